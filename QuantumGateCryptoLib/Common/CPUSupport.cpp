@@ -0,0 +1,29 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#include "pch.h"
+#include "CPUSupport.h"
+#include "CPUInstructionSet.h"
+
+#include <atomic>
+
+static std::atomic<int> AVX2Enabled{ 1 };
+
+int QGCryptoCPUSupportsAVX2()
+{
+	// Besides the CPU the OS also needs to support AVX by saving
+	// the (upper halves of the) YMM registers on context switches
+	static const int supported = (CPUInstructionSet::AVX2() && CPUInstructionSet::OSXSAVE() &&
+								  ((_xgetbv(0) & 0x6) == 0x6)) ? 1 : 0;
+	return supported;
+}
+
+int QGCryptoIsAVX2Enabled()
+{
+	return (QGCryptoCPUSupportsAVX2() && AVX2Enabled.load(std::memory_order_relaxed)) ? 1 : 0;
+}
+
+void QGCryptoSetAVX2Enabled(int enabled)
+{
+	AVX2Enabled.store(enabled ? 1 : 0, std::memory_order_relaxed);
+}
@@ -0,0 +1,22 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#pragma once
+
+// Used by the C implementations to choose between
+// the reference and the vectorized code at runtime
+#ifdef __cplusplus
+extern "C" {
+#endif
+	// Returns 1 if the CPU and the OS support AVX2 instructions
+	int QGCryptoCPUSupportsAVX2();
+
+	// Returns 1 if the AVX2 implementations should be used
+	int QGCryptoIsAVX2Enabled();
+
+	// Allows the AVX2 implementations to be turned off (for example
+	// for benchmarks); they only get used if the CPU supports them
+	void QGCryptoSetAVX2Enabled(int enabled);
+#ifdef __cplusplus
+}
+#endif
@@ -2,8 +2,10 @@
 // licensing information refer to the license file(s) in the project root.
 
 #include "Random.h"
+#include "aes256ctr.h"
 
 #include <assert.h>
+#include <string.h>
 
 #include "..\targetver.h"
 
@@ -18,6 +20,10 @@
 
 static BCRYPT_ALG_HANDLE BCryptAlgorithm = NULL;
 
+static int DeterministicRng = 0;
+static unsigned char DeterministicRngKey[32];
+static unsigned char DeterministicRngNonce[16];
+
 int QGCryptoInitRng()
 {
 	assert(BCryptAlgorithm == NULL);
@@ -57,8 +63,43 @@ int QGCryptoGetRandomBytes(unsigned char* buffer, unsigned long buffer_len)
 	return 0;
 }
 
+void QGCryptoSetDeterministicRng(const unsigned char* seed)
+{
+	if (seed != NULL)
+	{
+		memcpy(DeterministicRngKey, seed, sizeof(DeterministicRngKey));
+		memset(DeterministicRngNonce, 0, sizeof(DeterministicRngNonce));
+		DeterministicRng = 1;
+	}
+	else
+	{
+		SecureZeroMemory(DeterministicRngKey, sizeof(DeterministicRngKey));
+		DeterministicRng = 0;
+	}
+}
+
+static void DeterministicRandomBytes(unsigned char* buffer, unsigned long buffer_len)
+{
+	int i;
+
+	// AES-256 in counter mode with the seed as the key; every call
+	// gets its own nonce so that the output doesn't repeat
+	aes256ctr(buffer, buffer_len, DeterministicRngNonce, DeterministicRngKey);
+
+	for (i = 0; i < 8; ++i)
+	{
+		if (++DeterministicRngNonce[i] != 0) break;
+	}
+}
+
 void randombytes(unsigned char* buffer, unsigned long buffer_len)
 {
+	if (DeterministicRng)
+	{
+		DeterministicRandomBytes(buffer, buffer_len);
+		return;
+	}
+
 	while (QGCryptoGetRandomBytes(buffer, buffer_len) != 1)
 	{}
 }
\ No newline at end of file
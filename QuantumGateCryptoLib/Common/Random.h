@@ -9,6 +9,12 @@ extern "C" {
 	int QGCryptoInitRng();
 	void QGCryptoDeinitRng();
 	int QGCryptoGetRandomBytes(unsigned char* buffer, unsigned long buffer_len);
+
+	// For tests only: makes randombytes() return a deterministic stream of bytes
+	// derived from the 32 byte seed (so that different implementations can be
+	// compared on the same input), or the system RNG again if the seed is NULL.
+	// Not thread safe; nothing else should be generating keys meanwhile.
+	void QGCryptoSetDeterministicRng(const unsigned char* seed);
 #ifdef __cplusplus
 }
 #endif
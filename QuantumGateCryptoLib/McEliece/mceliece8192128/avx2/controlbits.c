@@ -0,0 +1,325 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+// Control bits of the Benes network; this is ..\ref\controlbits.c with the
+// sorting done by a bitonic sorting network on 256-bit vectors. Which elements
+// get compared only depends on the size of the input, so the sorting still runs
+// in constant time. Since the sorted output is the same no matter which sorting
+// network produces it, so are the control bits.
+
+#include "controlbits.h"
+
+#include "..\ref\params.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <malloc.h>
+#include <immintrin.h>
+
+typedef char bit;
+
+static bit is_smaller(uint32_t a, uint32_t b)
+{
+  uint32_t ret = 0;
+
+  ret = a - b;
+  ret >>= 31;
+
+  return ret;
+}
+
+static void cswap(uint32_t *x,uint32_t *y,bit swap)
+{
+  uint32_t m;
+  uint32_t d;
+
+  m = swap; 
+  m = 0 - m;
+
+  d = (*x ^ *y);
+  d &= m;
+  *x ^= d;
+  *y ^= d;
+}
+
+/* output x = min(input x,input y) */
+/* output y = max(input x,input y) */
+
+static void minmax(uint32_t *x, uint32_t *y)
+{
+  bit m;
+
+  m = is_smaller(*y, *x);
+  cswap(x, y, m);
+}
+
+/* merge first half of x[0],x[step],...,x[(2*n-1)*step] with second half */
+/* requires n to be a power of 2 */
+
+static void merge(int n,uint32_t *x,int step)
+{
+  int i;
+  if (n == 1)
+    minmax(&x[0],&x[step]);
+  else {
+    merge(n / 2,x,step * 2);
+    merge(n / 2,x + step,step * 2);
+    for (i = 1;i < 2*n-1;i += 2)
+      minmax(&x[i * step],&x[(i + 1) * step]);
+  }
+}
+
+/* sort x[0],x[1],...,x[n-1] in place */
+/* requires n to be a power of 2 */
+
+static void sort(int n, uint32_t *x)
+{
+  if (n <= 1) return;
+  sort(n/2,x);
+  sort(n/2,x + n/2);
+  merge(n/2,x,1);
+}
+
+/* sort x[0],x[1],...,x[n-1] in place */
+/* requires n to be a power of 2 */
+
+static void sort_x8(int n, uint32_t *x)
+{
+	int i, j, k, l;
+
+	const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+	// Lanes that hold the upper element of each pair for distances 1, 2 and 4
+	const __m256i upper1 = _mm256_setr_epi32(0, -1, 0, -1, 0, -1, 0, -1);
+	const __m256i upper2 = _mm256_setr_epi32(0, 0, -1, -1, 0, 0, -1, -1);
+	const __m256i upper4 = _mm256_setr_epi32(0, 0, 0, 0, -1, -1, -1, -1);
+
+	__m256i a, b, mn, mx, desc, kv;
+
+	if (n < 16)
+	{
+		sort(n, x);
+		return;
+	}
+
+	// Merging blocks of size k into sorted blocks of size 2k; blocks
+	// where (i & k) != 0 get sorted in descending order so that each
+	// pair of blocks forms a bitonic sequence for the next round
+	for (k = 2; k <= n; k <<= 1)
+	{
+		// Pairs that are at least a whole vector apart
+		for (j = k >> 1; j >= 8; j >>= 1)
+		{
+			for (i = 0; i < n; i += 2*j)
+			for (l = i; l < i + j; l += 8)
+			{
+				a = _mm256_loadu_si256((const __m256i*)(x + l));
+				b = _mm256_loadu_si256((const __m256i*)(x + l + j));
+				mn = _mm256_min_epu32(a, b);
+				mx = _mm256_max_epu32(a, b);
+
+				if ((l & k) == 0)
+				{
+					_mm256_storeu_si256((__m256i*)(x + l), mn);
+					_mm256_storeu_si256((__m256i*)(x + l + j), mx);
+				}
+				else
+				{
+					_mm256_storeu_si256((__m256i*)(x + l), mx);
+					_mm256_storeu_si256((__m256i*)(x + l + j), mn);
+				}
+			}
+		}
+
+		// The remaining distances (4, 2 and 1) within each vector in one pass;
+		// the upper element gets the maximum unless the block is descending
+		kv = _mm256_set1_epi32(k);
+
+		for (i = 0; i < n; i += 8)
+		{
+			a = _mm256_loadu_si256((const __m256i*)(x + i));
+			desc = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_add_epi32(_mm256_set1_epi32(i), lanes), kv), kv);
+
+			if (j >= 4)
+			{
+				b = _mm256_permute2x128_si256(a, a, 0x01);
+				mn = _mm256_min_epu32(a, b);
+				mx = _mm256_max_epu32(a, b);
+				a = _mm256_blendv_epi8(mn, mx, _mm256_xor_si256(upper4, desc));
+			}
+
+			if (j >= 2)
+			{
+				b = _mm256_shuffle_epi32(a, 0x4e);
+				mn = _mm256_min_epu32(a, b);
+				mx = _mm256_max_epu32(a, b);
+				a = _mm256_blendv_epi8(mn, mx, _mm256_xor_si256(upper2, desc));
+			}
+
+			b = _mm256_shuffle_epi32(a, 0xb1);
+			mn = _mm256_min_epu32(a, b);
+			mx = _mm256_max_epu32(a, b);
+			a = _mm256_blendv_epi8(mn, mx, _mm256_xor_si256(upper1, desc));
+
+			_mm256_storeu_si256((__m256i*)(x + i), a);
+		}
+	}
+}
+
+/* y[pi[i]] = x[i] */
+/* requires n = 2^w */
+/* requires pi to be a permutation */
+static void composeinv(int n,uint32_t *y,uint32_t *x,uint32_t *pi) // NC
+{
+  int i;
+  uint32_t *t = (uint32_t*)_malloca(n*sizeof(uint32_t));
+
+  for (i = 0;i < n;++i) 
+    t[i] = x[i] | (pi[i] << 16);
+
+  sort_x8(n,t);
+
+  for (i = 0;i < n;++i)
+    y[i] = t[i] & 0xFFFF;
+
+  _freea(t);
+}
+
+/* ip[i] = j iff pi[i] = j */
+/* requires n = 2^w */
+/* requires pi to be a permutation */
+static void invert(int n,uint32_t *ip,uint32_t *pi)
+{
+  int i;
+
+  for (i = 0;i < n;i++)
+    ip[i] = i;
+
+  composeinv(n,ip,ip,pi);
+}
+
+
+static void flow(int w, uint32_t *x, uint32_t *y, const int t)
+{
+  bit m0;
+  bit m1;
+
+  uint32_t b;
+  uint32_t y_copy = *y;
+
+  m0 = is_smaller(*y & ((1<<w)-1), *x & ((1<<w)-1));
+  m1 = is_smaller(0, t);
+
+  cswap(x, &y_copy, m0);
+  b = m0 & m1;
+  *x ^= b << w;
+}
+
+/* input: permutation pi */
+/* output: (2w-1)n/2 (or 0 if n==1) control bits c[0],c[step],c[2*step],... */
+/* requires n = 2^w */
+static int controlbitsfrompermutation(int w, int n, int step, int off, unsigned char *c, uint32_t *pi)
+{
+  int i;
+  int j;
+  int k;
+  int t;
+  /*
+  uint32_t ip[n];
+  uint32_t I[2 * n];
+  uint32_t P[2 * n];
+  uint32_t PI[2 * n];
+  uint32_t T[2 * n];
+  uint32_t piflip[n];
+  uint32_t subpi[2][n / 2];
+  */
+
+  if (w == 1) c[ off/8 ] |= (pi[0] & 1) << (off%8);
+  if (w <= 1) return 0;
+
+  // Above arrays allocated on the heap instead to
+  // avoid exhausting the stack
+  uint32_t* memory = (uint32_t*)malloc((n + (4 * (2 * n)) + n + (2 * (n / 2))) * sizeof(uint32_t));
+  if (memory == NULL) return -1;
+
+  uint32_t* ip = memory;
+  uint32_t* I = memory + n;
+  uint32_t* P = memory + n + (2 * n);
+  uint32_t* PI = memory + n + (2 * (2 * n));
+  uint32_t* T = memory + n + (3 * (2 * n));
+  uint32_t* piflip = memory + n + (4 * (2 * n));
+
+  uint32_t* subpi[2];
+  subpi[0] = memory + n + (4 * (2 * n) + n);
+  subpi[1] = memory + n + (4 * (2 * n) + n + (n / 2));
+
+  invert(n,ip,pi);
+
+  for (i = 0;i < n;++i) 
+  {
+    I[i] = ip[i] | (1 << w);
+    I[n + i] = pi[i];
+  }
+
+  for (i = 0;i < 2 * n;++i)
+      P[i] = (i >> w) + (i & ((1<<w)-2)) + ((i & 1) << w);
+
+  for (t = 0;t < w;++t) 
+  {
+    composeinv(2 * n,PI,P,I);
+
+    for (i = 0;i < 2 * n;++i)
+      flow(w,&P[i],&PI[i],t);
+
+    for (i = 0;i < 2 * n;++i)
+	T[i] = I[i ^ 1];
+
+    composeinv(2 * n,I,I,T);
+
+    for (i = 0;i < 2 * n;++i)
+	T[i] = P[i ^ 1];
+
+    for (i = 0;i < 2 * n;++i)
+      flow(w,&P[i],&T[i],1);
+  }
+
+  for (i = 0;i < n;++i)
+    for (j = 0;j < w;++j)
+      piflip[i] = pi[i];
+
+  for (i = 0;i < n / 2;++i) c[ (off + i * step)/8 ] |= ((P[i * 2] >> w) & 1) << ((off + i * step)%8);
+  for (i = 0;i < n / 2;++i) c[ (off + ((w-1)*n + i) * step)/8 ] |= ((P[n + i * 2] >> w) & 1) << ((off + ((w-1)*n + i) * step)%8);
+
+  for (i = 0;i < n / 2;++i)
+    cswap(&piflip[i * 2], &piflip[i * 2 + 1], (P[n + i * 2] >> w) & 1);
+
+  for (k = 0;k < 2;++k)
+    for (i = 0;i < n / 2;++i)
+        subpi[k][i] = piflip[i * 2 + k] >> 1;
+
+  for (k = 0;k < 2;++k)
+    controlbitsfrompermutation(w - 1, n / 2, step * 2, off + step * (n/2 + k), c, subpi[k]);
+
+  free(memory);
+
+  return 0;
+}
+
+/* input: pi, a permutation*/
+/* output: out, control bits w.r.t. pi */
+int crypto_kem_mceliece8192128_avx2_controlbits(unsigned char * out, uint32_t * pi)
+{
+	unsigned int i;
+	unsigned char c[ (2*GFBITS - 1) * (1 << GFBITS) / 16 ];
+
+	for (i = 0; i < sizeof(c); i++)
+		c[i] = 0;
+
+    if (controlbitsfrompermutation(GFBITS, (1 << GFBITS), 1, 0, c, pi) != 0) return -1;
+
+	for (i = 0; i < sizeof(c); i++)
+		out[i] = c[i];
+
+    return 0;
+}
+
@@ -0,0 +1,13 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#ifndef MCELIECE8192128_AVX2_CONTROLBITS_H
+#define MCELIECE8192128_AVX2_CONTROLBITS_H
+
+#include <stdint.h>
+
+// Same as controlbits() in ..\ref\controlbits.c (and with the same results), but
+// with the sorting that takes up most of the time done by a vectorized sorting network
+int crypto_kem_mceliece8192128_avx2_controlbits(unsigned char *out, uint32_t *pi);
+
+#endif
@@ -0,0 +1,125 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+// Niederreiter encryption; this is ..\vec\encrypt.c with
+// the syndrome computed on 256-bit vectors
+
+#include "encrypt.h"
+
+#include "..\..\..\Common\randombytes.h"
+#include "..\ref\params.h"
+#include "..\vec\util.h"
+
+#include <stdint.h>
+#include <immintrin.h>
+
+/* output: e, an error vector of weight t */
+static void gen_e(unsigned char *e)
+{
+	int i, j, eq;
+
+	uint16_t ind[ SYS_T ];
+	unsigned char bytes[ sizeof(ind) ];
+	uint64_t e_int[ SYS_N/64 ];	
+	uint64_t one = 1;	
+	uint64_t mask;	
+	uint64_t val[ SYS_T ];	
+
+	while (1)
+	{
+		randombytes(bytes, sizeof(bytes));
+
+		for (i = 0; i < SYS_T; i++)
+			ind[i] = load_gf(bytes + i*2);
+
+		// check for repetition
+
+		eq = 0;
+
+		for (i = 1; i < SYS_T; i++) 
+			for (j = 0; j < i; j++)
+				if (ind[i] == ind[j]) 
+					eq = 1;
+
+		if (eq == 0)
+			break;
+	}
+
+	for (j = 0; j < SYS_T; j++)
+		val[j] = one << (ind[j] & 63);
+
+	for (i = 0; i < SYS_N/64; i++) 
+	{
+		e_int[i] = 0;
+
+		for (j = 0; j < SYS_T; j++)
+		{
+			mask = i ^ (ind[j] >> 6);
+			mask -= 1;
+			mask >>= 63;
+			mask = -mask;
+
+			e_int[i] |= val[j] & mask;
+		}
+	}
+
+	for (i = 0; i < SYS_N/64; i++)
+		store8(e + i*8, e_int[i]);
+}
+
+/* input: public key pk, error vector e */
+/* output: syndrome s */
+static void syndrome(unsigned char *s, const unsigned char *pk, unsigned char *e)
+{
+	uint64_t b;
+
+	const uint64_t *pk_ptr; 
+	const uint64_t *e_ptr = ((uint64_t *) (e + SYND_BYTES));
+
+	__m256i e_vec[ PK_NCOLS/256 ];
+	__m256i acc;
+	uint64_t acc_words[4];
+
+	int i, j;
+
+	//
+
+	for (i = 0; i < SYND_BYTES; i++)
+		s[i] = e[i];
+
+	for (j = 0; j < PK_NCOLS/256; j++)
+		e_vec[j] = _mm256_loadu_si256((const __m256i*)(e_ptr + j*4));
+
+	for (i = 0; i < PK_NROWS; i++)	
+	{
+		pk_ptr = ((uint64_t *) (pk + PK_ROW_BYTES * i));
+	
+		acc = _mm256_setzero_si256();
+		for (j = 0; j < PK_NCOLS/256; j++)
+			acc = _mm256_xor_si256(acc, _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(pk_ptr + j*4)), e_vec[j]));
+
+		_mm256_storeu_si256((__m256i*)acc_words, acc);
+		b = acc_words[0] ^ acc_words[1] ^ acc_words[2] ^ acc_words[3];
+
+		for (j = (PK_NCOLS/256)*4; j < PK_NCOLS/64; j++)
+			b ^= pk_ptr[j] & e_ptr[j];
+
+		b ^= b >> 32;
+		b ^= b >> 16;
+		b ^= b >> 8;
+		b ^= b >> 4;
+		b ^= b >> 2;
+		b ^= b >> 1;
+		b &= 1;
+
+		s[ i/8 ] ^= (b << (i%8));
+	}
+}
+
+/* input: public key pk */
+/* output: error vector e, syndrome s */
+void crypto_kem_mceliece8192128_avx2_encrypt(unsigned char *s, const unsigned char *pk, unsigned char *e)
+{
+	gen_e(e);
+	syndrome(s, pk, e);
+}
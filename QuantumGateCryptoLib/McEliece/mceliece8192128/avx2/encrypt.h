@@ -0,0 +1,10 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#ifndef MCELIECE8192128_AVX2_ENCRYPT_H
+#define MCELIECE8192128_AVX2_ENCRYPT_H
+
+// Same as encrypt() in ..\vec\encrypt.c, but computes the syndrome on whole vectors
+void crypto_kem_mceliece8192128_avx2_encrypt(unsigned char *s, const unsigned char *pk, unsigned char *e);
+
+#endif
@@ -0,0 +1,101 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+// Same as ..\vec\operations.c, but with the AVX2 versions of key
+// generation and encryption; there's no AVX2 decryption since decryption
+// cost is small compared to key generation, so the vec code gets used for it
+
+#include "operations.h"
+
+#include "..\..\..\Common\aes256ctr.h"
+#include "..\..\..\Common\randombytes.h"
+#include "..\ref\crypto_hash.h"
+#include "..\ref\params.h"
+#include "..\vec\util.h"
+#include "controlbits.h"
+#include "encrypt.h"
+#include "pk_gen.h"
+#include "sk_gen.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+
+int crypto_kem_mceliece8192128_avx2_enc(
+       unsigned char *c,
+       unsigned char *key,
+       const unsigned char *pk
+)
+{
+	unsigned char two_e[ 1 + SYS_N/8 ] = {2};
+	unsigned char *e = two_e + 1;
+	unsigned char one_ec[ 1 + SYS_N/8 + (SYND_BYTES + 32) ] = {1};
+
+	//
+
+	crypto_kem_mceliece8192128_avx2_encrypt(c, pk, e);
+
+	crypto_hash_32b(c + SYND_BYTES, two_e, sizeof(two_e)); 
+
+	memcpy(one_ec + 1, e, SYS_N/8);
+	memcpy(one_ec + 1 + SYS_N/8, c, SYND_BYTES + 32);
+
+	crypto_hash_32b(key, one_ec, sizeof(one_ec));
+
+	return 0;
+}
+
+int crypto_kem_mceliece8192128_avx2_keypair
+(
+       unsigned char *pk,
+       unsigned char *sk 
+)
+{
+	int i;
+	unsigned char seed[ 32 ];
+	unsigned char r[ SYS_T*2 + (1 << GFBITS)*sizeof(uint32_t) + SYS_N/8 + 32 ];
+	unsigned char nonce[ 16 ] = {0};
+	unsigned char *rp;
+
+	gf f[ SYS_T ]; // element in GF(2^mt)
+	gf irr[ SYS_T ]; // Goppa polynomial
+	uint32_t perm[ 1 << GFBITS ]; // random permutation 
+
+	int matmem_size = (GFBITS * SYS_T) * 128;
+	int opsmem_size = (GFBITS * SYS_T) * (GFBITS * SYS_T / 64);
+	uint64_t *memory = (uint64_t*)malloc((matmem_size + opsmem_size) * sizeof(uint64_t));
+	if (memory == NULL) return -1;
+
+	uint64_t* matmem = memory;
+	uint64_t* opsmem = memory+matmem_size;
+
+	randombytes(seed, sizeof(seed));
+
+	int ret = -1;
+
+	while (1)
+	{
+		rp = r;
+		if (aes256ctr(r, sizeof(r), nonce, seed) != 0) break;
+
+		memcpy(seed, &r[ sizeof(r)-32 ], 32);
+
+		for (i = 0; i < SYS_T; i++) f[i] = load_gf(rp + i*2); rp += sizeof(f);
+		if (crypto_kem_mceliece8192128_avx2_genpoly_gen(irr, f)) continue;
+
+		for (i = 0; i < (1 << GFBITS); i++) perm[i] = load4(rp + i*4); rp += sizeof(perm);
+
+		for (i = 0; i < SYS_T;   i++) store_gf(sk + SYS_N/8 + i*2, irr[i]);
+		if (crypto_kem_mceliece8192128_avx2_pk_gen(pk, sk + SYS_N/8, perm, matmem, opsmem)) continue;
+
+		memcpy(sk, rp, SYS_N/8);
+		ret = crypto_kem_mceliece8192128_avx2_controlbits(sk + SYS_N/8 + IRR_BYTES, perm);
+
+		break;
+	}
+
+	free(memory);
+
+	return ret;
+}
+
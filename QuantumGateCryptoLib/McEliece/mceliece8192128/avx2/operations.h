@@ -0,0 +1,23 @@
+#ifndef OPERATIONS_AVX2_H
+#define OPERATIONS_AVX2_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+int crypto_kem_mceliece8192128_avx2_enc(
+       unsigned char *c,
+       unsigned char *key,
+       const unsigned char *pk
+);
+
+int crypto_kem_mceliece8192128_avx2_keypair
+(
+       unsigned char *pk,
+       unsigned char *sk 
+);
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
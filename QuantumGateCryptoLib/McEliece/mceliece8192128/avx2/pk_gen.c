@@ -0,0 +1,316 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+// Public-key generation; this is ..\vec\pk_gen.c with the row operations done
+// on 256-bit vectors. All masks are still computed from the matrix contents
+// without branching, so the code runs in constant time just like the original.
+
+#include "pk_gen.h"
+
+#include "..\ref\controlbits.h"
+#include "..\ref\params.h"
+#include "..\vec\util.h"
+#include "..\vec\fft.h"
+#include "..\vec\vec.h"
+
+#include <stdint.h>
+#include <immintrin.h>
+
+// Number of 64-bit words in a row of the systematic
+// part of the matrix and in a row of the public key
+#define SYS_WORDS ((GFBITS * SYS_T) / 64)
+#define PK_WORDS ((SYS_N - GFBITS*SYS_T) / 64)
+
+// Number of rows of the public key that are computed together
+// so that each row of the matrix gets loaded only once for them
+#define PK_ROWS_PER_PASS 4
+
+// dst ^= src & mask for n words; n must be even
+static inline void row_xor_masked(uint64_t *dst, const uint64_t *src, uint64_t mask, int n)
+{
+	int c = 0;
+
+	const __m256i m = _mm256_set1_epi64x((long long)mask);
+
+	for (; c + 4 <= n; c += 4)
+	{
+		const __m256i s = _mm256_loadu_si256((const __m256i*)(src + c));
+		const __m256i d = _mm256_loadu_si256((const __m256i*)(dst + c));
+		_mm256_storeu_si256((__m256i*)(dst + c), _mm256_xor_si256(d, _mm256_and_si256(s, m)));
+	}
+
+	if (c < n)
+	{
+		const __m128i s = _mm_loadu_si128((const __m128i*)(src + c));
+		const __m128i d = _mm_loadu_si128((const __m128i*)(dst + c));
+		_mm_storeu_si128((__m128i*)(dst + c), _mm_xor_si128(d, _mm_and_si128(s, _mm256_castsi256_si128(m))));
+	}
+}
+
+// dst[r] ^= src & mask[r] for each of the PK_ROWS_PER_PASS rows of PK_WORDS words in dst
+static inline void rows_xor_masked(uint64_t dst[][PK_WORDS], const uint64_t *src, const uint64_t *mask)
+{
+	int c = 0, r;
+
+	__m256i m[PK_ROWS_PER_PASS];
+
+	for (r = 0; r < PK_ROWS_PER_PASS; r++)
+		m[r] = _mm256_set1_epi64x((long long)mask[r]);
+
+	for (; c + 4 <= PK_WORDS; c += 4)
+	{
+		const __m256i s = _mm256_loadu_si256((const __m256i*)(src + c));
+
+		for (r = 0; r < PK_ROWS_PER_PASS; r++)
+		{
+			const __m256i d = _mm256_loadu_si256((const __m256i*)(dst[r] + c));
+			_mm256_storeu_si256((__m256i*)(dst[r] + c), _mm256_xor_si256(d, _mm256_and_si256(s, m[r])));
+		}
+	}
+
+	for (; c < PK_WORDS; c++)
+	{
+		for (r = 0; r < PK_ROWS_PER_PASS; r++)
+			dst[r][c] ^= src[c] & mask[r];
+	}
+}
+
+static void de_bitslicing(uint64_t * out, const vec in[][GFBITS])
+{
+	int i, j, r;
+
+	for (i = 0; i < (1 << GFBITS); i++)
+		out[i] = 0 ;
+
+	for (i = 0; i < 128; i++)
+	for (j = GFBITS-1; j >= 0; j--)
+	for (r = 0; r < 64; r++) 
+	{ 
+		out[i*64 + r] <<= 1; 
+		out[i*64 + r] |= (in[i][j] >> r) & 1; 
+	}
+}
+
+static void to_bitslicing_2x(vec out0[][GFBITS], vec out1[][GFBITS], const uint64_t * in)
+{
+	int i, j, r;
+
+	for (i = 0; i < 128; i++)
+	{
+		for (j = GFBITS-1; j >= 0; j--)
+		for (r = 63; r >= 0; r--)
+		{
+			out1[i][j] <<= 1;
+			out1[i][j] |= (in[i*64 + r] >> (j + GFBITS)) & 1;
+		}
+        
+		for (j = GFBITS-1; j >= 0; j--)
+		for (r = 63; r >= 0; r--)
+		{
+			out0[i][GFBITS-1-j] <<= 1;
+			out0[i][GFBITS-1-j] |= (in[i*64 + r] >> j) & 1;
+		}
+	}
+}
+
+int crypto_kem_mceliece8192128_avx2_pk_gen(unsigned char * pk, const unsigned char * irr, uint32_t * perm,
+										   uint64_t * matmem, uint64_t * opsmem)
+{
+	int i, j, k;
+	int row, c, d, r;
+	
+	// uint64_t mat[ GFBITS * SYS_T ][ 128 ];
+	// allocated on the heap instead to avoid exhausting the stack
+	uint64_t *mat[GFBITS * SYS_T];
+	for (int x = 0; x < (GFBITS * SYS_T); x++)
+	{
+		mat[x] = matmem + (x * 128);
+	}
+
+	// uint64_t ops[ GFBITS * SYS_T ][ GFBITS * SYS_T / 64 ];
+	// allocated on the heap instead to avoid exhausting the stack
+	uint64_t *ops[GFBITS * SYS_T];
+	for (int x = 0; x < (GFBITS * SYS_T); x++)
+	{
+		ops[x] = opsmem + (x * SYS_WORDS);
+	}
+
+	uint64_t mask;	
+	uint64_t masks[ PK_ROWS_PER_PASS ];
+
+	vec irr_int[2][ GFBITS ];
+
+	vec consts[ 128 ][ GFBITS ];
+	vec eval[ 128 ][ GFBITS ];
+	vec prod[ 128 ][ GFBITS ];
+	vec tmp[ GFBITS ];
+
+	uint64_t list[1 << GFBITS];
+	uint64_t one_row[ PK_ROWS_PER_PASS ][ PK_WORDS ];
+
+	// compute the inverses 
+
+	irr_load(irr_int, irr);
+
+	fft(eval, irr_int);
+
+	vec_copy(prod[0], eval[0]);
+
+	for (i = 1; i < 128; i++)
+		vec_mul(prod[i], prod[i-1], eval[i]);
+
+	vec_inv(tmp, prod[127]);
+
+	for (i = 126; i >= 0; i--)
+	{
+		vec_mul(prod[i+1], prod[i], tmp);
+		vec_mul(tmp, tmp, eval[i+1]);
+	}
+
+	vec_copy(prod[0], tmp);
+
+	// fill matrix 
+
+	de_bitslicing(list, prod);
+
+	for (i = 0; i < (1 << GFBITS); i++)
+	{	
+		list[i] <<= GFBITS;
+		list[i] |= i;	
+		list[i] |= ((uint64_t) perm[i]) << 31;
+	}
+
+	sort_63b(1 << GFBITS, list);
+
+	for (i = 1; i < (1 << GFBITS); i++)
+		if ((list[i-1] >> 31) == (list[i] >> 31))
+			return -1;
+
+	to_bitslicing_2x(consts, prod, list);
+
+	for (i = 0; i < (1 << GFBITS); i++)
+		perm[i] = list[i] & GFMASK;
+
+	for (j = 0; j < (GFBITS * SYS_T + 63)/64; j++)
+	for (k = 0; k < GFBITS; k++)
+		mat[ k ][ j ] = prod[ j ][ k ];
+
+	for (i = 1; i < SYS_T; i++)
+	for (j = 0; j < (GFBITS * SYS_T + 63)/64; j++)
+	{
+		vec_mul(prod[j], prod[j], consts[j]);
+
+		for (k = 0; k < GFBITS; k++)
+			mat[ i*GFBITS + k ][ j ] = prod[ j ][ k ];
+	}
+
+	// gaussian elimination to obtain an upper triangular matrix 
+	// and keep track of the operations in ops
+
+	for (row = 0; row < GFBITS * SYS_T; row++)
+	for (c = 0; c < SYS_WORDS; c++)
+		ops[ row ][ c ] = 0;
+
+	for (i = 0; i < SYS_WORDS; i++)
+	for (j = 0; j < 64; j++)
+	{
+		row = i*64 + j;			
+
+		ops[ row ][ i ] = 1;
+		ops[ row ][ i ] <<= j;
+	}
+
+	for (i = 0; i < SYS_WORDS; i++)
+	for (j = 0; j < 64; j++)
+	{
+		row = i*64 + j;			
+
+		for (k = row + 1; k < GFBITS * SYS_T; k++)
+		{
+			mask = mat[ row ][ i ] >> j;
+			mask &= 1;
+			mask -= 1;
+
+			row_xor_masked(mat[ row ], mat[ k ], mask, SYS_WORDS);
+			row_xor_masked(ops[ row ], ops[ k ], mask, SYS_WORDS);
+		}
+
+		if ( ((mat[ row ][ i ] >> j) & 1) == 0 ) // return if not systematic
+		{
+			return -1;
+		}
+
+		for (k = row+1; k < GFBITS * SYS_T; k++)
+		{
+			mask = mat[ k ][ i ] >> j;
+			mask &= 1;
+			mask = -mask;
+
+			row_xor_masked(mat[ k ], mat[ row ], mask, SYS_WORDS);
+			row_xor_masked(ops[ k ], ops[ row ], mask, SYS_WORDS);
+		}
+	}
+
+	// computing the linear map required to obtain the systematic form
+
+	for (i = SYS_WORDS - 1; i >= 0; i--)
+	for (j = 63; j >= 0; j--)
+	{
+		row = i*64 + j;			
+
+		for (k = 0; k < row; k++)
+		{
+			mask = mat[ k ][ i ] >> j;
+			mask &= 1;
+			mask = -mask;
+
+			row_xor_masked(ops[ k ], ops[ row ], mask, SYS_WORDS);
+		}
+	}
+
+	// apply the linear map to the non-systematic part
+
+	for (j = (GFBITS * SYS_T + 63)/64; j < 128; j++)
+	for (k = 0; k < GFBITS; k++)
+		mat[ k ][ j ] = prod[ j ][ k ];
+
+	for (i = 1; i < SYS_T; i++)
+	for (j = (GFBITS * SYS_T + 63)/64; j < 128; j++)
+	{
+		vec_mul(prod[j], prod[j], consts[j]);
+
+		for (k = 0; k < GFBITS; k++)
+			mat[ i*GFBITS + k ][ j ] = prod[ j ][ k ];
+	}
+
+	for (row = 0; row < GFBITS * SYS_T; row += PK_ROWS_PER_PASS)
+	{
+		for (r = 0; r < PK_ROWS_PER_PASS; r++)
+		for (k = 0; k < PK_WORDS; k++)
+			one_row[ r ][ k ] = 0;
+
+		for (c = 0; c < SYS_WORDS; c++)
+		for (d = 0; d < 64; d++)
+		{
+			for (r = 0; r < PK_ROWS_PER_PASS; r++)
+			{
+				mask = ops[ row + r ][ c ] >> d;
+				mask &= 1;
+				masks[ r ] = -mask;
+			}
+
+			rows_xor_masked(one_row, mat[ c*64 + d ] + SYS_WORDS, masks);
+		}
+
+		for (r = 0; r < PK_ROWS_PER_PASS; r++)
+		for (k = 0; k < PK_WORDS; k++)
+		{
+			store8(pk, one_row[ r ][ k ]);
+			pk += 8;		
+		}
+	}
+
+	//
+
+	return 0;
+}
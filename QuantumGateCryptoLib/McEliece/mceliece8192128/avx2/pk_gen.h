@@ -0,0 +1,14 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#ifndef MCELIECE8192128_AVX2_PK_GEN_H
+#define MCELIECE8192128_AVX2_PK_GEN_H
+
+#include <stdint.h>
+
+// Same as pk_gen() in ..\vec\pk_gen.c (and with the same results), but with the
+// row operations of the Gaussian elimination and of the linear map on whole vectors
+int crypto_kem_mceliece8192128_avx2_pk_gen(unsigned char *pk, const unsigned char *irr, uint32_t *perm,
+										   uint64_t *matmem, uint64_t *opsmem);
+
+#endif
@@ -0,0 +1,134 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+// Secret-key generation; this is genpoly_gen() from ..\vec\sk_gen.c
+// with the elimination steps done on 256-bit vectors of field elements
+
+#include "sk_gen.h"
+
+#include "..\ref\params.h"
+
+#include <stdint.h>
+#include <immintrin.h>
+
+// Number of vectors of 16 field elements in a column of the matrix
+#define COL_VECS (SYS_T / 16)
+
+// The field polynomial without the leading term: x^13 = x^4 + x^3 + x + 1
+#define GF_POLY_LOW 0x001B
+
+// out[i] = in * x^i for i = 0...GFBITS-1 for each of the elements in the column
+static void col_mul_powers(__m256i out[][COL_VECS], const gf *in)
+{
+	int i, v;
+
+	const __m256i top = _mm256_set1_epi16(1 << GFBITS);
+	const __m256i gfmask = _mm256_set1_epi16(GFMASK);
+	const __m256i poly = _mm256_set1_epi16(GF_POLY_LOW);
+
+	__m256i t, m;
+
+	for (v = 0; v < COL_VECS; v++)
+		out[0][v] = _mm256_loadu_si256((const __m256i*)(in + v*16));
+
+	for (i = 1; i < GFBITS; i++)
+	for (v = 0; v < COL_VECS; v++)
+	{
+		t = _mm256_slli_epi16(out[i-1][v], 1);
+		m = _mm256_cmpeq_epi16(_mm256_and_si256(t, top), top);
+		out[i][v] = _mm256_xor_si256(_mm256_and_si256(t, gfmask), _mm256_and_si256(m, poly));
+	}
+}
+
+// col ^= a * p where p holds the powers of the column from col_mul_powers();
+// the bits of a only get used as masks so this runs in constant time
+static void col_xor_mul(gf *col, gf a, __m256i p[][COL_VECS])
+{
+	int i, v;
+
+	__m256i m[GFBITS];
+	__m256i acc;
+
+	for (i = 0; i < GFBITS; i++)
+		m[i] = _mm256_set1_epi16((short)(-((a >> i) & 1)));
+
+	for (v = 0; v < COL_VECS; v++)
+	{
+		acc = _mm256_loadu_si256((const __m256i*)(col + v*16));
+
+		for (i = 0; i < GFBITS; i++)
+			acc = _mm256_xor_si256(acc, _mm256_and_si256(p[i][v], m[i]));
+
+		_mm256_storeu_si256((__m256i*)(col + v*16), acc);
+	}
+}
+
+/* input: f, element in GF((2^m)^t) */
+/* output: out, minimal polynomial of f */
+/* return: 0 for success and -1 for failure */
+int crypto_kem_mceliece8192128_avx2_genpoly_gen(gf *out, gf *f)
+{
+	int i, j, k, c;
+
+	gf mat[ SYS_T+1 ][ SYS_T ];
+	gf mask, inv;
+
+	gf t[ SYS_T ];
+	__m256i t_powers[ GFBITS ][ COL_VECS ];
+
+	// fill matrix
+
+	mat[0][0] = 1;
+
+	for (i = 1; i < SYS_T; i++)
+		mat[0][i] = 0;
+
+	for (i = 0; i < SYS_T; i++)
+		mat[1][i] = f[i];
+
+	for (j = 2; j <= SYS_T; j++)
+		GF_mul(mat[j], mat[j-1], f);
+
+	// gaussian
+
+	for (j = 0; j < SYS_T; j++)
+	{
+		for (k = j + 1; k < SYS_T; k++)
+		{
+			mask = gf_iszero(mat[ j ][ j ]);
+
+			for (c = j; c < SYS_T + 1; c++)
+				mat[ c ][ j ] ^= mat[ c ][ k ] & mask;
+
+		}
+
+		if ( mat[ j ][ j ] == 0 ) // return if not systematic
+		{
+			return -1;
+		}
+
+		inv = gf_inv(mat[j][j]);
+
+		for (c = j; c < SYS_T + 1; c++)
+			mat[ c ][ j ] = gf_mul(mat[ c ][ j ], inv) ;
+
+		// Eliminating row j from all other rows; the factors get taken from column j
+		// before it changes, and leaving out row j itself (mat[j][j] is now 1) this
+		// is the same as going through the rows one by one as the vec code does
+
+		for (k = 0; k < SYS_T; k++)
+			t[ k ] = mat[ j ][ k ];
+
+		t[ j ] = 0;
+
+		col_mul_powers(t_powers, t);
+
+		for (c = j; c < SYS_T + 1; c++)
+			col_xor_mul(mat[ c ], mat[ c ][ j ], t_powers);
+	}
+
+	for (i = 0; i < SYS_T; i++)
+		out[i] = mat[ SYS_T ][ i ];
+
+	return 0;
+}
@@ -0,0 +1,13 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#ifndef MCELIECE8192128_AVX2_SK_GEN_H
+#define MCELIECE8192128_AVX2_SK_GEN_H
+
+#include "..\vec\gf.h"
+
+// Same as genpoly_gen() in ..\vec\sk_gen.c (and with the same results), but with the
+// elimination steps multiplying whole rows of the matrix by a field element at once
+int crypto_kem_mceliece8192128_avx2_genpoly_gen(gf *out, gf *f);
+
+#endif
@@ -5,10 +5,18 @@
 #include "mceliece8192128.h"
 #include "ref\operations.h"
 #include "vec\operations.h"
+#include "avx2\operations.h"
+#include "..\..\Common\CPUSupport.h"
+
+// This is the only place where the implementation gets chosen; with MCELIECE_USE_VEC
+// the AVX2 implementation gets used at runtime when the CPU supports it, otherwise
+// the vec implementation. Decryption is only available in the vec implementation.
 
 int crypto_kem_mceliece8192128_enc(unsigned char* c, unsigned char* key, const unsigned char* pk)
 {
 #ifdef MCELIECE_USE_VEC
+	if (QGCryptoIsAVX2Enabled()) return crypto_kem_mceliece8192128_avx2_enc(c, key, pk);
+
 	return crypto_kem_mceliece8192128_vec_enc(c, key, pk);
 #else
 	return crypto_kem_mceliece8192128_ref_enc(c, key, pk);
@@ -27,6 +35,8 @@ int crypto_kem_mceliece8192128_dec(unsigned char* key, const unsigned char* c, c
 int crypto_kem_mceliece8192128_keypair(unsigned char* pk, unsigned char* sk)
 {
 #ifdef MCELIECE_USE_VEC
+	if (QGCryptoIsAVX2Enabled()) return crypto_kem_mceliece8192128_avx2_keypair(pk, sk);
+
 	return crypto_kem_mceliece8192128_vec_keypair(pk, sk);
 #else
 	return crypto_kem_mceliece8192128_ref_keypair(pk, sk);
@@ -0,0 +1,348 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#include "poly.h"
+
+#include <string.h>
+#include <immintrin.h>
+
+#include "..\ref\params.h"
+#include "..\ref\int32.h"
+#include "..\ref\uint16.h"
+
+#pragma warning (disable: 4146)
+
+#define q12 ((q-1)/2)
+
+// Montgomery constant for multiplication mod q in 16-bit lanes: q^-1 mod 2^16
+#define qinv (-19761)
+
+// Polynomials (and their padding) handled as whole vectors
+#define PADDED8 (((p+1)+31)&~31)
+#define PADDED16 (((p+1)+15)&~15)
+
+// Number of products f*g handled as whole groups of four vectors;
+// the product has p+p-1 coefficients before reduction
+#define PRODUCT32 (((p+p-1)+31)&~31)
+#define PRODUCT16 (((p+p-1)+63)&~63)
+
+/* ----- scalar helpers (same as in the reference code) */
+
+/* return -1 if x!=0; else return 0 */
+static int int16_nonzero_mask(int16 x)
+{
+	uint16 u = x;
+	uint32_t v = u;
+	v = -v;
+	v >>= 31;
+	return -(int)v;
+}
+
+/* return -1 if x<0; otherwise return 0 */
+static int int16_negative_mask(int16 x)
+{
+	uint16 u = x;
+	u >>= 15;
+	return -(int)u;
+}
+
+static int8 F3_freeze(int16 x)
+{
+	return int32_mod_uint14(x + 1, 3) - 1;
+}
+
+static int16 Fq_freeze(int32 x)
+{
+	return int32_mod_uint14(x + q12, q) - q12;
+}
+
+static int16 Fq_recip(int16 a1)
+{
+	int i = 1;
+	int16 ai = a1;
+
+	while (i < q - 2)
+	{
+		ai = Fq_freeze(a1 * (int32)ai);
+		i += 1;
+	}
+	return ai;
+}
+
+/* ----- vector helpers */
+
+// x in -2...2 to -1...1
+static inline __m256i F3_freeze_x32(__m256i x)
+{
+	const __m256i one = _mm256_set1_epi8(1);
+	const __m256i minus_one = _mm256_set1_epi8(-1);
+	const __m256i three = _mm256_set1_epi8(3);
+
+	x = _mm256_sub_epi8(x, _mm256_and_si256(_mm256_cmpgt_epi8(x, one), three));
+	return _mm256_add_epi8(x, _mm256_and_si256(_mm256_cmpgt_epi8(minus_one, x), three));
+}
+
+// x in -q-q12...q+q12 to -q12...q12
+static inline __m256i Fq_freeze_x16(__m256i x)
+{
+	const __m256i qv = _mm256_set1_epi16(q);
+	const __m256i q12v = _mm256_set1_epi16(q12);
+	const __m256i minus_q12v = _mm256_set1_epi16(-q12);
+
+	x = _mm256_sub_epi16(x, _mm256_and_si256(_mm256_cmpgt_epi16(x, q12v), qv));
+	return _mm256_add_epi16(x, _mm256_and_si256(_mm256_cmpgt_epi16(minus_q12v, x), qv));
+}
+
+// Returns a*b*2^-16 mod q in -q...q (Montgomery multiplication) for a in -q12...q12
+// and b in -q...q; with b = c*2^16 mod q this is the product a*c mod q
+static inline __m256i Fq_montmul_x16(__m256i a, __m256i b)
+{
+	const __m256i qv = _mm256_set1_epi16(q);
+	const __m256i qinvv = _mm256_set1_epi16(qinv);
+
+	const __m256i hi = _mm256_mulhi_epi16(a, b);
+	const __m256i m = _mm256_mullo_epi16(_mm256_mullo_epi16(a, b), qinvv);
+	return _mm256_sub_epi16(hi, _mm256_mulhi_epi16(m, qv));
+}
+
+// Returns x*2^16 mod q
+static int16 Fq_montgomery(int16 x)
+{
+	return Fq_freeze(x * (int32)65536);
+}
+
+/* ----- small polynomials */
+
+void sntrup857_avx2_R3_mult(int8 *h, const int8 *f, const int8 *g)
+{
+	// f with 64 zero coefficients on both sides so that all
+	// products outside the range of f come out as zero
+	int16 fpad[64 + p + 64];
+	int16 fg[PRODUCT16];
+	int i, j, n;
+
+	memset(fpad, 0, sizeof(fpad));
+	for (i = 0; i < p; ++i) fpad[64 + i] = f[i];
+
+	// Coefficients n...n+63 of the product at a time; the sums
+	// can't exceed p in magnitude so they fit in 16 bits
+	for (n = 0; n < PRODUCT16; n += 64)
+	{
+		__m256i acc0 = _mm256_setzero_si256();
+		__m256i acc1 = _mm256_setzero_si256();
+		__m256i acc2 = _mm256_setzero_si256();
+		__m256i acc3 = _mm256_setzero_si256();
+
+		const int jlo = (n > p - 1) ? n - (p - 1) : 0;
+		const int jhi = (n + 63 < p - 1) ? n + 63 : p - 1;
+
+		for (j = jlo; j <= jhi; ++j)
+		{
+			const __m256i gj = _mm256_set1_epi16(g[j]);
+			const int16 *fj = fpad + 64 + n - j;
+
+			acc0 = _mm256_add_epi16(acc0, _mm256_sign_epi16(_mm256_loadu_si256((const __m256i*)fj), gj));
+			acc1 = _mm256_add_epi16(acc1, _mm256_sign_epi16(_mm256_loadu_si256((const __m256i*)(fj + 16)), gj));
+			acc2 = _mm256_add_epi16(acc2, _mm256_sign_epi16(_mm256_loadu_si256((const __m256i*)(fj + 32)), gj));
+			acc3 = _mm256_add_epi16(acc3, _mm256_sign_epi16(_mm256_loadu_si256((const __m256i*)(fj + 48)), gj));
+		}
+
+		_mm256_storeu_si256((__m256i*)(fg + n), acc0);
+		_mm256_storeu_si256((__m256i*)(fg + n + 16), acc1);
+		_mm256_storeu_si256((__m256i*)(fg + n + 32), acc2);
+		_mm256_storeu_si256((__m256i*)(fg + n + 48), acc3);
+	}
+
+	// Reduce mod x^p-x-1; the coefficients beyond p+p-2 are zero
+	h[0] = F3_freeze(fg[0] + fg[p]);
+	for (i = 1; i < p; ++i) h[i] = F3_freeze(fg[i] + fg[i + p] + fg[i + p - 1]);
+}
+
+int sntrup857_avx2_R3_recip(int8 *out, const int8 *in)
+{
+	// The padding beyond p stays zero throughout
+	int8 f[PADDED8], g[PADDED8], v[PADDED8], r[PADDED8];
+	int i, loop, delta;
+	int sign, swap;
+
+	memset(f, 0, sizeof(f));
+	memset(g, 0, sizeof(g));
+	memset(v, 0, sizeof(v));
+	memset(r, 0, sizeof(r));
+
+	r[0] = 1;
+	f[0] = 1; f[p - 1] = f[p] = -1;
+	for (i = 0; i < p; ++i) g[p - 1 - i] = in[i];
+
+	delta = 1;
+
+	for (loop = 0; loop < 2 * p - 1; ++loop)
+	{
+		memmove(v + 1, v, p);
+		v[0] = 0;
+
+		sign = -g[0] * f[0];
+		swap = int16_negative_mask(-delta) & int16_nonzero_mask(g[0]);
+		delta ^= swap & (delta ^ -delta);
+		delta += 1;
+
+		{
+			const __m256i swapv = _mm256_set1_epi8((char)swap);
+			const __m256i signv = _mm256_set1_epi8((char)sign);
+
+			for (i = 0; i < PADDED8; i += 32)
+			{
+				__m256i fv = _mm256_loadu_si256((const __m256i*)(f + i));
+				__m256i gv = _mm256_loadu_si256((const __m256i*)(g + i));
+				__m256i vv = _mm256_loadu_si256((const __m256i*)(v + i));
+				__m256i rv = _mm256_loadu_si256((const __m256i*)(r + i));
+
+				__m256i t = _mm256_and_si256(swapv, _mm256_xor_si256(fv, gv));
+				fv = _mm256_xor_si256(fv, t);
+				gv = _mm256_xor_si256(gv, t);
+
+				t = _mm256_and_si256(swapv, _mm256_xor_si256(vv, rv));
+				vv = _mm256_xor_si256(vv, t);
+				rv = _mm256_xor_si256(rv, t);
+
+				gv = F3_freeze_x32(_mm256_add_epi8(gv, _mm256_sign_epi8(fv, signv)));
+				rv = F3_freeze_x32(_mm256_add_epi8(rv, _mm256_sign_epi8(vv, signv)));
+
+				_mm256_storeu_si256((__m256i*)(f + i), fv);
+				_mm256_storeu_si256((__m256i*)(g + i), gv);
+				_mm256_storeu_si256((__m256i*)(v + i), vv);
+				_mm256_storeu_si256((__m256i*)(r + i), rv);
+			}
+		}
+
+		memmove(g, g + 1, p);
+		g[p] = 0;
+	}
+
+	sign = f[0];
+	for (i = 0; i < p; ++i) out[i] = sign * v[p - 1 - i];
+
+	return int16_nonzero_mask(delta);
+}
+
+/* ----- polynomials mod q */
+
+void sntrup857_avx2_Rq_mult_small(int16 *h, const int16 *f, const int8 *g)
+{
+	// f with 32 zero coefficients on both sides so that all
+	// products outside the range of f come out as zero
+	int32 fpad[32 + p + 32];
+	int32 fg[PRODUCT32];
+	int i, j, n;
+
+	memset(fpad, 0, sizeof(fpad));
+	for (i = 0; i < p; ++i) fpad[32 + i] = f[i];
+
+	// Coefficients n...n+31 of the product at a time; the sums
+	// can't exceed p*q12 in magnitude so they fit in 32 bits
+	// and only need to be reduced mod q at the end
+	for (n = 0; n < PRODUCT32; n += 32)
+	{
+		__m256i acc0 = _mm256_setzero_si256();
+		__m256i acc1 = _mm256_setzero_si256();
+		__m256i acc2 = _mm256_setzero_si256();
+		__m256i acc3 = _mm256_setzero_si256();
+
+		const int jlo = (n > p - 1) ? n - (p - 1) : 0;
+		const int jhi = (n + 31 < p - 1) ? n + 31 : p - 1;
+
+		for (j = jlo; j <= jhi; ++j)
+		{
+			const __m256i gj = _mm256_set1_epi32(g[j]);
+			const int32 *fj = fpad + 32 + n - j;
+
+			acc0 = _mm256_add_epi32(acc0, _mm256_sign_epi32(_mm256_loadu_si256((const __m256i*)fj), gj));
+			acc1 = _mm256_add_epi32(acc1, _mm256_sign_epi32(_mm256_loadu_si256((const __m256i*)(fj + 8)), gj));
+			acc2 = _mm256_add_epi32(acc2, _mm256_sign_epi32(_mm256_loadu_si256((const __m256i*)(fj + 16)), gj));
+			acc3 = _mm256_add_epi32(acc3, _mm256_sign_epi32(_mm256_loadu_si256((const __m256i*)(fj + 24)), gj));
+		}
+
+		_mm256_storeu_si256((__m256i*)(fg + n), acc0);
+		_mm256_storeu_si256((__m256i*)(fg + n + 8), acc1);
+		_mm256_storeu_si256((__m256i*)(fg + n + 16), acc2);
+		_mm256_storeu_si256((__m256i*)(fg + n + 24), acc3);
+	}
+
+	// Reduce mod x^p-x-1; the coefficients beyond p+p-2 are zero
+	h[0] = Fq_freeze(fg[0] + fg[p]);
+	for (i = 1; i < p; ++i) h[i] = Fq_freeze(fg[i] + fg[i + p] + fg[i + p - 1]);
+}
+
+int sntrup857_avx2_Rq_recip3(int16 *out, const int8 *in)
+{
+	// The padding beyond p stays zero throughout
+	int16 f[PADDED16], g[PADDED16], v[PADDED16], r[PADDED16];
+	int i, loop, delta;
+	int swap;
+	int16 scale;
+
+	memset(f, 0, sizeof(f));
+	memset(g, 0, sizeof(g));
+	memset(v, 0, sizeof(v));
+	memset(r, 0, sizeof(r));
+
+	r[0] = Fq_recip(3);
+	f[0] = 1; f[p - 1] = f[p] = -1;
+	for (i = 0; i < p; ++i) g[p - 1 - i] = in[i];
+
+	delta = 1;
+
+	for (loop = 0; loop < 2 * p - 1; ++loop)
+	{
+		memmove(v + 1, v, p * sizeof(int16));
+		v[0] = 0;
+
+		swap = int16_negative_mask(-delta) & int16_nonzero_mask(g[0]);
+		delta ^= swap & (delta ^ -delta);
+		delta += 1;
+
+		{
+			const __m256i swapv = _mm256_set1_epi16((short)swap);
+			__m256i f0v, g0v;
+
+			// f[0] and g[0] after the swap
+			const int16 f0 = f[0] ^ (swap & (f[0] ^ g[0]));
+			const int16 g0 = g[0] ^ (swap & (f[0] ^ g[0]));
+
+			f0v = _mm256_set1_epi16(Fq_montgomery(f0));
+			g0v = _mm256_set1_epi16(Fq_montgomery(g0));
+
+			for (i = 0; i < PADDED16; i += 16)
+			{
+				__m256i fv = _mm256_loadu_si256((const __m256i*)(f + i));
+				__m256i gv = _mm256_loadu_si256((const __m256i*)(g + i));
+				__m256i vv = _mm256_loadu_si256((const __m256i*)(v + i));
+				__m256i rv = _mm256_loadu_si256((const __m256i*)(r + i));
+
+				__m256i t = _mm256_and_si256(swapv, _mm256_xor_si256(fv, gv));
+				fv = _mm256_xor_si256(fv, t);
+				gv = _mm256_xor_si256(gv, t);
+
+				t = _mm256_and_si256(swapv, _mm256_xor_si256(vv, rv));
+				vv = _mm256_xor_si256(vv, t);
+				rv = _mm256_xor_si256(rv, t);
+
+				gv = Fq_freeze_x16(_mm256_sub_epi16(Fq_montmul_x16(gv, f0v), Fq_montmul_x16(fv, g0v)));
+				rv = Fq_freeze_x16(_mm256_sub_epi16(Fq_montmul_x16(rv, f0v), Fq_montmul_x16(vv, g0v)));
+
+				_mm256_storeu_si256((__m256i*)(f + i), fv);
+				_mm256_storeu_si256((__m256i*)(g + i), gv);
+				_mm256_storeu_si256((__m256i*)(v + i), vv);
+				_mm256_storeu_si256((__m256i*)(r + i), rv);
+			}
+		}
+
+		memmove(g, g + 1, p * sizeof(int16));
+		g[p] = 0;
+	}
+
+	scale = Fq_recip(f[0]);
+	for (i = 0; i < p; ++i) out[i] = Fq_freeze(scale * (int32)v[p - 1 - i]);
+
+	return int16_nonzero_mask(delta);
+}
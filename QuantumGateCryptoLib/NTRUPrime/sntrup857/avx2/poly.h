@@ -0,0 +1,27 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#ifndef SNTRUP857_AVX2_POLY_H
+#define SNTRUP857_AVX2_POLY_H
+
+#include "..\ref\int8.h"
+#include "..\ref\int16.h"
+
+// AVX2 versions of the polynomial arithmetic in ..\ref\kem.c; they produce exactly
+// the same results as the reference functions and also run in constant time.
+// Small polynomials have coefficients -1, 0 or 1 and polynomials mod q have
+// coefficients in the range -(q-1)/2...(q-1)/2, as in the reference code.
+
+// h = f*g in the ring R3
+void sntrup857_avx2_R3_mult(int8 *h, const int8 *f, const int8 *g);
+
+// out = 1/in in the ring R3; returns 0 if recip succeeded, else -1
+int sntrup857_avx2_R3_recip(int8 *out, const int8 *in);
+
+// h = f*g in the ring Rq
+void sntrup857_avx2_Rq_mult_small(int16 *h, const int16 *f, const int8 *g);
+
+// out = 1/(3*in) in Rq; returns 0 if recip succeeded, else -1
+int sntrup857_avx2_Rq_recip3(int16 *out, const int8 *in);
+
+#endif
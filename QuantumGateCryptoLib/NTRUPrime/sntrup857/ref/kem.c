@@ -20,6 +20,9 @@
 #include "Encode.h"
 #include "Decode.h"
 
+#include "..\..\..\Common\CPUSupport.h"
+#include "..\avx2\poly.h"
+
 #pragma warning (disable: 4146)
 
 /* ----- masks */
@@ -134,6 +137,11 @@ static void R3_mult(small *h,const small *f,const small *g)
   small result;
   int i,j;
 
+  if (QGCryptoIsAVX2Enabled()) {
+    sntrup857_avx2_R3_mult(h,f,g);
+    return;
+  }
+
   for (i = 0;i < p;++i) {
     result = 0;
     for (j = 0;j <= i;++j) result = F3_freeze(result+f[j]*g[i-j]);
@@ -159,6 +167,8 @@ static int R3_recip(small *out,const small *in)
   small f[p+1],g[p+1],v[p+1],r[p+1];
   int i,loop,delta;
   int sign,swap,t;
+
+  if (QGCryptoIsAVX2Enabled()) return sntrup857_avx2_R3_recip(out,in);
   
   for (i = 0;i < p+1;++i) v[i] = 0;
   for (i = 0;i < p+1;++i) r[i] = 0;
@@ -208,6 +218,11 @@ static void Rq_mult_small(Fq *h,const Fq *f,const small *g)
   Fq result;
   int i,j;
 
+  if (QGCryptoIsAVX2Enabled()) {
+    sntrup857_avx2_Rq_mult_small(h,f,g);
+    return;
+  }
+
   for (i = 0;i < p;++i) {
     result = 0;
     for (j = 0;j <= i;++j) result = Fq_freeze(result+f[j]*(int32)g[i-j]);
@@ -247,6 +262,8 @@ static int Rq_recip3(Fq *out,const small *in)
   int32 f0,g0;
   Fq scale;
 
+  if (QGCryptoIsAVX2Enabled()) return sntrup857_avx2_Rq_recip3(out,in);
+
   for (i = 0;i < p+1;++i) v[i] = 0;
   for (i = 0;i < p+1;++i) r[i] = 0;
   r[0] = Fq_recip(3);
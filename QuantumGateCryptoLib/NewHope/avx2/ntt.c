@@ -0,0 +1,171 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#include "ntt.h"
+
+#include <immintrin.h>
+
+#include "..\ref\params.h"
+
+// Coefficients get processed as eight 32-bit lanes so that all products and
+// sums wrap around in exactly the same way as the 32-bit reference arithmetic
+
+static inline __m256i load_x8(const uint16_t *a)
+{
+	return _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)a));
+}
+
+// Stores the lower 16 bits of each lane (the lanes must be in 0...65535)
+static inline void store_x8(uint16_t *a, __m256i x)
+{
+	x = _mm256_packus_epi32(x, x);
+	x = _mm256_permute4x64_epi64(x, 0x08);
+	_mm_storeu_si128((__m128i*)a, _mm256_castsi256_si128(x));
+}
+
+// Same as montgomery_reduce() in ..\ref\reduce.c
+static inline __m256i montgomery_reduce_x8(__m256i a)
+{
+	__m256i u = _mm256_mullo_epi32(a, _mm256_set1_epi32(12287));
+	u = _mm256_and_si256(u, _mm256_set1_epi32((1 << 18) - 1));
+	u = _mm256_mullo_epi32(u, _mm256_set1_epi32(NEWHOPE_Q));
+	return _mm256_srli_epi32(_mm256_add_epi32(a, u), 18);
+}
+
+// a % NEWHOPE_Q for a in 0...2^17; 5461/2^26 is slightly more than 1/NEWHOPE_Q
+// so that the quotient is at most one too large, which gets corrected afterwards
+static inline __m256i mod_q_x8(__m256i a)
+{
+	const __m256i qv = _mm256_set1_epi32(NEWHOPE_Q);
+
+	const __m256i quot = _mm256_srli_epi32(_mm256_mullo_epi32(a, _mm256_set1_epi32(5461)), 26);
+	const __m256i rem = _mm256_sub_epi32(a, _mm256_mullo_epi32(quot, qv));
+	return _mm256_add_epi32(rem, _mm256_and_si256(_mm256_cmpgt_epi32(_mm256_setzero_si256(), rem), qv));
+}
+
+// Butterflies for the top coefficients x and the bottom coefficients y using
+// twiddle factors w; on even levels the reduction of the sum is omitted (lazy)
+static inline void butterfly_x8(__m256i *x, __m256i *y, const __m256i w, const int odd)
+{
+	__m256i sum = _mm256_add_epi32(*x, *y);
+	if (odd) sum = mod_q_x8(sum);
+	else sum = _mm256_and_si256(sum, _mm256_set1_epi32(0xffff));
+
+	const __m256i diff = _mm256_sub_epi32(_mm256_add_epi32(*x, _mm256_set1_epi32(3 * NEWHOPE_Q)), *y);
+
+	*x = sum;
+	*y = montgomery_reduce_x8(_mm256_mullo_epi32(w, diff));
+}
+
+void newhope_avx2_ntt(uint16_t *a, const uint16_t *omega)
+{
+	int level, i, j, distance, odd;
+
+	for (level = 0; (1 << level) < NEWHOPE_N; ++level)
+	{
+		distance = (1 << level);
+		odd = (level & 1);
+
+		if (distance < 8)
+		{
+			// The butterflies of 16 coefficients at a time get rearranged so that
+			// the top coefficients end up in one vector and the bottom ones in another
+			for (i = 0; i < NEWHOPE_N; i += 16)
+			{
+				__m256i x = load_x8(a + i);
+				__m256i y = load_x8(a + i + 8);
+				__m256i top, bottom, w;
+
+				if (distance == 1)
+				{
+					const uint16_t *o = omega + i / 2;
+					w = _mm256_setr_epi32(o[0], o[1], o[4], o[5], o[2], o[3], o[6], o[7]);
+
+					x = _mm256_shuffle_epi32(x, 0xd8);
+					y = _mm256_shuffle_epi32(y, 0xd8);
+					top = _mm256_unpacklo_epi64(x, y);
+					bottom = _mm256_unpackhi_epi64(x, y);
+
+					butterfly_x8(&top, &bottom, w, odd);
+
+					x = _mm256_shuffle_epi32(_mm256_unpacklo_epi64(top, bottom), 0xd8);
+					y = _mm256_shuffle_epi32(_mm256_unpackhi_epi64(top, bottom), 0xd8);
+				}
+				else if (distance == 2)
+				{
+					const uint16_t *o = omega + i / 4;
+					w = _mm256_setr_epi32(o[0], o[0], o[2], o[2], o[1], o[1], o[3], o[3]);
+
+					top = _mm256_unpacklo_epi64(x, y);
+					bottom = _mm256_unpackhi_epi64(x, y);
+
+					butterfly_x8(&top, &bottom, w, odd);
+
+					x = _mm256_unpacklo_epi64(top, bottom);
+					y = _mm256_unpackhi_epi64(top, bottom);
+				}
+				else
+				{
+					const uint16_t *o = omega + i / 8;
+					w = _mm256_setr_epi32(o[0], o[0], o[0], o[0], o[1], o[1], o[1], o[1]);
+
+					top = _mm256_permute2x128_si256(x, y, 0x20);
+					bottom = _mm256_permute2x128_si256(x, y, 0x31);
+
+					butterfly_x8(&top, &bottom, w, odd);
+
+					x = _mm256_permute2x128_si256(top, bottom, 0x20);
+					y = _mm256_permute2x128_si256(top, bottom, 0x31);
+				}
+
+				store_x8(a + i, x);
+				store_x8(a + i + 8, y);
+			}
+		}
+		else
+		{
+			// All butterflies in a block of 2*distance
+			// coefficients use the same twiddle factor
+			for (i = 0; i < NEWHOPE_N / (2 * distance); ++i)
+			{
+				const __m256i w = _mm256_set1_epi32(omega[i]);
+				uint16_t *block = a + i * 2 * distance;
+
+				for (j = 0; j < distance; j += 8)
+				{
+					__m256i x = load_x8(block + j);
+					__m256i y = load_x8(block + j + distance);
+
+					butterfly_x8(&x, &y, w, odd);
+
+					store_x8(block + j, x);
+					store_x8(block + j + distance, y);
+				}
+			}
+		}
+	}
+}
+
+void newhope_avx2_mul_coefficients(uint16_t *poly, const uint16_t *factors)
+{
+	int i;
+
+	for (i = 0; i < NEWHOPE_N; i += 8)
+	{
+		const __m256i x = _mm256_mullo_epi32(load_x8(poly + i), load_x8(factors + i));
+		store_x8(poly + i, montgomery_reduce_x8(x));
+	}
+}
+
+void newhope_avx2_poly_mul_pointwise(uint16_t *r, const uint16_t *a, const uint16_t *b)
+{
+	const __m256i f = _mm256_set1_epi32(3186);
+	int i;
+
+	for (i = 0; i < NEWHOPE_N; i += 8)
+	{
+		// t is in Montgomery domain and the result is back in normal domain
+		const __m256i t = montgomery_reduce_x8(_mm256_mullo_epi32(f, load_x8(b + i)));
+		store_x8(r + i, montgomery_reduce_x8(_mm256_mullo_epi32(load_x8(a + i), t)));
+	}
+}
@@ -0,0 +1,17 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#ifndef NEWHOPE_AVX2_NTT_H
+#define NEWHOPE_AVX2_NTT_H
+
+#include <stdint.h>
+
+// AVX2 versions of the NTT and the pointwise multiplications in ..\ref; they
+// produce exactly the same results as the reference functions (including the
+// lazy reductions) and also run in constant time.
+
+void newhope_avx2_ntt(uint16_t *a, const uint16_t *omega);
+void newhope_avx2_mul_coefficients(uint16_t *poly, const uint16_t *factors);
+void newhope_avx2_poly_mul_pointwise(uint16_t *r, const uint16_t *a, const uint16_t *b);
+
+#endif
@@ -3,6 +3,9 @@
 #include "params.h"
 #include "reduce.h"
 
+#include "..\..\Common\CPUSupport.h"
+#include "..\avx2\ntt.h"
+
 #if (NEWHOPE_N == 512)
 /************************************************************
 * Name:        bitrev_table
@@ -112,6 +115,12 @@ void mul_coefficients(uint16_t* poly, const uint16_t* factors)
 {
     unsigned int i;
 
+    if (QGCryptoIsAVX2Enabled())
+    {
+      newhope_avx2_mul_coefficients(poly, factors);
+      return;
+    }
+
     for(i = 0; i < NEWHOPE_N; i++)
       poly[i] = montgomery_reduce((poly[i] * factors[i]));
 }
@@ -134,6 +143,11 @@ void ntt(uint16_t * a, const uint16_t* omega)
   int i, start, j, jTwiddle, distance;
   uint16_t temp, W;
 
+  if (QGCryptoIsAVX2Enabled())
+  {
+    newhope_avx2_ntt(a, omega);
+    return;
+  }
 
   for(i=0;i<9;i+=2)
   {
@@ -186,6 +200,11 @@ ntt(uint16_t * a, const uint16_t* omega)
   int i, start, j, jTwiddle, distance;
   uint16_t temp, W;
 
+  if (QGCryptoIsAVX2Enabled())
+  {
+    newhope_avx2_ntt(a, omega);
+    return;
+  }
 
   for(i=0;i<10;i+=2)
   {
@@ -3,6 +3,9 @@
 #include "reduce.h"
 #include "fips202.h"
 
+#include "..\..\Common\CPUSupport.h"
+#include "..\avx2\ntt.h"
+
 /*************************************************
 * Name:        coeff_freeze
 * 
@@ -331,6 +334,13 @@ void poly_mul_pointwise(poly *r, const poly *a, const poly *b)
 {
   int i;
   uint16_t t;
+
+  if (QGCryptoIsAVX2Enabled())
+  {
+    newhope_avx2_poly_mul_pointwise(r->coeffs, a->coeffs, b->coeffs);
+    return;
+  }
+
   for(i=0;i<NEWHOPE_N;i++)
   {
     t            = montgomery_reduce(3186*b->coeffs[i]); /* t is now in Montgomery domain */
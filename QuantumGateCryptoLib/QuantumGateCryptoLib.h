@@ -4,6 +4,7 @@
 #pragma once
 
 #include "Common\Random.h"
+#include "Common\CPUSupport.h"
 #include "McEliece\mceliece8192128\mceliece8192128.h"
 #include "NTRUPrime\sntrup857\ref\crypto_kem_sntrup857.h"
 #include "NewHope\ref\ccakem.h"
@@ -15,6 +16,8 @@ extern "C" {
 #endif
 	int halfsiphash(const uint8_t* in, const size_t inlen, const uint8_t* k,
 					uint8_t* out, const size_t outlen);
+	int halfsiphash_batch(const uint8_t* const* in, const size_t* inlen, const size_t num,
+						  const uint8_t* k, uint8_t* out);
 	int siphash(const uint8_t* in, const size_t inlen, const uint8_t* k,
 				uint8_t* out, const size_t outlen);
 #ifdef __cplusplus
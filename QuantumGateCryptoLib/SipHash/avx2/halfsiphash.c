@@ -0,0 +1,207 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#include "halfsiphash.h"
+
+#include <immintrin.h>
+#include <string.h>
+
+#define NUM_LANES 8
+
+static inline __m256i rotl_x8(const __m256i x, const int b)
+{
+	return _mm256_or_si256(_mm256_slli_epi32(x, b), _mm256_srli_epi32(x, 32 - b));
+}
+
+// Rotations by 8 and 16 bits move whole bytes and can be done with a single shuffle
+static inline __m256i rotl8_x8(const __m256i x)
+{
+	const __m256i idx = _mm256_setr_epi8(3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+										 3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+	return _mm256_shuffle_epi8(x, idx);
+}
+
+static inline __m256i rotl16_x8(const __m256i x)
+{
+	const __m256i idx = _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+										 2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+	return _mm256_shuffle_epi8(x, idx);
+}
+
+// Same as SIPROUND in ..\halfsiphash.c
+#define SIPROUND_X8                              \
+	do {                                         \
+		v0 = _mm256_add_epi32(v0, v1);           \
+		v1 = rotl_x8(v1, 5);                     \
+		v1 = _mm256_xor_si256(v1, v0);           \
+		v0 = rotl16_x8(v0);                      \
+		v2 = _mm256_add_epi32(v2, v3);           \
+		v3 = rotl8_x8(v3);                       \
+		v3 = _mm256_xor_si256(v3, v2);           \
+		v0 = _mm256_add_epi32(v0, v3);           \
+		v3 = rotl_x8(v3, 7);                     \
+		v3 = _mm256_xor_si256(v3, v0);           \
+		v2 = _mm256_add_epi32(v2, v1);           \
+		v1 = rotl_x8(v1, 13);                    \
+		v1 = _mm256_xor_si256(v1, v2);           \
+		v2 = rotl16_x8(v2);                      \
+	} while (0)
+
+// Compresses message word m of each lane into the state (cROUNDS = 2)
+#define COMPRESS_X8(m)                           \
+	do {                                         \
+		v3 = _mm256_xor_si256(v3, (m));          \
+		SIPROUND_X8;                             \
+		SIPROUND_X8;                             \
+		v0 = _mm256_xor_si256(v0, (m));          \
+	} while (0)
+
+static inline uint32_t load32_le(const uint8_t *p)
+{
+	uint32_t x;
+	memcpy(&x, p, sizeof(x));
+	return x;
+}
+
+// Transposes eight rows of eight 32-bit words so that
+// r[j] afterwards holds word j of each of the rows
+static inline void transpose_8x8(__m256i r[8])
+{
+	const __m256i t0 = _mm256_unpacklo_epi32(r[0], r[1]);
+	const __m256i t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+	const __m256i t2 = _mm256_unpacklo_epi32(r[2], r[3]);
+	const __m256i t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+	const __m256i t4 = _mm256_unpacklo_epi32(r[4], r[5]);
+	const __m256i t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+	const __m256i t6 = _mm256_unpacklo_epi32(r[6], r[7]);
+	const __m256i t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+
+	const __m256i s0 = _mm256_unpacklo_epi64(t0, t2);
+	const __m256i s1 = _mm256_unpackhi_epi64(t0, t2);
+	const __m256i s2 = _mm256_unpacklo_epi64(t1, t3);
+	const __m256i s3 = _mm256_unpackhi_epi64(t1, t3);
+	const __m256i s4 = _mm256_unpacklo_epi64(t4, t6);
+	const __m256i s5 = _mm256_unpackhi_epi64(t4, t6);
+	const __m256i s6 = _mm256_unpacklo_epi64(t5, t7);
+	const __m256i s7 = _mm256_unpackhi_epi64(t5, t7);
+
+	r[0] = _mm256_permute2x128_si256(s0, s4, 0x20);
+	r[1] = _mm256_permute2x128_si256(s1, s5, 0x20);
+	r[2] = _mm256_permute2x128_si256(s2, s6, 0x20);
+	r[3] = _mm256_permute2x128_si256(s3, s7, 0x20);
+	r[4] = _mm256_permute2x128_si256(s0, s4, 0x31);
+	r[5] = _mm256_permute2x128_si256(s1, s5, 0x31);
+	r[6] = _mm256_permute2x128_si256(s2, s6, 0x31);
+	r[7] = _mm256_permute2x128_si256(s3, s7, 0x31);
+}
+
+void halfsiphash_avx2_x8(const uint8_t *const *in, const size_t *inlen, const uint8_t *k, uint8_t *out)
+{
+	const uint32_t k0 = load32_le(k);
+	const uint32_t k1 = load32_le(k + 4);
+
+	__m256i v0 = _mm256_set1_epi32((int)k0);
+	__m256i v1 = _mm256_set1_epi32((int)k1);
+	__m256i v2 = _mm256_set1_epi32((int)(UINT32_C(0x6c796765) ^ k0));
+	__m256i v3 = _mm256_set1_epi32((int)(UINT32_C(0x74656462) ^ k1));
+
+	size_t nblocks[NUM_LANES];
+	uint32_t last[NUM_LANES];
+	size_t min_nblocks = SIZE_MAX;
+	size_t max_nblocks = 0;
+
+	for (int l = 0; l < NUM_LANES; ++l)
+	{
+		nblocks[l] = inlen[l] / sizeof(uint32_t);
+		if (nblocks[l] < min_nblocks) min_nblocks = nblocks[l];
+		if (nblocks[l] > max_nblocks) max_nblocks = nblocks[l];
+
+		// Last block with the remaining bytes and the length in the top byte
+		const uint8_t *tail = in[l] + nblocks[l] * sizeof(uint32_t);
+		uint32_t b = ((uint32_t)inlen[l]) << 24;
+		switch (inlen[l] & 3)
+		{
+			case 3:
+				b |= ((uint32_t)tail[2]) << 16;
+			case 2:
+				b |= ((uint32_t)tail[1]) << 8;
+			case 1:
+				b |= ((uint32_t)tail[0]);
+				break;
+			default:
+				break;
+		}
+		last[l] = b;
+	}
+
+	size_t i = 0;
+
+	// While all lanes have data, eight blocks of each lane get
+	// loaded at once and transposed so that each vector holds
+	// the same block of all of the messages
+	for (; i + NUM_LANES <= min_nblocks; i += NUM_LANES)
+	{
+		__m256i m[NUM_LANES];
+		for (int l = 0; l < NUM_LANES; ++l)
+		{
+			m[l] = _mm256_loadu_si256((const __m256i*)(in[l] + i * sizeof(uint32_t)));
+		}
+
+		transpose_8x8(m);
+
+		for (int j = 0; j < NUM_LANES; ++j)
+		{
+			COMPRESS_X8(m[j]);
+		}
+	}
+
+	// The remaining blocks and the last block of each message; lanes whose
+	// message is already done keep their state until all lanes are done
+	for (; i <= max_nblocks; ++i)
+	{
+		uint32_t m[NUM_LANES];
+		int32_t active[NUM_LANES];
+
+		for (int l = 0; l < NUM_LANES; ++l)
+		{
+			if (i < nblocks[l])
+			{
+				m[l] = load32_le(in[l] + i * sizeof(uint32_t));
+				active[l] = -1;
+			}
+			else if (i == nblocks[l])
+			{
+				m[l] = last[l];
+				active[l] = -1;
+			}
+			else
+			{
+				m[l] = 0;
+				active[l] = 0;
+			}
+		}
+
+		const __m256i mv = _mm256_loadu_si256((const __m256i*)m);
+		const __m256i mask = _mm256_loadu_si256((const __m256i*)active);
+
+		const __m256i p0 = v0, p1 = v1, p2 = v2, p3 = v3;
+
+		COMPRESS_X8(mv);
+
+		v0 = _mm256_blendv_epi8(p0, v0, mask);
+		v1 = _mm256_blendv_epi8(p1, v1, mask);
+		v2 = _mm256_blendv_epi8(p2, v2, mask);
+		v3 = _mm256_blendv_epi8(p3, v3, mask);
+	}
+
+	// Finalization for 4 byte output (dROUNDS = 4)
+	v2 = _mm256_xor_si256(v2, _mm256_set1_epi32(0xff));
+
+	SIPROUND_X8;
+	SIPROUND_X8;
+	SIPROUND_X8;
+	SIPROUND_X8;
+
+	// Lanes are stored in little endian order like U32TO8_LE
+	_mm256_storeu_si256((__m256i*)out, _mm256_xor_si256(v1, v3));
+}
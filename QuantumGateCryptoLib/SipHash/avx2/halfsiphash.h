@@ -0,0 +1,17 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#ifndef SIPHASH_AVX2_HALFSIPHASH_H
+#define SIPHASH_AVX2_HALFSIPHASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Computes the 4 byte HalfSipHash-2-4 of eight messages with the same key at once, one
+// message in each 32-bit lane. The messages may have different lengths; the outputs are
+// written one after the other to out (32 bytes) and are the same as those of halfsiphash()
+// in ..\halfsiphash.c.
+
+void halfsiphash_avx2_x8(const uint8_t *const *in, const size_t *inlen, const uint8_t *k, uint8_t *out);
+
+#endif
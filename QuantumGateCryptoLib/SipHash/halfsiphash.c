@@ -19,6 +19,9 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "..\Common\CPUSupport.h"
+#include "avx2\halfsiphash.h"
+
 /* default: SipHash-2-4 */
 #ifndef cROUNDS
     #define cROUNDS 2
@@ -149,3 +152,44 @@ int halfsiphash(const uint8_t *in, const size_t inlen, const uint8_t *k,
 
     return 0;
 }
+
+/*
+   Computes the 4 byte halfsiphash of num messages with the same key and
+   writes the outputs one after the other to out (num * 4 bytes). Groups of
+   messages get hashed together with the AVX2 implementation when the CPU
+   supports it; in the last group the lanes without a message get empty
+   messages.
+ */
+int halfsiphash_batch(const uint8_t *const *in, const size_t *inlen,
+                      const size_t num, const uint8_t *k, uint8_t *out) {
+
+    size_t i = 0;
+
+    if (QGCryptoIsAVX2Enabled()) {
+        for (; i + 8 <= num; i += 8)
+            halfsiphash_avx2_x8(in + i, inlen + i, k, out + i * 4);
+
+        /* Hashing a partly filled group is still faster than
+           hashing two or more messages one after the other */
+        if (num - i > 1) {
+            const uint8_t *pin[8];
+            size_t pinlen[8];
+            uint8_t pout[8 * 4];
+            size_t j;
+
+            for (j = 0; j < 8; ++j) {
+                pin[j] = (i + j < num) ? in[i + j] : in[i];
+                pinlen[j] = (i + j < num) ? inlen[i + j] : 0;
+            }
+
+            halfsiphash_avx2_x8(pin, pinlen, k, pout);
+            memcpy(out + i * 4, pout, (num - i) * 4);
+            i = num;
+        }
+    }
+
+    for (; i < num; ++i)
+        halfsiphash(in[i], inlen[i], k, out + i * 4, 4);
+
+    return 0;
+}
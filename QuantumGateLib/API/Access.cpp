@@ -37,6 +37,12 @@ namespace QuantumGate::API::Access
 		return m_AccessManager->AddIPFilter(ip, mask, type);
 	}
 
+	Result<Vector<IPFilterID>> Manager::AddIPFilters(const Vector<String>& ip_cidrs,
+													 const IPFilterType type) noexcept
+	{
+		return m_AccessManager->AddIPFilters(ip_cidrs, type);
+	}
+
 	Result<> Manager::RemoveIPFilter(const IPFilterID filterid, const IPFilterType type) noexcept
 	{
 		return m_AccessManager->RemoveIPFilter(filterid, type);
@@ -280,6 +280,11 @@ namespace QuantumGate::API
 		return m_Local->GetUUID();
 	}
 
+	Result<KeyGenerationStatistics> Local::GetKeyGenerationStatistics() const noexcept
+	{
+		return m_Local->GetKeyGenerationStatistics();
+	}
+
 	Result<Peer> Local::GetPeer(const PeerLUID pluid) const noexcept
 	{
 		return m_Local->GetPeer(pluid);
@@ -129,6 +129,8 @@ namespace QuantumGate::API
 
 		Result<PeerUUID> GetUUID() const noexcept;
 
+		Result<KeyGenerationStatistics> GetKeyGenerationStatistics() const noexcept;
+
 		Result<Peer> GetPeer(const PeerLUID pluid) const noexcept;
 
 		Result<Vector<PeerLUID>> QueryPeers(const PeerQueryParameters& params) const noexcept;
@@ -59,6 +59,17 @@ namespace QuantumGate::Implementation
 			return GetHash(buffer, BufferView(reinterpret_cast<const Byte*>(&m_PersistentKey), sizeof(m_PersistentKey)));
 		}
 
+		// Chooses one of 2^NumShardBits shards for a hash from std::hash, such as for
+		// spreading a map over several separately locked maps. The top bits of the hash
+		// are used because the maps within the shards choose their buckets with the bottom bits.
+		template<Size NumShardBits>
+		[[nodiscard]] inline static constexpr Size GetShardIndex(const std::size_t hash) noexcept
+		{
+			static_assert(NumShardBits > 0 && NumShardBits < sizeof(hash) * 8, "Invalid number of shard bits");
+
+			return static_cast<Size>(hash >> (sizeof(hash) * 8 - NumShardBits));
+		}
+
 		inline static UInt64 GetHash(const BufferView& buffer, const BufferView& key) noexcept
 		{
 			assert(key.GetSize() == m_KeySize);
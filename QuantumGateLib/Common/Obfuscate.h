@@ -13,6 +13,10 @@
 #include <random>
 #endif
 
+#include "..\..\QuantumGateCryptoLib\Common\CPUSupport.h"
+
+#include <immintrin.h>
+
 namespace QuantumGate::Implementation
 {
 	class Obfuscate final
@@ -49,9 +53,16 @@ namespace QuantumGate::Implementation
 
 			auto data64 = reinterpret_cast<UInt64*>(data.GetBytes());
 
-			for (Size i = 0; i < len; ++i)
+			Size x{ 0 };
+
+			if (len >= keys.size() && QGCryptoIsAVX2Enabled())
+			{
+				x = XorAVX2(data64, len, keys);
+			}
+
+			for (; x < len; ++x)
 			{
-				data64[i] = data64[i] ^ keys[i % keys.size()];
+				data64[x] = data64[x] ^ keys[x % keys.size()];
 			}
 
 			const auto idx = len % keys.size();
@@ -68,5 +79,25 @@ namespace QuantumGate::Implementation
 		{
 			Do(data, key, iv);
 		}
+
+	private:
+		// XORs whole repetitions of the keys (64 bytes) with the data, two 256-bit
+		// vectors at a time; returns the number of 64-bit words that were done
+		inline static Size XorAVX2(UInt64* data64, const Size len, const std::array<UInt64, 8>& keys) noexcept
+		{
+			const auto k0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys.data()));
+			const auto k1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys.data() + 4));
+
+			const auto num = len - (len % keys.size());
+
+			for (Size i = 0; i < num; i += keys.size())
+			{
+				const auto d = reinterpret_cast<__m256i*>(data64 + i);
+				_mm256_storeu_si256(d, _mm256_xor_si256(_mm256_loadu_si256(d), k0));
+				_mm256_storeu_si256(d + 1, _mm256_xor_si256(_mm256_loadu_si256(d + 1), k1));
+			}
+
+			return num;
+		}
 	};
 }
\ No newline at end of file
@@ -16,26 +16,32 @@ namespace QuantumGate::Implementation
 	{
 		if (count == 0) return Buffer();
 
-		GetRngEngine().CheckSeed64(count);
+		Buffer bytes(count);
+		BufferSpan bytes_span(bytes);
+		GetPseudoRandomBytes(bytes_span);
 
-		// How many 64bit integers do we need for the number of requested bytes?
-		const auto num = static_cast<Size>(std::ceil(static_cast<double>(count) /
-													 static_cast<double>(sizeof(UInt64))));
+		return bytes;
+	}
 
-		assert(count <= (num * sizeof(UInt64)));
+	void Random::GetPseudoRandomBytes(BufferSpan& bytes) noexcept
+	{
+		if (bytes.GetSize() == 0) return;
 
-		Buffer bytes(num * sizeof(UInt64));
-		auto uint64_ptr = reinterpret_cast<UInt64*>(bytes.GetBytes());
+		GetRngEngine().CheckSeed64(bytes.GetSize());
 
-		// Generate random 64bit integers
-		std::generate(uint64_ptr, uint64_ptr + num,
-					  [&]() -> UInt64
+		auto dest = bytes.GetBytes();
+		auto remaining = bytes.GetSize();
+
+		// Generate random 64bit integers directly into the destination
+		while (remaining > 0)
 		{
-			return (GetRngEngine().Rng64)();
-		});
+			const UInt64 rnd = (GetRngEngine().Rng64)();
+			const auto len = std::min(remaining, sizeof(UInt64));
 
-		bytes.Resize(count);
+			std::memcpy(dest, &rnd, len);
 
-		return bytes;
+			dest += len;
+			remaining -= len;
+		}
 	}
 }
\ No newline at end of file
@@ -92,6 +92,7 @@ namespace QuantumGate::Implementation
 		}
 
 		static Buffer GetPseudoRandomBytes(const Size count);
+		static void GetPseudoRandomBytes(BufferSpan& bytes) noexcept;
 
 	private:
 		ForceInline static RngEngine& GetRngEngine() noexcept
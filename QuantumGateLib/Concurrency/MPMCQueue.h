@@ -0,0 +1,221 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#pragma once
+
+#include "Event.h"
+#include "CriticalSection.h"
+#include "WaitableCounter.h"
+#include "..\Common\Containers.h"
+
+#include <optional>
+
+namespace QuantumGate::Implementation::Concurrency
+{
+	// Multiple producer, multiple consumer queue built on a bounded lock-free
+	// ring buffer (as described by Dmitry Vyukov). Producers and consumers
+	// only contend on an atomic position per end of the ring. Should the ring
+	// fill up, elements spill over into a locked overflow queue so that Push()
+	// never fails. Elements are popped roughly in the order they were pushed,
+	// but there is no ordering guarantee, not even for the elements of any one
+	// producer: with several consumers a later element can be handed out
+	// before an earlier one, and when the ring fills up or drains elements
+	// can pass each other between the ring and the overflow queue.
+	//
+	// Unlike Queue, consumers claim an element before they get to see it,
+	// so there is no PopFrontIf(); PopFront() hands the claimed element to
+	// the function and always removes it.
+	template<typename T, Size Capacity = 1024>
+	class MPMCQueue final
+	{
+		static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity should be a power of two.");
+		static_assert(std::is_nothrow_move_constructible_v<T>, "Elements should be nothrow move constructible.");
+
+		struct Cell final
+		{
+			std::atomic<Size> Sequence{ 0 };
+			std::optional<T> Value;
+		};
+
+		using OverflowQueueType = Containers::Queue<T>;
+		using LockGuardType = std::lock_guard<CriticalSection>;
+
+		static constexpr Size Mask{ Capacity - 1 };
+
+	public:
+		MPMCQueue() :
+			m_Cells(std::make_unique<Cell[]>(Capacity))
+		{
+			for (Size x = 0; x < Capacity; ++x)
+			{
+				m_Cells[x].Sequence.store(x, std::memory_order_relaxed);
+			}
+		}
+
+		MPMCQueue(const MPMCQueue&) = delete;
+		MPMCQueue(MPMCQueue&&) = delete;
+		~MPMCQueue() = default;
+		MPMCQueue& operator=(const MPMCQueue&) = delete;
+		MPMCQueue& operator=(MPMCQueue&&) = delete;
+
+		[[nodiscard]] inline bool IsEmpty() const noexcept
+		{
+			return (GetSize() == 0);
+		}
+
+		[[nodiscard]] inline Size GetSize() const noexcept
+		{
+			const auto dpos = m_DequeuePosition.load(std::memory_order_acquire);
+			const auto epos = m_EnqueuePosition.load(std::memory_order_acquire);
+
+			// Positions are read separately, so dequeue may have moved past
+			// the enqueue position we read
+			const auto ring_size = (epos > dpos) ? (epos - dpos) : 0;
+
+			return ring_size + m_OverflowSize.load(std::memory_order_acquire);
+		}
+
+		[[nodiscard]] static constexpr Size GetCapacity() noexcept { return Capacity; }
+
+		inline void Clear() noexcept
+		{
+			while (PopFront([](T&) noexcept {})) {}
+		}
+
+		template<typename F> requires std::is_invocable_v<F, T&>
+		inline bool PopFront(F&& function) noexcept(noexcept(function(std::declval<T&>())))
+		{
+			if (TryPopRing(function)) return true;
+
+			if (m_OverflowSize.load(std::memory_order_acquire) > 0)
+			{
+				LockGuardType lock(m_OverflowCriticalSection);
+
+				if (!m_OverflowQueue.empty())
+				{
+					function(m_OverflowQueue.front());
+					m_OverflowQueue.pop();
+					m_OverflowSize.fetch_sub(1, std::memory_order_release);
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		inline void Push(const T& element)
+		{
+			// Copy first so that a throwing copy can't leave a claimed cell behind
+			T copy(element);
+			Push(std::move(copy));
+		}
+
+		inline void Push(T&& element)
+		{
+			if (m_OverflowSize.load(std::memory_order_acquire) > 0 || !TryPushRing(element))
+			{
+				LockGuardType lock(m_OverflowCriticalSection);
+				m_OverflowQueue.push(std::move(element));
+				m_OverflowSize.fetch_add(1, std::memory_order_release);
+			}
+
+			m_WaitCounter.NotifyOne();
+		}
+
+		inline void InterruptWait() const noexcept
+		{
+			m_WaitCounter.NotifyAll();
+		}
+
+		inline bool Wait(const std::chrono::milliseconds time, const Event& interrupt_event) const noexcept
+		{
+			return m_WaitCounter.Wait(time, [&]() noexcept
+			{
+				return (!IsEmpty() || interrupt_event.IsSet());
+			});
+		}
+
+		inline bool Wait(const Event& interrupt_event) const noexcept
+		{
+			return m_WaitCounter.Wait([&]() noexcept
+			{
+				return (!IsEmpty() || interrupt_event.IsSet());
+			});
+		}
+
+	private:
+		[[nodiscard]] bool TryPushRing(T& element) noexcept
+		{
+			Cell* cell{ nullptr };
+			auto pos = m_EnqueuePosition.load(std::memory_order_relaxed);
+
+			while (true)
+			{
+				cell = &m_Cells[pos & Mask];
+				const auto seq = cell->Sequence.load(std::memory_order_acquire);
+				const auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+
+				if (diff == 0)
+				{
+					if (m_EnqueuePosition.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+				}
+				else if (diff < 0) return false; // Full
+				else pos = m_EnqueuePosition.load(std::memory_order_relaxed);
+			}
+
+			cell->Value.emplace(std::move(element));
+			cell->Sequence.store(pos + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		template<typename F>
+		[[nodiscard]] bool TryPopRing(F& function) noexcept(noexcept(function(std::declval<T&>())))
+		{
+			Cell* cell{ nullptr };
+			auto pos = m_DequeuePosition.load(std::memory_order_relaxed);
+
+			while (true)
+			{
+				cell = &m_Cells[pos & Mask];
+				const auto seq = cell->Sequence.load(std::memory_order_acquire);
+				const auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+
+				if (diff == 0)
+				{
+					if (m_DequeuePosition.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+				}
+				else if (diff < 0) return false; // Empty
+				else pos = m_DequeuePosition.load(std::memory_order_relaxed);
+			}
+
+			// Release the cell even if the function throws
+			auto sg = MakeScopeGuard([&]() noexcept
+			{
+				cell->Value.reset();
+				cell->Sequence.store(pos + Capacity, std::memory_order_release);
+			});
+
+			function(*cell->Value);
+
+			return true;
+		}
+
+	private:
+		std::unique_ptr<Cell[]> m_Cells;
+
+		// Producers and consumers each work on their own position;
+		// the padding keeps them from sharing a cache line
+		[[maybe_unused]] Byte m_Padding1[64]{};
+		std::atomic<Size> m_EnqueuePosition{ 0 };
+		[[maybe_unused]] Byte m_Padding2[64]{};
+		std::atomic<Size> m_DequeuePosition{ 0 };
+		[[maybe_unused]] Byte m_Padding3[64]{};
+
+		std::atomic<Size> m_OverflowSize{ 0 };
+		OverflowQueueType m_OverflowQueue;
+		mutable CriticalSection m_OverflowCriticalSection;
+
+		mutable WaitableCounter m_WaitCounter;
+	};
+}
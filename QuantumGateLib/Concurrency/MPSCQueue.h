@@ -0,0 +1,189 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#pragma once
+
+#include "Event.h"
+#include "WaitableCounter.h"
+#include "..\Memory\Allocator.h"
+
+#include <optional>
+
+namespace QuantumGate::Implementation::Concurrency
+{
+	// Unbounded lock-free multiple producer, single consumer queue (intrusive
+	// linked list with a stub node as described by Dmitry Vyukov). Pushing is
+	// wait-free; PopFrontIf() and Clear() may only be called from one consumer
+	// thread at a time. An element that's still being linked by a producer
+	// that got preempted is not visible to the consumer until the producer
+	// finishes, which also holds back the elements pushed after it.
+	template<typename T>
+	class MPSCQueue final
+	{
+		struct Node final
+		{
+			std::atomic<Node*> Next{ nullptr };
+			std::optional<T> Value;
+		};
+
+		using NodeAllocator = Memory::DefaultAllocator<Node>;
+
+	public:
+		MPSCQueue()
+		{
+			m_Tail = AllocateNode();
+			m_Head.store(m_Tail, std::memory_order_relaxed);
+		}
+
+		MPSCQueue(const MPSCQueue&) = delete;
+		MPSCQueue(MPSCQueue&&) = delete;
+		MPSCQueue& operator=(const MPSCQueue&) = delete;
+		MPSCQueue& operator=(MPSCQueue&&) = delete;
+
+		~MPSCQueue()
+		{
+			auto node = m_Tail;
+			while (node != nullptr)
+			{
+				auto next = node->Next.load(std::memory_order_relaxed);
+				FreeNode(node);
+				node = next;
+			}
+		}
+
+		[[nodiscard]] inline bool IsEmpty() const noexcept
+		{
+			return (m_Size.load(std::memory_order_acquire) == 0);
+		}
+
+		[[nodiscard]] inline Size GetSize() const noexcept
+		{
+			return m_Size.load(std::memory_order_acquire);
+		}
+
+		inline void Clear() noexcept
+		{
+			while (PopFront()) {}
+		}
+
+		template<typename F> requires std::is_same_v<std::invoke_result_t<F, T&>, bool>
+		inline void PopFrontIf(F&& function) noexcept(noexcept(function(std::declval<T&>())))
+		{
+			auto tail = m_Tail;
+			auto next = tail->Next.load(std::memory_order_acquire);
+			if (next != nullptr)
+			{
+				if (function(*next->Value))
+				{
+					// The next node becomes the new stub
+					m_Tail = next;
+					next->Value.reset();
+					m_Size.fetch_sub(1, std::memory_order_release);
+
+					FreeNode(tail);
+				}
+			}
+		}
+
+		inline void Push(const T& element)
+		{
+			PushNode(AllocateNode(element));
+		}
+
+		template<typename F>
+		inline void Push(const T& element, F&& function)
+		{
+			PushNode(AllocateNode(element));
+			function();
+		}
+
+		inline void Push(T&& element)
+		{
+			PushNode(AllocateNode(std::move(element)));
+		}
+
+		template<typename F>
+		inline void Push(T&& element, F&& function)
+		{
+			PushNode(AllocateNode(std::move(element)));
+			function();
+		}
+
+		inline void InterruptWait() const noexcept
+		{
+			m_WaitCounter.NotifyAll();
+		}
+
+		inline bool Wait(const std::chrono::milliseconds time, const Event& interrupt_event) const noexcept
+		{
+			return m_WaitCounter.Wait(time, [&]() noexcept
+			{
+				return (!IsEmpty() || interrupt_event.IsSet());
+			});
+		}
+
+		inline bool Wait(const Event& interrupt_event) const noexcept
+		{
+			return m_WaitCounter.Wait([&]() noexcept
+			{
+				return (!IsEmpty() || interrupt_event.IsSet());
+			});
+		}
+
+	private:
+		template<typename... Args>
+		[[nodiscard]] Node* AllocateNode(Args&&... args)
+		{
+			NodeAllocator allocator;
+			auto node = allocator.allocate(1);
+
+			try
+			{
+				std::construct_at(node);
+				if constexpr (sizeof...(Args) > 0)
+				{
+					node->Value.emplace(std::forward<Args>(args)...);
+				}
+			}
+			catch (...)
+			{
+				std::destroy_at(node);
+				allocator.deallocate(node, 1);
+				throw;
+			}
+
+			return node;
+		}
+
+		void FreeNode(Node* node) noexcept
+		{
+			std::destroy_at(node);
+			NodeAllocator().deallocate(node, 1);
+		}
+
+		void PushNode(Node* node) noexcept
+		{
+			const auto prev = m_Head.exchange(node, std::memory_order_acq_rel);
+			prev->Next.store(node, std::memory_order_release);
+			m_Size.fetch_add(1, std::memory_order_release);
+
+			m_WaitCounter.NotifyOne();
+		}
+
+		[[nodiscard]] bool PopFront() noexcept
+		{
+			auto popped = false;
+			PopFrontIf([&](T&) noexcept { popped = true; return true; });
+			return popped;
+		}
+
+	private:
+		// Producers and the consumer work on different ends of the queue;
+		// the padding keeps them from sharing a cache line
+		std::atomic<Node*> m_Head{ nullptr };
+		[[maybe_unused]] Byte m_Padding[64]{};
+		Node* m_Tail{ nullptr };
+		std::atomic<Size> m_Size{ 0 };
+		mutable WaitableCounter m_WaitCounter;
+	};
+}
@@ -0,0 +1,384 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#pragma once
+
+#include <mutex>
+#include <chrono>
+
+#include "Event.h"
+#include "..\Common\Containers.h"
+
+namespace QuantumGate::Implementation::Concurrency
+{
+	// The reactor keeps track of a (potentially very large) set of handles and
+	// reports which of them became ready, by key, so that the waiting thread can
+	// sleep until there is actual I/O instead of polling every object. Handles get
+	// registered with the system thread pool wait facility (which doesn't have the
+	// MAXIMUM_WAIT_OBJECTS limitation for the caller). Handles are level triggered;
+	// a handle that is still signaled after it was reported will get reported again
+	// on the next wait. In-process sources can signal readiness directly using
+	// Notify(). Keys may be reported more than once for a single wait.
+	class Reactor final
+	{
+	public:
+		using HandleType = Event::HandleType;
+		using Key = UInt64;
+		using ReadyKeys = Vector<Key>;
+
+		struct WaitResult final
+		{
+			bool Waited{ false };
+			bool HadEvent{ false };
+
+			// Set when readiness information got lost (due to a memory
+			// allocation failure); the caller should treat all keys as ready
+			bool Overflow{ false };
+		};
+
+	private:
+		using LockGuardType = std::lock_guard<std::mutex>;
+
+		struct Registration final
+		{
+			Reactor* Owner{ nullptr };
+			HandleType Handle{};
+			Reactor::Key Key{ 0 };
+			HANDLE WaitHandle{ nullptr };
+			bool Fired{ false };
+			Registration* NextFired{ nullptr };
+		};
+
+		using RegistrationMap = Containers::UnorderedMap<HandleType, std::unique_ptr<Registration>>;
+
+	public:
+		Reactor() noexcept {}
+		Reactor(const Reactor&) = delete;
+		Reactor(Reactor&&) = delete;
+		~Reactor() { Deinitialize(); }
+		Reactor& operator=(const Reactor&) = delete;
+		Reactor& operator=(Reactor&&) = delete;
+
+		[[nodiscard]] bool Initialize() noexcept
+		{
+			LockGuardType lock(m_Mutex);
+
+			assert(!m_Initialized);
+
+			m_WakeEvent.Reset();
+			m_Initialized = true;
+			return true;
+		}
+
+		void Deinitialize() noexcept
+		{
+			if (!m_Initialized) return;
+
+			RemoveAll();
+
+			LockGuardType lock(m_Mutex);
+
+			m_ReadyKeys.clear();
+			m_Overflow = false;
+
+			m_Initialized = false;
+		}
+
+		[[nodiscard]] inline bool IsInitialized() const noexcept { return m_Initialized; }
+
+		[[nodiscard]] bool Add(const HandleType handle, const Key key) noexcept
+		{
+			assert(m_Initialized);
+
+			try
+			{
+				LockGuardType lock(m_Mutex);
+
+				if (m_Registrations.find(handle) != m_Registrations.end())
+				{
+					LogErr(L"Couldn't add handle to reactor; the handle was already added");
+					return false;
+				}
+
+				auto reg = std::make_unique<Registration>();
+				reg->Owner = this;
+				reg->Handle = handle;
+				reg->Key = key;
+
+				auto& regref = *reg;
+
+				const auto [it, inserted] = m_Registrations.emplace(handle, std::move(reg));
+				if (inserted)
+				{
+					if (Arm(regref)) return true;
+
+					m_Registrations.erase(it);
+				}
+			}
+			catch (const std::exception& e)
+			{
+				LogErr(L"Couldn't add handle to reactor due to exception: %s",
+					   Util::ToStringW(e.what()).c_str());
+			}
+			catch (...) {}
+
+			return false;
+		}
+
+		void Remove(const HandleType handle) noexcept
+		{
+			std::unique_ptr<Registration> reg;
+
+			{
+				LockGuardType lock(m_Mutex);
+
+				const auto it = m_Registrations.find(handle);
+				if (it == m_Registrations.end())
+				{
+					LogErr(L"Couldn't remove handle from reactor; the handle wasn't found");
+					return;
+				}
+
+				reg = std::move(it->second);
+				m_Registrations.erase(it);
+
+				UnlinkFired(*reg);
+			}
+
+			Disarm(*reg);
+		}
+
+		void RemoveAll() noexcept
+		{
+			RegistrationMap registrations;
+
+			{
+				LockGuardType lock(m_Mutex);
+
+				registrations.swap(m_Registrations);
+
+				for (auto& reg : registrations)
+				{
+					UnlinkFired(*reg.second);
+				}
+			}
+
+			for (auto& reg : registrations)
+			{
+				Disarm(*reg.second);
+			}
+		}
+
+		[[nodiscard]] bool Has(const HandleType handle) const noexcept
+		{
+			LockGuardType lock(m_Mutex);
+			return (m_Registrations.find(handle) != m_Registrations.end());
+		}
+
+		[[nodiscard]] Size GetSize() const noexcept
+		{
+			LockGuardType lock(m_Mutex);
+			return m_Registrations.size();
+		}
+
+		// Signals readiness for an in-process source that
+		// doesn't have (or need) a registered handle
+		void Notify(const Key key) noexcept
+		{
+			{
+				LockGuardType lock(m_Mutex);
+
+				try
+				{
+					m_ReadyKeys.emplace_back(key);
+				}
+				catch (...)
+				{
+					m_Overflow = true;
+				}
+			}
+
+			Wake();
+		}
+
+		// Wakes up a waiting thread without reporting any keys
+		inline void Interrupt() noexcept { Wake(); }
+
+		// Waits at most max_wait_time for any registered handle to become ready; the keys
+		// of ready handles and notified keys are returned in ready_keys which gets cleared first
+		WaitResult Wait(const std::chrono::milliseconds max_wait_time, ReadyKeys& ready_keys) noexcept
+		{
+			WaitResult result;
+
+			ready_keys.clear();
+
+			if (!m_Initialized) return result;
+
+			// Handles that were reported during the previous wait get rearmed
+			// now that the caller had the chance to process them
+			RearmFired();
+
+			result.Waited = true;
+
+			if (m_WakeEvent.Wait(max_wait_time))
+			{
+				LockGuardType lock(m_Mutex);
+
+				// Reset while holding the lock so that a key that gets added
+				// after we collected the ready keys sets the event again
+				m_WakeEvent.Reset();
+
+				CollectReadyKeys(ready_keys, result);
+
+				result.HadEvent = (!ready_keys.empty() || result.Overflow);
+			}
+			return result;
+		}
+
+	private:
+		void Wake() noexcept
+		{
+			m_WakeEvent.Set();
+		}
+
+		void CollectReadyKeys(ReadyKeys& ready_keys, WaitResult& result) noexcept
+		{
+			// Swapping doesn't allocate and hands the (cleared)
+			// capacity of the caller's vector back to us for reuse
+			ready_keys.swap(m_ReadyKeys);
+			result.Overflow = std::exchange(m_Overflow, false);
+		}
+
+		static void CALLBACK OnHandleSignaled(PVOID context, BOOLEAN timed_out) noexcept
+		{
+			auto reg = static_cast<Registration*>(context);
+			reg->Owner->OnHandleSignaled(*reg);
+		}
+
+		void OnHandleSignaled(Registration& reg) noexcept
+		{
+			{
+				LockGuardType lock(m_Mutex);
+
+				// The wait was registered to execute only once; the
+				// registration gets rearmed during the next wait
+				assert(!reg.Fired);
+				reg.Fired = true;
+				reg.NextFired = std::exchange(m_FiredHead, &reg);
+
+				try
+				{
+					m_ReadyKeys.emplace_back(reg.Key);
+				}
+				catch (...)
+				{
+					m_Overflow = true;
+				}
+			}
+
+			Wake();
+		}
+
+		[[nodiscard]] bool Arm(Registration& reg) noexcept
+		{
+			assert(reg.WaitHandle == nullptr);
+
+			if (::RegisterWaitForSingleObject(&reg.WaitHandle, reg.Handle, &Reactor::OnHandleSignaled, &reg,
+											  INFINITE, WT_EXECUTEINWAITTHREAD | WT_EXECUTEONLYONCE))
+			{
+				return true;
+			}
+
+			reg.WaitHandle = nullptr;
+
+			LogErr(L"Couldn't register wait for reactor handle (%s)", GetLastSysErrorString().c_str());
+
+			return false;
+		}
+
+		void Disarm(Registration& reg) noexcept
+		{
+			if (reg.WaitHandle != nullptr)
+			{
+				// Blocks until a callback that may be in progress has completed;
+				// must not be called while holding the mutex since the callback
+				// needs it
+				::UnregisterWaitEx(reg.WaitHandle, INVALID_HANDLE_VALUE);
+				reg.WaitHandle = nullptr;
+			}
+
+			// The callback may have fired again before it
+			// got unregistered so we make sure it's unlinked
+			LockGuardType lock(m_Mutex);
+			UnlinkFired(reg);
+		}
+
+		void RearmFired() noexcept
+		{
+			LockGuardType lock(m_Mutex);
+
+			while (m_FiredHead != nullptr)
+			{
+				auto& reg = *std::exchange(m_FiredHead, m_FiredHead->NextFired);
+				reg.NextFired = nullptr;
+				reg.Fired = false;
+
+				// The callback already executed so this doesn't block
+				::UnregisterWaitEx(reg.WaitHandle, nullptr);
+				reg.WaitHandle = nullptr;
+
+				if (!Arm(reg))
+				{
+					// Keep reporting the handle as ready so that
+					// it at least still gets looked at by the caller
+					reg.Fired = true;
+					reg.NextFired = m_FiredHead;
+
+					try
+					{
+						m_ReadyKeys.emplace_back(reg.Key);
+					}
+					catch (...)
+					{
+						m_Overflow = true;
+					}
+
+					// Try again during the next wait
+					m_FiredHead = &reg;
+					m_WakeEvent.Set();
+					break;
+				}
+			}
+		}
+
+		void UnlinkFired(Registration& reg) noexcept
+		{
+			if (!reg.Fired) return;
+
+			auto next = &m_FiredHead;
+			while (*next != nullptr)
+			{
+				if (*next == &reg)
+				{
+					*next = reg.NextFired;
+					break;
+				}
+
+				next = &(*next)->NextFired;
+			}
+
+			reg.Fired = false;
+			reg.NextFired = nullptr;
+		}
+
+	private:
+		std::atomic_bool m_Initialized{ false };
+		mutable std::mutex m_Mutex;
+		RegistrationMap m_Registrations;
+		ReadyKeys m_ReadyKeys;
+		bool m_Overflow{ false };
+
+		Event m_WakeEvent;
+		Registration* m_FiredHead{ nullptr };
+	};
+}
@@ -11,7 +11,7 @@ namespace QuantumGate::Implementation::Concurrency
 	class SpinMutex final
 	{
 	public:
-		SpinMutex() noexcept {}
+		constexpr SpinMutex() noexcept = default;
 		SpinMutex(const SpinMutex&) = delete;
 		SpinMutex(SpinMutex&&) = delete;
 		~SpinMutex() = default;
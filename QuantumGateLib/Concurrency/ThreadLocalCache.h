@@ -6,110 +6,201 @@
 #include "ThreadSafe.h"
 #include "SpinMutex.h"
 
-#include <random>
+#include <memory>
 
 namespace QuantumGate::Implementation::Concurrency
 {
+	// Threads that get values from a ThreadLocalCache call OnQuiescentState() at points
+	// where they can't be holding on to references to any of those values, such as in
+	// between work items in a thread pool. Snapshots that a thread has moved on from
+	// get released the first time it picks up a newer snapshot after such a point.
+	class ThreadLocalCacheQuiescence final
+	{
+	public:
+		ThreadLocalCacheQuiescence() = delete;
+
+		ForceInline static void OnQuiescentState() noexcept
+		{
+			++Count();
+		}
+
+		[[nodiscard]] ForceInline static UInt64 GetCount() noexcept
+		{
+			return Count();
+		}
+
+	private:
+		[[nodiscard]] ForceInline static UInt64& Count() noexcept
+		{
+			// Count for the current thread
+			static thread_local UInt64 m_Count{ 0 };
+			return m_Count;
+		}
+	};
+
+	// Every update of the value publishes a new immutable snapshot of it. Each thread keeps
+	// a reference to the snapshot it last got, so that reading the value only takes one
+	// atomic load to check if there's a newer snapshot and never copies the value. Threads
+	// pick up a newer snapshot the next time they get the value; old snapshots get released
+	// once all threads that used them have moved on.
+	//
+	// A reference to the value that a thread got stays valid until that thread has passed
+	// a quiescent point (see ThreadLocalCacheQuiescence above), no matter how many newer
+	// snapshots it picks up in the meantime, so that references held further up the call
+	// stack don't become invalid when a function that gets called picks up a newer snapshot.
+	// Threads that never pass a quiescent point keep the snapshots they moved on from until
+	// they exit. Code that needs the value for longer (such as across a wait) should hold
+	// on to the snapshot from GetSnapshot() instead, which keeps it alive for as long as needed.
 	template<typename T, typename M = SpinMutex, UInt64 ID = 0>
 	class ThreadLocalCache final
 	{
 		static_assert(std::is_default_constructible_v<T>, "Type must be default constructible.");
-		static_assert(std::is_copy_assignable_v<T>, "Type must be copy assignable.");
-		static_assert(std::is_member_function_pointer<decltype(&M::try_lock)>::value, "Value mutex should support try_lock.");
+		static_assert(std::is_copy_constructible_v<T>, "Type must be copy constructible.");
 
 	public:
 		using CacheType = T;
+		using Snapshot = std::shared_ptr<const T>;
 
 		template<typename... Args>
-		ThreadLocalCache(Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args...>) :
-			m_Value(std::forward<Args>(args)...)
+		ThreadLocalCache(Args&&... args) :
+			m_Value(std::make_shared<const T>(std::forward<Args>(args)...))
 		{
-			std::random_device rnd_dev;
-			std::mt19937 rnd_alg(rnd_dev());
-
-			do
-			{
-				m_ValueUpdateFlag = rnd_alg();
-			}
-			while (m_ValueUpdateFlag == 0);
+			m_Current.store(m_Value.WithUniqueLock()->get());
 		};
-		
+
 		ThreadLocalCache(const ThreadLocalCache&) = delete;
 		ThreadLocalCache(ThreadLocalCache&&) = delete;
 		~ThreadLocalCache() = default;
 		ThreadLocalCache& operator=(const ThreadLocalCache&) = delete;
 		ThreadLocalCache& operator=(ThreadLocalCache&&) = delete;
 
-		inline const CacheType* operator->() const noexcept(noexcept(GetCache()))
+		inline const CacheType* operator->() const noexcept
 		{
 			return &GetCache();
 		}
 
-		inline const CacheType& operator*() const noexcept(noexcept(GetCache()))
+		inline const CacheType& operator*() const noexcept
 		{
 			return GetCache();
 		}
 
-		[[nodiscard]] inline const CacheType& GetCache(const bool latest = true) const noexcept(noexcept(UpdateCache()))
+		[[nodiscard]] inline const CacheType& GetCache(const bool latest = true) const noexcept
 		{
-			if (latest && IsCacheExpired()) UpdateCache();
+			auto& cache = Cache();
+
+			if (latest && IsCacheExpired(cache)) UpdateCache(cache);
 
-			return Cache();
+			if (cache.Current) return *cache.Current;
+
+			// Thread didn't get the value yet
+			return Default();
 		}
 
+		[[nodiscard]] inline Snapshot GetSnapshot() const noexcept
+		{
+			auto& cache = Cache();
+
+			if (IsCacheExpired(cache)) UpdateCache(cache);
+
+			return cache.Current;
+		}
+
+		// Returns false if the new snapshot couldn't be made, in which case the value stays
+		// the same and the function doesn't get called; exceptions thrown by the function
+		// itself get passed on and also leave the value the same
 		template<typename F>
-		void UpdateValue(F&& function) noexcept(noexcept(m_Value.WithUniqueLock(function)))
+		[[nodiscard]] bool UpdateValue(F&& function) noexcept(std::is_nothrow_invocable_v<F, T&>)
 		{
-			m_Value.WithUniqueLock([&](T& value) noexcept(noexcept(function(value)))
+			Snapshot expired;
+			auto success = true;
+
+			m_Value.WithUniqueLock([&](Snapshot& snapshot) noexcept(std::is_nothrow_invocable_v<F, T&>)
 			{
-				function(value);
+				std::shared_ptr<T> value;
+
+				try
+				{
+					value = std::make_shared<T>(*snapshot);
+				}
+				catch (...)
+				{
+					success = false;
+					return;
+				}
+
+				function(*value);
+
+				expired = std::exchange(snapshot, std::move(value));
+
+				m_Current.store(snapshot.get(), std::memory_order_release);
 			});
 
-			// No problem if this wraps/overflows
-			// because what matters is the change
-			++m_ValueUpdateFlag;
+			// The expired snapshot gets released here (outside the lock) unless
+			// threads are still using it, in which case the last of them releases it
+			return success;
 		}
 
 	private:
-		[[nodiscard]] ForceInline static CacheType& Cache() noexcept
+		struct CacheData final
+		{
+			Snapshot Current;
+			Vector<Snapshot> Retired;
+			UInt64 QuiescentCount{ 0 };
+		};
+
+		[[nodiscard]] ForceInline static CacheData& Cache() noexcept
 		{
 			// Static object for use by the current thread
-			static thread_local CacheType m_Cache;
+			static thread_local CacheData m_Cache;
 			return m_Cache;
 		}
 
-		[[nodiscard]] ForceInline static UInt& CacheUpdateFlag() noexcept
+		[[nodiscard]] static const CacheType& Default() noexcept
 		{
-			// Static object for use by the current thread
-			static thread_local UInt m_CacheUpdateFlag{ 0 };
-			return m_CacheUpdateFlag;
+			static const CacheType m_Default;
+			return m_Default;
 		}
 
-		ForceInline void UpdateCache() const noexcept(std::is_nothrow_copy_assignable_v<T>)
+		void UpdateCache(CacheData& cache) const noexcept
 		{
-			m_Value.WithUniqueLock([&](const T& value) noexcept(std::is_nothrow_copy_assignable_v<T>)
+			// The thread passed a quiescent point since it last moved on from a
+			// snapshot, so it can't have references to the retired ones anymore
+			const auto count = ThreadLocalCacheQuiescence::GetCount();
+			if (cache.QuiescentCount != count)
 			{
-				Cache() = value;
-				CacheUpdateFlag() = m_ValueUpdateFlag.load();
-			});
-		}
+				cache.Retired.clear();
+				cache.QuiescentCount = count;
+			}
 
-		bool TryUpdateCache() const noexcept(std::is_nothrow_copy_assignable_v<T>)
-		{
-			return m_Value.IfUniqueLock([&](T& value) noexcept(std::is_nothrow_copy_assignable_v<T>)
+			if (cache.Current)
+			{
+				try
+				{
+					cache.Retired.emplace_back(cache.Current);
+				}
+				catch (...)
+				{
+					// Keep using the current snapshot for now since
+					// it can't be released yet; we'll try again later
+					return;
+				}
+			}
+
+			m_Value.WithUniqueLock([&](const Snapshot& snapshot) noexcept
 			{
-				Cache() = value;
-				CacheUpdateFlag() = m_ValueUpdateFlag.load();
+				cache.Current = snapshot;
 			});
 		}
 
-		[[nodiscard]] ForceInline bool IsCacheExpired() const noexcept
+		[[nodiscard]] ForceInline bool IsCacheExpired(const CacheData& cache) const noexcept
 		{
-			return (m_ValueUpdateFlag.load(std::memory_order_relaxed) != CacheUpdateFlag());
+			// The snapshot of the thread can't get released while the thread still has it,
+			// so another snapshot can't be at the same address; comparing addresses is enough
+			return (m_Current.load(std::memory_order_relaxed) != cache.Current.get());
 		}
 
 	private:
-		ThreadSafe<T, M> m_Value;
-		std::atomic<UInt> m_ValueUpdateFlag{ 0 };
+		ThreadSafe<Snapshot, M> m_Value;
+		std::atomic<const T*> m_Current{ nullptr };
 	};
-}
\ No newline at end of file
+}
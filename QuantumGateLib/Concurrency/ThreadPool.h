@@ -4,6 +4,7 @@
 #pragma once
 
 #include "Event.h"
+#include "ThreadLocalCache.h"
 #include "..\Common\Console.h"
 #include "..\Common\Callback.h"
 #include "..\Common\Containers.h"
@@ -427,6 +428,10 @@ namespace QuantumGate::Implementation::Concurrency
 
 			while (true)
 			{
+				// In between work items the thread doesn't hold on to
+				// references to any values from a ThreadLocalCache
+				ThreadLocalCacheQuiescence::OnQuiescentState();
+
 				try
 				{
 					// Thread with callback to wait for work
@@ -0,0 +1,417 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+
+#include "..\Common\Containers.h"
+
+namespace QuantumGate::Implementation::Concurrency
+{
+	// Hierarchical hashed timer wheel with millisecond resolution. Timers are
+	// identified by key; scheduling, rescheduling and cancelling a timer are O(1)
+	// and timers that aren't due yet cost nothing while the wheel advances.
+	// Level 0 has a slot for each of the next 256 ticks, and each higher level
+	// covers 256 times the range of the level below it; timers on higher levels
+	// get cascaded down as their slot comes up. A timer never expires before
+	// its deadline and at most one tick after it (if the wheel gets advanced
+	// in time). The wheel is not thread safe and is meant to be owned by the
+	// single thread that drives it.
+	template<typename K>
+	class TimerWheel final
+	{
+	public:
+		using Key = K;
+		using ExpiredKeys = Vector<Key>;
+
+	private:
+		using Tick = UInt64;
+		using Index = UInt32;
+
+		static constexpr Index InvalidIndex{ std::numeric_limits<Index>::max() };
+
+		static constexpr Size SlotBits{ 8 };
+		static constexpr Size NumSlots{ Size{ 1 } << SlotBits };
+		static constexpr Tick SlotMask{ NumSlots - 1 };
+
+		// Enough levels to cover the entire tick range
+		static constexpr Size NumLevels{ (sizeof(Tick) * 8) / SlotBits };
+
+		struct Timer final
+		{
+			K Key{};
+			Tick Expiry{ 0 };
+			Index Previous{ InvalidIndex };
+			Index Next{ InvalidIndex };
+			UInt8 Level{ 0 };
+			UInt8 Slot{ 0 };
+			bool Active{ false };
+		};
+
+		struct Level final
+		{
+			Level() noexcept { Slots.fill(InvalidIndex); }
+
+			std::array<Index, NumSlots> Slots;
+			Size Count{ 0 };
+		};
+
+		using KeyMap = Containers::UnorderedMap<Key, Index>;
+
+	public:
+		TimerWheel(const SteadyTime base_steadytime = Util::GetCurrentSteadyTime()) noexcept :
+			m_BaseSteadyTime(base_steadytime)
+		{}
+
+		TimerWheel(const TimerWheel&) = delete;
+		TimerWheel(TimerWheel&&) noexcept = default;
+		~TimerWheel() = default;
+		TimerWheel& operator=(const TimerWheel&) = delete;
+		TimerWheel& operator=(TimerWheel&&) noexcept = default;
+
+		// Schedules the timer for the key to expire at the deadline; if the
+		// key already has a timer it gets rescheduled. Returns false if the
+		// timer couldn't be added (memory allocation failure).
+		[[nodiscard]] bool Schedule(const Key& key, const SteadyTime deadline) noexcept
+		{
+			const auto expiry = GetExpiryTick(deadline);
+
+			if (const auto it = m_KeyMap.find(key); it != m_KeyMap.end())
+			{
+				auto& timer = m_Timers[it->second];
+				if (timer.Expiry != expiry)
+				{
+					Unlink(it->second);
+					timer.Expiry = expiry;
+					Link(it->second);
+				}
+
+				return true;
+			}
+
+			try
+			{
+				const auto idx = Allocate(key, expiry);
+
+				try
+				{
+					m_KeyMap.emplace(key, idx);
+				}
+				catch (...)
+				{
+					Free(idx);
+					throw;
+				}
+
+				Link(idx);
+
+				return true;
+			}
+			catch (...) {}
+
+			return false;
+		}
+
+		bool Cancel(const Key& key) noexcept
+		{
+			if (const auto it = m_KeyMap.find(key); it != m_KeyMap.end())
+			{
+				Unlink(it->second);
+				Free(it->second);
+				m_KeyMap.erase(it);
+
+				return true;
+			}
+
+			return false;
+		}
+
+		[[nodiscard]] inline bool Has(const Key& key) const noexcept { return m_KeyMap.find(key) != m_KeyMap.end(); }
+
+		[[nodiscard]] std::optional<SteadyTime> GetDeadline(const Key& key) const noexcept
+		{
+			if (const auto it = m_KeyMap.find(key); it != m_KeyMap.end())
+			{
+				return ToSteadyTime(m_Timers[it->second].Expiry);
+			}
+
+			return std::nullopt;
+		}
+
+		[[nodiscard]] inline Size GetSize() const noexcept { return m_KeyMap.size(); }
+		[[nodiscard]] inline bool IsEmpty() const noexcept { return m_KeyMap.empty(); }
+
+		// Returns the time at which the wheel next needs to be advanced; this is the
+		// earliest deadline, or earlier if a higher level slot needs cascading first
+		[[nodiscard]] std::optional<SteadyTime> GetNextExpiry() const noexcept
+		{
+			if (IsEmpty()) return std::nullopt;
+
+			for (Size level = 0; level < NumLevels; ++level)
+			{
+				if (m_Levels[level].Count == 0) continue;
+
+				const auto shift = SlotBits * level;
+				const auto current_slot = static_cast<Size>((m_CurrentTick >> shift) & SlotMask);
+
+				// Timers are always in a slot after the current one
+				for (auto slot = current_slot + 1; slot < NumSlots; ++slot)
+				{
+					if (m_Levels[level].Slots[slot] != InvalidIndex)
+					{
+						const auto window_shift = shift + SlotBits;
+						const auto window = (window_shift < sizeof(Tick) * 8) ?
+							((m_CurrentTick >> window_shift) << window_shift) : Tick{ 0 };
+
+						return ToSteadyTime(window | (static_cast<Tick>(slot) << shift));
+					}
+				}
+
+				// Shouldn't get here
+				assert(false);
+			}
+
+			return std::nullopt;
+		}
+
+		// Advances the wheel up to the current time and adds the keys of all timers
+		// that expired to expired_keys. Returns false if not all expired keys could
+		// be added (memory allocation failure); those timers remain and will
+		// be reported on the next call.
+		[[nodiscard]] bool Expire(const SteadyTime current_steadytime, ExpiredKeys& expired_keys) noexcept
+		{
+			const auto target = GetCurrentTick(current_steadytime);
+
+			while (m_CurrentTick < target)
+			{
+				if (IsEmpty())
+				{
+					m_CurrentTick = target;
+					break;
+				}
+
+				// Nothing can expire or needs cascading before the
+				// next slot boundary of the lowest level that has timers
+				Size lowest{ 0 };
+				while (m_Levels[lowest].Count == 0) ++lowest;
+
+				auto next = m_CurrentTick + 1;
+				if (lowest > 0)
+				{
+					const auto shift = SlotBits * lowest;
+					next = ((m_CurrentTick >> shift) + 1) << shift;
+					if (next > target)
+					{
+						m_CurrentTick = target;
+						break;
+					}
+				}
+
+				m_CurrentTick = next;
+
+				// Cascade timers down from higher levels whose slot came up,
+				// starting with the highest so they can trickle all the way down
+				for (auto level = NumLevels - 1; level > 0; --level)
+				{
+					const auto shift = SlotBits * level;
+					if ((m_CurrentTick & ((Tick{ 1 } << shift) - 1)) == 0)
+					{
+						Cascade(level, static_cast<Size>((m_CurrentTick >> shift) & SlotMask));
+					}
+				}
+
+				auto& head = m_Levels[0].Slots[static_cast<Size>(m_CurrentTick & SlotMask)];
+				if (head != InvalidIndex)
+				{
+					try
+					{
+						Size num{ 0 };
+						for (auto idx = head; idx != InvalidIndex; idx = m_Timers[idx].Next) ++num;
+
+						expired_keys.reserve(expired_keys.size() + num);
+					}
+					catch (...)
+					{
+						// Try again next time; cascading again
+						// for this tick is harmless
+						--m_CurrentTick;
+						return false;
+					}
+
+					while (head != InvalidIndex)
+					{
+						const auto idx = head;
+						auto& timer = m_Timers[idx];
+
+						assert(timer.Expiry == m_CurrentTick);
+
+						expired_keys.emplace_back(timer.Key);
+
+						Unlink(idx);
+						m_KeyMap.erase(timer.Key);
+						Free(idx);
+					}
+				}
+			}
+
+			return true;
+		}
+
+		void Clear() noexcept
+		{
+			m_KeyMap.clear();
+			m_Timers.clear();
+			m_FreeIndex = InvalidIndex;
+
+			for (auto& level : m_Levels)
+			{
+				level.Slots.fill(InvalidIndex);
+				level.Count = 0;
+			}
+		}
+
+	private:
+		[[nodiscard]] inline Tick GetCurrentTick(const SteadyTime steadytime) const noexcept
+		{
+			if (steadytime <= m_BaseSteadyTime) return 0;
+
+			return static_cast<Tick>(std::chrono::floor<std::chrono::milliseconds>(steadytime - m_BaseSteadyTime).count());
+		}
+
+		[[nodiscard]] inline Tick GetExpiryTick(const SteadyTime deadline) const noexcept
+		{
+			auto tick = (deadline <= m_BaseSteadyTime) ? Tick{ 0 } :
+				static_cast<Tick>(std::chrono::ceil<std::chrono::milliseconds>(deadline - m_BaseSteadyTime).count());
+
+			// Timers that are already due expire on the next tick
+			if (tick <= m_CurrentTick) tick = m_CurrentTick + 1;
+
+			return tick;
+		}
+
+		[[nodiscard]] inline SteadyTime ToSteadyTime(const Tick tick) const noexcept
+		{
+			return m_BaseSteadyTime + std::chrono::milliseconds(tick);
+		}
+
+		[[nodiscard]] Index Allocate(const Key& key, const Tick expiry)
+		{
+			Index idx{ InvalidIndex };
+
+			if (m_FreeIndex != InvalidIndex)
+			{
+				idx = m_FreeIndex;
+				m_FreeIndex = m_Timers[idx].Next;
+			}
+			else
+			{
+				if (m_Timers.size() >= InvalidIndex) throw std::length_error("Too many timers");
+
+				m_Timers.emplace_back();
+				idx = static_cast<Index>(m_Timers.size() - 1);
+			}
+
+			auto& timer = m_Timers[idx];
+			timer.Key = key;
+			timer.Expiry = expiry;
+			timer.Previous = InvalidIndex;
+			timer.Next = InvalidIndex;
+			timer.Active = false;
+
+			return idx;
+		}
+
+		void Free(const Index idx) noexcept
+		{
+			auto& timer = m_Timers[idx];
+
+			assert(!timer.Active);
+
+			timer.Key = Key{};
+			timer.Previous = InvalidIndex;
+			timer.Next = m_FreeIndex;
+			m_FreeIndex = idx;
+		}
+
+		void Link(const Index idx) noexcept
+		{
+			auto& timer = m_Timers[idx];
+
+			// Timers only get linked for the current tick while cascading
+			assert(!timer.Active && timer.Expiry >= m_CurrentTick);
+
+			// The level is determined by the most significant group of bits
+			// in which the expiry and the current tick differ; this way the
+			// timer's slot is always after the current slot on that level
+			auto diff = (timer.Expiry ^ m_CurrentTick) >> SlotBits;
+			Size level{ 0 };
+
+			while (diff != 0)
+			{
+				diff >>= SlotBits;
+				++level;
+			}
+
+			assert(level < NumLevels);
+
+			const auto slot = static_cast<Size>((timer.Expiry >> (SlotBits * level)) & SlotMask);
+
+			auto& head = m_Levels[level].Slots[slot];
+
+			timer.Level = static_cast<UInt8>(level);
+			timer.Slot = static_cast<UInt8>(slot);
+			timer.Previous = InvalidIndex;
+			timer.Next = head;
+			timer.Active = true;
+
+			if (head != InvalidIndex) m_Timers[head].Previous = idx;
+
+			head = idx;
+
+			++m_Levels[level].Count;
+		}
+
+		void Unlink(const Index idx) noexcept
+		{
+			auto& timer = m_Timers[idx];
+
+			assert(timer.Active);
+
+			if (timer.Previous != InvalidIndex) m_Timers[timer.Previous].Next = timer.Next;
+			else m_Levels[timer.Level].Slots[timer.Slot] = timer.Next;
+
+			if (timer.Next != InvalidIndex) m_Timers[timer.Next].Previous = timer.Previous;
+
+			timer.Previous = InvalidIndex;
+			timer.Next = InvalidIndex;
+			timer.Active = false;
+
+			--m_Levels[timer.Level].Count;
+		}
+
+		void Cascade(const Size level, const Size slot) noexcept
+		{
+			auto idx = m_Levels[level].Slots[slot];
+
+			while (idx != InvalidIndex)
+			{
+				const auto next = m_Timers[idx].Next;
+
+				Unlink(idx);
+				Link(idx);
+
+				idx = next;
+			}
+		}
+
+	private:
+		SteadyTime m_BaseSteadyTime;
+		Tick m_CurrentTick{ 0 };
+		std::array<Level, NumLevels> m_Levels;
+		Vector<Timer> m_Timers;
+		Index m_FreeIndex{ InvalidIndex };
+		KeyMap m_KeyMap;
+	};
+}
@@ -0,0 +1,99 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#pragma once
+
+#include "..\Common\ScopeGuard.h"
+
+#include <atomic>
+#include <chrono>
+
+#pragma comment(lib, "Synchronization.lib")
+
+namespace QuantumGate::Implementation::Concurrency
+{
+	// Counter that threads can block on with WaitOnAddress until it gets
+	// incremented; notifying only enters the kernel when there are waiters
+	class WaitableCounter final
+	{
+		using CounterType = UInt32;
+
+	public:
+		WaitableCounter() noexcept = default;
+		WaitableCounter(const WaitableCounter&) = delete;
+		WaitableCounter(WaitableCounter&&) = delete;
+		~WaitableCounter() = default;
+		WaitableCounter& operator=(const WaitableCounter&) = delete;
+		WaitableCounter& operator=(WaitableCounter&&) = delete;
+
+		inline void NotifyOne() noexcept
+		{
+			m_Counter.fetch_add(1, std::memory_order_seq_cst);
+
+			if (m_NumWaiters.load(std::memory_order_seq_cst) > 0)
+			{
+				::WakeByAddressSingle(&m_Counter);
+			}
+		}
+
+		inline void NotifyAll() noexcept
+		{
+			m_Counter.fetch_add(1, std::memory_order_seq_cst);
+
+			if (m_NumWaiters.load(std::memory_order_seq_cst) > 0)
+			{
+				::WakeByAddressAll(&m_Counter);
+			}
+		}
+
+		template<typename Pred>
+		bool Wait(const std::chrono::milliseconds time, Pred&& pred) noexcept
+		{
+			const auto end_time = std::chrono::steady_clock::now() + time;
+
+			return WaitImpl(std::forward<Pred>(pred), [&]() noexcept -> DWORD
+			{
+				const auto now = std::chrono::steady_clock::now();
+				if (now >= end_time) return 0;
+
+				return static_cast<DWORD>(
+					std::chrono::ceil<std::chrono::milliseconds>(end_time - now).count());
+			});
+		}
+
+		template<typename Pred>
+		bool Wait(Pred&& pred) noexcept
+		{
+			return WaitImpl(std::forward<Pred>(pred), []() noexcept -> DWORD { return INFINITE; });
+		}
+
+	private:
+		template<typename Pred, typename F>
+		bool WaitImpl(Pred&& pred, F&& get_timeout) noexcept
+		{
+			// Registering as a waiter before sampling the counter guarantees that
+			// a notifier either sees us waiting or we see its increment
+			m_NumWaiters.fetch_add(1, std::memory_order_seq_cst);
+			auto sg = MakeScopeGuard([&]() noexcept { m_NumWaiters.fetch_sub(1, std::memory_order_seq_cst); });
+
+			while (true)
+			{
+				CounterType counter = m_Counter.load(std::memory_order_seq_cst);
+
+				if (pred()) return true;
+
+				const auto timeout = get_timeout();
+				if (timeout == 0) return false;
+
+				if (!::WaitOnAddress(&m_Counter, &counter, sizeof(CounterType), timeout))
+				{
+					if (::GetLastError() == ERROR_TIMEOUT) return pred();
+				}
+			}
+		}
+
+	private:
+		std::atomic<CounterType> m_Counter{ 0 };
+		std::atomic<CounterType> m_NumWaiters{ 0 };
+	};
+}
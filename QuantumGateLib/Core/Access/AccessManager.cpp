@@ -7,41 +7,101 @@
 
 namespace QuantumGate::Implementation::Core::Access
 {
+	bool AccessUpdate::CanAffect(const Address& addr) const noexcept
+	{
+		switch (m_Scope)
+		{
+			case Scope::None:
+				return false;
+			case Scope::Address:
+				return (addr == m_Address);
+			case Scope::IPNetwork:
+			{
+				if (addr.GetType() != Address::Type::IP) return false;
+
+				const auto [success, same_network] =
+					BinaryIPAddress::AreInSameNetwork(addr.GetIPAddress().GetBinary(),
+													  m_Address.GetIPAddress().GetBinary(), m_CIDRLeadingBits);
+				return (!success || same_network);
+			}
+			default:
+				break;
+		}
+
+		return true;
+	}
+
 	Manager::Manager(const Settings_CThS& settings) noexcept :
 		m_Settings(settings)
 	{}
 
-	Result<IPFilterID> Manager::AddIPFilter(const WChar* ip_cidr,
-											const IPFilterType type) noexcept
+	template<typename F>
+	Result<IPFilterID> Manager::AddIPFilterImpl(F&& function, const IPFilterType type) noexcept
 	{
-		auto result = m_IPFilters.WithUniqueLock()->AddFilter(ip_cidr, type);
+		// IP addresses are blocked by default, so adding an allowed filter
+		// can't take away access from any address; adding a blocked filter
+		// can only do so for the addresses in its network
+		auto update = AccessUpdate(AccessUpdate::Scope::None);
+
+		auto result = m_IPFilters.WithUniqueLock([&](IPFilters& ipfilters) noexcept
+		{
+			auto retval = function(ipfilters);
+			if (retval.Succeeded() && type == IPFilterType::Blocked)
+			{
+				if (const auto ipfilter = ipfilters.GetFilter(*retval, type); ipfilter != nullptr)
+				{
+					update = AccessUpdate(ipfilter->Address, ipfilter->CIDRLeadingBits);
+				}
+				else update = AccessUpdate(AccessUpdate::Scope::All);
+			}
+
+			return retval;
+		});
+
 		if (result.Succeeded())
 		{
-			m_AccessUpdateCallbacks.WithUniqueLock()();
+			OnAddressAccessUpdate(update);
 		}
 
 		return result;
 	}
 
-	Result<IPFilterID> Manager::AddIPFilter(const WChar* ip_str, const WChar* mask_str,
+	Result<IPFilterID> Manager::AddIPFilter(const WChar* ip_cidr,
 											const IPFilterType type) noexcept
 	{
-		auto result = m_IPFilters.WithUniqueLock()->AddFilter(ip_str, mask_str, type);
-		if (result.Succeeded())
+		return AddIPFilterImpl([&](IPFilters& ipfilters) noexcept
 		{
-			m_AccessUpdateCallbacks.WithUniqueLock()();
-		}
+			return ipfilters.AddFilter(ip_cidr, type);
+		}, type);
+	}
 
-		return result;
+	Result<IPFilterID> Manager::AddIPFilter(const WChar* ip_str, const WChar* mask_str,
+											const IPFilterType type) noexcept
+	{
+		return AddIPFilterImpl([&](IPFilters& ipfilters) noexcept
+		{
+			return ipfilters.AddFilter(ip_str, mask_str, type);
+		}, type);
 	}
 
 	Result<IPFilterID> Manager::AddIPFilter(const IPAddress& ip, const IPAddress& mask,
 											const IPFilterType type) noexcept
 	{
-		auto result = m_IPFilters.WithUniqueLock()->AddFilter(ip, mask, type);
+		return AddIPFilterImpl([&](IPFilters& ipfilters) noexcept
+		{
+			return ipfilters.AddFilter(ip, mask, type);
+		}, type);
+	}
+
+	Result<Vector<IPFilterID>> Manager::AddIPFilters(const Vector<String>& ip_cidrs,
+													 const IPFilterType type) noexcept
+	{
+		auto result = m_IPFilters.WithUniqueLock()->AddFilters(ip_cidrs, type);
 		if (result.Succeeded())
 		{
-			m_AccessUpdateCallbacks.WithUniqueLock()();
+			// Once for all filters
+			OnAddressAccessUpdate(AccessUpdate(type == IPFilterType::Blocked ?
+											   AccessUpdate::Scope::All : AccessUpdate::Scope::None));
 		}
 
 		return result;
@@ -49,10 +109,26 @@ namespace QuantumGate::Implementation::Core::Access
 
 	Result<> Manager::RemoveIPFilter(const IPFilterID filterid, const IPFilterType type) noexcept
 	{
-		auto result = m_IPFilters.WithUniqueLock()->RemoveFilter(filterid, type);
+		// Removing a blocked filter can't take away access from any address;
+		// removing an allowed filter can only do so for the addresses in its network
+		auto update = AccessUpdate(AccessUpdate::Scope::None);
+
+		auto result = m_IPFilters.WithUniqueLock([&](IPFilters& ipfilters) noexcept
+		{
+			if (type == IPFilterType::Allowed)
+			{
+				if (const auto ipfilter = ipfilters.GetFilter(filterid, type); ipfilter != nullptr)
+				{
+					update = AccessUpdate(ipfilter->Address, ipfilter->CIDRLeadingBits);
+				}
+			}
+
+			return ipfilters.RemoveFilter(filterid, type);
+		});
+
 		if (result.Succeeded())
 		{
-			m_AccessUpdateCallbacks.WithUniqueLock()();
+			OnAddressAccessUpdate(update);
 		}
 
 		return result;
@@ -61,7 +137,7 @@ namespace QuantumGate::Implementation::Core::Access
 	void Manager::RemoveAllIPFilters() noexcept
 	{
 		m_IPFilters.WithUniqueLock()->Clear();
-		m_AccessUpdateCallbacks.WithUniqueLock()();
+		OnAddressAccessUpdate(AccessUpdate(AccessUpdate::Scope::All));
 	}
 
 	Result<Vector<IPFilter>> Manager::GetAllIPFilters() const noexcept
@@ -72,10 +148,10 @@ namespace QuantumGate::Implementation::Core::Access
 	Result<> Manager::SetAddressReputation(const Address& addr, const Int16 score,
 										   const std::optional<Time>& time) noexcept
 	{
-		auto result = m_AddressAccessControl.WithUniqueLock()->SetReputation(addr, score, time);
+		auto result = m_AddressAccessControl.SetReputation(addr, score, time);
 		if (result.Succeeded())
 		{
-			m_AccessUpdateCallbacks.WithUniqueLock()();
+			OnAddressAccessUpdate(AccessUpdate(addr));
 		}
 
 		return result;
@@ -83,12 +159,12 @@ namespace QuantumGate::Implementation::Core::Access
 
 	Result<> Manager::SetAddressReputation(const AddressReputation& addr_rep) noexcept
 	{
-		auto result = m_AddressAccessControl.WithUniqueLock()->SetReputation(addr_rep.Address,
+		auto result = m_AddressAccessControl.SetReputation(addr_rep.Address,
 																			 addr_rep.Score,
 																			 addr_rep.LastUpdateTime);
 		if (result.Succeeded())
 		{
-			m_AccessUpdateCallbacks.WithUniqueLock()();
+			OnAddressAccessUpdate(AccessUpdate(addr_rep.Address));
 		}
 
 		return result;
@@ -107,10 +183,11 @@ namespace QuantumGate::Implementation::Core::Access
 
 	Result<> Manager::ResetAddressReputation(const Address& addr) noexcept
 	{
-		auto result = m_AddressAccessControl.WithUniqueLock()->ResetReputation(addr);
+		auto result = m_AddressAccessControl.ResetReputation(addr);
 		if (result.Succeeded())
 		{
-			m_AccessUpdateCallbacks.WithUniqueLock()();
+			// Reputation goes back to the maximum
+			OnAddressAccessUpdate(AccessUpdate(AccessUpdate::Scope::None));
 		}
 
 		return result;
@@ -118,17 +195,17 @@ namespace QuantumGate::Implementation::Core::Access
 
 	void Manager::ResetAllAddressReputations() noexcept
 	{
-		m_AddressAccessControl.WithUniqueLock()->ResetAllReputations();
-		m_AccessUpdateCallbacks.WithUniqueLock()();
+		m_AddressAccessControl.ResetAllReputations();
+		OnAddressAccessUpdate(AccessUpdate(AccessUpdate::Scope::None));
 	}
 
 	Result<std::pair<Int16, bool>> Manager::UpdateAddressReputation(const Address& addr,
 																	const AddressReputationUpdate rep_update) noexcept
 	{
-		auto result = m_AddressAccessControl.WithUniqueLock()->UpdateReputation(addr, rep_update);
+		auto result = m_AddressAccessControl.UpdateReputation(addr, rep_update);
 		if (result.Succeeded())
 		{
-			m_AccessUpdateCallbacks.WithUniqueLock()();
+			OnAddressAccessUpdate(AccessUpdate(addr));
 		}
 
 		return result;
@@ -136,7 +213,7 @@ namespace QuantumGate::Implementation::Core::Access
 
 	Result<Vector<AddressReputation>> Manager::GetAllAddressReputations() const noexcept
 	{
-		return m_AddressAccessControl.WithUniqueLock()->GetReputations();
+		return m_AddressAccessControl.GetReputations();
 	}
 
 	bool Manager::AddIPConnection(const IPAddress& ip) noexcept
@@ -151,9 +228,9 @@ namespace QuantumGate::Implementation::Core::Access
 
 	bool Manager::AddConnectionAttempt(const Address& addr) noexcept
 	{
-		if (!m_AddressAccessControl.WithUniqueLock()->AddConnectionAttempt(addr))
+		if (!m_AddressAccessControl.AddConnectionAttempt(addr))
 		{
-			m_AccessUpdateCallbacks.WithUniqueLock()();
+			OnAddressAccessUpdate(AccessUpdate(addr));
 			return false;
 		}
 
@@ -162,9 +239,9 @@ namespace QuantumGate::Implementation::Core::Access
 
 	bool Manager::AddRelayConnectionAttempt(const Address& addr) noexcept
 	{
-		if (!m_AddressAccessControl.WithUniqueLock()->AddRelayConnectionAttempt(addr))
+		if (!m_AddressAccessControl.AddRelayConnectionAttempt(addr))
 		{
-			m_AccessUpdateCallbacks.WithUniqueLock()();
+			OnAddressAccessUpdate(AccessUpdate(addr));
 			return false;
 		}
 
@@ -177,7 +254,7 @@ namespace QuantumGate::Implementation::Core::Access
 		auto result = m_SubnetLimits.WithUniqueLock()->AddLimit(af, cidr_lbits, max_con);
 		if (result.Succeeded())
 		{
-			m_AccessUpdateCallbacks.WithUniqueLock()();
+			OnAddressAccessUpdate(AccessUpdate(AccessUpdate::Scope::All));
 		}
 
 		return result;
@@ -188,7 +265,7 @@ namespace QuantumGate::Implementation::Core::Access
 		auto result = m_SubnetLimits.WithUniqueLock()->AddLimit(af, cidr_lbits, max_con);
 		if (result.Succeeded())
 		{
-			m_AccessUpdateCallbacks.WithUniqueLock()();
+			OnAddressAccessUpdate(AccessUpdate(AccessUpdate::Scope::All));
 		}
 
 		return result;
@@ -199,7 +276,7 @@ namespace QuantumGate::Implementation::Core::Access
 		auto result = m_SubnetLimits.WithUniqueLock()->RemoveLimit(af, cidr_lbits);
 		if (result.Succeeded())
 		{
-			m_AccessUpdateCallbacks.WithUniqueLock()();
+			OnAddressAccessUpdate(AccessUpdate(AccessUpdate::Scope::None));
 		}
 
 		return result;
@@ -210,7 +287,7 @@ namespace QuantumGate::Implementation::Core::Access
 		auto result = m_SubnetLimits.WithUniqueLock()->RemoveLimit(af, cidr_lbits);
 		if (result.Succeeded())
 		{
-			m_AccessUpdateCallbacks.WithUniqueLock()();
+			OnAddressAccessUpdate(AccessUpdate(AccessUpdate::Scope::None));
 		}
 
 		return result;
@@ -246,7 +323,7 @@ namespace QuantumGate::Implementation::Core::Access
 			}
 			case CheckType::AddressReputations:
 			{
-				return m_AddressAccessControl.WithUniqueLock()->HasAcceptableReputation(addr);
+				return m_AddressAccessControl.HasAcceptableReputation(addr);
 			}
 			case CheckType::IPSubnetLimits:
 			{
@@ -262,20 +339,18 @@ namespace QuantumGate::Implementation::Core::Access
 				{
 					case Address::Type::IP:
 					{
-						if (const auto result = m_IPFilters.WithSharedLock()->GetAllowed(addr.GetIPAddress()); result)
+						// Subnet limits depend on the current connections
+						// and are therefore always checked
+						if (GetAddressAllowedByFiltersAndReputation(addr) &&
+							!m_SubnetLimits.WithSharedLock()->HasConnectionOverflow(addr.GetIPAddress()))
 						{
-							if (*result &&
-								m_AddressAccessControl.WithUniqueLock()->HasAcceptableReputation(addr) &&
-								!m_SubnetLimits.WithSharedLock()->HasConnectionOverflow(addr.GetIPAddress()))
-							{
-								return true;
-							}
+							return true;
 						}
 						break;
 					}
 					case Address::Type::BTH:
 					{
-						return m_AddressAccessControl.WithUniqueLock()->HasAcceptableReputation(addr);
+						return GetAddressAllowedByFiltersAndReputation(addr);
 					}
 					default:
 					{
@@ -310,7 +385,7 @@ namespace QuantumGate::Implementation::Core::Access
 			}
 			case CheckType::AddressReputations:
 			{
-				return m_AddressAccessControl.WithUniqueLock()->HasAcceptableReputation(addr);
+				return m_AddressAccessControl.HasAcceptableReputation(addr);
 			}
 			case CheckType::IPSubnetLimits:
 			{
@@ -326,20 +401,18 @@ namespace QuantumGate::Implementation::Core::Access
 				{
 					case Address::Type::IP:
 					{
-						if (const auto result = m_IPFilters.WithSharedLock()->GetAllowed(addr.GetIPAddress()); result)
+						// Subnet limits depend on the current connections
+						// and are therefore always checked
+						if (GetAddressAllowedByFiltersAndReputation(addr) &&
+							m_SubnetLimits.WithSharedLock()->CanAcceptConnection(addr.GetIPAddress()))
 						{
-							if (*result &&
-								m_AddressAccessControl.WithUniqueLock()->HasAcceptableReputation(addr) &&
-								m_SubnetLimits.WithSharedLock()->CanAcceptConnection(addr.GetIPAddress()))
-							{
-								return true;
-							}
+							return true;
 						}
 						break;
 					}
 					case Address::Type::BTH:
 					{
-						return m_AddressAccessControl.WithUniqueLock()->HasAcceptableReputation(addr);
+						return GetAddressAllowedByFiltersAndReputation(addr);
 					}
 					default:
 					{
@@ -360,12 +433,71 @@ namespace QuantumGate::Implementation::Core::Access
 		return false;
 	}
 
+	bool Manager::GetAddressAllowedByFiltersAndReputation(const Address& addr) noexcept
+	{
+		if (const auto verdict = m_AccessVerdicts.GetVerdict(addr); verdict.has_value())
+		{
+			return *verdict;
+		}
+
+		const auto generation = m_AccessVerdicts.GetGeneration(addr);
+
+		auto allowed = false;
+
+		switch (addr.GetType())
+		{
+			case Address::Type::IP:
+			{
+				const auto result = m_IPFilters.WithSharedLock()->GetAllowed(addr.GetIPAddress());
+				if (!result) return false;
+
+				allowed = (*result && m_AddressAccessControl.HasAcceptableReputation(addr));
+				break;
+			}
+			case Address::Type::BTH:
+			{
+				allowed = m_AddressAccessControl.HasAcceptableReputation(addr);
+				break;
+			}
+			default:
+			{
+				return false;
+			}
+		}
+
+		m_AccessVerdicts.AddVerdict(addr, generation, allowed);
+
+		return allowed;
+	}
+
+	void Manager::OnAddressAccessUpdate(const AccessUpdate& update) noexcept
+	{
+		// Even changes that can't take away access from any address
+		// can give access to addresses with a cached blocked verdict
+		if (update.GetScope() == AccessUpdate::Scope::Address)
+		{
+			// Such as the reputation of an address that changes with every
+			// bad datagram; the verdicts for other addresses stay valid
+			m_AccessVerdicts.Invalidate(update.GetAddress());
+		}
+		else m_AccessVerdicts.Invalidate();
+
+		m_AccessUpdateCallbacks.WithUniqueLock()(update);
+	}
+
+	void Manager::OnPeerAccessUpdate() noexcept
+	{
+		// Peers are allowed access by their UUID which isn't
+		// related to their address so all of them are affected
+		m_AccessUpdateCallbacks.WithUniqueLock()(AccessUpdate(AccessUpdate::Scope::All));
+	}
+
 	Result<> Manager::AddPeer(PeerSettings&& pas) noexcept
 	{
 		auto result = m_PeerAccessControl.WithUniqueLock()->AddPeer(std::move(pas));
 		if (result.Succeeded())
 		{
-			m_AccessUpdateCallbacks.WithUniqueLock()();
+			OnPeerAccessUpdate();
 		}
 
 		return result;
@@ -376,7 +508,7 @@ namespace QuantumGate::Implementation::Core::Access
 		auto result = m_PeerAccessControl.WithUniqueLock()->UpdatePeer(std::move(pas));
 		if (result.Succeeded())
 		{
-			m_AccessUpdateCallbacks.WithUniqueLock()();
+			OnPeerAccessUpdate();
 		}
 
 		return result;
@@ -387,7 +519,7 @@ namespace QuantumGate::Implementation::Core::Access
 		auto result = m_PeerAccessControl.WithUniqueLock()->RemovePeer(puuid);
 		if (result.Succeeded())
 		{
-			m_AccessUpdateCallbacks.WithUniqueLock()();
+			OnPeerAccessUpdate();
 		}
 
 		return result;
@@ -396,7 +528,7 @@ namespace QuantumGate::Implementation::Core::Access
 	void Manager::RemoveAllPeers() noexcept
 	{
 		m_PeerAccessControl.WithUniqueLock()->Clear();
-		m_AccessUpdateCallbacks.WithUniqueLock()();
+		OnPeerAccessUpdate();
 	}
 
 	Result<bool> Manager::GetPeerAllowed(const PeerUUID& puuid) const noexcept
@@ -412,7 +544,7 @@ namespace QuantumGate::Implementation::Core::Access
 	void Manager::SetPeerAccessDefault(const PeerAccessDefault pad) noexcept
 	{
 		m_PeerAccessControl.WithUniqueLock()->SetAccessDefault(pad);
-		m_AccessUpdateCallbacks.WithUniqueLock()();
+		OnPeerAccessUpdate();
 	}
 
 	PeerAccessDefault Manager::GetPeerAccessDefault() const noexcept
@@ -7,6 +7,7 @@
 #include "AddressAccessControl.h"
 #include "IPSubnetLimits.h"
 #include "PeerAccessControl.h"
+#include "AccessVerdictCache.h"
 #include "..\..\Common\Dispatcher.h"
 
 namespace QuantumGate::Implementation::Core::Peer
@@ -16,10 +17,45 @@ namespace QuantumGate::Implementation::Core::Peer
 
 namespace QuantumGate::Implementation::Core::Access
 {
+	// Describes which peers might not be allowed access anymore after a change in the
+	// access configuration, so that only those peers need to get checked again
+	class AccessUpdate final
+	{
+	public:
+		enum class Scope : UInt8
+		{
+			None, Address, IPNetwork, All
+		};
+
+		constexpr AccessUpdate() noexcept = default;
+
+		constexpr AccessUpdate(const Scope scope) noexcept : m_Scope(scope)
+		{
+			assert(scope == Scope::None || scope == Scope::All);
+		}
+
+		constexpr AccessUpdate(const Address& addr) noexcept :
+			m_Scope(Scope::Address), m_Address(addr)
+		{}
+
+		constexpr AccessUpdate(const IPAddress& network, const UInt8 cidr_lbits) noexcept :
+			m_Scope(Scope::IPNetwork), m_Address(network), m_CIDRLeadingBits(cidr_lbits)
+		{}
+
+		[[nodiscard]] inline Scope GetScope() const noexcept { return m_Scope; }
+		[[nodiscard]] inline const Address& GetAddress() const noexcept { return m_Address; }
+		[[nodiscard]] bool CanAffect(const Address& addr) const noexcept;
+
+	private:
+		Scope m_Scope{ Scope::All };
+		Address m_Address;
+		UInt8 m_CIDRLeadingBits{ 0 };
+	};
+
 	class Manager final
 	{
 	public:
-		using AccessUpdateCallbacks = Dispatcher<void() noexcept>;
+		using AccessUpdateCallbacks = Dispatcher<void(const AccessUpdate&) noexcept>;
 		using AccessUpdateCallbackHandle = AccessUpdateCallbacks::FunctionHandle;
 		using AccessUpdateCallbacks_ThS = Concurrency::ThreadSafe<AccessUpdateCallbacks, std::mutex>;
 
@@ -37,6 +73,8 @@ namespace QuantumGate::Implementation::Core::Access
 									   const IPFilterType type) noexcept;
 		Result<IPFilterID> AddIPFilter(const IPAddress& ip, const IPAddress& mask,
 									   const IPFilterType type) noexcept;
+		Result<Vector<IPFilterID>> AddIPFilters(const Vector<String>& ip_cidrs,
+												const IPFilterType type) noexcept;
 
 		Result<> RemoveIPFilter(const IPFilterID filterid, const IPFilterType type) noexcept;
 		void RemoveAllIPFilters() noexcept;
@@ -87,13 +125,23 @@ namespace QuantumGate::Implementation::Core::Access
 
 		inline AccessUpdateCallbacks_ThS& GetAccessUpdateCallbacks() noexcept { return m_AccessUpdateCallbacks; }
 
+	private:
+		template<typename F>
+		Result<IPFilterID> AddIPFilterImpl(F&& function, const IPFilterType type) noexcept;
+
+		[[nodiscard]] bool GetAddressAllowedByFiltersAndReputation(const Address& addr) noexcept;
+
+		void OnAddressAccessUpdate(const AccessUpdate& update) noexcept;
+		void OnPeerAccessUpdate() noexcept;
+
 	private:
 		const Settings_CThS& m_Settings;
 
 		IPFilters_ThS m_IPFilters;
-		AddressAccessControl_ThS m_AddressAccessControl{ m_Settings };
+		AddressAccessControl m_AddressAccessControl{ m_Settings };
 		IPSubnetLimits_ThS m_SubnetLimits;
 		PeerAccessControl_ThS m_PeerAccessControl{ m_Settings };
+		AccessVerdictCache m_AccessVerdicts;
 
 		AccessUpdateCallbacks_ThS m_AccessUpdateCallbacks;
 	};
@@ -0,0 +1,95 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#include "pch.h"
+#include "AccessVerdictCache.h"
+#include "..\..\Common\Hash.h"
+
+namespace QuantumGate::Implementation::Core::Access
+{
+	AccessVerdictCache::Generation AccessVerdictCache::GetGeneration(const Address& addr) const noexcept
+	{
+		const auto idx = Hash::GetShardIndex<NumShardBits>(std::hash<Address>{}(addr));
+
+		return Generation{
+			m_Generation.load(std::memory_order_acquire),
+			m_ShardGenerations[idx].load(std::memory_order_acquire)
+		};
+	}
+
+	void AccessVerdictCache::Invalidate(const Address& addr) noexcept
+	{
+		const auto idx = Hash::GetShardIndex<NumShardBits>(std::hash<Address>{}(addr));
+
+		m_Verdicts[idx].WithUniqueLock([&](VerdictMap& verdicts) noexcept
+		{
+			// Verdicts that are being made for any address in the shard right
+			// now won't get added; the verdicts already in it stay valid
+			m_ShardGenerations[idx].fetch_add(1, std::memory_order_acq_rel);
+
+			verdicts.erase(addr);
+		});
+	}
+
+	std::optional<bool> AccessVerdictCache::GetVerdict(const Address& addr) const noexcept
+	{
+		const auto generation = m_Generation.load(std::memory_order_acquire);
+
+		auto shard = m_Verdicts[Hash::GetShardIndex<NumShardBits>(std::hash<Address>{}(addr))].WithSharedLock();
+
+		if (const auto it = shard->find(addr); it != shard->end())
+		{
+			if (IsCurrent(it->second, generation, Util::GetCurrentSteadyTime()))
+			{
+				return it->second.Allowed;
+			}
+		}
+
+		return std::nullopt;
+	}
+
+	void AccessVerdictCache::AddVerdict(const Address& addr, const Generation& generation, const bool allowed) noexcept
+	{
+		// A verdict from an older generation would never get used
+		if (generation.Global != m_Generation.load(std::memory_order_acquire)) return;
+
+		const auto idx = Hash::GetShardIndex<NumShardBits>(std::hash<Address>{}(addr));
+		const auto current_steadytime = Util::GetCurrentSteadyTime();
+
+		m_Verdicts[idx].WithUniqueLock([&](VerdictMap& verdicts) noexcept
+		{
+			// The address (or another one in the shard) changed after the verdict was made
+			if (generation.Shard != m_ShardGenerations[idx].load(std::memory_order_acquire)) return;
+
+			try
+			{
+				if (verdicts.size() >= MaxEntriesPerShard)
+				{
+					// Make room by getting rid of the verdicts that can't be used anymore,
+					// and if that's not enough start over; this keeps the cache small
+					// even when lots of different addresses get checked
+					std::erase_if(verdicts, [&](const auto& it) noexcept
+					{
+						return !IsCurrent(it.second, generation.Global, current_steadytime);
+					});
+
+					if (verdicts.size() >= MaxEntriesPerShard) verdicts.clear();
+				}
+
+				verdicts.insert_or_assign(addr, Verdict{ generation.Global, current_steadytime, allowed });
+			}
+			catch (...)
+			{
+				// Not caching the verdict isn't a problem; it will get made again the next time
+			}
+		});
+	}
+
+	bool AccessVerdictCache::IsCurrent(const Verdict& verdict, const UInt64 generation,
+									   const SteadyTime current_steadytime) noexcept
+	{
+		if (verdict.Generation != generation) return false;
+
+		return (verdict.Allowed || (current_steadytime - verdict.AddedSteadyTime) < BlockedVerdictExpiration);
+	}
+}
@@ -0,0 +1,76 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#pragma once
+
+#include "..\..\Common\Containers.h"
+#include "..\..\Network\Address.h"
+#include "..\..\Concurrency\ThreadSafe.h"
+
+namespace QuantumGate::Implementation::Core::Access
+{
+	// Thread-safe cache of recent access verdicts for addresses, so that addresses that keep
+	// getting checked (such as for every datagram coming in on a listener) don't have to go
+	// through all the filters and reputations every time. Verdicts are only valid for the
+	// generation they were made in; bumping the generation after a change to the filters
+	// or limits invalidates all of them at once without having to touch the cache. A change
+	// that only affects one address (such as its reputation) only removes that verdict.
+	class AccessVerdictCache final
+	{
+		static constexpr Size NumShardBits{ 4 };
+		static constexpr Size NumShards{ Size{ 1 } << NumShardBits };
+		static constexpr Size MaxEntriesPerShard{ 512 };
+
+		// Reputations improve over time without a change to the generation,
+		// so that blocked verdicts are only kept for a short while
+		static constexpr std::chrono::seconds BlockedVerdictExpiration{ 1 };
+
+		struct Verdict final
+		{
+			UInt64 Generation{ 0 };
+			SteadyTime AddedSteadyTime;
+			bool Allowed{ false };
+		};
+
+		using VerdictMap = Containers::UnorderedMap<Address, Verdict>;
+		using VerdictMap_ThS = Concurrency::ThreadSafe<VerdictMap, std::shared_mutex>;
+
+	public:
+		// The shard generation goes up with every change to a single address in the
+		// shard, so that a verdict made before such a change doesn't get added after it
+		struct Generation final
+		{
+			UInt64 Global{ 0 };
+			UInt64 Shard{ 0 };
+		};
+
+		AccessVerdictCache() noexcept = default;
+		~AccessVerdictCache() = default;
+		AccessVerdictCache(const AccessVerdictCache&) = delete;
+		AccessVerdictCache(AccessVerdictCache&&) = delete;
+		AccessVerdictCache& operator=(const AccessVerdictCache&) = delete;
+		AccessVerdictCache& operator=(AccessVerdictCache&&) = delete;
+
+		// The generation should be gotten before the verdict is made and passed to
+		// AddVerdict() so that a change in between isn't missed
+		[[nodiscard]] Generation GetGeneration(const Address& addr) const noexcept;
+
+		// Should be called after every change that can affect the verdicts
+		inline void Invalidate() noexcept { m_Generation.fetch_add(1, std::memory_order_acq_rel); }
+
+		// Should be called after a change that can only affect the verdict for the address
+		void Invalidate(const Address& addr) noexcept;
+
+		[[nodiscard]] std::optional<bool> GetVerdict(const Address& addr) const noexcept;
+		void AddVerdict(const Address& addr, const Generation& generation, const bool allowed) noexcept;
+
+	private:
+		[[nodiscard]] static bool IsCurrent(const Verdict& verdict, const UInt64 generation,
+											const SteadyTime current_steadytime) noexcept;
+
+	private:
+		std::atomic<UInt64> m_Generation{ 0 };
+		std::array<VerdictMap_ThS, NumShards> m_Verdicts;
+		std::array<std::atomic<UInt64>, NumShards> m_ShardGenerations{};
+	};
+}
@@ -3,6 +3,7 @@
 
 #include "pch.h"
 #include "AddressAccessControl.h"
+#include "..\..\Common\Hash.h"
 
 using namespace std::literals;
 
@@ -15,6 +16,28 @@ namespace QuantumGate::Implementation::Core::Access
 		m_RelayConnectionAttempts.LastResetSteadyTime = Util::GetCurrentSteadyTime();
 	}
 
+	Int16 AddressAccessDetails::GetImprovedScore(const std::chrono::seconds interval,
+												 const std::chrono::seconds elapsed) const noexcept
+	{
+		if (elapsed < interval) return m_Reputation.Score;
+
+		Int64 factor{ 1 };
+		if (interval.count() > 0)
+		{
+			factor = elapsed.count() / interval.count();
+		}
+
+		Int64 new_score{ static_cast<Int64>(m_Reputation.Score) +
+			(static_cast<Int64>(AddressReputationUpdate::ImproveMinimal) * factor) };
+
+		if (new_score > AddressReputation::ScoreLimits::Maximum)
+		{
+			new_score = AddressReputation::ScoreLimits::Maximum;
+		}
+
+		return static_cast<Int16>(new_score);
+	}
+
 	void AddressAccessDetails::ImproveReputation(const std::chrono::seconds interval) noexcept
 	{
 		const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(
@@ -22,25 +45,17 @@ namespace QuantumGate::Implementation::Core::Access
 
 		if (seconds >= interval)
 		{
-			Int64 factor{ 1 };
-			if (interval.count() > 0)
-			{
-				factor = seconds.count() / interval.count();
-			}
-
-			Int64 new_score{ static_cast<Int64>(m_Reputation.Score) +
-				(static_cast<Int64>(AddressReputationUpdate::ImproveMinimal) * factor) };
-
-			if (new_score > AddressReputation::ScoreLimits::Maximum)
-			{
-				new_score = AddressReputation::ScoreLimits::Maximum;
-			}
-
-			m_Reputation.Score = static_cast<Int16>(new_score);
+			m_Reputation.Score = GetImprovedScore(interval, seconds);
 			m_Reputation.LastImproveSteadyTime = Util::GetCurrentSteadyTime();
 		}
 	}
 
+	Int16 AddressAccessDetails::GetCurrentScore(const std::chrono::seconds interval) const noexcept
+	{
+		return GetImprovedScore(interval, std::chrono::duration_cast<std::chrono::seconds>(
+			Util::GetCurrentSteadyTime() - m_Reputation.LastImproveSteadyTime));
+	}
+
 	bool AddressAccessDetails::SetReputation(const Int16 score, const std::optional<Time>& time) noexcept
 	{
 		if (score < AddressReputation::ScoreLimits::Minimum ||
@@ -144,7 +159,9 @@ namespace QuantumGate::Implementation::Core::Access
 	Result<> AddressAccessControl::SetReputation(const Address& addr, const Int16 score,
 												 const std::optional<Time>& time) noexcept
 	{
-		auto aad = GetAddressAccessDetails(addr);
+		auto shard = GetShard(addr).WithUniqueLock();
+
+		auto aad = GetAddressAccessDetails(*shard, addr);
 		if (aad != nullptr)
 		{
 			if (aad->SetReputation(score, time))
@@ -158,7 +175,9 @@ namespace QuantumGate::Implementation::Core::Access
 
 	Result<> AddressAccessControl::ResetReputation(const Address& addr) noexcept
 	{
-		auto aad = GetAddressAccessDetails(addr);
+		auto shard = GetShard(addr).WithUniqueLock();
+
+		auto aad = GetAddressAccessDetails(*shard, addr);
 		if (aad != nullptr)
 		{
 			aad->ResetReputation();
@@ -170,9 +189,15 @@ namespace QuantumGate::Implementation::Core::Access
 
 	void AddressAccessControl::ResetAllReputations() noexcept
 	{
-		for (auto& it : m_AddressAccessDetails)
+		for (auto& shard : m_AddressAccessDetails)
 		{
-			it.second.ResetReputation();
+			shard.WithUniqueLock([](auto& map) noexcept
+			{
+				for (auto& it : map)
+				{
+					it.second.ResetReputation();
+				}
+			});
 		}
 	}
 
@@ -181,7 +206,9 @@ namespace QuantumGate::Implementation::Core::Access
 	{
 		const auto interval = m_Settings->Local.AddressReputationImprovementInterval;
 
-		auto aad = GetAddressAccessDetails(addr);
+		auto shard = GetShard(addr).WithUniqueLock();
+
+		auto aad = GetAddressAccessDetails(*shard, addr);
 		if (aad != nullptr)
 		{
 			auto rep = aad->UpdateReputation(interval, rep_update);
@@ -192,15 +219,20 @@ namespace QuantumGate::Implementation::Core::Access
 		return ResultCode::Failed;
 	}
 
-	bool AddressAccessControl::HasAcceptableReputation(const Address& addr) noexcept
+	bool AddressAccessControl::HasAcceptableReputation(const Address& addr) const noexcept
 	{
-		const auto result = UpdateReputation(addr, AddressReputationUpdate::None);
-		if (result.Succeeded())
+		const auto interval = m_Settings->Local.AddressReputationImprovementInterval;
+
+		auto shard = GetShard(addr).WithSharedLock();
+
+		if (const auto it = shard->find(addr); it != shard->end())
 		{
-			return result->second;
+			return AddressAccessDetails::IsAcceptableReputation(it->second.GetCurrentScore(interval));
 		}
 
-		return false;
+		// Addresses we don't know about yet start out with the maximum score;
+		// they don't get added here so that checking stays read-only
+		return AddressAccessDetails::IsAcceptableReputation(AddressReputation::ScoreLimits::Maximum);
 	}
 
 	Result<Vector<AddressReputation>> AddressAccessControl::GetReputations() const noexcept
@@ -209,14 +241,20 @@ namespace QuantumGate::Implementation::Core::Access
 		{
 			Vector<AddressReputation> addr_reps;
 
-			for (const auto& it : m_AddressAccessDetails)
+			for (const auto& shard : m_AddressAccessDetails)
 			{
-				const auto [score, time] = it.second.GetReputation();
-
-				auto& addr_rep = addr_reps.emplace_back();
-				addr_rep.Address = it.first;
-				addr_rep.Score = score;
-				addr_rep.LastUpdateTime = time;
+				shard.WithSharedLock([&](const auto& map)
+				{
+					for (const auto& it : map)
+					{
+						const auto [score, time] = it.second.GetReputation();
+
+						auto& addr_rep = addr_reps.emplace_back();
+						addr_rep.Address = it.first;
+						addr_rep.Score = score;
+						addr_rep.LastUpdateTime = time;
+					}
+				});
 			}
 
 			return std::move(addr_reps);
@@ -232,7 +270,9 @@ namespace QuantumGate::Implementation::Core::Access
 		const auto interval = settings.Local.ConnectionAttempts.Interval;
 		const auto max_attempts = settings.Local.ConnectionAttempts.MaxPerInterval;
 
-		if (auto aad = GetAddressAccessDetails(addr); aad != nullptr)
+		auto shard = GetShard(addr).WithUniqueLock();
+
+		if (auto aad = GetAddressAccessDetails(*shard, addr); aad != nullptr)
 		{
 			return aad->AddConnectionAttempt(aad->GetConnectionAttempts(), interval, max_attempts);
 		}
@@ -246,7 +286,9 @@ namespace QuantumGate::Implementation::Core::Access
 		const auto interval = settings.Relay.ConnectionAttempts.Interval;
 		const auto max_attempts = settings.Relay.ConnectionAttempts.MaxPerInterval;
 
-		if (auto aad = GetAddressAccessDetails(addr); aad != nullptr)
+		auto shard = GetShard(addr).WithUniqueLock();
+
+		if (auto aad = GetAddressAccessDetails(*shard, addr); aad != nullptr)
 		{
 			return aad->AddConnectionAttempt(aad->GetRelayConnectionAttempts(), interval, max_attempts);
 		}
@@ -254,18 +296,29 @@ namespace QuantumGate::Implementation::Core::Access
 		return false;
 	}
 
-	AddressAccessDetails* AddressAccessControl::GetAddressAccessDetails(const Address& addr) noexcept
+	AddressAccessControl::AddressAccessDetailsMap_ThS& AddressAccessControl::GetShard(const Address& addr) noexcept
+	{
+		return m_AddressAccessDetails[Hash::GetShardIndex<NumShardBits>(std::hash<Address>{}(addr))];
+	}
+
+	const AddressAccessControl::AddressAccessDetailsMap_ThS& AddressAccessControl::GetShard(const Address& addr) const noexcept
+	{
+		return m_AddressAccessDetails[Hash::GetShardIndex<NumShardBits>(std::hash<Address>{}(addr))];
+	}
+
+	AddressAccessDetails* AddressAccessControl::GetAddressAccessDetails(AddressAccessDetailsMap& map,
+																		const Address& addr) noexcept
 	{
 		try
 		{
-			const auto it = m_AddressAccessDetails.find(addr);
-			if (it != m_AddressAccessDetails.end())
+			const auto it = map.find(addr);
+			if (it != map.end())
 			{
 				return &it->second;
 			}
 			else
 			{
-				const auto [it, success] = m_AddressAccessDetails.insert({ addr, AddressAccessDetails() });
+				const auto [it, success] = map.insert({ addr, AddressAccessDetails() });
 				if (success) return &it->second;
 			}
 		}
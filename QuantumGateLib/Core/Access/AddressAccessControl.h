@@ -6,6 +6,7 @@
 #include "..\..\API\Access.h"
 #include "..\..\Common\Containers.h"
 #include "..\..\Network\Address.h"
+#include "..\..\Concurrency\ThreadSafe.h"
 
 namespace QuantumGate::Implementation::Core::Access
 {
@@ -47,6 +48,10 @@ namespace QuantumGate::Implementation::Core::Access
 		Int16 UpdateReputation(const std::chrono::seconds interval, const AddressReputationUpdate rep_update) noexcept;
 		[[nodiscard]] std::pair<Int16, Time> GetReputation() const noexcept;
 
+		// Returns the score including the improvement over time that hasn't been
+		// applied yet, without changing anything so that it can be used with a shared lock
+		[[nodiscard]] Int16 GetCurrentScore(const std::chrono::seconds interval) const noexcept;
+
 		inline ConnectionAttempts& GetConnectionAttempts() noexcept { return m_ConnectionAttempts; }
 		inline ConnectionAttempts& GetRelayConnectionAttempts() noexcept { return m_RelayConnectionAttempts; }
 
@@ -59,6 +64,8 @@ namespace QuantumGate::Implementation::Core::Access
 		}
 
 	private:
+		[[nodiscard]] Int16 GetImprovedScore(const std::chrono::seconds interval,
+											 const std::chrono::seconds elapsed) const noexcept;
 		void ImproveReputation(const std::chrono::seconds interval) noexcept;
 		Int16 UpdateReputation(const AddressReputationUpdate rep_update) noexcept;
 
@@ -71,16 +78,25 @@ namespace QuantumGate::Implementation::Core::Access
 
 	using AddressAccessDetailsMap = Containers::UnorderedMap<Address, AddressAccessDetails>;
 
+	// Thread-safe; the addresses are spread over a number of shards by their hash and each
+	// shard has its own lock, so that threads checking different addresses (such as the
+	// listener threads when a lot of connections come in) don't have to wait for each other.
+	// Checking a reputation only takes a shared lock on the shard of the address.
 	class AddressAccessControl final
 	{
+		static constexpr Size NumShardBits{ 4 };
+		static constexpr Size NumShards{ Size{ 1 } << NumShardBits };
+
+		using AddressAccessDetailsMap_ThS = Concurrency::ThreadSafe<AddressAccessDetailsMap, std::shared_mutex>;
+
 	public:
 		AddressAccessControl() = delete;
 		AddressAccessControl(const Settings_CThS& settings) noexcept;
 		~AddressAccessControl() = default;
 		AddressAccessControl(const AddressAccessControl&) = delete;
-		AddressAccessControl(AddressAccessControl&&) noexcept = default;
+		AddressAccessControl(AddressAccessControl&&) = delete;
 		AddressAccessControl& operator=(const AddressAccessControl&) = delete;
-		AddressAccessControl& operator=(AddressAccessControl&&) noexcept = default;
+		AddressAccessControl& operator=(AddressAccessControl&&) = delete;
 
 		Result<> SetReputation(const Address& addrp, const Int16 score,
 							   const std::optional<Time>& time = std::nullopt) noexcept;
@@ -88,7 +104,7 @@ namespace QuantumGate::Implementation::Core::Access
 		void ResetAllReputations() noexcept;
 		Result<std::pair<Int16, bool>> UpdateReputation(const Address& addr,
 														const AddressReputationUpdate rep_update) noexcept;
-		[[nodiscard]] bool HasAcceptableReputation(const Address& addr) noexcept;
+		[[nodiscard]] bool HasAcceptableReputation(const Address& addr) const noexcept;
 
 		Result<Vector<AddressReputation>> GetReputations() const noexcept;
 
@@ -96,13 +112,15 @@ namespace QuantumGate::Implementation::Core::Access
 		[[nodiscard]] bool AddRelayConnectionAttempt(const Address& addr) noexcept;
 
 	private:
-		AddressAccessDetails* GetAddressAccessDetails(const Address& addr) noexcept;
+		[[nodiscard]] AddressAccessDetailsMap_ThS& GetShard(const Address& addr) noexcept;
+		[[nodiscard]] const AddressAccessDetailsMap_ThS& GetShard(const Address& addr) const noexcept;
+
+		[[nodiscard]] static AddressAccessDetails* GetAddressAccessDetails(AddressAccessDetailsMap& map,
+																		   const Address& addr) noexcept;
 
 	private:
 		const Settings_CThS& m_Settings;
 
-		AddressAccessDetailsMap m_AddressAccessDetails;
+		std::array<AddressAccessDetailsMap_ThS, NumShards> m_AddressAccessDetails;
 	};
-
-	using AddressAccessControl_ThS = Concurrency::ThreadSafe<AddressAccessControl, std::shared_mutex>;
 }
\ No newline at end of file
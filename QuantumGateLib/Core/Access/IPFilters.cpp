@@ -50,23 +50,13 @@ namespace QuantumGate::Implementation::Core::Access
 	{
 		IPAddress ip, mask;
 
-		if (IPAddress::TryParse(ip_str, ip))
+		const auto result_code = ParseFilter(ip_str, mask_str, ip, mask);
+		if (result_code == ResultCode::Succeeded)
 		{
-			if (IPAddress::TryParseMask(ip.GetFamily(), mask_str, mask))
-			{
-				return AddFilter(ip, mask, type);
-			}
-			else
-			{
-				LogErr(L"Could not add IP filter: Invalid IP address mask %s", mask_str);
-				return ResultCode::AddressMaskInvalid;
-			}
-		}
-		else
-		{
-			LogErr(L"Could not add IP filter: Unrecognized IP address %s", ip_str);
-			return ResultCode::AddressInvalid;
+			return AddFilter(ip, mask, type);
 		}
+
+		return result_code;
 	}
 
 	Result<IPFilterID> IPFilters::AddFilter(const String& ip_str, const String& mask_str,
@@ -91,6 +81,115 @@ namespace QuantumGate::Implementation::Core::Access
 		return ResultCode::InvalidArgument;
 	}
 
+	Result<Vector<IPFilterID>> IPFilters::AddFilters(const Vector<String>& ip_cidrs,
+													 const IPFilterType type) noexcept
+	{
+		switch (type)
+		{
+			case IPFilterType::Allowed:
+			case IPFilterType::Blocked:
+				break;
+			default:
+				assert(false);
+				return ResultCode::InvalidArgument;
+		}
+
+		Vector<IPFilterID> added_filterids;
+
+		try
+		{
+			// All filters get parsed before any get added so that
+			// nothing needs to be undone for invalid input
+			Vector<std::pair<IPAddress, IPAddress>> filters;
+			filters.reserve(ip_cidrs.size());
+
+			// Same CIDR notation as for adding a single filter
+			const std::wregex r(LR"r(^\s*(.*)(\/\d+)\s*$)r");
+			std::wsmatch m;
+
+			for (const auto& ip_cidr : ip_cidrs)
+			{
+				if (!std::regex_search(ip_cidr, m, r))
+				{
+					LogErr(L"Could not add IP filters: invalid CIDR notation %s", ip_cidr.c_str());
+					return ResultCode::AddressMaskInvalid;
+				}
+
+				auto& filter = filters.emplace_back();
+
+				const auto result_code = ParseFilter(m[1].str().c_str(), m[2].str().c_str(),
+													 filter.first, filter.second);
+				if (result_code != ResultCode::Succeeded) return result_code;
+			}
+
+			auto& fltmap = (type == IPFilterType::Allowed) ? m_IPAllowFilters : m_IPBlockFilters;
+			auto& networks = (type == IPFilterType::Allowed) ? m_IPAllowNetworks : m_IPBlockNetworks;
+
+			fltmap.reserve(fltmap.size() + filters.size());
+			networks.Reserve(networks.GetSize() + filters.size());
+
+			Vector<IPFilterID> filterids;
+			filterids.reserve(filters.size());
+			added_filterids.reserve(filters.size());
+
+			auto success = true;
+
+			for (const auto& filter : filters)
+			{
+				const auto filterid = GetFilterID(filter.first, filter.second);
+				if (!HasFilter(filterid, type))
+				{
+					const auto result = AddFilterImpl(filter.first, filter.second, type);
+					if (result.Failed())
+					{
+						success = false;
+						break;
+					}
+
+					added_filterids.emplace_back(*result);
+				}
+
+				filterids.emplace_back(filterid);
+			}
+
+			if (success) return filterids;
+		}
+		catch (...) {}
+
+		// Undo the filters that were added
+		for (const auto filterid : added_filterids)
+		{
+			[[maybe_unused]] const auto result = RemoveFilter(filterid, type);
+			assert(result.Succeeded());
+		}
+
+		LogErr(L"Could not add IP filters");
+
+		return ResultCode::Failed;
+	}
+
+	ResultCode IPFilters::ParseFilter(const WChar* ip_str, const WChar* mask_str,
+									  IPAddress& ip, IPAddress& mask) noexcept
+	{
+		if (IPAddress::TryParse(ip_str, ip))
+		{
+			if (IPAddress::TryParseMask(ip.GetFamily(), mask_str, mask))
+			{
+				return ResultCode::Succeeded;
+			}
+			else
+			{
+				LogErr(L"Could not add IP filter: Invalid IP address mask %s", mask_str);
+				return ResultCode::AddressMaskInvalid;
+			}
+		}
+		else
+		{
+			LogErr(L"Could not add IP filter: Unrecognized IP address %s", ip_str);
+			return ResultCode::AddressInvalid;
+		}
+	}
+
 	Result<IPFilterID> IPFilters::AddFilterImpl(const IPAddress& ip, const IPAddress& mask,
 												const IPFilterType type) noexcept
 	{
@@ -106,24 +205,23 @@ namespace QuantumGate::Implementation::Core::Access
 
 				if (!HasFilter(ipfilter.ID, type))
 				{
-					const auto range = BinaryIPAddress::GetAddressRange(ipfilter.Address.GetBinary(),
-																		ipfilter.Mask.GetBinary());
-					if (range.has_value())
+					if (BinaryIPAddress::GetCIDRLeadingBits(ipfilter.Mask.GetBinary(), ipfilter.CIDRLeadingBits))
 					{
-						ipfilter.StartAddress = range->first;
-						ipfilter.EndAddress = range->second;
+						auto& fltmap = (ipfilter.Type == IPFilterType::Allowed) ? m_IPAllowFilters : m_IPBlockFilters;
+						auto& networks = (ipfilter.Type == IPFilterType::Allowed) ? m_IPAllowNetworks : m_IPBlockNetworks;
 
-						switch (ipfilter.Type)
+						const auto [it, inserted] = fltmap.insert({ ipfilter.ID, ipfilter });
+						if (inserted)
 						{
-							case IPFilterType::Allowed:
-								m_IPAllowFilters[ipfilter.ID] = ipfilter;
-								break;
-							case IPFilterType::Blocked:
-								m_IPBlockFilters[ipfilter.ID] = ipfilter;
-								break;
+							if (AddFilterNetwork(networks, ipfilter))
+							{
+								return ipfilter.ID;
+							}
+
+							fltmap.erase(it);
 						}
 
-						return ipfilter.ID;
+						LogErr(L"Could not add IP filter: failed to add IP range");
 					}
 					else LogErr(L"Could not add IP filter: failed to get IP range");
 				}
@@ -141,21 +239,28 @@ namespace QuantumGate::Implementation::Core::Access
 		try
 		{
 			IPFilterMap* fltmap{ nullptr };
+			IPFilterNetworks* networks{ nullptr };
 
 			switch (type)
 			{
 				case IPFilterType::Allowed:
 					fltmap = &m_IPAllowFilters;
+					networks = &m_IPAllowNetworks;
 					break;
 				case IPFilterType::Blocked:
 					fltmap = &m_IPBlockFilters;
+					networks = &m_IPBlockNetworks;
 					break;
 				default:
 					return ResultCode::InvalidArgument;
 			}
 
-			if (fltmap->erase(filterid) != 0)
+			const auto it = fltmap->find(filterid);
+			if (it != fltmap->end())
 			{
+				RemoveFilterNetwork(*networks, it->second);
+				fltmap->erase(it);
+
 				return ResultCode::Succeeded;
 			}
 			else LogErr(L"Could not remove IP filter: filter does not exist");
@@ -169,9 +274,16 @@ namespace QuantumGate::Implementation::Core::Access
 	{
 		m_IPAllowFilters.clear();
 		m_IPBlockFilters.clear();
+		m_IPAllowNetworks.Clear();
+		m_IPBlockNetworks.Clear();
 	}
 
 	bool IPFilters::HasFilter(const IPFilterID filterid, const IPFilterType type) const noexcept
+	{
+		return (GetFilter(filterid, type) != nullptr);
+	}
+
+	const IPFilterImpl* IPFilters::GetFilter(const IPFilterID filterid, const IPFilterType type) const noexcept
 	{
 		const IPFilterMap* fltmap{ nullptr };
 
@@ -184,10 +296,15 @@ namespace QuantumGate::Implementation::Core::Access
 				fltmap = &m_IPBlockFilters;
 				break;
 			default:
-				return false;
+				return nullptr;
+		}
+
+		if (const auto it = fltmap->find(filterid); it != fltmap->end())
+		{
+			return &it->second;
 		}
 
-		return (fltmap->find(filterid) != fltmap->end());
+		return nullptr;
 	}
 
 	Result<Vector<IPFilter>> IPFilters::GetFilters() const noexcept
@@ -216,28 +333,39 @@ namespace QuantumGate::Implementation::Core::Access
 		return ResultCode::Failed;
 	}
 
-	bool IPFilters::IsIPInFilterMap(const IPAddress& address, const IPFilterMap& filtermap) const noexcept
+	bool IPFilters::AddFilterNetwork(IPFilterNetworks& networks, const IPFilterImpl& ipfilter) noexcept
 	{
-		for (const auto& fltpair : filtermap)
+		try
 		{
-			const auto& filter = fltpair.second;
-
-			if (filter.Address.GetFamily() == address.GetFamily())
+			const auto [count, inserted] = networks.Insert(ipfilter.Address.GetBinary(),
+														   ipfilter.CIDRLeadingBits, Size{ 1 });
+			if (count != nullptr)
 			{
-				const auto[success, inrange] = BinaryIPAddress::IsInAddressRange(address.GetBinary(),
-																				 filter.StartAddress, filter.EndAddress);
-				if (success && inrange)
-				{
-					// If the IP address was within the filter range of at least one filter
-					// we can stop looking immediately
-					return true;
-				}
+				// Another filter already has the same network
+				if (!inserted) ++(*count);
+
+				return true;
 			}
 		}
+		catch (...) {}
 
 		return false;
 	}
 
+	void IPFilters::RemoveFilterNetwork(IPFilterNetworks& networks, const IPFilterImpl& ipfilter) noexcept
+	{
+		const auto count = networks.Find(ipfilter.Address.GetBinary(), ipfilter.CIDRLeadingBits);
+		if (count != nullptr)
+		{
+			// The network stays as long as other filters have it
+			if (--(*count) == 0)
+			{
+				networks.Remove(ipfilter.Address.GetBinary(), ipfilter.CIDRLeadingBits);
+			}
+		}
+		else assert(false);
+	}
+
 	const IPFilterID IPFilters::GetFilterID(const IPAddress& ip, const IPAddress& mask) const noexcept
 	{
 		return Hash::GetNonPersistentHash(ip.GetString() + mask.GetString());
@@ -263,8 +391,8 @@ namespace QuantumGate::Implementation::Core::Access
 		// ranges, they can still be blocked if they also exist in one of the blocked filter
 		// ranges.
 
-		// If the IP address is not in the allowed filter ranges we can return true immediately
-		if (!IsIPInFilterMap(ipaddr, m_IPAllowFilters))
+		// If the IP address is not in the allowed filter ranges we can return false immediately
+		if (!m_IPAllowNetworks.HasMatch(ipaddr.GetBinary()))
 		{
 			return false;
 		}
@@ -272,7 +400,7 @@ namespace QuantumGate::Implementation::Core::Access
 		{
 			// If the IP address is in the allowed filter ranges check if it's also in the blocked
 			// filter ranges, in which case it was explicitly blocked
-			if (IsIPInFilterMap(ipaddr, m_IPBlockFilters))
+			if (m_IPBlockNetworks.HasMatch(ipaddr.GetBinary()))
 			{
 				return false;
 			}
@@ -6,6 +6,7 @@
 #include "..\..\API\Access.h"
 #include "..\..\Common\Containers.h"
 #include "..\..\Network\IPAddress.h"
+#include "..\..\Network\IPAddressTrie.h"
 #include "..\..\Concurrency\ThreadSafe.h"
 
 namespace QuantumGate::Implementation::Core::Access
@@ -18,12 +19,15 @@ namespace QuantumGate::Implementation::Core::Access
 		IPFilterType Type{ IPFilterType::Blocked };
 		IPAddress Address;
 		IPAddress Mask;
-		Network::BinaryIPAddress StartAddress; // Network byte order (big endian)
-		Network::BinaryIPAddress EndAddress; // Network byte order (big endian)
+		UInt8 CIDRLeadingBits{ 0 };
 	};
 
 	using IPFilterMap = Containers::UnorderedMap<IPFilterID, IPFilterImpl>;
 
+	// Number of filters for each network; filters with addresses
+	// that only differ in the host bits have the same network
+	using IPFilterNetworks = Network::IPAddressTrie<Size>;
+
 	class Export IPFilters final
 	{
 	public:
@@ -43,11 +47,18 @@ namespace QuantumGate::Implementation::Core::Access
 		Result<IPFilterID> AddFilter(const IPAddress& ip, const IPAddress& mask,
 									 const IPFilterType type) noexcept;
 
+		// Adds filters in CIDR notation in one go, for importing large lists; either all filters
+		// get added or none of them. Filters that already exist are not an error and their IDs
+		// get returned like those of the new filters.
+		Result<Vector<IPFilterID>> AddFilters(const Vector<String>& ip_cidrs,
+											  const IPFilterType type) noexcept;
+
 		Result<> RemoveFilter(const IPFilterID filterid, const IPFilterType type) noexcept;
 
 		void Clear() noexcept;
 
 		[[nodiscard]] bool HasFilter(const IPFilterID filterid, const IPFilterType type) const noexcept;
+		[[nodiscard]] const IPFilterImpl* GetFilter(const IPFilterID filterid, const IPFilterType type) const noexcept;
 
 		Result<Vector<IPFilter>> GetFilters() const noexcept;
 
@@ -58,13 +69,19 @@ namespace QuantumGate::Implementation::Core::Access
 		Result<IPFilterID> AddFilterImpl(const IPAddress& ip, const IPAddress& mask,
 										 const IPFilterType type) noexcept;
 
-		[[nodiscard]] bool IsIPInFilterMap(const IPAddress& address, const IPFilterMap& filtermap) const noexcept;
+		[[nodiscard]] static ResultCode ParseFilter(const WChar* ip_str, const WChar* mask_str,
+													IPAddress& ip, IPAddress& mask) noexcept;
+
+		[[nodiscard]] static bool AddFilterNetwork(IPFilterNetworks& networks, const IPFilterImpl& ipfilter) noexcept;
+		static void RemoveFilterNetwork(IPFilterNetworks& networks, const IPFilterImpl& ipfilter) noexcept;
 
 		const IPFilterID GetFilterID(const IPAddress& ip, const IPAddress& mask) const noexcept;
 
 	private:
 		IPFilterMap m_IPAllowFilters;
 		IPFilterMap m_IPBlockFilters;
+		IPFilterNetworks m_IPAllowNetworks;
+		IPFilterNetworks m_IPBlockNetworks;
 	};
 
 	using IPFilters_ThS = Concurrency::ThreadSafe<IPFilters, std::shared_mutex>;
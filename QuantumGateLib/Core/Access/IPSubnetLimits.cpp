@@ -121,30 +121,31 @@ namespace QuantumGate::Implementation::Core::Access
 
 	Result<> IPSubnetLimits::RemoveLimit(const IPAddress::Family af, const UInt8 cidr_lbits) noexcept
 	{
-		auto subnets = GetSubnets(af);
-		if (subnets != nullptr)
+		try
 		{
-			const auto it = subnets->Limits.find(cidr_lbits);
-			if (it != subnets->Limits.end())
+			auto subnets = GetSubnets(af);
+			if (subnets != nullptr)
 			{
-				// Remove limit details for this limit
-				for (auto it2 = m_IPSubnetLimitDetails.begin(); it2 != m_IPSubnetLimitDetails.end();)
+				const auto it = subnets->Limits.find(cidr_lbits);
+				if (it != subnets->Limits.end())
 				{
-					if (it2->second.AddressFamily == it->second.AddressFamily &&
-						it2->second.CIDRLeadingBits == it->second.CIDRLeadingBits)
+					// Remove limit details for this limit
+					m_IPSubnetLimitDetails.RemoveIf([&](const BinaryIPAddress& subnet, const UInt8 subnet_lbits,
+														const IPSubnetLimitDetail&) noexcept
 					{
-						it2 = m_IPSubnetLimitDetails.erase(it2);
-					}
-					else ++it2;
-				}
+						return (subnet.AddressFamily == it->second.AddressFamily &&
+								subnet_lbits == it->second.CIDRLeadingBits);
+					});
 
-				// Remove limit
-				subnets->Limits.erase(it);
+					// Remove limit
+					subnets->Limits.erase(it);
 
-				return ResultCode::Succeeded;
+					return ResultCode::Succeeded;
+				}
+				else LogErr(L"Subnet limits: could not remove limit; limit does not exist");
 			}
-			else LogErr(L"Subnet limits: could not remove limit; limit does not exist");
 		}
+		catch (...) {}
 
 		return ResultCode::Failed;
 	}
@@ -178,7 +179,7 @@ namespace QuantumGate::Implementation::Core::Access
 	{
 		m_IPv4Subnets.Clear();
 		m_IPv6Subnets.Clear();
-		m_IPSubnetLimitDetails.clear();
+		m_IPSubnetLimitDetails.Clear();
 	}
 
 	bool IPSubnetLimits::HasLimit(const IPAddress::Family af, const UInt8 cidr_lbits) const noexcept
@@ -330,30 +331,22 @@ namespace QuantumGate::Implementation::Core::Access
 	{
 		try
 		{
-			const auto subnet = ip.GetBinary() & limit.SubnetMask;
-
-			const auto it = m_IPSubnetLimitDetails.find(subnet);
-			if (it == m_IPSubnetLimitDetails.end())
+			const auto [ldetail, inserted] = m_IPSubnetLimitDetails.Insert(ip.GetBinary(), limit.CIDRLeadingBits,
+																		   IPSubnetLimitDetail{ num });
+			if (ldetail == nullptr)
 			{
-				IPSubnetLimitDetail ldetail(limit.AddressFamily, limit.CIDRLeadingBits);
-				ldetail.CurrentConnections = num;
-
-				const auto[dit, retval] = m_IPSubnetLimitDetails.insert({ subnet, ldetail });
-				if (!retval)
-				{
-					LogErr(L"Subnet limits: could not add limit details for subnet /%u, address %s",
-						   limit.CIDRLeadingBits, ip.GetString().c_str());
-					return false;
-				}
+				LogErr(L"Subnet limits: could not add limit details for subnet /%u, address %s",
+					   limit.CIDRLeadingBits, ip.GetString().c_str());
+				return false;
 			}
-			else
+			else if (!inserted)
 			{
-				if ((it->second.CurrentConnections < limit.MaximumConnections) ||
-					(allow_overflow && it->second.CurrentConnections >= limit.MaximumConnections))
+				if ((ldetail->CurrentConnections < limit.MaximumConnections) ||
+					(allow_overflow && ldetail->CurrentConnections >= limit.MaximumConnections))
 				{
-					if (std::numeric_limits<Size>::max() - num >= it->second.CurrentConnections)
+					if (std::numeric_limits<Size>::max() - num >= ldetail->CurrentConnections)
 					{
-						it->second.CurrentConnections += num;
+						ldetail->CurrentConnections += num;
 					}
 					else return false;
 				}
@@ -389,14 +382,12 @@ namespace QuantumGate::Implementation::Core::Access
 
 	bool IPSubnetLimits::RemoveLimitConnection(const IPSubnetLimitImpl& limit, const IPAddress& ip) noexcept
 	{
-		const auto subnet = ip.GetBinary() & limit.SubnetMask;
-
-		const auto it = m_IPSubnetLimitDetails.find(subnet);
-		if (it != m_IPSubnetLimitDetails.end())
+		const auto ldetail = m_IPSubnetLimitDetails.Find(ip.GetBinary(), limit.CIDRLeadingBits);
+		if (ldetail != nullptr)
 		{
-			if (it->second.CurrentConnections > 0)
+			if (ldetail->CurrentConnections > 0)
 			{
-				--it->second.CurrentConnections;
+				--ldetail->CurrentConnections;
 			}
 			else
 			{
@@ -406,9 +397,9 @@ namespace QuantumGate::Implementation::Core::Access
 				return false;
 			}
 
-			if (it->second.CurrentConnections == 0)
+			if (ldetail->CurrentConnections == 0)
 			{
-				m_IPSubnetLimitDetails.erase(it);
+				m_IPSubnetLimitDetails.Remove(ip.GetBinary(), limit.CIDRLeadingBits);
 			}
 		}
 		else
@@ -429,21 +420,20 @@ namespace QuantumGate::Implementation::Core::Access
 		auto subnets = GetSubnets(ip.GetFamily());
 		if (subnets != nullptr)
 		{
-			for (const auto& limit : subnets->Limits)
+			m_IPSubnetLimitDetails.ForEachMatch(ip.GetBinary(), [&](const UInt8 cidr_lbits,
+																	const IPSubnetLimitDetail& ldetail) noexcept
 			{
-				const auto subnet = ip.GetBinary() & limit.second.SubnetMask;
-
-				const auto it = m_IPSubnetLimitDetails.find(subnet);
-				if (it != m_IPSubnetLimitDetails.end())
+				const auto it = subnets->Limits.find(cidr_lbits);
+				if (it != subnets->Limits.end() &&
+					ldetail.CurrentConnections > it->second.MaximumConnections)
 				{
-					if (it->second.CurrentConnections > limit.second.MaximumConnections)
-					{
-						// Too many connections on this subnet
-						overflow = true;
-						break;
-					}
+					// Too many connections on this subnet
+					overflow = true;
+					return false;
 				}
-			}
+
+				return true;
+			});
 		}
 
 		return overflow;
@@ -462,34 +452,33 @@ namespace QuantumGate::Implementation::Core::Access
 
 	bool IPSubnetLimits::CanAcceptConnection(const IPSubnetLimitMap& map, const IPAddress& ip) const noexcept
 	{
-		auto success = true;
-
 		for (const auto& limit : map)
 		{
-			const auto subnet = ip.GetBinary() & limit.second.SubnetMask;
-
-			const auto it = m_IPSubnetLimitDetails.find(subnet);
-			if (it != m_IPSubnetLimitDetails.end())
+			// Subnets without connections have no details, so
+			// check here if connections are allowed at all
+			if (limit.second.MaximumConnections == 0)
 			{
-				if (it->second.CurrentConnections >= limit.second.MaximumConnections)
-				{
-					// No connections allowed anymore on this subnet
-					success = false;
-					break;
-				}
+				// No connections allowed on this subnet
+				return false;
 			}
-			else
+		}
+
+		auto success = true;
+
+		// Only the subnets of the address that already have connections
+		m_IPSubnetLimitDetails.ForEachMatch(ip.GetBinary(), [&](const UInt8 cidr_lbits,
+																const IPSubnetLimitDetail& ldetail) noexcept
+		{
+			const auto it = map.find(cidr_lbits);
+			if (it != map.end() && ldetail.CurrentConnections >= it->second.MaximumConnections)
 			{
-				// Subnet not found; probably no connections yet accepted;
-				// check if connections are allowed
-				if (limit.second.MaximumConnections == 0)
-				{
-					// No connections allowed on this subnet
-					success = false;
-					break;
-				}
+				// No connections allowed anymore on this subnet
+				success = false;
+				return false;
 			}
-		}
+
+			return true;
+		});
 
 		return success;
 	}
@@ -6,6 +6,7 @@
 #include "..\..\API\Access.h"
 #include "..\..\Common\Containers.h"
 #include "..\..\Network\IPAddress.h"
+#include "..\..\Network\IPAddressTrie.h"
 #include "..\..\Concurrency\ThreadSafe.h"
 
 namespace QuantumGate::Implementation::Core::Access
@@ -30,15 +31,13 @@ namespace QuantumGate::Implementation::Core::Access
 
 	struct IPSubnetLimitDetail final
 	{
-		IPSubnetLimitDetail(const IPAddress::Family af, const UInt8 cidr_lbits) noexcept :
-			AddressFamily(af), CIDRLeadingBits(cidr_lbits) {}
-
-		IPAddress::Family AddressFamily{ IPAddress::Family::Unspecified };
-		UInt8 CIDRLeadingBits{ 0 };
 		Size CurrentConnections{ 0 };
 	};
 
-	using IPSubnetLimitDetailMap = Containers::UnorderedMap<Network::BinaryIPAddress, IPSubnetLimitDetail>;
+	// Details for each subnet that has connections; the prefix length of
+	// a subnet is the number of CIDR leading bits of the limit it's for,
+	// so all subnets of an address can be found in a single lookup
+	using IPSubnetLimitDetails = Network::IPAddressTrie<IPSubnetLimitDetail>;
 
 	struct IPSubnetConnection final
 	{
@@ -105,7 +104,7 @@ namespace QuantumGate::Implementation::Core::Access
 	private:
 		IPSubnetAF m_IPv4Subnets;
 		IPSubnetAF m_IPv6Subnets;
-		IPSubnetLimitDetailMap m_IPSubnetLimitDetails;
+		IPSubnetLimitDetails m_IPSubnetLimitDetails;
 	};
 
 	using IPSubnetLimits_ThS = Concurrency::ThreadSafe<IPSubnetLimits, std::shared_mutex>;
@@ -22,7 +22,8 @@ namespace QuantumGate::Implementation::Core::BTH::Listener
 
 		PreStartup();
 
-		const auto& settings = m_Settings.GetCache();
+		const auto settings_snapshot = m_Settings.GetSnapshot();
+		const auto& settings = *settings_snapshot;
 		const auto& listener_ports = settings.Local.Listeners.BTH.Ports;
 		const auto require_auth = settings.Local.Listeners.BTH.RequireAuthentication;
 		const auto discoverable = settings.Local.Listeners.BTH.Discoverable;
@@ -60,7 +61,8 @@ namespace QuantumGate::Implementation::Core::BTH::Listener
 
 		PreStartup();
 
-		const auto& settings = m_Settings.GetCache();
+		const auto settings_snapshot = m_Settings.GetSnapshot();
+		const auto& settings = *settings_snapshot;
 		const auto& listener_ports = settings.Local.Listeners.BTH.Ports;
 		const auto require_auth = settings.Local.Listeners.BTH.RequireAuthentication;
 		const auto discoverable = settings.Local.Listeners.BTH.Discoverable;
@@ -185,7 +187,8 @@ namespace QuantumGate::Implementation::Core::BTH::Listener
 
 		LogSys(L"Updating BTH listenermanager...");
 
-		const auto& settings = m_Settings.GetCache();
+		const auto settings_snapshot = m_Settings.GetSnapshot();
+		const auto& settings = *settings_snapshot;
 		const auto& listener_ports = settings.Local.Listeners.BTH.Ports;
 		const auto require_auth = settings.Local.Listeners.BTH.RequireAuthentication;
 		const auto& service_details = settings.Local.Listeners.BTH.Service;
@@ -252,7 +255,8 @@ namespace QuantumGate::Implementation::Core::BTH::Listener
 
 		LogSys(L"BTH listenermanager shutting down...");
 
-		const auto& settings = m_Settings.GetCache();
+		const auto settings_snapshot = m_Settings.GetSnapshot();
+		const auto& settings = *settings_snapshot;
 		const auto& service_details = settings.Local.Listeners.BTH.Service;
 
 		DisableDiscovery();
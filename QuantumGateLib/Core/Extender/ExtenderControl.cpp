@@ -135,10 +135,9 @@ namespace QuantumGate::Implementation::Core::Extender
 	{
 		std::shared_ptr<Peer_ThS> peerctrl = nullptr;
 
-		thpdata.Queue.PopFrontIf([&](auto& fpeer) noexcept -> bool
+		thpdata.Queue.PopFront([&](auto& fpeer) noexcept
 		{
 			peerctrl = std::move(fpeer);
-			return true;
 		});
 
 		if (peerctrl != nullptr)
@@ -296,8 +295,8 @@ namespace QuantumGate::Implementation::Core::Extender
 
 				if (!peer.IsInQueue)
 				{
-					data->ThreadPools[thpoolkey]->GetData().Queue.Push(peerctrl,
-																	   [&]() noexcept { peer.IsInQueue = true; });
+					data->ThreadPools[thpoolkey]->GetData().Queue.Push(peerctrl);
+					peer.IsInQueue = true;
 				}
 			});
 
@@ -3,7 +3,7 @@
 
 #pragma once
 
-#include "..\..\Concurrency\Queue.h"
+#include "..\..\Concurrency\MPMCQueue.h"
 #include "..\..\Concurrency\ThreadSafe.h"
 #include "..\..\Concurrency\ThreadPool.h"
 #include "..\Peer\PeerEvent.h"
@@ -54,7 +54,7 @@ namespace QuantumGate::Implementation::Core::Extender
 
 		using PeerMap = Containers::UnorderedMap<PeerLUID, std::shared_ptr<Peer_ThS>>;
 
-		using Queue_ThS = Concurrency::Queue<std::shared_ptr<Peer_ThS>>;
+		using Queue_ThS = Concurrency::MPMCQueue<std::shared_ptr<Peer_ThS>>;
 
 		struct ThreadPoolData final
 		{
@@ -696,7 +696,7 @@ namespace QuantumGate::Implementation::Core::Extender
 	{
 		try
 		{
-			m_ActiveExtenderUUIDs.UpdateValue([&](ActiveExtenderUUIDs& extuuids)
+			const auto updated = m_ActiveExtenderUUIDs.UpdateValue([&](ActiveExtenderUUIDs& extuuids)
 			{
 				extuuids.UUIDs.clear();
 				extuuids.SerializedUUIDs.clear();
@@ -710,6 +710,11 @@ namespace QuantumGate::Implementation::Core::Extender
 					}
 				}
 			});
+
+			if (!updated)
+			{
+				LogErr(L"Extendermanager failed to update the active extender list");
+			}
 		}
 		catch (const std::exception& e)
 		{
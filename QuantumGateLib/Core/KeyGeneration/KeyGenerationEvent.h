@@ -4,19 +4,59 @@
 #pragma once
 
 #include "..\..\Common\Containers.h"
+#include "..\..\Common\Callback.h"
 #include "..\..\Crypto\KeyData.h"
 #include "..\..\Concurrency\SharedSpinMutex.h"
 
 namespace QuantumGate::Implementation::Core::KeyGeneration
 {
+	// Request for a keypair by someone waiting for it (such as a peer in the middle
+	// of a handshake) when no pre-generated keypair was available; the callback gets
+	// called from a key generation thread when the request completes. KeyData will be
+	// empty if the keypair couldn't be generated.
+	struct KeyRequest final
+	{
+		KeyRequest(const Algorithm::Asymmetric alg, Callback<void() noexcept>&& callback) noexcept :
+			Algorithm(alg), CompletionCallback(std::move(callback))
+		{}
+
+		Algorithm::Asymmetric Algorithm{ Algorithm::Asymmetric::Unknown };
+		std::optional<Crypto::AsymmetricKeyData> KeyData;
+		bool Completed{ false };
+		Callback<void() noexcept> CompletionCallback;
+	};
+
+	using KeyRequest_ThS = Concurrency::ThreadSafe<KeyRequest, Concurrency::SpinMutex>;
+
 	struct KeyQueue final
 	{
 		KeyQueue(const Algorithm::Asymmetric alg) noexcept : Algorithm(alg) {}
 
 		Algorithm::Asymmetric Algorithm{ Algorithm::Asymmetric::Unknown };
 		Containers::Queue<Crypto::AsymmetricKeyData> Queue;
+
+		// Requests waiting for a keypair get served before the queue gets
+		// refilled; the requester drops the request when it's no longer interested
+		Containers::Queue<std::weak_ptr<KeyRequest_ThS>> Requests;
 		Size NumPendingEvents{ 0 };
 		bool Active{ true };
+
+		// Number of keys the queue gets filled up to; this adapts to the demand
+		// and the generation time (see Manager::UpdateQueueSizes())
+		Size TargetSize{ 0 };
+
+		// Number of times a key was needed since the last
+		// update, and the resulting (smoothed) keys per second
+		Size NumNeeded{ 0 };
+		double NeededRate{ 0.0 };
+
+		// Times a key was (not) available in the queue when needed
+		UInt64 NumHits{ 0 };
+		UInt64 NumMisses{ 0 };
+
+		// Smoothed time to generate a key and the memory a key takes
+		std::chrono::nanoseconds GenerationTime{ 0 };
+		Size KeySize{ 0 };
 	};
 
 	using KeyQueue_ThS = Concurrency::ThreadSafe<KeyQueue, Concurrency::SpinMutex>;
@@ -3,6 +3,7 @@
 
 #include "pch.h"
 #include "KeyGenerationManager.h"
+#include "KeyPoolFile.h"
 #include "..\..\Crypto\Crypto.h"
 
 using namespace std::literals;
@@ -26,7 +27,22 @@ namespace QuantumGate::Implementation::Core::KeyGeneration
 
 		PreStartup();
 
-		if (!AddKeyQueues() || !StartupThreadPool())
+		if (!AddKeyQueues())
+		{
+			ClearKeyQueues();
+
+			LogErr(L"Keymanager startup failed");
+
+			return false;
+		}
+
+		// Start out with the keys left over from
+		// before the last shutdown, if any
+		LoadKeyPoolFile();
+
+		m_ThreadPool.GetData().LastQueueSizeUpdateSteadyTime = Util::GetCurrentSteadyTime();
+
+		if (!StartupThreadPool())
 		{
 			ShutdownThreadPool();
 			ClearKeyQueues();
@@ -56,6 +72,9 @@ namespace QuantumGate::Implementation::Core::KeyGeneration
 
 		ShutdownThreadPool();
 
+		// Keep the keys we didn't use for the next startup
+		SaveKeyPoolFile();
+
 		ResetState();
 
 		LogSys(L"Keymanager shut down");
@@ -100,6 +119,11 @@ namespace QuantumGate::Implementation::Core::KeyGeneration
 					[[maybe_unused]] const auto [it, inserted] =
 						queues.insert({ alg, std::make_unique<KeyQueue_ThS>(alg) });
 
+					if (inserted)
+					{
+						it->second->WithUniqueLock()->TargetSize = settings.Local.NumPreGeneratedKeysPerAlgorithm;
+					}
+
 					assert(inserted);
 					if (!inserted)
 					{
@@ -122,7 +146,133 @@ namespace QuantumGate::Implementation::Core::KeyGeneration
 
 	void Manager::ClearKeyQueues() noexcept
 	{
-		m_KeyQueues.WithUniqueLock()->clear();
+		Vector<std::shared_ptr<KeyRequest_ThS>> requests;
+
+		m_KeyQueues.WithUniqueLock([&](KeyQueueMap& queues)
+		{
+			for (auto& queue : queues)
+			{
+				queue.second->WithUniqueLock([&](KeyQueue& key_queue)
+				{
+					while (!key_queue.Requests.empty())
+					{
+						if (auto request = key_queue.Requests.front().lock(); request != nullptr)
+						{
+							try
+							{
+								requests.emplace_back(std::move(request));
+							}
+							catch (...) {}
+						}
+
+						key_queue.Requests.pop();
+						--m_NumPendingRequests;
+					}
+				});
+			}
+
+			queues.clear();
+		});
+
+		// Requests that are still waiting won't get a keypair
+		// from us anymore; let the requesters know
+		for (auto& request : requests)
+		{
+			CompleteRequest(*request, std::nullopt);
+		}
+	}
+
+	void Manager::LoadKeyPoolFile() noexcept
+	{
+		const auto& settings = GetSettings();
+		if (settings.Local.PreGeneratedKeysFile.Path.empty()) return;
+
+		try
+		{
+			KeyPoolFile file(settings.Local.PreGeneratedKeysFile.Path, settings.Local.PreGeneratedKeysFile.Secret);
+
+			auto pools = file.Load();
+			if (!pools.has_value()) return;
+
+			Size num_keys{ 0 };
+
+			m_KeyQueues.WithSharedLock([&](const KeyQueueMap& queues)
+			{
+				for (auto& pool : *pools)
+				{
+					// Algorithms that are no longer supported get dropped
+					const auto it = queues.find(pool.Algorithm);
+					if (it == queues.end()) continue;
+
+					it->second->WithUniqueLock([&](KeyQueue& key_queue)
+					{
+						// Continue with the demand from before so that
+						// the queue doesn't get trimmed right away
+						key_queue.NeededRate = pool.NeededRate;
+						key_queue.GenerationTime = pool.GenerationTime;
+
+						for (auto& keydata : pool.Keys)
+						{
+							key_queue.KeySize = keydata.LocalPrivateKey.GetSize() + keydata.LocalPublicKey.GetSize();
+							key_queue.Queue.push(std::move(keydata));
+							++num_keys;
+						}
+
+						key_queue.TargetSize = std::max(key_queue.TargetSize, key_queue.Queue.size());
+					});
+				}
+			});
+
+			LogInfo(L"Keymanager loaded %zu pregenerated keys from %s", num_keys, settings.Local.PreGeneratedKeysFile.Path.c_str());
+		}
+		catch (const std::exception& e)
+		{
+			LogErr(L"Keymanager couldn't load pregenerated keys due to exception: %s", Util::ToStringW(e.what()).c_str());
+		}
+	}
+
+	void Manager::SaveKeyPoolFile() noexcept
+	{
+		const auto& settings = GetSettings();
+		if (settings.Local.PreGeneratedKeysFile.Path.empty()) return;
+
+		try
+		{
+			Vector<KeyPoolFile::KeyPool> pools;
+			Size num_keys{ 0 };
+
+			m_KeyQueues.WithSharedLock([&](const KeyQueueMap& queues)
+			{
+				for (const auto& queue : queues)
+				{
+					queue.second->WithUniqueLock([&](KeyQueue& key_queue)
+					{
+						auto& pool = pools.emplace_back(key_queue.Algorithm);
+						pool.NeededRate = key_queue.NeededRate;
+						pool.GenerationTime = key_queue.GenerationTime;
+						pool.Keys.reserve(key_queue.Queue.size());
+
+						while (!key_queue.Queue.empty())
+						{
+							pool.Keys.emplace_back(std::move(key_queue.Queue.front()));
+							key_queue.Queue.pop();
+						}
+
+						num_keys += pool.Keys.size();
+					});
+				}
+			});
+
+			KeyPoolFile file(settings.Local.PreGeneratedKeysFile.Path, settings.Local.PreGeneratedKeysFile.Secret);
+			if (file.Save(pools))
+			{
+				LogInfo(L"Keymanager saved %zu pregenerated keys to %s", num_keys, settings.Local.PreGeneratedKeysFile.Path.c_str());
+			}
+		}
+		catch (const std::exception& e)
+		{
+			LogErr(L"Keymanager couldn't save pregenerated keys due to exception: %s", Util::ToStringW(e.what()).c_str());
+		}
 	}
 
 	bool Manager::StartupThreadPool() noexcept
@@ -183,7 +333,8 @@ namespace QuantumGate::Implementation::Core::KeyGeneration
 		m_ThreadPool.Clear();
 	}
 
-	std::optional<Crypto::AsymmetricKeyData> Manager::GetAsymmetricKeys(const Algorithm::Asymmetric alg) noexcept
+	std::optional<Crypto::AsymmetricKeyData> Manager::GetAsymmetricKeys(const Algorithm::Asymmetric alg,
+																		const bool requested) noexcept
 	{
 		if (!IsRunning()) return std::nullopt;
 
@@ -196,6 +347,8 @@ namespace QuantumGate::Implementation::Core::KeyGeneration
 			{
 				it->second->WithUniqueLock([&](KeyQueue& key_queue)
 				{
+					if (!requested) ++key_queue.NumNeeded;
+
 					if (!key_queue.Queue.empty())
 					{
 						// Get the first keypair and
@@ -203,10 +356,13 @@ namespace QuantumGate::Implementation::Core::KeyGeneration
 						keydata = std::move(key_queue.Queue.front());
 						key_queue.Queue.pop();
 
+						if (!requested) ++key_queue.NumHits;
+
 						// Set event to generate more keys and
 						// fill the queue again
 						m_ThreadPool.GetData().PrimaryThreadEvent.Set();
 					}
+					else if (!requested) ++key_queue.NumMisses;
 				});
 			}
 		});
@@ -214,9 +370,269 @@ namespace QuantumGate::Implementation::Core::KeyGeneration
 		return keydata;
 	}
 
+	std::shared_ptr<KeyRequest_ThS> Manager::RequestAsymmetricKeys(const Algorithm::Asymmetric alg,
+																   Callback<void() noexcept>&& callback) noexcept
+	{
+		if (!IsRunning()) return nullptr;
+
+		std::shared_ptr<KeyRequest_ThS> request;
+
+		try
+		{
+			request = std::make_shared<KeyRequest_ThS>(alg, std::move(callback));
+		}
+		catch (...) { return nullptr; }
+
+		auto success = false;
+
+		m_KeyQueues.WithSharedLock([&](const KeyQueueMap& key_queues)
+		{
+			// Find the keypair queue for the algorithm
+			if (const auto it = key_queues.find(alg); it != key_queues.end())
+			{
+				Size num_events{ 0 };
+
+				it->second->WithUniqueLock([&](KeyQueue& key_queue)
+				{
+					if (!key_queue.Active) return;
+
+					if (!key_queue.Queue.empty())
+					{
+						// A pre-generated keypair is available
+						// so the request completes right away
+						request->WithUniqueLock([&](KeyRequest& key_request)
+						{
+							key_request.KeyData = std::move(key_queue.Queue.front());
+							key_request.Completed = true;
+						});
+
+						key_queue.Queue.pop();
+
+						++key_queue.NumNeeded;
+						++key_queue.NumHits;
+						success = true;
+					}
+					else
+					{
+						try
+						{
+							key_queue.Requests.emplace(request);
+
+							// Only counted when the request went through; otherwise
+							// the requester falls back to GetAsymmetricKeys() later
+							++key_queue.NumNeeded;
+							++key_queue.NumMisses;
+							++m_NumPendingRequests;
+							success = true;
+
+							// Keypairs that are already being generated go to the waiting
+							// requests first; there should be at least as many pending events
+							// as requests so that every request gets a keypair
+							if (key_queue.Requests.size() > key_queue.NumPendingEvents)
+							{
+								num_events = key_queue.Requests.size() - key_queue.NumPendingEvents;
+							}
+						}
+						catch (...) {}
+					}
+				});
+
+				// Events are added outside the key queue lock because they lock the queue
+				// themselves; the key queue can't go away while we hold the shared lock
+				while (num_events > 0)
+				{
+					m_ThreadPool.GetData().KeyGenEventQueue.Push({ it->second.get() });
+					--num_events;
+				}
+			}
+		});
+
+		if (!success) return nullptr;
+
+		// Set event to generate more keys and
+		// fill the queue again
+		m_ThreadPool.GetData().PrimaryThreadEvent.Set();
+
+		return request;
+	}
+
+	bool Manager::GenerateAsymmetricKeys(Crypto::AsymmetricKeyData& keydata) noexcept
+	{
+		// Generating keys on the fly is slow especially for certain algorithms; this
+		// holds up the calling thread and everything else that's waiting for it
+		LogDbg(L"Keymanager generating a key for algorithm %s inline; no pre-generated key was available",
+			   Crypto::GetAlgorithmName(keydata.GetAlgorithm()));
+
+		++m_NumInlineKeys;
+
+		return Crypto::GenerateAsymmetricKeys(keydata);
+	}
+
+	void Manager::CompleteRequest(KeyRequest_ThS& requestths, std::optional<Crypto::AsymmetricKeyData>&& keydata) noexcept
+	{
+		Callback<void() noexcept> callback;
+
+		requestths.WithUniqueLock([&](KeyRequest& request)
+		{
+			request.KeyData = std::move(keydata);
+			request.Completed = true;
+
+			callback = std::move(request.CompletionCallback);
+		});
+
+		// Called without holding any locks since
+		// the requester may need to take its own
+		if (callback) callback();
+	}
+
+	std::optional<KeyGenerationStatistics> Manager::GetStatistics() const noexcept
+	{
+		try
+		{
+			KeyGenerationStatistics stats;
+			stats.NumRequestedKeys = m_NumRequestedKeys;
+			stats.NumInlineKeys = m_NumInlineKeys;
+			stats.NumPendingRequests = m_NumPendingRequests;
+
+			m_KeyQueues.WithSharedLock([&](const KeyQueueMap& queues)
+			{
+				for (const auto& queue : queues)
+				{
+					auto& details = stats.Algorithms.emplace_back();
+
+					queue.second->WithUniqueLock([&](const KeyQueue& key_queue)
+					{
+						details.Algorithm = key_queue.Algorithm;
+						details.NumKeys = key_queue.Queue.size();
+						details.TargetNumKeys = key_queue.TargetSize;
+						details.NumHits = key_queue.NumHits;
+						details.NumMisses = key_queue.NumMisses;
+						details.NeededRate = key_queue.NeededRate;
+						details.GenerationTime = std::chrono::duration_cast<std::chrono::microseconds>(key_queue.GenerationTime);
+						details.MemoryInUse = key_queue.Queue.size() * key_queue.KeySize;
+					});
+
+					if (details.NumHits + details.NumMisses > 0)
+					{
+						details.HitRate = static_cast<double>(details.NumHits) /
+							static_cast<double>(details.NumHits + details.NumMisses);
+					}
+
+					stats.MemoryInUse += details.MemoryInUse;
+				}
+			});
+
+			return stats;
+		}
+		catch (...) {}
+
+		return std::nullopt;
+	}
+
+	void Manager::UpdateQueueSizes(const KeyQueueMap& queues, const std::chrono::nanoseconds elapsed) noexcept
+	{
+		const auto& settings = GetSettings();
+		const auto seconds = std::max(std::chrono::duration<double>(elapsed).count(), 0.001);
+
+		Vector<KeyQueue_ThS*> key_queues;
+		Vector<QueueDemand> demands;
+
+		try
+		{
+			key_queues.reserve(queues.size());
+			demands.reserve(queues.size());
+		}
+		catch (...) { return; }
+
+		for (const auto& queue : queues)
+		{
+			key_queues.emplace_back(queue.second.get());
+			auto& demand = demands.emplace_back();
+
+			queue.second->WithUniqueLock([&](KeyQueue& key_queue)
+			{
+				// Bursts get followed quickly, but after a burst
+				// the demand goes down slowly
+				const auto rate = static_cast<double>(key_queue.NumNeeded) / seconds;
+				const auto factor = (rate > key_queue.NeededRate) ? NeededRateIncreaseFactor : NeededRateDecreaseFactor;
+				key_queue.NeededRate += factor * (rate - key_queue.NeededRate);
+				key_queue.NumNeeded = 0;
+
+				demand.NeededRate = key_queue.NeededRate;
+				demand.GenerationTime = key_queue.GenerationTime;
+				demand.KeySize = key_queue.KeySize;
+			});
+		}
+
+		CalcTargetSizes(demands, settings.Local.NumPreGeneratedKeysPerAlgorithm,
+						settings.Local.PreGeneratedKeysBurstWindow, settings.Local.PreGeneratedKeysMemoryBudget);
+
+		for (Size x = 0; x < key_queues.size(); ++x)
+		{
+			const auto target_size = demands[x].TargetSize;
+
+			key_queues[x]->WithUniqueLock([&](KeyQueue& key_queue)
+			{
+				if (key_queue.TargetSize != target_size)
+				{
+					LogDbg(L"Keymanager changing number of pregenerated keys for algorithm %s from %zu to %zu",
+						   Crypto::GetAlgorithmName(key_queue.Algorithm), key_queue.TargetSize, target_size);
+
+					key_queue.TargetSize = target_size;
+				}
+
+				// Release keys we don't need anymore
+				while (key_queue.Queue.size() > key_queue.TargetSize)
+				{
+					key_queue.Queue.pop();
+				}
+			});
+		}
+	}
+
+	void Manager::CalcTargetSizes(Vector<QueueDemand>& demands, const Size min_size,
+								  const std::chrono::seconds window, const Size memory_budget) noexcept
+	{
+		const auto window_secs = std::chrono::duration<double>(window).count();
+
+		Size min_memory{ 0 };
+		Size extra_memory{ 0 };
+
+		for (auto& demand : demands)
+		{
+			// The keys needed during a burst that lasts for the window period, minus the
+			// keys that one key generation thread can make in that time; for algorithms
+			// that are fast to generate this leaves nothing and only slow ones get deep queues
+			auto needed = demand.NeededRate * window_secs;
+			if (demand.GenerationTime.count() > 0)
+			{
+				needed -= window_secs / std::chrono::duration<double>(demand.GenerationTime).count();
+			}
+
+			demand.TargetSize = std::max(min_size, static_cast<Size>(std::ceil(std::max(needed, 0.0))));
+
+			min_memory += min_size * demand.KeySize;
+			extra_memory += (demand.TargetSize - min_size) * demand.KeySize;
+		}
+
+		// Keys beyond the minimum number get scaled down
+		// for all algorithms to stay within the memory budget
+		if (extra_memory > 0 && min_memory + extra_memory > memory_budget)
+		{
+			const auto available = (memory_budget > min_memory) ? memory_budget - min_memory : 0;
+			const auto scale = static_cast<double>(available) / static_cast<double>(extra_memory);
+
+			for (auto& demand : demands)
+			{
+				demand.TargetSize = min_size + static_cast<Size>(static_cast<double>(demand.TargetSize - min_size) * scale);
+			}
+		}
+	}
+
 	void Manager::PrimaryThreadWait(ThreadPoolData& thpdata, const Concurrency::Event& shutdown_event)
 	{
-		thpdata.PrimaryThreadEvent.Wait(shutdown_event);
+		// Wakes up periodically to measure the demand for keys
+		thpdata.PrimaryThreadEvent.Wait(QueueSizeUpdateInterval, shutdown_event);
 	}
 
 	void Manager::PrimaryThreadWaitInterrupt(ThreadPoolData& thpdata)
@@ -235,24 +651,32 @@ namespace QuantumGate::Implementation::Core::KeyGeneration
 			// and we need to fill the queue again
 			thpdata.PrimaryThreadEvent.Reset();
 
+			const auto now = Util::GetCurrentSteadyTime();
+			if (now - thpdata.LastQueueSizeUpdateSteadyTime >= QueueSizeUpdateInterval)
+			{
+				UpdateQueueSizes(queues, now - thpdata.LastQueueSizeUpdateSteadyTime);
+				thpdata.LastQueueSizeUpdateSteadyTime = now;
+			}
+
 			for (auto it = queues.begin(); it != queues.end() && !shutdown_event.IsSet(); ++it)
 			{
 				auto active = false;
 				Size queue_size{ 0 };
 				Size num_pending_events{ 0 };
+				Size numpregen{ 0 };
 
 				it->second->WithUniqueLock([&](KeyQueue& key_queue)
 				{
 					active = key_queue.Active;
 					queue_size = key_queue.Queue.size();
 					num_pending_events = key_queue.NumPendingEvents;
+					numpregen = key_queue.TargetSize;
 				});
 
 				if (active)
 				{
 					Size numkeys{ 0 };
 					const Size pending{ queue_size + num_pending_events };
-					const Size numpregen{ GetSettings().Local.NumPreGeneratedKeysPerAlgorithm };
 
 					if (pending < numpregen)
 					{
@@ -318,10 +742,9 @@ namespace QuantumGate::Implementation::Core::KeyGeneration
 	void Manager::WorkerThreadProcessor(ThreadPoolData& thpdata, const Concurrency::Event& shutdown_event)
 	{
 		Event event;
-		thpdata.KeyGenEventQueue.PopFrontIf([&](auto& fevent) noexcept -> bool
+		thpdata.KeyGenEventQueue.PopFront([&](auto& fevent) noexcept
 		{
 			event = std::move(fevent);
-			return true;
 		});
 
 		if (event)
@@ -341,16 +764,84 @@ namespace QuantumGate::Implementation::Core::KeyGeneration
 
 				Crypto::AsymmetricKeyData keydata(alg);
 
+				const auto start_steadytime = Util::GetCurrentSteadyTime();
+
 				if (Crypto::GenerateAsymmetricKeys(keydata))
 				{
-					event.GetQueue()->WithUniqueLock()->Queue.emplace(std::move(keydata));
+					const auto generation_time = Util::GetCurrentSteadyTime() - start_steadytime;
+
+					std::shared_ptr<KeyRequest_ThS> request;
+
+					event.GetQueue()->WithUniqueLock([&](KeyQueue& key_queue)
+					{
+						if (key_queue.GenerationTime.count() == 0)
+						{
+							key_queue.GenerationTime = generation_time;
+						}
+						else
+						{
+							key_queue.GenerationTime += std::chrono::duration_cast<std::chrono::nanoseconds>(
+								(generation_time - key_queue.GenerationTime) * GenerationTimeFactor);
+						}
+
+						key_queue.KeySize = keydata.LocalPrivateKey.GetSize() + keydata.LocalPublicKey.GetSize();
+
+						// Requests that are waiting get served first; the
+						// ones that were dropped by the requester get skipped
+						while (request == nullptr && !key_queue.Requests.empty())
+						{
+							request = key_queue.Requests.front().lock();
+							key_queue.Requests.pop();
+
+							--m_NumPendingRequests;
+						}
+
+						if (request == nullptr)
+						{
+							key_queue.Queue.emplace(std::move(keydata));
+						}
+					});
+
+					if (request != nullptr)
+					{
+						++m_NumRequestedKeys;
+
+						CompleteRequest(*request, std::move(keydata));
+					}
 				}
 				else
 				{
 					LogErr(L"Keymanager failed to generate a key for algorithm %s; will stop trying for this algorithm",
 						   Crypto::GetAlgorithmName(alg));
 
-					event.GetQueue()->WithUniqueLock()->Active = false;
+					Vector<std::shared_ptr<KeyRequest_ThS>> requests;
+
+					event.GetQueue()->WithUniqueLock([&](KeyQueue& key_queue)
+					{
+						key_queue.Active = false;
+
+						// Requests that are waiting won't get a keypair anymore
+						while (!key_queue.Requests.empty())
+						{
+							if (auto request = key_queue.Requests.front().lock(); request != nullptr)
+							{
+								try
+								{
+									requests.emplace_back(std::move(request));
+								}
+								catch (...) {}
+							}
+
+							key_queue.Requests.pop();
+
+							--m_NumPendingRequests;
+						}
+					});
+
+					for (auto& request : requests)
+					{
+						CompleteRequest(*request, std::nullopt);
+					}
 				}
 			}
 		}
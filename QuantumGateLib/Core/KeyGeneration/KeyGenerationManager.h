@@ -5,7 +5,7 @@
 
 #include "KeyGenerationEvent.h"
 #include "..\..\Concurrency\ThreadPool.h"
-#include "..\..\Concurrency\Queue.h"
+#include "..\..\Concurrency\MPMCQueue.h"
 #include "..\..\Concurrency\ConditionEvent.h"
 
 namespace QuantumGate::Implementation::Core::KeyGeneration
@@ -15,17 +15,40 @@ namespace QuantumGate::Implementation::Core::KeyGeneration
 		using KeyQueueMap = Containers::UnorderedMap<Algorithm::Asymmetric, std::unique_ptr<KeyQueue_ThS>>;
 		using KeyQueueMap_ThS = Concurrency::ThreadSafe<KeyQueueMap, Concurrency::SharedSpinMutex>;
 
-		using EventQueue_ThS = Concurrency::Queue<Event>;
+		using EventQueue_ThS = Concurrency::MPMCQueue<Event>;
 
 		struct ThreadPoolData final
 		{
 			EventQueue_ThS KeyGenEventQueue;
 			Concurrency::ConditionEvent PrimaryThreadEvent;
+			SteadyTime LastQueueSizeUpdateSteadyTime;
 		};
 
 		using ThreadPool = Concurrency::ThreadPool<ThreadPoolData>;
 
+		// How often the demand for keys gets measured and the
+		// target sizes of the key queues get updated
+		static constexpr std::chrono::seconds QueueSizeUpdateInterval{ 1 };
+
+		// Smoothing factors for the demand when it goes up (quickly
+		// follow bursts) or down (keep keys around for a while after a burst)
+		static constexpr double NeededRateIncreaseFactor{ 0.5 };
+		static constexpr double NeededRateDecreaseFactor{ 0.05 };
+
+		// Smoothing factor for the key generation time
+		static constexpr double GenerationTimeFactor{ 0.2 };
+
 	public:
+		// The demand for keys of one algorithm and the
+		// number of keys to keep available because of it
+		struct QueueDemand final
+		{
+			double NeededRate{ 0.0 };
+			std::chrono::nanoseconds GenerationTime{ 0 };
+			Size KeySize{ 0 };
+			Size TargetSize{ 0 };
+		};
+
 		Manager(const Settings_CThS& settings) noexcept;
 		Manager(const Manager&) = delete;
 		Manager(Manager&&) noexcept = default;
@@ -40,7 +63,18 @@ namespace QuantumGate::Implementation::Core::KeyGeneration
 
 		inline bool IsRunning() const noexcept { return m_Running; }
 
-		std::optional<Crypto::AsymmetricKeyData> GetAsymmetricKeys(const Algorithm::Asymmetric alg) noexcept;
+		// When the keys were requested with RequestAsymmetricKeys() before, the need for
+		// them was already counted towards the demand and shouldn't be counted again
+		std::optional<Crypto::AsymmetricKeyData> GetAsymmetricKeys(const Algorithm::Asymmetric alg,
+																   const bool requested = false) noexcept;
+		std::shared_ptr<KeyRequest_ThS> RequestAsymmetricKeys(const Algorithm::Asymmetric alg,
+															  Callback<void() noexcept>&& callback) noexcept;
+		[[nodiscard]] bool GenerateAsymmetricKeys(Crypto::AsymmetricKeyData& keydata) noexcept;
+
+		std::optional<KeyGenerationStatistics> GetStatistics() const noexcept;
+
+		static void CalcTargetSizes(Vector<QueueDemand>& demands, const Size min_size,
+									const std::chrono::seconds window, const Size memory_budget) noexcept;
 
 	private:
 		void PreStartup() noexcept;
@@ -49,6 +83,13 @@ namespace QuantumGate::Implementation::Core::KeyGeneration
 		bool AddKeyQueues() noexcept;
 		void ClearKeyQueues() noexcept;
 
+		void LoadKeyPoolFile() noexcept;
+		void SaveKeyPoolFile() noexcept;
+
+		void CompleteRequest(KeyRequest_ThS& requestths, std::optional<Crypto::AsymmetricKeyData>&& keydata) noexcept;
+
+		void UpdateQueueSizes(const KeyQueueMap& queues, const std::chrono::nanoseconds elapsed) noexcept;
+
 		bool StartupThreadPool() noexcept;
 		void ShutdownThreadPool() noexcept;
 
@@ -66,5 +107,9 @@ namespace QuantumGate::Implementation::Core::KeyGeneration
 
 		KeyQueueMap_ThS m_KeyQueues;
 		ThreadPool m_ThreadPool;
+
+		std::atomic<UInt64> m_NumRequestedKeys{ 0 };
+		std::atomic<UInt64> m_NumInlineKeys{ 0 };
+		std::atomic<UInt64> m_NumPendingRequests{ 0 };
 	};
 }
\ No newline at end of file
@@ -0,0 +1,399 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#include "pch.h"
+#include "KeyPoolFile.h"
+#include "..\..\Crypto\Crypto.h"
+#include "..\..\Common\ScopeGuard.h"
+
+namespace QuantumGate::Implementation::Core::KeyGeneration
+{
+	std::optional<Vector<KeyPoolFile::KeyPool>> KeyPoolFile::Load() noexcept
+	{
+		auto file = ::CreateFileW(m_Path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr,
+								  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			const auto error = ::GetLastError();
+			if (error == ERROR_FILE_NOT_FOUND) return Vector<KeyPool>{};
+
+			LogErr(L"Couldn't open key pool file %s (%s)", m_Path.c_str(), GetSysErrorString(error).c_str());
+			return std::nullopt;
+		}
+
+		// Close file when we exit
+		const auto sg = MakeScopeGuard([&]() noexcept { ::CloseHandle(file); });
+
+		LARGE_INTEGER file_size{ 0 };
+		if (!::GetFileSizeEx(file, &file_size))
+		{
+			LogErr(L"Couldn't get the size of key pool file %s (%s)", m_Path.c_str(), GetLastSysErrorString().c_str());
+			return std::nullopt;
+		}
+
+		// Empty after a previous load
+		if (file_size.QuadPart == 0) return Vector<KeyPool>{};
+
+		auto mapping = ::CreateFileMappingW(file, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+		if (mapping == nullptr)
+		{
+			LogErr(L"Couldn't map key pool file %s (%s)", m_Path.c_str(), GetLastSysErrorString().c_str());
+			return std::nullopt;
+		}
+
+		auto view = static_cast<Byte*>(::MapViewOfFile(mapping, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, 0));
+		if (view == nullptr)
+		{
+			LogErr(L"Couldn't map key pool file %s (%s)", m_Path.c_str(), GetLastSysErrorString().c_str());
+			::CloseHandle(mapping);
+			return std::nullopt;
+		}
+
+		const auto size = static_cast<Size>(file_size.QuadPart);
+
+		auto pools = Read(BufferView(view, size));
+
+		// The keys get erased from the file whether they could be read or not; they're
+		// only useful if they were read (and if they weren't they're not readable anyway).
+		// Since the keys are encrypted, any copies the storage device may keep behind
+		// (such as on flash memory) are of no use without the secret.
+		::SecureZeroMemory(view, size);
+		::FlushViewOfFile(view, 0);
+		::UnmapViewOfFile(view);
+		::CloseHandle(mapping);
+
+		LARGE_INTEGER zero{ 0 };
+		if (!::SetFilePointerEx(file, zero, nullptr, FILE_BEGIN) ||
+			!::SetEndOfFile(file) || !::FlushFileBuffers(file))
+		{
+			LogErr(L"Couldn't truncate key pool file %s (%s)", m_Path.c_str(), GetLastSysErrorString().c_str());
+		}
+
+		return pools;
+	}
+
+	bool KeyPoolFile::Save(const Vector<KeyPool>& pools) noexcept
+	{
+		auto salt = Crypto::GetCryptoRandomBytes(SaltSize);
+		if (!salt.has_value())
+		{
+			LogErr(L"Couldn't get random bytes for key pool file %s", m_Path.c_str());
+			return false;
+		}
+
+		UInt64 size{ sizeof(FileHeader) };
+		for (const auto& pool : pools)
+		{
+			size += sizeof(RecordHeader) + Crypto::SymmetricTagSize + sizeof(DetailsRecord);
+
+			for (const auto& keydata : pool.Keys)
+			{
+				size += GetRecordSize(keydata);
+			}
+		}
+
+		auto file = ::CreateFileW(m_Path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr,
+								  CREATE_ALWAYS, FILE_ATTRIBUTE_NOT_CONTENT_INDEXED, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			LogErr(L"Couldn't create key pool file %s (%s)", m_Path.c_str(), GetLastSysErrorString().c_str());
+			return false;
+		}
+
+		// Close file when we exit
+		const auto sg = MakeScopeGuard([&]() noexcept { ::CloseHandle(file); });
+
+		auto mapping = ::CreateFileMappingW(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32),
+											static_cast<DWORD>(size & 0xffffffff), nullptr);
+		if (mapping == nullptr)
+		{
+			LogErr(L"Couldn't map key pool file %s (%s)", m_Path.c_str(), GetLastSysErrorString().c_str());
+			return false;
+		}
+
+		auto view = static_cast<Byte*>(::MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, 0));
+		if (view == nullptr)
+		{
+			LogErr(L"Couldn't map key pool file %s (%s)", m_Path.c_str(), GetLastSysErrorString().c_str());
+			::CloseHandle(mapping);
+			return false;
+		}
+
+		const auto success = Write(BufferSpan(view, static_cast<Size>(size)), pools, *salt);
+
+		// Don't leave a partially written file behind
+		if (!success) ::SecureZeroMemory(view, static_cast<Size>(size));
+
+		::FlushViewOfFile(view, 0);
+		::UnmapViewOfFile(view);
+		::CloseHandle(mapping);
+
+		if (!success)
+		{
+			LARGE_INTEGER zero{ 0 };
+			::SetFilePointerEx(file, zero, nullptr, FILE_BEGIN);
+			::SetEndOfFile(file);
+		}
+
+		::FlushFileBuffers(file);
+
+		return success;
+	}
+
+	std::optional<Vector<KeyPoolFile::KeyPool>> KeyPoolFile::Read(const BufferView& data) noexcept
+	{
+		try
+		{
+			FileHeader header;
+
+			if (data.GetSize() < sizeof(header))
+			{
+				LogErr(L"Key pool file %s is invalid", m_Path.c_str());
+				return std::nullopt;
+			}
+
+			std::memcpy(&header, data.GetBytes(), sizeof(header));
+
+			if (header.Magic != Magic || header.Version != Version)
+			{
+				LogErr(L"Key pool file %s is invalid or has an unsupported version", m_Path.c_str());
+				return std::nullopt;
+			}
+
+			Crypto::SymmetricKeyData symkeydata(Crypto::SymmetricKeyType::Derived, Algorithm::Hash::BLAKE2B512,
+												Algorithm::Symmetric::CHACHA20_POLY1305, Algorithm::Compression::Unknown);
+			if (!DeriveKey(symkeydata, BufferView(header.Salt, SaltSize))) return std::nullopt;
+
+			Vector<KeyPool> pools;
+
+			const auto get_pool = [&](const Algorithm::Asymmetric alg) -> KeyPool&
+			{
+				const auto it = std::find_if(pools.begin(), pools.end(),
+											 [&](const auto& pool) noexcept { return (pool.Algorithm == alg); });
+				if (it != pools.end()) return *it;
+
+				return pools.emplace_back(alg);
+			};
+
+			auto records = data;
+			records.RemoveFirst(sizeof(header));
+
+			ProtectedBuffer record;
+			Size num_valid{ 0 };
+			Size num_invalid{ 0 };
+
+			for (UInt64 num = 0; num < header.NumRecords; ++num)
+			{
+				RecordHeader rheader;
+
+				if (records.GetSize() < sizeof(rheader)) break;
+
+				std::memcpy(&rheader, records.GetBytes(), sizeof(rheader));
+				records.RemoveFirst(sizeof(rheader));
+
+				if (records.GetSize() < rheader.Size) break;
+
+				// Decrypt a copy so that the plaintext doesn't end up in the file
+				record = records.GetFirst(rheader.Size);
+				records.RemoveFirst(rheader.Size);
+
+				const auto iv = GetIV(num);
+				BufferSpan plaintext(record);
+
+				if (!Crypto::DecryptInPlace(plaintext, symkeydata, BufferView(iv.data(), iv.size())))
+				{
+					// When not even the first record decrypts the secret is most likely
+					// different; otherwise only this record was damaged and gets skipped
+					if (num_valid == 0 && num_invalid == 0)
+					{
+						LogErr(L"Couldn't decrypt key pool file %s; the secret may have changed", m_Path.c_str());
+						break;
+					}
+
+					++num_invalid;
+					continue;
+				}
+
+				if (rheader.Type == RecordType::Details && plaintext.GetSize() == sizeof(DetailsRecord))
+				{
+					DetailsRecord details;
+					std::memcpy(&details, plaintext.GetBytes(), sizeof(details));
+
+					if (details.Type == rheader.Type && details.Algorithm == rheader.Algorithm)
+					{
+						auto& pool = get_pool(details.Algorithm);
+						pool.NeededRate = details.NeededRate;
+						pool.GenerationTime = std::chrono::nanoseconds(details.GenerationTime);
+						++num_valid;
+						continue;
+					}
+				}
+				else if (rheader.Type == RecordType::Key && plaintext.GetSize() >= sizeof(KeyRecord))
+				{
+					KeyRecord key;
+					std::memcpy(&key, plaintext.GetBytes(), sizeof(key));
+					plaintext.RemoveFirst(sizeof(key));
+
+					if (key.Type == rheader.Type && key.Algorithm == rheader.Algorithm &&
+						plaintext.GetSize() == static_cast<Size>(key.PrivateKeySize) + key.PublicKeySize)
+					{
+						Crypto::AsymmetricKeyData keydata(key.Algorithm);
+						keydata.LocalPrivateKey = BufferView(plaintext).GetFirst(key.PrivateKeySize);
+						keydata.LocalPublicKey = BufferView(plaintext).GetLast(key.PublicKeySize);
+
+						if (Crypto::RestoreAsymmetricKeys(keydata))
+						{
+							get_pool(key.Algorithm).Keys.emplace_back(std::move(keydata));
+							++num_valid;
+							continue;
+						}
+					}
+				}
+
+				++num_invalid;
+			}
+
+			if (num_invalid > 0)
+			{
+				LogWarn(L"Skipped %zu invalid records in key pool file %s", num_invalid, m_Path.c_str());
+			}
+
+			return pools;
+		}
+		catch (const std::exception& e)
+		{
+			LogErr(L"Couldn't read key pool file %s due to exception: %s",
+				   m_Path.c_str(), Util::ToStringW(e.what()).c_str());
+		}
+
+		return std::nullopt;
+	}
+
+	bool KeyPoolFile::Write(BufferSpan data, const Vector<KeyPool>& pools, const BufferView& salt) noexcept
+	{
+		try
+		{
+			Crypto::SymmetricKeyData symkeydata(Crypto::SymmetricKeyType::Derived, Algorithm::Hash::BLAKE2B512,
+												Algorithm::Symmetric::CHACHA20_POLY1305, Algorithm::Compression::Unknown);
+			if (!DeriveKey(symkeydata, salt)) return false;
+
+			FileHeader header;
+			header.Magic = Magic;
+			header.Version = Version;
+			std::memcpy(header.Salt, salt.GetBytes(), SaltSize);
+
+			const auto header_bytes = data.GetBytes();
+			data.RemoveFirst(sizeof(header));
+
+			// The plaintext gets put together and encrypted in protected
+			// memory and only the encrypted data gets copied to the file
+			ProtectedBuffer record;
+			UInt64 num{ 0 };
+
+			const auto write_record = [&](const RecordType type, const Algorithm::Asymmetric alg) -> bool
+			{
+				const auto iv = GetIV(num);
+				BufferSpan encrypted(record);
+
+				if (!Crypto::EncryptInPlace(encrypted, symkeydata, BufferView(iv.data(), iv.size()))) return false;
+
+				RecordHeader rheader;
+				rheader.Type = type;
+				rheader.Algorithm = alg;
+				rheader.Size = static_cast<UInt32>(encrypted.GetSize());
+
+				if (data.GetSize() < sizeof(rheader) + encrypted.GetSize()) return false;
+
+				std::memcpy(data.GetBytes(), &rheader, sizeof(rheader));
+				data.RemoveFirst(sizeof(rheader));
+
+				std::memcpy(data.GetBytes(), encrypted.GetBytes(), encrypted.GetSize());
+				data.RemoveFirst(encrypted.GetSize());
+
+				++num;
+				return true;
+			};
+
+			for (const auto& pool : pools)
+			{
+				DetailsRecord details;
+				details.Type = RecordType::Details;
+				details.Algorithm = pool.Algorithm;
+				details.NeededRate = pool.NeededRate;
+				details.GenerationTime = pool.GenerationTime.count();
+
+				record.Allocate(Crypto::SymmetricTagSize + sizeof(details));
+				std::memcpy(record.GetBytes() + Crypto::SymmetricTagSize, &details, sizeof(details));
+
+				if (!write_record(RecordType::Details, pool.Algorithm)) return false;
+
+				for (const auto& keydata : pool.Keys)
+				{
+					KeyRecord key;
+					key.Type = RecordType::Key;
+					key.Algorithm = pool.Algorithm;
+					key.PrivateKeySize = static_cast<UInt32>(keydata.LocalPrivateKey.GetSize());
+					key.PublicKeySize = static_cast<UInt32>(keydata.LocalPublicKey.GetSize());
+
+					record.Allocate(GetRecordSize(keydata) - sizeof(RecordHeader));
+
+					auto bytes = record.GetBytes() + Crypto::SymmetricTagSize;
+					std::memcpy(bytes, &key, sizeof(key));
+					bytes += sizeof(key);
+					std::memcpy(bytes, keydata.LocalPrivateKey.GetBytes(), keydata.LocalPrivateKey.GetSize());
+					bytes += keydata.LocalPrivateKey.GetSize();
+					std::memcpy(bytes, keydata.LocalPublicKey.GetBytes(), keydata.LocalPublicKey.GetSize());
+
+					if (!write_record(RecordType::Key, pool.Algorithm)) return false;
+				}
+			}
+
+			// The header goes in last so that the file is only
+			// valid once all records have been written
+			header.NumRecords = num;
+			std::memcpy(header_bytes, &header, sizeof(header));
+
+			return true;
+		}
+		catch (const std::exception& e)
+		{
+			LogErr(L"Couldn't write key pool file %s due to exception: %s",
+				   m_Path.c_str(), Util::ToStringW(e.what()).c_str());
+		}
+
+		return false;
+	}
+
+	bool KeyPoolFile::DeriveKey(Crypto::SymmetricKeyData& symkeydata, const BufferView& salt) const noexcept
+	{
+		try
+		{
+			// A new salt for every file gives every file its own key
+			ProtectedBuffer secret(m_Secret);
+			secret += salt;
+
+			if (Crypto::HKDF(secret, symkeydata.Key, 32, symkeydata.HashAlgorithm)) return true;
+		}
+		catch (...) {}
+
+		LogErr(L"Couldn't derive the encryption key for key pool file %s", m_Path.c_str());
+
+		return false;
+	}
+
+	std::array<Byte, 12> KeyPoolFile::GetIV(const UInt64 num) noexcept
+	{
+		// Every file has its own key so the record
+		// number is enough to never reuse an IV
+		std::array<Byte, 12> iv{};
+		std::memcpy(iv.data(), &num, sizeof(num));
+
+		return iv;
+	}
+
+	Size KeyPoolFile::GetRecordSize(const Crypto::AsymmetricKeyData& keydata) noexcept
+	{
+		return sizeof(RecordHeader) + Crypto::SymmetricTagSize + sizeof(KeyRecord) +
+			keydata.LocalPrivateKey.GetSize() + keydata.LocalPublicKey.GetSize();
+	}
+}
@@ -0,0 +1,106 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#pragma once
+
+#include "..\..\Crypto\KeyData.h"
+
+namespace QuantumGate::Implementation::Core::KeyGeneration
+{
+	// Encrypted file that keeps pregenerated keys across restarts so that the key queues
+	// don't start out empty. The keys get written when the key manager shuts down and are
+	// read back (through a memory mapping) on startup. As soon as the keys are read they get
+	// erased from the file, so that each key gets used at most once even if the process
+	// doesn't shut down cleanly afterwards.
+	class KeyPoolFile final
+	{
+		static constexpr UInt32 Magic{ 0x504b4751 }; // QGKP
+		static constexpr UInt16 Version{ 1 };
+		static constexpr Size SaltSize{ 32 };
+
+		enum class RecordType : UInt16
+		{
+			Unknown = 0, Details = 1, Key = 2
+		};
+
+#pragma pack(push, 1) // Disable padding bytes
+		struct FileHeader final
+		{
+			UInt32 Magic{ 0 };
+			UInt16 Version{ 0 };
+			UInt16 Reserved{ 0 };
+			UInt64 NumRecords{ 0 };
+			Byte Salt[SaltSize]{};
+		};
+
+		// Followed by the encrypted record data
+		// of Size bytes (including the tag)
+		struct RecordHeader final
+		{
+			RecordType Type{ RecordType::Unknown };
+			Algorithm::Asymmetric Algorithm{ Algorithm::Asymmetric::Unknown };
+			UInt32 Size{ 0 };
+		};
+
+		// Encrypted data of a Details record
+		struct DetailsRecord final
+		{
+			RecordType Type{ RecordType::Unknown };
+			Algorithm::Asymmetric Algorithm{ Algorithm::Asymmetric::Unknown };
+			double NeededRate{ 0.0 };
+			Int64 GenerationTime{ 0 };
+		};
+
+		// Encrypted data of a Key record; followed
+		// by the private key and public key bytes
+		struct KeyRecord final
+		{
+			RecordType Type{ RecordType::Unknown };
+			Algorithm::Asymmetric Algorithm{ Algorithm::Asymmetric::Unknown };
+			UInt32 PrivateKeySize{ 0 };
+			UInt32 PublicKeySize{ 0 };
+		};
+#pragma pack(pop)
+
+	public:
+		struct KeyPool final
+		{
+			KeyPool(const Algorithm::Asymmetric alg) noexcept : Algorithm(alg) {}
+
+			Algorithm::Asymmetric Algorithm{ Algorithm::Asymmetric::Unknown };
+			double NeededRate{ 0.0 };
+			std::chrono::nanoseconds GenerationTime{ 0 };
+			Vector<Crypto::AsymmetricKeyData> Keys;
+		};
+
+		KeyPoolFile(const String& path, const ProtectedBuffer& secret) :
+			m_Path(path), m_Secret(secret)
+		{}
+
+		KeyPoolFile(const KeyPoolFile&) = delete;
+		KeyPoolFile(KeyPoolFile&&) = delete;
+		~KeyPoolFile() = default;
+		KeyPoolFile& operator=(const KeyPoolFile&) = delete;
+		KeyPoolFile& operator=(KeyPoolFile&&) = delete;
+
+		// Returns the keys in the file (nothing if there's no file) and erases
+		// them from the file; returns nothing if the file couldn't be read
+		[[nodiscard]] std::optional<Vector<KeyPool>> Load() noexcept;
+
+		// Replaces the contents of the file with the keys
+		[[nodiscard]] bool Save(const Vector<KeyPool>& pools) noexcept;
+
+	private:
+		[[nodiscard]] std::optional<Vector<KeyPool>> Read(const BufferView& data) noexcept;
+		[[nodiscard]] bool Write(BufferSpan data, const Vector<KeyPool>& pools, const BufferView& salt) noexcept;
+
+		[[nodiscard]] bool DeriveKey(Crypto::SymmetricKeyData& symkeydata, const BufferView& salt) const noexcept;
+		[[nodiscard]] static std::array<Byte, 12> GetIV(const UInt64 num) noexcept;
+
+		[[nodiscard]] static Size GetRecordSize(const Crypto::AsymmetricKeyData& keydata) noexcept;
+
+	private:
+		const String m_Path;
+		const ProtectedBuffer m_Secret;
+	};
+}
@@ -87,6 +87,15 @@ namespace QuantumGate::Implementation::Core
 			return false;
 		}
 
+		if (!params.PreGeneratedKeysFile.Path.empty())
+		{
+			if (params.PreGeneratedKeysFile.Secret.GetSize() < 32 || !Crypto::ValidateBuffer(params.PreGeneratedKeysFile.Secret))
+			{
+				LogErr(L"The secret for the pregenerated keys file specified in the initialization parameters isn't valid");
+				return false;
+			}
+		}
+
 		if (params.RequireAuthentication && !(params.Keys.has_value() && !params.Keys->PrivateKey.IsEmpty()))
 		{
 			LogErr(L"No private key is specified in the initialization parameters while authentication is required");
@@ -100,6 +109,17 @@ namespace QuantumGate::Implementation::Core
 			return false;
 		}
 
+		switch (params.UDP.CongestionControl)
+		{
+			case UDPCongestionControl::AIMD:
+			case UDPCongestionControl::CUBIC:
+			case UDPCongestionControl::BBR:
+				break;
+			default:
+				LogErr(L"Invalid congestion control algorithm specified in UDP parameters");
+				return false;
+		}
+
 		return true;
 	}
 
@@ -239,7 +259,7 @@ namespace QuantumGate::Implementation::Core
 
 		try
 		{
-			m_Settings.UpdateValue([&](Settings& settings)
+			const auto updated = m_Settings.UpdateValue([&](Settings& settings)
 			{
 				settings.Local.UUID = params.UUID;
 
@@ -272,6 +292,9 @@ namespace QuantumGate::Implementation::Core
 				
 				settings.Local.Listeners.UDP.Ports = Util::SetToVector(params.Listeners.UDP.Ports);
 				settings.Local.Listeners.UDP.NATTraversal = params.Listeners.UDP.NATTraversal;
+
+				settings.Local.UDP.CongestionControl = params.UDP.CongestionControl;
+				settings.Local.UDP.Pacing = params.UDP.Pacing;
 				
 				settings.Local.Listeners.BTH.Ports = Util::SetToVector(params.Listeners.BTH.Ports);
 				settings.Local.Listeners.BTH.RequireAuthentication = params.Listeners.BTH.RequireAuthentication;
@@ -290,10 +313,20 @@ namespace QuantumGate::Implementation::Core
 				}
 				
 				settings.Local.NumPreGeneratedKeysPerAlgorithm = params.NumPreGeneratedKeysPerAlgorithm;
+				settings.Local.PreGeneratedKeysBurstWindow = params.PreGeneratedKeysBurstWindow;
+				settings.Local.PreGeneratedKeysMemoryBudget = params.PreGeneratedKeysMemoryBudget;
+				settings.Local.PreGeneratedKeysFile.Path = params.PreGeneratedKeysFile.Path;
+				settings.Local.PreGeneratedKeysFile.Secret = params.PreGeneratedKeysFile.Secret;
 				
 				settings.Relay.IPv4ExcludedNetworksCIDRLeadingBits = params.Relays.IPv4ExcludedNetworksCIDRLeadingBits;
 				settings.Relay.IPv6ExcludedNetworksCIDRLeadingBits = params.Relays.IPv6ExcludedNetworksCIDRLeadingBits;
 			});
+
+			if (!updated)
+			{
+				LogErr(L"Failed to update settings with initialization parameters");
+				return ResultCode::Failed;
+			}
 		}
 		catch (const std::exception& e)
 		{
@@ -1191,6 +1224,18 @@ namespace QuantumGate::Implementation::Core
 		return ResultCode::NotRunning;
 	}
 
+	Result<KeyGenerationStatistics> Local::GetKeyGenerationStatistics() const noexcept
+	{
+		if (!IsRunning()) return ResultCode::NotRunning;
+
+		if (auto stats = m_KeyGenerationManager.GetStatistics(); stats.has_value())
+		{
+			return std::move(*stats);
+		}
+
+		return ResultCode::Failed;
+	}
+
 	Result<API::Peer> Local::GetPeer(const PeerLUID pluid) const noexcept
 	{
 		if (IsRunning()) return m_PeerManager.GetPeer(pluid);
@@ -1337,7 +1382,7 @@ namespace QuantumGate::Implementation::Core
 	{
 		auto result_code = ResultCode::Succeeded;
 
-		m_Settings.UpdateValue([&](Settings& settings) noexcept
+		const auto updated = m_Settings.UpdateValue([&](Settings& settings) noexcept
 		{
 			switch (level)
 			{
@@ -1605,6 +1650,12 @@ namespace QuantumGate::Implementation::Core
 			if (result_code == ResultCode::Succeeded) m_SecurityLevel = level;
 		});
 
+		if (!updated)
+		{
+			LogErr(L"Could not set security level; failed to update settings");
+			result_code = ResultCode::Failed;
+		}
+
 		return result_code;
 	}
 
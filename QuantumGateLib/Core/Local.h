@@ -7,6 +7,7 @@
 #include "UDP\UDPListenerManager.h"
 #include "BTH\BTHListenerManager.h"
 #include "KeyGeneration\KeyGenerationManager.h"
+#include "..\Concurrency\MPSCQueue.h"
 
 namespace QuantumGate::Implementation::Core
 {
@@ -28,7 +29,7 @@ namespace QuantumGate::Implementation::Core
 		};
 
 		using Event = std::variant<Events::LocalEnvironmentChange, Events::UnhandledExtenderException>;
-		using EventQueue_ThS = Concurrency::Queue<Event>;
+		using EventQueue_ThS = Concurrency::MPSCQueue<Event>;
 
 		struct ThreadPoolData final
 		{
@@ -94,6 +95,8 @@ namespace QuantumGate::Implementation::Core
 
 		Result<PeerUUID> GetUUID() const noexcept;
 
+		Result<KeyGenerationStatistics> GetKeyGenerationStatistics() const noexcept;
+
 		Result<API::Peer> GetPeer(const PeerLUID pluid) const noexcept;
 
 		Result<Vector<PeerLUID>> QueryPeers(const PeerQueryParameters& params) const noexcept;
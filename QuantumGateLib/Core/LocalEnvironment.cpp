@@ -682,10 +682,10 @@ namespace QuantumGate::Implementation::Core
 		m_BluetoothRadios.clear();
 		m_BluetoothDevices.clear();
 
-		m_CachedAddresses.UpdateValue([](auto& addresses) noexcept
+		if (!m_CachedAddresses.UpdateValue([](auto& addresses) noexcept { addresses.clear(); }))
 		{
-			addresses.clear();
-		});
+			LogErr(L"Could not clear cached addresses");
+		}
 
 		return;
 	}
@@ -736,12 +736,10 @@ namespace QuantumGate::Implementation::Core
 			// Add any trusted/verified public addresses if we have them
 			if (m_PublicEndpoints.AddAddresses(addrs, true).Succeeded())
 			{
-				m_CachedAddresses.UpdateValue([&](auto& addresses) noexcept
+				return m_CachedAddresses.UpdateValue([&](auto& addresses) noexcept
 				{
 					addresses = std::move(addrs);
 				});
-
-				return true;
 			}
 		}
 		catch (const std::exception& e)
@@ -3,6 +3,7 @@
 
 #include "pch.h"
 #include "MessageTransport.h"
+#include "..\Memory\StackBuffer.h"
 #include "..\Common\Random.h"
 #include "..\Common\Endian.h"
 #include "..\Memory\BufferReader.h"
@@ -37,7 +38,7 @@ namespace QuantumGate::Implementation::Core
 			BufferSpan hmac(m_MessageHMAC);
 
 			Memory::BufferReader rdr(buffer, true);
-			if (rdr.Read(size, m_MessageNonceSeed, hmac))
+			if (rdr.Read(size, m_MessageNonceSeed, m_MessageKeyHint, hmac))
 			{
 				m_MessageDataSize = DeObfuscateMessageDataSize(m_MessageDataSizeSettings, size);
 
@@ -49,14 +50,26 @@ namespace QuantumGate::Implementation::Core
 		return false;
 	}
 
-	bool MessageTransport::OHeader::Write(Buffer& buffer) const noexcept
+	bool MessageTransport::OHeader::Write(BufferSpan& buffer) const noexcept
 	{
+		assert(buffer.GetSize() == OHeader::GetSize());
+
+		if (buffer.GetSize() != OHeader::GetSize()) return false;
+
 		const auto size = ObfuscateMessageDataSize(m_MessageDataSizeSettings, m_MessageRandomBits, m_MessageDataSize);
 
 		const BufferView hmac(m_MessageHMAC);
 
-		Memory::BufferWriter wrt(buffer, true);
-		return wrt.WriteWithPreallocation(size, m_MessageNonceSeed, hmac);
+		Memory::StackBuffer<OHeader::GetSize()> hdrbuf;
+		Memory::StackBufferWriter<OHeader::GetSize()> wrt(hdrbuf, true);
+		if (wrt.WriteWithPreallocation(size, m_MessageNonceSeed, m_MessageKeyHint, hmac) &&
+			hdrbuf.GetSize() == buffer.GetSize())
+		{
+			std::memcpy(buffer.GetBytes(), hdrbuf.GetBytes(), hdrbuf.GetSize());
+			return true;
+		}
+
+		return false;
 	}
 
 	UInt32 MessageTransport::OHeader::ObfuscateMessageDataSize(const DataSizeSettings mds_settings,
@@ -127,23 +140,30 @@ namespace QuantumGate::Implementation::Core
 		return false;
 	}
 
-	bool MessageTransport::IHeader::Write(Buffer& buffer) const noexcept
+	bool MessageTransport::IHeader::Write(BufferSpan& buffer) const noexcept
 	{
-		try
+		assert(buffer.GetSize() == IHeader::GetSize() + m_RandomDataSize);
+
+		if (buffer.GetSize() != IHeader::GetSize() + m_RandomDataSize) return false;
+
+		Memory::StackBuffer<IHeader::GetSize()> hdrbuf;
+		Memory::StackBufferWriter<IHeader::GetSize()> wrt(hdrbuf, true);
+		if (wrt.WriteWithPreallocation(m_MessageCounter, m_MessageTime,
+									   m_NextRandomDataPrefixLength, m_RandomDataSize) &&
+			hdrbuf.GetSize() == IHeader::GetSize())
 		{
-			Buffer rnddata;
+			std::memcpy(buffer.GetBytes(), hdrbuf.GetBytes(), hdrbuf.GetSize());
+
 			if (m_RandomDataSize > 0)
 			{
-				rnddata = Random::GetPseudoRandomBytes(m_RandomDataSize);
+				auto rnddata = buffer.GetLast(m_RandomDataSize);
+				Random::GetPseudoRandomBytes(rnddata);
 
 				Dbg(L"MsgTIHdr Random data: %d bytes - %s", rnddata.GetSize(), Util::ToBase64(rnddata)->c_str());
 			}
 
-			Memory::BufferWriter wrt(buffer, true);
-			return wrt.WriteWithPreallocation(m_MessageCounter, m_MessageTime, m_NextRandomDataPrefixLength,
-											  m_RandomDataSize, rnddata);
+			return true;
 		}
-		catch (...) {}
 
 		return false;
 	}
@@ -224,9 +244,11 @@ namespace QuantumGate::Implementation::Core
 		}
 	}
 
-	const Buffer& MessageTransport::GetMessageData() const noexcept
+	BufferView MessageTransport::GetMessageData() const noexcept
 	{
-		return m_MessageData;
+		if (!m_MessageData.IsEmpty()) return m_MessageData;
+
+		return m_ReadMessageData;
 	}
 
 	void MessageTransport::Validate() noexcept
@@ -234,7 +256,7 @@ namespace QuantumGate::Implementation::Core
 		m_Valid = false;
 
 		// If there's message data its size should not exceed maximum allowed
-		if (m_MessageData.GetSize() > MessageTransport::MaxMessageDataSize)
+		if (GetMessageData().GetSize() > MessageTransport::MaxMessageDataSize)
 		{
 			LogErr(L"Could not validate message transport: message data too large (Max. is %u bytes)",
 				   MessageTransport::MaxMessageDataSize);
@@ -250,7 +272,7 @@ namespace QuantumGate::Implementation::Core
 		return m_IHeader.GetMessageTime();
 	}
 
-	std::pair<bool, bool> MessageTransport::Read(BufferView buffer, Crypto::SymmetricKeyData& symkey,
+	std::pair<bool, bool> MessageTransport::Read(BufferSpan buffer, Crypto::SymmetricKeyData& symkey,
 												 const BufferView& nonce) noexcept
 	{
 		assert(buffer.GetSize() >= OHeader::GetSize());
@@ -276,6 +298,15 @@ namespace QuantumGate::Implementation::Core
 				// Remaining buffer size should match data size otherwise something is wrong
 				if (m_OHeader.GetMessageDataSize() == buffer.GetSize())
 				{
+					// If the key hint doesn't match the message was encrypted using a different
+					// key; no need to compute the HMAC and we'll try again with another key
+					if (m_OHeader.GetMessageKeyHint() != Crypto::GetSymmetricKeyHint(symkey, m_OHeader.GetMessageNonceSeed()))
+					{
+						LogDbg(L"MessageTransport key hint mismatch");
+
+						return std::make_pair(false, true);
+					}
+
 					OHeader::HMACBuffer hmac;
 
 					// Calculate message HMAC
@@ -286,24 +317,25 @@ namespace QuantumGate::Implementation::Core
 						// Check if message data corresponds to HMAC
 						if (Crypto::CompareBuffers(m_OHeader.GetHMACBuffer(), hmac))
 						{
-							Buffer decrbuf;
-
-							// Decrypt message data
-							if (Crypto::Decrypt(buffer, decrbuf, symkey, nonce))
+							// Decrypt message data in place; buffer will
+							// refer to just the decrypted data afterwards
+							if (Crypto::DecryptInPlace(buffer, symkey, nonce))
 							{
 								// Get message inner header from buffer
-								if (m_IHeader.Read(decrbuf))
+								if (buffer.GetSize() >= IHeader::GetSize() && m_IHeader.Read(buffer))
 								{
-									// Remove inner message header and random padding data (if any) from buffer
-									decrbuf.RemoveFirst(IHeader::GetSize() + m_IHeader.GetRandomDataSize());
-
-									// Rest of message is message data
-									if (!decrbuf.IsEmpty())
+									const auto ihdr_size = IHeader::GetSize() + m_IHeader.GetRandomDataSize();
+									if (buffer.GetSize() >= ihdr_size)
 									{
-										m_MessageData = std::move(decrbuf);
-									}
+										// Remove inner message header and random padding data (if any) from buffer
+										buffer.RemoveFirst(ihdr_size);
+
+										// Rest of message is message data
+										m_ReadMessageData = buffer;
 
-									success = true;
+										success = true;
+									}
+									else LogDbg(L"MessageTransport random data length mismatch");
 								}
 							}
 							else LogErr(L"Could not decrypt message data");
@@ -336,68 +368,77 @@ namespace QuantumGate::Implementation::Core
 
 		try
 		{
-			Buffer msgdatabuf;
-
-			// Add inner message header
-			if (!m_IHeader.Write(msgdatabuf)) return false;
+			const auto rnddata_size = static_cast<Size>(m_IHeader.GetRandomDataSize());
+			const auto msgdata_size = IHeader::GetSize() + rnddata_size + m_MessageData.GetSize();
 
-			// Add message data if any
-			if (!m_MessageData.IsEmpty())
+			if (msgdata_size > (MessageTransport::IHeader::GetSize() + MessageTransport::MaxMessageAndRandomDataSize))
 			{
-				msgdatabuf += m_MessageData;
+				LogErr(L"Size of MessageTransport data combined with random data is too large: %u bytes (Max. is %u bytes)",
+					   msgdata_size, MessageTransport::MaxMessageAndRandomDataSize);
+
+				return false;
 			}
 
-			if (msgdatabuf.GetSize() > (MessageTransport::IHeader::GetSize() + MessageTransport::MaxMessageAndRandomDataSize))
+			const auto encrdata_size = Crypto::SymmetricTagSize + msgdata_size;
+			const auto msg_size = OHeader::GetSize() + encrdata_size;
+
+			if (msg_size > MessageTransport::MaxMessageSize)
 			{
-				LogErr(L"Size of MessageTransport data combined with random data is too large: %u bytes (Max. is %u bytes)",
-					   msgdatabuf.GetSize(), MessageTransport::MaxMessageAndRandomDataSize);
+				LogErr(L"MessageTransport size too large: %u bytes (Max. is %u bytes)",
+					   msg_size, MessageTransport::MaxMessageSize);
 
 				return false;
 			}
 
+			// Everything gets put in its final place in the output buffer in one go:
+			// [random data prefix][outer header][tag][inner header][random data][message data]
+			// and the part starting at the tag gets encrypted in place
+			buffer.Allocate(m_RandomDataPrefixLength + msg_size);
+
+			BufferSpan outbuf(buffer);
+
+			if (m_RandomDataPrefixLength > 0)
+			{
+				auto rndprefix = outbuf.GetFirst(m_RandomDataPrefixLength);
+				Random::GetPseudoRandomBytes(rndprefix);
+			}
+
+			auto msgbuf = outbuf.GetLast(msg_size);
+			auto ohdrbuf = msgbuf.GetFirst(OHeader::GetSize());
+			auto encrbuf = msgbuf.GetLast(encrdata_size);
+			auto ihdrbuf = encrbuf.GetSub(Crypto::SymmetricTagSize, IHeader::GetSize() + rnddata_size);
+
+			// Add inner message header
+			if (!m_IHeader.Write(ihdrbuf)) return false;
+
+			// Add message data if any
+			if (!m_MessageData.IsEmpty())
+			{
+				std::memcpy(ihdrbuf.GetBytes() + ihdrbuf.GetSize(), m_MessageData.GetBytes(), m_MessageData.GetSize());
+			}
+
 			auto msgohdr = m_OHeader;
-			Buffer encrdata;
+			msgohdr.SetMessageKeyHint(Crypto::GetSymmetricKeyHint(symkey, msgohdr.GetMessageNonceSeed()));
 
 			// Encrypt message
-			if (Crypto::Encrypt(msgdatabuf, encrdata, symkey, nonce))
+			if (Crypto::EncryptInPlace(encrbuf, symkey, nonce))
 			{
-				msgohdr.SetMessageDataSize(encrdata.GetSize());
+				msgohdr.SetMessageDataSize(encrbuf.GetSize());
 
 				// Calculate HMAC for the encrypted message
-				if (Crypto::HMAC(encrdata, msgohdr.GetHMACBuffer(), symkey.AuthKey, Algorithm::Hash::BLAKE2S256))
+				if (Crypto::HMAC(encrbuf, msgohdr.GetHMACBuffer(), symkey.AuthKey, Algorithm::Hash::BLAKE2S256))
 				{
 					assert(msgohdr.GetHMACBuffer().GetSize() == OHeader::HMACBuffer::GetMaxSize());
 
 					Dbg(L"MessageTransport hash: %s", Util::ToBase64(msgohdr.GetHMACBuffer())->c_str());
 
-					auto& msgbuffer = msgdatabuf;
-					msgbuffer.Clear();
-
-					// First get the outer message header into the output buffer, then
-					// add inner message header and message data to the output buffer
-					if (msgohdr.Write(msgbuffer))
+					// Outer message header goes in front of the encrypted data
+					if (msgohdr.Write(ohdrbuf))
 					{
-						msgbuffer += encrdata;
+						Dbg(L"Send buffer plus random data prefix: %d bytes - %s",
+							buffer.GetSize(), Util::ToBase64(buffer)->c_str());
 
-						Dbg(L"Send buffer: %d bytes - %s", msgbuffer.GetSize(), Util::ToBase64(msgbuffer)->c_str());
-
-						if (msgbuffer.GetSize() <= MessageTransport::MaxMessageSize)
-						{
-							if (m_RandomDataPrefixLength > 0)
-							{
-								buffer.Preallocate(m_RandomDataPrefixLength + msgbuffer.GetSize());
-								buffer += Random::GetPseudoRandomBytes(m_RandomDataPrefixLength);
-								buffer += msgbuffer;
-							}
-							else buffer = std::move(msgbuffer);
-
-							Dbg(L"Send buffer plus random data prefix: %d bytes - %s",
-								buffer.GetSize(), Util::ToBase64(buffer)->c_str());
-
-							return true;
-						}
-						else LogErr(L"MessageTransport size too large: %u bytes (Max. is %u bytes)",
-									msgbuffer.GetSize(), MessageTransport::MaxMessageSize);
+						return true;
 					}
 					else LogErr(L"Could not write MessageTransport");
 				}
@@ -411,7 +452,7 @@ namespace QuantumGate::Implementation::Core
 	}
 
 	MessageTransportCheck MessageTransport::Peek(const UInt16 rndp_len, const DataSizeSettings mds_settings,
-												 const Buffer& srcbuf) noexcept
+												 const BufferView& srcbuf) noexcept
 	{
 		// Check if buffer has enough data for outer MessageTransport header
 		if (srcbuf.GetSize() < rndp_len + OHeader::GetSize()) return MessageTransportCheck::NotEnoughData;
@@ -438,39 +479,30 @@ namespace QuantumGate::Implementation::Core
 	}
 
 	MessageTransportCheck MessageTransport::GetFromBuffer(const UInt16 rndp_len, const DataSizeSettings mds_settings,
-														  Buffer& srcbuf, Buffer& destbuf) noexcept
+														  const BufferSpan& srcbuf, BufferSpan& msgbuf) noexcept
 	{
-		try
-		{
-			// Check if buffer has enough data for outer MessageTransport header
-			if (srcbuf.GetSize() < rndp_len + OHeader::GetSize()) return MessageTransportCheck::NotEnoughData;
-
-			BufferView srcbufview(srcbuf);
-			srcbufview.RemoveFirst(rndp_len);
+		// Check if buffer has enough data for outer MessageTransport header
+		if (srcbuf.GetSize() < rndp_len + OHeader::GetSize()) return MessageTransportCheck::NotEnoughData;
 
-			OHeader hdr(mds_settings);
-			if (hdr.Read(srcbufview))
-			{
-				const auto msglen = hdr.GetSize() + hdr.GetMessageDataSize();
+		auto srcbufspan = srcbuf;
+		srcbufspan.RemoveFirst(rndp_len);
 
-				// If buffer has enough data for a complete message read
-				// the message out and remove it from the buffer
-				if (srcbufview.GetSize() >= msglen)
-				{
-					destbuf.Allocate(msglen);
-					memcpy(destbuf.GetBytes(), srcbufview.GetBytes(), msglen);
+		OHeader hdr(mds_settings);
+		if (hdr.Read(srcbufspan))
+		{
+			const auto msglen = hdr.GetSize() + hdr.GetMessageDataSize();
 
-					srcbuf.RemoveFirst(rndp_len + msglen);
+			// If buffer has enough data for a complete message
+			// refer to it; it gets removed by the caller
+			if (srcbufspan.GetSize() >= msglen)
+			{
+				msgbuf = srcbufspan.GetFirst(msglen);
 
-					return MessageTransportCheck::CompleteMessage;
-				}
+				return MessageTransportCheck::CompleteMessage;
 			}
-
-			return MessageTransportCheck::NotEnoughData;
 		}
-		catch (...) {}
 
-		return MessageTransportCheck::Failed;
+		return MessageTransportCheck::NotEnoughData;
 	}
 
 	std::optional<UInt32> MessageTransport::GetNonceSeedFromBuffer(const BufferView& srcbuf) noexcept
@@ -485,4 +517,17 @@ namespace QuantumGate::Implementation::Core
 
 		return std::nullopt;
 	}
+
+	std::optional<UInt32> MessageTransport::GetKeyHintFromBuffer(const BufferView& srcbuf) noexcept
+	{
+		// Buffer should at least have the MessageTransport header
+		if (srcbuf.GetSize() >= OHeader::GetSize())
+		{
+			// Key hint starts at 9th byte and is 4 bytes long stored in network byte order
+			UInt32 hint = Endian::FromNetworkByteOrder(*reinterpret_cast<const UInt32*>(srcbuf.GetBytes() + 8));
+			return { hint };
+		}
+
+		return std::nullopt;
+	}
 }
@@ -44,12 +44,13 @@ namespace QuantumGate::Implementation::Core
 			void Initialize() noexcept;
 
 			[[nodiscard]] bool Read(const BufferView& buffer) noexcept;
-			[[nodiscard]] bool Write(Buffer& buffer) const noexcept;
+			[[nodiscard]] bool Write(BufferSpan& buffer) const noexcept;
 
 			static constexpr Size GetSize() noexcept
 			{
 				return 4 + // 4 bytes for random bits and m_MessageDataSize combined
 					sizeof(m_MessageNonceSeed) +
+					sizeof(m_MessageKeyHint) +
 					OHeader::MessageHMACSize;
 			}
 
@@ -58,6 +59,8 @@ namespace QuantumGate::Implementation::Core
 			inline Size GetMessageDataSize() const noexcept { return m_MessageDataSize; }
 			inline void SetMessageNonceSeed(UInt32 seed) noexcept { m_MessageNonceSeed = seed; }
 			inline UInt32 GetMessageNonceSeed() const noexcept { return m_MessageNonceSeed; }
+			inline void SetMessageKeyHint(UInt32 hint) noexcept { m_MessageKeyHint = hint; }
+			inline UInt32 GetMessageKeyHint() const noexcept { return m_MessageKeyHint; }
 
 			static UInt32 ObfuscateMessageDataSize(const DataSizeSettings mds_settings, const UInt32 rnd_bits,
 												   UInt32 size) noexcept;
@@ -68,6 +71,7 @@ namespace QuantumGate::Implementation::Core
 			UInt32 m_MessageRandomBits{ 0 };
 			UInt32 m_MessageDataSize{ 0 };
 			UInt32 m_MessageNonceSeed{ 0 };
+			UInt32 m_MessageKeyHint{ 0 };
 			HMACBuffer m_MessageHMAC;
 		};
 
@@ -84,7 +88,10 @@ namespace QuantumGate::Implementation::Core
 			void Initialize() noexcept;
 
 			[[nodiscard]] bool Read(const BufferView& buffer) noexcept;
-			[[nodiscard]] bool Write(Buffer& buffer) const noexcept;
+
+			// Writes the header followed by the random data into
+			// the buffer, which should be exactly large enough
+			[[nodiscard]] bool Write(BufferSpan& buffer) const noexcept;
 
 			static constexpr Size GetSize() noexcept
 			{
@@ -128,7 +135,10 @@ namespace QuantumGate::Implementation::Core
 		inline UInt32 GetMessageNonceSeed() const noexcept { return m_OHeader.GetMessageNonceSeed(); }
 
 		void SetMessageData(Buffer&& buffer) noexcept;
-		const Buffer& GetMessageData() const noexcept;
+
+		// After Read() the message data refers to memory inside the buffer
+		// that was passed in, which therefore needs to remain valid
+		[[nodiscard]] BufferView GetMessageData() const noexcept;
 
 		inline void SetCurrentRandomDataPrefixLength(const UInt16 len) noexcept { m_RandomDataPrefixLength = len; }
 		inline void SetNextRandomDataPrefixLength(const UInt16 len) noexcept { m_IHeader.SetRandomDataPrefixLength(len); }
@@ -136,19 +146,28 @@ namespace QuantumGate::Implementation::Core
 
 		SystemTime GetMessageTime() const noexcept;
 
-		[[nodiscard]] std::pair<bool, bool> Read(BufferView buffer, Crypto::SymmetricKeyData& symkey,
+		// Decrypts the message in place; if the HMAC doesn't match the buffer is left untouched
+		// so that reading can be retried with another key, otherwise its contents are modified
+		[[nodiscard]] std::pair<bool, bool> Read(BufferSpan buffer, Crypto::SymmetricKeyData& symkey,
 												 const BufferView& nonce) noexcept;
 
 		[[nodiscard]] bool Write(Buffer& buffer, Crypto::SymmetricKeyData& symkey, const BufferView& nonce) noexcept;
 
 		static MessageTransportCheck Peek(const UInt16 rndp_len, const DataSizeSettings mds_settings,
-										  const Buffer& srcbuf) noexcept;
+										  const BufferView& srcbuf) noexcept;
 
+		// On success msgbuf refers to the complete message inside srcbuf (nothing gets copied)
+		// and rndp_len + msgbuf.GetSize() bytes can be removed from the front of srcbuf
 		static MessageTransportCheck GetFromBuffer(const UInt16 rndp_len, const DataSizeSettings mds_settings,
-												   Buffer& srcbuf, Buffer& destbuf) noexcept;
+												   const BufferSpan& srcbuf, BufferSpan& msgbuf) noexcept;
 
 		static std::optional<UInt32> GetNonceSeedFromBuffer(const BufferView& srcbuf) noexcept;
 
+		// The key hint tells which key the message was encrypted with
+		// (see Crypto::GetSymmetricKeyHint()) so that the receiver
+		// doesn't have to try all its keys to find the right one
+		static std::optional<UInt32> GetKeyHintFromBuffer(const BufferView& srcbuf) noexcept;
+
 	public:
 		static constexpr Size MaxMessageDataSizeOffset{ 12 };
 
@@ -173,6 +192,7 @@ namespace QuantumGate::Implementation::Core
 		OHeader m_OHeader;
 		IHeader m_IHeader;
 		Buffer m_MessageData;
+		BufferView m_ReadMessageData;
 		UInt16 m_RandomDataPrefixLength{ 0 };
 	};
 }
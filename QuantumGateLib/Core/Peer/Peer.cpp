@@ -5,6 +5,7 @@
 #include "Peer.h"
 #include "PeerManager.h"
 #include "..\..\Common\Random.h"
+#include "..\..\Common\ScopeGuard.h"
 #include "..\..\API\Access.h"
 
 using namespace std::literals;
@@ -253,6 +254,19 @@ namespace QuantumGate::Implementation::Core::Peer
 		return false;
 	}
 
+	std::chrono::seconds Peer::GetMaxHandshakeDuration(const std::chrono::seconds max_handshake_duration) const noexcept
+	{
+		if (IsRelayed())
+		{
+			// Minimum of 2 times the maximum handshake duration setting for
+			// relayed peer connections (because of all the delays in between peers)
+			const auto hops = GetPeerEndpoint().GetRelayHop();
+			return max_handshake_duration * (hops > 2 ? hops : 2);
+		}
+
+		return max_handshake_duration;
+	}
+
 	bool Peer::CheckStatus(const bool noise_enabled, const SteadyTime current_steadytime,
 						   const std::chrono::seconds max_connect_duration, std::chrono::seconds max_handshake_duration) noexcept
 	{
@@ -298,13 +312,7 @@ namespace QuantumGate::Implementation::Core::Peer
 				EnableSend();
 			}
 
-			if (IsRelayed())
-			{
-				// Minimum of 2 times the maximum handshake duration setting for
-				// relayed peer connections (because of all the delays in between peers)
-				const auto hops = GetPeerEndpoint().GetRelayHop();
-				max_handshake_duration = max_handshake_duration * (hops > 2 ? hops : 2);
-			}
+			max_handshake_duration = GetMaxHandshakeDuration(max_handshake_duration);
 
 			if (GetIOStatus().IsConnecting() && ((current_steadytime - GetConnectedSteadyTime()) > max_connect_duration))
 			{
@@ -386,6 +394,19 @@ namespace QuantumGate::Implementation::Core::Peer
 
 		const auto& settings = GetSettings();
 
+		// Continue the handshake if we were waiting for
+		// our primary asymmetric keys to get generated
+		if (IsFlagSet(Flags::PrimaryKeyExchangePending) && !GetKeyExchange().HasPendingPrimaryAsymmetricKeys())
+		{
+			SetFlag(Flags::PrimaryKeyExchangePending, false);
+
+			if (!m_MessageProcessor.SendBeginPrimaryKeyExchange())
+			{
+				SetDisconnectCondition(DisconnectCondition::GeneralFailure);
+				return false;
+			}
+		}
+
 		// First we check if we have data waiting to be received;
 		// if so receive and process any received messages
 		if (HasReceiveEvents())
@@ -484,6 +505,51 @@ namespace QuantumGate::Implementation::Core::Peer
 		GetKeys().ExpireAllExceptLatestKeyPair();
 	}
 
+	void Peer::RequestHandshakeAsymmetricKeys() noexcept
+	{
+		// Inbound peers are Alice and outbound peers are Bob in the key exchanges
+		const auto owner = (GetConnectionType() == PeerConnectionType::Inbound) ?
+			Crypto::AsymmetricKeyOwner::Alice : Crypto::AsymmetricKeyOwner::Bob;
+
+		// Gets called from a key generation thread when keys that weren't pre-generated
+		// are ready; signaling the work event gets the peer processed again so that the
+		// handshake continues (see IsWaitingForAsymmetricKeys())
+		const auto make_callback = [&]() noexcept
+		{
+			return [peer = m_PeerPointer]() mutable noexcept
+			{
+				if (auto peerths = peer.lock(); peerths != nullptr)
+				{
+					peerths->WithUniqueLock()->SignalWorkEvent();
+				}
+			};
+		};
+
+		const auto algorithms = GetAlgorithms();
+
+		GetKeyExchange().RequestPrimaryAsymmetricKeys(algorithms, owner, make_callback());
+		GetKeyExchange().RequestSecondaryAsymmetricKeys(algorithms, owner, make_callback());
+	}
+
+	bool Peer::IsWaitingForAsymmetricKeys(const MessageType type) const noexcept
+	{
+		if (m_KeyExchange == nullptr) return false;
+
+		// Handshake messages that need our asymmetric keys to get processed
+		switch (type)
+		{
+			case MessageType::BeginPrimaryKeyExchange:
+				return m_KeyExchange->HasPendingPrimaryAsymmetricKeys();
+			case MessageType::EndPrimaryKeyExchange:
+			case MessageType::BeginSecondaryKeyExchange:
+				return m_KeyExchange->HasPendingSecondaryAsymmetricKeys();
+			default:
+				break;
+		}
+
+		return false;
+	}
+
 	bool Peer::SetStatus(const Status status) noexcept
 	{
 		auto success = true;
@@ -621,6 +687,8 @@ namespace QuantumGate::Implementation::Core::Peer
 					{
 						LogInfo(L"Peer %s is ready", GetPeerName().c_str());
 
+						m_PeerManager.RecordHandshakeDuration(Util::GetCurrentSteadyTime() - GetConnectedSteadyTime());
+
 						// We went to the ready state; this means the connection attempt succeeded
 						// From now on concatenate messages when possible
 						SetFlag(Flags::ConcatenateMessages, true);
@@ -850,35 +918,42 @@ namespace QuantumGate::Implementation::Core::Peer
 		{
 			if (msg_size > 0) m_PeerData.WithUniqueLock()->ExtendersBytesSent += msg_size;
 
-			auto success{ false };
+			SignalWorkEvent();
+		}
 
-			switch (GetGateType())
-			{
-				case GateType::TCPSocket:
-					success = GetSocket<TCP::Socket>().GetEvent().Set();
-					break;
-				case GateType::UDPSocket:
-					success = GetSocket<UDP::Socket>().GetReceiveEvent().Set();
-					break;
-				case GateType::BTHSocket:
-					success = GetSocket<BTH::Socket>().GetEvent().Set();
-					break;
-				case GateType::RelaySocket:
-					success = GetSocket<Relay::Socket>().GetReceiveEvent().Set();
-					break;
-				default:
-					// Shouldn't get here
-					assert(false);
-					break;
-			}
+		return result;
+	}
 
-			if (!success)
-			{
-				LogErr(L"Failed to set event on socket (%s)", GetLastSysErrorString().c_str());
-			}
+	void Peer::SignalWorkEvent() noexcept
+	{
+		auto success{ false };
+
+		// Setting the event the peermanager waits on for this peer
+		// gets the peer scheduled for processing
+		switch (GetGateType())
+		{
+			case GateType::TCPSocket:
+				success = GetSocket<TCP::Socket>().GetEvent().Set();
+				break;
+			case GateType::UDPSocket:
+				success = GetSocket<UDP::Socket>().GetReceiveEvent().Set();
+				break;
+			case GateType::BTHSocket:
+				success = GetSocket<BTH::Socket>().GetEvent().Set();
+				break;
+			case GateType::RelaySocket:
+				success = GetSocket<Relay::Socket>().GetReceiveEvent().Set();
+				break;
+			default:
+				// Shouldn't get here
+				assert(false);
+				break;
 		}
 
-		return result;
+		if (!success)
+		{
+			LogErr(L"Failed to set event on socket (%s)", GetLastSysErrorString().c_str());
+		}
 	}
 
 	Result<> Peer::Send(const MessageType msgtype, Buffer&& buffer, const SendParameters::PriorityOption priority,
@@ -1044,16 +1119,16 @@ namespace QuantumGate::Implementation::Core::Peer
 					const auto result = Gate::Send(sndbuf);
 					if (result.Succeeded())
 					{
-						sndbuf.RemoveFirst(*result);
-
-						if (!sndbuf.IsEmpty())
+						if (*result < sndbuf.GetSize())
 						{
-							// If we weren't able to send all
-							// data we'll try again later
+							// If we weren't able to send all data we'll try again later;
+							// the send buffer takes over the memory and skips the sent part
 							m_SendBuffer = std::move(sndbuf);
+							m_SendBuffer.RemoveFirst(*result);
 							m_SendBuffer.SetEvent();
 							break;
 						}
+						else sndbuf.Clear();
 					}
 					else
 					{
@@ -1153,19 +1228,33 @@ namespace QuantumGate::Implementation::Core::Peer
 			case MessageTransportCheck::CompleteMessage:
 			{
 				Size num{ 0 };
-				Buffer msgbuf;
+				Size num_consumed{ 0 };
+
+				// Messages get decrypted and processed in place in the receive buffer;
+				// the consumed data gets removed from the front all at once when we leave
+				auto sg = MakeScopeGuard([&]() noexcept
+				{
+					if (num_consumed > 0) m_ReceiveBuffer.RemoveFirst(num_consumed);
+				});
 
 				// Get as many completed messages from the receive buffer
 				// as possible and process them
 				while (true)
 				{
+					BufferSpan rcvbuf(m_ReceiveBuffer);
+					rcvbuf.RemoveFirst(num_consumed);
+
+					BufferSpan msgbuf;
+
 					const auto msgchk2 = MessageTransport::GetFromBuffer(m_NextPeerRandomDataPrefixLength,
 																		 m_MessageTransportDataSizeSettings,
-																		 m_ReceiveBuffer, msgbuf);
+																		 rcvbuf, msgbuf);
 					switch (msgchk2)
 					{
 						case MessageTransportCheck::CompleteMessage:
 						{
+							num_consumed += m_NextPeerRandomDataPrefixLength + msgbuf.GetSize();
+
 							const auto& [retval, nump, nrndplen] = ProcessMessageTransport(msgbuf, settings);
 							if (retval)
 							{
@@ -1177,7 +1266,7 @@ namespace QuantumGate::Implementation::Core::Peer
 								// This prevents this socket from hoarding all the processing capacity.
 								if (num >= settings.Local.Concurrency.WorkerThreadsMaxBurst)
 								{
-									if (!m_ReceiveBuffer.IsEmpty()) m_ReceiveBuffer.SetEvent();
+									if (m_ReceiveBuffer.GetSize() > num_consumed) m_ReceiveBuffer.SetEvent();
 									return true;
 								}
 							}
@@ -1223,104 +1312,100 @@ namespace QuantumGate::Implementation::Core::Peer
 		return false;
 	}
 
-	std::tuple<bool, Size, UInt16> Peer::ProcessMessageTransport(const BufferView msgbuf, const Settings& settings) noexcept
+	std::tuple<bool, Size, UInt16> Peer::ProcessMessageTransport(BufferSpan msgbuf, const Settings& settings) noexcept
 	{
 		const auto nonce_seed = MessageTransport::GetNonceSeedFromBuffer(msgbuf);
-		if (nonce_seed)
+		const auto key_hint = MessageTransport::GetKeyHintFromBuffer(msgbuf);
+		if (nonce_seed && key_hint)
 		{
-			// Try to decrypt message using all the keys we have;
-			// we'll start with the (first) latest key available
-			auto keynum = 0u;
+			std::optional<std::tuple<bool, Size, UInt16>> result;
 
-			while (true)
+			// Try to decrypt message using the keys we have whose key hint matches the
+			// one in the message (normally just one); we'll start with the (first)
+			// latest key available and the autogen key is the last one we try
+			const auto stopped = m_Keys.ForEachDecryptionKey(*nonce_seed, *key_hint, GetConnectionType(), IsAutoGenKeyAllowed(),
+														 [&](Crypto::SymmetricKeyData& symkey, const Buffer& nonce) noexcept
 			{
-				const auto& [symkey, nonce] = m_Keys.GetDecryptionKeyAndNonce(keynum, *nonce_seed,
-																			  GetConnectionType(), IsAutoGenKeyAllowed());
+				auto msg = MessageTransport(m_MessageTransportDataSizeSettings, settings);
 
-				// The next time we'll try the next
-				// key we have until we run out
-				++keynum;
+				Dbg(L"Receive buffer: %d bytes - %s", msgbuf.GetSize(), Util::ToBase64(msgbuf)->c_str());
 
-				if (symkey != nullptr)
+				const auto& [retval, retry] = msg.Read(msgbuf, symkey, nonce);
+				if (retval && msg.IsValid())
 				{
-					auto msg = MessageTransport(m_MessageTransportDataSizeSettings, settings);
+					// MessageTransport counter should match the expected message counter
+					// if we have one already; this is to protect against replay attacks
+					const auto counter = GetNextPeerMessageCounter();
 
-					Dbg(L"Receive buffer: %d bytes - %s", msgbuf.GetSize(), Util::ToBase64(msgbuf)->c_str());
+					Dbg(L"MessageTransport counters %u/%u",
+						counter.has_value() ? counter.value() : 0, msg.GetMessageCounter());
 
-					const auto& [retval, retry] = msg.Read(msgbuf, *symkey, nonce);
-					if (retval && msg.IsValid())
+					if (counter.has_value() && (counter.value() != msg.GetMessageCounter()))
 					{
-						// MessageTransport counter should match the expected message counter
-						// if we have one already; this is to protect against replay attacks
-						const auto counter = GetNextPeerMessageCounter();
-
-						Dbg(L"MessageTransport counters %u/%u",
-							counter.has_value() ? counter.value() : 0, msg.GetMessageCounter());
+						// Unexpected message counter
+						LogErr(L"Peer %s sent a message with an invalid counter value %u (%u expected)",
+							   GetPeerName().c_str(), msg.GetMessageCounter(), counter.value());
+						return false;
+					}
+					else if (std::chrono::abs(Util::GetCurrentSystemTime() - msg.GetMessageTime()) >
+							 settings.Message.AgeTolerance)
+					{
+						bool disconnect{ true };
 
-						if (counter.has_value() && (counter.value() != msg.GetMessageCounter()))
-						{
-							// Unexpected message counter
-							LogErr(L"Peer %s sent a message with an invalid counter value %u (%u expected)",
-								   GetPeerName().c_str(), msg.GetMessageCounter(), counter.value());
-							break;
-						}
-						else if (std::chrono::abs(Util::GetCurrentSystemTime() - msg.GetMessageTime()) >
-								 settings.Message.AgeTolerance)
+						if (CanSuspend())
 						{
-							bool disconnect{ true };
+							const auto lres_time = GetLastResumedSteadyTime();
 
-							if (CanSuspend())
+							if (lres_time.has_value())
 							{
-								const auto lres_time = GetLastResumedSteadyTime();
-
-								if (lres_time.has_value())
+								const auto now = Util::GetCurrentSteadyTime();
+								const auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(now - *lres_time);
+
+								LogWarn(L"Peer %s sent a message outside time tolerance (%jd seconds). "
+										L"Connection was suspended; resume steady time %jd, current is %jd, delta is %jdms",
+										GetPeerName().c_str(), settings.Message.AgeTolerance.count(),
+										lres_time->time_since_epoch().count(), now.time_since_epoch().count(),
+										delta.count());
+
+								// Due to connection being suspended some messages can arrive late; we
+								// keep accepting late messages for a brief period
+								if (delta < settings.Local.SuspendTimeout + settings.Message.AgeTolerance + 600s)
 								{
-									const auto now = Util::GetCurrentSteadyTime();
-									const auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(now - *lres_time);
-
-									LogWarn(L"Peer %s sent a message outside time tolerance (%jd seconds). "
-											L"Connection was suspended; resume steady time %jd, current is %jd, delta is %jdms",
-											GetPeerName().c_str(), settings.Message.AgeTolerance.count(),
-											lres_time->time_since_epoch().count(), now.time_since_epoch().count(),
-											delta.count());
-
-									// Due to connection being suspended some messages can arrive late; we
-									// keep accepting late messages for a brief period
-									if (delta < settings.Local.SuspendTimeout + settings.Message.AgeTolerance + 600s)
-									{
-										disconnect = false;
-									}
+									disconnect = false;
 								}
 							}
+						}
 
-							if (disconnect)
-							{
-								// Message should not be too old or too far into the future
-								LogErr(L"Peer %s sent a message outside time tolerance (%jd seconds)",
-									   GetPeerName().c_str(), settings.Message.AgeTolerance.count());
-								break;
-							}
+						if (disconnect)
+						{
+							// Message should not be too old or too far into the future
+							LogErr(L"Peer %s sent a message outside time tolerance (%jd seconds)",
+								   GetPeerName().c_str(), settings.Message.AgeTolerance.count());
+							return false;
 						}
-						
-						const auto retval2 = ProcessMessages(msg.GetMessageData(), *symkey);
-						return std::make_tuple(retval2.first, retval2.second, msg.GetNextRandomDataPrefixLength());
-					}
-					else if (!msg.IsValid() && !retry)
-					{
-						// Unrecognized message
-						LogErr(L"Peer %s sent an invalid message", GetPeerName().c_str());
-						break;
 					}
+					
+					const auto retval2 = ProcessMessages(msg.GetMessageData(), symkey);
+					result = std::make_tuple(retval2.first, retval2.second, msg.GetNextRandomDataPrefixLength());
+					return false;
 				}
-				else
+				else if (!msg.IsValid() && !retry)
 				{
-					// We have no more keys to try
-					LogErr(L"Could not read message using available keys");
-					break;
+					// Unrecognized message
+					LogErr(L"Peer %s sent an invalid message", GetPeerName().c_str());
+					return false;
 				}
-			}
+
+				// Try the next key
+				return true;
+			});
+
+			if (result.has_value()) return *result;
+
+			// We have no more keys to try
+			if (!stopped) LogErr(L"Could not read message using available keys");
 		}
-		else LogErr(L"Could not get nonce seed from message buffer");
+		else LogErr(L"Could not get nonce seed or key hint from message buffer");
 
 		// Unrecognized or invalid message; this is a fatal problem and may be an attack
 		// so the peer should get disconnected asap
@@ -1558,9 +1643,80 @@ namespace QuantumGate::Implementation::Core::Peer
 			return true;
 		}
 
+		if (IsFlagSet(Flags::PrimaryKeyExchangePending) && !GetKeyExchange().HasPendingPrimaryAsymmetricKeys())
+		{
+			return true;
+		}
+
 		return false;
 	}
 
+	bool Peer::HasDeferredWork(const bool noise_enabled) const noexcept
+	{
+		// Work that was left over after processing (because of processing limits,
+		// rate limits etc.) and that doesn't cause the work event to get signaled;
+		// messages waiting for asymmetric keys get the work event signaled once
+		// the keys are ready
+		if (m_ReceiveBuffer.IsEventSet() ||
+			(m_ReceiveQueues.HaveMessages() && !m_ReceiveQueues.IsWaitingForAsymmetricKeys())) return true;
+
+		if (!IsFlagSet(Flags::SendDisabled) && (m_SendBuffer.IsEventSet() || m_SendQueues.HaveMessages())) return true;
+
+		const auto status = GetStatus();
+
+		// Noise queue needs to be refilled or has noise ready to be sent
+		if (noise_enabled && status >= Status::Connected && status != Status::Suspended &&
+			status != Status::Disconnected && (m_NoiseQueue.IsEmpty() || m_NoiseQueue.IsQueuedNoiseReady()))
+		{
+			return true;
+		}
+
+		if (NeedsExtenderUpdate() && status == Status::Ready) return true;
+
+		return false;
+	}
+
+	std::optional<SteadyTime> Peer::GetNextDeadline(const bool noise_enabled,
+													 const std::chrono::seconds max_connect_duration,
+													 const std::chrono::seconds max_handshake_duration) const noexcept
+	{
+		std::optional<SteadyTime> deadline;
+
+		const auto update_deadline = [&](const std::optional<SteadyTime>& steadytime) noexcept
+		{
+			if (steadytime.has_value() && (!deadline.has_value() || *steadytime < *deadline))
+			{
+				deadline = steadytime;
+			}
+		};
+
+		const auto status = GetStatus();
+
+		// Connect and handshake timeouts
+		if (status < Status::Ready)
+		{
+			if (GetIOStatus().IsConnecting())
+			{
+				update_deadline(GetConnectedSteadyTime() + max_connect_duration);
+			}
+			else update_deadline(GetConnectedSteadyTime() + GetMaxHandshakeDuration(max_handshake_duration));
+		}
+
+		// Send disabled for a period of time (handshake delays)
+		if (IsFlagSet(Flags::SendDisabled) && m_SendDisabledDuration > 0ms)
+		{
+			update_deadline(m_SendDisabledSteadyTime + m_SendDisabledDuration);
+		}
+
+		if (noise_enabled) update_deadline(m_NoiseQueue.GetNextNoiseSteadyTime());
+
+		update_deadline(m_SendQueues.GetNextDelayedMessageSteadyTime());
+
+		update_deadline(m_KeyUpdate.GetNextEventSteadyTime());
+
+		return deadline;
+	}
+
 	void Peer::SetLUID() noexcept
 	{
 		m_PeerData.WithUniqueLock([&](Data& peer_data) noexcept
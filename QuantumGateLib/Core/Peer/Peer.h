@@ -38,17 +38,18 @@ namespace QuantumGate::Implementation::Core::Peer
 			ConcatenateMessages,
 			HandshakeStartDelay,
 			SendDisabled,
-			NeedsExtenderUpdate
+			NeedsExtenderUpdate,
+			PrimaryKeyExchangePending
 		};
 
-		class EventBuffer final : public Buffer
+		class EventBuffer final : public StreamBuffer
 		{
 		public:
 			inline void SetEvent() noexcept { m_EventState = true; }
 			inline void ResetEvent() noexcept { m_EventState = false; }
 			[[nodiscard]] inline bool IsEventSet() const noexcept { return m_EventState; }
 
-			using Buffer::operator=;
+			using StreamBuffer::operator=;
 
 		private:
 			bool m_EventState{ false };
@@ -171,6 +172,9 @@ namespace QuantumGate::Implementation::Core::Peer
 		void ReleaseKeyExchange() noexcept;
 		[[nodiscard]] inline KeyExchange& GetKeyExchange() noexcept { assert(m_KeyExchange != nullptr); return *m_KeyExchange; }
 		[[nodiscard]] inline const KeyExchange& GetKeyExchange() const noexcept { assert(m_KeyExchange != nullptr); return *m_KeyExchange; }
+		void RequestHandshakeAsymmetricKeys() noexcept;
+		[[nodiscard]] bool IsWaitingForAsymmetricKeys(const MessageType type) const noexcept;
+		inline void SetPrimaryKeyExchangePending() noexcept { SetFlag(Flags::PrimaryKeyExchangePending, true); }
 
 		[[nodiscard]] inline KeyUpdate& GetKeyUpdate() noexcept { return m_KeyUpdate; }
 
@@ -202,6 +206,11 @@ namespace QuantumGate::Implementation::Core::Peer
 		void UpdateReputation(const Access::AddressReputationUpdate rep_update) noexcept;
 
 		[[nodiscard]] bool HasPendingEvents(const SteadyTime current_steadytime) noexcept;
+		[[nodiscard]] bool HasDeferredWork(const bool noise_enabled) const noexcept;
+		[[nodiscard]] std::optional<SteadyTime> GetNextDeadline(const bool noise_enabled,
+																const std::chrono::seconds max_connect_duration,
+																const std::chrono::seconds max_handshake_duration) const noexcept;
+		void SignalWorkEvent() noexcept;
 		[[nodiscard]] bool ProcessEvents(const SteadyTime current_steadytime);
 		void ProcessLocalExtenderUpdate(const Vector<ExtenderUUID>& extuuids);
 		[[nodiscard]] bool ProcessPeerExtenderUpdate(Vector<ExtenderUUID>&& uuids) noexcept;
@@ -232,6 +241,8 @@ namespace QuantumGate::Implementation::Core::Peer
 
 		[[nodiscard]] bool SendFromNoiseQueue(const Settings& settings) noexcept;
 
+		[[nodiscard]] std::chrono::seconds GetMaxHandshakeDuration(const std::chrono::seconds max_handshake_duration) const noexcept;
+
 		void EnableSend() noexcept;
 		void DisableSend() noexcept;
 		void DisableSend(const std::chrono::milliseconds duration) noexcept;
@@ -257,7 +268,7 @@ namespace QuantumGate::Implementation::Core::Peer
 
 		[[nodiscard]] bool ProcessFromReceiveQueues(const Settings& settings) noexcept;
 		[[nodiscard]] bool ReceiveAndProcess(const Settings& settings) noexcept;
-		[[nodiscard]] std::tuple<bool, Size, UInt16> ProcessMessageTransport(const BufferView msgbuf, const Settings& settings) noexcept;
+		[[nodiscard]] std::tuple<bool, Size, UInt16> ProcessMessageTransport(BufferSpan msgbuf, const Settings& settings) noexcept;
 		[[nodiscard]] std::pair<bool, Size> ProcessMessages(BufferView buffer, const Crypto::SymmetricKeyData& symkey) noexcept;
 
 		[[nodiscard]] PeerReceiveQueues& GetReceiveQueues() noexcept { return m_ReceiveQueues; }
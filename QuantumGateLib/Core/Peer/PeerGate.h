@@ -45,6 +45,7 @@ namespace QuantumGate::Implementation::Core::Peer
 
 		[[nodiscard]] Result<Size> Send(const BufferView& buffer) noexcept { assert(m_Socket); return m_Socket->Send(buffer); }
 		[[nodiscard]] Result<Size> Receive(Buffer& buffer) noexcept { assert(m_Socket); return m_Socket->Receive(buffer); }
+		[[nodiscard]] Result<Size> Receive(StreamBuffer& buffer) noexcept { assert(m_Socket); return m_Socket->Receive(buffer); }
 
 		void Close(const bool linger = false) noexcept { assert(m_Socket); return m_Socket->Close(linger); }
 
@@ -19,10 +19,29 @@ namespace QuantumGate::Implementation::Core::Peer
 		KeyExchange& operator=(const KeyExchange&) = delete;
 		KeyExchange& operator=(KeyExchange&&) noexcept = default;
 
+		// The asymmetric keys for the handshake can be requested as soon as the algorithms
+		// are known; when no pre-generated keys are available they get generated by the key
+		// generation threads and the callback gets called once they're ready, so that the
+		// handshake can continue without holding up the calling thread
+		inline void RequestPrimaryAsymmetricKeys(const Algorithms& algorithms, const Crypto::AsymmetricKeyOwner owner,
+												 Callback<void() noexcept>&& callback) noexcept
+		{
+			RequestAsymmetricKeys(m_PrimaryKeyRequest, algorithms.PrimaryAsymmetric, owner, std::move(callback));
+		}
+
+		inline void RequestSecondaryAsymmetricKeys(const Algorithms& algorithms, const Crypto::AsymmetricKeyOwner owner,
+												   Callback<void() noexcept>&& callback) noexcept
+		{
+			RequestAsymmetricKeys(m_SecondaryKeyRequest, algorithms.SecondaryAsymmetric, owner, std::move(callback));
+		}
+
+		[[nodiscard]] inline bool HasPendingPrimaryAsymmetricKeys() const noexcept { return IsPending(m_PrimaryKeyRequest); }
+		[[nodiscard]] inline bool HasPendingSecondaryAsymmetricKeys() const noexcept { return IsPending(m_SecondaryKeyRequest); }
+
 		[[nodiscard]] inline bool GeneratePrimaryAsymmetricKeys(const Algorithms& algorithms,
 																const Crypto::AsymmetricKeyOwner type) noexcept
 		{
-			return GenerateAsymmetricKeys(m_PrimaryAsymmetricKeys, algorithms.PrimaryAsymmetric, type);
+			return GenerateAsymmetricKeys(m_PrimaryAsymmetricKeys, m_PrimaryKeyRequest, algorithms.PrimaryAsymmetric, type);
 		}
 
 		inline void SetPeerPrimaryHandshakeData(ProtectedBuffer&& buffer) noexcept
@@ -57,7 +76,8 @@ namespace QuantumGate::Implementation::Core::Peer
 		[[nodiscard]] bool GenerateSecondaryAsymmetricKeys(const Algorithms& algorithms,
 														   const Crypto::AsymmetricKeyOwner owner) noexcept
 		{
-			return GenerateAsymmetricKeys(m_SecondaryAsymmetricKeys, algorithms.SecondaryAsymmetric, owner);
+			return GenerateAsymmetricKeys(m_SecondaryAsymmetricKeys, m_SecondaryKeyRequest,
+										  algorithms.SecondaryAsymmetric, owner);
 		}
 
 		inline void SetPeerSecondaryHandshakeData(ProtectedBuffer&& buffer) noexcept
@@ -224,7 +244,29 @@ namespace QuantumGate::Implementation::Core::Peer
 		}
 
 	private:
+		inline void RequestAsymmetricKeys(std::shared_ptr<KeyGeneration::KeyRequest_ThS>& request,
+										  const Algorithm::Asymmetric aa, const Crypto::AsymmetricKeyOwner owner,
+										  Callback<void() noexcept>&& callback) noexcept
+		{
+			// Should not already have a request
+			assert(request == nullptr);
+
+			// Bob doesn't need an asymmetric keypair for key encapsulation
+			if (Crypto::AsymmetricKeyData(aa).GetKeyExchangeType() == Crypto::KeyExchangeType::KeyEncapsulation &&
+				owner == Crypto::AsymmetricKeyOwner::Bob) return;
+
+			// If this fails the keys will get generated
+			// on the fly when they're needed
+			request = m_KeyManager.RequestAsymmetricKeys(aa, std::move(callback));
+		}
+
+		[[nodiscard]] static inline bool IsPending(const std::shared_ptr<KeyGeneration::KeyRequest_ThS>& request) noexcept
+		{
+			return (request != nullptr && !request->WithUniqueLock()->Completed);
+		}
+
 		[[nodiscard]] inline bool GenerateAsymmetricKeys(std::shared_ptr<Crypto::AsymmetricKeyData>& keydata,
+														 std::shared_ptr<KeyGeneration::KeyRequest_ThS>& request,
 														 const Algorithm::Asymmetric aa,
 														 const Crypto::AsymmetricKeyOwner owner) noexcept
 		{
@@ -246,8 +288,28 @@ namespace QuantumGate::Implementation::Core::Peer
 				return true;
 			}
 
-			// First check if we have a pre-generated keypair available
-			auto keys = m_KeyManager.GetAsymmetricKeys(aa);
+			std::optional<Crypto::AsymmetricKeyData> keys;
+			auto requested = false;
+
+			// Check if the keypair was requested ahead of time; if the request
+			// didn't complete (yet) we don't wait for it and it gets dropped
+			if (request != nullptr)
+			{
+				request->WithUniqueLock([&](KeyGeneration::KeyRequest& key_request)
+				{
+					requested = (key_request.Algorithm == aa);
+					if (key_request.Completed) keys = std::move(key_request.KeyData);
+				});
+
+				request.reset();
+			}
+
+			// Otherwise check if we have a pre-generated keypair available
+			if (!keys || keys->GetAlgorithm() != aa)
+			{
+				keys = m_KeyManager.GetAsymmetricKeys(aa, requested);
+			}
+
 			if (keys)
 			{
 				*keydata = std::move(*keys);
@@ -258,7 +320,7 @@ namespace QuantumGate::Implementation::Core::Peer
 			// Generate an asymmetric keypair on the fly below (slower
 			// especially for certain algorithms, which introduces delays
 			// in the connection handshake which might result in timeouts)
-			if (Crypto::GenerateAsymmetricKeys(*keydata))
+			if (m_KeyManager.GenerateAsymmetricKeys(*keydata))
 			{
 				keydata->SetOwner(owner);
 				return true;
@@ -291,6 +353,9 @@ namespace QuantumGate::Implementation::Core::Peer
 		std::shared_ptr<Crypto::AsymmetricKeyData> m_PrimaryAsymmetricKeys;
 		std::shared_ptr<Crypto::AsymmetricKeyData> m_SecondaryAsymmetricKeys;
 
+		std::shared_ptr<KeyGeneration::KeyRequest_ThS> m_PrimaryKeyRequest;
+		std::shared_ptr<KeyGeneration::KeyRequest_ThS> m_SecondaryKeyRequest;
+
 		std::shared_ptr<SymmetricKeyPair> m_PrimarySymmetricKeyPair;
 		std::shared_ptr<SymmetricKeyPair> m_SecondarySymmetricKeyPair;
 	};
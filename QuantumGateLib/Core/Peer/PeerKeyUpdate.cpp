@@ -98,8 +98,11 @@ namespace QuantumGate::Implementation::Core::Peer
 
 	bool KeyUpdate::UpdateTimedOut(const SteadyTime current_steadytime) const noexcept
 	{
+		// The whole key update, including waiting for the
+		// peer to be ready, should finish within MaxDuration
 		if (GetStatus() == Status::PrimaryExchange ||
-			GetStatus() == Status::SecondaryExchange)
+			GetStatus() == Status::SecondaryExchange ||
+			GetStatus() == Status::ReadyWait)
 		{
 			if ((current_steadytime - m_UpdateSteadyTime) >
 				m_Peer.GetSettings().Local.KeyUpdate.MaxDuration)
@@ -147,6 +150,36 @@ namespace QuantumGate::Implementation::Core::Peer
 		return false;
 	}
 
+	std::optional<SteadyTime> KeyUpdate::GetNextEventSteadyTime() const noexcept
+	{
+		switch (GetStatus())
+		{
+			case Status::UpdateWait:
+			{
+				if (m_Peer.GetConnectionType() == PeerConnectionType::Inbound &&
+					m_Peer.GetStatus() == Core::Peer::Status::Ready)
+				{
+					// When the update interval gets changed because of a settings
+					// change this will be a bit early, which is harmless
+					return m_UpdateSteadyTime + m_UpdateInterval;
+				}
+				break;
+			}
+			case Status::PrimaryExchange:
+			case Status::SecondaryExchange:
+			case Status::ReadyWait:
+			{
+				return m_UpdateSteadyTime + m_Peer.GetSettings().Local.KeyUpdate.MaxDuration;
+			}
+			default:
+			{
+				break;
+			}
+		}
+
+		return std::nullopt;
+	}
+
 	bool KeyUpdate::BeginKeyUpdate() noexcept
 	{
 		// Should not already be updating
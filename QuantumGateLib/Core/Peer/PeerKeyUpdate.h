@@ -34,6 +34,8 @@ namespace QuantumGate::Implementation::Core::Peer
 			return ShouldUpdate(current_steadytime) || UpdateTimedOut(current_steadytime);
 		}
 
+		[[nodiscard]] std::optional<SteadyTime> GetNextEventSteadyTime() const noexcept;
+
 		[[nodiscard]] bool ProcessEvents(const SteadyTime current_steadytime) noexcept;
 		[[nodiscard]] MessageProcessor::Result ProcessKeyUpdateMessage(MessageDetails&& msg) noexcept;
 
@@ -129,6 +129,25 @@ namespace QuantumGate::Implementation::Core::Peer
 			return std::make_pair(nullptr, Buffer());
 		}
 
+		// Returns the number of the first key, starting at keynum, that's enabled for decryption and
+		// matches the key hint; if there's no such key the number of the autogen key is returned
+		UInt32 GetDecryptionKeyNum(UInt32 keynum, const UInt32 nonce_seed, const UInt32 key_hint) const noexcept
+		{
+			const auto numkeys = static_cast<UInt32>(m_SymmetricKeyPairs.size());
+
+			for (; keynum < numkeys; ++keynum)
+			{
+				if (m_SymmetricKeyPairs[keynum]->UseForDecryption &&
+					!m_SymmetricKeyPairs[keynum]->IsExpired() &&
+					Crypto::GetSymmetricKeyHint(*m_SymmetricKeyPairs[keynum]->DecryptionKey, nonce_seed) == key_hint)
+				{
+					break;
+				}
+			}
+
+			return keynum;
+		}
+
 		std::pair<std::shared_ptr<Crypto::SymmetricKeyData>, Buffer> GetDecryptionKeyAndNonce(const UInt32 keynum,
 																							  const UInt32 nonce_seed,
 																							  const PeerConnectionType pctype,
@@ -160,6 +179,29 @@ namespace QuantumGate::Implementation::Core::Peer
 			return std::make_pair(nullptr, Buffer());
 		}
 
+		// Calls the function with each key whose key hint matches the one given (normally just one)
+		// for as long as the function returns true; we'll start with the (first) latest key available
+		// and the autogen key is the last one we try. Returns false if we ran out of keys to try.
+		template<typename F>
+		[[nodiscard]] bool ForEachDecryptionKey(const UInt32 nonce_seed, const UInt32 key_hint,
+												const PeerConnectionType pctype, const bool autogenkey_allowed,
+												F&& function) const noexcept(std::is_nothrow_invocable_v<F, Crypto::SymmetricKeyData&, const Buffer&>)
+		{
+			auto keynum = GetDecryptionKeyNum(0, nonce_seed, key_hint);
+
+			while (true)
+			{
+				const auto& [symkey, nonce] = GetDecryptionKeyAndNonce(keynum, nonce_seed, pctype, autogenkey_allowed);
+				if (symkey == nullptr) return false;
+
+				if (!function(*symkey, nonce)) return true;
+
+				// The next time we'll try the next matching
+				// key we have until we run out
+				keynum = GetDecryptionKeyNum(keynum + 1, nonce_seed, key_hint);
+			}
+		}
+
 		[[nodiscard]] bool HasNumBytesProcessedExceededForLatestKeyPair(const Size max_num) const noexcept
 		{
 			return (GetNumBytesProcessedForLatestKeyPair(m_SymmetricKeyPairs) > max_num);
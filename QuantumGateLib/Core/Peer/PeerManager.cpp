@@ -18,13 +18,13 @@ namespace QuantumGate::Implementation::Core::Peer
 		switch (peer.GetGateType())
 		{
 			case GateType::TCPSocket:
-				return WorkEvents.AddEvent(peer.GetSocket<TCP::Socket>().GetEvent().GetHandle());
+				return WorkEvents.Add(peer.GetSocket<TCP::Socket>().GetEvent().GetHandle(), peer.GetLUID());
 			case GateType::UDPSocket:
-				return WorkEvents.AddEvent(peer.GetSocket<UDP::Socket>().GetReceiveEvent().GetHandle());
+				return WorkEvents.Add(peer.GetSocket<UDP::Socket>().GetReceiveEvent().GetHandle(), peer.GetLUID());
 			case GateType::BTHSocket:
-				return WorkEvents.AddEvent(peer.GetSocket<BTH::Socket>().GetEvent().GetHandle());
+				return WorkEvents.Add(peer.GetSocket<BTH::Socket>().GetEvent().GetHandle(), peer.GetLUID());
 			case GateType::RelaySocket:
-				return WorkEvents.AddEvent(peer.GetSocket<Relay::Socket>().GetReceiveEvent().GetHandle());
+				return WorkEvents.Add(peer.GetSocket<Relay::Socket>().GetReceiveEvent().GetHandle(), peer.GetLUID());
 			default:
 				// Shouldn't get here
 				assert(false);
@@ -39,16 +39,16 @@ namespace QuantumGate::Implementation::Core::Peer
 		switch (peer.GetGateType())
 		{
 			case GateType::TCPSocket:
-				WorkEvents.RemoveEvent(peer.GetSocket<TCP::Socket>().GetEvent().GetHandle());
+				WorkEvents.Remove(peer.GetSocket<TCP::Socket>().GetEvent().GetHandle());
 				break;
 			case GateType::UDPSocket:
-				WorkEvents.RemoveEvent(peer.GetSocket<UDP::Socket>().GetReceiveEvent().GetHandle());
+				WorkEvents.Remove(peer.GetSocket<UDP::Socket>().GetReceiveEvent().GetHandle());
 				break;
 			case GateType::BTHSocket:
-				WorkEvents.RemoveEvent(peer.GetSocket<BTH::Socket>().GetEvent().GetHandle());
+				WorkEvents.Remove(peer.GetSocket<BTH::Socket>().GetEvent().GetHandle());
 				break;
 			case GateType::RelaySocket:
-				WorkEvents.RemoveEvent(peer.GetSocket<Relay::Socket>().GetReceiveEvent().GetHandle());
+				WorkEvents.Remove(peer.GetSocket<Relay::Socket>().GetReceiveEvent().GetHandle());
 				break;
 			default:
 				// Shouldn't get here
@@ -155,7 +155,8 @@ namespace QuantumGate::Implementation::Core::Peer
 					{
 						if (!thpool->AddThread(L"QuantumGate Peers Thread (Main)",
 											   MakeCallback(this, &Manager::PrimaryThreadProcessor),
-											   MakeCallback(this, &Manager::PrimaryThreadWait)))
+											   MakeCallback(this, &Manager::PrimaryThreadWait),
+											   MakeCallback(this, &Manager::PrimaryThreadWaitInterrupt)))
 						{
 							error = true;
 						}
@@ -284,17 +285,101 @@ namespace QuantumGate::Implementation::Core::Peer
 
 	void Manager::PrimaryThreadWait(ThreadPoolData& thpdata, const Concurrency::Event& shutdown_event)
 	{
-		const auto result = thpdata.WaitForWorkEvent(1ms);
+		// If there are peers with work left over we only wait briefly; otherwise
+		// we can wait until the earliest peer deadline or the next full scan and rely
+		// on the work events to wake us up when peers have something to do
+		auto wait_time = std::chrono::milliseconds(1);
+
+		if (thpdata.PolledPeers.empty() && !thpdata.NeedsFullScan)
+		{
+			const auto current_steadytime = Util::GetCurrentSteadyTime();
+
+			auto wakeup_steadytime = thpdata.LastFullScanSteadyTime + FullScanInterval;
+
+			if (const auto next_expiry = thpdata.PeerTimers.GetNextExpiry(); next_expiry.has_value())
+			{
+				wakeup_steadytime = std::min(wakeup_steadytime, *next_expiry);
+			}
+
+			if (wakeup_steadytime > current_steadytime)
+			{
+				wait_time = std::max(std::chrono::milliseconds(1),
+									 std::chrono::ceil<std::chrono::milliseconds>(wakeup_steadytime - current_steadytime));
+			}
+		}
+
+		const auto result = thpdata.WaitForWorkEvent(wait_time);
 		if (!result.Waited)
 		{
 			shutdown_event.Wait(1ms);
 		}
+		else if (result.Overflow)
+		{
+			// Readiness information was lost
+			thpdata.NeedsFullScan = true;
+		}
+	}
+
+	void Manager::PrimaryThreadWaitInterrupt(ThreadPoolData& thpdata)
+	{
+		thpdata.InterruptWorkEventWait();
 	}
 
 	void Manager::PrimaryThreadProcessor(ThreadPoolData& thpdata, const Concurrency::Event& shutdown_event)
 	{
 		std::optional<Containers::List<PeerSharedPointer>> remove_list;
 
+		const auto wakeup_steadytime = Util::GetCurrentSteadyTime();
+
+		auto full_scan = thpdata.NeedsFullScan ||
+			((wakeup_steadytime - thpdata.LastFullScanSteadyTime) >= FullScanInterval);
+
+		// Peers whose deadline has passed
+		thpdata.VisitPeers.clear();
+		if (!thpdata.PeerTimers.Expire(wakeup_steadytime, thpdata.VisitPeers))
+		{
+			// Couldn't collect all expired timers
+			full_scan = true;
+		}
+
+		thpdata.SchedulerStats.NumTimersExpired += thpdata.VisitPeers.size();
+
+		if (!full_scan)
+		{
+			// Besides the peers with expired timers only peers whose work
+			// event got signaled and the ones with work left over get visited
+			try
+			{
+				const auto& ready_peers = thpdata.GetReadyPeers();
+
+				thpdata.VisitPeers.insert(thpdata.VisitPeers.end(), ready_peers.begin(), ready_peers.end());
+				thpdata.VisitPeers.insert(thpdata.VisitPeers.end(), thpdata.PolledPeers.begin(), thpdata.PolledPeers.end());
+			}
+			catch (...)
+			{
+				full_scan = true;
+			}
+
+			if (!full_scan)
+			{
+				if (thpdata.VisitPeers.empty())
+				{
+					++thpdata.SchedulerStats.NumWakeups;
+					thpdata.SchedulerStats.LastNumPeersVisited = 0;
+					return;
+				}
+
+				// Peers may be in more than one of the above
+				std::sort(thpdata.VisitPeers.begin(), thpdata.VisitPeers.end());
+				thpdata.VisitPeers.erase(std::unique(thpdata.VisitPeers.begin(), thpdata.VisitPeers.end()),
+										 thpdata.VisitPeers.end());
+			}
+		}
+
+		thpdata.PolledPeers.clear();
+
+		UInt64 num_visited{ 0 };
+
 		thpdata.PeerMap.WithSharedLock([&](const PeerMap& peers)
 		{
 			if (peers.empty()) return;
@@ -304,12 +389,12 @@ namespace QuantumGate::Implementation::Core::Peer
 			const auto max_handshake_duration = settings.Local.MaxHandshakeDuration;
 			const auto max_connect_duration = settings.Local.ConnectTimeout;
 
-			for (auto it = peers.begin(); it != peers.end() && !shutdown_event.IsSet(); ++it)
+			const auto process_peer = [&](const PeerSharedPointer& peerths)
 			{
 				// Placed in the loop to have the latest time for each peer
 				const auto current_steadytime = Util::GetCurrentSteadyTime();
 
-				auto& peerths = it->second;
+				++num_visited;
 
 				peerths->WithUniqueLock([&](Peer& peer)
 				{
@@ -326,15 +411,65 @@ namespace QuantumGate::Implementation::Core::Peer
 					{
 						Disconnect(peer, false);
 
+						thpdata.PeerTimers.Cancel(peer.GetLUID());
+
 						// Collect the peer for removal
 						if (!remove_list.has_value()) remove_list.emplace();
 
 						remove_list->emplace_back(peerths);
 					}
+					else
+					{
+						if (peer.HasDeferredWork(noise_enabled))
+						{
+							thpdata.PolledPeers.emplace_back(peer.GetLUID());
+						}
+
+						if (const auto deadline = peer.GetNextDeadline(noise_enabled, max_connect_duration,
+																	   max_handshake_duration); deadline.has_value())
+						{
+							// Most deadline checks are exclusive so we schedule one tick later
+							if (!thpdata.PeerTimers.Schedule(peer.GetLUID(), *deadline + 1ms))
+							{
+								thpdata.NeedsFullScan = true;
+							}
+						}
+						else thpdata.PeerTimers.Cancel(peer.GetLUID());
+					}
 				});
+			};
+
+			if (full_scan)
+			{
+				for (auto it = peers.begin(); it != peers.end() && !shutdown_event.IsSet(); ++it)
+				{
+					process_peer(it->second);
+				}
+			}
+			else
+			{
+				for (auto it = thpdata.VisitPeers.begin(); it != thpdata.VisitPeers.end() && !shutdown_event.IsSet(); ++it)
+				{
+					// Peer may have been removed in the mean time
+					if (const auto pit = peers.find(*it); pit != peers.end())
+					{
+						process_peer(pit->second);
+					}
+				}
 			}
 		});
 
+		if (full_scan)
+		{
+			thpdata.NeedsFullScan = false;
+			thpdata.LastFullScanSteadyTime = Util::GetCurrentSteadyTime();
+			++thpdata.SchedulerStats.NumFullScans;
+		}
+
+		++thpdata.SchedulerStats.NumWakeups;
+		thpdata.SchedulerStats.NumPeersVisited += num_visited;
+		thpdata.SchedulerStats.LastNumPeersVisited = num_visited;
+
 		// Remove all peers that were collected for removal
 		if (remove_list.has_value() && !remove_list->empty())
 		{
@@ -360,10 +495,9 @@ namespace QuantumGate::Implementation::Core::Peer
 		// Execute any scheduled tasks
 		std::optional<ThreadPoolTask> task;
 		
-		thpdata.TaskQueue.PopFrontIf([&](auto& ftask) noexcept -> bool
+		thpdata.TaskQueue.PopFront([&](auto& ftask) noexcept
 		{
 			task = std::move(ftask);
-			return true;
 		});
 
 		if (task.has_value())
@@ -377,7 +511,12 @@ namespace QuantumGate::Implementation::Core::Peer
 						{
 							it->second->WithUniqueLock([&](Peer& peer) noexcept
 							{
-								peer.SetNeedsAccessCheck();
+								// Peers that the update can't affect don't need to be checked again
+								if (ptask.Update.CanAffect(peer.GetPeerEndpoint()))
+								{
+									peer.SetNeedsAccessCheck();
+									peer.SignalWorkEvent();
+								}
 							});
 						}
 					});
@@ -641,6 +780,9 @@ namespace QuantumGate::Implementation::Core::Peer
 			sg.Deactivate();
 			sg2.Deactivate();
 
+			// Make sure the new peer gets processed
+			peer.SignalWorkEvent();
+
 			success = true;
 		});
 
@@ -678,6 +820,7 @@ namespace QuantumGate::Implementation::Core::Peer
 		for (const auto& thpool : m_ThreadPools)
 		{
 			thpool.second->GetData().ClearWorkEvents();
+			thpool.second->GetData().PeerTimers.Clear();
 			thpool.second->GetData().PeerMap.WithUniqueLock()->clear();
 		}
 	}
@@ -711,6 +854,7 @@ namespace QuantumGate::Implementation::Core::Peer
 				// Set the disconnect condition so that the peer
 				// gets disconnected as soon as possible
 				peer.SetDisconnectCondition(DisconnectCondition::DisconnectRequest);
+				peer.SignalWorkEvent();
 
 				result_code = ResultCode::Succeeded;
 			}
@@ -856,6 +1000,7 @@ namespace QuantumGate::Implementation::Core::Peer
 
 				// Set the disconnect condition so that the peer gets disconnected as soon as possible
 				peer->SetDisconnectCondition(DisconnectCondition::ConnectError);
+				peer->SignalWorkEvent();
 				return ResultCode::FailedRetry;
 			}
 		}
@@ -1190,6 +1335,77 @@ namespace QuantumGate::Implementation::Core::Peer
 		return m_LocalEnvironment.WithSharedLock()->GetTrustedAndVerifiedAddresses();
 	}
 
+	Manager::Statistics Manager::GetStatistics() const noexcept
+	{
+		Statistics stats;
+
+		for (const auto& thpool : m_ThreadPools)
+		{
+			const auto& thpstats = thpool.second->GetData().SchedulerStats;
+
+			stats.NumWakeups += thpstats.NumWakeups;
+			stats.NumFullScans += thpstats.NumFullScans;
+			stats.NumTimersExpired += thpstats.NumTimersExpired;
+			stats.NumPeersVisited += thpstats.NumPeersVisited;
+			stats.LastNumPeersVisited += thpstats.LastNumPeersVisited;
+		}
+
+		for (const auto& count : m_HandshakeStats.Buckets)
+		{
+			stats.NumHandshakes += count;
+		}
+
+		stats.HandshakeDurationP50 = m_HandshakeStats.GetPercentile(0.50);
+		stats.HandshakeDurationP90 = m_HandshakeStats.GetPercentile(0.90);
+		stats.HandshakeDurationP99 = m_HandshakeStats.GetPercentile(0.99);
+
+		return stats;
+	}
+
+	void Manager::HandshakeStatistics::Record(const std::chrono::nanoseconds duration) noexcept
+	{
+		const auto ms = std::chrono::duration<double, std::milli>(duration).count();
+
+		Size bucket{ 0 };
+		if (ms > 1.0)
+		{
+			bucket = std::min(static_cast<Size>(std::ceil(4.0 * std::log2(ms))), NumBuckets - 1);
+		}
+
+		++Buckets[bucket];
+	}
+
+	std::chrono::milliseconds Manager::HandshakeStatistics::GetPercentile(const double percentile) const noexcept
+	{
+		std::array<UInt64, NumBuckets> counts{ 0 };
+		UInt64 total{ 0 };
+
+		for (Size x = 0; x < NumBuckets; ++x)
+		{
+			counts[x] = Buckets[x];
+			total += counts[x];
+		}
+
+		if (total == 0) return std::chrono::milliseconds{ 0 };
+
+		const auto rank = std::max(static_cast<UInt64>(std::ceil(percentile * static_cast<double>(total))), UInt64{ 1 });
+
+		// Returns the upper bound of the bucket the
+		// sample with the requested rank is in
+		UInt64 num{ 0 };
+		for (Size x = 0; x < NumBuckets; ++x)
+		{
+			num += counts[x];
+			if (num >= rank)
+			{
+				return std::chrono::milliseconds{ static_cast<std::chrono::milliseconds::rep>(
+					std::round(std::exp2(static_cast<double>(x) / 4.0))) };
+			}
+		}
+
+		return std::chrono::milliseconds{ 0 };
+	}
+
 	Result<> Manager::SendTo(const ExtenderUUID& extuuid, const std::atomic_bool& running, const std::atomic_bool& ready,
 							 const PeerLUID pluid, Buffer&& buffer, const SendParameters& params, SendCallback&& callback) noexcept
 	{
@@ -1356,10 +1572,13 @@ namespace QuantumGate::Implementation::Core::Peer
 		return false;
 	}
 
-	void Manager::OnAccessUpdate() noexcept
+	void Manager::OnAccessUpdate(const Access::AccessUpdate& update) noexcept
 	{
 		assert(m_Running);
 
+		// Nothing to do when no peer can lose access
+		if (update.GetScope() == Access::AccessUpdate::Scope::None) return;
+
 		// This function should not update peers directly since
 		// it can get called by all kinds of outside threads and
 		// could cause deadlocks. A task is scheduled for the threadpools
@@ -1367,7 +1586,7 @@ namespace QuantumGate::Implementation::Core::Peer
 
 		for (const auto& thpool : m_ThreadPools)
 		{
-			thpool.second->GetData().TaskQueue.Push(Tasks::PeerAccessCheck{});
+			thpool.second->GetData().TaskQueue.Push(Tasks::PeerAccessCheck{ update });
 		}
 	}
 
@@ -6,9 +6,10 @@
 #include "..\..\API\Peer.h"
 #include "..\LocalEnvironment.h"
 #include "..\..\Settings.h"
-#include "..\..\Concurrency\Queue.h"
+#include "..\..\Concurrency\MPMCQueue.h"
 #include "..\..\Concurrency\ThreadPool.h"
-#include "..\..\Concurrency\EventGroup.h"
+#include "..\..\Concurrency\Reactor.h"
+#include "..\..\Concurrency\TimerWheel.h"
 #include "..\KeyGeneration\KeyGenerationManager.h"
 #include "..\Relay\RelayManager.h"
 #include "..\UDP\UDPConnectionManager.h"
@@ -26,15 +27,37 @@ namespace QuantumGate::Implementation::Core::Peer
 
 		struct Tasks final
 		{
-			struct PeerAccessCheck final {};
+			struct PeerAccessCheck final { Access::AccessUpdate Update; };
 			struct PeerCallback final { Callback<void()> Callback; };
 		};
 
 		using ThreadPoolTask = std::variant<Tasks::PeerAccessCheck, Tasks::PeerCallback>;
-		using ThreadPoolTaskQueue_ThS = Concurrency::Queue<ThreadPoolTask>;
+		using ThreadPoolTaskQueue_ThS = Concurrency::MPMCQueue<ThreadPoolTask>;
 		
 		enum class BroadcastResult { Succeeded, PeerNotReady, SendFailure };
 
+		struct SchedulerStatistics final
+		{
+			std::atomic<UInt64> NumWakeups{ 0 };
+			std::atomic<UInt64> NumFullScans{ 0 };
+			std::atomic<UInt64> NumTimersExpired{ 0 };
+			std::atomic<UInt64> NumPeersVisited{ 0 };
+			std::atomic<UInt64> LastNumPeersVisited{ 0 };
+		};
+
+		// Durations of completed handshakes counted in buckets that grow exponentially
+		// (four per doubling, so about 19% apart) starting at 1ms, for getting
+		// percentiles without having to keep all the samples around
+		struct HandshakeStatistics final
+		{
+			static constexpr Size NumBuckets{ 80 };
+
+			void Record(const std::chrono::nanoseconds duration) noexcept;
+			[[nodiscard]] std::chrono::milliseconds GetPercentile(const double percentile) const noexcept;
+
+			std::array<std::atomic<UInt64>, NumBuckets> Buckets{};
+		};
+
 		using BroadcastCallback = Callback<void(Peer& peer, const BroadcastResult result)>;
 
 		struct ThreadPoolData final
@@ -43,14 +66,28 @@ namespace QuantumGate::Implementation::Core::Peer
 			PeerMap_ThS PeerMap;
 			ThreadPoolTaskQueue_ThS TaskQueue;
 
+			// Only accessed by the primary thread; PolledPeers are peers with work left
+			// over that need to be looked at again on the next wakeup, and PeerTimers
+			// has the next deadline (timeouts, delayed messages, noise etc.) for peers
+			Vector<PeerLUID> PolledPeers;
+			Vector<PeerLUID> VisitPeers;
+			Concurrency::TimerWheel<PeerLUID> PeerTimers;
+			SteadyTime LastFullScanSteadyTime;
+			bool NeedsFullScan{ true };
+
+			SchedulerStatistics SchedulerStats;
+
 		private:
-			Concurrency::EventGroup WorkEvents;
+			Concurrency::Reactor WorkEvents;
+			Concurrency::Reactor::ReadyKeys ReadyPeers;
 
 		public:
 			[[nodiscard]] inline bool InitializeWorkEvents() noexcept { return WorkEvents.Initialize(); }
 			inline void DeinitializeWorkEvents() noexcept { WorkEvents.Deinitialize(); }
-			inline void ClearWorkEvents() noexcept { WorkEvents.RemoveAllEvents(); }
-			inline auto WaitForWorkEvent(const std::chrono::milliseconds time) noexcept { return WorkEvents.Wait(time); }
+			inline void ClearWorkEvents() noexcept { WorkEvents.RemoveAll(); }
+			inline auto WaitForWorkEvent(const std::chrono::milliseconds time) noexcept { return WorkEvents.Wait(time, ReadyPeers); }
+			inline void InterruptWorkEventWait() noexcept { WorkEvents.Interrupt(); }
+			[[nodiscard]] inline const Concurrency::Reactor::ReadyKeys& GetReadyPeers() const noexcept { return ReadyPeers; }
 			[[nodiscard]] bool AddWorkEvent(const Peer& peer) noexcept;
 			void RemoveWorkEvent(const Peer& peer) noexcept;
 		};
@@ -58,7 +95,25 @@ namespace QuantumGate::Implementation::Core::Peer
 		using ThreadPool = Concurrency::ThreadPool<ThreadPoolData>;
 		using ThreadPoolMap = Containers::UnorderedMap<UInt64, std::unique_ptr<ThreadPool>>;
 
+		// Interval at which all peers in a threadpool get looked at regardless
+		// of whether their work event got signaled or a timer expired, as a safety net
+		static constexpr std::chrono::seconds FullScanInterval{ 5 };
+
 	public:
+		struct Statistics final
+		{
+			UInt64 NumWakeups{ 0 };
+			UInt64 NumFullScans{ 0 };
+			UInt64 NumTimersExpired{ 0 };
+			UInt64 NumPeersVisited{ 0 };
+			UInt64 LastNumPeersVisited{ 0 };
+
+			UInt64 NumHandshakes{ 0 };
+			std::chrono::milliseconds HandshakeDurationP50{ 0 };
+			std::chrono::milliseconds HandshakeDurationP90{ 0 };
+			std::chrono::milliseconds HandshakeDurationP99{ 0 };
+		};
+
 		Manager() = delete;
 		Manager(const Settings_CThS& settings, LocalEnvironment_ThS& environment, UDP::Connection::Manager& udpmgr,
 				KeyGeneration::Manager& keymgr, Access::Manager& accessmgr,
@@ -115,6 +170,8 @@ namespace QuantumGate::Implementation::Core::Peer
 
 		const Vector<Address>* GetLocalAddresses() const noexcept;
 
+		Statistics GetStatistics() const noexcept;
+
 	private:
 		void PreStartupThreadPools() noexcept;
 		void ResetState() noexcept;
@@ -166,18 +223,21 @@ namespace QuantumGate::Implementation::Core::Peer
 
 		bool BroadcastExtenderUpdate();
 
-		void OnAccessUpdate() noexcept;
+		void OnAccessUpdate(const Access::AccessUpdate& update) noexcept;
 		void OnLocalExtenderUpdate(const Vector<ExtenderUUID>& extuuids, const bool added);
 		void OnPeerEvent(const Peer& peer, const Event&& event) noexcept;
 
 		void SchedulePeerCallback(const UInt64 threadpool_key, Callback<void()>&& callback) noexcept;
 
+		inline void RecordHandshakeDuration(const std::chrono::nanoseconds duration) noexcept { m_HandshakeStats.Record(duration); }
+
 		void AddReportedPublicEndpoint(const Endpoint& pub_endpoint, const Endpoint& rep_peer,
 									   const PeerConnectionType rep_con_type, const bool trusted) noexcept;
 
 		Result<Buffer> GetExtenderUpdateData() const noexcept;
 
 		void PrimaryThreadWait(ThreadPoolData& thpdata, const Concurrency::Event& shutdown_event);
+		void PrimaryThreadWaitInterrupt(ThreadPoolData& thpdata);
 		void PrimaryThreadProcessor(ThreadPoolData& thpdata, const Concurrency::Event& shutdown_event);
 
 		void WorkerThreadWait(ThreadPoolData& thpdata, const Concurrency::Event& shutdown_event);
@@ -197,6 +257,8 @@ namespace QuantumGate::Implementation::Core::Peer
 		PeerMap_ThS m_AllPeers;
 		ThreadPoolMap m_ThreadPools;
 
+		HandshakeStatistics m_HandshakeStats;
+
 		Relay::Manager m_RelayManager{ *this };
 
 		Access::Manager::AccessUpdateCallbackHandle m_AccessUpdateCallbackHandle;
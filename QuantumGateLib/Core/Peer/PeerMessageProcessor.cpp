@@ -173,6 +173,10 @@ namespace QuantumGate::Implementation::Core::Peer
 
 					if (m_Peer.SetAlgorithms(ha, paa, saa, sa, ca))
 					{
+						// Get the asymmetric keys for the key exchanges
+						// ready while the peer prepares its own
+						m_Peer.RequestHandshakeAsymmetricKeys();
+
 						BufferWriter wrt(true);
 						if (wrt.WriteWithPreallocation(m_Peer.GetLocalProtocolVersion().first,
 													   m_Peer.GetLocalProtocolVersion().second, ha, paa, saa, sa, ca))
@@ -221,7 +225,17 @@ namespace QuantumGate::Implementation::Core::Peer
 
 					if (m_Peer.SetAlgorithms(ha, paa, saa, sa, ca))
 					{
-						if (SendBeginPrimaryKeyExchange())
+						m_Peer.RequestHandshakeAsymmetricKeys();
+
+						if (m_Peer.GetKeyExchange().HasPendingPrimaryAsymmetricKeys())
+						{
+							// The primary asymmetric keys are still being generated; the
+							// BeginPrimaryKeyExchange message gets sent once they're ready
+							m_Peer.SetPrimaryKeyExchangePending();
+
+							result.Success = m_Peer.SetStatus(Status::PrimaryKeyExchange);
+						}
+						else if (SendBeginPrimaryKeyExchange())
 						{
 							result.Success = m_Peer.SetStatus(Status::PrimaryKeyExchange);
 						}
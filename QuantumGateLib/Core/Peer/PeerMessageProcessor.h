@@ -32,6 +32,7 @@ namespace QuantumGate::Implementation::Core::Peer
 		MessageProcessor& operator=(MessageProcessor&&) noexcept = default;
 
 		[[nodiscard]] bool SendBeginHandshake() const noexcept;
+		[[nodiscard]] bool SendBeginPrimaryKeyExchange() const noexcept;
 
 		[[nodiscard]] bool SendBeginRelay(const RelayPort rport, const Endpoint& endpoint, const RelayHop hops) const noexcept;
 		QuantumGate::Result<> SendRelayStatus(const RelayPort rport, const RelayStatusUpdate status) const noexcept;
@@ -41,7 +42,6 @@ namespace QuantumGate::Implementation::Core::Peer
 		[[nodiscard]] Result ProcessMessage(MessageDetails&& msg) const noexcept;
 
 	private:
-		[[nodiscard]] bool SendBeginPrimaryKeyExchange() const noexcept;
 		[[nodiscard]] bool SendBeginKeyExchange(const MessageType type) const noexcept;
 		[[nodiscard]] bool SendBeginPrimaryKeyUpdateExchange() const noexcept;
 
@@ -29,6 +29,17 @@ namespace QuantumGate::Implementation::Core::Peer
 
 		[[nodiscard]] inline bool IsEmpty() const noexcept { return m_NoiseQueue.empty(); }
 
+		[[nodiscard]] inline std::optional<SteadyTime> GetNextNoiseSteadyTime() const noexcept
+		{
+			if (!m_NoiseQueue.empty() && !m_SuspendSteadyTime.has_value())
+			{
+				const auto& noiseitm = m_NoiseQueue.top();
+				return noiseitm.ScheduleSteadyTime + noiseitm.ScheduleMilliseconds;
+			}
+
+			return std::nullopt;
+		}
+
 		void Suspend() noexcept;
 		[[nodiscard]] bool Resume() noexcept;
 
@@ -28,14 +28,18 @@ namespace QuantumGate::Implementation::Core::Peer
 
 		// Messages have to be processed in the order in which they are received, so
 		// if the queues aren't empty then the messages need to go to the back
-		// of the queue even if there's room in the receive rate limit
-		return (HaveMessages() || !canadd);
+		// of the queue even if there's room in the receive rate limit. Handshake
+		// messages also have to wait for the asymmetric keys they need in case
+		// those are still being generated.
+		return (HaveMessages() || !canadd || m_Peer.IsWaitingForAsymmetricKeys(msg.GetMessageType()));
 	}
 
 	bool PeerReceiveQueues::CanProcessNextDeferredMessage() const noexcept
 	{
 		assert(!m_DeferredQueue.empty());
 
+		if (IsWaitingForAsymmetricKeys()) return false;
+
 		switch (m_DeferredQueue.front().GetMessageType())
 		{
 			case MessageType::ExtenderCommunication:
@@ -52,6 +56,11 @@ namespace QuantumGate::Implementation::Core::Peer
 		return false;
 	}
 
+	bool PeerReceiveQueues::IsWaitingForAsymmetricKeys() const noexcept
+	{
+		return (HaveMessages() && m_Peer.IsWaitingForAsymmetricKeys(m_DeferredQueue.front().GetMessageType()));
+	}
+
 	void PeerReceiveQueues::AddMessageRate(const MessageType type, const Size msg_size) noexcept
 	{
 		switch (type)
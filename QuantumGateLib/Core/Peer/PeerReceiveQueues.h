@@ -27,6 +27,8 @@ namespace QuantumGate::Implementation::Core::Peer
 
 		[[nodiscard]] bool CanProcessNextDeferredMessage() const noexcept;
 
+		[[nodiscard]] bool IsWaitingForAsymmetricKeys() const noexcept;
+
 		[[nodiscard]] inline bool HaveMessages() const noexcept
 		{
 			return !m_DeferredQueue.empty();
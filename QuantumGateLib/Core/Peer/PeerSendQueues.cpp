@@ -45,7 +45,8 @@ namespace QuantumGate::Implementation::Core::Peer
 					m_ExpeditedQueue.push(DefaultMessage{ std::move(msg), std::move(callback) });
 					break;
 				case SendParameters::PriorityOption::Delayed:
-					m_DelayedQueue.push(DelayedMessage{ std::move(msg), Util::GetCurrentSteadyTime(), delay, std::move(callback) });
+					m_DelayedQueue.push(DelayedMessage{ std::move(msg), Util::GetCurrentSteadyTime() + delay,
+														m_DelayedMessageNumber++, std::move(callback) });
 					break;
 				default:
 					// Shouldn't get here
@@ -69,12 +70,22 @@ namespace QuantumGate::Implementation::Core::Peer
 	{
 		auto result = std::invoke([&]()
 		{
-			if constexpr (std::is_same_v<T, MessageQueue> || std::is_same_v<T, DelayedMessageQueue>)
+			if constexpr (std::is_same_v<T, MessageQueue>)
 			{
 				return std::make_tuple(queue.front().Message.GetMessageType(),
 									   queue.front().Message.GetMessageData().GetSize(),
 									   std::move(queue.front().SendCallback));
 			}
+			else if constexpr (std::is_same_v<T, DelayedMessageQueue>)
+			{
+				// The message gets removed right after so it's
+				// safe to move the callback out of the queue
+				auto& dmsg = const_cast<DelayedMessage&>(queue.top());
+
+				return std::make_tuple(dmsg.Message.GetMessageType(),
+									   dmsg.Message.GetMessageData().GetSize(),
+									   std::move(dmsg.SendCallback));
+			}
 			else
 			{
 				static_assert(AlwaysFalse<T>, "Unsupported type.");
@@ -167,10 +178,13 @@ namespace QuantumGate::Implementation::Core::Peer
 
 		if (success && !stop)
 		{
+			const auto now = Util::GetCurrentSteadyTime();
+
 			while (!m_DelayedQueue.empty())
 			{
-				auto& dmsg = m_DelayedQueue.front();
-				if (dmsg.IsTime())
+				// Writing the message doesn't change its place in the queue
+				auto& dmsg = const_cast<DelayedMessage&>(m_DelayedQueue.top());
+				if (dmsg.IsTime(now))
 				{
 					if (dmsg.Message.Write(tempbuf, symkey))
 					{
@@ -209,8 +223,8 @@ namespace QuantumGate::Implementation::Core::Peer
 				}
 				else
 				{
-					// It's not time yet to send delayed message;
-					// we'll come back later
+					// It's not time yet to send the first due delayed
+					// message (or any after it); we'll come back later
 					break;
 				}
 			}
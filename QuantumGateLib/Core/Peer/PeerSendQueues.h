@@ -21,20 +21,28 @@ namespace QuantumGate::Implementation::Core::Peer
 		struct DelayedMessage final
 		{
 			Message Message;
-			SteadyTime ScheduleSteadyTime;
-			std::chrono::milliseconds Delay{ 0 };
+			SteadyTime DueSteadyTime;
+			UInt64 Number{ 0 };
 			SendCallback SendCallback{ nullptr };
 
-			[[nodiscard]] inline bool IsTime() const noexcept
+			[[nodiscard]] inline bool IsTime(const SteadyTime now) const noexcept
 			{
-				if ((Util::GetCurrentSteadyTime() - ScheduleSteadyTime) >= Delay) return true;
+				return (now >= DueSteadyTime);
+			}
+
+			// Earliest due time first; messages that are due at
+			// the same time stay in the order they were added
+			inline static bool Compare(const DelayedMessage& msg1, const DelayedMessage& msg2) noexcept
+			{
+				if (msg1.DueSteadyTime == msg2.DueSteadyTime) return (msg1.Number > msg2.Number);
 
-				return false;
+				return (msg1.DueSteadyTime > msg2.DueSteadyTime);
 			}
 		};
 
 		using MessageQueue = Containers::Queue<DefaultMessage>;
-		using DelayedMessageQueue = Containers::Queue<DelayedMessage>;
+		using DelayedMessageQueue = Containers::PriorityQueue<DelayedMessage, Vector<DelayedMessage>,
+															  decltype(&DelayedMessage::Compare)>;
 
 	public:
 		PeerSendQueues(Peer& peer) noexcept : m_Peer(peer) {}
@@ -47,7 +55,19 @@ namespace QuantumGate::Implementation::Core::Peer
 		[[nodiscard]] inline bool HaveMessages() const noexcept
 		{
 			return (!m_NormalQueue.empty() || !m_ExpeditedQueue.empty() ||
-				(!m_DelayedQueue.empty() && m_DelayedQueue.front().IsTime()));
+				(!m_DelayedQueue.empty() && m_DelayedQueue.top().IsTime(Util::GetCurrentSteadyTime())));
+		}
+
+		// Delayed messages that aren't due yet don't count as work for the peer; instead
+		// the peer gets scheduled again at this time, when the first of them is due
+		[[nodiscard]] inline std::optional<SteadyTime> GetNextDelayedMessageSteadyTime() const noexcept
+		{
+			if (!m_DelayedQueue.empty())
+			{
+				return m_DelayedQueue.top().DueSteadyTime;
+			}
+
+			return std::nullopt;
 		}
 
 		Result<> AddMessage(Message&& msg, const SendParameters::PriorityOption priority,
@@ -75,6 +95,7 @@ namespace QuantumGate::Implementation::Core::Peer
 		Peer& m_Peer;
 		MessageQueue m_NormalQueue;
 		MessageQueue m_ExpeditedQueue;
-		DelayedMessageQueue m_DelayedQueue;
+		DelayedMessageQueue m_DelayedQueue{ &DelayedMessage::Compare };
+		UInt64 m_DelayedMessageNumber{ 0 };
 	};
 }
\ No newline at end of file
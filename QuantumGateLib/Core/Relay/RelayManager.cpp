@@ -85,6 +85,10 @@ namespace QuantumGate::Implementation::Core::Relay
 		m_ThreadPool.GetData().ThreadKeyToLinkTotals.WithUniqueLock()->clear();
 
 		m_RelayLinks.WithUniqueLock()->clear();
+
+		m_ThreadPool.GetData().ClosedLinkTimers.Clear();
+		m_ThreadPool.GetData().ExpiredLinks.clear();
+		m_ThreadPool.GetData().HasOpenLinks = false;
 	}
 
 	bool Manager::StartupThreadPool() noexcept
@@ -111,7 +115,8 @@ namespace QuantumGate::Implementation::Core::Relay
 			{
 				if (!m_ThreadPool.AddThread(L"QuantumGate Relay Thread (Main)", ThreadData(x, nullptr),
 											MakeCallback(this, &Manager::PrimaryThreadProcessor),
-											MakeCallback(this, &Manager::PrimaryThreadWait)))
+											MakeCallback(this, &Manager::PrimaryThreadWait),
+											MakeCallback(this, &Manager::PrimaryThreadWaitInterrupt)))
 				{
 					error = true;
 				}
@@ -455,6 +460,10 @@ namespace QuantumGate::Implementation::Core::Relay
 		}
 		catch (...) {}
 
+		// Wake up the primary thread which may be
+		// idle if there were no open relay links
+		if (success) m_ThreadPool.GetData().WorkEvents.Notify(rport);
+
 		return success;
 	}
 
@@ -611,17 +620,50 @@ namespace QuantumGate::Implementation::Core::Relay
 
 	void Manager::PrimaryThreadWait(ThreadPoolData& thpdata, ThreadData& thdata, const Concurrency::Event& shutdown_event)
 	{
-		const auto result = thpdata.WorkEvents.Wait(1ms);
+		// Open relay links get looked at continuously since their state depends
+		// on that of the peers they're relaying for; without any we can wait until
+		// a closed link is due for removal, or until a new link gets added
+		auto wait_time = std::chrono::milliseconds(1);
+
+		if (!thpdata.HasOpenLinks)
+		{
+			const auto current_steadytime = Util::GetCurrentSteadyTime();
+
+			auto wakeup_steadytime = current_steadytime + MaxIdleWaitTime;
+
+			if (const auto next_expiry = thpdata.ClosedLinkTimers.GetNextExpiry(); next_expiry.has_value())
+			{
+				wakeup_steadytime = std::min(wakeup_steadytime, *next_expiry);
+			}
+
+			if (wakeup_steadytime > current_steadytime)
+			{
+				wait_time = std::max(std::chrono::milliseconds(1),
+									 std::chrono::ceil<std::chrono::milliseconds>(wakeup_steadytime - current_steadytime));
+			}
+		}
+
+		const auto result = thpdata.WorkEvents.Wait(wait_time, thpdata.ReadyRelayPorts);
 		if (!result.Waited)
 		{
 			shutdown_event.Wait(1ms);
 		}
 	}
 
+	void Manager::PrimaryThreadWaitInterrupt(ThreadPoolData& thpdata, ThreadData& thdata)
+	{
+		thpdata.WorkEvents.Interrupt();
+	}
+
 	void Manager::PrimaryThreadProcessor(ThreadPoolData& thpdata, ThreadData& thdata, const Concurrency::Event& shutdown_event)
 	{
 		std::optional<Containers::List<RelayPort>> remove_list;
 
+		// Closed links whose grace period has passed get removed below;
+		// if not all expired timers could be collected we keep polling
+		thpdata.ExpiredLinks.clear();
+		auto has_open_links = !thpdata.ClosedLinkTimers.Expire(Util::GetCurrentSteadyTime(), thpdata.ExpiredLinks);
+
 		m_RelayLinks.WithSharedLock([&](const LinkMap& relays)
 		{
 			if (relays.empty()) return;
@@ -633,12 +675,14 @@ namespace QuantumGate::Implementation::Core::Relay
 
 			for (auto it = relays.begin(); it != relays.end() && !shutdown_event.IsSet(); ++it)
 			{
-				it->second->IfUniqueLock([&](Link& rl)
+				const auto locked = it->second->IfUniqueLock([&](Link& rl)
 				{
 					const auto current_steadytime = Util::GetCurrentSteadyTime();
 
 					if (rl.GetStatus() != Status::Closed)
 					{
+						has_open_links = true;
+
 						Peer::Peer_ThS::UniqueLockedType in_peer;
 						Peer::Peer_ThS::UniqueLockedType out_peer;
 
@@ -735,18 +779,39 @@ namespace QuantumGate::Implementation::Core::Relay
 							ProcessRelayDisconnect(rl, in_peer, out_peer);
 						}
 					}
-					else if (rl.GetStatus() == Status::Closed &&
-							 ((current_steadytime - rl.GetLastStatusChangeSteadyTime()) > closed_grace_period))
+					else
 					{
-						// Collect the relay for removal
-						if (!remove_list.has_value()) remove_list.emplace();
+						const auto removal_steadytime = rl.GetLastStatusChangeSteadyTime() + closed_grace_period;
 
-						remove_list->emplace_back(rl.GetPort());
+						if (current_steadytime > removal_steadytime)
+						{
+							thpdata.ClosedLinkTimers.Cancel(rl.GetPort());
+
+							// Collect the relay for removal
+							if (!remove_list.has_value()) remove_list.emplace();
+
+							remove_list->emplace_back(rl.GetPort());
+						}
+						else if (!thpdata.ClosedLinkTimers.Has(rl.GetPort()))
+						{
+							// Closed links don't need looking at until their grace period has
+							// passed; the check is exclusive so we schedule one tick later
+							if (!thpdata.ClosedLinkTimers.Schedule(rl.GetPort(), removal_steadytime + 1ms))
+							{
+								// Keep polling instead
+								has_open_links = true;
+							}
+						}
 					}
 				});
+
+				// Link is busy; we'll try again on the next pass
+				if (!locked) has_open_links = true;
 			}
 		});
 
+		thpdata.HasOpenLinks = has_open_links;
+
 		// Remove all relays that were collected for removal
 		if (remove_list.has_value() && !remove_list->empty())
 		{
@@ -946,7 +1011,7 @@ namespace QuantumGate::Implementation::Core::Relay
 
 		if (peer != nullptr)
 		{
-			success = m_ThreadPool.GetData().WorkEvents.AddEvent((*peer)->GetSocket<Socket>().GetSendEvent().GetHandle());
+			success = m_ThreadPool.GetData().WorkEvents.Add((*peer)->GetSocket<Socket>().GetSendEvent().GetHandle(), rl.GetPort());
 		}
 
 		if (!success) UpdateRelayStatus(rl, in_peer, out_peer, Status::Exception, Exception::GeneralFailure);
@@ -1301,9 +1366,9 @@ namespace QuantumGate::Implementation::Core::Relay
 		{
 			// Event may not have been added if the link never got to the Connecting state
 			const auto handle = (*peer)->GetSocket<Socket>().GetSendEvent().GetHandle();
-			if (m_ThreadPool.GetData().WorkEvents.HasEvent(handle))
+			if (m_ThreadPool.GetData().WorkEvents.Has(handle))
 			{
-				m_ThreadPool.GetData().WorkEvents.RemoveEvent(handle);
+				m_ThreadPool.GetData().WorkEvents.Remove(handle);
 			}
 		}
 
@@ -6,7 +6,8 @@
 #include "RelayLink.h"
 #include "RelayEvents.h"
 #include "..\..\Concurrency\SharedSpinMutex.h"
-#include "..\..\Concurrency\EventGroup.h"
+#include "..\..\Concurrency\Reactor.h"
+#include "..\..\Concurrency\TimerWheel.h"
 #include "..\..\Concurrency\DequeMap.h"
 
 namespace QuantumGate::Implementation::Core::Relay
@@ -42,7 +43,14 @@ namespace QuantumGate::Implementation::Core::Relay
 			RelayPortToThreadKeyMap_ThS RelayPortToThreadKeys;
 			ThreadKeyToLinkTotalMap_ThS ThreadKeyToLinkTotals;
 			ThreadKeyToEventQueueMap RelayEventQueues;
-			Concurrency::EventGroup WorkEvents;
+			Concurrency::Reactor WorkEvents;
+			Concurrency::Reactor::ReadyKeys ReadyRelayPorts;
+
+			// Only accessed by the primary thread; ClosedLinkTimers has the time
+			// at which closed relay links can be removed after their grace period
+			Concurrency::TimerWheel<RelayPort> ClosedLinkTimers;
+			Vector<RelayPort> ExpiredLinks;
+			bool HasOpenLinks{ false };
 		};
 
 		using ThreadPool = Concurrency::ThreadPool<ThreadPoolData, ThreadData>;
@@ -108,6 +116,7 @@ namespace QuantumGate::Implementation::Core::Relay
 		Link_ThS* Get(const RelayPort rport) noexcept;
 
 		void PrimaryThreadWait(ThreadPoolData& thpdata, ThreadData& thdata, const Concurrency::Event& shutdown_event);
+		void PrimaryThreadWaitInterrupt(ThreadPoolData& thpdata, ThreadData& thdata);
 		void PrimaryThreadProcessor(ThreadPoolData& thpdata, ThreadData& thdata, const Concurrency::Event& shutdown_event);
 
 		void WorkerThreadWait(ThreadPoolData& thpdata, ThreadData& thdata, const Concurrency::Event& shutdown_event);
@@ -158,6 +167,9 @@ namespace QuantumGate::Implementation::Core::Relay
 	private:
 		static constexpr RelayPort DefaultQueueRelayPort{ 0 };
 
+		// Maximum time the primary thread waits when there are no open relay links
+		static constexpr std::chrono::seconds MaxIdleWaitTime{ 1 };
+
 	private:
 		std::atomic_bool m_Running{ false };
 		Peer::Manager& m_PeerManager;
@@ -199,6 +199,47 @@ namespace QuantumGate::Implementation::Core::Relay
 		return ResultCode::Failed;
 	}
 
+	Result<Size> Socket::Receive(StreamBuffer& buffer, const Size /* max_rcv_size */) noexcept
+	{
+		assert(m_IOStatus.IsOpen() && m_IOStatus.IsConnected() && m_IOStatus.CanRead());
+
+		try
+		{
+			const auto bytesrcv = m_ReceiveBuffer.GetSize();
+
+			if (bytesrcv == 0)
+			{
+				if (!m_ClosingRead) return 0;
+
+				LogDbg(L"Relay socket connection closed for endpoint %s", GetPeerName().c_str());
+
+				m_ReceiveEvent.GetSubEvent(0).Reset();
+			}
+			else
+			{
+				// Nothing needs to be copied when the buffer is empty
+				if (buffer.IsEmpty()) buffer.Swap(m_ReceiveBuffer);
+				else buffer += m_ReceiveBuffer;
+
+				m_ReceiveBuffer.Clear();
+				m_ReceiveEvent.GetSubEvent(0).Reset();
+
+				m_BytesReceived += bytesrcv;
+
+				return bytesrcv;
+			}
+		}
+		catch (const std::exception& e)
+		{
+			LogErr(L"Relay socket receive exception for endpoint %s - %s",
+					GetPeerName().c_str(), Util::ToStringW(e.what()).c_str());
+
+			SetException(WSAENOBUFS);
+		}
+
+		return ResultCode::Failed;
+	}
+
 	void Socket::Close(const bool linger) noexcept
 	{
 		assert(m_IOStatus.IsOpen());
@@ -21,7 +21,7 @@ namespace QuantumGate::Implementation::Core::Relay
 		public:
 			IOBuffer() noexcept = delete;
 			
-			IOBuffer(Buffer& buffer, IOEvent& event) noexcept :
+			IOBuffer(StreamBuffer& buffer, IOEvent& event) noexcept :
 				m_Buffer(buffer), m_Event(event)
 			{}
 
@@ -37,12 +37,12 @@ namespace QuantumGate::Implementation::Core::Relay
 			IOBuffer& operator=(const IOBuffer&) = delete;
 			IOBuffer& operator=(IOBuffer&&) noexcept = default;
 
-			inline Buffer* operator->() noexcept { return &m_Buffer; }
+			inline StreamBuffer* operator->() noexcept { return &m_Buffer; }
 
-			inline Buffer& operator*() noexcept { return m_Buffer; }
+			inline StreamBuffer& operator*() noexcept { return m_Buffer; }
 
 		private:
-			Buffer& m_Buffer;
+			StreamBuffer& m_Buffer;
 			IOEvent& m_Event;
 		};
 
@@ -68,6 +68,7 @@ namespace QuantumGate::Implementation::Core::Relay
 		[[nodiscard]] Result<Size> Send(const BufferView& buffer, const Size max_snd_size = 0) noexcept override;
 		[[nodiscard]] Result<Size> SendTo(const Endpoint& endpoint, const BufferView& buffer, const Size max_snd_size = 0) noexcept override { return ResultCode::Failed; }
 		[[nodiscard]] Result<Size> Receive(Buffer& buffer, const Size max_rcv_size = 0) noexcept override;
+		[[nodiscard]] Result<Size> Receive(StreamBuffer& buffer, const Size max_rcv_size = 0) noexcept override;
 		[[nodiscard]] Result<Size> ReceiveFrom(Endpoint& endpoint, Buffer& buffer, const Size max_rcv_size = 0) noexcept override { return ResultCode::Failed; }
 
 		void Close(const bool linger = false) noexcept override;
@@ -174,9 +175,9 @@ namespace QuantumGate::Implementation::Core::Relay
 		std::optional<SteadyTime> m_LastSuspendedSteadyTime;
 		std::optional<SteadyTime> m_LastResumedSteadyTime;
 
-		Buffer m_SendBuffer;
+		StreamBuffer m_SendBuffer;
 		IOEvent m_SendEvent;
-		Buffer m_ReceiveBuffer;
+		StreamBuffer m_ReceiveBuffer;
 		IOEvent m_ReceiveEvent;
 
 		ConnectingCallback m_ConnectingCallback{ []() mutable noexcept {} };
@@ -22,7 +22,8 @@ namespace QuantumGate::Implementation::Core::TCP::Listener
 
 		PreStartup();
 
-		const auto& settings = m_Settings.GetCache();
+		const auto settings_snapshot = m_Settings.GetSnapshot();
+		const auto& settings = *settings_snapshot;
 		const auto& listener_ports = settings.Local.Listeners.TCP.Ports;
 		const auto nat_traversal = settings.Local.Listeners.TCP.NATTraversal;
 		const auto cond_accept = settings.Local.Listeners.TCP.UseConditionalAcceptFunction;
@@ -83,7 +84,8 @@ namespace QuantumGate::Implementation::Core::TCP::Listener
 
 		PreStartup();
 
-		const auto& settings = m_Settings.GetCache();
+		const auto settings_snapshot = m_Settings.GetSnapshot();
+		const auto& settings = *settings_snapshot;
 		const auto& listener_ports = settings.Local.Listeners.TCP.Ports;
 		const auto nat_traversal = settings.Local.Listeners.TCP.NATTraversal;
 		const auto cond_accept = settings.Local.Listeners.TCP.UseConditionalAcceptFunction;
@@ -190,7 +192,8 @@ namespace QuantumGate::Implementation::Core::TCP::Listener
 
 		LogSys(L"Updating TCP listenermanager...");
 
-		const auto& settings = m_Settings.GetCache();
+		const auto settings_snapshot = m_Settings.GetSnapshot();
+		const auto& settings = *settings_snapshot;
 		const auto& listener_ports = settings.Local.Listeners.TCP.Ports;
 		const auto nat_traversal = settings.Local.Listeners.TCP.NATTraversal;
 		const auto cond_accept = settings.Local.Listeners.TCP.UseConditionalAcceptFunction;
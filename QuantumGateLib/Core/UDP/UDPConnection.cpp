@@ -15,11 +15,24 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 						   const PeerConnectionType type, const ConnectionID id, const Message::SequenceNumber seqnum,
 						   ProtectedBuffer&& handshake_data, std::optional<ProtectedBuffer>&& shared_secret,
 						   std::unique_ptr<Connection::HandshakeTracker>&& handshake_tracker) :
-		m_Settings(settings), m_AccessManager(accessmgr), m_Type(type), m_ID(id),
+		Connection(settings, keymgr, accessmgr, type, id, seqnum, std::move(handshake_data), std::move(shared_secret),
+				   std::move(handshake_tracker), std::make_unique<SocketDatagramIO>(), SystemClock::Get())
+	{}
+
+	Connection::Connection(const Settings_CThS& settings, KeyGeneration::Manager& keymgr, Access::Manager& accessmgr,
+						   const PeerConnectionType type, const ConnectionID id, const Message::SequenceNumber seqnum,
+						   ProtectedBuffer&& handshake_data, std::optional<ProtectedBuffer>&& shared_secret,
+						   std::unique_ptr<Connection::HandshakeTracker>&& handshake_tracker,
+						   std::unique_ptr<DatagramIO>&& io, const Clock& clock) :
+		m_Settings(settings), m_AccessManager(accessmgr), m_Clock(clock), m_Type(type), m_ID(id), m_IO(std::move(io)),
 		m_LastInOrderReceivedSequenceNumber(seqnum), m_HandshakeTracker(std::move(handshake_tracker))
 	{
+		assert(m_IO != nullptr);
+
 		if (shared_secret) m_GlobalSharedSecret = std::move(shared_secret);
 
+		m_ReceiveQueue.Reset(Message::GetNextSequenceNumber(seqnum));
+
 		if (!InitializeKeyExchange(keymgr, std::move(handshake_data)))
 		{
 			throw std::exception("Failed to initialize keyexchange for UDP connection.");
@@ -28,7 +41,7 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 
 	Connection::~Connection()
 	{
-		if (m_Socket.GetIOStatus().IsOpen()) m_Socket.Close();
+		if (m_IO->GetIOStatus().IsOpen()) m_IO->Close();
 	}
 
 	bool Connection::InitializeKeyExchange(KeyGeneration::Manager& keymgr, ProtectedBuffer&& handshake_data) noexcept
@@ -74,13 +87,9 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 	{
 		try
 		{
-			m_Socket = Network::Socket(af, Network::Socket::Type::Datagram, Network::Protocol::UDP);
-
-			if (m_Socket.Bind(IPEndpoint(IPEndpoint::Protocol::UDP,
-										 (af == Network::AddressFamily::IPv4) ? IPAddress::AnyIPv4() : IPAddress::AnyIPv6(),
-										 0), nat_traversal))
+			if (m_IO->Open(af, nat_traversal))
 			{
-				m_ConnectionData = std::make_shared<ConnectionData_ThS>(&m_Socket.GetEvent());
+				m_ConnectionData = std::make_shared<ConnectionData_ThS>(&m_IO->GetEvent());
 
 				ResetMTU();
 
@@ -109,6 +118,10 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 			SendImmediateReset();
 		}
 
+		const auto& dgstats = m_IO->GetDatagramStatistics();
+		LogDbg(L"UDP connection: sent %zu datagrams (%.2f per call) and received %zu datagrams (%.2f per call) on connection %llu",
+			   dgstats.NumSent, dgstats.GetSentPerCall(), dgstats.NumReceived, dgstats.GetReceivedPerCall(), GetID());
+
 		DiscardReturnValue(SetStatus(Status::Closed));
 	}
 
@@ -192,7 +205,7 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 	bool Connection::OnStatusChange(const Status old_status, const Status new_status) noexcept
 	{
 		auto success = true;
-		m_LastStatusChangeSteadyTime = Util::GetCurrentSteadyTime();
+		m_LastStatusChangeSteadyTime = m_Clock.GetSteadyTime();
 
 		switch (new_status)
 		{
@@ -381,6 +394,77 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 		}
 	}
 
+	bool Connection::HasDeferredWork() const noexcept
+	{
+		// Received data that's waiting for room in the receive buffer;
+		// we don't get signaled when the peer reads from the buffer
+		if (GetStatus() == Status::Connected)
+		{
+			return (m_ReceiveQueue.GetFront() != nullptr);
+		}
+
+		return false;
+	}
+
+	std::optional<SteadyTime> Connection::GetNextDeadline() noexcept
+	{
+		const auto& settings = GetSettings();
+
+		const auto max_keepalive_timeout = settings.Local.SuspendTimeout + SuspendTimeoutMargin;
+
+		std::optional<SteadyTime> deadline;
+
+		const auto update_deadline = [&](const SteadyTime steadytime) noexcept
+		{
+			if (!deadline.has_value() || steadytime < *deadline) deadline = steadytime;
+		};
+
+		if (!m_DelayedSendQueue.empty())
+		{
+			const auto& itm = m_DelayedSendQueue.top();
+			update_deadline(itm.ScheduleSteadyTime + itm.ScheduleMilliseconds);
+		}
+
+		switch (GetStatus())
+		{
+			case Status::Handshake:
+			{
+				update_deadline(m_LastStatusChangeSteadyTime + settings.UDP.ConnectTimeout);
+
+				if (const auto next = m_SendQueue.GetNextProcessSteadyTime(); next.has_value())
+				{
+					update_deadline(*next);
+				}
+				break;
+			}
+			case Status::Connected:
+			{
+				update_deadline(m_LastSendSteadyTime + m_KeepAliveTimeout);
+				update_deadline(m_LastReceiveSteadyTime + max_keepalive_timeout);
+
+				if (const auto next = m_SendQueue.GetNextProcessSteadyTime(); next.has_value())
+				{
+					update_deadline(*next);
+				}
+
+				if (m_MTUDiscovery) update_deadline(m_MTUDiscovery->GetNextProcessSteadyTime());
+				break;
+			}
+			case Status::Suspended:
+			{
+				update_deadline(m_LastSendSteadyTime + m_KeepAliveTimeout);
+				update_deadline(m_LastReceiveSteadyTime + max_keepalive_timeout + settings.Local.MaxSuspendDuration);
+				break;
+			}
+			default:
+			{
+				break;
+			}
+		}
+
+		return deadline;
+	}
+
 	void Connection::UpdateReputation(const IPEndpoint& endpoint, const Access::AddressReputationUpdate rep_update) noexcept
 	{
 		const auto result = m_AccessManager.UpdateAddressReputation(endpoint.GetIPAddress(), rep_update);
@@ -536,7 +620,7 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 				.ProtocolVersionMinor = ProtocolVersion::Minor,
 				.ConnectionID = GetID(),
 				.Port = static_cast<UInt16>(Random::GetPseudoRandomNumber()),
-				.Time = static_cast<UInt64>(Util::ToTimeT(Util::GetCurrentSystemTime())),
+				.Time = static_cast<UInt64>(Util::ToTimeT(m_Clock.GetSystemTime())),
 				.Cookie = std::move(cookie),
 				.HandshakeDataOut = &m_KeyExchange->GetHandshakeData()
 			});
@@ -573,8 +657,8 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 				.ProtocolVersionMajor = ProtocolVersion::Major,
 				.ProtocolVersionMinor = ProtocolVersion::Minor,
 				.ConnectionID = GetID(),
-				.Port = m_Socket.GetLocalEndpoint().GetIPEndpoint().GetPort(),
-				.Time = static_cast<UInt64>(Util::ToTimeT(Util::GetCurrentSystemTime())),
+				.Port = m_IO->GetLocalEndpoint().GetIPEndpoint().GetPort(),
+				.Time = static_cast<UInt64>(Util::ToTimeT(m_Clock.GetSystemTime())),
 				.HandshakeDataOut = &m_KeyExchange->GetHandshakeData()
 			});
 
@@ -644,59 +728,25 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 
 	bool Connection::SendPendingAcks() noexcept
 	{
-		if (m_ReceivePendingAcks.empty()) return true;
+		if (m_ReceivePendingAckRanges.empty()) return true;
 
 		try
 		{
 			// Update when we leave
 			auto sg = MakeScopeGuard([&]
 			{
-				m_ReceivePendingAcks.clear();
+				m_ReceivePendingAckRanges.clear();
 			});
 
-			std::sort(m_ReceivePendingAcks.begin(), m_ReceivePendingAcks.end());
-
 			// If the last sequence number in the list was already ACked
 			// then no need to send ACKs
-			const auto lastnum = *(m_ReceivePendingAcks.end()-1);
+			const auto lastnum = m_ReceivePendingAckRanges.back().End;
 			if (lastnum <= m_LastInOrderReceivedSequenceNumber &&
 				m_LastInOrderReceivedSequenceNumber.IsAcked())
 			{
 				return true;
 			}
 
-			// Make ranges out of sequence numbers; i.e. 2, 3, 4, 6, 7, 8, 9
-			// becomes [2, 4], [6, 9]
-			for (auto it = m_ReceivePendingAcks.begin(); it != m_ReceivePendingAcks.end();)
-			{
-				auto begin = *it;
-				auto end = begin;
-
-				++it;
-
-				for (; it != m_ReceivePendingAcks.end();)
-				{
-					if (end < std::numeric_limits<Message::SequenceNumber>::max() &&
-						(*it == end || *it == end + 1))
-					{
-						end = *it;
-						++it;
-					}
-					else
-					{
-						break;
-					}
-				}
-
-				assert(begin <= end);
-
-				m_ReceivePendingAckRanges.emplace_back(
-					Message::AckRange{
-						.Begin = begin,
-						.End = end
-					});
-			}
-
 			while (!m_ReceivePendingAckRanges.empty())
 			{
 				Dbg(L"UDP connection: sending ACKs on connection %llu", GetID());
@@ -824,7 +874,7 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 			Buffer data;
 			if (msg.Write(data, m_SymmetricKeys[0]))
 			{
-				const auto now = Util::GetCurrentSteadyTime();
+				const auto now = m_Clock.GetSteadyTime();
 
 				// Need to use the listener socket to send syn replies for inbound connections.
 				// This is because if the peer is behind NAT, it will expect a reply from the same
@@ -933,7 +983,7 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 		{
 			try
 			{
-				listener_send_queue->WithUniqueLock()->emplace(
+				listener_send_queue->WithUniqueLock()->emplace_back(
 					Listener::SendQueueItem{
 						.Endpoint = endpoint,
 						.Data = msgdata
@@ -947,7 +997,7 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 		}
 		else
 		{
-			auto result = m_Socket.SendTo(endpoint, msgdata);
+			auto result = m_IO->SendTo(endpoint, msgdata);
 			if (result.Failed())
 			{
 				if (result.GetErrorCode().category() == std::system_category() &&
@@ -968,6 +1018,30 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 		}
 	}
 
+	Result<Size> Connection::SendBatch(const SteadyTime current_steadytime, const Vector<BufferView>& batch,
+									   const std::optional<IPEndpoint>& peer_endpoint) noexcept
+	{
+		m_LastSendSteadyTime = current_steadytime;
+
+		const auto& endpoint = peer_endpoint.has_value() ? *peer_endpoint : m_PeerEndpoint;
+
+		// Returns the number of datagrams sent from the front of the batch
+		auto result = m_IO->SendToBatch(endpoint, batch);
+		if (result.Failed())
+		{
+			if (result.GetErrorCode().category() == std::system_category() &&
+				result.GetErrorCode().value() == 10065)
+			{
+				LogDbg(L"UDP connection: failed to send data on connection %llu (host unreachable)", GetID());
+
+				// Host unreachable error; see Send() above
+				return 0;
+			}
+		}
+
+		return result;
+	}
+
 	Connection::ReceiveBuffer& Connection::GetReceiveBuffer() const noexcept
 	{
 		static thread_local ReceiveBuffer rcvbuf{ ReceiveBuffer::GetMaxSize() };
@@ -980,15 +1054,15 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 		Endpoint endpoint;
 		auto& buffer = GetReceiveBuffer();
 
-		if (m_Socket.UpdateIOStatus(0ms))
+		if (m_IO->UpdateIOStatus(0ms))
 		{
-			if (m_Socket.GetIOStatus().CanRead())
+			if (m_IO->GetIOStatus().CanRead())
 			{
 				while (true)
 				{
 					auto bufspan = BufferSpan(buffer);
 
-					const auto result = m_Socket.ReceiveFrom(endpoint, bufspan);
+					const auto result = m_IO->ReceiveFrom(endpoint, bufspan);
 					if (result.Succeeded())
 					{
 						if (*result > 0)
@@ -1034,12 +1108,12 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 					}
 				}
 			}
-			else if (m_Socket.GetIOStatus().HasException())
+			else if (m_IO->GetIOStatus().HasException())
 			{
 				LogErr(L"UDP connection: exception on socket for connection %llu (%s)",
-					   GetID(), GetSysErrorString(m_Socket.GetIOStatus().GetErrorCode()).c_str());
+					   GetID(), GetSysErrorString(m_IO->GetIOStatus().GetErrorCode()).c_str());
 
-				SetCloseCondition(CloseCondition::ReceiveError, m_Socket.GetIOStatus().GetErrorCode());
+				SetCloseCondition(CloseCondition::ReceiveError, m_IO->GetIOStatus().GetErrorCode());
 
 				return false;
 			}
@@ -1199,6 +1273,7 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 					m_KeyExchange->SetPeerHandshakeData(std::move(*syn_data.HandshakeDataIn));
 
 					m_LastInOrderReceivedSequenceNumber = msg.GetMessageSequenceNumber();
+					m_ReceiveQueue.Reset(Message::GetNextSequenceNumber(m_LastInOrderReceivedSequenceNumber));
 
 					assert(msg.HasAck());
 
@@ -1217,7 +1292,7 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 							m_ConnectionData->WithUniqueLock([&](auto& connection_data) noexcept
 							{
 								// Endpoint update
-								connection_data.SetLocalEndpoint(m_Socket.GetLocalEndpoint().GetIPEndpoint());
+								connection_data.SetLocalEndpoint(m_IO->GetLocalEndpoint().GetIPEndpoint());
 								// Don't need listener send queue anymore
 								connection_data.ReleaseListenerSendQueue();
 								// Socket can now send data
@@ -1311,13 +1386,14 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 
 						if (AckReceivedMessage(msg.GetMessageSequenceNumber()))
 						{
-							try
+							// Duplicates of messages that are still
+							// in the queue don't replace them
+							const auto seqnum = msg.GetMessageSequenceNumber();
+							if (m_ReceiveQueue.Emplace(seqnum, std::move(msg)).first != nullptr)
 							{
-								m_ReceiveQueue.emplace(msg.GetMessageSequenceNumber(), std::move(msg));
 								success = true;
 								endpoint_check = true;
 							}
-							catch (...) {}
 						}
 					}
 					case ReceiveWindow::Previous:
@@ -1562,9 +1638,45 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 
 	bool Connection::AckReceivedMessage(const Message::SequenceNumber seqnum) noexcept
 	{
+		// The pending acks are kept as ranges sorted by sequence number so that they can be
+		// sent as they are; i.e. 2, 3, 4, 6, 7, 8, 9 becomes [2, 4], [6, 9]. Messages mostly
+		// arrive in order, in which case the last range just gets extended.
+		auto& ranges = m_ReceivePendingAckRanges;
+
 		try
 		{
-			m_ReceivePendingAcks.emplace_back(seqnum);
+			if (ranges.empty() || ranges.back().End < seqnum)
+			{
+				if (!ranges.empty() && ranges.back().End + 1 == seqnum) ranges.back().End = seqnum;
+				else ranges.emplace_back(Message::AckRange{ .Begin = seqnum, .End = seqnum });
+
+				return true;
+			}
+
+			// First range that ends at or after the sequence number
+			const auto it = std::lower_bound(ranges.begin(), ranges.end(), seqnum,
+											 [](const Message::AckRange& range, const Message::SequenceNumber num) noexcept
+			{
+				return (range.End < num);
+			});
+
+			assert(it != ranges.end());
+
+			// Already in a range
+			if (it->Begin <= seqnum) return true;
+
+			const auto extends_next = (it->Begin == seqnum + 1);
+			const auto extends_prev = (it != ranges.begin() && std::prev(it)->End + 1 == seqnum);
+
+			if (extends_prev && extends_next)
+			{
+				std::prev(it)->End = it->End;
+				ranges.erase(it);
+			}
+			else if (extends_prev) std::prev(it)->End = seqnum;
+			else if (extends_next) it->Begin = seqnum;
+			else ranges.insert(it, Message::AckRange{ .Begin = seqnum, .End = seqnum });
+
 			return true;
 		}
 		catch (...) {}
@@ -1610,23 +1722,22 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 
 	bool Connection::ReceivePendingSocketData() noexcept
 	{
-		if (m_ReceiveQueue.empty()) return true;
+		assert(m_ReceiveQueue.GetBaseSequenceNumber() ==
+			   Message::GetNextSequenceNumber(m_LastInOrderReceivedSequenceNumber));
 
-		auto next_itm = m_ReceiveQueue.find(Message::GetNextSequenceNumber(m_LastInOrderReceivedSequenceNumber));
-		if (next_itm == m_ReceiveQueue.end())
-		{
-			return true;
-		}
+		// The next message in order is always at the front of the queue
+		auto next_msg = m_ReceiveQueue.GetFront();
+		if (next_msg == nullptr) return true;
 
 		auto connection_data = m_ConnectionData->WithUniqueLock();
 
 		auto rcv_event = false;
 
-		while (next_itm != m_ReceiveQueue.end())
+		while (next_msg != nullptr)
 		{
 			auto remove = false;
 
-			auto& msg = next_itm->second;
+			auto& msg = *next_msg;
 
 			if (msg.GetType() == Message::Type::Data)
 			{
@@ -1658,10 +1769,10 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 			if (remove)
 			{
 				m_LastInOrderReceivedSequenceNumber = msg.GetMessageSequenceNumber();
-				m_ReceiveQueue.erase(next_itm);
+				m_ReceiveQueue.PopFront();
 			}
 
-			next_itm = m_ReceiveQueue.find(Message::GetNextSequenceNumber(m_LastInOrderReceivedSequenceNumber));
+			next_msg = m_ReceiveQueue.GetFront();
 		}
 
 		if (rcv_event)
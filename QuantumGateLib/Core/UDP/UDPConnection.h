@@ -5,6 +5,7 @@
 
 #include "UDPSocket.h"
 #include "UDPConnectionSendQueue.h"
+#include "UDPConnectionIO.h"
 #include "..\..\Memory\StackBuffer.h"
 #include "..\..\Common\Containers.h"
 #include "..\Access\AccessManager.h"
@@ -21,7 +22,10 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 
 		using ReceiveBuffer = Memory::StackBuffer<UDPMessageSizes::Max>;
 
-		using ReceiveQueue = Containers::Map<Message::SequenceNumber, Message>;
+		// Messages received out of order wait in the window until the messages before
+		// them have been received; the window begins right after the last message
+		// that was received in order
+		using ReceiveQueue = SequenceWindow<Message>;
 
 		enum class ReceiveWindow { Unknown, Current, Previous };
 
@@ -132,6 +136,11 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 				   const PeerConnectionType type, const ConnectionID id, const Message::SequenceNumber seqnum,
 				   ProtectedBuffer&& handshake_data, std::optional<ProtectedBuffer>&& shared_secret,
 				   std::unique_ptr<Connection::HandshakeTracker>&& handshake_tracker);
+		Connection(const Settings_CThS& settings, KeyGeneration::Manager& keymgr, Access::Manager& accessmgr,
+				   const PeerConnectionType type, const ConnectionID id, const Message::SequenceNumber seqnum,
+				   ProtectedBuffer&& handshake_data, std::optional<ProtectedBuffer>&& shared_secret,
+				   std::unique_ptr<Connection::HandshakeTracker>&& handshake_tracker,
+				   std::unique_ptr<DatagramIO>&& io, const Clock& clock);
 		Connection(const Connection&) = delete;
 		Connection(Connection&&) noexcept = delete;
 		~Connection();
@@ -148,17 +157,32 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 								const bool nat_traversal, UDP::Socket& socket) noexcept;
 		void Close() noexcept;
 
-		Concurrency::Event& GetReadEvent() noexcept { return m_Socket.GetEvent(); }
+		Concurrency::Event& GetReadEvent() noexcept { return m_IO->GetEvent(); }
 
 		void ProcessEvents(const SteadyTime current_steadytime, const SystemTime current_systemtime) noexcept;
 		[[nodiscard]] inline bool ShouldClose() const noexcept { return (m_CloseCondition != CloseCondition::None); }
 
+		// Work that can't be signaled by an event or timed; the connection
+		// needs to get processed again on the next opportunity
+		[[nodiscard]] bool HasDeferredWork() const noexcept;
+
+		// Earliest time at which ProcessEvents() needs to be called again
+		// for timeouts, retransmissions, keepalives and delayed sends
+		[[nodiscard]] std::optional<SteadyTime> GetNextDeadline() noexcept;
+
 		void OnLocalIPInterfaceChanged() noexcept;
 
+		// Adds the datagrams sent and received since the last time to the totals
+		inline void AddDatagramStatistics(Network::Socket::DatagramStatisticsTotals& totals) noexcept
+		{
+			totals.Add(m_IO->GetDatagramStatistics(), m_AddedDatagramStatistics);
+		}
+
 		static std::optional<ConnectionID> MakeConnectionID() noexcept;
 
 	private:
 		[[nodiscard]] const Settings& GetSettings() const noexcept { return m_Settings.GetCache(true); }
+		[[nodiscard]] inline const Clock& GetClock() const noexcept { return m_Clock; }
 
 		[[nodiscard]] bool SetStatus(const Status status) noexcept;
 		[[nodiscard]] bool OnStatusChange(const Status old_status, const Status new_status) noexcept;
@@ -174,7 +198,7 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 		void SetCloseCondition(const CloseCondition cc, int socket_error_code = -1) noexcept;
 		void SetSocketException(const int error_code) noexcept;
 		
-		inline Result<bool> SetMTUDiscovery(const bool enabled) noexcept { return m_Socket.SetMTUDiscovery(enabled); }
+		inline Result<bool> SetMTUDiscovery(const bool enabled) noexcept { return m_IO->SetMTUDiscovery(enabled); }
 		void ResetMTU() noexcept;
 		[[nodiscard]] bool OnMTUUpdate(const Size mtu) noexcept;
 
@@ -200,6 +224,8 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 		[[nodiscard]] Result<Size> Send(const SteadyTime current_steadytime, const Buffer& msgdata,
 										const std::shared_ptr<Listener::SendQueue_ThS>& listener_send_queue,
 										const std::optional<IPEndpoint>& peer_endpoint) noexcept;
+		[[nodiscard]] Result<Size> SendBatch(const SteadyTime current_steadytime, const Vector<BufferView>& batch,
+											 const std::optional<IPEndpoint>& peer_endpoint) noexcept;
 
 		[[nodiscard]] ReceiveBuffer& GetReceiveBuffer() const noexcept;
 		[[nodiscard]] bool ReceiveToQueue(const SteadyTime current_steadytime, const SystemTime current_systemtime,
@@ -240,6 +266,7 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 	private:
 		const Settings_CThS& m_Settings;
 		Access::Manager& m_AccessManager;
+		const Clock& m_Clock;
 
 		const PeerConnectionType m_Type{ PeerConnectionType::Unknown };
 		Status m_Status{ Status::Closed };
@@ -249,7 +276,8 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 		std::optional<ProtectedBuffer> m_GlobalSharedSecret;
 		SymmetricKeysCollection m_SymmetricKeys;
 
-		Network::Socket m_Socket;
+		std::unique_ptr<DatagramIO> m_IO;
+		Network::Socket::DatagramStatistics m_AddedDatagramStatistics;
 		SteadyTime m_LastStatusChangeSteadyTime;
 		std::shared_ptr<ConnectionData_ThS> m_ConnectionData;
 
@@ -266,7 +294,6 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 		Size m_ReceiveWindowSize{ MinReceiveWindowItemSize };
 		ReceiveQueue m_ReceiveQueue;
 		SteadyTime m_LastReceiveSteadyTime;
-		Vector<Message::SequenceNumber> m_ReceivePendingAcks;
 		Vector<Message::AckRange> m_ReceivePendingAckRanges;
 
 		CloseCondition m_CloseCondition{ CloseCondition::None };
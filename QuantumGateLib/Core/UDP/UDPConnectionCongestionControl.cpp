@@ -0,0 +1,247 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#include "pch.h"
+#include "UDPConnectionCongestionControl.h"
+#include "UDPConnectionStats.h"
+
+namespace QuantumGate::Implementation::Core::UDP::Connection
+{
+	std::unique_ptr<CongestionController> CongestionController::Create(const UDPCongestionControl algorithm)
+	{
+		switch (algorithm)
+		{
+			case UDPCongestionControl::AIMD:
+				return std::make_unique<Statistics>();
+			case UDPCongestionControl::CUBIC:
+				return std::make_unique<CubicCongestionController>();
+			case UDPCongestionControl::BBR:
+				return std::make_unique<BBRCongestionController>();
+			default:
+				assert(false);
+				break;
+		}
+
+		return std::make_unique<Statistics>();
+	}
+
+	Size CubicCongestionController::GetMTUWindowSize() noexcept
+	{
+		return static_cast<Size>(std::ceil(m_WindowSize));
+	}
+
+	void CubicCongestionController::RecordMTUAck(const double num_mtu, const SteadyTime now) noexcept
+	{
+		if (num_mtu == 0.0) return;
+
+		if (m_WindowSize < m_SlowStartThreshold)
+		{
+			// Slow start
+			m_WindowSize += num_mtu;
+			return;
+		}
+
+		if (!m_EpochStartSteadyTime.has_value())
+		{
+			m_EpochStartSteadyTime = now;
+
+			if (m_WindowSize < m_MaxWindowSize)
+			{
+				m_K = std::cbrt((m_MaxWindowSize - m_WindowSize) / C);
+			}
+			else
+			{
+				m_K = 0.0;
+				m_MaxWindowSize = m_WindowSize;
+			}
+
+			m_RenoWindowSize = m_WindowSize;
+		}
+
+		const auto t = std::chrono::duration<double>(now - *m_EpochStartSteadyTime).count();
+		const auto rtt = std::chrono::duration<double>(m_RTT.GetRTT()).count();
+
+		const auto cubic_window = [&](const double time) noexcept
+		{
+			return (C * std::pow(time - m_K, 3.0) + m_MaxWindowSize);
+		};
+
+		// Window size that standard AIMD would have had; CUBIC should never be
+		// less aggressive than that (RFC 9438 section 4.3)
+		constexpr auto alpha = 3.0 * (1.0 - Beta) / (1.0 + Beta);
+		m_RenoWindowSize += alpha * (num_mtu / m_WindowSize);
+
+		if (cubic_window(t) < m_RenoWindowSize)
+		{
+			m_WindowSize = m_RenoWindowSize;
+		}
+		else
+		{
+			// Grow towards where the cubic function will be one RTT from now,
+			// but by no more than half of the window per RTT
+			const auto target = std::clamp(cubic_window(t + rtt), m_WindowSize, m_WindowSize * 1.5);
+			m_WindowSize += ((target - m_WindowSize) / m_WindowSize) * num_mtu;
+		}
+	}
+
+	void CubicCongestionController::RecordMTULoss(const double num_mtu, const SteadyTime now) noexcept
+	{
+		if (num_mtu == 0.0) return;
+
+		// Losses within the same RTT are part of the same congestion event
+		if (m_LastLossSteadyTime.has_value() && now - *m_LastLossSteadyTime < m_RTT.GetRTT()) return;
+
+		m_LastLossSteadyTime = now;
+		m_EpochStartSteadyTime.reset();
+
+		// Fast convergence; release bandwidth for new flows
+		// when the window didn't get back to where it was
+		if (m_WindowSize < m_MaxWindowSize) m_MaxWindowSize = m_WindowSize * (1.0 + Beta) / 2.0;
+		else m_MaxWindowSize = m_WindowSize;
+
+		m_WindowSize = std::max(MinWindowSize, m_WindowSize * Beta);
+		m_SlowStartThreshold = m_WindowSize;
+	}
+
+	void BBRCongestionController::RecordRTT(const std::chrono::nanoseconds rtt, const SteadyTime now) noexcept
+	{
+		m_RTT.RecordRTT(rtt);
+
+		if (m_MinRTT.count() == 0 || rtt <= m_MinRTT)
+		{
+			m_MinRTT = rtt;
+			m_MinRTTSteadyTime = now;
+		}
+		else if (now - m_MinRTTSteadyTime > MinRTTExpiration && m_State == State::ProbeBandwidth)
+		{
+			// The minimum RTT wasn't seen again for a while; drain the queues along
+			// the path for a short time so that the propagation delay can be measured
+			// again, since the route may have changed
+			m_State = State::ProbeRTT;
+			m_PacingGain = 1.0;
+			m_MinRTT = rtt;
+			m_MinRTTSteadyTime = now;
+			m_ProbeRTTDoneSteadyTime = now + ProbeRTTDuration;
+		}
+	}
+
+	Size BBRCongestionController::GetMTUWindowSize() noexcept
+	{
+		if (m_State == State::ProbeRTT || m_BottleneckBandwidth == 0.0)
+		{
+			return static_cast<Size>(MinWindowSize);
+		}
+
+		return static_cast<Size>(std::ceil(std::max(MinWindowSize, m_WindowGain * GetBDP())));
+	}
+
+	void BBRCongestionController::RecordMTUAck(const double num_mtu, const SteadyTime now) noexcept
+	{
+		if (num_mtu == 0.0) return;
+
+		if (m_State == State::ProbeRTT && now >= m_ProbeRTTDoneSteadyTime)
+		{
+			m_State = State::ProbeBandwidth;
+			m_PacingGain = ProbeBandwidthGains[m_ProbeBandwidthGainIndex];
+			m_WindowGain = WindowGain;
+		}
+
+		if (!m_RoundStartSteadyTime.has_value())
+		{
+			m_RoundStartSteadyTime = now;
+			m_RoundDelivered = 0.0;
+		}
+
+		m_RoundDelivered += num_mtu;
+
+		// The delivery rate is sampled about once per round trip
+		const auto elapsed = now - *m_RoundStartSteadyTime;
+		if (elapsed >= GetRoundDuration())
+		{
+			const auto delivery_rate = m_RoundDelivered / std::chrono::duration<double>(elapsed).count();
+
+			OnRoundEnd(now, delivery_rate);
+
+			m_RoundStartSteadyTime = now;
+			m_RoundDelivered = 0.0;
+		}
+	}
+
+	void BBRCongestionController::RecordMTULoss(const double num_mtu, const SteadyTime now) noexcept
+	{
+		// Loss isn't used as a signal; the window and pacing rate
+		// only follow the measured bandwidth and minimum RTT
+	}
+
+	double BBRCongestionController::GetPacingRate() noexcept
+	{
+		// No estimate yet; spread the initial window over the RTT
+		if (m_BottleneckBandwidth == 0.0) return CongestionController::GetPacingRate() * m_PacingGain;
+
+		return (m_PacingGain * m_BottleneckBandwidth);
+	}
+
+	void BBRCongestionController::OnRoundEnd(const SteadyTime now, const double delivery_rate) noexcept
+	{
+		// Maximum of the delivery rates of the last rounds
+		m_BandwidthSamples[m_BandwidthSampleIndex] = delivery_rate;
+		m_BandwidthSampleIndex = (m_BandwidthSampleIndex + 1) % m_BandwidthSamples.size();
+		m_BottleneckBandwidth = *std::max_element(m_BandwidthSamples.begin(), m_BandwidthSamples.end());
+
+		switch (m_State)
+		{
+			case State::Startup:
+			{
+				// The pipe is full when the bandwidth stops growing by at least 25% per round
+				if (m_BottleneckBandwidth >= m_StartupBandwidth * 1.25)
+				{
+					m_StartupBandwidth = m_BottleneckBandwidth;
+					m_NumStartupRoundsWithoutGrowth = 0;
+				}
+				else if (++m_NumStartupRoundsWithoutGrowth >= NumStartupRoundsWithoutGrowth)
+				{
+					// Drain the queue that built up during startup
+					m_State = State::Drain;
+					m_PacingGain = 1.0 / StartupGain;
+					m_WindowGain = StartupGain;
+				}
+				break;
+			}
+			case State::Drain:
+			{
+				m_State = State::ProbeBandwidth;
+				m_ProbeBandwidthGainIndex = 0;
+				m_PacingGain = ProbeBandwidthGains[m_ProbeBandwidthGainIndex];
+				m_WindowGain = WindowGain;
+				break;
+			}
+			case State::ProbeBandwidth:
+			{
+				// Cycle through probing for more bandwidth, draining
+				// the queue that the probing caused and cruising
+				m_ProbeBandwidthGainIndex = (m_ProbeBandwidthGainIndex + 1) % ProbeBandwidthGains.size();
+				m_PacingGain = ProbeBandwidthGains[m_ProbeBandwidthGainIndex];
+				break;
+			}
+			case State::ProbeRTT:
+			{
+				break;
+			}
+			default:
+			{
+				assert(false);
+				break;
+			}
+		}
+	}
+
+	double BBRCongestionController::GetBDP() const noexcept
+	{
+		return (m_BottleneckBandwidth * std::chrono::duration<double>(GetRoundDuration()).count());
+	}
+
+	std::chrono::nanoseconds BBRCongestionController::GetRoundDuration() const noexcept
+	{
+		return (m_MinRTT.count() > 0) ? m_MinRTT : m_RTT.GetRTT();
+	}
+}
@@ -0,0 +1,177 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#pragma once
+
+namespace QuantumGate::Implementation::Core::UDP::Connection
+{
+	// Decides how many messages may be in flight on a connection and how fast they may be
+	// sent, based on the acks and losses that the send queue records. Window sizes are in
+	// number of messages of the maximum message size (MTUs).
+	class CongestionController
+	{
+	public:
+		CongestionController() noexcept = default;
+		CongestionController(const CongestionController&) = delete;
+		CongestionController(CongestionController&&) noexcept = delete;
+		virtual ~CongestionController() = default;
+		CongestionController& operator=(const CongestionController&) = delete;
+		CongestionController& operator=(CongestionController&&) noexcept = delete;
+
+		[[nodiscard]] virtual std::chrono::nanoseconds GetRetransmissionTimeout() noexcept = 0;
+		[[nodiscard]] virtual std::chrono::nanoseconds GetRTT() noexcept = 0;
+		virtual void RecordRTT(const std::chrono::nanoseconds rtt, const SteadyTime now) noexcept = 0;
+
+		[[nodiscard]] virtual Size GetMTUWindowSize() noexcept = 0;
+		virtual void RecordMTUAck(const double num_mtu, const SteadyTime now) noexcept = 0;
+		virtual void RecordMTULoss(const double num_mtu, const SteadyTime now) noexcept = 0;
+		virtual void RecordMTUWindowSizeStats(const SteadyTime now) noexcept {}
+
+		// The number of MTUs per second to pace sending at; by default the window
+		// gets spread over the RTT, with some room for the window to grow
+		[[nodiscard]] virtual double GetPacingRate() noexcept
+		{
+			const auto rtt = std::chrono::duration<double>(GetRTT()).count();
+			return (PacingGain * static_cast<double>(GetMTUWindowSize()) / std::max(rtt, MinPacingRTT));
+		}
+
+		[[nodiscard]] static std::unique_ptr<CongestionController> Create(const UDPCongestionControl algorithm);
+
+	protected:
+		static constexpr double PacingGain{ 1.25 };
+		static constexpr double MinPacingRTT{ 0.000'001 };
+	};
+
+	// Smoothed RTT and retransmission timeout as per RFC 6298
+	class RTTEstimator final
+	{
+	public:
+		[[nodiscard]] inline std::chrono::nanoseconds GetRTT() const noexcept { return m_SmoothedRTT; }
+		[[nodiscard]] inline std::chrono::nanoseconds GetMinRTT() const noexcept { return m_MinRTT; }
+		[[nodiscard]] inline bool HasSamples() const noexcept { return m_HasSamples; }
+
+		[[nodiscard]] inline std::chrono::nanoseconds GetRetransmissionTimeout() const noexcept
+		{
+			if (!m_HasSamples) return StartRTT;
+
+			return m_SmoothedRTT + std::max(ClockGranularity, m_RTTVariation * 4);
+		}
+
+		void RecordRTT(const std::chrono::nanoseconds rtt) noexcept
+		{
+			const auto sample = std::max(MinRTT, rtt);
+
+			if (!m_HasSamples)
+			{
+				m_SmoothedRTT = sample;
+				m_RTTVariation = sample / 2;
+				m_MinRTT = sample;
+				m_HasSamples = true;
+			}
+			else
+			{
+				m_RTTVariation = (m_RTTVariation * 3 + std::chrono::abs(m_SmoothedRTT - sample)) / 4;
+				m_SmoothedRTT = (m_SmoothedRTT * 7 + sample) / 8;
+				m_MinRTT = std::min(m_MinRTT, sample);
+			}
+		}
+
+	private:
+		static constexpr std::chrono::nanoseconds StartRTT{ 600'000'000 };
+		static constexpr std::chrono::nanoseconds MinRTT{ 1'000 };
+		static constexpr std::chrono::nanoseconds ClockGranularity{ 1'000'000 };
+
+	private:
+		bool m_HasSamples{ false };
+		std::chrono::nanoseconds m_SmoothedRTT{ StartRTT };
+		std::chrono::nanoseconds m_RTTVariation{ StartRTT / 2 };
+		std::chrono::nanoseconds m_MinRTT{ StartRTT };
+	};
+
+	// CUBIC as per RFC 9438; the window grows as a cubic function of the time since the
+	// last congestion event, so that it quickly gets back to the size at which loss occurred
+	// and then carefully probes beyond it, independent of the RTT
+	class CubicCongestionController final : public CongestionController
+	{
+	public:
+		[[nodiscard]] std::chrono::nanoseconds GetRetransmissionTimeout() noexcept override { return m_RTT.GetRetransmissionTimeout(); }
+		[[nodiscard]] std::chrono::nanoseconds GetRTT() noexcept override { return m_RTT.GetRTT(); }
+		void RecordRTT(const std::chrono::nanoseconds rtt, const SteadyTime now) noexcept override { m_RTT.RecordRTT(rtt); }
+
+		[[nodiscard]] Size GetMTUWindowSize() noexcept override;
+		void RecordMTUAck(const double num_mtu, const SteadyTime now) noexcept override;
+		void RecordMTULoss(const double num_mtu, const SteadyTime now) noexcept override;
+
+	private:
+		static constexpr double C{ 0.4 };
+		static constexpr double Beta{ 0.7 };
+		static constexpr double MinWindowSize{ 2.0 };
+
+	private:
+		RTTEstimator m_RTT;
+		double m_WindowSize{ MinWindowSize };
+		double m_SlowStartThreshold{ std::numeric_limits<double>::max() };
+		double m_MaxWindowSize{ 0.0 };
+		double m_RenoWindowSize{ 0.0 };
+		double m_K{ 0.0 };
+		std::optional<SteadyTime> m_EpochStartSteadyTime;
+		std::optional<SteadyTime> m_LastLossSteadyTime;
+	};
+
+	// BBR-style model; estimates the bottleneck bandwidth from the rate at which messages
+	// get delivered and the propagation delay from the minimum RTT, and keeps about one
+	// bandwidth-delay product in flight while pacing at the bottleneck bandwidth. Loss alone
+	// isn't taken as a sign of congestion, which keeps goodput up on lossy links.
+	class BBRCongestionController final : public CongestionController
+	{
+		enum class State { Startup, Drain, ProbeBandwidth, ProbeRTT };
+
+	public:
+		[[nodiscard]] std::chrono::nanoseconds GetRetransmissionTimeout() noexcept override { return m_RTT.GetRetransmissionTimeout(); }
+		[[nodiscard]] std::chrono::nanoseconds GetRTT() noexcept override { return m_RTT.GetRTT(); }
+		void RecordRTT(const std::chrono::nanoseconds rtt, const SteadyTime now) noexcept override;
+
+		[[nodiscard]] Size GetMTUWindowSize() noexcept override;
+		void RecordMTUAck(const double num_mtu, const SteadyTime now) noexcept override;
+		void RecordMTULoss(const double num_mtu, const SteadyTime now) noexcept override;
+
+		[[nodiscard]] double GetPacingRate() noexcept override;
+
+		[[nodiscard]] inline double GetBottleneckBandwidth() const noexcept { return m_BottleneckBandwidth; }
+
+	private:
+		void OnRoundEnd(const SteadyTime now, const double delivery_rate) noexcept;
+		[[nodiscard]] double GetBDP() const noexcept;
+		[[nodiscard]] std::chrono::nanoseconds GetRoundDuration() const noexcept;
+
+	private:
+		static constexpr double StartupGain{ 2.885 };
+		static constexpr double WindowGain{ 2.0 };
+		static constexpr std::array<double, 8> ProbeBandwidthGains{ 1.25, 0.75, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0 };
+		static constexpr double MinWindowSize{ 4.0 };
+		static constexpr Size NumBandwidthRounds{ 10 };
+		static constexpr Size NumStartupRoundsWithoutGrowth{ 3 };
+		static constexpr std::chrono::seconds MinRTTExpiration{ 10 };
+		static constexpr std::chrono::milliseconds ProbeRTTDuration{ 200 };
+
+	private:
+		RTTEstimator m_RTT;
+		State m_State{ State::Startup };
+		double m_PacingGain{ StartupGain };
+		double m_WindowGain{ StartupGain };
+		Size m_ProbeBandwidthGainIndex{ 0 };
+
+		std::array<double, NumBandwidthRounds> m_BandwidthSamples{};
+		Size m_BandwidthSampleIndex{ 0 };
+		double m_BottleneckBandwidth{ 0.0 };
+		double m_StartupBandwidth{ 0.0 };
+		Size m_NumStartupRoundsWithoutGrowth{ 0 };
+
+		std::chrono::nanoseconds m_MinRTT{ 0 };
+		SteadyTime m_MinRTTSteadyTime;
+		SteadyTime m_ProbeRTTDoneSteadyTime;
+
+		std::optional<SteadyTime> m_RoundStartSteadyTime;
+		double m_RoundDelivered{ 0.0 };
+	};
+}
@@ -0,0 +1,116 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#pragma once
+
+#include "..\..\Network\Socket.h"
+
+namespace QuantumGate::Implementation::Core::UDP::Connection
+{
+	// The datagram socket a connection sends and receives on; connections
+	// normally use a real socket, while the unit tests put them on a
+	// simulated network
+	class DatagramIO
+	{
+	public:
+		DatagramIO() noexcept = default;
+		DatagramIO(const DatagramIO&) = delete;
+		DatagramIO(DatagramIO&&) noexcept = delete;
+		virtual ~DatagramIO() = default;
+		DatagramIO& operator=(const DatagramIO&) = delete;
+		DatagramIO& operator=(DatagramIO&&) noexcept = delete;
+
+		[[nodiscard]] virtual bool Open(const Network::AddressFamily af, const bool nat_traversal) = 0;
+		virtual void Close() noexcept = 0;
+
+		[[nodiscard]] virtual Concurrency::Event& GetEvent() noexcept = 0;
+
+		[[nodiscard]] virtual const Network::Socket::IOStatus& GetIOStatus() const noexcept = 0;
+		[[nodiscard]] virtual bool UpdateIOStatus(const std::chrono::milliseconds& mseconds) noexcept = 0;
+
+		[[nodiscard]] virtual const Endpoint& GetLocalEndpoint() const noexcept = 0;
+
+		[[nodiscard]] virtual Result<Size> SendTo(const Endpoint& endpoint, const BufferView& buffer) noexcept = 0;
+		[[nodiscard]] virtual Result<Size> SendToBatch(const Endpoint& endpoint, const Vector<BufferView>& buffers) noexcept = 0;
+		[[nodiscard]] virtual Result<Size> ReceiveFrom(Endpoint& endpoint, BufferSpan& buffer) noexcept = 0;
+
+		[[nodiscard]] virtual bool SetMTUDiscovery(const bool enabled) noexcept = 0;
+
+		[[nodiscard]] virtual const Network::Socket::DatagramStatistics& GetDatagramStatistics() const noexcept = 0;
+	};
+
+	class SocketDatagramIO final : public DatagramIO
+	{
+	public:
+		[[nodiscard]] bool Open(const Network::AddressFamily af, const bool nat_traversal) override
+		{
+			m_Socket = Network::Socket(af, Network::Socket::Type::Datagram, Network::Protocol::UDP);
+
+			return m_Socket.Bind(IPEndpoint(IPEndpoint::Protocol::UDP,
+											(af == Network::AddressFamily::IPv4) ? IPAddress::AnyIPv4() : IPAddress::AnyIPv6(),
+											0), nat_traversal);
+		}
+
+		inline void Close() noexcept override { m_Socket.Close(); }
+
+		[[nodiscard]] inline Concurrency::Event& GetEvent() noexcept override { return m_Socket.GetEvent(); }
+
+		[[nodiscard]] inline const Network::Socket::IOStatus& GetIOStatus() const noexcept override { return m_Socket.GetIOStatus(); }
+
+		[[nodiscard]] inline bool UpdateIOStatus(const std::chrono::milliseconds& mseconds) noexcept override
+		{
+			return m_Socket.UpdateIOStatus(mseconds);
+		}
+
+		[[nodiscard]] inline const Endpoint& GetLocalEndpoint() const noexcept override { return m_Socket.GetLocalEndpoint(); }
+
+		[[nodiscard]] inline Result<Size> SendTo(const Endpoint& endpoint, const BufferView& buffer) noexcept override
+		{
+			return m_Socket.SendTo(endpoint, buffer);
+		}
+
+		[[nodiscard]] inline Result<Size> SendToBatch(const Endpoint& endpoint, const Vector<BufferView>& buffers) noexcept override
+		{
+			return m_Socket.SendToBatch(endpoint, buffers);
+		}
+
+		[[nodiscard]] inline Result<Size> ReceiveFrom(Endpoint& endpoint, BufferSpan& buffer) noexcept override
+		{
+			return m_Socket.ReceiveFrom(endpoint, buffer);
+		}
+
+		[[nodiscard]] inline bool SetMTUDiscovery(const bool enabled) noexcept override { return m_Socket.SetMTUDiscovery(enabled); }
+
+		[[nodiscard]] inline const Network::Socket::DatagramStatistics& GetDatagramStatistics() const noexcept override
+		{
+			return m_Socket.GetDatagramStatistics();
+		}
+
+	private:
+		Network::Socket m_Socket;
+	};
+
+	// Where a connection gets the current time from; the unit
+	// tests run connections on the virtual time of a simulated network
+	class Clock
+	{
+	public:
+		virtual ~Clock() = default;
+
+		[[nodiscard]] virtual SteadyTime GetSteadyTime() const noexcept = 0;
+		[[nodiscard]] virtual SystemTime GetSystemTime() const noexcept = 0;
+	};
+
+	class SystemClock final : public Clock
+	{
+	public:
+		[[nodiscard]] inline SteadyTime GetSteadyTime() const noexcept override { return Util::GetCurrentSteadyTime(); }
+		[[nodiscard]] inline SystemTime GetSystemTime() const noexcept override { return Util::GetCurrentSystemTime(); }
+
+		[[nodiscard]] static const SystemClock& Get() noexcept
+		{
+			static const SystemClock clock;
+			return clock;
+		}
+	};
+}
@@ -223,10 +223,10 @@ namespace QuantumGate::Implementation::Core::UDP
 				return true;
 			}
 
-			// Generate an asymmetric keypair on the fly below (slower
-			// especially for certain algorithms, which introduces delays
-			// in the connection handshake which might result in timeouts)
-			if (Crypto::GenerateAsymmetricKeys(*m_AsymmetricKeys))
+			// Generate an asymmetric keypair on the fly below; UDP connections only
+			// use X25519 keys which are cheap to generate, so unlike for peer handshakes
+			// it's not worth suspending the connection until one has been generated
+			if (keymgr.GenerateAsymmetricKeys(*m_AsymmetricKeys))
 			{
 				m_AsymmetricKeys->SetOwner(owner);
 				return true;
@@ -12,7 +12,7 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 	MTUDiscovery::MTUDiscovery(Connection& connection, const std::chrono::milliseconds max_start_delay) noexcept :
 		m_Connection(connection)
 	{
-		m_StartTime = Util::GetCurrentSteadyTime();
+		m_StartTime = m_Connection.GetClock().GetSteadyTime();
 
 		if (max_start_delay > 0ms)
 		{
@@ -91,7 +91,7 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 				 m_MTUDMessageData->Data.GetSize() << L" bytes on connection " << m_Connection.GetID() <<
 				 L" (" << m_MTUDMessageData->NumTries << L" previous tries)" << SLogFmt(Default));
 #endif
-		const auto now = Util::GetCurrentSteadyTime();
+		const auto now = m_Connection.GetClock().GetSteadyTime();
 
 		const auto result = m_Connection.Send(now, m_MTUDMessageData->Data, nullptr, std::nullopt);
 		if (result.Succeeded())
@@ -154,9 +154,26 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 		return Status::Failed;
 	}
 
+	SteadyTime MTUDiscovery::GetNextProcessSteadyTime() const noexcept
+	{
+		switch (m_Status)
+		{
+			case Status::Start:
+				return m_StartTime + m_StartDelay;
+			case Status::Discovery:
+				// Ack received; next message can be sent right away
+				if (m_MTUDMessageData->Acked) return m_MTUDMessageData->TimeSent;
+
+				return m_MTUDMessageData->TimeSent + m_RetransmissionTimeout;
+			default:
+				// Finished or failed; result needs to be picked up right away
+				return m_StartTime;
+		}
+	}
+
 	MTUDiscovery::Status MTUDiscovery::Process() noexcept
 	{
-		const auto now = Util::GetCurrentSteadyTime();
+		const auto now = m_Connection.GetClock().GetSteadyTime();
 
 		if (m_Status == Status::Start)
 		{
@@ -306,7 +323,7 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 		if (m_Status == Status::Discovery && m_MTUDMessageData->SequenceNumber == seqnum)
 		{
 			m_RetransmissionTimeout = std::max(MinRetransmissionTimeout,
-											   std::chrono::duration_cast<std::chrono::milliseconds>(Util::GetCurrentSteadyTime() - m_MTUDMessageData->TimeSent));
+											   std::chrono::duration_cast<std::chrono::milliseconds>(m_Connection.GetClock().GetSteadyTime() - m_MTUDMessageData->TimeSent));
 			m_MTUDMessageData->Acked = true;
 			m_MaximumMessageSize = m_MTUDMessageData->MaximumMessageSize;
 		}
@@ -326,7 +343,7 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 				SLogInfo(SLogFmt(FGBrightBlue) << L"UDP connection MTUD: sending MTUDAck message on connection " <<
 						 connection.GetID() << SLogFmt(Default));
 #endif
-				const auto result = connection.Send(Util::GetCurrentSteadyTime(), data, nullptr, std::nullopt);
+				const auto result = connection.Send(connection.GetClock().GetSteadyTime(), data, nullptr, std::nullopt);
 				if (result.Failed())
 				{
 					LogErr(L"UDP connection MTUD: failed to send MTUDAck message on connection %llu",
@@ -42,6 +42,7 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 		[[nodiscard]] inline Size GetMaxMessageSize() const noexcept { return m_MaximumMessageSize; }
 
 		[[nodiscard]] Status Process() noexcept;
+		[[nodiscard]] SteadyTime GetNextProcessSteadyTime() const noexcept;
 
 		void ProcessReceivedAck(const Message::SequenceNumber seqnum) noexcept;
 
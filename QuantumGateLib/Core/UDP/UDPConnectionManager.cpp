@@ -84,7 +84,8 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 				{
 					if (m_ThreadPool.AddThread(L"QuantumGate UDP connectionmanager Thread", std::move(thdata),
 											   MakeCallback(this, &Manager::WorkerThreadProcessor),
-											   MakeCallback(this, &Manager::WorkerThreadWait)))
+											   MakeCallback(this, &Manager::WorkerThreadWait),
+											   MakeCallback(this, &Manager::WorkerThreadWaitInterrupt)))
 					{
 						// Add entry for the total number of relay links this thread is handling
 						m_ThreadPool.GetData().ThreadKeyToConnectionTotals.WithUniqueLock([&](auto& con_totals)
@@ -180,35 +181,158 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 
 	void Manager::WorkerThreadWait(ThreadPoolData& thpdata, ThreadData& thdata, const Concurrency::Event& shutdown_event)
 	{
-		const auto result = thdata.WorkEvents->Wait(1ms);
+		// If there are connections with work left over we only wait briefly; otherwise
+		// we can wait until the earliest connection deadline or the next full scan
+		// and rely on the read events to wake us up when there's network activity
+		auto wait_time = std::chrono::milliseconds(1);
+
+		if (thdata.PolledConnections.empty() && !thdata.NeedsFullScan)
+		{
+			const auto current_steadytime = Util::GetCurrentSteadyTime();
+
+			auto wakeup_steadytime = thdata.LastFullScanSteadyTime + FullScanInterval;
+
+			if (const auto next_expiry = thdata.ConnectionTimers.GetNextExpiry(); next_expiry.has_value())
+			{
+				wakeup_steadytime = std::min(wakeup_steadytime, *next_expiry);
+			}
+
+			if (wakeup_steadytime > current_steadytime)
+			{
+				wait_time = std::max(std::chrono::milliseconds(1),
+									 std::chrono::ceil<std::chrono::milliseconds>(wakeup_steadytime - current_steadytime));
+			}
+		}
+
+		const auto result = thdata.WorkEvents->Wait(wait_time, thdata.ReadyConnections);
 		if (!result.Waited)
 		{
 			shutdown_event.Wait(1ms);
 		}
+		else if (result.Overflow)
+		{
+			// Readiness information was lost
+			thdata.NeedsFullScan = true;
+		}
+	}
+
+	void Manager::WorkerThreadWaitInterrupt(ThreadPoolData& thpdata, ThreadData& thdata)
+	{
+		thdata.WorkEvents->Interrupt();
 	}
 
 	void Manager::WorkerThreadProcessor(ThreadPoolData& thpdata, ThreadData& thdata, const Concurrency::Event& shutdown_event)
 	{
+		const auto wakeup_steadytime = Util::GetCurrentSteadyTime();
+
+		auto full_scan = thdata.NeedsFullScan ||
+			((wakeup_steadytime - thdata.LastFullScanSteadyTime) >= FullScanInterval);
+
+		// Connections whose deadline has passed
+		thdata.VisitConnections.clear();
+		if (!thdata.ConnectionTimers.Expire(wakeup_steadytime, thdata.VisitConnections))
+		{
+			// Couldn't collect all expired timers
+			full_scan = true;
+		}
+
+		if (!full_scan)
+		{
+			// Besides the connections with expired timers only connections whose read
+			// event got signaled and the ones with work left over get visited
+			try
+			{
+				thdata.VisitConnections.insert(thdata.VisitConnections.end(),
+											   thdata.ReadyConnections.begin(), thdata.ReadyConnections.end());
+				thdata.VisitConnections.insert(thdata.VisitConnections.end(),
+											   thdata.PolledConnections.begin(), thdata.PolledConnections.end());
+			}
+			catch (...)
+			{
+				full_scan = true;
+			}
+
+			if (!full_scan)
+			{
+				if (thdata.VisitConnections.empty()) return;
+
+				// Connections may be in more than one of the above
+				std::sort(thdata.VisitConnections.begin(), thdata.VisitConnections.end());
+				thdata.VisitConnections.erase(std::unique(thdata.VisitConnections.begin(), thdata.VisitConnections.end()),
+											  thdata.VisitConnections.end());
+			}
+		}
+
+		thdata.PolledConnections.clear();
+
 		std::optional<Containers::List<ConnectionID>> remove_list;
 
 		auto connections = thdata.Connections->WithUniqueLock();
-		for (auto it = connections->begin(); it != connections->end() && !shutdown_event.IsSet(); ++it)
+
+		const auto process_connection = [&](Connection& connection)
 		{
 			// Placed in the loop to have the latest time for each connection
 			const auto current_steadytime = Util::GetCurrentSteadyTime();
 			const auto current_systemtime = Util::GetCurrentSystemTime();
 
-			auto& connection = it->second;
-
 			connection.ProcessEvents(current_steadytime, current_systemtime);
+			connection.AddDatagramStatistics(m_DatagramStatistics);
 
 			if (connection.ShouldClose())
 			{
+				thdata.ConnectionTimers.Cancel(connection.GetID());
+
 				// Collect the connection for removal
 				if (!remove_list.has_value()) remove_list.emplace();
 
 				remove_list->emplace_back(connection.GetID());
 			}
+			else
+			{
+				if (connection.HasDeferredWork())
+				{
+					try
+					{
+						thdata.PolledConnections.emplace_back(connection.GetID());
+					}
+					catch (...)
+					{
+						thdata.NeedsFullScan = true;
+					}
+				}
+
+				if (const auto deadline = connection.GetNextDeadline(); deadline.has_value())
+				{
+					// Most deadline checks are exclusive so we schedule one tick later
+					if (!thdata.ConnectionTimers.Schedule(connection.GetID(), *deadline + 1ms))
+					{
+						thdata.NeedsFullScan = true;
+					}
+				}
+				else thdata.ConnectionTimers.Cancel(connection.GetID());
+			}
+		};
+
+		if (full_scan)
+		{
+			for (auto it = connections->begin(); it != connections->end() && !shutdown_event.IsSet(); ++it)
+			{
+				process_connection(it->second);
+			}
+
+			thdata.NeedsFullScan = false;
+			thdata.LastFullScanSteadyTime = Util::GetCurrentSteadyTime();
+		}
+		else
+		{
+			for (auto it = thdata.VisitConnections.begin(); it != thdata.VisitConnections.end() && !shutdown_event.IsSet(); ++it)
+			{
+				// Connection may have been removed in the mean time
+				if (const auto cit = connections->find(*it); cit != connections->end())
+				{
+					process_connection(cit->second);
+				}
+			}
 		}
 
 		// Remove all connections that were collected for removal
@@ -289,12 +413,15 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 					}
 				});
 
-				if (!thread->GetData().WorkEvents->AddEvent(cit->second.GetReadEvent()))
+				if (!thread->GetData().WorkEvents->Add(cit->second.GetReadEvent().GetHandle(), id))
 				{
 					LogErr(L"Couldn't add new UDP connection; failed to add read event");
 					return false;
 				}
 
+				// Make sure the connection gets processed so that its timer gets set
+				thread->GetData().WorkEvents->Notify(id);
+
 				sg1.Deactivate();
 				sg2.Deactivate();
 
@@ -309,14 +436,16 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 		return false;
 	}
 
-	void Manager::RemoveConnection(const ConnectionID id, ConnectionMap& connections, const ThreadData& thdata) noexcept
+	void Manager::RemoveConnection(const ConnectionID id, ConnectionMap& connections, ThreadData& thdata) noexcept
 	{
 		const auto it = connections.find(id);
 		if (it != connections.end())
 		{
-			thdata.WorkEvents->RemoveEvent(it->second.GetReadEvent());
+			thdata.WorkEvents->Remove(it->second.GetReadEvent().GetHandle());
+			thdata.ConnectionTimers.Cancel(id);
 
 			it->second.Close();
+			it->second.AddDatagramStatistics(m_DatagramStatistics);
 
 			connections.erase(it);
 
@@ -332,7 +461,7 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 	}
 
 	void Manager::RemoveConnections(const Containers::List<ConnectionID>& list, ConnectionMap& connections,
-									const ThreadData& thdata) noexcept
+									ThreadData& thdata) noexcept
 	{
 		for (const auto id : list)
 		{
@@ -383,12 +512,20 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 			for (auto& connection : *connections)
 			{
 				connection.second.OnLocalIPInterfaceChanged();
+
+				// Deadlines changed (MTU discovery restarts)
+				thread->GetData().WorkEvents->Notify(connection.first);
 			}
 
 			thread = m_ThreadPool.GetNextThread(*thread);
 		}
 	}
 
+	Manager::Statistics Manager::GetStatistics() const noexcept
+	{
+		return Statistics{ .Datagrams = m_DatagramStatistics.Get() };
+	}
+
 	Manager::AddQueryCode Manager::QueryAddConnection(const ConnectionID id, const IPEndpoint& pendpoint,
 													  const PeerConnectionType type) const noexcept
 	{
@@ -5,7 +5,8 @@
 
 #include "UDPConnection.h"
 #include "..\..\Concurrency\ThreadPool.h"
-#include "..\..\Concurrency\EventGroup.h"
+#include "..\..\Concurrency\Reactor.h"
+#include "..\..\Concurrency\TimerWheel.h"
 
 namespace QuantumGate::Implementation::Core::UDP::Listener
 {
@@ -28,13 +29,23 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 		{
 			explicit ThreadData(const ThreadKey thread_key) noexcept :
 				ThreadKey(thread_key),
-				WorkEvents(std::make_unique<Concurrency::EventGroup>()),
+				WorkEvents(std::make_unique<Concurrency::Reactor>()),
 				Connections(std::make_unique<ConnectionMap_ThS>())
 			{}
 
 			ThreadKey ThreadKey{ 0 };
-			std::unique_ptr<Concurrency::EventGroup> WorkEvents;
+			std::unique_ptr<Concurrency::Reactor> WorkEvents;
+			Concurrency::Reactor::ReadyKeys ReadyConnections;
 			std::unique_ptr<ConnectionMap_ThS> Connections;
+
+			// Only accessed by the worker thread; PolledConnections are connections
+			// with work left over that need to be looked at again on the next wakeup,
+			// and ConnectionTimers has the next deadline for each connection
+			Vector<ConnectionID> PolledConnections;
+			Vector<ConnectionID> VisitConnections;
+			Concurrency::TimerWheel<ConnectionID> ConnectionTimers;
+			SteadyTime LastFullScanSteadyTime;
+			bool NeedsFullScan{ true };
 		};
 
 		struct ThreadPoolData final
@@ -45,7 +56,16 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 
 		using ThreadPool = Concurrency::ThreadPool<ThreadPoolData, ThreadData>;
 
+		// Interval at which all connections of a thread get looked at regardless
+		// of whether their read event got signaled or a timer expired, as a safety net
+		static constexpr std::chrono::seconds FullScanInterval{ 5 };
+
 	public:
+		struct Statistics final
+		{
+			Network::Socket::DatagramStatistics Datagrams;
+		};
+
 		enum class AddQueryCode
 		{
 			OK,
@@ -79,6 +99,8 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 
 		void OnLocalIPInterfaceChanged() noexcept;
 
+		Statistics GetStatistics() const noexcept;
+
 	private:
 		[[nodiscard]] inline const Settings& GetSettings() const noexcept { return m_Settings.GetCache(); }
 
@@ -91,14 +113,15 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 		std::optional<ThreadKey> GetThreadKeyWithLeastConnections() const noexcept;
 		[[nodiscard]] std::optional<ThreadPool::ThreadType> GetThreadWithLeastConnections() noexcept;
 
-		void RemoveConnection(const ConnectionID id, ConnectionMap& connections, const ThreadData& thdata) noexcept;
+		void RemoveConnection(const ConnectionID id, ConnectionMap& connections, ThreadData& thdata) noexcept;
 		void RemoveConnections(const Containers::List<ConnectionID>& list, ConnectionMap& connections,
-							   const ThreadData& thdata) noexcept;
+							   ThreadData& thdata) noexcept;
 
 		[[nodiscard]] bool IncrementThreadConnectionTotal(const ThreadKey key) noexcept;
 		[[nodiscard]] bool DecrementThreadConnectionTotal(const ThreadKey key) noexcept;
 
 		void WorkerThreadWait(ThreadPoolData& thpdata, ThreadData& thdata, const Concurrency::Event& shutdown_event);
+		void WorkerThreadWaitInterrupt(ThreadPoolData& thpdata, ThreadData& thdata);
 		void WorkerThreadProcessor(ThreadPoolData& thpdata, ThreadData& thdata, const Concurrency::Event& shutdown_event);
 
 	private:
@@ -109,5 +132,8 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 		std::atomic_bool m_Running{ false };
 		
 		ThreadPool m_ThreadPool;
+
+		// Datagrams sent and received by all connections
+		Network::Socket::DatagramStatisticsTotals m_DatagramStatistics;
 	};
 }
\ No newline at end of file
@@ -7,9 +7,14 @@
 
 namespace QuantumGate::Implementation::Core::UDP::Connection
 {
-	SendQueue::SendQueue(Connection& connection) noexcept : m_Connection(connection)
+	SendQueue::SendQueue(Connection& connection) : m_Connection(connection)
 	{
+		const auto& settings = m_Connection.GetSettings();
+		m_CongestionController = CongestionController::Create(settings.Local.UDP.CongestionControl);
+		m_Pacing = settings.Local.UDP.Pacing;
+
 		m_NextSendSequenceNumber = static_cast<Message::SequenceNumber>(Random::GetPseudoRandomNumber());
+		m_Queue.Reset(m_NextSendSequenceNumber);
 	}
 
 	void SendQueue::SetMaxMessageSize(const Size size) noexcept
@@ -35,103 +40,258 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 
 	bool SendQueue::Add(Item&& item) noexcept
 	{
-		try
-		{
-			auto& qitem = m_Queue.emplace_back(std::move(item));
+		assert(item.SequenceNumber == m_NextSendSequenceNumber);
 
-			m_NumBytesInQueue += qitem.Data.GetSize();
+		const auto [qitem, inserted] = m_Queue.Emplace(item.SequenceNumber, std::move(item));
+		if (qitem == nullptr || !inserted)
+		{
+			LogErr(L"UDP connection: could not add message with sequence number %u to send queue for connection %llu",
+				   item.SequenceNumber, m_Connection.GetID());
+			return false;
+		}
 
-			m_NextSendSequenceNumber = Message::GetNextSequenceNumber(m_NextSendSequenceNumber);
+		m_NumBytesInQueue += qitem->Data.GetSize();
 
-			const auto result = m_Connection.Send(qitem.TimeSent, qitem.Data, qitem.ListenerSendQueue, qitem.PeerEndpoint);
-			if (result.Succeeded()) qitem.NumTries = 1;
+		m_NextSendSequenceNumber = Message::GetNextSequenceNumber(m_NextSendSequenceNumber);
 
-			return true;
+		// If sending has to wait for the pacing rate
+		// the item gets sent when the queue is processed
+		if (CanSendPaced(qitem->TimeSent))
+		{
+			const auto result = m_Connection.Send(qitem->TimeSent, qitem->Data, qitem->ListenerSendQueue, qitem->PeerEndpoint);
+			if (result.Succeeded())
+			{
+				qitem->NumTries = 1;
+				RecordPacedSend(qitem->TimeSent, qitem->Data.GetSize());
+			}
 		}
-		catch (...) {}
 
-		return false;
+		return true;
 	}
 
 	bool SendQueue::Process() noexcept
 	{
-		if (m_Queue.empty()) return true;
+		if (m_Queue.IsEmpty()) return true;
 
-		const auto rtt_timeout = std::invoke([&]()
-		{
-			return (m_Connection.GetStatus() < Status::Connected) ?
-				m_Connection.GetSettings().UDP.ConnectRetransmissionTimeout :
-				m_Statistics.GetRetransmissionTimeout();
-		});
+		const auto rtt_timeout = GetRetransmissionTimeout();
 
 #ifdef UDPSND_DEBUG
 		Size loss_num{ 0 };
 #endif	
 		Size loss_bytes{ 0 };
 
-		const auto now = Util::GetCurrentSteadyTime();
+		const auto now = m_Connection.GetClock().GetSteadyTime();
 
-		for (auto it = m_Queue.begin(); it != m_Queue.end(); ++it)
+		auto result = SendResult::Sent;
+
+		// Bytes collected in the batch that haven't been sent yet
+		Size batch_bytes{ 0 };
+
+		m_Queue.ForEach([&](Item& item) noexcept
 		{
-			if (it->NumTries == 0 || (now - it->TimeResent >= rtt_timeout * it->NumTries))
+			// Items that were acked out of order stay in the queue
+			// until the ones before them are acked as well
+			if (item.Acked) return true;
+
+			if (item.NumTries == 0 || (now - item.TimeResent >= rtt_timeout * item.NumTries))
 			{
-				if (it->NumTries > 0)
+				// The rest gets sent when the pacing rate allows; the sends
+				// get recorded once they succeed, so the items that were
+				// already collected in the batch have to be counted as well
+				if (!CanSendPaced(now, batch_bytes)) return false;
+
+				if (item.NumTries > 0)
 				{
 #ifdef UDPSND_DEBUG
-					SLogInfo(SLogFmt(FGBrightCyan) << L"UDP connection: retransmitting (" << it->NumTries <<
-							 ") message with sequence number " <<  it->SequenceNumber << L" (timeout " <<
-							 std::chrono::duration_cast<std::chrono::milliseconds>(rtt_timeout).count() * it->NumTries <<
+					SLogInfo(SLogFmt(FGBrightCyan) << L"UDP connection: retransmitting (" << item.NumTries <<
+							 ") message with sequence number " <<  item.SequenceNumber << L" (timeout " <<
+							 std::chrono::duration_cast<std::chrono::milliseconds>(rtt_timeout).count() * item.NumTries <<
 							 L"ms) for connection " << m_Connection.GetID() << SLogFmt(Default));
 
 					++loss_num;
 #endif	
-					loss_bytes += it->Data.GetSize();
+					loss_bytes += item.Data.GetSize();
 				}
 
-				const auto result = m_Connection.Send(now, it->Data, it->ListenerSendQueue, it->PeerEndpoint);
-				if (result.Succeeded())
+				// Items that go directly on the socket to the same endpoint get
+				// collected and sent together; others get sent one at a time
+				if (!item.ListenerSendQueue)
 				{
-					// If data was actually sent, otherwise buffer may
-					// temporarily be full/unavailable
-					if (*result == it->Data.GetSize())
+					if (!m_SendBatchItems.empty() &&
+						(m_SendBatchItems.front()->PeerEndpoint != item.PeerEndpoint ||
+						 m_SendBatchItems.size() == Network::Socket::MaxDatagramBatchSize))
 					{
-						// We'll wait for ack or else continue sending
-						it->TimeResent = Util::GetCurrentSteadyTime();
-						++it->NumTries;
+						result = SendBatch(now);
+						if (result != SendResult::Sent) return false;
+
+						batch_bytes = 0;
 					}
-					else
+
+					try
 					{
-						// We'll try again later
-						break;
+						m_SendBatchItems.emplace_back(&item);
+						m_SendBatch.emplace_back(item.Data);
+						batch_bytes += item.Data.GetSize();
+						return true;
+					}
+					catch (...)
+					{
+						// Send it on its own instead
+						if (m_SendBatchItems.size() > m_SendBatch.size()) m_SendBatchItems.pop_back();
 					}
 				}
-				else
+
+				result = SendBatch(now);
+				if (result == SendResult::Sent)
 				{
-					LogErr(L"UDP connection: send failed on connection %llu (%s)",
-						   m_Connection.GetID(), result.GetErrorString().c_str());
-					return false;
+					batch_bytes = 0;
+					result = SendItem(item, now);
 				}
 			}
-		}
 
-		m_Statistics.RecordMTULoss(static_cast<double>(loss_bytes) / static_cast<double>(GetMaxMessageSize()));
-		m_Statistics.RecordMTUWindowSizeStats();
+			return (result == SendResult::Sent);
+		});
+
+		if (result == SendResult::Sent) result = SendBatch(now);
+
+		m_SendBatchItems.clear();
+		m_SendBatch.clear();
+
+		if (result == SendResult::Failed) return false;
+
+		m_CongestionController->RecordMTULoss(static_cast<double>(loss_bytes) / static_cast<double>(GetMaxMessageSize()), now);
+		m_CongestionController->RecordMTUWindowSizeStats(now);
 
 #ifdef UDPSND_DEBUG
 		if (loss_num > 0)
 		{
 			SLogWarn(SLogFmt(FGBrightCyan) << L"UDP connection: retransmitted " << loss_num <<
-					 " items (" <<  loss_bytes << L" bytes), queue size " << m_Queue.size() << L", MTU window size " <<
-					 m_Statistics.GetMTUWindowSize() << L" (" << GetSendWindowByteSize() << L" bytes), RTT " <<
-					 m_Statistics.GetRetransmissionTimeout().count() << L"ms" << SLogFmt(Default));
+					 " items (" <<  loss_bytes << L" bytes), queue size " << m_Queue.GetSize() << L", MTU window size " <<
+					 m_CongestionController->GetMTUWindowSize() << L" (" << GetSendWindowByteSize() << L" bytes), RTT " <<
+					 m_CongestionController->GetRetransmissionTimeout().count() << L"ms" << SLogFmt(Default));
 		}
 #endif
 		return true;
 	}
 
+	SendQueue::SendResult SendQueue::SendItem(Item& item, const SteadyTime now) noexcept
+	{
+		const auto result = m_Connection.Send(now, item.Data, item.ListenerSendQueue, item.PeerEndpoint);
+		if (result.Succeeded())
+		{
+			// If data was actually sent, otherwise buffer may
+			// temporarily be full/unavailable
+			if (*result == item.Data.GetSize())
+			{
+				// We'll wait for ack or else continue sending
+				item.TimeResent = m_Connection.GetClock().GetSteadyTime();
+
+				// Time spent waiting for the pacing rate
+				// shouldn't count towards the RTT
+				if (item.NumTries == 0) item.TimeSent = item.TimeResent;
+
+				++item.NumTries;
+
+				RecordPacedSend(now, item.Data.GetSize());
+
+				return SendResult::Sent;
+			}
+
+			// We'll try again later
+			return SendResult::TryAgainLater;
+		}
+
+		LogErr(L"UDP connection: send failed on connection %llu (%s)",
+			   m_Connection.GetID(), result.GetErrorString().c_str());
+
+		return SendResult::Failed;
+	}
+
+	SendQueue::SendResult SendQueue::SendBatch(const SteadyTime now) noexcept
+	{
+		assert(m_SendBatchItems.size() == m_SendBatch.size());
+
+		while (!m_SendBatch.empty())
+		{
+			const auto result = m_Connection.SendBatch(now, m_SendBatch, m_SendBatchItems.front()->PeerEndpoint);
+			if (result.Succeeded())
+			{
+				// If data was actually sent, otherwise buffer may
+				// temporarily be full/unavailable
+				if (*result == 0) return SendResult::TryAgainLater;
+
+				assert(*result <= m_SendBatch.size());
+
+				const auto sent_time = m_Connection.GetClock().GetSteadyTime();
+
+				// We'll wait for ack or else continue sending
+				for (Size x = 0; x < *result; ++x)
+				{
+					m_SendBatchItems[x]->TimeResent = sent_time;
+					if (m_SendBatchItems[x]->NumTries == 0) m_SendBatchItems[x]->TimeSent = sent_time;
+					++m_SendBatchItems[x]->NumTries;
+
+					RecordPacedSend(now, m_SendBatch[x].GetSize());
+				}
+
+				m_SendBatchItems.erase(m_SendBatchItems.begin(), m_SendBatchItems.begin() + *result);
+				m_SendBatch.erase(m_SendBatch.begin(), m_SendBatch.begin() + *result);
+			}
+			else
+			{
+				LogErr(L"UDP connection: send failed on connection %llu (%s)",
+					   m_Connection.GetID(), result.GetErrorString().c_str());
+
+				return SendResult::Failed;
+			}
+		}
+
+		return SendResult::Sent;
+	}
+
+	std::optional<SteadyTime> SendQueue::GetNextProcessSteadyTime() noexcept
+	{
+		if (m_Queue.IsEmpty()) return std::nullopt;
+
+		const auto rtt_timeout = GetRetransmissionTimeout();
+
+		std::optional<SteadyTime> next_steadytime;
+
+		m_Queue.ForEach([&](const Item& item) noexcept
+		{
+			if (item.Acked) return true;
+
+			// Items that couldn't be sent yet need to be tried again right away
+			const auto steadytime = (item.NumTries == 0) ? item.TimeSent :
+				item.TimeResent + std::chrono::duration_cast<SteadyTime::duration>(rtt_timeout * item.NumTries);
+
+			if (!next_steadytime.has_value() || steadytime < *next_steadytime)
+			{
+				next_steadytime = steadytime;
+			}
+
+			return true;
+		});
+
+		// Items can't be sent before the pacing rate allows
+		if (next_steadytime.has_value() && m_Pacing && m_Connection.GetStatus() == Status::Connected)
+		{
+			next_steadytime = std::max(*next_steadytime, m_NextPacedSendSteadyTime - PacingQuantum);
+		}
+
+		return next_steadytime;
+	}
+
+	std::chrono::nanoseconds SendQueue::GetRetransmissionTimeout() noexcept
+	{
+		return (m_Connection.GetStatus() < Status::Connected) ?
+			m_Connection.GetSettings().UDP.ConnectRetransmissionTimeout :
+			m_CongestionController->GetRetransmissionTimeout();
+	}
+
 	Size SendQueue::GetAvailableSendWindowByteSize() noexcept
 	{
-		if (m_Queue.size() >= m_PeerReceiveWindowItemSize) return 0;
+		if (m_Queue.GetSize() >= m_PeerReceiveWindowItemSize) return 0;
 
 		const auto send_wnd_size = GetSendWindowByteSize();
 		if (send_wnd_size > m_NumBytesInQueue)
@@ -147,36 +307,31 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 
 		m_LastInSequenceAckedSequenceNumber = seqnum;
 
-		auto it = std::find_if(m_Queue.begin(), m_Queue.end(), [&](const auto& itm)
+		if (m_Queue.Get(seqnum) != nullptr)
 		{
-			return (itm.SequenceNumber == seqnum);
-		});
-
-		if (it != m_Queue.end())
-		{
-			const auto now = Util::GetCurrentSteadyTime();
+			const auto now = m_Connection.GetClock().GetSteadyTime();
 
 			auto purge_acked{ false };
 			Size num_bytes{ 0 };
 
-			for (auto it2 = m_Queue.begin();;)
+			// All items up to and including the acked one
+			m_Queue.ForEach([&](Item& item) noexcept
 			{
-				if (it2->NumTries > 0)
+				if (item.NumTries > 0)
 				{
-					if (!it2->Acked)
+					if (!item.Acked)
 					{
-						AckItem(*it2, now);
+						AckItem(item, now);
 
-						num_bytes += it2->Data.GetSize();
+						num_bytes += item.Data.GetSize();
 						purge_acked = true;
 					}
 				}
 
-				if (it2->SequenceNumber == it->SequenceNumber) break;
-				else ++it2;
-			}
+				return (item.SequenceNumber != seqnum);
+			});
 
-			m_Statistics.RecordMTUAck(static_cast<double>(num_bytes) / static_cast<double>(GetMaxMessageSize()));
+			m_CongestionController->RecordMTUAck(static_cast<double>(num_bytes) / static_cast<double>(GetMaxMessageSize()), now);
 
 			if (purge_acked)
 			{
@@ -187,31 +342,29 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 
 	void SendQueue::ProcessReceivedAcks(const Vector<Message::AckRange>& ack_ranges) noexcept
 	{
-		const auto now = Util::GetCurrentSteadyTime();
+		const auto now = m_Connection.GetClock().GetSteadyTime();
 
 		auto purge_acked{ false };
 		Size num_bytes{ 0 };
 
+		// Only the part of each range that overlaps with the items
+		// in flight gets visited; each item is found by its index
 		for (const auto& ack_range : ack_ranges)
 		{
-			for (auto seqnum = ack_range.Begin; seqnum <= ack_range.End;)
+			m_Queue.ForEachInRange(ack_range.Begin, ack_range.End, [&](Item& item) noexcept
 			{
-				const auto [acked, msg_size] = AckSentMessage(seqnum, now);
+				const auto [acked, msg_size] = AckSentMessage(item, now);
 				if (acked)
 				{
 					num_bytes += msg_size;
 					purge_acked = true;
 				}
 
-				if (seqnum < std::numeric_limits<Message::SequenceNumber>::max())
-				{
-					++seqnum;
-				}
-				else break;
-			}
+				return true;
+			});
 		}
 
-		m_Statistics.RecordMTUAck(static_cast<double>(num_bytes) / static_cast<double>(GetMaxMessageSize()));
+		m_CongestionController->RecordMTUAck(static_cast<double>(num_bytes) / static_cast<double>(GetMaxMessageSize()), now);
 
 		if (purge_acked)
 		{
@@ -228,21 +381,22 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 		// retransmitted as per Karn's Algorithm
 		if (item.NumTries == 1)
 		{
-			m_Statistics.RecordRTT(std::chrono::duration_cast<std::chrono::nanoseconds>(item.TimeAcked - item.TimeSent));
+			m_CongestionController->RecordRTT(std::chrono::duration_cast<std::chrono::nanoseconds>(item.TimeAcked - item.TimeSent), now);
 		}
 	}
 
 	void SendQueue::PurgeAcked() noexcept
 	{
-		// Remove all acked messages from the front of the list
+		// Remove all acked messages from the front of the window
 		// to make room for new messages in the send window
-		for (auto it = m_Queue.begin(); it != m_Queue.end();)
+		while (m_Queue.GetSpan() > 0)
 		{
-			if (it->Acked)
+			const auto item = m_Queue.GetFront();
+			if (item == nullptr || item->Acked)
 			{
-				m_NumBytesInQueue -= it->Data.GetSize();
-				
-				it = m_Queue.erase(it);
+				if (item != nullptr) m_NumBytesInQueue -= item->Data.GetSize();
+
+				m_Queue.PopFront();
 			}
 			else break;
 		}
@@ -250,28 +404,20 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 
 	void SendQueue::Reset() noexcept
 	{
-		m_Queue.clear();
+		m_Queue.Reset(m_NextSendSequenceNumber);
 		m_NumBytesInQueue = 0;
 	}
 
-	std::pair<bool, Size> SendQueue::AckSentMessage(const Message::SequenceNumber seqnum, const SteadyTime& now) noexcept
+	std::pair<bool, Size> SendQueue::AckSentMessage(Item& item, const SteadyTime& now) noexcept
 	{
-		auto it = std::find_if(m_Queue.begin(), m_Queue.end(), [&](const auto& itm)
-		{
-			return (itm.SequenceNumber == seqnum);
-		});
+		Dbg(L"UDP connection: received ack for message with seq# %u for connection %llu",
+			item.SequenceNumber, m_Connection.GetID());
 
-		if (it != m_Queue.end())
+		if (!item.Acked)
 		{
-			Dbg(L"UDP connection: received ack for message with seq# %u for connection %llu",
-				seqnum, m_Connection.GetID());
+			AckItem(item, now);
 
-			if (!it->Acked)
-			{
-				AckItem(*it, now);
-
-				return std::make_pair(true, it->Data.GetSize());
-			}
+			return std::make_pair(true, item.Data.GetSize());
 		}
 
 		return std::make_pair(false, 0);
@@ -291,6 +437,32 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 
 	Size SendQueue::GetSendWindowByteSize() noexcept
 	{
-		return std::min(m_Statistics.GetMTUWindowSize() * GetMaxMessageSize(), m_PeerAdvReceiveWindowByteSize);
+		return std::min(m_CongestionController->GetMTUWindowSize() * GetMaxMessageSize(), m_PeerAdvReceiveWindowByteSize);
+	}
+
+	bool SendQueue::CanSendPaced(const SteadyTime now, const Size num_pending_bytes) const noexcept
+	{
+		// No pacing during the handshake, when there's no RTT yet
+		if (!m_Pacing || m_Connection.GetStatus() != Status::Connected) return true;
+
+		return (GetNextPacedSendSteadyTime(now, num_pending_bytes) <= now + PacingQuantum);
+	}
+
+	SteadyTime SendQueue::GetNextPacedSendSteadyTime(const SteadyTime now, const Size num_bytes) const noexcept
+	{
+		const auto rate = m_CongestionController->GetPacingRate() * static_cast<double>(GetMaxMessageSize());
+		if (rate <= 0.0) return m_NextPacedSendSteadyTime;
+
+		const auto interval = std::chrono::duration_cast<SteadyTime::duration>(
+			std::chrono::duration<double>(static_cast<double>(num_bytes) / rate));
+
+		return std::max(m_NextPacedSendSteadyTime, now - MaxPacingCatchUp) + interval;
+	}
+
+	void SendQueue::RecordPacedSend(const SteadyTime now, const Size num_bytes) noexcept
+	{
+		if (!m_Pacing || m_Connection.GetStatus() != Status::Connected) return;
+
+		m_NextPacedSendSteadyTime = GetNextPacedSendSteadyTime(now, num_bytes);
 	}
 }
\ No newline at end of file
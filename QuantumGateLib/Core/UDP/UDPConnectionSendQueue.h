@@ -4,6 +4,8 @@
 #pragma once
 
 #include "UDPConnectionMTUD.h"
+#include "UDPConnectionSequenceWindow.h"
+#include "UDPConnectionCongestionControl.h"
 
 // Use to enable/disable debug console output
 // #define UDPSND_DEBUG
@@ -29,7 +31,7 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 			SteadyTime TimeAcked;
 		};
 
-		SendQueue(Connection& connection) noexcept;
+		SendQueue(Connection& connection);
 		SendQueue(const SendQueue&) = delete;
 		SendQueue(SendQueue&&) noexcept = delete;
 		~SendQueue() = default;
@@ -42,6 +44,7 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 		[[nodiscard]] bool Add(Item&& item) noexcept;
 
 		[[nodiscard]] bool Process() noexcept;
+		[[nodiscard]] std::optional<SteadyTime> GetNextProcessSteadyTime() noexcept;
 
 		void Reset() noexcept;
 
@@ -55,19 +58,47 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 
 	private:
 		void AckItem(Item& item, const SteadyTime& now) noexcept;
-		[[nodiscard]] std::pair<bool, Size> AckSentMessage(const Message::SequenceNumber seqnum, const SteadyTime& now) noexcept;
+		[[nodiscard]] std::pair<bool, Size> AckSentMessage(Item& item, const SteadyTime& now) noexcept;
 		void PurgeAcked() noexcept;
 
+		[[nodiscard]] std::chrono::nanoseconds GetRetransmissionTimeout() noexcept;
+
+		enum class SendResult { Sent, TryAgainLater, Failed };
+
+		[[nodiscard]] SendResult SendItem(Item& item, const SteadyTime now) noexcept;
+		[[nodiscard]] SendResult SendBatch(const SteadyTime now) noexcept;
+
 		void RecalcPeerReceiveWindowSize() noexcept;
 		[[nodiscard]] Size GetSendWindowByteSize() noexcept;
 
+		[[nodiscard]] bool CanSendPaced(const SteadyTime now, const Size num_pending_bytes = 0) const noexcept;
+		[[nodiscard]] SteadyTime GetNextPacedSendSteadyTime(const SteadyTime now, const Size num_bytes) const noexcept;
+		void RecordPacedSend(const SteadyTime now, const Size num_bytes) noexcept;
+
 	private:
-		using Queue = Containers::List<Item>;
+		// Items in flight are indexed by their sequence number so that
+		// acks can be processed without searching for the items
+		using Queue = SequenceWindow<Item>;
+
+		// Sending may get ahead of the pacing rate by this much to make up
+		// for the granularity of the timers that the connections wait on
+		static constexpr std::chrono::milliseconds PacingQuantum{ 1 };
+
+		// Sending that falls behind the pacing rate (for example when the connection
+		// didn't get processed in time) may catch up by at most this much
+		static constexpr std::chrono::milliseconds MaxPacingCatchUp{ 10 };
 
 		Connection& m_Connection;
 		Size m_NumBytesInQueue{ 0 };
 		Queue m_Queue;
-		Statistics m_Statistics;
+		std::unique_ptr<CongestionController> m_CongestionController;
+		bool m_Pacing{ false };
+		SteadyTime m_NextPacedSendSteadyTime;
+
+		// Items that get sent directly on the socket are collected
+		// here so that they can be sent with as few calls as possible
+		Vector<Item*> m_SendBatchItems;
+		Vector<BufferView> m_SendBatch;
 
 		Message::SequenceNumber m_NextSendSequenceNumber{ 0 };
 		Message::SequenceNumber m_LastInSequenceAckedSequenceNumber{ 0 };
@@ -0,0 +1,239 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#pragma once
+
+#include "UDPMessage.h"
+
+namespace QuantumGate::Implementation::Core::UDP::Connection
+{
+	// Items indexed by their sequence number in a ring of slots, so that finding, adding
+	// and removing items takes constant time regardless of the size of the window. The
+	// window begins at the base sequence number and spans up to and including the slot of
+	// the last sequence number that was added; slots in between can be empty, for example
+	// for messages that arrived out of order.
+	template<typename T>
+	class SequenceWindow final
+	{
+		using SequenceNumber = Message::SequenceNumber;
+		using Slots = Vector<std::optional<T>>;
+
+		static constexpr Size MinCapacity{ 16 };
+
+	public:
+		// The window can't span more than half of all sequence numbers since
+		// older and newer sequence numbers couldn't be told apart otherwise
+		static constexpr Size MaxCapacity{ (Size{ std::numeric_limits<SequenceNumber>::max() } + 1) / 2 };
+
+		SequenceWindow() noexcept = default;
+		SequenceWindow(const SequenceWindow&) = delete;
+		SequenceWindow(SequenceWindow&&) noexcept = default;
+		~SequenceWindow() = default;
+		SequenceWindow& operator=(const SequenceWindow&) = delete;
+		SequenceWindow& operator=(SequenceWindow&&) noexcept = default;
+
+		[[nodiscard]] inline SequenceNumber GetBaseSequenceNumber() const noexcept { return m_BaseSequenceNumber; }
+
+		// Number of items in the window
+		[[nodiscard]] inline Size GetSize() const noexcept { return m_Size; }
+		[[nodiscard]] inline bool IsEmpty() const noexcept { return (m_Size == 0); }
+
+		// Number of slots from the base up to and including the last item
+		[[nodiscard]] inline Size GetSpan() const noexcept { return m_Span; }
+
+		[[nodiscard]] inline Size GetCapacity() const noexcept { return m_Slots.size(); }
+
+		[[nodiscard]] inline Size GetOffset(const SequenceNumber seqnum) const noexcept
+		{
+			return static_cast<SequenceNumber>(seqnum - m_BaseSequenceNumber);
+		}
+
+		[[nodiscard]] inline bool IsInWindow(const SequenceNumber seqnum) const noexcept
+		{
+			return (GetOffset(seqnum) < m_Span);
+		}
+
+		// Removes all items; the window then begins at the given sequence number
+		void Reset(const SequenceNumber base_seqnum) noexcept
+		{
+			for (Size x = 0; x < m_Span; ++x)
+			{
+				GetSlot(x).reset();
+			}
+
+			m_Head = 0;
+			m_Size = 0;
+			m_Span = 0;
+			m_BaseSequenceNumber = base_seqnum;
+		}
+
+		// Makes room for a window spanning at least the given number of slots
+		[[nodiscard]] bool Reserve(const Size span) noexcept
+		{
+			if (span > MaxCapacity) return false;
+
+			if (span <= GetCapacity()) return true;
+
+			try
+			{
+				auto capacity = std::max(MinCapacity, GetCapacity());
+				while (capacity < span) capacity *= 2;
+
+				Slots slots(capacity);
+
+				for (Size x = 0; x < m_Span; ++x)
+				{
+					slots[x] = std::move(GetSlot(x));
+				}
+
+				m_Slots = std::move(slots);
+				m_Head = 0;
+
+				return true;
+			}
+			catch (...) {}
+
+			return false;
+		}
+
+		// Returns the item and true if it was added, or the item that already
+		// existed and false; returns nothing if the sequence number is too
+		// far ahead of the base of the window or in case of failure
+		template<typename... Args>
+		[[nodiscard]] std::pair<T*, bool> Emplace(const SequenceNumber seqnum, Args&&... args) noexcept
+		{
+			const auto offset = GetOffset(seqnum);
+
+			if (offset >= GetCapacity() && !Reserve(offset + 1)) return { nullptr, false };
+
+			auto& slot = GetSlot(offset);
+			if (slot.has_value()) return { &*slot, false };
+
+			try
+			{
+				slot.emplace(std::forward<Args>(args)...);
+			}
+			catch (...) { return { nullptr, false }; }
+
+			++m_Size;
+			m_Span = std::max(m_Span, offset + 1);
+
+			return { &*slot, true };
+		}
+
+		[[nodiscard]] inline T* Get(const SequenceNumber seqnum) noexcept
+		{
+			const auto offset = GetOffset(seqnum);
+			if (offset < m_Span)
+			{
+				auto& slot = GetSlot(offset);
+				if (slot.has_value()) return &*slot;
+			}
+
+			return nullptr;
+		}
+
+		[[nodiscard]] inline const T* Get(const SequenceNumber seqnum) const noexcept
+		{
+			return const_cast<SequenceWindow*>(this)->Get(seqnum);
+		}
+
+		// The item at the base of the window, if there is one
+		[[nodiscard]] inline T* GetFront() noexcept
+		{
+			if (m_Span > 0)
+			{
+				auto& slot = GetSlot(0);
+				if (slot.has_value()) return &*slot;
+			}
+
+			return nullptr;
+		}
+
+		[[nodiscard]] inline const T* GetFront() const noexcept
+		{
+			return const_cast<SequenceWindow*>(this)->GetFront();
+		}
+
+		// Removes the slot at the base of the window (with the item if there is one)
+		// and moves the base of the window to the next sequence number
+		void PopFront() noexcept
+		{
+			if (m_Span == 0) return;
+
+			auto& slot = GetSlot(0);
+			if (slot.has_value())
+			{
+				slot.reset();
+				--m_Size;
+			}
+
+			m_Head = (m_Head + 1) & (GetCapacity() - 1);
+			--m_Span;
+			m_BaseSequenceNumber = Message::GetNextSequenceNumber(m_BaseSequenceNumber);
+		}
+
+		// Calls the function for all items from the base of the window onwards;
+		// the function returns false to stop
+		template<typename F>
+		void ForEach(F&& function) noexcept(noexcept(function(std::declval<T&>())))
+		{
+			ForEachInSlots(0, m_Span, function);
+		}
+
+		// Calls the function for the items with sequence numbers from begin up to and
+		// including end (as numbers, so that begin should not be greater than end)
+		template<typename F>
+		void ForEachInRange(const SequenceNumber begin, const SequenceNumber end,
+							F&& function) noexcept(noexcept(function(std::declval<T&>())))
+		{
+			if (begin > end || m_Span == 0) return;
+
+			// The range can wrap around the end of the sequence numbers
+			// when it's relative to the base of the window
+			constexpr Size num_seqnums = Size{ std::numeric_limits<SequenceNumber>::max() } + 1;
+			const Size first = GetOffset(begin);
+			const Size last = first + (static_cast<Size>(end) - static_cast<Size>(begin));
+
+			if (first < m_Span)
+			{
+				if (!ForEachInSlots(first, std::min(last + 1, m_Span), function)) return;
+			}
+
+			if (last >= num_seqnums)
+			{
+				ForEachInSlots(0, std::min(last + 1 - num_seqnums, m_Span), function);
+			}
+		}
+
+	private:
+		[[nodiscard]] ForceInline std::optional<T>& GetSlot(const Size offset) noexcept
+		{
+			assert(offset < GetCapacity());
+
+			return m_Slots[(m_Head + offset) & (GetCapacity() - 1)];
+		}
+
+		template<typename F>
+		bool ForEachInSlots(const Size begin, const Size end, F& function) noexcept(noexcept(function(std::declval<T&>())))
+		{
+			for (auto x = begin; x < end; ++x)
+			{
+				auto& slot = GetSlot(x);
+				if (slot.has_value())
+				{
+					if (!function(*slot)) return false;
+				}
+			}
+
+			return true;
+		}
+
+	private:
+		Slots m_Slots;
+		Size m_Head{ 0 };
+		Size m_Size{ 0 };
+		Size m_Span{ 0 };
+		SequenceNumber m_BaseSequenceNumber{ 0 };
+	};
+}
@@ -6,6 +6,7 @@
 #include "..\..\Common\OnlineVariance.h"
 #include "..\..\Common\RingList.h"
 #include "..\..\Common\Containers.h"
+#include "UDPConnectionCongestionControl.h"
 
 // Use to enable/disable RTT debug console output
 // #define UDPCS_RTT_DEBUG
@@ -15,7 +16,9 @@
 
 namespace QuantumGate::Implementation::Core::UDP::Connection
 {
-	class Statistics final
+	// The default congestion control; additive increase/multiplicative decrease (AIMD)
+	// of the MTU window size with smoothed RTT and MTU window size samples
+	class Statistics final : public CongestionController
 	{
 		struct RTTSample final
 		{
@@ -39,7 +42,7 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 		Statistics& operator=(const Statistics&) = delete;
 		Statistics& operator=(Statistics&&) noexcept = delete;
 
-		[[nodiscard]] inline std::chrono::nanoseconds GetRetransmissionTimeout() noexcept
+		[[nodiscard]] inline std::chrono::nanoseconds GetRetransmissionTimeout() noexcept override
 		{
 			RecalcRetransmissionTimeout();
 
@@ -55,7 +58,13 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 			}
 		}
 
-		inline void RecordRTT(const std::chrono::nanoseconds rtt) noexcept
+		[[nodiscard]] inline std::chrono::nanoseconds GetRTT() noexcept override
+		{
+			RecalcRetransmissionTimeout();
+			return m_RTT;
+		}
+
+		inline void RecordRTT(const std::chrono::nanoseconds rtt, const SteadyTime now) noexcept override
 		{
 			// Never go below minimum
 			const auto ns = std::max(MinRTT.count(), rtt.count());
@@ -125,13 +134,13 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 		}
 
 	public:
-		[[nodiscard]] inline Size GetMTUWindowSize() noexcept
+		[[nodiscard]] inline Size GetMTUWindowSize() noexcept override
 		{
 			RecalcMTUWindowSize();
 			return m_MTUWindowSize;
 		}
 
-		inline void RecordMTUAck(const double num_mtu) noexcept
+		inline void RecordMTUAck(const double num_mtu, const SteadyTime now) noexcept override
 		{
 			if (num_mtu == 0.0) return;
 
@@ -155,7 +164,7 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 			}
 		}
 
-		inline void RecordMTULoss(const double num_mtu) noexcept
+		inline void RecordMTULoss(const double num_mtu, const SteadyTime now) noexcept override
 		{
 			if (num_mtu == 0.0)
 			{
@@ -167,8 +176,6 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 			}
 			else
 			{
-				const auto now = Util::GetCurrentSteadyTime();
-
 				m_LastLossRecordedSteadyTime = now;
 
 				// Part of additive increase/multiplicative decrease (AIMD) algorithm
@@ -204,7 +211,7 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 			}
 		}
 
-		void RecordMTUWindowSizeStats() noexcept
+		void RecordMTUWindowSizeStats(const SteadyTime now) noexcept override
 		{
 			if (m_OldMTUWindowSizeSample == m_NewMTUWindowSizeSample) return;
 
@@ -215,7 +222,6 @@ namespace QuantumGate::Implementation::Core::UDP::Connection
 			});
 
 			// Only record every RTT for a good sample
-			const auto now = Util::GetCurrentSteadyTime();
 			if (now - m_LastMTUWindowSizeSampleSteadyTime >= rtt)
 			{
 				m_MTUWindowSizeVariance.AddSample(m_NewMTUWindowSizeSample);
@@ -23,7 +23,8 @@ namespace QuantumGate::Implementation::Core::UDP::Listener
 
 		PreStartup();
 
-		const auto& settings = m_Settings.GetCache();
+		const auto settings_snapshot = m_Settings.GetSnapshot();
+		const auto& settings = *settings_snapshot;
 		const auto& listener_ports = settings.Local.Listeners.UDP.Ports;
 		const auto nat_traversal = settings.Local.Listeners.UDP.NATTraversal;
 		const auto& shared_secret = settings.Local.GlobalSharedSecret;
@@ -88,7 +89,8 @@ namespace QuantumGate::Implementation::Core::UDP::Listener
 
 		PreStartup();
 
-		const auto& settings = m_Settings.GetCache();
+		const auto settings_snapshot = m_Settings.GetSnapshot();
+		const auto& settings = *settings_snapshot;
 		const auto& listener_ports = settings.Local.Listeners.UDP.Ports;
 		const auto nat_traversal = settings.Local.Listeners.UDP.NATTraversal;
 		const auto& shared_secret = settings.Local.GlobalSharedSecret;
@@ -199,7 +201,8 @@ namespace QuantumGate::Implementation::Core::UDP::Listener
 
 		LogSys(L"Updating UDP listenermanager...");
 
-		const auto& settings = m_Settings.GetCache();
+		const auto settings_snapshot = m_Settings.GetSnapshot();
+		const auto& settings = *settings_snapshot;
 		const auto& listener_ports = settings.Local.Listeners.UDP.Ports;
 		const auto nat_traversal = settings.Local.Listeners.UDP.NATTraversal;
 
@@ -311,9 +314,12 @@ namespace QuantumGate::Implementation::Core::UDP::Listener
 	{
 		auto& socket = thdata.Socket;
 		const Endpoint lendpoint = socket.GetLocalEndpoint();
-		Endpoint pendpoint;
 		auto& buffer = GetReceiveBuffer();
 
+		std::array<Endpoint, Message::HMACBatchSize> batch_endpoints;
+		std::array<BufferSpan, Message::HMACBatchSize> batch_buffers;
+		std::array<bool, Message::HMACBatchSize> batch_hmac_results{ false };
+
 		while (!shutdown_event.IsSet())
 		{
 			if (socket.UpdateIOStatus(1ms))
@@ -329,25 +335,66 @@ namespace QuantumGate::Implementation::Core::UDP::Listener
 				{
 					if (socket.GetIOStatus().CanRead())
 					{
-						auto& settings = m_Settings.GetCache();
+						const auto settings_snapshot = m_Settings.GetSnapshot();
+						const auto& settings = *settings_snapshot;
 
-						pendpoint = Endpoint();
-						auto bufspan = BufferSpan(buffer);
+						// Receive as many datagrams as are available (up to a
+						// maximum) instead of waiting for the socket again for each
+						auto more_data{ true };
+						Size num{ 0 };
 
-						const auto result = socket.ReceiveFrom(pendpoint, bufspan);
-						if (result.Succeeded() && *result > 0)
+						while (more_data && num < MaxReceiveBatchSize)
 						{
-							// Check if IP is allowed through filters/limits and if it has acceptable reputation
-							if (const auto result1 =
-								m_AccessManager.GetConnectionFromAddressAllowed(pendpoint.GetIPEndpoint().GetIPAddress(),
-																				Access::CheckType::All); result1.Succeeded())
+							// Datagrams get received one after the other into the buffer
+							// and their HMACs get checked together, which is faster than
+							// checking them one at a time (especially for floods)
+							auto rcvspan = BufferSpan(buffer);
+							Size batch_size{ 0 };
+
+							while (batch_size < Message::HMACBatchSize && num < MaxReceiveBatchSize &&
+								   rcvspan.GetSize() >= Connection::UDPMessageSizes::Max)
+							{
+								auto& pendpoint = batch_endpoints[batch_size];
+								pendpoint = Endpoint();
+								auto bufspan = rcvspan;
+
+								const auto result = socket.ReceiveFrom(pendpoint, bufspan);
+								if (!result.Succeeded() || *result == 0)
+								{
+									more_data = false;
+									break;
+								}
+
+								++num;
+
+								// Check if IP is allowed through filters/limits and if it has acceptable reputation
+								if (const auto result1 =
+									m_AccessManager.GetConnectionFromAddressAllowed(pendpoint.GetIPEndpoint().GetIPAddress(),
+																					Access::CheckType::All); result1.Succeeded())
+								{
+									batch_buffers[batch_size] = rcvspan.GetFirst(*result);
+									rcvspan.RemoveFirst(*result);
+									++batch_size;
+								}
+								else
+								{
+									LogWarn(L"UDP listenermanager discarding incoming data from peer %s; IP address is not allowed by access configuration",
+											pendpoint.GetString().c_str());
+								}
+							}
+
+							if (batch_size == 0) continue;
+
+							Message::CheckHMACs(batch_buffers, batch_size, thdata.SymmetricKeys, batch_hmac_results);
+
+							for (Size x = 0; x < batch_size; ++x)
 							{
-								bufspan = bufspan.GetFirst(*result);
+								const auto& pendpoint = batch_endpoints[x];
 
 								[[maybe_unused]] const auto& [success, rep_update] =
 									AcceptConnection(settings, Util::GetCurrentSteadyTime(), Util::GetCurrentSystemTime(),
 													 thdata.SendQueue, lendpoint.GetIPEndpoint(), pendpoint.GetIPEndpoint(),
-													 bufspan, thdata.SymmetricKeys);
+													 batch_buffers[x], thdata.SymmetricKeys, batch_hmac_results[x]);
 								if (rep_update != Access::AddressReputationUpdate::None)
 								{
 									const auto result2 = m_AccessManager.UpdateAddressReputation(pendpoint.GetIPEndpoint().GetIPAddress(), rep_update);
@@ -358,30 +405,36 @@ namespace QuantumGate::Implementation::Core::UDP::Listener
 									}
 								}
 							}
-							else
-							{
-								LogWarn(L"UDP listenermanager discarding incoming data from peer %s; IP address is not allowed by access configuration",
-										pendpoint.GetString().c_str());
-							}
 						}
 					}
 
 					if (socket.GetIOStatus().CanWrite())
 					{
+						auto& batch = thdata.SendBatch;
+
 						auto send_queue = thdata.SendQueue->WithUniqueLock();
 						while (!send_queue->empty())
 						{
-							auto remove = false;
-							const auto& item = send_queue->front();
+							// Consecutive items for the same endpoint
+							// can possibly be sent with one call
+							const auto& front = send_queue->front();
 
-							const auto result = socket.SendTo(item.Endpoint, item.Data);
+							batch.clear();
+
+							for (auto it = send_queue->begin(); it != send_queue->end() &&
+								 batch.size() < Network::Socket::MaxDatagramBatchSize && it->Endpoint == front.Endpoint; ++it)
+							{
+								batch.emplace_back(it->Data);
+							}
+
+							const auto result = socket.SendToBatch(front.Endpoint, batch);
 							if (result.Succeeded())
 							{
 								// If data was actually sent, otherwise buffer may
 								// temporarily be full/unavailable
-								if (*result == item.Data.GetSize())
+								if (*result > 0)
 								{
-									remove = true;
+									for (Size x = 0; x < *result; ++x) send_queue->pop_front();
 								}
 								else
 								{
@@ -392,13 +445,11 @@ namespace QuantumGate::Implementation::Core::UDP::Listener
 							else
 							{
 								LogErr(L"UDP listenermanager failed to send data to peer %s (%s)",
-									   item.Endpoint.GetString().c_str(), result.GetErrorString().c_str());
+									   front.Endpoint.GetString().c_str(), result.GetErrorString().c_str());
 
 								// Remove from queue (UDPConnection will retry and add back if needed)
-								remove = true;
+								send_queue->pop_front();
 							}
-
-							if (remove) send_queue->pop();
 						}
 					}
 				}
@@ -409,17 +460,24 @@ namespace QuantumGate::Implementation::Core::UDP::Listener
 					   socket.GetLocalEndpoint().GetString().c_str());
 				break;
 			}
+
+			m_DatagramStatistics.Add(socket.GetDatagramStatistics(), thdata.AddedDatagramStatistics);
 		}
 	}
 
+	Manager::Statistics Manager::GetStatistics() const noexcept
+	{
+		return Statistics{ .Datagrams = m_DatagramStatistics.Get() };
+	}
+
 	std::pair<bool, Access::AddressReputationUpdate>
 		Manager::AcceptConnection(const Settings& settings, const SteadyTime current_steadytime,
 								  const SystemTime current_systemtime, const std::shared_ptr<SendQueue_ThS>& send_queue,
 								  const IPEndpoint& lendpoint, const IPEndpoint& pendpoint, BufferSpan& buffer,
-								  const SymmetricKeys& symkeys) noexcept
+								  const SymmetricKeys& symkeys, const bool hmac_valid) noexcept
 	{
 		Message msg(Message::Type::Unknown, Message::Direction::Incoming);
-		if (msg.Read(buffer, symkeys) && msg.IsValid())
+		if (hmac_valid && msg.Read(buffer, symkeys, true) && msg.IsValid())
 		{
 			switch (msg.GetType())
 			{
@@ -452,7 +510,7 @@ namespace QuantumGate::Implementation::Core::UDP::Listener
 					{
 						auto& connection_cookies = m_ThreadPool.GetData().ConnectionCookies;
 						if (connection_cookies.WithUniqueLock()->VerifyCookie(*syn_data.Cookie, syn_data.ConnectionID,
-																			  pendpoint, Util::GetCurrentSteadyTime(),
+																			  pendpoint, current_steadytime,
 																			  settings.UDP.CookieExpirationInterval))
 						{
 							LogDbg(L"UDP listenermanager verified cookie from peer %s for incoming connection with ID %llu",
@@ -584,7 +642,7 @@ namespace QuantumGate::Implementation::Core::UDP::Listener
 
 		auto& connection_cookies = m_ThreadPool.GetData().ConnectionCookies;
 		auto cookie_data = connection_cookies.WithUniqueLock()->GetCookie(connectionid, pendpoint,
-																		  Util::GetCurrentSteadyTime(),
+																		  current_steadytime,
 																		  settings.UDP.CookieExpirationInterval);
 		if (cookie_data.has_value())
 		{
@@ -596,7 +654,7 @@ namespace QuantumGate::Implementation::Core::UDP::Listener
 				Buffer data;
 				if (msg.Write(data, symkeys))
 				{
-					send_queue->WithUniqueLock()->emplace(
+					send_queue->WithUniqueLock()->emplace_back(
 						SendQueueItem{
 							.Endpoint = pendpoint,
 							.Data = std::move(data)
@@ -14,13 +14,22 @@ namespace QuantumGate::Implementation::Core::UDP::Listener
 {
 	class Manager final
 	{
-		using ReceiveBuffer = Memory::StackBuffer<Connection::UDPMessageSizes::Max>;
+		// Room for at least two datagrams of the maximum size; datagrams get
+		// received one after the other into the buffer so that their HMACs can
+		// be checked together, as long as there's room for another one
+		using ReceiveBuffer = Memory::StackBuffer<2 * Connection::UDPMessageSizes::Max>;
+
+		// Maximum number of datagrams to receive before
+		// checking for data to send and shutdown again
+		static constexpr Size MaxReceiveBatchSize{ 64 };
 
 		struct ThreadData final
 		{
 			ThreadData(const ProtectedBuffer& shared_secret, const bool primary = false) :
 				SymmetricKeys(PeerConnectionType::Inbound, shared_secret)
-			{}
+			{
+				SendBatch.reserve(Network::Socket::MaxDatagramBatchSize);
+			}
 
 			ThreadData(const ThreadData&) = delete;
 			ThreadData(ThreadData&&) noexcept = default;
@@ -35,7 +44,9 @@ namespace QuantumGate::Implementation::Core::UDP::Listener
 
 			SymmetricKeys SymmetricKeys;
 			Socket Socket;
+			Network::Socket::DatagramStatistics AddedDatagramStatistics;
 			std::shared_ptr<SendQueue_ThS> SendQueue;
+			Vector<BufferView> SendBatch;
 		};
 
 		struct ThreadPoolData final
@@ -46,6 +57,11 @@ namespace QuantumGate::Implementation::Core::UDP::Listener
 		using ThreadPool = Concurrency::ThreadPool<ThreadPoolData, ThreadData>;
 
 	public:
+		struct Statistics final
+		{
+			Network::Socket::DatagramStatistics Datagrams;
+		};
+
 		Manager() = delete;
 		Manager(const Settings_CThS& settings, Access::Manager& accessmgr, UDP::Connection::Manager& udpmgr,
 				Peer::Manager& peermgr) noexcept;
@@ -65,6 +81,8 @@ namespace QuantumGate::Implementation::Core::UDP::Listener
 		std::optional<ThreadPool::ThreadType> RemoveListenerThread(ThreadPool::ThreadType&& thread) noexcept;
 		[[nodiscard]] bool Update(const Vector<API::Local::Environment::EthernetInterface>& interfaces) noexcept;
 
+		Statistics GetStatistics() const noexcept;
+
 	private:
 		void PreStartup() noexcept;
 		void ResetState() noexcept;
@@ -78,7 +96,7 @@ namespace QuantumGate::Implementation::Core::UDP::Listener
 			AcceptConnection(const Settings& settings, const SteadyTime current_steadytime,
 							 const SystemTime current_systemtime, const std::shared_ptr<SendQueue_ThS>& send_queue,
 							 const IPEndpoint& lendpoint, const IPEndpoint& pendpoint, BufferSpan& buffer,
-							 const SymmetricKeys& symkeys) noexcept;
+							 const SymmetricKeys& symkeys, const bool hmac_valid) noexcept;
 
 		void SendCookie(const Settings& settings, const SteadyTime current_steadytime,
 						const std::shared_ptr<SendQueue_ThS>& send_queue, const IPEndpoint& pendpoint,
@@ -93,5 +111,8 @@ namespace QuantumGate::Implementation::Core::UDP::Listener
 		Peer::Manager& m_PeerManager;
 
 		ThreadPool m_ThreadPool;
+
+		// Datagrams sent and received by all listener sockets
+		Network::Socket::DatagramStatisticsTotals m_DatagramStatistics;
 	};
 }
\ No newline at end of file
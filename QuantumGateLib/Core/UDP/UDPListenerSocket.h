@@ -20,5 +20,5 @@ namespace QuantumGate::Implementation::Core::UDP::Listener
 		Buffer Data;
 	};
 
-	using SendQueue_ThS = Concurrency::ThreadSafe<Containers::Queue<SendQueueItem>, std::shared_mutex>;
+	using SendQueue_ThS = Concurrency::ThreadSafe<Containers::Deque<SendQueueItem>, std::shared_mutex>;
 }
\ No newline at end of file
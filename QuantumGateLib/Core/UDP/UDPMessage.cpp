@@ -211,7 +211,7 @@ namespace QuantumGate::Implementation::Core::UDP
 		return m_Header.GetSize();
 	}
 
-	bool Message::Read(BufferSpan& buffer, const SymmetricKeys& symkey) noexcept
+	bool Message::Read(BufferSpan& buffer, const SymmetricKeys& symkey, const bool hmac_checked) noexcept
 	{
 		try
 		{
@@ -223,6 +223,8 @@ namespace QuantumGate::Implementation::Core::UDP
 				assert(symkey);
 
 				// Calculate and check HMAC for the message
+				// unless it was already checked with others
+				if (!hmac_checked)
 				{
 					BufferView msgview{ buffer };
 
@@ -556,6 +558,46 @@ namespace QuantumGate::Implementation::Core::UDP
 		return hmac;
 	}
 
+	void Message::CheckHMACs(const std::array<BufferSpan, HMACBatchSize>& buffers, const Size num,
+							 const SymmetricKeys& symkey, std::array<bool, HMACBatchSize>& results) noexcept
+	{
+		assert(num <= HMACBatchSize);
+		assert(symkey);
+		assert(symkey.GetPeerAuthKey().GetSize() == 8);
+
+		std::array<const uint8_t*, HMACBatchSize> data{ nullptr };
+		std::array<size_t, HMACBatchSize> data_sizes{ 0 };
+		std::array<Size, HMACBatchSize> indices{ 0 };
+		std::array<HMAC, HMACBatchSize> chmacs{ 0 };
+		Size count{ 0 };
+
+		for (Size x = 0; x < num; ++x)
+		{
+			// Messages too short for an HMAC and IV fail right away
+			results[x] = false;
+			if (buffers[x].GetSize() < sizeof(HMAC) + sizeof(IV)) continue;
+
+			data[count] = reinterpret_cast<const uint8_t*>(buffers[x].GetBytes()) + sizeof(HMAC);
+			data_sizes[count] = buffers[x].GetSize() - sizeof(HMAC);
+			indices[count] = x;
+			++count;
+		}
+
+		if (count == 0) return;
+
+		halfsiphash_batch(data.data(), data_sizes.data(), count,
+						  reinterpret_cast<const uint8_t*>(symkey.GetPeerAuthKey().GetBytes()),
+						  reinterpret_cast<uint8_t*>(chmacs.data()));
+
+		for (Size x = 0; x < count; ++x)
+		{
+			HMAC hmac{ 0 };
+			std::memcpy(&hmac, buffers[indices[x]].GetBytes(), sizeof(HMAC));
+
+			results[indices[x]] = (hmac == chmacs[x]);
+		}
+	}
+
 	void Message::Validate() noexcept
 	{
 		m_Valid = false;
@@ -42,6 +42,9 @@ namespace QuantumGate::Implementation::Core::UDP
 		using HMAC = UInt32;
 		using IV = UInt32;
 
+		// Maximum number of received messages of which the HMACs get checked together
+		static constexpr Size HMACBatchSize{ 8 };
+
 #pragma pack(push, 1) // Disable padding bytes
 		struct AckRange final
 		{
@@ -204,9 +207,14 @@ namespace QuantumGate::Implementation::Core::UDP
 		[[nodiscard]] const Buffer& GetMessageData() const noexcept;
 		[[nodiscard]] Buffer&& MoveMessageData() noexcept;
 
-		[[nodiscard]] bool Read(BufferSpan& buffer, const SymmetricKeys& symkey) noexcept;
+		[[nodiscard]] bool Read(BufferSpan& buffer, const SymmetricKeys& symkey, const bool hmac_checked = false) noexcept;
 		[[nodiscard]] bool Write(Buffer& buffer, const SymmetricKeys& symkey) noexcept;
 
+		// Checks the HMACs of several received messages at once, which is faster than checking
+		// them one at a time; messages that passed can then be read with hmac_checked set
+		static void CheckHMACs(const std::array<BufferSpan, HMACBatchSize>& buffers, const Size num,
+							   const SymmetricKeys& symkey, std::array<bool, HMACBatchSize>& results) noexcept;
+
 		static SequenceNumber GetNextSequenceNumber(const SequenceNumber current) noexcept
 		{
 			if (current == std::numeric_limits<SequenceNumber>::max())
@@ -161,6 +161,51 @@ namespace QuantumGate::Implementation::Core::UDP
 		return ResultCode::Failed;
 	}
 
+	Result<Size> Socket::Receive(StreamBuffer& buffer, const Size /* max_rcv_size */) noexcept
+	{
+		assert(m_IOStatus.IsOpen() && m_IOStatus.IsConnected() && m_IOStatus.CanRead());
+
+		try
+		{
+			auto connection_data = m_ConnectionData->WithUniqueLock();
+
+			const auto max_rcv_size = connection_data->GetReceiveBuffer().GetReadSize();
+			if (max_rcv_size > 0)
+			{
+				auto rcvbuf_span = buffer.GetTailroom(max_rcv_size);
+
+				const auto rcv_size = connection_data->GetReceiveBuffer().Read(rcvbuf_span.GetBytes(), max_rcv_size);
+
+				assert(max_rcv_size == rcv_size);
+
+				buffer.CommitTailroom(rcv_size);
+
+				connection_data->SetRead(false);
+
+				m_BytesReceived += rcv_size;
+
+				return rcv_size;
+			}
+			else
+			{
+				if (!connection_data->HasCloseRequest()) return 0;
+
+				LogDbg(L"UDP socket connection closed for endpoint %s", GetPeerName().c_str());
+
+				connection_data->ResetReceiveEvent();
+			}
+		}
+		catch (const std::exception& e)
+		{
+			LogErr(L"UDP socket receive exception for endpoint %s - %s",
+				   GetPeerName().c_str(), Util::ToStringW(e.what()).c_str());
+
+			SetException(WSAENOBUFS);
+		}
+
+		return ResultCode::Failed;
+	}
+
 	void Socket::Close(const bool linger) noexcept
 	{
 		assert(m_IOStatus.IsOpen());
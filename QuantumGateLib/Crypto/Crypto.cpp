@@ -287,6 +287,20 @@ namespace QuantumGate::Implementation::Crypto
 		return false;
 	}
 
+	bool RestoreAsymmetricKeys(AsymmetricKeyData& keydata) noexcept
+	{
+		// Should have algorithm
+		assert(keydata.GetAlgorithm() != Algorithm::Asymmetric::Unknown);
+
+		if (!ValidateBuffer(keydata.LocalPrivateKey) ||
+			!ValidateBuffer(keydata.LocalPublicKey)) return false;
+
+		// The key encapsulation algorithms only use the buffers
+		if (keydata.GetKeyExchangeType() == KeyExchangeType::KeyEncapsulation) return true;
+
+		return OpenSSL::RestoreKey(keydata);
+	}
+
 	bool GenerateSharedSecret(AsymmetricKeyData& keydata) noexcept
 	{
 		// Should have algorithm and owner
@@ -396,7 +410,8 @@ namespace QuantumGate::Implementation::Crypto
 		try
 		{
 			ProtectedBuffer hkdfbuf;
-			const auto outlen = (2 * key_size) + (2 * 64); // Two encryption keys and two authentication keys
+			// Two encryption keys, two authentication keys and two key hint keys
+			const auto outlen = (2 * key_size) + (2 * 64) + (2 * 16);
 
 			// Generate random bytes which will be divided into the four keys
 			if (HKDF(sharedsecret, hkdfbuf, outlen, key1.HashAlgorithm))
@@ -412,13 +427,21 @@ namespace QuantumGate::Implementation::Crypto
 				key2.Key = kbuf.GetFirst(key_size);
 				kbuf.RemoveFirst(key_size);
 
-				// Last 128 bytes are authentication keys
+				// Next 128 bytes are authentication keys
 				key1.AuthKey = kbuf.GetFirst(64);
 				kbuf.RemoveFirst(64);
 
 				key2.AuthKey = kbuf.GetFirst(64);
 				kbuf.RemoveFirst(64);
 
+				// Last 32 bytes are key hint keys (for siphash); these come
+				// last so that the keys above are the same as before they were added
+				key1.HintKey = kbuf.GetFirst(16);
+				kbuf.RemoveFirst(16);
+
+				key2.HintKey = kbuf.GetFirst(16);
+				kbuf.RemoveFirst(16);
+
 				assert(kbuf.IsEmpty());
 
 				Dbg(L"Secret: %d bytes - %s", sharedsecret.GetSize(), Util::ToBase64(sharedsecret)->c_str());
@@ -438,6 +461,20 @@ namespace QuantumGate::Implementation::Crypto
 		return false;
 	}
 
+	UInt32 GetSymmetricKeyHint(const SymmetricKeyData& symkeydata, const UInt32 seed) noexcept
+	{
+		// Siphash requires keysize of 16
+		assert(symkeydata.HintKey.GetSize() == 16);
+
+		UInt64 hash{ 0 };
+
+		siphash(reinterpret_cast<const uint8_t*>(&seed), sizeof(seed),
+				reinterpret_cast<const uint8_t*>(symkeydata.HintKey.GetBytes()),
+				reinterpret_cast<uint8_t*>(&hash), sizeof(hash));
+
+		return static_cast<UInt32>(hash);
+	}
+
 	std::optional<ProtectedBuffer> GetPEMPrivateKey(const AsymmetricKeyData& keydata) noexcept
 	{
 		// Must have a key already
@@ -478,6 +515,30 @@ namespace QuantumGate::Implementation::Crypto
 		return false;
 	}
 
+	bool EncryptInPlace(BufferSpan& buffer, SymmetricKeyData& symkeydata, const BufferView& iv) noexcept
+	{
+		static_assert(SymmetricTagSize == OpenSSLSymmetric::TagSize, "Symmetric tag sizes should match");
+
+		if (OpenSSLSymmetric::EncryptInPlace(buffer, symkeydata, iv))
+		{
+			symkeydata.NumBytesProcessed += buffer.GetSize() - SymmetricTagSize;
+			return true;
+		}
+
+		return false;
+	}
+
+	bool DecryptInPlace(BufferSpan& buffer, SymmetricKeyData& symkeydata, const BufferView& iv) noexcept
+	{
+		if (OpenSSLSymmetric::DecryptInPlace(buffer, symkeydata, iv))
+		{
+			symkeydata.NumBytesProcessed += buffer.GetSize();
+			return true;
+		}
+
+		return false;
+	}
+
 	bool HashAndSign(const BufferView& msg, const Algorithm::Asymmetric alg, const BufferView& priv_key,
 					 Buffer& sig, const Algorithm::Hash type) noexcept
 	{
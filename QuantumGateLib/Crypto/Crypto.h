@@ -34,6 +34,10 @@ namespace QuantumGate::Implementation::Crypto
 								   const Algorithm::Hash type) noexcept;
 
 	[[nodiscard]] bool GenerateAsymmetricKeys(AsymmetricKeyData& keydata) noexcept;
+
+	// Restores a keypair from its LocalPrivateKey and LocalPublicKey buffers (for example
+	// after these were stored) so that it can be used as if it was just generated
+	[[nodiscard]] bool RestoreAsymmetricKeys(AsymmetricKeyData& keydata) noexcept;
 	[[nodiscard]] bool GenerateSharedSecret(AsymmetricKeyData& keydata) noexcept;
 	[[nodiscard]] bool GenerateSymmetricKeys(const BufferView& sharedsecret,
 											 SymmetricKeyData& key1, SymmetricKeyData& key2) noexcept;
@@ -47,6 +51,20 @@ namespace QuantumGate::Implementation::Crypto
 	[[nodiscard]] bool Decrypt(const BufferView& encrbuf, Buffer& buffer,
 							   SymmetricKeyData& symkeydata, const BufferView& iv) noexcept;
 
+	// Size of the authentication tag in front of the data output by Encrypt()
+	inline constexpr Size SymmetricTagSize{ 16 };
+
+	// In place variants of the above; the first SymmetricTagSize bytes of the buffer
+	// are for the tag and the rest is the data. After decryption the buffer refers
+	// to just the decrypted data.
+	[[nodiscard]] bool EncryptInPlace(BufferSpan& buffer, SymmetricKeyData& symkeydata, const BufferView& iv) noexcept;
+	[[nodiscard]] bool DecryptInPlace(BufferSpan& buffer, SymmetricKeyData& symkeydata, const BufferView& iv) noexcept;
+
+	// Returns a short keyed hash of the seed that can be used to tell which key some data
+	// was protected with without having to try them all; because it depends on the seed
+	// it doesn't identify the key to anyone who doesn't have it
+	[[nodiscard]] UInt32 GetSymmetricKeyHint(const SymmetricKeyData& symkeydata, const UInt32 seed) noexcept;
+
 	[[nodiscard]] bool HashAndSign(const BufferView& msg, const Algorithm::Asymmetric alg, const BufferView& priv_key,
 								   Buffer& sig, const Algorithm::Hash type) noexcept;
 
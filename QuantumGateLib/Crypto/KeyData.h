@@ -67,6 +67,7 @@ namespace QuantumGate::Implementation::Crypto
 		SymmetricKeyType Type{ SymmetricKeyType::Unknown };
 		ProtectedBuffer Key;
 		ProtectedBuffer AuthKey;
+		ProtectedBuffer HintKey;
 		Algorithm::Hash HashAlgorithm{ Algorithm::Hash::Unknown };
 		Algorithm::Symmetric SymmetricAlgorithm{ Algorithm::Symmetric::Unknown };
 		Algorithm::Compression CompressionAlgorithm{ Algorithm::Compression::Unknown };
@@ -207,6 +207,78 @@ namespace QuantumGate::Implementation::Crypto
 			return false;
 		}
 
+		[[nodiscard]] static bool RestoreKey(AsymmetricKeyData& keydata) noexcept
+		{
+			assert(keydata.GetKey() == nullptr);
+
+			EVP_PKEY* key{ nullptr };
+			std::optional<ProtectedBuffer> pub_key;
+
+			switch (keydata.GetAlgorithm())
+			{
+				case Algorithm::Asymmetric::ECDH_SECP521R1:
+				{
+					auto buff = BIO_new_mem_buf(keydata.LocalPrivateKey.GetBytes(),
+												static_cast<int>(keydata.LocalPrivateKey.GetSize()));
+					if (buff == nullptr) return false;
+
+					// Release buff when we exit
+					const auto sg = MakeScopeGuard([&]() noexcept { BIO_free_all(buff); });
+
+					key = PEM_read_bio_PrivateKey(buff, nullptr, nullptr, nullptr);
+					if (key != nullptr) pub_key = GetPEMPublicKey(key);
+					break;
+				}
+				case Algorithm::Asymmetric::ECDH_X25519:
+				case Algorithm::Asymmetric::EDDSA_ED25519:
+				case Algorithm::Asymmetric::ECDH_X448:
+				case Algorithm::Asymmetric::EDDSA_ED448:
+				{
+					int id{ 0 };
+
+					switch (keydata.GetAlgorithm())
+					{
+						case Algorithm::Asymmetric::ECDH_X25519:
+							id = EVP_PKEY_X25519;
+							break;
+						case Algorithm::Asymmetric::EDDSA_ED25519:
+							id = EVP_PKEY_ED25519;
+							break;
+						case Algorithm::Asymmetric::ECDH_X448:
+							id = EVP_PKEY_X448;
+							break;
+						default:
+							id = EVP_PKEY_ED448;
+							break;
+					}
+
+					key = EVP_PKEY_new_raw_private_key(id, nullptr,
+													   reinterpret_cast<const UChar*>(keydata.LocalPrivateKey.GetBytes()),
+													   keydata.LocalPrivateKey.GetSize());
+					if (key != nullptr) pub_key = GetRawPublicKey(key);
+					break;
+				}
+				default:
+					// Shouldn't get here
+					assert(false);
+					return false;
+			}
+
+			if (key == nullptr) return false;
+
+			// The public key derived from the private key should
+			// match the one we got to make sure the keypair is intact
+			if (pub_key.has_value() && *pub_key == BufferView(keydata.LocalPublicKey))
+			{
+				keydata.SetKey(key);
+				return true;
+			}
+
+			EVP_PKEY_free(key);
+
+			return false;
+		}
+
 		[[nodiscard]] static bool GenerateSharedSecret(AsymmetricKeyData& keydata) noexcept
 		{
 			switch (keydata.GetAlgorithm())
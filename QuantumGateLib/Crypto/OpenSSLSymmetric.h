@@ -40,185 +40,234 @@ namespace QuantumGate::Implementation::Crypto
 		}
 
 	public:
+		// Size of the authentication tag that precedes the encrypted data
+		static constexpr Size TagSize{ 16 };
+
 		[[nodiscard]] static bool Encrypt(const BufferView& buffer, Buffer& encrbuf,
 										  const SymmetricKeyData& symkeydata, const BufferView& iv) noexcept
 		{
-			assert(symkeydata.Key.GetSize() >= 32); // At least 256 bits
-			assert(iv.GetSize() >= 12); // At least 96 bits
+			try
+			{
+				encrbuf.Allocate(TagSize + buffer.GetSize());
+
+				if (Encrypt(buffer.GetBytes(), buffer.GetSize(), encrbuf.GetBytes() + TagSize,
+							encrbuf.GetBytes(), symkeydata, iv))
+				{
+					DbgInvoke([&]() noexcept
+					{
+						const auto tag = BufferView(encrbuf).GetFirst(TagSize);
+
+						Dbg(L"Etag: %s", Util::ToBase64(tag)->c_str());
+						Dbg(L"Encr: %s", Util::ToBase64(encrbuf)->c_str());
+					});
+
+					return true;
+				}
+			}
+			catch (...) {}
+
+			return false;
+		}
+
+		// Encrypts the data following the first TagSize bytes of the buffer in place;
+		// the tag gets written into the first TagSize bytes. The result has the same
+		// layout as the output of Encrypt() above, without allocating or copying.
+		[[nodiscard]] static bool EncryptInPlace(BufferSpan& buffer, const SymmetricKeyData& symkeydata,
+												 const BufferView& iv) noexcept
+		{
+			if (buffer.GetSize() < TagSize) return false;
+
+			return Encrypt(buffer.GetBytes() + TagSize, buffer.GetSize() - TagSize, buffer.GetBytes() + TagSize,
+						   buffer.GetBytes(), symkeydata, iv);
+		}
+
+		[[nodiscard]] static bool Decrypt(const BufferView& encrbuf, Buffer& buffer,
+										  const SymmetricKeyData& symkeydata, const BufferView& iv) noexcept
+		{
+			if (encrbuf.GetSize() < TagSize) return false;
+
+			try
+			{
+				DbgInvoke([&]() noexcept
+				{
+					const auto tag = BufferView(encrbuf).GetFirst(TagSize);
+
+					Dbg(L"Dtag: %s", Util::ToBase64(tag)->c_str());
+					Dbg(L"Decr: %s", Util::ToBase64(encrbuf)->c_str());
+				});
+
+				buffer.Allocate(encrbuf.GetSize() - TagSize);
+
+				return Decrypt(encrbuf.GetBytes() + TagSize, encrbuf.GetSize() - TagSize, buffer.GetBytes(),
+							   encrbuf.GetBytes(), symkeydata, iv);
+			}
+			catch (...) {}
 
-			const EVP_CIPHER* cipher{ nullptr };
+			return false;
+		}
+
+		// Decrypts data that has the layout of the output of Encrypt() in place; on
+		// success the buffer is updated to refer to just the decrypted data. On failure
+		// the contents of the buffer are undefined (the plaintext is not trustworthy).
+		[[nodiscard]] static bool DecryptInPlace(BufferSpan& buffer, const SymmetricKeyData& symkeydata,
+												 const BufferView& iv) noexcept
+		{
+			if (buffer.GetSize() < TagSize) return false;
 
-			switch (symkeydata.SymmetricAlgorithm)
+			if (Decrypt(buffer.GetBytes() + TagSize, buffer.GetSize() - TagSize, buffer.GetBytes() + TagSize,
+						buffer.GetBytes(), symkeydata, iv))
+			{
+				buffer.RemoveFirst(TagSize);
+				return true;
+			}
+
+			return false;
+		}
+
+	private:
+		[[nodiscard]] static const EVP_CIPHER* GetCipher(const Algorithm::Symmetric alg) noexcept
+		{
+			switch (alg)
 			{
 				case Algorithm::Symmetric::AES256_GCM:
-					cipher = EVP_aes_256_gcm();
-					break;
+					return EVP_aes_256_gcm();
 				case Algorithm::Symmetric::CHACHA20_POLY1305:
-					cipher = EVP_chacha20_poly1305();
-					break;
+					return EVP_chacha20_poly1305();
 				default:
-					return false;
+					break;
 			}
 
+			return nullptr;
+		}
+
+		// Both supported ciphers are stream ciphers so the encrypted data has the same size
+		// as the plaintext; in and out may point to the same memory (but may not otherwise overlap)
+		[[nodiscard]] static bool Encrypt(const Byte* in, const Size len, Byte* out, Byte* tag,
+										  const SymmetricKeyData& symkeydata, const BufferView& iv) noexcept
+		{
+			assert(symkeydata.Key.GetSize() >= 32); // At least 256 bits
+			assert(iv.GetSize() >= 12); // At least 96 bits
+
+			const auto cipher = GetCipher(symkeydata.SymmetricAlgorithm);
+			if (cipher == nullptr) return false;
+
 			// Docs: https://wiki.openssl.org/index.php/EVP_Authenticated_Encryption_and_Decryption
 			// https://www.openssl.org/docs/man1.1.0/crypto/EVP_chacha20_poly1305.html
 
-			try
+			auto ctx = GetContext();
+			assert(ctx != nullptr);
+
+			// Initialize the encryption operation
+			if (EVP_EncryptInit_ex(ctx, cipher, nullptr, nullptr, nullptr) == 1)
 			{
-				auto ctx = GetContext();
-				assert(ctx != nullptr);
+				EVP_CIPHER_CTX_set_padding(ctx, 1);
 
-				// Initialize the encryption operation
-				if (EVP_EncryptInit_ex(ctx, cipher, nullptr, nullptr, nullptr) == 1)
+				// Set IV length (default is 12 bytes (96 bits), but AES supports larger ones)
+				if (symkeydata.SymmetricAlgorithm == Algorithm::Symmetric::AES256_GCM)
 				{
-					EVP_CIPHER_CTX_set_padding(ctx, 1);
+					if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN,
+											static_cast<int>(iv.GetSize()), nullptr) != 1) return false;
+				}
 
-					// Set IV length (default is 12 bytes (96 bits), but AES supports larger ones)
-					if (symkeydata.SymmetricAlgorithm == Algorithm::Symmetric::AES256_GCM)
-					{
-						if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN,
-												static_cast<int>(iv.GetSize()), nullptr) != 1) return false;
-					}
+				// Initialize key and IV
+				if (EVP_EncryptInit_ex(ctx, nullptr, nullptr,
+									   reinterpret_cast<const UChar*>(symkeydata.Key.GetBytes()),
+									   reinterpret_cast<const UChar*>(iv.GetBytes())) == 1)
+				{
+					Size encrlen{ 0 };
+					int outlen{ 0 };
 
-					// Initialize key and IV
-					if (EVP_EncryptInit_ex(ctx, nullptr, nullptr,
-										   reinterpret_cast<const UChar*>(symkeydata.Key.GetBytes()),
-										   reinterpret_cast<const UChar*>(iv.GetBytes())) == 1)
+					// Provide the message to be encrypted, and obtain the encrypted output
+					if (EVP_EncryptUpdate(ctx, reinterpret_cast<UChar*>(out), &outlen,
+										  reinterpret_cast<const UChar*>(in), static_cast<int>(len)) == 1)
 					{
-						Size encrlen{ 0 };
-						Size len{ 0 };
-						Size taglen{ 16 };
-
-						encrbuf.Allocate(taglen + buffer.GetSize() + EVP_CIPHER_CTX_block_size(ctx));
+						encrlen = static_cast<Size>(outlen);
+						outlen = 0;
 
-						// Provide the message to be encrypted, and obtain the encrypted output
-						if (EVP_EncryptUpdate(ctx, reinterpret_cast<UChar*>(encrbuf.GetBytes()) + taglen,
-											  reinterpret_cast<int*>(&len), reinterpret_cast<const UChar*>(buffer.GetBytes()),
-											  static_cast<int>(buffer.GetSize())) == 1)
+						// Finalize the encryption; doesn't output anything for stream ciphers
+						if (EVP_EncryptFinal_ex(ctx, reinterpret_cast<UChar*>(out) + encrlen, &outlen) == 1)
 						{
-							encrlen = len;
-							len = 0;
-
-							// Finalize the encryption
-							if (EVP_EncryptFinal_ex(ctx, reinterpret_cast<UChar*>(encrbuf.GetBytes()) + taglen + encrlen,
-													reinterpret_cast<int*>(&len)) == 1)
-							{
-								encrlen += len;
-
-								assert(encrlen <= (encrbuf.GetSize() - taglen));
+							encrlen += static_cast<Size>(outlen);
 
-								// Get the tag (16 bytes (128 bits))
-								if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG,
-														static_cast<int>(taglen), encrbuf.GetBytes()) == 1)
-								{
-									DbgInvoke([&]() noexcept
-									{
-										const auto tag = BufferView(encrbuf).GetFirst(taglen);
+							assert(encrlen == len);
 
-										Dbg(L"Etag: %s", Util::ToBase64(tag)->c_str());
-										Dbg(L"Encr: %s", Util::ToBase64(encrbuf)->c_str());
-									});
-
-									encrbuf.Resize(taglen + encrlen);
-									return true;
-								}
+							// Get the tag (16 bytes (128 bits))
+							if (encrlen == len &&
+								EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG,
+													static_cast<int>(TagSize), tag) == 1)
+							{
+								return true;
 							}
 						}
 					}
 				}
 			}
-			catch (...) {}
 
 			return false;
 		}
 
-		[[nodiscard]] static bool Decrypt(const BufferView& encrbuf, Buffer& buffer,
+		[[nodiscard]] static bool Decrypt(const Byte* in, const Size len, Byte* out, const Byte* tag,
 										  const SymmetricKeyData& symkeydata, const BufferView& iv) noexcept
 		{
 			assert(symkeydata.Key.GetSize() >= 32); // At least 256 bits
 			assert(iv.GetSize() >= 12); // At least 96 bits
 
-			const EVP_CIPHER* cipher{ nullptr };
-
-			switch (symkeydata.SymmetricAlgorithm)
-			{
-				case Algorithm::Symmetric::AES256_GCM:
-					cipher = EVP_aes_256_gcm();
-					break;
-				case Algorithm::Symmetric::CHACHA20_POLY1305:
-					cipher = EVP_chacha20_poly1305();
-					break;
-				default:
-					return false;
-			}
+			const auto cipher = GetCipher(symkeydata.SymmetricAlgorithm);
+			if (cipher == nullptr) return false;
 
 			// Docs: https://wiki.openssl.org/index.php/EVP_Authenticated_Encryption_and_Decryption
 			// https://www.openssl.org/docs/man1.1.0/crypto/EVP_chacha20_poly1305.html
 
-			try
+			auto ctx = GetContext();
+			assert(ctx != nullptr);
+
+			// Initialize the decryption operation
+			if (EVP_DecryptInit_ex(ctx, cipher, nullptr, nullptr, nullptr) == 1)
 			{
-				auto ctx = GetContext();
-				assert(ctx != nullptr);
+				EVP_CIPHER_CTX_set_padding(ctx, 1);
 
-				// Initialize the decryption operation
-				if (EVP_DecryptInit_ex(ctx, cipher, nullptr, nullptr, nullptr) == 1)
+				// Set IV length (default is 12 bytes (96 bits))
+				if (symkeydata.SymmetricAlgorithm == Algorithm::Symmetric::AES256_GCM)
 				{
-					EVP_CIPHER_CTX_set_padding(ctx, 1);
+					if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN,
+											static_cast<int>(iv.GetSize()), nullptr) != 1) return false;
+				}
 
-					// Set IV length (default is 12 bytes (96 bits))
-					if (symkeydata.SymmetricAlgorithm == Algorithm::Symmetric::AES256_GCM)
-					{
-						if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN,
-												static_cast<int>(iv.GetSize()), nullptr) != 1) return false;
-					}
+				// Initialize key and IV
+				if (EVP_DecryptInit_ex(ctx, nullptr, nullptr,
+									   reinterpret_cast<const UChar*>(symkeydata.Key.GetBytes()),
+									   reinterpret_cast<const UChar*>(iv.GetBytes())) == 1)
+				{
+					Size declen{ 0 };
+					int outlen{ 0 };
 
-					// Initialize key and IV
-					if (EVP_DecryptInit_ex(ctx, nullptr, nullptr,
-										   reinterpret_cast<const UChar*>(symkeydata.Key.GetBytes()),
-										   reinterpret_cast<const UChar*>(iv.GetBytes())) == 1)
+					// Provide the message to be decrypted, and obtain the plaintext output
+					if (EVP_DecryptUpdate(ctx, reinterpret_cast<UChar*>(out), &outlen,
+										  reinterpret_cast<const UChar*>(in), static_cast<int>(len)) == 1)
 					{
-						buffer.Allocate(encrbuf.GetSize());
-						Size declen{ 0 };
-						Size len{ 0 };
-						const Size taglen{ 16 };
-
-						// Provide the message to be decrypted, and obtain the plaintext output
-						if (EVP_DecryptUpdate(ctx, reinterpret_cast<UChar*>(buffer.GetBytes()), reinterpret_cast<int*>(&len),
-											  reinterpret_cast<const UChar*>(encrbuf.GetBytes()) + taglen,
-											  static_cast<int>(encrbuf.GetSize() - taglen)) == 1)
+						declen = static_cast<Size>(outlen);
+
+						// Set expected tag value
+						if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_TAG,
+												static_cast<int>(TagSize), const_cast<Byte*>(tag)) == 1)
 						{
-							declen = len;
+							outlen = 0;
 
-							DbgInvoke([&]() noexcept
+							// Finalize the decryption; a positive return value indicates success,
+							// anything else is a failure - the plaintext is not trustworthy
+							const auto ret = EVP_DecryptFinal_ex(ctx, reinterpret_cast<UChar*>(out) + declen, &outlen);
+							if (ret > 0)
 							{
-								const auto tag = BufferView(encrbuf).GetFirst(taglen);
+								declen += static_cast<Size>(outlen);
 
-								Dbg(L"Dtag: %s", Util::ToBase64(tag)->c_str());
-								Dbg(L"Decr: %s", Util::ToBase64(encrbuf)->c_str());
-							});
+								assert(declen == len);
 
-							// Set expected tag value
-							if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_TAG,
-													static_cast<int>(taglen), const_cast<Byte*>(encrbuf.GetBytes())) == 1)
-							{
-								len = 0;
-
-								// Finalize the decryption; a positive return value indicates success,
-								// anything else is a failure - the plaintext is not trustworthy
-								const auto ret = EVP_DecryptFinal_ex(ctx, reinterpret_cast<UChar*>(buffer.GetBytes()) + declen,
-																	 reinterpret_cast<int*>(&len));
-								if (ret > 0)
-								{
-									declen += len;
-									buffer.Resize(declen);
-									return true;
-								}
+								return (declen == len);
 							}
 						}
 					}
 				}
 			}
-			catch (...) {}
 
 			return false;
 		}
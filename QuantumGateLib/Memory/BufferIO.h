@@ -21,9 +21,11 @@ namespace QuantumGate::Implementation::Memory
 	struct MemorySize final
 	{
 		static constexpr Size _1B{ 0x00000001UL };
+		static constexpr Size _64B{ 0x00000040UL };
 		static constexpr Size _256B{ 0x00000100UL };
 		static constexpr Size _512B{ 0x00000200UL };
 		static constexpr Size _1KB{ 0x00000400UL };
+		static constexpr Size _32KB{ 0x00008000UL };
 		static constexpr Size _65KB{ 0x00010000UL };
 		static constexpr Size _1MB{ 0x00100000UL };
 		static constexpr Size _2MB{ 0x00200000UL };
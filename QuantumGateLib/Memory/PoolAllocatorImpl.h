@@ -7,6 +7,8 @@
 #include "AllocatorStats.h"
 
 #include <unordered_map>
+#include <map>
+#include <bit>
 
 namespace QuantumGate::Implementation::Memory::PoolAllocator
 {
@@ -19,6 +21,13 @@ namespace QuantumGate::Implementation::Memory::PoolAllocator
 		static constexpr const std::size_t PoolAllocationMaximumSize{ MemorySize::_4MB };
 		static constexpr const std::size_t MaximumFreeBufferPoolSize{ MemorySize::_16MB };
 		static constexpr const std::size_t MaximumFreeBuffersPerPool{ 20 };
+		static constexpr const std::size_t MagazineMaximumSize{ MemorySize::_1MB };
+		static constexpr const std::size_t MagazineMaximumBuffers{ 4 };
+		static constexpr const std::size_t SlabAllocationMinimumSize{ MemorySize::_64B };
+		static constexpr const std::size_t SlabAllocationMaximumSize{ MemorySize::_32KB };
+		static constexpr const std::size_t SlabMinimumSize{ MemorySize::_65KB };
+		static constexpr const std::size_t SlabMinimumObjects{ 8 };
+		static constexpr const std::size_t SlabCacheMaximumSize{ MemorySize::_65KB };
 	};
 
 	template<> struct AllocatorConstants<ProtectedPool>
@@ -27,6 +36,15 @@ namespace QuantumGate::Implementation::Memory::PoolAllocator
 		static constexpr const std::size_t PoolAllocationMaximumSize{ MemorySize::_4MB };
 		static constexpr const std::size_t MaximumFreeBufferPoolSize{ MemorySize::_16MB };
 		static constexpr const std::size_t MaximumFreeBuffersPerPool{ 20 };
+		static constexpr const std::size_t MagazineMaximumSize{ MemorySize::_1MB };
+		static constexpr const std::size_t MagazineMaximumBuffers{ 4 };
+
+		// Protected memory is already fully pooled; no slabs
+		static constexpr const std::size_t SlabAllocationMinimumSize{ MemorySize::_64B };
+		static constexpr const std::size_t SlabAllocationMaximumSize{ 0 };
+		static constexpr const std::size_t SlabMinimumSize{ MemorySize::_65KB };
+		static constexpr const std::size_t SlabMinimumObjects{ 8 };
+		static constexpr const std::size_t SlabCacheMaximumSize{ MemorySize::_65KB };
 	};
 
 	template<typename MemoryBufferType>
@@ -56,9 +74,188 @@ namespace QuantumGate::Implementation::Memory::PoolAllocator
 	template<typename Type>
 	using MemoryPoolMap_ThS = Concurrency::ThreadSafe<MemoryPoolMap_T<Type>, std::shared_mutex>;
 
+	// Allocations up to SlabAllocationMaximumSize get rounded up to a power of two
+	// and carved out of slabs of memory that are allocated directly with VirtualAlloc.
+	// Free objects are kept in an intrusive singly linked list per size class. The
+	// shared slab pools are constant initialized and never get destroyed, because
+	// objects elsewhere may still free memory during static destruction.
+	struct SlabHeader final
+	{
+		SlabHeader* Next{ nullptr };
+		std::size_t Size{ 0 };
+	};
+
+	static constexpr std::size_t SlabHeaderSize{ 64 };
+	static_assert(sizeof(SlabHeader) <= SlabHeaderSize, "SlabHeader doesn't fit");
+
+	struct SlabPool final
+	{
+		Concurrency::SpinMutex Mutex;
+		void* FreeList{ nullptr };
+		std::size_t NumFree{ 0 };
+		SlabHeader* Slabs{ nullptr };
+		std::size_t NumSlabs{ 0 };
+	};
+
+	// Records which slab, if any, each allocation granularity (64KB) sized piece of the
+	// address space belongs to, so that every free can be checked against the actual slabs
+	// without locking. A granule's byte has the size class of its slab plus one (zero means
+	// no slab) in the lower bits and the index of the granule within the slab in the upper
+	// bits. The leaves each cover 4GB of address space and get allocated when first needed;
+	// like the slab pools the map is constant initialized and never gets destroyed.
+	struct SlabGranuleMap final
+	{
+		static constexpr std::size_t GranuleBits{ 16 };
+		static constexpr std::size_t LeafBits{ 16 };
+		static constexpr std::size_t AddressBits{ (sizeof(void*) == 8) ? 47 : 32 };
+		static constexpr std::size_t NumLeaves{ std::size_t{ 1 } << (AddressBits - GranuleBits - LeafBits) };
+
+		static constexpr std::size_t IndexShift{ 5 };
+		static constexpr std::uint8_t SizeClassMask{ (1 << IndexShift) - 1 };
+
+		using Leaf = std::array<std::atomic<std::uint8_t>, std::size_t{ 1 } << LeafBits>;
+
+		std::array<std::atomic<Leaf*>, NumLeaves> Leaves{};
+	};
+
+	struct SlabCache final
+	{
+		void* Head{ nullptr };
+		std::size_t Count{ 0 };
+	};
+
+	[[nodiscard]] inline void*& NextFreeObject(void* p) noexcept
+	{
+		return *static_cast<void**>(p);
+	}
+
+	template<typename Type>
+	[[nodiscard]] constexpr std::size_t GetSlabSize(const std::size_t len) noexcept
+	{
+		constexpr auto granularity = AllocatorConstants<Type>::SlabMinimumSize;
+		const auto size = SlabHeaderSize + (len * AllocatorConstants<Type>::SlabMinimumObjects);
+
+		return ((size + granularity - 1) / granularity) * granularity;
+	}
+
+	// Each thread keeps a small magazine of free buffers per allocation size
+	// (for sizes up to MagazineMaximumSize) and a cache of free slab objects
+	// per slab size class, so that most allocations and frees don't need to
+	// touch the shared pools. Both get refilled from and flushed to the shared
+	// pools in batches.
+	template<typename Type>
+	struct Magazine final
+	{
+		std::array<void*, AllocatorConstants<Type>::MagazineMaximumBuffers> Buffers{};
+		std::size_t Count{ 0 };
+	};
+
+	template<typename Type>
+	struct ThreadMagazines final
+	{
+		static constexpr const std::size_t NumSizeClasses{
+			static_cast<std::size_t>(std::bit_width(AllocatorConstants<Type>::PoolAllocationMaximumSize /
+													AllocatorConstants<Type>::PoolAllocationMinimumSize)) };
+
+		[[nodiscard]] static constexpr std::size_t GetSizeClass(const std::size_t len) noexcept
+		{
+			return static_cast<std::size_t>(std::bit_width(len / AllocatorConstants<Type>::PoolAllocationMinimumSize)) - 1;
+		}
+
+		[[nodiscard]] static constexpr std::size_t GetAllocationSize(const std::size_t size_class) noexcept
+		{
+			return AllocatorConstants<Type>::PoolAllocationMinimumSize << size_class;
+		}
+
+		[[nodiscard]] static constexpr std::size_t GetCapacity(const std::size_t len) noexcept
+		{
+			return std::min(AllocatorConstants<Type>::MagazineMaximumBuffers,
+							AllocatorConstants<Type>::MagazineMaximumSize / len);
+		}
+
+		[[nodiscard]] inline Magazine<Type>* GetMagazine(const std::size_t len) noexcept
+		{
+			if (len > AllocatorConstants<Type>::MagazineMaximumSize) return nullptr;
+
+			return &Magazines[GetSizeClass(len)];
+		}
+
+		static constexpr const std::size_t NumSlabSizeClasses{
+			static_cast<std::size_t>(std::bit_width(AllocatorConstants<Type>::SlabAllocationMaximumSize /
+													AllocatorConstants<Type>::SlabAllocationMinimumSize)) };
+
+		[[nodiscard]] static constexpr std::size_t GetSlabAllocationSize(const std::size_t n) noexcept
+		{
+			return std::bit_ceil(std::max(n, AllocatorConstants<Type>::SlabAllocationMinimumSize));
+		}
+
+		[[nodiscard]] static constexpr std::size_t GetSlabSizeClass(const std::size_t len) noexcept
+		{
+			return static_cast<std::size_t>(std::bit_width(len / AllocatorConstants<Type>::SlabAllocationMinimumSize)) - 1;
+		}
+
+		[[nodiscard]] static constexpr std::size_t GetSlabClassAllocationSize(const std::size_t size_class) noexcept
+		{
+			return AllocatorConstants<Type>::SlabAllocationMinimumSize << size_class;
+		}
+
+		[[nodiscard]] static constexpr std::size_t GetSlabCacheCapacity(const std::size_t len) noexcept
+		{
+			return std::max(AllocatorConstants<Type>::SlabCacheMaximumSize / len, std::size_t{ 2 });
+		}
+
+		// Counters are only written by the owning thread; other
+		// threads only read them for the statistics
+		inline void AddHit() noexcept { Hits.store(Hits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+		inline void AddMiss() noexcept { Misses.store(Misses.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+
+		std::array<Magazine<Type>, NumSizeClasses> Magazines{};
+		std::array<SlabCache, NumSlabSizeClasses> SlabCaches{};
+		std::atomic<std::uint64_t> Hits{ 0 };
+		std::atomic<std::uint64_t> Misses{ 0 };
+		DWORD ThreadID{ 0 };
+		bool Registered{ false };
+		bool Enabled{ true };
+		ThreadMagazines* Next{ nullptr };
+	};
+
+	// Constant initialized for the same reason as the slab pools; threads
+	// may start allocating before the static objects are constructed
+	template<typename Type>
+	struct ThreadMagazinesRegistry final
+	{
+		Concurrency::SpinMutex Mutex;
+		ThreadMagazines<Type>* Threads{ nullptr };
+		std::uint64_t ExitedThreadsHits{ 0 };
+		std::uint64_t ExitedThreadsMisses{ 0 };
+	};
+
+	template<typename Type>
+	using SlabPools = std::array<SlabPool, ThreadMagazines<Type>::NumSlabSizeClasses>;
+
+	static_assert(ThreadMagazines<NormalPool>::NumSlabSizeClasses < SlabGranuleMap::SizeClassMask,
+				  "Slab size classes don't fit in the granule map");
+	static_assert((GetSlabSize<NormalPool>(AllocatorConstants<NormalPool>::SlabAllocationMaximumSize) >>
+				   SlabGranuleMap::GranuleBits) <= (0xFF >> SlabGranuleMap::IndexShift) + 1,
+				  "Slab granule indexes don't fit in the granule map");
+
 	static MemoryPoolMap_ThS<NormalPool> NormalMemoryPoolMap;
 	static MemoryPoolMap_ThS<ProtectedPool> ProtectedMemoryPoolMap;
 
+	static SlabPools<NormalPool> NormalSlabPools;
+	static SlabPools<ProtectedPool> ProtectedSlabPools;
+
+	static SlabGranuleMap NormalSlabGranuleMap;
+	static SlabGranuleMap ProtectedSlabGranuleMap;
+
+	static ThreadMagazinesRegistry<NormalPool> NormalThreadMagazinesRegistry;
+	static ThreadMagazinesRegistry<ProtectedPool> ProtectedThreadMagazinesRegistry;
+
+	// Trivially destructible so that these remain accessible (and disabled)
+	// during thread exit after ThreadMagazinesCleanup has run
+	static thread_local ThreadMagazines<NormalPool> NormalThreadMagazines;
+	static thread_local ThreadMagazines<ProtectedPool> ProtectedThreadMagazines;
+
 	static AllocatorStats_ThS NormalPoolAllocatorStats;
 	static AllocatorStats_ThS ProtectedPoolAllocatorStats;
 
@@ -116,6 +313,565 @@ namespace QuantumGate::Implementation::Memory::PoolAllocator
 		}
 	}
 
+	template<typename Type>
+	inline auto& GetThreadMagazinesRegistry() noexcept
+	{
+		if constexpr (std::is_same_v<Type, NormalPool>)
+		{
+			return NormalThreadMagazinesRegistry;
+		}
+		else if constexpr (std::is_same_v<Type, ProtectedPool>)
+		{
+			return ProtectedThreadMagazinesRegistry;
+		}
+		else
+		{
+			static_assert(AlwaysFalse<Type>, "Unsupported type used");
+		}
+	}
+
+	template<typename Type>
+	inline auto& GetSlabPools() noexcept
+	{
+		if constexpr (std::is_same_v<Type, NormalPool>)
+		{
+			return NormalSlabPools;
+		}
+		else if constexpr (std::is_same_v<Type, ProtectedPool>)
+		{
+			return ProtectedSlabPools;
+		}
+		else
+		{
+			static_assert(AlwaysFalse<Type>, "Unsupported type used");
+		}
+	}
+
+	template<typename Type>
+	inline auto& GetSlabGranuleMap() noexcept
+	{
+		if constexpr (std::is_same_v<Type, NormalPool>)
+		{
+			return NormalSlabGranuleMap;
+		}
+		else if constexpr (std::is_same_v<Type, ProtectedPool>)
+		{
+			return ProtectedSlabGranuleMap;
+		}
+		else
+		{
+			static_assert(AlwaysFalse<Type>, "Unsupported type used");
+		}
+	}
+
+	template<typename Type>
+	void UnmarkSlabGranules(const void* slab, const std::size_t slab_size) noexcept
+	{
+		auto& map = GetSlabGranuleMap<Type>();
+
+		const auto first = reinterpret_cast<std::uintptr_t>(slab) >> SlabGranuleMap::GranuleBits;
+
+		for (auto granule = first; granule < first + (slab_size >> SlabGranuleMap::GranuleBits); ++granule)
+		{
+			if (const auto leaf = map.Leaves[granule >> SlabGranuleMap::LeafBits].load(std::memory_order_acquire);
+				leaf != nullptr)
+			{
+				(*leaf)[granule & (leaf->size() - 1)].store(0, std::memory_order_release);
+			}
+		}
+	}
+
+	template<typename Type>
+	[[nodiscard]] bool MarkSlabGranules(const void* slab, const std::size_t slab_size, const std::size_t size_class) noexcept
+	{
+		auto& map = GetSlabGranuleMap<Type>();
+
+		const auto first = reinterpret_cast<std::uintptr_t>(slab) >> SlabGranuleMap::GranuleBits;
+
+		for (auto granule = first; granule < first + (slab_size >> SlabGranuleMap::GranuleBits); ++granule)
+		{
+			const auto leaf_index = granule >> SlabGranuleMap::LeafBits;
+			if (leaf_index >= map.Leaves.size())
+			{
+				UnmarkSlabGranules<Type>(slab, slab_size);
+				return false;
+			}
+
+			auto leaf = map.Leaves[leaf_index].load(std::memory_order_acquire);
+			if (leaf == nullptr)
+			{
+				auto new_leaf = ::VirtualAlloc(nullptr, sizeof(SlabGranuleMap::Leaf), MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+				if (new_leaf == nullptr)
+				{
+					UnmarkSlabGranules<Type>(slab, slab_size);
+					return false;
+				}
+
+				// Another thread may have been first
+				auto expected = leaf;
+				leaf = std::construct_at(static_cast<SlabGranuleMap::Leaf*>(new_leaf));
+
+				if (!map.Leaves[leaf_index].compare_exchange_strong(expected, leaf, std::memory_order_acq_rel,
+																	std::memory_order_acquire))
+				{
+					::VirtualFree(new_leaf, 0, MEM_RELEASE);
+					leaf = expected;
+				}
+			}
+
+			const auto value = ((granule - first) << SlabGranuleMap::IndexShift) | (size_class + 1);
+			(*leaf)[granule & (leaf->size() - 1)].store(static_cast<std::uint8_t>(value), std::memory_order_release);
+		}
+
+		return true;
+	}
+
+	template<typename Type>
+	[[nodiscard]] bool AllocateSlab(SlabPool& pool, const std::size_t len, SlabCache& cache, const std::size_t num) noexcept
+	{
+		const auto slab_size = GetSlabSize<Type>(len);
+
+		auto slab = static_cast<Byte*>(::VirtualAlloc(nullptr, slab_size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+		if (slab == nullptr) return false;
+
+		if (!MarkSlabGranules<Type>(slab, slab_size, ThreadMagazines<Type>::GetSlabSizeClass(len)))
+		{
+			::VirtualFree(slab, 0, MEM_RELEASE);
+			return false;
+		}
+
+		auto header = std::construct_at(reinterpret_cast<SlabHeader*>(slab), SlabHeader{ nullptr, slab_size });
+
+		// Carve the slab up into a list of free objects
+		const auto num_objects = (slab_size - SlabHeaderSize) / len;
+		const auto GetObject = [&](const std::size_t x) noexcept -> void* { return slab + SlabHeaderSize + (x * len); };
+
+		for (std::size_t x = 0; x < num_objects - 1; ++x)
+		{
+			NextFreeObject(GetObject(x)) = GetObject(x + 1);
+		}
+
+		// The first objects go to the cache and the rest to the shared pool
+		const auto num_cache = std::min(num, num_objects);
+
+		NextFreeObject(GetObject(num_cache - 1)) = cache.Head;
+		cache.Head = GetObject(0);
+		cache.Count += num_cache;
+
+		std::lock_guard<Concurrency::SpinMutex> lock(pool.Mutex);
+
+		header->Next = pool.Slabs;
+		pool.Slabs = header;
+		++pool.NumSlabs;
+
+		if (num_cache < num_objects)
+		{
+			NextFreeObject(GetObject(num_objects - 1)) = pool.FreeList;
+			pool.FreeList = GetObject(num_cache);
+			pool.NumFree += num_objects - num_cache;
+		}
+
+		return true;
+	}
+
+	template<typename Type>
+	[[nodiscard]] bool RefillSlabCache(const std::size_t size_class, SlabCache& cache, const std::size_t num) noexcept
+	{
+		auto& pool = GetSlabPools<Type>()[size_class];
+
+		{
+			std::lock_guard<Concurrency::SpinMutex> lock(pool.Mutex);
+
+			if (pool.FreeList != nullptr)
+			{
+				std::size_t count{ 0 };
+
+				while (count < num && pool.FreeList != nullptr)
+				{
+					auto obj = pool.FreeList;
+					pool.FreeList = NextFreeObject(obj);
+
+					NextFreeObject(obj) = cache.Head;
+					cache.Head = obj;
+					++count;
+				}
+
+				pool.NumFree -= count;
+				cache.Count += count;
+
+				return true;
+			}
+		}
+
+		return AllocateSlab<Type>(pool, ThreadMagazines<Type>::GetSlabClassAllocationSize(size_class), cache, num);
+	}
+
+	template<typename Type>
+	void FlushSlabCache(const std::size_t size_class, SlabCache& cache, const std::size_t num) noexcept
+	{
+		assert(num <= cache.Count);
+
+		if (num == 0) return;
+
+		auto head = cache.Head;
+		auto tail = head;
+
+		for (std::size_t x = 1; x < num; ++x)
+		{
+			tail = NextFreeObject(tail);
+		}
+
+		cache.Head = NextFreeObject(tail);
+		cache.Count -= num;
+
+		auto& pool = GetSlabPools<Type>()[size_class];
+
+		std::lock_guard<Concurrency::SpinMutex> lock(pool.Mutex);
+
+		NextFreeObject(tail) = pool.FreeList;
+		pool.FreeList = head;
+		pool.NumFree += num;
+	}
+
+	// Checks whether the pointer is an object of one of the slabs for the size
+	// class, using the granule map so that the slabs don't need to be walked
+	template<typename Type>
+	[[nodiscard]] bool IsSlabObject(const void* p, const std::size_t len) noexcept
+	{
+		const auto& map = GetSlabGranuleMap<Type>();
+
+		const auto obj = reinterpret_cast<std::uintptr_t>(p);
+		const auto granule = obj >> SlabGranuleMap::GranuleBits;
+
+		const auto leaf_index = granule >> SlabGranuleMap::LeafBits;
+		if (leaf_index >= map.Leaves.size()) return false;
+
+		const auto leaf = map.Leaves[leaf_index].load(std::memory_order_acquire);
+		if (leaf == nullptr) return false;
+
+		const auto value = (*leaf)[granule & (leaf->size() - 1)].load(std::memory_order_acquire);
+
+		// The size class is stored plus one
+		if (static_cast<std::size_t>(value & SlabGranuleMap::SizeClassMask) !=
+			ThreadMagazines<Type>::GetSlabSizeClass(len) + 1) return false;
+
+		const auto index = static_cast<std::uintptr_t>(value >> SlabGranuleMap::IndexShift);
+		const auto slab = (granule - index) << SlabGranuleMap::GranuleBits;
+		const auto num_objects = (GetSlabSize<Type>(len) - SlabHeaderSize) / len;
+
+		return (obj >= slab + SlabHeaderSize &&
+				(obj - slab - SlabHeaderSize) % len == 0 &&
+				(obj - slab - SlabHeaderSize) / len < num_objects);
+	}
+
+	template<typename Type>
+	void FreeUnusedSlabs() noexcept
+	{
+		auto& pools = GetSlabPools<Type>();
+
+		for (std::size_t x = 0; x < pools.size(); ++x)
+		{
+			auto& pool = pools[x];
+			const auto len = ThreadMagazines<Type>::GetSlabClassAllocationSize(x);
+			const auto num_objects = (GetSlabSize<Type>(len) - SlabHeaderSize) / len;
+
+			SlabHeader* unused_slabs{ nullptr };
+
+			try
+			{
+				std::lock_guard<Concurrency::SpinMutex> lock(pool.Mutex);
+
+				// Count the free objects in each slab
+				std::map<std::uintptr_t, std::pair<SlabHeader*, std::size_t>> slabs;
+
+				for (auto slab = pool.Slabs; slab != nullptr; slab = slab->Next)
+				{
+					slabs.emplace(reinterpret_cast<std::uintptr_t>(slab), std::make_pair(slab, std::size_t{ 0 }));
+				}
+
+				const auto GetSlab = [&](void* obj) noexcept
+				{
+					auto it = slabs.upper_bound(reinterpret_cast<std::uintptr_t>(obj));
+					assert(it != slabs.begin());
+					return --it;
+				};
+
+				for (auto obj = pool.FreeList; obj != nullptr; obj = NextFreeObject(obj))
+				{
+					++GetSlab(obj)->second.second;
+				}
+
+				// Slabs whose objects are all free can be released;
+				// leave their objects out of the free list
+				void* free_list{ nullptr };
+				std::size_t num_free{ 0 };
+
+				for (auto obj = pool.FreeList; obj != nullptr;)
+				{
+					auto next = NextFreeObject(obj);
+
+					if (GetSlab(obj)->second.second < num_objects)
+					{
+						NextFreeObject(obj) = free_list;
+						free_list = obj;
+						++num_free;
+					}
+
+					obj = next;
+				}
+
+				pool.FreeList = free_list;
+				pool.NumFree = num_free;
+
+				SlabHeader* used_slabs{ nullptr };
+				pool.NumSlabs = 0;
+
+				for (auto& [address, slab] : slabs)
+				{
+					if (slab.second == num_objects)
+					{
+						slab.first->Next = unused_slabs;
+						unused_slabs = slab.first;
+					}
+					else
+					{
+						slab.first->Next = used_slabs;
+						used_slabs = slab.first;
+						++pool.NumSlabs;
+					}
+				}
+
+				pool.Slabs = used_slabs;
+			}
+			catch (...) {}
+
+			while (unused_slabs != nullptr)
+			{
+				auto next = unused_slabs->Next;
+				UnmarkSlabGranules<Type>(unused_slabs, unused_slabs->Size);
+				::VirtualFree(unused_slabs, 0, MEM_RELEASE);
+				unused_slabs = next;
+			}
+		}
+	}
+
+	template<typename Type>
+	void FlushMagazine(Magazine<Type>& mag, const std::size_t len, const std::size_t num) noexcept
+	{
+		assert(num <= mag.Count);
+
+		if (num == 0) return;
+
+		const auto mpm = GetMemoryPoolMap<Type>().WithSharedLock();
+
+		// The pool can't have been removed since it still has buffers in use
+		const auto it = mpm->find(len);
+		assert(it != mpm->end());
+
+		if (it != mpm->end())
+		{
+			MemoryPoolData<Type>* mpd = it->second.get();
+
+			// The oldest buffers are at the bottom of the magazine
+			std::size_t num_reused{ 0 };
+
+			try
+			{
+				mpd->FreeBufferPool.WithUniqueLock([&](auto& fbp)
+				{
+					while (num_reused < num &&
+						   fbp.size() <= AllocatorConstants<Type>::MaximumFreeBuffersPerPool &&
+						   (fbp.size() * len <= AllocatorConstants<Type>::MaximumFreeBufferPoolSize))
+					{
+						fbp.emplace_front(reinterpret_cast<std::uintptr_t>(mag.Buffers[num_reused]));
+						++num_reused;
+					}
+				});
+			}
+			catch (...) {}
+
+			if (num_reused < num)
+			{
+				// Release the buffers that didn't fit in the free buffer pool
+				auto mbp = mpd->MemoryBufferPool.WithUniqueLock();
+
+				for (auto x = num_reused; x < num; ++x)
+				{
+					[[maybe_unused]] const auto erased = mbp->erase(reinterpret_cast<std::uintptr_t>(mag.Buffers[x]));
+
+					// If we don't find the buffer in the pool something is wrong
+					assert(erased == 1);
+				}
+			}
+		}
+
+		std::move(mag.Buffers.begin() + num, mag.Buffers.begin() + mag.Count, mag.Buffers.begin());
+		mag.Count -= num;
+	}
+
+	template<typename Type>
+	void FlushThreadMagazines(ThreadMagazines<Type>& tm) noexcept
+	{
+		for (std::size_t x = 0; x < tm.Magazines.size(); ++x)
+		{
+			auto& mag = tm.Magazines[x];
+			FlushMagazine<Type>(mag, ThreadMagazines<Type>::GetAllocationSize(x), mag.Count);
+		}
+
+		for (std::size_t x = 0; x < tm.SlabCaches.size(); ++x)
+		{
+			FlushSlabCache<Type>(x, tm.SlabCaches[x], tm.SlabCaches[x].Count);
+		}
+	}
+
+	template<typename Type>
+	class ThreadMagazinesCleanup final
+	{
+	public:
+		ThreadMagazinesCleanup(ThreadMagazines<Type>& tm) noexcept : m_ThreadMagazines(tm)
+		{
+			m_ThreadMagazines.ThreadID = ::GetCurrentThreadId();
+			m_ThreadMagazines.Registered = true;
+
+			auto& registry = GetThreadMagazinesRegistry<Type>();
+
+			std::lock_guard<Concurrency::SpinMutex> lock(registry.Mutex);
+
+			m_ThreadMagazines.Next = registry.Threads;
+			registry.Threads = &m_ThreadMagazines;
+		}
+
+		ThreadMagazinesCleanup(const ThreadMagazinesCleanup&) = delete;
+		ThreadMagazinesCleanup(ThreadMagazinesCleanup&&) = delete;
+		ThreadMagazinesCleanup& operator=(const ThreadMagazinesCleanup&) = delete;
+		ThreadMagazinesCleanup& operator=(ThreadMagazinesCleanup&&) = delete;
+
+		~ThreadMagazinesCleanup()
+		{
+			// Return all cached buffers to the shared pool and
+			// bypass the magazines for whatever runs after us
+			m_ThreadMagazines.Enabled = false;
+
+			FlushThreadMagazines<Type>(m_ThreadMagazines);
+
+			auto& registry = GetThreadMagazinesRegistry<Type>();
+
+			std::lock_guard<Concurrency::SpinMutex> lock(registry.Mutex);
+
+			registry.ExitedThreadsHits += m_ThreadMagazines.Hits.load(std::memory_order_relaxed);
+			registry.ExitedThreadsMisses += m_ThreadMagazines.Misses.load(std::memory_order_relaxed);
+
+			for (auto tm = &registry.Threads; *tm != nullptr; tm = &(*tm)->Next)
+			{
+				if (*tm == &m_ThreadMagazines)
+				{
+					*tm = m_ThreadMagazines.Next;
+					break;
+				}
+			}
+		}
+
+	private:
+		ThreadMagazines<Type>& m_ThreadMagazines;
+	};
+
+	template<typename Type>
+	inline ThreadMagazines<Type>* GetThreadMagazines() noexcept
+	{
+		auto& tm = [&]() noexcept -> ThreadMagazines<Type>&
+		{
+			if constexpr (std::is_same_v<Type, NormalPool>)
+			{
+				return NormalThreadMagazines;
+			}
+			else if constexpr (std::is_same_v<Type, ProtectedPool>)
+			{
+				return ProtectedThreadMagazines;
+			}
+			else
+			{
+				static_assert(AlwaysFalse<Type>, "Unsupported type used");
+			}
+		}();
+
+		if (!tm.Enabled) return nullptr;
+
+		if (!tm.Registered)
+		{
+			// Registers the magazines for the statistics and
+			// flushes them when the thread exits
+			static thread_local ThreadMagazinesCleanup<Type> cleanup(tm);
+		}
+
+		return &tm;
+	}
+
+	template<typename Type>
+	[[nodiscard]] void* AllocateFromSlab(const std::size_t len) noexcept
+	{
+		const auto size_class = ThreadMagazines<Type>::GetSlabSizeClass(len);
+
+		void* retbuf{ nullptr };
+
+		if (const auto tm = GetThreadMagazines<Type>(); tm != nullptr)
+		{
+			auto& cache = tm->SlabCaches[size_class];
+
+			if (cache.Head != nullptr) tm->AddHit();
+			else
+			{
+				tm->AddMiss();
+
+				const auto refill = std::max(ThreadMagazines<Type>::GetSlabCacheCapacity(len) / 2, std::size_t{ 1 });
+				if (!RefillSlabCache<Type>(size_class, cache, refill)) return nullptr;
+			}
+
+			retbuf = cache.Head;
+			cache.Head = NextFreeObject(retbuf);
+			--cache.Count;
+		}
+		else
+		{
+			// The thread is exiting and its cache is gone;
+			// take an object directly from the shared pool
+			SlabCache cache;
+			if (!RefillSlabCache<Type>(size_class, cache, 1)) return nullptr;
+
+			retbuf = cache.Head;
+		}
+
+		NextFreeObject(retbuf) = nullptr;
+
+		return retbuf;
+	}
+
+	template<typename Type>
+	void FreeToSlab(void* p, const std::size_t len) noexcept
+	{
+		const auto size_class = ThreadMagazines<Type>::GetSlabSizeClass(len);
+
+		if (const auto tm = GetThreadMagazines<Type>(); tm != nullptr)
+		{
+			auto& cache = tm->SlabCaches[size_class];
+
+			NextFreeObject(p) = cache.Head;
+			cache.Head = p;
+			++cache.Count;
+
+			if (const auto capacity = ThreadMagazines<Type>::GetSlabCacheCapacity(len); cache.Count > capacity)
+			{
+				FlushSlabCache<Type>(size_class, cache, capacity / 2);
+			}
+		}
+		else
+		{
+			NextFreeObject(p) = nullptr;
+
+			SlabCache cache{ p, 1 };
+			FlushSlabCache<Type>(size_class, cache, 1);
+		}
+	}
+
 	template<typename Type>
 	inline const WChar* GetAllocatorName() noexcept
 	{
@@ -156,6 +912,54 @@ namespace QuantumGate::Implementation::Memory::PoolAllocator
 			output += AllocatorStats::FormatString(L"\r\nTotal in managed pools: %zu bytes\r\n", total);
 		});
 
+		if constexpr (ThreadMagazines<Type>::NumSlabSizeClasses > 0)
+		{
+			std::size_t total{ 0 };
+
+			output += AllocatorStats::FormatString(L"\r\n%s slabs:\r\n-----------------------------------------------\r\n", GetAllocatorName<Type>());
+
+			auto& pools = GetSlabPools<Type>();
+
+			for (std::size_t x = 0; x < pools.size(); ++x)
+			{
+				const auto len = ThreadMagazines<Type>::GetSlabClassAllocationSize(x);
+				const auto slab_size = GetSlabSize<Type>(len);
+
+				std::lock_guard<Concurrency::SpinMutex> lock(pools[x].Mutex);
+
+				output += AllocatorStats::FormatString(L"Object size: %8zu bytes -> Slabs: %8zu of %zu bytes (%zu free objects)\r\n",
+													   len, pools[x].NumSlabs, slab_size, pools[x].NumFree);
+
+				total += pools[x].NumSlabs * slab_size;
+			}
+
+			output += AllocatorStats::FormatString(L"\r\nTotal in slabs: %zu bytes\r\n", total);
+		}
+
+		{
+			auto& registry = GetThreadMagazinesRegistry<Type>();
+
+			std::lock_guard<Concurrency::SpinMutex> lock(registry.Mutex);
+
+			const auto format_hits = [&](const std::uint64_t hits, const std::uint64_t misses)
+			{
+				const auto total = hits + misses;
+				return AllocatorStats::FormatString(L"%12llu hits, %12llu misses (%5.1f%% hit rate)\r\n", hits, misses,
+													(total > 0) ? (static_cast<double>(hits) * 100.0 / static_cast<double>(total)) : 0.0);
+			};
+
+			output += AllocatorStats::FormatString(L"\r\n%s thread magazines:\r\n-----------------------------------------------\r\n", GetAllocatorName<Type>());
+
+			for (auto tm = registry.Threads; tm != nullptr; tm = tm->Next)
+			{
+				output += AllocatorStats::FormatString(L"Thread %8lu: ", tm->ThreadID);
+				output += format_hits(tm->Hits.load(std::memory_order_relaxed), tm->Misses.load(std::memory_order_relaxed));
+			}
+
+			output += L"Exited threads:  ";
+			output += format_hits(registry.ExitedThreadsHits, registry.ExitedThreadsMisses);
+		}
+
 		DbgInvoke([&]()
 		{
 			auto& pas = GetAllocatorStats<Type>();
@@ -177,8 +981,11 @@ namespace QuantumGate::Implementation::Memory::PoolAllocator
 		auto len = n;
 		auto manage = false;
 
-		if (n >= AllocatorConstants<Type>::PoolAllocationMinimumSize&&
-			n <= AllocatorConstants<Type>::PoolAllocationMaximumSize)
+		// Sizes up to the slab maximum are handled by the slabs; the pools take the sizes above that
+		constexpr auto minimum_size = (AllocatorConstants<Type>::SlabAllocationMaximumSize > 0) ?
+			AllocatorConstants<Type>::SlabAllocationMaximumSize + 1 : AllocatorConstants<Type>::PoolAllocationMinimumSize;
+
+		if (n >= minimum_size && n <= AllocatorConstants<Type>::PoolAllocationMaximumSize)
 		{
 			manage = true;
 			len = AllocatorConstants<Type>::PoolAllocationMinimumSize;
@@ -197,13 +1004,52 @@ namespace QuantumGate::Implementation::Memory::PoolAllocator
 	{
 		void* retbuf{ nullptr };
 
+		if constexpr (ThreadMagazines<Type>::NumSlabSizeClasses > 0)
+		{
+			if (n <= AllocatorConstants<Type>::SlabAllocationMaximumSize)
+			{
+				const auto len = ThreadMagazines<Type>::GetSlabAllocationSize(n);
+
+				retbuf = AllocateFromSlab<Type>(len);
+
+				DbgInvoke([&]()
+				{
+					GetAllocatorStats<Type>().WithUniqueLock()->AddAllocation(retbuf, len);
+				});
+
+				return retbuf;
+			}
+		}
+
 		const auto [manage, len] = GetAllocationDetails(n);
 
 		if (manage)
 		{
-			const auto GetBuffer = [](MemoryPoolData<Type>* mpd, const std::size_t len) -> void*
+			const auto tm = GetThreadMagazines<Type>();
+			const auto mag = (tm != nullptr) ? tm->GetMagazine(len) : nullptr;
+
+			if (mag != nullptr)
+			{
+				if (mag->Count > 0)
+				{
+					tm->AddHit();
+
+					retbuf = mag->Buffers[--mag->Count];
+
+					DbgInvoke([&]()
+					{
+						GetAllocatorStats<Type>().WithUniqueLock()->AddAllocation(retbuf, len);
+					});
+
+					return retbuf;
+				}
+				else tm->AddMiss();
+			}
+
+			const auto GetBuffer = [&](MemoryPoolData<Type>* mpd, const std::size_t len) -> void*
 			{
-				// If we have free buffers reuse one
+				// If we have free buffers reuse one, and refill the
+				// magazine (up to half its capacity) while we're at it
 				{
 					auto fbp = mpd->FreeBufferPool.WithUniqueLock();
 					if (!fbp->empty())
@@ -211,6 +1057,17 @@ namespace QuantumGate::Implementation::Memory::PoolAllocator
 						auto bufptr = reinterpret_cast<void*>(fbp->front());
 						fbp->pop_front();
 
+						if (mag != nullptr)
+						{
+							const auto refill = std::max(ThreadMagazines<Type>::GetCapacity(len) / 2, std::size_t{ 1 }) - 1;
+
+							while (mag->Count < refill && !fbp->empty())
+							{
+								mag->Buffers[mag->Count++] = reinterpret_cast<void*>(fbp->front());
+								fbp->pop_front();
+							}
+						}
+
 						return bufptr;
 					}
 				}
@@ -287,10 +1144,74 @@ namespace QuantumGate::Implementation::Memory::PoolAllocator
 	{
 		auto found = false;
 
+		if constexpr (ThreadMagazines<Type>::NumSlabSizeClasses > 0)
+		{
+			if (n <= AllocatorConstants<Type>::SlabAllocationMaximumSize)
+			{
+				const auto len = ThreadMagazines<Type>::GetSlabAllocationSize(n);
+
+				found = IsSlabObject<Type>(p, len);
+				if (found)
+				{
+					// Wipe all data from used memory, as the
+					// unmanaged allocator would have done
+					MemClear(p, n);
+
+					FreeToSlab<Type>(p, len);
+
+					DbgInvoke([&]()
+					{
+						GetAllocatorStats<Type>().WithUniqueLock()->RemoveAllocation(p, len);
+					});
+				}
+
+				return found;
+			}
+		}
+
 		const auto [manage, len] = GetAllocationDetails(n);
 
 		if (manage)
 		{
+			const auto tm = GetThreadMagazines<Type>();
+			if (const auto mag = (tm != nullptr) ? tm->GetMagazine(len) : nullptr; mag != nullptr)
+			{
+				// Make sure the buffer belongs to the pool before it goes into the
+				// magazine; this only takes shared locks, so frees on different
+				// threads still don't contend with each other
+				{
+					const auto mpm = GetMemoryPoolMap<Type>().WithSharedLock();
+					if (const auto it = mpm->find(len); it != mpm->end())
+					{
+						found = it->second->MemoryBufferPool.WithSharedLock()->contains(reinterpret_cast<std::uintptr_t>(p));
+					}
+				}
+
+				if (found)
+				{
+					const auto capacity = ThreadMagazines<Type>::GetCapacity(len);
+					if (mag->Count == capacity)
+					{
+						FlushMagazine<Type>(*mag, len, std::max(capacity / 2, std::size_t{ 1 }));
+					}
+
+					if constexpr (std::is_same_v<Type, ProtectedPool>)
+					{
+						// Wipe all data from used memory
+						MemClear(p, len);
+					}
+
+					mag->Buffers[mag->Count++] = p;
+
+					DbgInvoke([&]()
+					{
+						GetAllocatorStats<Type>().WithUniqueLock()->RemoveAllocation(p, len);
+					});
+				}
+
+				return found;
+			}
+
 			const auto mpm = GetMemoryPoolMap<Type>().WithSharedLock();
 
 			if (const auto it = mpm->find(len); it != mpm->end())
@@ -361,6 +1282,15 @@ namespace QuantumGate::Implementation::Memory::PoolAllocator
 	template<typename Type>
 	void AllocatorBase<Type>::FreeUnused() noexcept
 	{
+		// Magazines of other threads can't be reached from here;
+		// they get flushed when their threads exit
+		if (const auto tm = GetThreadMagazines<Type>(); tm != nullptr)
+		{
+			FlushThreadMagazines<Type>(*tm);
+		}
+
+		FreeUnusedSlabs<Type>();
+
 		auto mpm = GetMemoryPoolMap<Type>().WithUniqueLock();
 
 		for (auto it = mpm->begin(); it != mpm->end();)
@@ -400,6 +1330,10 @@ namespace QuantumGate::Implementation::Memory::PoolAllocator
 				if (mbp->size() == 0) remove = true;
 			}
 
+			// Release the locks before the pool (and its mutexes) gets destroyed
+			fbp.Unlock();
+			mbp.Unlock();
+
 			if (remove) it = mpm->erase(it);
 			else ++it;
 		}
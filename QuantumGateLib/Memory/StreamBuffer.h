@@ -0,0 +1,277 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#pragma once
+
+#include "Buffer.h"
+
+namespace QuantumGate::Implementation::Memory
+{
+	// Buffer for stream data that gets added at the back and consumed from the
+	// front in arbitrary amounts, such as socket send and receive buffers. The data
+	// lives somewhere in the middle of the underlying memory; there's free room in
+	// front of it (headroom) and behind it (tailroom). Removing data from the front
+	// only moves the read offset, and headers can be added in front of the data
+	// without moving it as long as there's enough headroom. The data gets moved back
+	// to the front only when that costs no more than the data that was consumed.
+	template<template<typename> typename A = FreeStoreAllocator>
+	class StreamBufferImpl
+	{
+	public:
+		using VectorType = std::vector<Byte, A<Byte>>;
+		using BufferType = BufferImpl<A>;
+		using SizeType = Size;
+
+		StreamBufferImpl() noexcept {}
+
+		// The headroom is kept free in front of the data whenever the buffer
+		// gets (re)allocated or emptied, for adding headers with AddFirst()
+		explicit StreamBufferImpl(const Size headroom) noexcept :
+			m_Headroom(headroom)
+		{}
+
+		StreamBufferImpl(const StreamBufferImpl& other) :
+			m_Headroom(other.m_Headroom)
+		{
+			*this += other;
+		}
+
+		StreamBufferImpl(StreamBufferImpl&& other) noexcept :
+			m_Buffer(std::move(other.m_Buffer)),
+			m_Headroom(other.m_Headroom),
+			m_Begin(std::exchange(other.m_Begin, 0)),
+			m_End(std::exchange(other.m_End, 0))
+		{}
+
+		StreamBufferImpl(BufferType&& buffer) noexcept :
+			m_Buffer(std::move(buffer.GetVector())),
+			m_End(m_Buffer.size())
+		{}
+
+		StreamBufferImpl(const BufferView& other) { *this += other; }
+
+		~StreamBufferImpl() = default;
+
+		inline explicit operator bool() const noexcept { return !IsEmpty(); }
+
+		inline Byte& operator[](const Size index) noexcept
+		{
+			assert(index < GetSize());
+
+			return m_Buffer[m_Begin + index];
+		}
+
+		inline const Byte& operator[](const Size index) const noexcept
+		{
+			assert(index < GetSize());
+
+			return m_Buffer[m_Begin + index];
+		}
+
+		inline StreamBufferImpl& operator=(const StreamBufferImpl& other)
+		{
+			// Check for same object
+			if (this == &other) return *this;
+
+			Clear();
+			*this += other;
+
+			return *this;
+		}
+
+		inline StreamBufferImpl& operator=(StreamBufferImpl&& other) noexcept
+		{
+			// Check for same object
+			if (this == &other) return *this;
+
+			m_Buffer = std::move(other.m_Buffer);
+			m_Headroom = other.m_Headroom;
+			m_Begin = std::exchange(other.m_Begin, 0);
+			m_End = std::exchange(other.m_End, 0);
+
+			return *this;
+		}
+
+		// Takes over the memory of the buffer; no data gets copied
+		inline StreamBufferImpl& operator=(BufferType&& buffer) noexcept
+		{
+			m_Buffer = std::move(buffer.GetVector());
+			m_Begin = 0;
+			m_End = m_Buffer.size();
+
+			return *this;
+		}
+
+		inline StreamBufferImpl& operator=(const BufferView& buffer)
+		{
+			Clear();
+			*this += buffer;
+
+			return *this;
+		}
+
+		inline bool operator==(const BufferView& other) const noexcept
+		{
+			return (this->operator BufferView() == other);
+		}
+
+		inline bool operator!=(const BufferView& other) const noexcept
+		{
+			return (this->operator BufferView() != other);
+		}
+
+		inline operator BufferView() const noexcept { return { GetBytes(), GetSize() }; }
+		inline operator BufferSpan() noexcept { return { GetBytes(), GetSize() }; }
+
+		inline StreamBufferImpl& operator+=(const StreamBufferImpl& other) { AddLast(other); return *this; }
+		inline StreamBufferImpl& operator+=(const BufferView& buffer) { AddLast(buffer); return *this; }
+
+		[[nodiscard]] inline Byte* GetBytes() noexcept { return m_Buffer.data() + m_Begin; }
+		[[nodiscard]] inline const Byte* GetBytes() const noexcept { return m_Buffer.data() + m_Begin; }
+
+		[[nodiscard]] inline Size GetSize() const noexcept { return m_End - m_Begin; }
+
+		[[nodiscard]] inline bool IsEmpty() const noexcept { return (m_Begin == m_End); }
+
+		[[nodiscard]] inline Size GetHeadroomSize() const noexcept { return m_Begin; }
+		[[nodiscard]] inline Size GetTailroomSize() const noexcept { return m_Buffer.size() - m_End; }
+
+		inline void Swap(StreamBufferImpl& other) noexcept
+		{
+			m_Buffer.swap(other.m_Buffer);
+			m_Headroom = std::exchange(other.m_Headroom, m_Headroom);
+			m_Begin = std::exchange(other.m_Begin, m_Begin);
+			m_End = std::exchange(other.m_End, m_End);
+		}
+
+		inline void Preallocate(const Size size) { MakeTailroom(size); }
+
+		inline void FreeUnused()
+		{
+			if (IsEmpty())
+			{
+				VectorType().swap(m_Buffer);
+				m_Begin = 0;
+				m_End = 0;
+			}
+			else if (m_Buffer.size() > m_Headroom + GetSize())
+			{
+				Reallocate(0);
+			}
+		}
+
+		inline void Clear() noexcept
+		{
+			m_Begin = std::min(m_Headroom, m_Buffer.size());
+			m_End = m_Begin;
+		}
+
+		inline void AddFirst(const BufferView& buffer)
+		{
+			if (buffer.IsEmpty()) return;
+
+			if (buffer.GetSize() > m_Begin)
+			{
+				Reallocate(0, buffer.GetSize());
+			}
+
+			m_Begin -= buffer.GetSize();
+			std::memcpy(GetBytes(), buffer.GetBytes(), buffer.GetSize());
+		}
+
+		inline void AddLast(const BufferView& buffer)
+		{
+			if (buffer.IsEmpty()) return;
+
+			MakeTailroom(buffer.GetSize());
+
+			std::memcpy(m_Buffer.data() + m_End, buffer.GetBytes(), buffer.GetSize());
+			m_End += buffer.GetSize();
+		}
+
+		inline void RemoveFirst(const Size num) noexcept
+		{
+			assert(GetSize() >= num);
+
+			m_Begin += std::min(num, GetSize());
+
+			// Start over with all the room available
+			// once all data has been consumed
+			if (IsEmpty()) Clear();
+		}
+
+		inline void RemoveLast(const Size num) noexcept
+		{
+			assert(GetSize() >= num);
+
+			m_End -= std::min(num, GetSize());
+
+			if (IsEmpty()) Clear();
+		}
+
+		// Returns (at least) size bytes of free room at the back of the buffer so that
+		// data can be written there directly (for example by a socket receive call);
+		// CommitTailroom() adds the bytes that were actually written to the data
+		[[nodiscard]] inline BufferSpan GetTailroom(const Size size)
+		{
+			MakeTailroom(size);
+
+			return { m_Buffer.data() + m_End, GetTailroomSize() };
+		}
+
+		inline void CommitTailroom(const Size num) noexcept
+		{
+			assert(GetTailroomSize() >= num);
+
+			m_End += std::min(num, GetTailroomSize());
+		}
+
+	private:
+		inline void MakeTailroom(const Size size)
+		{
+			if (GetTailroomSize() >= size) return;
+
+			const auto data_size = GetSize();
+			const auto consumed = (m_Begin > m_Headroom) ? m_Begin - m_Headroom : 0;
+
+			if (consumed >= data_size && m_Headroom + data_size + size <= m_Buffer.size())
+			{
+				// Moving the data back to the front costs no more than
+				// the data that was consumed since the last move
+				std::memmove(m_Buffer.data() + m_Headroom, GetBytes(), data_size);
+				m_Begin = m_Headroom;
+				m_End = m_Headroom + data_size;
+			}
+			else
+			{
+				Reallocate(std::max(size, data_size));
+			}
+		}
+
+		inline void Reallocate(const Size tailroom, const Size min_headroom = 0)
+		{
+			const auto headroom = std::max(m_Headroom, min_headroom);
+			const auto data_size = GetSize();
+
+			VectorType new_buffer(headroom + data_size + tailroom, Byte{ 0 }, m_Buffer.get_allocator());
+
+			if (data_size > 0)
+			{
+				std::memcpy(new_buffer.data() + headroom, GetBytes(), data_size);
+			}
+
+			m_Buffer.swap(new_buffer);
+			m_Begin = headroom;
+			m_End = headroom + data_size;
+		}
+
+	private:
+		VectorType m_Buffer;
+		Size m_Headroom{ 0 };
+		Size m_Begin{ 0 };
+		Size m_End{ 0 };
+	};
+
+	using FreeStreamBuffer = StreamBufferImpl<>;
+	using StreamBuffer = StreamBufferImpl<DefaultAllocator>;
+}
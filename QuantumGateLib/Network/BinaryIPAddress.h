@@ -335,6 +335,28 @@ namespace QuantumGate::Implementation::Network
 			return false;
 		}
 
+		[[nodiscard]] static constexpr bool GetCIDRLeadingBits(const BinaryIPAddress& bin_mask,
+															   UInt8& cidr_lbits) noexcept
+		{
+			if (!IsMask(bin_mask)) return false;
+
+			// The mask is contiguous so the number
+			// of bits that are set is all we need
+			UInt8 lbits{ 0 };
+
+			for (auto x = 0u; x < bin_mask.GetNumAddressBytes(); ++x)
+			{
+				for (auto byte = static_cast<UChar>(bin_mask.GetAddressByte(x)); byte != 0; byte &= byte - 1)
+				{
+					++lbits;
+				}
+			}
+
+			cidr_lbits = lbits;
+
+			return true;
+		}
+
 		[[nodiscard]] static constexpr bool GetNetwork(const BinaryIPAddress& bin_ipaddr,
 													   const UInt8 cidr_lbits,
 													   BinaryIPAddress& bin_network) noexcept
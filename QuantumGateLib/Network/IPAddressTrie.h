@@ -0,0 +1,452 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#pragma once
+
+#include "BinaryIPAddress.h"
+
+namespace QuantumGate::Implementation::Network
+{
+	// Path compressed binary (Patricia) trie of IPv4 and IPv6 network prefixes (CIDR ranges)
+	// with a value for each prefix. Each node has the bits of a prefix in common with all of its
+	// descendants, so nodes are only needed where prefixes branch off and a lookup takes at most
+	// as many steps as there are bits in an address, no matter how many prefixes there are.
+	// The nodes are kept together in a vector and refer to each other by index.
+	template<typename T>
+	class IPAddressTrie final
+	{
+		using NodeIndex = UInt32;
+
+		static constexpr NodeIndex InvalidIndex{ std::numeric_limits<NodeIndex>::max() };
+		static constexpr UInt8 MaxPrefixLength{ 128 };
+
+		struct Node final
+		{
+			BinaryIPAddress Prefix; // Network byte order (big endian); bits after PrefixLength are zero
+			UInt8 PrefixLength{ 0 };
+			std::array<NodeIndex, 2> Children{ InvalidIndex, InvalidIndex };
+			std::optional<T> Value; // Nodes without a value only connect their children
+		};
+
+		// Path from the root down to a node; each node
+		// on the path has a longer prefix than its parent
+		using NodePath = std::array<NodeIndex, MaxPrefixLength + 1>;
+
+	public:
+		IPAddressTrie() noexcept = default;
+		IPAddressTrie(const IPAddressTrie&) = default;
+		IPAddressTrie(IPAddressTrie&&) noexcept = default;
+		~IPAddressTrie() = default;
+		IPAddressTrie& operator=(const IPAddressTrie&) = default;
+		IPAddressTrie& operator=(IPAddressTrie&&) noexcept = default;
+
+		[[nodiscard]] inline Size GetSize() const noexcept { return m_Size; }
+		[[nodiscard]] inline bool IsEmpty() const noexcept { return (m_Size == 0); }
+
+		// Makes room for the given number of prefixes; useful
+		// before adding a large number of prefixes at once
+		inline void Reserve(const Size num)
+		{
+			// A trie with n prefixes has at most 2n - 1 nodes
+			m_Nodes.reserve((num > 0) ? (num * 2) - 1 : 0);
+		}
+
+		inline void Clear() noexcept
+		{
+			m_Nodes.clear();
+			m_FreeNodes.clear();
+			m_IPv4Root = InvalidIndex;
+			m_IPv6Root = InvalidIndex;
+			m_Size = 0;
+		}
+
+		// Adds the value for the network with the given prefix length (bits of the address after
+		// the prefix length are ignored) if it doesn't exist yet. Returns the value for the network
+		// and whether it was added, or a null pointer if the arguments are invalid.
+		template<typename V>
+		std::pair<T*, bool> Insert(const BinaryIPAddress& network, const UInt8 prefix_len, V&& value)
+		{
+			BinaryIPAddress prefix;
+			if (!BinaryIPAddress::GetNetwork(network, prefix_len, prefix)) return { nullptr, false };
+
+			// Parent of the node we're looking at and the child
+			// slot we came through; the root has no parent
+			auto parent = InvalidIndex;
+			UInt8 bit{ 0 };
+
+			auto index = GetRoot(prefix.AddressFamily);
+
+			while (index != InvalidIndex)
+			{
+				auto& node = m_Nodes[index];
+				const auto common_len = GetCommonPrefixLength(node.Prefix, prefix,
+															  std::min(node.PrefixLength, prefix_len));
+
+				if (common_len == node.PrefixLength)
+				{
+					if (node.PrefixLength == prefix_len)
+					{
+						if (node.Value.has_value()) return { &*node.Value, false };
+
+						node.Value.emplace(std::forward<V>(value));
+						++m_Size;
+
+						return { &*node.Value, true };
+					}
+
+					parent = index;
+					bit = GetBit(prefix, node.PrefixLength);
+					index = node.Children[bit];
+					continue;
+				}
+
+				// The prefix branches off (or ends) somewhere above this node; note that
+				// references to nodes are no longer valid after adding new nodes
+				const auto old_index = index;
+				const auto old_bit = GetBit(node.Prefix, common_len);
+
+				if (common_len == prefix_len)
+				{
+					// New node goes in between as the parent
+					const auto new_index = AddNode(prefix, prefix_len);
+					m_Nodes[new_index].Children[old_bit] = old_index;
+					m_Nodes[new_index].Value.emplace(std::forward<V>(value));
+					GetLink(parent, bit, prefix.AddressFamily) = new_index;
+					++m_Size;
+
+					return { &*m_Nodes[new_index].Value, true };
+				}
+				else
+				{
+					// New node goes next to the existing node
+					// under a new node for the common bits
+					BinaryIPAddress common_prefix;
+					[[maybe_unused]] const auto success = BinaryIPAddress::GetNetwork(prefix, common_len, common_prefix);
+					assert(success);
+
+					const auto branch_index = AddNode(common_prefix, common_len);
+					const auto new_index = AddNode(prefix, prefix_len);
+					m_Nodes[new_index].Value.emplace(std::forward<V>(value));
+					m_Nodes[branch_index].Children[old_bit] = old_index;
+					m_Nodes[branch_index].Children[old_bit ^ 1] = new_index;
+					GetLink(parent, bit, prefix.AddressFamily) = branch_index;
+					++m_Size;
+
+					return { &*m_Nodes[new_index].Value, true };
+				}
+			}
+
+			const auto new_index = AddNode(prefix, prefix_len);
+			m_Nodes[new_index].Value.emplace(std::forward<V>(value));
+			GetLink(parent, bit, prefix.AddressFamily) = new_index;
+			++m_Size;
+
+			return { &*m_Nodes[new_index].Value, true };
+		}
+
+		// Removes the value for the network with the given prefix length
+		bool Remove(const BinaryIPAddress& network, const UInt8 prefix_len) noexcept
+		{
+			NodePath path;
+			Size depth{ 0 };
+
+			if (!FindNode(network, prefix_len, path, depth)) return false;
+
+			const auto index = path[depth - 1];
+			auto& node = m_Nodes[index];
+			node.Value.reset();
+			--m_Size;
+
+			const auto num_children = GetNumChildren(node);
+			if (num_children == 2)
+			{
+				// Still needed to connect the children
+				return true;
+			}
+
+			const auto parent = (depth > 1) ? path[depth - 2] : InvalidIndex;
+			const auto parent_bit = (parent != InvalidIndex) ? GetBit(node.Prefix, m_Nodes[parent].PrefixLength) : UInt8{ 0 };
+
+			if (num_children == 1)
+			{
+				// The child takes the place of the node
+				GetLink(parent, parent_bit, node.Prefix.AddressFamily) = GetOnlyChild(node);
+				FreeNode(index);
+			}
+			else
+			{
+				GetLink(parent, parent_bit, node.Prefix.AddressFamily) = InvalidIndex;
+				FreeNode(index);
+
+				// A parent without a value that was only there to connect
+				// two children isn't needed anymore with one child left
+				if (parent != InvalidIndex)
+				{
+					auto& parent_node = m_Nodes[parent];
+					if (!parent_node.Value.has_value())
+					{
+						assert(GetNumChildren(parent_node) == 1);
+
+						const auto grandparent = (depth > 2) ? path[depth - 3] : InvalidIndex;
+						const auto grandparent_bit = (grandparent != InvalidIndex) ?
+							GetBit(parent_node.Prefix, m_Nodes[grandparent].PrefixLength) : UInt8{ 0 };
+
+						GetLink(grandparent, grandparent_bit, parent_node.Prefix.AddressFamily) = GetOnlyChild(parent_node);
+						FreeNode(parent);
+					}
+				}
+			}
+
+			return true;
+		}
+
+		// Removes all values for which the function returns true; the function gets called
+		// with the network and prefix length of each value and the value itself
+		template<typename F>
+		void RemoveIf(F&& function)
+		{
+			Vector<std::pair<BinaryIPAddress, UInt8>> prefixes;
+
+			for (const auto& node : m_Nodes)
+			{
+				if (node.Value.has_value() && function(node.Prefix, node.PrefixLength, *node.Value))
+				{
+					prefixes.emplace_back(node.Prefix, node.PrefixLength);
+				}
+			}
+
+			for (const auto& prefix : prefixes)
+			{
+				[[maybe_unused]] const auto success = Remove(prefix.first, prefix.second);
+				assert(success);
+			}
+		}
+
+		// Returns the value for the network with the given prefix length
+		[[nodiscard]] T* Find(const BinaryIPAddress& network, const UInt8 prefix_len) noexcept
+		{
+			return const_cast<T*>(std::as_const(*this).Find(network, prefix_len));
+		}
+
+		[[nodiscard]] const T* Find(const BinaryIPAddress& network, const UInt8 prefix_len) const noexcept
+		{
+			NodePath path;
+			Size depth{ 0 };
+
+			if (FindNode(network, prefix_len, path, depth))
+			{
+				return &*m_Nodes[path[depth - 1]].Value;
+			}
+
+			return nullptr;
+		}
+
+		// Returns the value for the most specific (longest) network that contains the address
+		[[nodiscard]] const T* FindLongestMatch(const BinaryIPAddress& ip) const noexcept
+		{
+			const T* value{ nullptr };
+
+			ForEachMatch(ip, [&](const UInt8, const T& match_value) noexcept
+			{
+				value = &match_value;
+				return true;
+			});
+
+			return value;
+		}
+
+		[[nodiscard]] bool HasMatch(const BinaryIPAddress& ip) const noexcept
+		{
+			auto found = false;
+
+			ForEachMatch(ip, [&](const UInt8, const T&) noexcept
+			{
+				found = true;
+				return false;
+			});
+
+			return found;
+		}
+
+		// Calls the function for each network that contains the address, from the least to the
+		// most specific (shortest to longest prefix), with the prefix length and the value of the
+		// network; the function returns false to stop early
+		template<typename F>
+		void ForEachMatch(const BinaryIPAddress& ip, F&& function) const
+		{
+			const auto max_len = static_cast<UInt8>(BinaryIPAddress::GetNumAddressBytes(ip.AddressFamily) * 8);
+			if (max_len == 0) return;
+
+			// Follow the bits of the address down the trie without comparing the skipped bits;
+			// all nodes on the path have prefixes of the prefix of the last node so comparing
+			// the last node tells us for all of them whether they contain the address
+			NodePath path;
+			Size depth{ 0 };
+
+			for (auto index = GetRoot(ip.AddressFamily); index != InvalidIndex;)
+			{
+				const auto& node = m_Nodes[index];
+				path[depth++] = index;
+
+				if (node.PrefixLength >= max_len) break;
+
+				index = node.Children[GetBit(ip, node.PrefixLength)];
+			}
+
+			if (depth == 0) return;
+
+			const auto& last = m_Nodes[path[depth - 1]];
+			const auto common_len = GetCommonPrefixLength(last.Prefix, ip, last.PrefixLength);
+
+			for (Size x = 0; x < depth; ++x)
+			{
+				const auto& node = m_Nodes[path[x]];
+				if (node.PrefixLength > common_len) break;
+
+				if (node.Value.has_value())
+				{
+					if (!function(node.PrefixLength, *node.Value)) break;
+				}
+			}
+		}
+
+	private:
+		[[nodiscard]] inline static UInt8 GetBit(const BinaryIPAddress& ip, const UInt8 bit) noexcept
+		{
+			assert(bit < MaxPrefixLength);
+
+			return static_cast<UInt8>((static_cast<UChar>(ip.GetAddressByte(bit / 8)) >> (7 - (bit % 8))) & 1);
+		}
+
+		[[nodiscard]] static UInt8 GetCommonPrefixLength(const BinaryIPAddress& ip1, const BinaryIPAddress& ip2,
+														 const UInt8 max_len) noexcept
+		{
+			UInt8 len{ 0 };
+
+			for (auto x = 0u; len < max_len; ++x)
+			{
+				auto diff = static_cast<UChar>(ip1.GetAddressByte(x) ^ ip2.GetAddressByte(x));
+				if (diff == 0)
+				{
+					len += 8;
+					continue;
+				}
+
+				while ((diff & 0x80) == 0)
+				{
+					++len;
+					diff <<= 1;
+				}
+
+				break;
+			}
+
+			return std::min(len, max_len);
+		}
+
+		[[nodiscard]] inline static Size GetNumChildren(const Node& node) noexcept
+		{
+			return static_cast<Size>(node.Children[0] != InvalidIndex) + static_cast<Size>(node.Children[1] != InvalidIndex);
+		}
+
+		[[nodiscard]] inline static NodeIndex GetOnlyChild(const Node& node) noexcept
+		{
+			return (node.Children[0] != InvalidIndex) ? node.Children[0] : node.Children[1];
+		}
+
+		[[nodiscard]] inline NodeIndex GetRoot(const BinaryIPAddress::Family af) const noexcept
+		{
+			switch (af)
+			{
+				case BinaryIPAddress::Family::IPv4:
+					return m_IPv4Root;
+				case BinaryIPAddress::Family::IPv6:
+					return m_IPv6Root;
+				default:
+					break;
+			}
+
+			return InvalidIndex;
+		}
+
+		// Returns the reference to the node below the parent, or to the root
+		// of the address family if there's no parent
+		[[nodiscard]] inline NodeIndex& GetLink(const NodeIndex parent, const UInt8 bit,
+												const BinaryIPAddress::Family af) noexcept
+		{
+			if (parent != InvalidIndex) return m_Nodes[parent].Children[bit];
+
+			assert(af == BinaryIPAddress::Family::IPv4 || af == BinaryIPAddress::Family::IPv6);
+
+			return (af == BinaryIPAddress::Family::IPv4) ? m_IPv4Root : m_IPv6Root;
+		}
+
+		[[nodiscard]] bool FindNode(const BinaryIPAddress& network, const UInt8 prefix_len,
+									NodePath& path, Size& depth) const noexcept
+		{
+			BinaryIPAddress prefix;
+			if (!BinaryIPAddress::GetNetwork(network, prefix_len, prefix)) return false;
+
+			for (auto index = GetRoot(prefix.AddressFamily); index != InvalidIndex;)
+			{
+				const auto& node = m_Nodes[index];
+				if (node.PrefixLength > prefix_len) break;
+
+				path[depth++] = index;
+
+				if (node.PrefixLength == prefix_len)
+				{
+					return (node.Prefix == prefix && node.Value.has_value());
+				}
+
+				index = node.Children[GetBit(prefix, node.PrefixLength)];
+			}
+
+			return false;
+		}
+
+		[[nodiscard]] NodeIndex AddNode(const BinaryIPAddress& prefix, const UInt8 prefix_len)
+		{
+			NodeIndex index{ InvalidIndex };
+
+			if (!m_FreeNodes.empty())
+			{
+				index = m_FreeNodes.back();
+				m_FreeNodes.pop_back();
+			}
+			else
+			{
+				if (m_Nodes.size() >= InvalidIndex) throw std::length_error("Too many nodes in IP address trie.");
+
+				index = static_cast<NodeIndex>(m_Nodes.size());
+				m_Nodes.emplace_back();
+			}
+
+			auto& node = m_Nodes[index];
+			node.Prefix = prefix;
+			node.PrefixLength = prefix_len;
+			node.Children = { InvalidIndex, InvalidIndex };
+
+			return index;
+		}
+
+		void FreeNode(const NodeIndex index) noexcept
+		{
+			auto& node = m_Nodes[index];
+			node.Value.reset();
+			node.Children = { InvalidIndex, InvalidIndex };
+
+			// If the node can't be kept for reuse it just
+			// stays unused until the trie gets cleared
+			try { m_FreeNodes.push_back(index); }
+			catch (...) {}
+		}
+
+	private:
+		Vector<Node> m_Nodes;
+		Vector<NodeIndex> m_FreeNodes;
+		NodeIndex m_IPv4Root{ InvalidIndex };
+		NodeIndex m_IPv6Root{ InvalidIndex };
+		Size m_Size{ 0 };
+	};
+}
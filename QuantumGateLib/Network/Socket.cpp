@@ -141,6 +141,9 @@ namespace QuantumGate::Implementation::Network
 		m_IOStatus(std::exchange(other.m_IOStatus, IOStatus{})),
 		m_BytesReceived(std::exchange(other.m_BytesReceived, 0)),
 		m_BytesSent(std::exchange(other.m_BytesSent, 0)),
+		m_DatagramStatistics(std::exchange(other.m_DatagramStatistics, DatagramStatistics{})),
+		m_SendSegmentationSupported(std::exchange(other.m_SendSegmentationSupported, std::nullopt)),
+		m_SendSegmentSize(std::exchange(other.m_SendSegmentSize, 0)),
 		m_LocalEndpoint(std::move(other.m_LocalEndpoint)),
 		m_PeerEndpoint(std::move(other.m_PeerEndpoint)),
 		m_ConnectedSteadyTime(std::exchange(other.m_ConnectedSteadyTime, SteadyTime{}))
@@ -162,6 +165,10 @@ namespace QuantumGate::Implementation::Network
 		m_BytesReceived = std::exchange(other.m_BytesReceived, 0);
 		m_BytesSent = std::exchange(other.m_BytesSent, 0);
 
+		m_DatagramStatistics = std::exchange(other.m_DatagramStatistics, DatagramStatistics{});
+		m_SendSegmentationSupported = std::exchange(other.m_SendSegmentationSupported, std::nullopt);
+		m_SendSegmentSize = std::exchange(other.m_SendSegmentSize, 0);
+
 		m_LocalEndpoint = std::move(other.m_LocalEndpoint);
 		m_PeerEndpoint = std::move(other.m_PeerEndpoint);
 
@@ -998,17 +1005,28 @@ namespace QuantumGate::Implementation::Network
 			}
 		});
 
+		// A datagram that's larger than the send segment size (set by SendToBatch())
+		// would otherwise get split up into several datagrams
+		if (m_SendSegmentSize > 0 && send_size > m_SendSegmentSize)
+		{
+			if (!SetSendSegmentSize(0)) return ResultCode::Failed;
+		}
+
 		const auto bytessent = sendto(m_Socket, reinterpret_cast<const char*>(buffer.GetBytes()),
 									  static_cast<int>(send_size), 0,
 									  reinterpret_cast<sockaddr*>(&sock_addr), sizeof(sock_addr));
 
 		Dbg(L"%d bytes sent", bytessent);
 
+		++m_DatagramStatistics.NumSendCalls;
+
 		if (bytessent >= 0)
 		{
 			// Update the total amount of bytes sent
 			m_BytesSent += bytessent;
 
+			if (bytessent > 0) ++m_DatagramStatistics.NumSent;
+
 			if (!m_IOStatus.IsBound() && GetType() == Type::Datagram)
 			{
 				m_IOStatus.SetBound(true);
@@ -1040,6 +1058,182 @@ namespace QuantumGate::Implementation::Network
 		return ResultCode::Failed;
 	}
 
+	Result<Size> Socket::SendToBatch(const Endpoint& endpoint, const Vector<BufferView>& buffers) noexcept
+	{
+		assert(m_Socket != INVALID_SOCKET);
+		assert(GetType() == Type::Datagram && GetProtocol() == Protocol::UDP);
+
+		if (buffers.empty()) return 0;
+
+		// Determine how many datagrams at the front can be sent as segments of one buffer;
+		// all segments have the size of the first one except for the last one which may be smaller
+		const auto segment_size = buffers[0].GetSize();
+		Size num{ 1 };
+		Size total_size{ segment_size };
+
+		if (segment_size > 0 && IsSendSegmentationSupported())
+		{
+			while (num < buffers.size() && num < MaxDatagramBatchSize)
+			{
+				const auto size = buffers[num].GetSize();
+				if (size == 0 || size > segment_size || total_size + size > MaxDatagramBatchByteSize) break;
+
+				total_size += size;
+				++num;
+
+				if (size < segment_size) break;
+			}
+		}
+
+		if (num == 1)
+		{
+			const auto result = SendTo(endpoint, buffers[0]);
+			if (result.Succeeded())
+			{
+				// If data was actually sent, otherwise buffer
+				// may temporarily be full/unavailable
+				return (*result == segment_size) ? 1 : 0;
+			}
+
+			return result.GetErrorCode();
+		}
+
+#ifdef UDP_SEND_MSG_SIZE
+		sockaddr_storage sock_addr{ 0 };
+		if (!SockAddrSetEndpoint(sock_addr, endpoint))
+		{
+			LogDbg(L"Send error on endpoint %s - SockAddrFill() failed for endpoint %s",
+				   GetLocalName().c_str(), endpoint.GetString().c_str());
+			return ResultCode::Failed;
+		}
+
+		if (!SetSendSegmentSize(segment_size))
+		{
+			// Fall back to sending one datagram per call
+			m_SendSegmentationSupported = false;
+			return SendToBatch(endpoint, buffers);
+		}
+
+		std::array<WSABUF, MaxDatagramBatchSize> wsabufs;
+		for (Size x = 0; x < num; ++x)
+		{
+			wsabufs[x].buf = reinterpret_cast<char*>(const_cast<Byte*>(buffers[x].GetBytes()));
+			wsabufs[x].len = static_cast<ULONG>(buffers[x].GetSize());
+		}
+
+		WSAMSG msg{ 0 };
+		msg.name = reinterpret_cast<sockaddr*>(&sock_addr);
+		msg.namelen = sizeof(sock_addr);
+		msg.lpBuffers = wsabufs.data();
+		msg.dwBufferCount = static_cast<DWORD>(num);
+
+		DWORD bytessent{ 0 };
+		const auto ret = WSASendMsg(m_Socket, &msg, 0, &bytessent, nullptr, nullptr);
+
+		Dbg(L"%u bytes sent in %zu datagrams", bytessent, num);
+
+		++m_DatagramStatistics.NumSendCalls;
+
+		if (ret == 0)
+		{
+			// Update the total amount of bytes sent
+			m_BytesSent += bytessent;
+
+			if (!m_IOStatus.IsBound())
+			{
+				m_IOStatus.SetBound(true);
+				UpdateSocketInfo();
+			}
+
+			// Data gets sent completely or not at all
+			if (bytessent == total_size)
+			{
+				m_DatagramStatistics.NumSent += num;
+				return num;
+			}
+
+			return 0;
+		}
+		else
+		{
+			const auto error = WSAGetLastError();
+			if (error == WSAENOBUFS || error == WSAEWOULDBLOCK)
+			{
+				// Send buffer is full or temporarily unavailable, we'll try again later
+				LogDbg(L"Send buffer full/unavailable on endpoint %s (%s)",
+					   GetLocalName().c_str(), GetLastSocketErrorString().c_str());
+
+				return 0;
+			}
+			else if (error == WSAEINVAL || error == WSAEOPNOTSUPP)
+			{
+				// Segmentation offload isn't usable for this send after all;
+				// stop using it and fall back to sending one datagram per call
+				LogDbg(L"Send segmentation failed on endpoint %s (%s); disabling it",
+					   GetLocalName().c_str(), GetLastSocketErrorString().c_str());
+
+				m_SendSegmentationSupported = false;
+				DiscardReturnValue(SetSendSegmentSize(0));
+
+				return SendToBatch(endpoint, buffers);
+			}
+			else
+			{
+				LogDbg(L"Send error on endpoint %s (%s)",
+					   GetLocalName().c_str(), GetLastSocketErrorString().c_str());
+
+				return std::error_code(error, std::system_category());
+			}
+		}
+#else
+		// Shouldn't get here
+		assert(false);
+		return ResultCode::Failed;
+#endif
+	}
+
+	bool Socket::IsSendSegmentationSupported() noexcept
+	{
+		if (!m_SendSegmentationSupported.has_value())
+		{
+#ifdef UDP_SEND_MSG_SIZE
+			// UDP send segmentation offload is supported if the
+			// socket option can be read (Windows 10 version 2004+)
+			// Docs: https://docs.microsoft.com/en-us/windows/win32/winsock/ipproto-udp-socket-options
+			DWORD value{ 0 };
+			int value_len = sizeof(value);
+
+			m_SendSegmentationSupported = (getsockopt(m_Socket, IPPROTO_UDP, UDP_SEND_MSG_SIZE,
+													  reinterpret_cast<char*>(&value), &value_len) != SOCKET_ERROR);
+#else
+			m_SendSegmentationSupported = false;
+#endif
+		}
+
+		return *m_SendSegmentationSupported;
+	}
+
+	bool Socket::SetSendSegmentSize(const Size size) noexcept
+	{
+		if (m_SendSegmentSize == size) return true;
+
+#ifdef UDP_SEND_MSG_SIZE
+		const DWORD value = static_cast<DWORD>(size);
+		if (setsockopt(m_Socket, IPPROTO_UDP, UDP_SEND_MSG_SIZE,
+					   reinterpret_cast<const char*>(&value), sizeof(value)) == SOCKET_ERROR)
+		{
+			LogErr(L"Could not set send segment size for endpoint %s (%s)",
+				   GetLocalName().c_str(), GetLastSocketErrorString().c_str());
+
+			return false;
+		}
+#endif
+
+		m_SendSegmentSize = size;
+
+		return true;
+	}
+
 	Result<Size> Socket::Receive(Buffer& buffer, const Size max_rcv_size) noexcept
 	{
 		auto& rcvbuf = GetReceiveBuffer();
@@ -1070,6 +1264,35 @@ namespace QuantumGate::Implementation::Network
 		return result;
 	}
 
+	Result<Size> Socket::Receive(StreamBuffer& buffer, const Size max_rcv_size) noexcept
+	{
+		const auto read_size = std::invoke([&]()
+		{
+			if (max_rcv_size > 0 && max_rcv_size < ReceiveBuffer::GetMaxSize()) return max_rcv_size;
+			else return ReceiveBuffer::GetMaxSize();
+		});
+
+		try
+		{
+			// Receive directly into the free room at the back of the buffer
+			auto rcvbuf_span = buffer.GetTailroom(read_size);
+
+			auto result = Receive(rcvbuf_span);
+			if (result.Succeeded())
+			{
+				buffer.CommitTailroom(*result);
+			}
+
+			return result;
+		}
+		catch (const std::exception& e)
+		{
+			LogErr(L"Receive exception for endpoint %s: %s", GetPeerName().c_str(), Util::ToStringW(e.what()).c_str());
+		}
+
+		return ResultCode::Failed;
+	}
+
 	Result<Size> Socket::Receive(BufferSpan& buffer) noexcept
 	{
 		assert(m_Socket != INVALID_SOCKET);
@@ -1154,6 +1377,9 @@ namespace QuantumGate::Implementation::Network
 
 		Dbg(L"%d bytes received", bytesrcv);
 
+		++m_DatagramStatistics.NumReceiveCalls;
+		if (bytesrcv > 0) ++m_DatagramStatistics.NumReceived;
+
 		if (sock_addr.ss_family != 0)
 		{
 			if (!SockAddrGetEndpoint(Protocol::UDP, &sock_addr, endpoint))
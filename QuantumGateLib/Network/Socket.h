@@ -32,6 +32,59 @@ namespace QuantumGate::Implementation::Network
 			Register, Delete
 		};
 
+		struct DatagramStatistics final
+		{
+			Size NumSent{ 0 };
+			Size NumSendCalls{ 0 };
+			Size NumReceived{ 0 };
+			Size NumReceiveCalls{ 0 };
+
+			[[nodiscard]] inline double GetSentPerCall() const noexcept
+			{
+				return (NumSendCalls > 0) ? static_cast<double>(NumSent) / static_cast<double>(NumSendCalls) : 0.0;
+			}
+
+			[[nodiscard]] inline double GetReceivedPerCall() const noexcept
+			{
+				return (NumReceiveCalls > 0) ? static_cast<double>(NumReceived) / static_cast<double>(NumReceiveCalls) : 0.0;
+			}
+		};
+
+		// Datagram statistics of several sockets added together; can be
+		// read from other threads while the sockets are being used
+		struct DatagramStatisticsTotals final
+		{
+			// Adds what a socket did since its statistics were last added
+			void Add(const DatagramStatistics& stats, DatagramStatistics& added_stats) noexcept
+			{
+				NumSent.fetch_add(stats.NumSent - added_stats.NumSent, std::memory_order_relaxed);
+				NumSendCalls.fetch_add(stats.NumSendCalls - added_stats.NumSendCalls, std::memory_order_relaxed);
+				NumReceived.fetch_add(stats.NumReceived - added_stats.NumReceived, std::memory_order_relaxed);
+				NumReceiveCalls.fetch_add(stats.NumReceiveCalls - added_stats.NumReceiveCalls, std::memory_order_relaxed);
+
+				added_stats = stats;
+			}
+
+			[[nodiscard]] DatagramStatistics Get() const noexcept
+			{
+				return DatagramStatistics{
+					.NumSent = NumSent.load(std::memory_order_relaxed),
+					.NumSendCalls = NumSendCalls.load(std::memory_order_relaxed),
+					.NumReceived = NumReceived.load(std::memory_order_relaxed),
+					.NumReceiveCalls = NumReceiveCalls.load(std::memory_order_relaxed)
+				};
+			}
+
+			std::atomic<Size> NumSent{ 0 };
+			std::atomic<Size> NumSendCalls{ 0 };
+			std::atomic<Size> NumReceived{ 0 };
+			std::atomic<Size> NumReceiveCalls{ 0 };
+		};
+
+		// Maximum number of datagrams and bytes that SendToBatch() sends with one call
+		static constexpr Size MaxDatagramBatchSize{ 64 };
+		static constexpr Size MaxDatagramBatchByteSize{ 65'507 };
+
 		Socket() noexcept;
 		Socket(const SOCKET s);
 		Socket(const AddressFamily af, const Type type, const Protocol protocol);
@@ -70,7 +123,14 @@ namespace QuantumGate::Implementation::Network
 
 		[[nodiscard]] Result<Size> Send(const BufferView& buffer, const Size max_snd_size = 0) noexcept override;
 		[[nodiscard]] Result<Size> SendTo(const Endpoint& endpoint, const BufferView& buffer, const Size max_snd_size = 0) noexcept override;
+
+		// Sends datagrams from the front of buffers to the endpoint and returns the number of datagrams sent.
+		// As many as possible get sent with one call using UDP send segmentation offload when the OS
+		// supports it; this requires consecutive datagrams of the same size (the last one may be
+		// smaller). Otherwise just the first datagram gets sent. Returns 0 if the send buffer is full.
+		[[nodiscard]] Result<Size> SendToBatch(const Endpoint& endpoint, const Vector<BufferView>& buffers) noexcept;
 		[[nodiscard]] Result<Size> Receive(Buffer& buffer, const Size max_rcv_size = 0) noexcept override;
+		[[nodiscard]] Result<Size> Receive(StreamBuffer& buffer, const Size max_rcv_size = 0) noexcept override;
 		[[nodiscard]] Result<Size> Receive(BufferSpan& buffer) noexcept;
 		[[nodiscard]] Result<Size> ReceiveFrom(Endpoint& endpoint, Buffer& buffer, const Size max_rcv_size = 0) noexcept override;
 		[[nodiscard]] Result<Size> ReceiveFrom(Endpoint& endpoint, BufferSpan& buffer) noexcept;
@@ -90,6 +150,8 @@ namespace QuantumGate::Implementation::Network
 		[[nodiscard]] inline Size GetBytesReceived() const noexcept override { return m_BytesReceived; }
 		[[nodiscard]] inline Size GetBytesSent() const noexcept override { return m_BytesSent; }
 
+		[[nodiscard]] inline const DatagramStatistics& GetDatagramStatistics() const noexcept { return m_DatagramStatistics; }
+
 		[[nodiscard]] inline const Endpoint& GetLocalEndpoint() const noexcept override { return m_LocalEndpoint; }
 		[[nodiscard]] inline String GetLocalName() const noexcept override { return m_LocalEndpoint.GetString(); }
 
@@ -174,6 +236,9 @@ namespace QuantumGate::Implementation::Network
 
 		[[nodiscard]] bool UpdateIOStatusFDSet(const std::chrono::milliseconds& mseconds) noexcept;
 
+		[[nodiscard]] bool IsSendSegmentationSupported() noexcept;
+		[[nodiscard]] bool SetSendSegmentSize(const Size size) noexcept;
+
 #ifdef USE_SOCKET_EVENT
 		[[nodiscard]] bool UpdateIOStatusEvent(const std::chrono::milliseconds& mseconds) noexcept;
 #endif
@@ -191,6 +256,10 @@ namespace QuantumGate::Implementation::Network
 		Size m_BytesReceived{ 0 };
 		Size m_BytesSent{ 0 };
 
+		DatagramStatistics m_DatagramStatistics;
+		std::optional<bool> m_SendSegmentationSupported;
+		Size m_SendSegmentSize{ 0 };
+
 		Endpoint m_LocalEndpoint;
 		Endpoint m_PeerEndpoint;
 
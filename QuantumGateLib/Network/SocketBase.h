@@ -101,6 +101,7 @@ namespace QuantumGate::Implementation::Network
 		virtual Result<Size> Send(const BufferView& buffer, const Size max_snd_size = 0) noexcept = 0;
 		virtual Result<Size> SendTo(const Endpoint& endpoint, const BufferView& buffer, const Size max_snd_size = 0) noexcept = 0;
 		virtual Result<Size> Receive(Buffer& buffer, const Size max_rcv_size = 0) noexcept = 0;
+		virtual Result<Size> Receive(StreamBuffer& buffer, const Size max_rcv_size = 0) noexcept = 0;
 		virtual Result<Size> ReceiveFrom(Endpoint& endpoint, Buffer& buffer, const Size max_rcv_size = 0) noexcept = 0;
 
 		virtual void Close(const bool linger = false) noexcept = 0;
@@ -71,7 +71,15 @@ namespace QuantumGate::Implementation
 		bool RequireAuthentication{ true };									// Whether authentication is required for connecting peers
 
 		LocalAlgorithms SupportedAlgorithms;								// The supported algorithms
-		Size NumPreGeneratedKeysPerAlgorithm{ 5 };							// The number of pregenerated keys per supported algorithm
+		Size NumPreGeneratedKeysPerAlgorithm{ 5 };							// The (minimum) number of pregenerated keys per supported algorithm
+		std::chrono::seconds PreGeneratedKeysBurstWindow{ 10 };				// The period of peak demand for keys that pregenerated keys should cover
+		Size PreGeneratedKeysMemoryBudget{ 64'000'000 };					// Maximum amount of memory for pregenerated keys beyond the minimum number per algorithm
+
+		struct
+		{
+			String Path;													// Path of the file to keep pregenerated keys in across restarts
+			ProtectedBuffer Secret;											// Secret for encrypting the keys in the file
+		} PreGeneratedKeysFile;
 
 		struct
 		{
@@ -97,6 +105,12 @@ namespace QuantumGate::Implementation
 			} BTH;
 		} Listeners;
 
+		struct
+		{
+			UDPCongestionControl CongestionControl{ UDPCongestionControl::AIMD };	// The congestion control algorithm to use for UDP connections
+			bool Pacing{ false };												// Whether to spread sending over the round-trip time instead of sending the whole send window at once
+		} UDP;
+
 		std::chrono::seconds ConnectTimeout{ 60 };							// Maximum number of seconds to wait for a connection to be established
 		std::chrono::seconds SuspendTimeout{ 60 };							// Maximum number of seconds of inactivity after which a connection gets suspended (only for endpoints that support suspending connections)
 		std::chrono::seconds MaxSuspendDuration{ 60 };						// Maximum number of seconds that a connection may be suspended before the peer is disconnected (only for endpoints that support suspending connections)
@@ -63,6 +63,7 @@ namespace QuantumGate
 }
 
 #include "Memory\RingBuffer.h"
+#include "Memory\StreamBuffer.h"
 #include "Memory\BufferView.h"
 
 namespace QuantumGate
@@ -73,6 +74,7 @@ namespace QuantumGate
 	using ProtectedBuffer = Implementation::Memory::ProtectedBuffer;
 	using RingBuffer = Implementation::Memory::RingBuffer;
 	using ProtectedRingBuffer = Implementation::Memory::ProtectedRingBuffer;
+	using StreamBuffer = Implementation::Memory::StreamBuffer;
 
 	using String = std::basic_string<wchar_t, std::char_traits<wchar_t>,
 		Implementation::Memory::DefaultAllocator<wchar_t>>;
@@ -112,7 +114,7 @@ namespace QuantumGate::Implementation
 	struct ProtocolVersion final
 	{
 		static constexpr const UInt8 Major{ 0 };
-		static constexpr const UInt8 Minor{ 1 };
+		static constexpr const UInt8 Minor{ 2 };
 	};
 
 	enum class PeerConnectionType : UInt16
@@ -159,6 +161,11 @@ namespace QuantumGate
 		GUID ID{ 0 };											// The service class ID to advertise in the Bluetooth SDP service record
 	};
 
+	enum class UDPCongestionControl : UInt8
+	{
+		AIMD, CUBIC, BBR
+	};
+
 	struct StartupParameters
 	{
 		PeerUUID UUID;											// The UUID for the local peer
@@ -167,7 +174,15 @@ namespace QuantumGate
 		bool RequireAuthentication{ true };						// Whether authentication is required for connecting peers
 
 		Algorithms SupportedAlgorithms;							// The supported algorithms
-		Size NumPreGeneratedKeysPerAlgorithm{ 5 };				// The number of pregenerated keys per supported algorithm
+		Size NumPreGeneratedKeysPerAlgorithm{ 5 };				// The (minimum) number of pregenerated keys per supported algorithm
+		std::chrono::seconds PreGeneratedKeysBurstWindow{ 10 };	// The period of peak demand for keys that pregenerated keys should cover; the number of keys per algorithm adapts to demand
+		Size PreGeneratedKeysMemoryBudget{ 64'000'000 };		// Maximum amount of memory in bytes for pregenerated keys beyond the minimum number per algorithm
+
+		struct
+		{
+			String Path;										// Path of the file to keep pregenerated keys in across restarts (leave empty to not keep them)
+			ProtectedBuffer Secret;								// Secret for encrypting the keys in the file (at least 32 bytes)
+		} PreGeneratedKeysFile;
 
 		bool EnableExtenders{ false };							// Enable extenders on startup?
 
@@ -204,6 +219,12 @@ namespace QuantumGate
 			UInt8 IPv4ExcludedNetworksCIDRLeadingBits{ 16 };	// The CIDR leading bits of the IPv4 network address spaces of the source and destination endpoints to exclude from the relay link
 			UInt8 IPv6ExcludedNetworksCIDRLeadingBits{ 48 };	// The CIDR leading bits of the IPv6 network address spaces of the source and destination endpoints to exclude from the relay link
 		} Relays;
+
+		struct
+		{
+			UDPCongestionControl CongestionControl{ UDPCongestionControl::AIMD };	// The congestion control algorithm to use for UDP connections
+			bool Pacing{ false };												// Whether to spread sending over the round-trip time instead of sending the whole send window at once
+		} UDP;
 	};
 
 	enum class SecurityLevel : UInt16
@@ -283,6 +304,27 @@ namespace QuantumGate
 		} Noise;
 	};
 
+	struct KeyGenerationStatistics
+	{
+		struct AlgorithmDetails
+		{
+			Algorithm::Asymmetric Algorithm{ Algorithm::Asymmetric::Unknown };
+			Size NumKeys{ 0 };									// The number of pregenerated keys available
+			Size TargetNumKeys{ 0 };							// The number of pregenerated keys being kept available based on demand
+			UInt64 NumHits{ 0 };								// The number of times a pregenerated key was available when needed
+			UInt64 NumMisses{ 0 };								// The number of times a key had to be waited for or generated when needed
+			double HitRate{ 0.0 };								// The fraction of times a pregenerated key was available when needed
+			double NeededRate{ 0.0 };							// The (smoothed) number of keys needed per second
+			std::chrono::microseconds GenerationTime{ 0 };		// The (smoothed) time it takes to generate a key
+			Size MemoryInUse{ 0 };								// The amount of memory in bytes used by the pregenerated keys
+		};
+
+		Vector<AlgorithmDetails> Algorithms;
+		Size MemoryInUse{ 0 };									// The amount of memory in bytes used by all pregenerated keys
+		UInt64 NumRequestedKeys{ 0 };							// The number of keys that were generated for someone waiting for them
+		UInt64 NumInlineKeys{ 0 };								// The number of keys that were generated on the spot by the thread needing them
+		UInt64 NumPendingRequests{ 0 };							// The number of keys currently being waited for
+	};
 }
 
 namespace QuantumGate::API
@@ -36,34 +36,42 @@ namespace QuantumGate::AVExtender
 
 	void Extender::SetUseCompression(const bool compression) noexcept
 	{
-		m_Settings.UpdateValue([&](auto& settings)
+		const auto updated = m_Settings.UpdateValue([&](auto& settings) noexcept
 		{
 			settings.UseCompression = compression;
 		});
+
+		if (!updated) LogErr(L"%s: couldn't update settings", GetName().c_str());
 	}
 
 	void Extender::SetUseAudioCompression(const bool compression) noexcept
 	{
-		m_Settings.UpdateValue([&](auto& settings)
+		const auto updated = m_Settings.UpdateValue([&](auto& settings) noexcept
 		{
 			settings.UseAudioCompression = compression;
 		});
+
+		if (!updated) LogErr(L"%s: couldn't update settings", GetName().c_str());
 	}
 
 	void Extender::SetUseVideoCompression(const bool compression) noexcept
 	{
-		m_Settings.UpdateValue([&](auto& settings)
+		const auto updated = m_Settings.UpdateValue([&](auto& settings) noexcept
 		{
 			settings.UseVideoCompression = compression;
 		});
+
+		if (!updated) LogErr(L"%s: couldn't update settings", GetName().c_str());
 	}
 
 	void Extender::SetFillVideoScreen(const bool fill) noexcept
 	{
-		m_Settings.UpdateValue([&](auto& settings)
+		const auto updated = m_Settings.UpdateValue([&](auto& settings) noexcept
 		{
 			settings.FillVideoScreen = fill;
 		});
+
+		if (!updated) LogErr(L"%s: couldn't update settings", GetName().c_str());
 	}
 
 	bool Extender::OnStartup()
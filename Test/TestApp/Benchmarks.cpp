@@ -15,7 +15,44 @@
 #include "Concurrency\RecursiveSharedMutex.h"
 #include "Concurrency\SpinMutex.h"
 #include "Concurrency\SharedSpinMutex.h"
+#include "Concurrency\Queue.h"
+#include "Concurrency\MPSCQueue.h"
+#include "Concurrency\MPMCQueue.h"
+#include "Concurrency\ThreadSafe.h"
+#include "Common\Containers.h"
 #include "Compression\Compression.h"
+#include "..\..\QuantumGateCryptoLib\QuantumGateCryptoLib.h"
+
+// Undefine conflicting macros
+#ifdef min
+#undef min
+#endif
+#ifdef max
+#undef max
+#endif
+
+#include "Core\UDP\UDPConnectionSequenceWindow.h"
+#include "Core\UDP\UDPConnectionCommon.h"
+#include "Common\Obfuscate.h"
+
+#include <intrin.h>
+#include <random>
+
+// The KEM benchmark uses the crypto library directly so that
+// the reference and AVX2 implementations can be compared
+#if defined(_DEBUG)
+	#if !defined(_WIN64)
+	#pragma comment(lib, "QuantumGateCryptoLib32D.lib")
+	#else
+	#pragma comment(lib, "QuantumGateCryptoLib64D.lib")
+	#endif
+#else
+	#if !defined(_WIN64)
+	#pragma comment(lib, "QuantumGateCryptoLib32.lib")
+	#else
+	#pragma comment(lib, "QuantumGateCryptoLib64.lib")
+	#endif
+#endif
 
 using namespace QuantumGate::Implementation;
 using namespace QuantumGate::Implementation::Concurrency;
@@ -323,6 +360,75 @@ void Benchmarks::BenchmarkMutexes()
 	});
 }
 
+template<typename QueueType, typename PopFunc>
+void BenchmarkQueue(const std::wstring& desc, const unsigned int numproducers, const unsigned int numitems, PopFunc&& pop)
+{
+	QueueType queue;
+	Concurrency::Event shutdown_event;
+
+	const auto items_per_producer = numitems / numproducers;
+
+	Benchmarks::DoBenchmark(Util::FormatString(L"%s with %u producers", desc.c_str(), numproducers), 1, [&]()
+	{
+		std::vector<std::thread> producers;
+		for (auto x = 0u; x < numproducers; ++x)
+		{
+			producers.emplace_back([&]()
+			{
+				for (auto y = 0u; y < items_per_producer; ++y)
+				{
+					queue.Push(y);
+				}
+			});
+		}
+
+		// Single consumer waiting the same way the worker threads do
+		auto num = 0u;
+		while (num < items_per_producer * numproducers)
+		{
+			if (pop(queue)) ++num;
+			else queue.Wait(shutdown_event);
+		}
+
+		for (auto& thread : producers)
+		{
+			thread.join();
+		}
+	});
+}
+
+void Benchmarks::BenchmarkQueues()
+{
+	CWaitCursor wait;
+
+	constexpr auto maxitems = 2000000u;
+
+	LogSys(L"---");
+	LogSys(L"Starting queues benchmark for %u items", maxitems);
+
+	for (auto numproducers = 1u; numproducers <= 32u; numproducers *= 2)
+	{
+		BenchmarkQueue<Concurrency::Queue<unsigned int>>(L"Queue", numproducers, maxitems, [](auto& queue) noexcept
+		{
+			auto popped = false;
+			queue.PopFrontIf([&](auto&) noexcept { popped = true; return true; });
+			return popped;
+		});
+
+		BenchmarkQueue<Concurrency::MPSCQueue<unsigned int>>(L"MPSCQueue", numproducers, maxitems, [](auto& queue) noexcept
+		{
+			auto popped = false;
+			queue.PopFrontIf([&](auto&) noexcept { popped = true; return true; });
+			return popped;
+		});
+
+		BenchmarkQueue<Concurrency::MPMCQueue<unsigned int>>(L"MPMCQueue", numproducers, maxitems, [](auto& queue) noexcept
+		{
+			return queue.PopFront([](auto&) noexcept {});
+		});
+	}
+}
+
 void Benchmarks::BenchmarkCompression()
 {
 	CWaitCursor wait;
@@ -442,6 +548,59 @@ void Benchmarks::BenchmarkConsole()
 		   std::chrono::duration_cast<std::chrono::milliseconds>(dur4).count());
 }
 
+template<template<typename> typename Allocator>
+void BenchmarkAllocationRate(const std::wstring& desc, const unsigned int numthreads, const unsigned int numallocs)
+{
+	using namespace QuantumGate::Implementation::Memory;
+
+	// Mix of small sizes typical for messages and container nodes
+	constexpr std::array<Size, 8> sizes{ 24u, 64u, 100u, 256u, 512u, 1000u, 2048u, 4096u };
+
+	const auto allocs_per_thread = numallocs / numthreads;
+
+	const auto time = Benchmarks::DoBenchmark(Util::FormatString(L"%s with %u threads", desc.c_str(), numthreads), 1, [&]()
+	{
+		std::vector<std::thread> threads;
+		for (auto x = 0u; x < numthreads; ++x)
+		{
+			threads.emplace_back([&]()
+			{
+				Allocator<Byte> alloc;
+				std::array<std::pair<Byte*, Size>, 64> live{};
+
+				for (auto y = 0u; y < allocs_per_thread; ++y)
+				{
+					auto& entry = live[y % live.size()];
+					if (entry.first != nullptr)
+					{
+						alloc.deallocate(entry.first, entry.second);
+					}
+
+					entry.second = sizes[(y * 7u) % sizes.size()];
+					entry.first = alloc.allocate(entry.second);
+					entry.first[0] = Byte{ 1 };
+				}
+
+				for (auto& entry : live)
+				{
+					if (entry.first != nullptr) alloc.deallocate(entry.first, entry.second);
+				}
+			});
+		}
+
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+	});
+
+	if (time.count() > 0)
+	{
+		LogSys(L"%s with %u threads: %.0f allocations/s", desc.c_str(), numthreads,
+			   static_cast<double>(allocs_per_thread * numthreads) * 1'000'000.0 / static_cast<double>(time.count()));
+	}
+}
+
 void Benchmarks::BenchmarkMemory()
 {
 	CWaitCursor wait;
@@ -482,4 +641,539 @@ void Benchmarks::BenchmarkMemory()
 		len *= 2;
 		if (len > 3000000) break;
 	}
-}
\ No newline at end of file
+
+	constexpr auto maxallocs = 4000000u;
+
+	LogSys(L"\r\nAllocation rate for %u small allocations:", maxallocs);
+
+	for (auto numthreads = 1u; numthreads <= 16u; numthreads *= 2)
+	{
+		BenchmarkAllocationRate<FreeStoreAllocator>(L"Free Allocator", numthreads, maxallocs);
+		BenchmarkAllocationRate<PoolAllocator::Allocator>(L"Pool Allocator", numthreads, maxallocs);
+	}
+}
+
+void Benchmarks::BenchmarkKEMs()
+{
+	CWaitCursor wait;
+
+	using KeyPairFunction = int(*)(unsigned char*, unsigned char*);
+	using EncryptFunction = int(*)(unsigned char*, unsigned char*, const unsigned char*);
+	using DecryptFunction = int(*)(unsigned char*, const unsigned char*, const unsigned char*);
+
+	struct KEM final
+	{
+		const wchar_t* Name{ nullptr };
+		Size PublicKeySize{ 0 };
+		Size PrivateKeySize{ 0 };
+		Size CipherTextSize{ 0 };
+		Size SharedSecretSize{ 0 };
+		KeyPairFunction KeyPair{ nullptr };
+		EncryptFunction Encrypt{ nullptr };
+		DecryptFunction Decrypt{ nullptr };
+		bool HasAVX2{ false };
+		unsigned int NumTries{ 0 };
+	};
+
+	const std::array<KEM, 3> kems{
+		KEM{ L"NTRUPrime", crypto_kem_sntrup857_ref_PUBLICKEYBYTES, crypto_kem_sntrup857_ref_SECRETKEYBYTES,
+			crypto_kem_sntrup857_ref_CIPHERTEXTBYTES, crypto_kem_sntrup857_ref_BYTES, crypto_kem_sntrup857_ref_keypair,
+			crypto_kem_sntrup857_ref_enc, crypto_kem_sntrup857_ref_dec, true, 100 },
+		KEM{ L"NewHope", NEWHOPE_CCAKEM_PUBLICKEYBYTES, NEWHOPE_CCAKEM_SECRETKEYBYTES,
+			NEWHOPE_CCAKEM_CIPHERTEXTBYTES, NEWHOPE_SYMBYTES, crypto_kem_newhope_keypair,
+			crypto_kem_newhope_enc, crypto_kem_newhope_dec, true, 1000 },
+		KEM{ L"McEliece", crypto_kem_mceliece8192128_PUBLICKEYBYTES, crypto_kem_mceliece8192128_SECRETKEYBYTES,
+			crypto_kem_mceliece8192128_CIPHERTEXTBYTES, crypto_kem_mceliece8192128_BYTES, crypto_kem_mceliece8192128_keypair,
+			crypto_kem_mceliece8192128_enc, crypto_kem_mceliece8192128_dec, true, 5 }
+	};
+
+	LogSys(L"---");
+	LogSys(L"Starting KEM benchmark");
+
+	if (!QGCryptoInitRng())
+	{
+		LogErr(L"Failed to initialize random number generator for KEM benchmark");
+		return;
+	}
+
+	const auto avx2 = (QGCryptoCPUSupportsAVX2() == 1);
+	LogSys(L"CPU supports AVX2: %s", avx2 ? L"Yes" : L"No");
+
+	const auto measure = [](const std::wstring& desc, const unsigned int numtries, auto&& func)
+	{
+		UInt64 cycles{ 0 };
+
+		DoBenchmark(desc, numtries, [&]()
+		{
+			const auto begin = __rdtsc();
+			func();
+			cycles += __rdtsc() - begin;
+		});
+
+		LogSys(L"Benchmark '%s' average: %llu cycles", desc.c_str(), cycles / numtries);
+	};
+
+	for (const auto& kem : kems)
+	{
+		for (const auto use_avx2 : { false, true })
+		{
+			if (use_avx2 && !(avx2 && kem.HasAVX2)) continue;
+
+			QGCryptoSetAVX2Enabled(use_avx2);
+
+			const std::wstring name = std::wstring(kem.Name) + (use_avx2 ? L" (AVX2)" : L"");
+
+			Buffer pubkey(kem.PublicKeySize);
+			Buffer privkey(kem.PrivateKeySize);
+			Buffer ciphertext(kem.CipherTextSize);
+			Buffer secret1(kem.SharedSecretSize);
+			Buffer secret2(kem.SharedSecretSize);
+			auto success = true;
+
+			LogSys(L"---");
+
+			measure(name + L" keygen", kem.NumTries, [&]()
+			{
+				if (kem.KeyPair(reinterpret_cast<unsigned char*>(pubkey.GetBytes()),
+								reinterpret_cast<unsigned char*>(privkey.GetBytes())) != 0) success = false;
+			});
+
+			measure(name + L" encaps", kem.NumTries, [&]()
+			{
+				if (kem.Encrypt(reinterpret_cast<unsigned char*>(ciphertext.GetBytes()),
+								reinterpret_cast<unsigned char*>(secret1.GetBytes()),
+								reinterpret_cast<const unsigned char*>(pubkey.GetBytes())) != 0) success = false;
+			});
+
+			measure(name + L" decaps", kem.NumTries, [&]()
+			{
+				if (kem.Decrypt(reinterpret_cast<unsigned char*>(secret2.GetBytes()),
+								reinterpret_cast<const unsigned char*>(ciphertext.GetBytes()),
+								reinterpret_cast<const unsigned char*>(privkey.GetBytes())) != 0) success = false;
+			});
+
+			if (!success || secret1 != secret2)
+			{
+				LogErr(L"%s failed to establish a shared secret", name.c_str());
+			}
+		}
+	}
+
+	QGCryptoSetAVX2Enabled(1);
+	QGCryptoDeinitRng();
+}
+template<typename Func>
+void BenchmarkAddressChecks(const std::wstring& desc, const unsigned int numthreads, const unsigned int numchecks, Func&& check)
+{
+	const auto checks_per_thread = numchecks / numthreads;
+
+	const auto time = Benchmarks::DoBenchmark(Util::FormatString(L"%s with %u threads", desc.c_str(), numthreads), 1, [&]()
+	{
+		std::vector<std::thread> threads;
+		for (auto x = 0u; x < numthreads; ++x)
+		{
+			threads.emplace_back([&, x]()
+			{
+				for (auto y = 0u; y < checks_per_thread; ++y)
+				{
+					check((x * checks_per_thread) + y);
+				}
+			});
+		}
+
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+	});
+
+	if (time.count() > 0)
+	{
+		LogSys(L"%s with %u threads: %.0f checks/s", desc.c_str(), numthreads,
+			   static_cast<double>(checks_per_thread * numthreads) * 1'000'000.0 / static_cast<double>(time.count()));
+	}
+}
+
+void Benchmarks::BenchmarkAccessControl()
+{
+	CWaitCursor wait;
+
+	constexpr auto maxchecks = 4000000u;
+	constexpr auto numaddresses = 65536u;
+
+	LogSys(L"---");
+	LogSys(L"Starting access control benchmark for %u address checks", maxchecks);
+
+	// Separate instance so that the reputations of
+	// the TestApp instance don't get changed
+	Local local;
+	auto& access_manager = local.GetAccessManager();
+
+	// Checks from many different addresses, like the listener threads
+	// do for each incoming connection or datagram during a flood
+	std::vector<Address> addresses;
+	addresses.reserve(numaddresses);
+
+	for (auto x = 0u; x < numaddresses; ++x)
+	{
+		addresses.emplace_back(IPAddress(Util::FormatString(L"10.%u.%u.%u", (x >> 16) & 0xffu, (x >> 8) & 0xffu, x & 0xffu)));
+
+		Access::AddressReputation addr_rep;
+		addr_rep.Address = addresses.back();
+		addr_rep.Score = Access::AddressReputation::ScoreLimits::Maximum;
+		if (access_manager.SetAddressReputation(addr_rep).Failed())
+		{
+			LogErr(L"Failed to set address reputation for access control benchmark");
+			return;
+		}
+	}
+
+	// The way address reputations used to be checked: a unique lock on a single
+	// map, since checking a reputation could also change it
+	ThreadSafe<Containers::UnorderedMap<UInt32, Int16>, std::shared_mutex> single_map;
+
+	for (auto x = 0u; x < numaddresses; ++x)
+	{
+		single_map.WithUniqueLock()->emplace(x, Access::AddressReputation::ScoreLimits::Maximum);
+	}
+
+	for (auto numthreads = 1u; numthreads <= 16u; numthreads *= 2)
+	{
+		BenchmarkAddressChecks(L"Single map with unique lock", numthreads, maxchecks, [&](const unsigned int n)
+		{
+			auto map = single_map.WithUniqueLock();
+			if (const auto it = map->find(n % numaddresses); it != map->end())
+			{
+				volatile const auto acceptable = (it->second > Access::AddressReputation::ScoreLimits::Base);
+			}
+		});
+
+		BenchmarkAddressChecks(L"Access manager", numthreads, maxchecks, [&](const unsigned int n)
+		{
+			volatile const auto allowed = access_manager.GetAddressAllowed(addresses[n % numaddresses],
+																		   Access::CheckType::AddressReputations).Succeeded();
+		});
+	}
+}
+
+void Benchmarks::BenchmarkUDPSendWindow()
+{
+	CWaitCursor wait;
+
+	using Message = Implementation::Core::UDP::Message;
+
+	constexpr auto numitems = 10'000u;
+	constexpr auto numtries = 10u;
+
+	LogSys(L"---");
+	LogSys(L"Starting UDP send window benchmark for %u items in flight", numitems);
+
+	struct SendItem final
+	{
+		Message::SequenceNumber SequenceNumber{ 0 };
+		Size NumBytes{ 0 };
+		bool Acked{ false };
+	};
+
+	// Starts close to the end of the sequence numbers so that the window wraps around
+	constexpr Message::SequenceNumber base_seqnum = std::numeric_limits<Message::SequenceNumber>::max() - (numitems / 2);
+
+	// Ack ranges get sent sorted by sequence number, as the receiver does
+	const auto make_ack_ranges = [](Vector<Message::SequenceNumber>& seqnums)
+	{
+		std::sort(seqnums.begin(), seqnums.end());
+
+		Vector<Message::AckRange> ack_ranges;
+		for (const auto seqnum : seqnums)
+		{
+			if (!ack_ranges.empty() && ack_ranges.back().End + 1 == seqnum) ack_ranges.back().End = seqnum;
+			else ack_ranges.emplace_back(Message::AckRange{ .Begin = seqnum, .End = seqnum });
+		}
+
+		return ack_ranges;
+	};
+
+	std::mt19937 rng(1);
+	Vector<Message::SequenceNumber> odd_seqnums;
+	Vector<Message::SequenceNumber> even_seqnums;
+	Vector<Message::SequenceNumber> received_seqnums;
+	Vector<Message::SequenceNumber> lost_seqnums;
+
+	for (auto x = 0u; x < numitems; ++x)
+	{
+		const auto seqnum = static_cast<Message::SequenceNumber>(base_seqnum + x);
+
+		if (x % 2 == 1) odd_seqnums.emplace_back(seqnum);
+		else even_seqnums.emplace_back(seqnum);
+
+		// About 2% loss
+		if (rng() % 50 != 0) received_seqnums.emplace_back(seqnum);
+		else lost_seqnums.emplace_back(seqnum);
+	}
+
+	// Selective acks for every other item followed by acks for the rest,
+	// and acks for a lossy link followed by acks for the retransmissions
+	const std::vector<std::pair<std::wstring, std::vector<Vector<Message::AckRange>>>> patterns
+	{
+		{ L"every other item", { make_ack_ranges(odd_seqnums), make_ack_ranges(even_seqnums) } },
+		{ L"2% loss", { make_ack_ranges(received_seqnums), make_ack_ranges(lost_seqnums) } }
+	};
+
+	// The way the send window used to be kept: a list that
+	// gets searched for every sequence number that gets acked
+	{
+		Containers::List<SendItem> queue;
+
+		const auto fill = [&]()
+		{
+			queue.clear();
+
+			for (auto x = 0u; x < numitems; ++x)
+			{
+				queue.emplace_back(SendItem{ .SequenceNumber = static_cast<Message::SequenceNumber>(base_seqnum + x), .NumBytes = 1000 });
+			}
+		};
+
+		const auto purge = [&]()
+		{
+			while (!queue.empty() && queue.front().Acked) queue.pop_front();
+		};
+
+		DoBenchmark(L"List with in sequence acks", numtries, [&]()
+		{
+			fill();
+
+			for (auto x = 1u; x < numitems; x += 2)
+			{
+				const auto seqnum = static_cast<Message::SequenceNumber>(base_seqnum + x);
+				const auto it = std::find_if(queue.begin(), queue.end(), [&](const auto& item) { return (item.SequenceNumber == seqnum); });
+				if (it != queue.end())
+				{
+					for (auto it2 = queue.begin();; ++it2)
+					{
+						it2->Acked = true;
+						if (it2 == it) break;
+					}
+
+					purge();
+				}
+			}
+		});
+
+		for (const auto& [desc, ack_sets] : patterns)
+		{
+			DoBenchmark(L"List with acks for " + desc, numtries, [&]()
+			{
+				fill();
+
+				for (const auto& ack_ranges : ack_sets)
+				{
+					for (const auto& ack_range : ack_ranges)
+					{
+						for (UInt32 seqnum = ack_range.Begin; seqnum <= ack_range.End; ++seqnum)
+						{
+							const auto it = std::find_if(queue.begin(), queue.end(), [&](const auto& item) { return (item.SequenceNumber == seqnum); });
+							if (it != queue.end()) it->Acked = true;
+						}
+					}
+
+					purge();
+				}
+
+				if (!queue.empty()) LogErr(L"Not all items in the list were acked");
+			});
+		}
+	}
+
+	// Send window indexed by sequence number
+	{
+		Implementation::Core::UDP::Connection::SequenceWindow<SendItem> queue;
+
+		const auto fill = [&]()
+		{
+			queue.Reset(base_seqnum);
+
+			for (auto x = 0u; x < numitems; ++x)
+			{
+				const auto seqnum = static_cast<Message::SequenceNumber>(base_seqnum + x);
+				[[maybe_unused]] const auto item = queue.Emplace(seqnum, SendItem{ .SequenceNumber = seqnum, .NumBytes = 1000 });
+			}
+		};
+
+		const auto purge = [&]()
+		{
+			while (queue.GetSpan() > 0)
+			{
+				const auto item = queue.GetFront();
+				if (item == nullptr || item->Acked) queue.PopFront();
+				else break;
+			}
+		};
+
+		DoBenchmark(L"SequenceWindow with in sequence acks", numtries, [&]()
+		{
+			fill();
+
+			for (auto x = 1u; x < numitems; x += 2)
+			{
+				const auto seqnum = static_cast<Message::SequenceNumber>(base_seqnum + x);
+				if (queue.Get(seqnum) != nullptr)
+				{
+					queue.ForEach([&](SendItem& item)
+					{
+						item.Acked = true;
+						return (item.SequenceNumber != seqnum);
+					});
+
+					purge();
+				}
+			}
+		});
+
+		for (const auto& [desc, ack_sets] : patterns)
+		{
+			DoBenchmark(L"SequenceWindow with acks for " + desc, numtries, [&]()
+			{
+				fill();
+
+				for (const auto& ack_ranges : ack_sets)
+				{
+					for (const auto& ack_range : ack_ranges)
+					{
+						queue.ForEachInRange(ack_range.Begin, ack_range.End, [](SendItem& item)
+						{
+							item.Acked = true;
+							return true;
+						});
+					}
+
+					purge();
+				}
+
+				if (!queue.IsEmpty()) LogErr(L"Not all items in the window were acked");
+			});
+		}
+	}
+}
+
+void Benchmarks::BenchmarkUDPObfuscation()
+{
+	CWaitCursor wait;
+
+	using Message = Implementation::Core::UDP::Message;
+	using UDPMessageSizes = Implementation::Core::UDP::Connection::UDPMessageSizes;
+
+	// Datagrams get checked in batches like the listener does
+	constexpr auto numdatagrams = Message::HMACBatchSize;
+	constexpr std::array<Size, 5> sizes{ 64, UDPMessageSizes::Min, 1232, 1472, UDPMessageSizes::Max };
+
+	LogSys(L"---");
+	LogSys(L"Starting UDP datagram obfuscation and HMAC benchmark");
+
+	const auto avx2 = (QGCryptoCPUSupportsAVX2() == 1);
+	LogSys(L"CPU supports AVX2: %s", avx2 ? L"Yes" : L"No");
+
+	std::mt19937_64 rng(1);
+
+	const auto random_buffer = [&](const Size size)
+	{
+		Buffer buffer(size);
+		std::generate(buffer.GetBytes(), buffer.GetBytes() + size, [&]() { return static_cast<Byte>(rng()); });
+		return buffer;
+	};
+
+	const auto key = random_buffer(8);
+	const auto authkey = random_buffer(8);
+	const auto iv = static_cast<UInt32>(rng());
+
+	const auto measure = [](const std::wstring& desc, const Size numbytes, const unsigned int numtries, auto&& func)
+	{
+		UInt64 cycles{ 0 };
+
+		DoBenchmark(desc, numtries, [&]()
+		{
+			const auto begin = __rdtsc();
+			func();
+			cycles += __rdtsc() - begin;
+		});
+
+		LogSys(L"Benchmark '%s' average: %.2f cycles per byte", desc.c_str(),
+			   static_cast<double>(cycles) / (static_cast<double>(numbytes) * numtries));
+	};
+
+	for (const auto size : sizes)
+	{
+		Vector<Buffer> datagrams;
+		std::array<const uint8_t*, numdatagrams> data{ nullptr };
+		std::array<size_t, numdatagrams> data_sizes{ 0 };
+
+		for (Size x = 0; x < numdatagrams; ++x)
+		{
+			datagrams.emplace_back(random_buffer(size));
+		}
+
+		for (Size x = 0; x < numdatagrams; ++x)
+		{
+			data[x] = reinterpret_cast<const uint8_t*>(datagrams[x].GetBytes());
+			data_sizes[x] = size;
+		}
+
+		const auto numbytes = size * numdatagrams;
+		const auto numtries = static_cast<unsigned int>(std::max(Size{ 10 }, Size{ 100'000'000 } / numbytes));
+
+		std::array<std::array<Message::HMAC, numdatagrams>, 2> hmacs{ 0 };
+		std::array<Vector<Buffer>, 2> obfuscated;
+
+		for (const auto use_avx2 : { false, true })
+		{
+			if (use_avx2 && !avx2) continue;
+
+			QGCryptoSetAVX2Enabled(use_avx2);
+
+			const auto name = Util::FormatString(L"%zu byte datagrams%s", size, use_avx2 ? L" (AVX2)" : L"");
+
+			LogSys(L"---");
+
+			// Working copies so that the datagrams stay the same for the HMACs
+			auto obf_datagrams = datagrams;
+
+			measure(L"Obfuscate " + name, numbytes, numtries, [&]()
+			{
+				for (auto& datagram : obf_datagrams)
+				{
+					BufferSpan span(datagram);
+					Obfuscate::Do(span, key, iv);
+				}
+			});
+
+			measure(L"HMAC " + name, numbytes, numtries, [&]()
+			{
+				for (Size x = 0; x < numdatagrams; ++x)
+				{
+					halfsiphash(data[x], data_sizes[x], reinterpret_cast<const uint8_t*>(authkey.GetBytes()),
+								reinterpret_cast<uint8_t*>(&hmacs[use_avx2][x]), sizeof(Message::HMAC));
+				}
+			});
+
+			measure(L"Batched HMAC " + name, numbytes, numtries, [&]()
+			{
+				halfsiphash_batch(data.data(), data_sizes.data(), numdatagrams, reinterpret_cast<const uint8_t*>(authkey.GetBytes()),
+								  reinterpret_cast<uint8_t*>(hmacs[use_avx2].data()));
+			});
+
+			for (const auto& datagram : datagrams)
+			{
+				auto& obf_datagram = obfuscated[use_avx2].emplace_back(datagram);
+				BufferSpan span(obf_datagram);
+				Obfuscate::Do(span, key, iv);
+			}
+		}
+
+		if (avx2 && (hmacs[0] != hmacs[1] || obfuscated[0] != obfuscated[1]))
+		{
+			LogErr(L"Results for %zu byte datagrams differ between the reference and AVX2 implementations", size);
+		}
+	}
+
+	QGCryptoSetAVX2Enabled(1);
+}
@@ -22,8 +22,13 @@ public:
 	static void BenchmarkCallbacks();
 	static void BenchmarkThreadPause();
 	static void BenchmarkMutexes();
+	static void BenchmarkQueues();
 	static void BenchmarkCompression();
 	static void BenchmarkConsole();
 	static void BenchmarkMemory();
+	static void BenchmarkKEMs();
+	static void BenchmarkAccessControl();
+	static void BenchmarkUDPSendWindow();
+	static void BenchmarkUDPObfuscation();
 };
 
@@ -132,6 +132,7 @@ BEGIN_MESSAGE_MAP(CTestAppDlg, CDialogBase)
 	ON_UPDATE_COMMAND_UI(ID_SECURITYLEVEL_FIVE, &CTestAppDlg::OnUpdateSecuritylevelFive)
 	ON_COMMAND(ID_BENCHMARKS_CALLBACKS, &CTestAppDlg::OnBenchmarksDelegates)
 	ON_COMMAND(ID_BENCHMARKS_MUTEXES, &CTestAppDlg::OnBenchmarksMutexes)
+	ON_COMMAND(ID_BENCHMARKS_QUEUES, &CTestAppDlg::OnBenchmarksQueues)
 	ON_COMMAND(ID_ATTACKS_CONNECTWITHGARBAGE, &CTestAppDlg::OnAttacksConnectWithGarbage)
 	ON_UPDATE_COMMAND_UI(ID_ATTACKS_CONNECTWITHGARBAGE, &CTestAppDlg::OnUpdateAttacksConnectWithGarbage)
 	ON_COMMAND(ID_LOCAL_LISTENERSENABLED, &CTestAppDlg::OnLocalListenersEnabled)
@@ -177,6 +178,10 @@ BEGIN_MESSAGE_MAP(CTestAppDlg, CDialogBase)
 	ON_COMMAND(ID_STRESS_MULTIPLEINSTANCES, &CTestAppDlg::OnStressMultipleInstances)
 	ON_UPDATE_COMMAND_UI(ID_STRESS_MULTIPLEINSTANCES, &CTestAppDlg::OnUpdateStressMultipleInstances)
 	ON_COMMAND(ID_BENCHMARKS_MEMORY, &CTestAppDlg::OnBenchmarksMemory)
+	ON_COMMAND(ID_BENCHMARKS_KEMS, &CTestAppDlg::OnBenchmarksKEMs)
+	ON_COMMAND(ID_BENCHMARKS_ACCESSCONTROL, &CTestAppDlg::OnBenchmarksAccessControl)
+	ON_COMMAND(ID_BENCHMARKS_UDPSENDWINDOW, &CTestAppDlg::OnBenchmarksUDPSendWindow)
+	ON_COMMAND(ID_BENCHMARKS_UDPOBFUSCATION, &CTestAppDlg::OnBenchmarksUDPObfuscation)
 	ON_COMMAND(ID_UTILS_LOGPOOLALLOCATORSTATISTICS, &CTestAppDlg::OnUtilsLogAllocatorStatistics)
 	ON_COMMAND(ID_LOCAL_ADDRESS_REPUTATIONS, &CTestAppDlg::OnLocalAddressReputations)
 	ON_COMMAND(ID_ATTACKS_CONNECTANDDISCONNECT, &CTestAppDlg::OnAttacksConnectAndDisconnect)
@@ -970,6 +975,11 @@ void CTestAppDlg::OnBenchmarksMutexes()
 	Benchmarks::BenchmarkMutexes();
 }
 
+void CTestAppDlg::OnBenchmarksQueues()
+{
+	Benchmarks::BenchmarkQueues();
+}
+
 void CTestAppDlg::OnAttacksConnectWithGarbage()
 {
 	if (!Attacks::IsConnectGarbageAttackRunning())
@@ -1695,6 +1705,26 @@ void CTestAppDlg::OnBenchmarksMemory()
 	Benchmarks::BenchmarkMemory();
 }
 
+void CTestAppDlg::OnBenchmarksKEMs()
+{
+	Benchmarks::BenchmarkKEMs();
+}
+
+void CTestAppDlg::OnBenchmarksAccessControl()
+{
+	Benchmarks::BenchmarkAccessControl();
+}
+
+void CTestAppDlg::OnBenchmarksUDPSendWindow()
+{
+	Benchmarks::BenchmarkUDPSendWindow();
+}
+
+void CTestAppDlg::OnBenchmarksUDPObfuscation()
+{
+	Benchmarks::BenchmarkUDPObfuscation();
+}
+
 void CTestAppDlg::OnUtilsLogAllocatorStatistics()
 {
 	QuantumGate::Implementation::Memory::PoolAllocator::Allocator<void>::LogStatistics();
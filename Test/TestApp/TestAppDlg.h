@@ -80,6 +80,7 @@ protected:
 	afx_msg void OnUpdateSecuritylevelFive(CCmdUI* pCmdUI);
 	afx_msg void OnBenchmarksDelegates();
 	afx_msg void OnBenchmarksMutexes();
+	afx_msg void OnBenchmarksQueues();
 	afx_msg void OnAttacksConnectWithGarbage();
 	afx_msg void OnUpdateAttacksConnectWithGarbage(CCmdUI* pCmdUI);
 	afx_msg void OnLocalListenersEnabled();
@@ -124,6 +125,10 @@ protected:
 	afx_msg void OnStressMultipleInstances();
 	afx_msg void OnUpdateStressMultipleInstances(CCmdUI* pCmdUI);
 	afx_msg void OnBenchmarksMemory();
+	afx_msg void OnBenchmarksKEMs();
+	afx_msg void OnBenchmarksAccessControl();
+	afx_msg void OnBenchmarksUDPSendWindow();
+	afx_msg void OnBenchmarksUDPObfuscation();
 	afx_msg void OnUtilsLogAllocatorStatistics();
 	afx_msg void OnLocalAddressReputations();
 	afx_msg void OnAttacksConnectAndDisconnect();
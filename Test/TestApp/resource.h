@@ -315,13 +315,18 @@
 #define ID_LOCAL_ADDRESS_REPUTATIONS    32857
 #define ID_LOCAL_BTHLISTENERSENABLED    32858
 #define ID_LOCAL_LISTENERS              32859
+#define ID_BENCHMARKS_QUEUES            32860
+#define ID_BENCHMARKS_KEMS              32861
+#define ID_BENCHMARKS_ACCESSCONTROL     32862
+#define ID_BENCHMARKS_UDPSENDWINDOW     32863
+#define ID_BENCHMARKS_UDPOBFUSCATION    32864
 
 // Next default values for new objects
 // 
 #ifdef APSTUDIO_INVOKED
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NEXT_RESOURCE_VALUE        178
-#define _APS_NEXT_COMMAND_VALUE         32860
+#define _APS_NEXT_COMMAND_VALUE         32867
 #define _APS_NEXT_CONTROL_VALUE         1094
 #define _APS_NEXT_SYMED_VALUE           101
 #endif
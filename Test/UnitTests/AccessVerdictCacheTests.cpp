@@ -0,0 +1,146 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#include "pch.h"
+#include "Settings.h"
+#include "Core\Access\AccessManager.h"
+
+#include <thread>
+
+using namespace std::literals;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace QuantumGate::Implementation;
+using namespace QuantumGate::Implementation::Core::Access;
+
+namespace UnitTests
+{
+	TEST_CLASS(AccessVerdictCacheTests)
+	{
+	public:
+		TEST_METHOD(General)
+		{
+			AccessVerdictCache cache;
+			const Address addr1(IPAddress(L"192.168.1.10"));
+			const Address addr2(IPAddress(L"fe80::c11a:3a9c:ef10:e795"));
+
+			Assert::AreEqual(false, cache.GetVerdict(addr1).has_value());
+
+			auto generation1 = cache.GetGeneration(addr1);
+			auto generation2 = cache.GetGeneration(addr2);
+			cache.AddVerdict(addr1, generation1, true);
+			cache.AddVerdict(addr2, generation2, false);
+
+			Assert::AreEqual(true, *cache.GetVerdict(addr1));
+			Assert::AreEqual(false, *cache.GetVerdict(addr2));
+
+			// New generation invalidates all verdicts
+			cache.Invalidate();
+			Assert::AreEqual(false, cache.GetVerdict(addr1).has_value());
+			Assert::AreEqual(false, cache.GetVerdict(addr2).has_value());
+
+			// Verdicts made before a change don't get added
+			cache.AddVerdict(addr1, generation1, true);
+			Assert::AreEqual(false, cache.GetVerdict(addr1).has_value());
+
+			generation1 = cache.GetGeneration(addr1);
+			generation2 = cache.GetGeneration(addr2);
+			cache.AddVerdict(addr1, generation1, false);
+			cache.AddVerdict(addr2, generation2, true);
+			Assert::AreEqual(false, *cache.GetVerdict(addr1));
+			Assert::AreEqual(true, *cache.GetVerdict(addr2));
+
+			// Blocked verdicts expire after a while
+			std::this_thread::sleep_for(1100ms);
+			Assert::AreEqual(false, cache.GetVerdict(addr1).has_value());
+			Assert::AreEqual(true, *cache.GetVerdict(addr2));
+		}
+
+		TEST_METHOD(Many)
+		{
+			AccessVerdictCache cache;
+
+			// Many more addresses than the cache keeps
+			for (UInt32 x = 0; x < 100'000; ++x)
+			{
+				const Address addr(IPAddress(BinaryIPAddress(0x0a000000 | x)));
+				cache.AddVerdict(addr, cache.GetGeneration(addr), (x % 2 == 0));
+			}
+
+			// Most recent address should still be there
+			const auto verdict = cache.GetVerdict(Address(IPAddress(BinaryIPAddress(0x0a000000 | 99'999))));
+			Assert::AreEqual(true, verdict.has_value());
+			Assert::AreEqual(false, *verdict);
+		}
+
+		TEST_METHOD(InvalidateAddress)
+		{
+			AccessVerdictCache cache;
+
+			Vector<Address> addrs;
+			for (UInt32 x = 0; x < 100; ++x)
+			{
+				addrs.emplace_back(IPAddress(BinaryIPAddress(0xc0a80000 | x)));
+			}
+
+			for (const auto& addr : addrs)
+			{
+				cache.AddVerdict(addr, cache.GetGeneration(addr), true);
+			}
+
+			// Only the verdict for the address goes away
+			cache.Invalidate(addrs[0]);
+			Assert::AreEqual(false, cache.GetVerdict(addrs[0]).has_value());
+
+			for (Size x = 1; x < addrs.size(); ++x)
+			{
+				Assert::AreEqual(true, *cache.GetVerdict(addrs[x]));
+			}
+
+			// A verdict made before a change to an address doesn't get added,
+			// also not for other addresses that were changed in the meantime
+			const auto generation = cache.GetGeneration(addrs[0]);
+			cache.Invalidate(addrs[0]);
+			cache.AddVerdict(addrs[0], generation, false);
+			Assert::AreEqual(false, cache.GetVerdict(addrs[0]).has_value());
+
+			cache.AddVerdict(addrs[0], cache.GetGeneration(addrs[0]), false);
+			Assert::AreEqual(false, *cache.GetVerdict(addrs[0]));
+
+			// Invalidating everything still works
+			cache.Invalidate();
+			for (const auto& addr : addrs)
+			{
+				Assert::AreEqual(false, cache.GetVerdict(addr).has_value());
+			}
+		}
+
+		TEST_METHOD(AccessUpdateScope)
+		{
+			const Address addr1(IPAddress(L"192.168.1.10"));
+			const Address addr2(IPAddress(L"192.168.2.10"));
+			const Address addr3(IPAddress(L"fe80::c11a:3a9c:ef10:e795"));
+			const Address addr4(BTHAddress(L"(92:5F:D3:5B:93:B2)"));
+
+			const AccessUpdate none(AccessUpdate::Scope::None);
+			const AccessUpdate all(AccessUpdate::Scope::All);
+			const AccessUpdate address(addr1);
+			const AccessUpdate network(IPAddress(L"192.168.1.0"), 24);
+
+			for (const auto& addr : { addr1, addr2, addr3, addr4 })
+			{
+				Assert::AreEqual(false, none.CanAffect(addr));
+				Assert::AreEqual(true, all.CanAffect(addr));
+			}
+
+			Assert::AreEqual(true, address.GetAddress() == addr1);
+			Assert::AreEqual(true, address.CanAffect(addr1));
+			Assert::AreEqual(false, address.CanAffect(addr2));
+			Assert::AreEqual(false, address.CanAffect(addr4));
+
+			Assert::AreEqual(true, network.CanAffect(addr1));
+			Assert::AreEqual(false, network.CanAffect(addr2));
+			Assert::AreEqual(false, network.CanAffect(addr3));
+			Assert::AreEqual(false, network.CanAffect(addr4));
+		}
+	};
+}
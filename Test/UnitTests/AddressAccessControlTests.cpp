@@ -21,11 +21,11 @@ namespace UnitTests
 		TEST_METHOD(ReputationGeneral)
 		{
 			Settings_CThS settings;
-			settings.UpdateValue([](Settings& set)
+			Assert::AreEqual(true, settings.UpdateValue([](Settings& set)
 			{
 				// For testing we let reputation improve every second
 				set.Local.AddressReputationImprovementInterval = 1s;
-			});
+			}));
 
 			AddressAccessControl reps(settings);
 			IPAddress ipaddr(L"192.168.1.10");
@@ -106,11 +106,11 @@ namespace UnitTests
 		TEST_METHOD(ReputationWithTime)
 		{
 			Settings_CThS settings;
-			settings.UpdateValue([](Settings& set)
+			Assert::AreEqual(true, settings.UpdateValue([](Settings& set)
 			{
 				// For testing we let reputation improve every second
 				set.Local.AddressReputationImprovementInterval = 1s;
-			});
+			}));
 
 			AddressAccessControl reps(settings);
 
@@ -229,14 +229,77 @@ namespace UnitTests
 			}
 		}
 
+		TEST_METHOD(ReputationConcurrency)
+		{
+			Settings_CThS settings;
+			Assert::AreEqual(true, settings.UpdateValue([](Settings& set)
+			{
+				// No improvement during the test
+				set.Local.AddressReputationImprovementInterval = 1h;
+			}));
+
+			AddressAccessControl reps(settings);
+
+			// Checking an unknown address doesn't add it
+			Assert::AreEqual(true, reps.HasAcceptableReputation(IPAddress(L"192.168.1.10")));
+			Assert::AreEqual(true, reps.GetReputations()->empty());
+
+			constexpr auto numthreads = 8u;
+			constexpr auto numaddresses = 64u;
+			constexpr auto numupdates = 10u;
+
+			std::vector<IPAddress> addresses;
+			for (auto x = 0u; x < numaddresses; ++x)
+			{
+				addresses.emplace_back(IPAddress(Util::FormatString(L"200.1.%u.%u", x / 8u, x)));
+			}
+
+			// All threads update and check the same addresses
+			// at the same time; no update should get lost
+			std::vector<std::thread> threads;
+			for (auto x = 0u; x < numthreads; ++x)
+			{
+				threads.emplace_back([&]()
+				{
+					for (auto y = 0u; y < numupdates; ++y)
+					{
+						for (const auto& ipaddr : addresses)
+						{
+							[[maybe_unused]] const auto result = reps.UpdateReputation(ipaddr,
+																					   AddressReputationUpdate::DeteriorateMinimal);
+							[[maybe_unused]] const auto acceptable = reps.HasAcceptableReputation(ipaddr);
+						}
+					}
+				});
+			}
+
+			for (auto& thread : threads)
+			{
+				thread.join();
+			}
+
+			const auto result = reps.GetReputations();
+			Assert::AreEqual(true, result.Succeeded());
+			Assert::AreEqual(true, result->size() == numaddresses);
+
+			const auto expected_score = AddressReputation::ScoreLimits::Maximum +
+				(static_cast<int>(AddressReputationUpdate::DeteriorateMinimal) * static_cast<int>(numthreads * numupdates));
+
+			for (const auto& rep : result.GetValue())
+			{
+				Assert::AreEqual(true, rep.Score == expected_score);
+				Assert::AreEqual(false, reps.HasAcceptableReputation(rep.Address));
+			}
+		}
+
 		TEST_METHOD(ConnectionAttempts)
 		{
 			Settings_CThS settings;
-			settings.UpdateValue([](Settings& set)
+			Assert::AreEqual(true, settings.UpdateValue([](Settings& set)
 			{
 				set.Local.ConnectionAttempts.MaxPerInterval = 2;
 				set.Local.ConnectionAttempts.Interval = 3s;
-			});
+			}));
 
 			AddressAccessControl ac(settings);
 
@@ -282,11 +345,11 @@ namespace UnitTests
 		TEST_METHOD(RelayConnectionAttempts)
 		{
 			Settings_CThS settings;
-			settings.UpdateValue([](Settings& set)
+			Assert::AreEqual(true, settings.UpdateValue([](Settings& set)
 			{
 				set.Relay.ConnectionAttempts.MaxPerInterval = 2;
 				set.Relay.ConnectionAttempts.Interval = 3s;
-			});
+			}));
 
 			AddressAccessControl ac(settings);
 
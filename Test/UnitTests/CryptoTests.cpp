@@ -4,6 +4,8 @@
 #include "pch.h"
 #include "Common\Util.h"
 #include "Crypto\Crypto.h"
+#include "Common\Obfuscate.h"
+#include "..\..\QuantumGateCryptoLib\QuantumGateCryptoLib.h"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -64,6 +66,16 @@ namespace UnitTests
 									 Crypto::GenerateSymmetricKeys(BufferView(reinterpret_cast<Byte*>(secret.data()),
 																			  secret.size()), skd, skd2));
 
+					// Key hints depend on the key and the seed
+					{
+						const auto seed = static_cast<UInt32>(Util::GetPseudoRandomNumber());
+
+						Assert::AreEqual(true, skd.HintKey.GetSize() == 16 && skd2.HintKey.GetSize() == 16);
+						Assert::AreEqual(true, Crypto::GetSymmetricKeyHint(skd, seed) == Crypto::GetSymmetricKeyHint(skd, seed));
+						Assert::AreEqual(true, Crypto::GetSymmetricKeyHint(skd, seed) != Crypto::GetSymmetricKeyHint(skd2, seed));
+						Assert::AreEqual(true, Crypto::GetSymmetricKeyHint(skd, seed) != Crypto::GetSymmetricKeyHint(skd, seed + 1));
+					}
+
 					for (const auto& input : inputbufs)
 					{
 						{
@@ -85,6 +97,33 @@ namespace UnitTests
 							// Decrypted data must match original input
 							Assert::AreEqual(true, (doutbuf == input));
 						}
+
+						{
+							Buffer eoutbuf;
+							Assert::AreEqual(true, Crypto::Encrypt(input, eoutbuf, skd, noncev));
+
+							// Tag goes in front of the data
+							Buffer buf(Crypto::SymmetricTagSize + input.GetSize());
+							std::memcpy(buf.GetBytes() + Crypto::SymmetricTagSize, input.GetBytes(), input.GetSize());
+
+							BufferSpan ebuf(buf);
+							Assert::AreEqual(true, Crypto::EncryptInPlace(ebuf, skd, noncev));
+
+							// Should produce the same output as Encrypt()
+							Assert::AreEqual(true, (buf == eoutbuf));
+
+							BufferSpan dbuf(buf);
+							Assert::AreEqual(true, Crypto::DecryptInPlace(dbuf, skd, noncev));
+
+							// Decrypted data must match original input
+							Assert::AreEqual(true, (input == dbuf));
+							Assert::AreEqual(true, (dbuf.GetBytes() == buf.GetBytes() + Crypto::SymmetricTagSize));
+
+							// Tampered data should not decrypt
+							BufferSpan ebuf2(eoutbuf);
+							ebuf2[ebuf2.GetSize() - 1] = ebuf2[ebuf2.GetSize() - 1] ^ Byte{ 0x01 };
+							Assert::AreEqual(false, Crypto::DecryptInPlace(ebuf2, skd, noncev));
+						}
 					}
 				}
 			}
@@ -190,6 +229,251 @@ namespace UnitTests
 			}
 		}
 
+		TEST_METHOD(RestoreAsymmetricKeys)
+		{
+			const std::vector<Algorithm::Asymmetric> algs =
+			{
+				Algorithm::Asymmetric::ECDH_SECP521R1,
+				Algorithm::Asymmetric::ECDH_X25519,
+				Algorithm::Asymmetric::ECDH_X448,
+				Algorithm::Asymmetric::KEM_NTRUPRIME,
+				Algorithm::Asymmetric::KEM_NEWHOPE,
+				Algorithm::Asymmetric::KEM_CLASSIC_MCELIECE
+			};
+
+			for (const auto aa : algs)
+			{
+				Crypto::AsymmetricKeyData akd(aa);
+				Assert::AreEqual(true, Crypto::GenerateAsymmetricKeys(akd));
+
+				// Restore Alice's keys from just the key buffers
+				Crypto::AsymmetricKeyData akd_alice(aa);
+				akd_alice.SetOwner(Crypto::AsymmetricKeyOwner::Alice);
+				akd_alice.LocalPrivateKey = akd.LocalPrivateKey;
+				akd_alice.LocalPublicKey = akd.LocalPublicKey;
+				Assert::AreEqual(true, Crypto::RestoreAsymmetricKeys(akd_alice));
+
+				Crypto::AsymmetricKeyData akd_bob(aa);
+				akd_bob.SetOwner(Crypto::AsymmetricKeyOwner::Bob);
+				akd_bob.PeerPublicKey = akd_alice.LocalPublicKey;
+
+				if (akd_bob.GetKeyExchangeType() == Crypto::KeyExchangeType::DiffieHellman)
+				{
+					Assert::AreEqual(true, Crypto::GenerateAsymmetricKeys(akd_bob));
+					akd_alice.PeerPublicKey = akd_bob.LocalPublicKey;
+
+					Assert::AreEqual(true, Crypto::GenerateSharedSecret(akd_bob));
+					Assert::AreEqual(true, Crypto::GenerateSharedSecret(akd_alice));
+				}
+				else
+				{
+					Assert::AreEqual(true, Crypto::GenerateSharedSecret(akd_bob));
+					akd_alice.EncryptedSharedSecret = akd_bob.EncryptedSharedSecret;
+
+					Assert::AreEqual(true, Crypto::GenerateSharedSecret(akd_alice));
+				}
+
+				// Shared secrets should match
+				Assert::AreEqual(true, akd_alice.SharedSecret == akd_bob.SharedSecret);
+
+				// Public key that doesn't belong to the private key
+				if (akd.GetKeyExchangeType() == Crypto::KeyExchangeType::DiffieHellman)
+				{
+					Crypto::AsymmetricKeyData akd2(aa);
+					akd2.LocalPrivateKey = akd.LocalPrivateKey;
+					akd2.LocalPublicKey = akd_bob.LocalPublicKey;
+					Assert::AreEqual(false, Crypto::RestoreAsymmetricKeys(akd2));
+				}
+
+				// No keys
+				Crypto::AsymmetricKeyData akd3(aa);
+				Assert::AreEqual(false, Crypto::RestoreAsymmetricKeys(akd3));
+			}
+		}
+
+		TEST_METHOD(AsymmetricAlgorithmsAVX2)
+		{
+			// The AVX2 implementations should give exactly the same keys, ciphertexts
+			// and shared secrets as the reference implementations from the same random bytes
+			const std::vector<Algorithm::Asymmetric> algs =
+			{
+				Algorithm::Asymmetric::KEM_NTRUPRIME,
+				Algorithm::Asymmetric::KEM_NEWHOPE,
+				Algorithm::Asymmetric::KEM_CLASSIC_MCELIECE
+			};
+
+			if (!QGCryptoCPUSupportsAVX2())
+			{
+				Logger::WriteMessage(L"The CPU doesn't support AVX2; only the reference implementations get tested");
+			}
+
+			struct Result final
+			{
+				ProtectedBuffer PrivateKey;
+				ProtectedBuffer PublicKey;
+				ProtectedBuffer EncryptedSharedSecret;
+				ProtectedBuffer SharedSecret;
+			};
+
+			const auto run = [](const Algorithm::Asymmetric aa, const bool avx2, const unsigned char* seed)
+			{
+				QGCryptoSetAVX2Enabled(avx2 ? 1 : 0);
+				QGCryptoSetDeterministicRng(seed);
+
+				Crypto::AsymmetricKeyData akd_alice(aa);
+				akd_alice.SetOwner(Crypto::AsymmetricKeyOwner::Alice);
+				Assert::AreEqual(true, Crypto::GenerateAsymmetricKeys(akd_alice));
+
+				Crypto::AsymmetricKeyData akd_bob(aa);
+				akd_bob.SetOwner(Crypto::AsymmetricKeyOwner::Bob);
+				akd_bob.PeerPublicKey = akd_alice.LocalPublicKey;
+				Assert::AreEqual(true, Crypto::GenerateSharedSecret(akd_bob));
+
+				akd_alice.EncryptedSharedSecret = akd_bob.EncryptedSharedSecret;
+				Assert::AreEqual(true, Crypto::GenerateSharedSecret(akd_alice));
+				Assert::AreEqual(true, akd_alice.SharedSecret == akd_bob.SharedSecret);
+
+				QGCryptoSetDeterministicRng(nullptr);
+				QGCryptoSetAVX2Enabled(1);
+
+				return Result{ akd_alice.LocalPrivateKey, akd_alice.LocalPublicKey,
+					akd_bob.EncryptedSharedSecret, akd_alice.SharedSecret };
+			};
+
+			for (const auto aa : algs)
+			{
+				for (unsigned char x = 0; x < 2; ++x)
+				{
+					std::array<unsigned char, 32> seed{};
+					seed.fill(x + 1);
+
+					const auto ref = run(aa, false, seed.data());
+					const auto avx2 = run(aa, true, seed.data());
+
+					Assert::AreEqual(true, ref.PrivateKey == avx2.PrivateKey);
+					Assert::AreEqual(true, ref.PublicKey == avx2.PublicKey);
+					Assert::AreEqual(true, ref.EncryptedSharedSecret == avx2.EncryptedSharedSecret);
+					Assert::AreEqual(true, ref.SharedSecret == avx2.SharedSecret);
+
+					// A different seed gives different keys
+					if (x > 0)
+					{
+						std::array<unsigned char, 32> seed2{};
+						seed2.fill(x);
+
+						const auto ref2 = run(aa, false, seed2.data());
+						Assert::AreEqual(false, ref.PublicKey == ref2.PublicKey);
+					}
+				}
+			}
+		}
+
+		TEST_METHOD(HalfSipHashBatch)
+		{
+			// Batches should give exactly the same hashes as hashing each message on its own,
+			// with and without AVX2, for full and partly filled groups of eight messages
+			if (!QGCryptoCPUSupportsAVX2())
+			{
+				Logger::WriteMessage(L"The CPU doesn't support AVX2; only the reference implementation gets tested");
+			}
+
+			const std::array<uint8_t, 8> key{ 0x51, 0x75, 0x61, 0x6e, 0x74, 0x75, 0x6d, 0x47 };
+
+			// All lengths up to a little more than two 32-byte blocks of eight
+			// messages, and lengths around larger multiples of 32 bytes
+			std::vector<Size> lengths;
+			for (Size x = 0; x <= 70; ++x) lengths.emplace_back(x);
+
+			for (const Size x : { 96, 128, 256, 1024, 1472 })
+			{
+				lengths.emplace_back(x - 1);
+				lengths.emplace_back(x);
+				lengths.emplace_back(x + 1);
+			}
+
+			const auto max_len = *std::max_element(lengths.begin(), lengths.end());
+
+			// Messages start at different (unaligned) offsets in the data
+			const auto data = Util::GetPseudoRandomBytes(max_len + 17);
+			const auto data_ptr = reinterpret_cast<const uint8_t*>(data.GetBytes());
+
+			constexpr Size max_num{ 17 };
+
+			for (const Size num : { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 17 })
+			{
+				for (const auto same_length : { true, false })
+				{
+					for (Size l = 0; l < lengths.size(); ++l)
+					{
+						std::array<const uint8_t*, max_num> in{ nullptr };
+						std::array<size_t, max_num> inlen{ 0 };
+						std::array<uint8_t, max_num * 4> ref{ 0 };
+
+						for (Size x = 0; x < num; ++x)
+						{
+							in[x] = data_ptr + x;
+							inlen[x] = same_length ? lengths[l] : lengths[(l + x * 7) % lengths.size()];
+							halfsiphash(in[x], inlen[x], key.data(), ref.data() + x * 4, 4);
+						}
+
+						for (const auto avx2 : { false, true })
+						{
+							QGCryptoSetAVX2Enabled(avx2 ? 1 : 0);
+
+							std::array<uint8_t, max_num * 4> out{ 0 };
+							halfsiphash_batch(in.data(), inlen.data(), num, key.data(), out.data());
+
+							QGCryptoSetAVX2Enabled(1);
+
+							Assert::AreEqual(true, std::memcmp(out.data(), ref.data(), num * 4) == 0);
+
+							// Nothing gets written past the hashes of the messages
+							Assert::AreEqual(true, std::all_of(out.begin() + num * 4, out.end(),
+															   [](const auto b) { return b == 0; }));
+						}
+					}
+				}
+			}
+		}
+
+		TEST_METHOD(ObfuscateAVX2)
+		{
+			// Obfuscation with AVX2 should give exactly the same output as without it,
+			// including for the words and bytes after the last whole 64-byte repetition
+			if (!QGCryptoCPUSupportsAVX2())
+			{
+				Logger::WriteMessage(L"The CPU doesn't support AVX2; only the reference implementation gets tested");
+			}
+
+			const auto key = Util::GetPseudoRandomBytes(8);
+			const auto data = Util::GetPseudoRandomBytes(1600);
+
+			for (const Size len : { 1, 7, 9, 63, 65, 71, 127, 129, 135, 1231, 1233, 1471, 1473 })
+			{
+				// Data doesn't have to be aligned
+				for (Size offset = 0; offset < 8; ++offset)
+				{
+					const auto iv = static_cast<UInt32>(len * 8 + offset);
+
+					Buffer ref(data);
+					auto ref_span = BufferSpan(ref).GetSub(offset, len);
+					QGCryptoSetAVX2Enabled(0);
+					Obfuscate::Do(ref_span, key, iv);
+
+					Buffer out(data);
+					auto out_span = BufferSpan(out).GetSub(offset, len);
+					QGCryptoSetAVX2Enabled(1);
+					Obfuscate::Do(out_span, key, iv);
+
+					Assert::AreEqual(true, out == ref);
+
+					// Only the data in the span gets changed
+					Obfuscate::Undo(out_span, key, iv);
+					Assert::AreEqual(true, out == data);
+				}
+			}
+		}
+
 		TEST_METHOD(HashAlgorithms)
 		{
 			std::vector<String> hstr =
@@ -63,5 +63,32 @@ namespace UnitTests
 				Assert::AreEqual(false, hash1 == hash3);
 			}
 		}
+
+		TEST_METHOD(ShardIndex)
+		{
+			// The shard is chosen with the top bits of the hash
+			constexpr auto max = std::numeric_limits<std::size_t>::max();
+			constexpr auto top = std::size_t{ 1 } << (sizeof(std::size_t) * 8 - 1);
+
+			static_assert(Hash::GetShardIndex<4>(0) == 0);
+			static_assert(Hash::GetShardIndex<4>(max >> 4) == 0);
+			static_assert(Hash::GetShardIndex<4>(max) == 15);
+			static_assert(Hash::GetShardIndex<4>(top | 1) == 8);
+			static_assert(Hash::GetShardIndex<1>(max) == 1);
+
+			// All shards get used
+			std::array<Size, 16> counts{};
+			for (UInt64 x = 0; x < 16'000; ++x)
+			{
+				const auto idx = Hash::GetShardIndex<4>(std::hash<UInt64>{}(Hash::GetNonPersistentHash(x)));
+				Assert::AreEqual(true, idx < counts.size());
+				++counts[idx];
+			}
+
+			for (const auto count : counts)
+			{
+				Assert::AreEqual(true, count > 0);
+			}
+		}
 	};
 }
\ No newline at end of file
@@ -0,0 +1,125 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#include "pch.h"
+#include "Network\IPAddress.h"
+#include "Network\IPAddressTrie.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace QuantumGate::Implementation::Network;
+
+namespace UnitTests
+{
+	TEST_CLASS(IPAddressTrieTests)
+	{
+	public:
+		TEST_METHOD(General)
+		{
+			IPAddressTrie<int> trie;
+			Assert::AreEqual(true, trie.IsEmpty());
+			Assert::AreEqual(true, trie.FindLongestMatch(IPAddress(L"192.168.1.1").GetBinary()) == nullptr);
+
+			// Host bits get ignored
+			const auto [value1, inserted1] = trie.Insert(IPAddress(L"192.168.1.20").GetBinary(), 24, 1);
+			Assert::AreEqual(true, inserted1);
+			Assert::AreEqual(true, *value1 == 1);
+
+			const auto [value2, inserted2] = trie.Insert(IPAddress(L"192.168.1.0").GetBinary(), 24, 2);
+			Assert::AreEqual(false, inserted2);
+			Assert::AreEqual(true, value2 == value1);
+
+			Assert::AreEqual(true, trie.Insert(IPAddress(L"192.168.0.0").GetBinary(), 16, 3).second);
+			Assert::AreEqual(true, trie.Insert(IPAddress(L"192.168.1.128").GetBinary(), 25, 4).second);
+			Assert::AreEqual(true, trie.Insert(IPAddress(L"10.0.0.0").GetBinary(), 8, 5).second);
+			Assert::AreEqual(true, trie.Insert(IPAddress(L"0.0.0.0").GetBinary(), 0, 6).second);
+			Assert::AreEqual(true, trie.Insert(IPAddress(L"fe80::").GetBinary(), 10, 7).second);
+			Assert::AreEqual(true, trie.Insert(IPAddress(L"fe80:c11a:3a9c::").GetBinary(), 48, 8).second);
+
+			// Invalid prefix length
+			Assert::AreEqual(true, trie.Insert(IPAddress(L"10.0.0.0").GetBinary(), 33, 9).first == nullptr);
+
+			Assert::AreEqual(true, trie.GetSize() == 7);
+
+			Assert::AreEqual(true, *trie.Find(IPAddress(L"192.168.0.0").GetBinary(), 16) == 3);
+			Assert::AreEqual(true, trie.Find(IPAddress(L"192.168.0.0").GetBinary(), 17) == nullptr);
+
+			// Most specific network
+			Assert::AreEqual(true, *trie.FindLongestMatch(IPAddress(L"192.168.1.200").GetBinary()) == 4);
+			Assert::AreEqual(true, *trie.FindLongestMatch(IPAddress(L"192.168.1.100").GetBinary()) == 1);
+			Assert::AreEqual(true, *trie.FindLongestMatch(IPAddress(L"192.168.2.1").GetBinary()) == 3);
+			Assert::AreEqual(true, *trie.FindLongestMatch(IPAddress(L"10.20.30.40").GetBinary()) == 5);
+			Assert::AreEqual(true, *trie.FindLongestMatch(IPAddress(L"11.20.30.40").GetBinary()) == 6);
+
+			// Address families are separate
+			Assert::AreEqual(true, *trie.FindLongestMatch(IPAddress(L"fe80:c11a:3a9c:ef10::").GetBinary()) == 8);
+			Assert::AreEqual(true, *trie.FindLongestMatch(IPAddress(L"febf::1").GetBinary()) == 7);
+			Assert::AreEqual(false, trie.HasMatch(IPAddress(L"fec0::1").GetBinary()));
+			Assert::AreEqual(false, trie.HasMatch(IPAddress(L"::ffff:c0a8:0101").GetBinary()));
+
+			// All networks from least to most specific
+			Vector<int> values;
+			trie.ForEachMatch(IPAddress(L"192.168.1.200").GetBinary(), [&](const UInt8, const int& value)
+			{
+				values.emplace_back(value);
+				return true;
+			});
+			Assert::AreEqual(true, values == Vector<int>{ 6, 3, 1, 4 });
+
+			Assert::AreEqual(true, trie.Remove(IPAddress(L"192.168.1.0").GetBinary(), 24));
+			Assert::AreEqual(false, trie.Remove(IPAddress(L"192.168.1.0").GetBinary(), 24));
+			Assert::AreEqual(true, *trie.FindLongestMatch(IPAddress(L"192.168.1.100").GetBinary()) == 3);
+			Assert::AreEqual(true, *trie.FindLongestMatch(IPAddress(L"192.168.1.200").GetBinary()) == 4);
+
+			Assert::AreEqual(true, trie.Remove(IPAddress(L"0.0.0.0").GetBinary(), 0));
+			Assert::AreEqual(false, trie.HasMatch(IPAddress(L"11.20.30.40").GetBinary()));
+
+			trie.RemoveIf([](const BinaryIPAddress& network, const UInt8, const int&)
+			{
+				return (network.AddressFamily == BinaryIPAddress::Family::IPv6);
+			});
+			Assert::AreEqual(false, trie.HasMatch(IPAddress(L"fe80:c11a:3a9c:ef10::").GetBinary()));
+			Assert::AreEqual(true, trie.GetSize() == 3);
+
+			trie.Clear();
+			Assert::AreEqual(true, trie.IsEmpty());
+			Assert::AreEqual(false, trie.HasMatch(IPAddress(L"192.168.1.200").GetBinary()));
+		}
+
+		TEST_METHOD(Many)
+		{
+			IPAddressTrie<UInt32> trie;
+			trie.Reserve(65536);
+
+			// All /24 networks in 10.0.0.0/8 with an even second byte
+			for (UInt32 x = 0; x < 65536; x += 2)
+			{
+				const auto network = BinaryIPAddress(static_cast<UInt32>(0x0a000000 | (x << 8)));
+				Assert::AreEqual(true, trie.Insert(network, 24, x).second);
+			}
+
+			Assert::AreEqual(true, trie.GetSize() == 32768);
+
+			auto success = true;
+
+			for (UInt32 x = 0; x < 65536; ++x)
+			{
+				const auto ip = BinaryIPAddress(static_cast<UInt32>(0x0a000000 | (x << 8) | (x & 0xff)));
+				const auto value = trie.FindLongestMatch(ip);
+
+				if ((x % 2 == 0) != (value != nullptr) || (value != nullptr && *value != x)) success = false;
+			}
+
+			Assert::AreEqual(true, success);
+
+			// Removing in a different order than adding
+			for (UInt32 x = 0; x < 65536; x += 2)
+			{
+				const auto y = (x * 7919) & 0xfffe;
+				if (!trie.Remove(BinaryIPAddress(static_cast<UInt32>(0x0a000000 | (y << 8))), 24)) success = false;
+			}
+
+			Assert::AreEqual(true, success);
+			Assert::AreEqual(true, trie.IsEmpty());
+		}
+	};
+}
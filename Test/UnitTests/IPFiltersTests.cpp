@@ -3,6 +3,7 @@
 
 #include "pch.h"
 #include "Core\Access\IPFilters.h"
+#include "Common\Util.h"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 using namespace QuantumGate::Implementation::Core::Access;
@@ -240,5 +241,58 @@ namespace UnitTests
 				Assert::AreEqual(false, ipfilters.GetAllowed(L"fe80:c11a:3a9c:ef11:e795::f000").GetValue());
 			}
 		}
+
+		TEST_METHOD(AddFilters)
+		{
+			IPFilters ipfilters;
+
+			// Nothing gets added if one of the filters is invalid
+			Assert::AreEqual(true, ipfilters.AddFilters({ L"192.168.0.0/16", L"10.0.0.0/33" },
+														IPFilterType::Allowed) == ResultCode::AddressMaskInvalid);
+			Assert::AreEqual(true, ipfilters.AddFilters({ L"192.168.0.0/16", L"10.0.0.0" },
+														IPFilterType::Allowed) == ResultCode::AddressMaskInvalid);
+			Assert::AreEqual(true, ipfilters.AddFilters({ L"192.168.0.0/16", L"10.abc.0.0/8" },
+														IPFilterType::Allowed) == ResultCode::AddressInvalid);
+			Assert::AreEqual(static_cast<size_t>(0), ipfilters.GetFilters().GetValue().size());
+
+			auto result = ipfilters.AddFilters({ L"0.0.0.0/0", L"::/0" }, IPFilterType::Allowed);
+			Assert::AreEqual(true, result.Succeeded());
+			Assert::AreEqual(static_cast<size_t>(2), result->size());
+
+			// Block list with a duplicate and filters for the same network
+			Vector<String> blocked{ L"10.0.0.0/8", L"192.168.1.0/24", L"192.168.1.10/24",
+									L"fe80:c11a:3a9c::/48", L"10.0.0.0/8" };
+
+			for (auto x = 0; x < 1000; ++x)
+			{
+				blocked.emplace_back(Util::FormatString(L"172.%d.%d.0/24", 16 + (x / 256), x % 256));
+			}
+
+			auto result2 = ipfilters.AddFilters(blocked, IPFilterType::Blocked);
+			Assert::AreEqual(true, result2.Succeeded());
+			Assert::AreEqual(true, result2->size() == blocked.size());
+			Assert::AreEqual(true, result2->at(0) == result2->at(4));
+			Assert::AreEqual(static_cast<size_t>(2 + blocked.size() - 1), ipfilters.GetFilters().GetValue().size());
+
+			// Adding again returns the same filters
+			auto result3 = ipfilters.AddFilters(blocked, IPFilterType::Blocked);
+			Assert::AreEqual(true, result3.Succeeded());
+			Assert::AreEqual(true, *result3 == *result2);
+			Assert::AreEqual(static_cast<size_t>(2 + blocked.size() - 1), ipfilters.GetFilters().GetValue().size());
+
+			Assert::AreEqual(false, ipfilters.GetAllowed(L"10.1.2.3").GetValue());
+			Assert::AreEqual(false, ipfilters.GetAllowed(L"192.168.1.0").GetValue());
+			Assert::AreEqual(false, ipfilters.GetAllowed(L"172.18.231.1").GetValue());
+			Assert::AreEqual(false, ipfilters.GetAllowed(L"fe80:c11a:3a9c:ef10::1").GetValue());
+			Assert::AreEqual(true, ipfilters.GetAllowed(L"172.19.232.1").GetValue());
+			Assert::AreEqual(true, ipfilters.GetAllowed(L"192.168.2.1").GetValue());
+			Assert::AreEqual(true, ipfilters.GetAllowed(L"fe80:c11a:3a9d::1").GetValue());
+
+			// Both filters for 192.168.1.0/24 need to be removed
+			Assert::AreEqual(true, ipfilters.RemoveFilter(result2->at(1), IPFilterType::Blocked).Succeeded());
+			Assert::AreEqual(false, ipfilters.GetAllowed(L"192.168.1.1").GetValue());
+			Assert::AreEqual(true, ipfilters.RemoveFilter(result2->at(2), IPFilterType::Blocked).Succeeded());
+			Assert::AreEqual(true, ipfilters.GetAllowed(L"192.168.1.1").GetValue());
+		}
 	};
 }
\ No newline at end of file
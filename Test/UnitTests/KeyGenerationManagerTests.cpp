@@ -0,0 +1,237 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#include "pch.h"
+#include "Settings.h"
+#include "Core\KeyGeneration\KeyGenerationManager.h"
+#include "Concurrency\Event.h"
+
+using namespace std::literals;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace QuantumGate::Implementation;
+using namespace QuantumGate::Implementation::Core::KeyGeneration;
+
+namespace UnitTests
+{
+	TEST_CLASS(KeyGenerationManagerTests)
+	{
+	public:
+		void SetupSettings(Settings_CThS& settings, const Size num_pregen)
+		{
+			Assert::AreEqual(true, settings.UpdateValue([&](Settings& set)
+			{
+				set.Local.SupportedAlgorithms.PrimaryAsymmetric = { Algorithm::Asymmetric::ECDH_X25519 };
+				set.Local.SupportedAlgorithms.SecondaryAsymmetric = { Algorithm::Asymmetric::ECDH_X25519 };
+				set.Local.NumPreGeneratedKeysPerAlgorithm = num_pregen;
+			}));
+		}
+
+		std::optional<KeyGenerationStatistics::AlgorithmDetails> GetDetails(const Manager& mgr)
+		{
+			const auto stats = mgr.GetStatistics();
+			if (!stats.has_value() || stats->Algorithms.size() != 1) return std::nullopt;
+
+			return stats->Algorithms.front();
+		}
+
+		TEST_METHOD(RequestCompletesWithCallback)
+		{
+			Settings_CThS settings;
+			SetupSettings(settings, 0);
+
+			Manager mgr(settings);
+			Assert::AreEqual(true, mgr.Startup());
+
+			// No pregenerated keys so the request has to wait
+			// until a key generation thread completes it
+			Concurrency::Event event;
+			std::atomic<Size> num_callbacks{ 0 };
+
+			const auto request = mgr.RequestAsymmetricKeys(Algorithm::Asymmetric::ECDH_X25519, [&]() noexcept
+			{
+				++num_callbacks;
+				event.Set();
+			});
+
+			Assert::AreEqual(true, request != nullptr);
+			Assert::AreEqual(true, event.Wait(10s));
+			Assert::AreEqual(true, num_callbacks.load() == 1);
+
+			request->WithUniqueLock([](const KeyRequest& key_request)
+			{
+				Assert::AreEqual(true, key_request.Completed);
+				Assert::AreEqual(true, key_request.KeyData.has_value());
+				Assert::AreEqual(true, key_request.KeyData->GetAlgorithm() == Algorithm::Asymmetric::ECDH_X25519);
+				Assert::AreEqual(true, !key_request.CompletionCallback);
+			});
+
+			const auto stats = mgr.GetStatistics();
+			Assert::AreEqual(true, stats.has_value());
+			Assert::AreEqual(true, stats->NumRequestedKeys == 1);
+			Assert::AreEqual(true, stats->NumPendingRequests == 0);
+
+			const auto details = GetDetails(mgr);
+			Assert::AreEqual(true, details.has_value());
+			Assert::AreEqual(true, details->NumHits == 0);
+			Assert::AreEqual(true, details->NumMisses == 1);
+
+			mgr.Shutdown();
+
+			// Unknown algorithm
+			Assert::AreEqual(true, mgr.Startup());
+			Assert::AreEqual(true, mgr.RequestAsymmetricKeys(Algorithm::Asymmetric::KEM_NTRUPRIME, []() noexcept {}) == nullptr);
+			mgr.Shutdown();
+
+			// Not running
+			Assert::AreEqual(true, mgr.RequestAsymmetricKeys(Algorithm::Asymmetric::ECDH_X25519, []() noexcept {}) == nullptr);
+		}
+
+		TEST_METHOD(RequestCompletesImmediately)
+		{
+			Settings_CThS settings;
+			SetupSettings(settings, 1);
+
+			Manager mgr(settings);
+			Assert::AreEqual(true, mgr.Startup());
+
+			// Wait for the pregenerated key
+			auto available = false;
+			for (auto x = 0; x < 100 && !available; ++x)
+			{
+				const auto details = GetDetails(mgr);
+				available = (details.has_value() && details->NumKeys == 1);
+				if (!available) std::this_thread::sleep_for(100ms);
+			}
+
+			Assert::AreEqual(true, available);
+
+			// The request completes right away; the callback
+			// is only for requests that have to wait
+			auto callback_called = false;
+
+			const auto request = mgr.RequestAsymmetricKeys(Algorithm::Asymmetric::ECDH_X25519, [&]() noexcept
+			{
+				callback_called = true;
+			});
+
+			Assert::AreEqual(true, request != nullptr);
+			Assert::AreEqual(false, callback_called);
+
+			request->WithUniqueLock([](const KeyRequest& key_request)
+			{
+				Assert::AreEqual(true, key_request.Completed);
+				Assert::AreEqual(true, key_request.KeyData.has_value());
+				Assert::AreEqual(true, key_request.KeyData->GetAlgorithm() == Algorithm::Asymmetric::ECDH_X25519);
+			});
+
+			const auto stats = mgr.GetStatistics();
+			Assert::AreEqual(true, stats.has_value());
+			Assert::AreEqual(true, stats->NumRequestedKeys == 0);
+			Assert::AreEqual(true, stats->NumPendingRequests == 0);
+
+			const auto details = GetDetails(mgr);
+			Assert::AreEqual(true, details.has_value());
+			Assert::AreEqual(true, details->NumHits == 1);
+			Assert::AreEqual(true, details->NumMisses == 0);
+
+			mgr.Shutdown();
+		}
+
+		TEST_METHOD(NeedsCountedOnce)
+		{
+			Settings_CThS settings;
+			SetupSettings(settings, 0);
+
+			Manager mgr(settings);
+			Assert::AreEqual(true, mgr.Startup());
+
+			const auto request = mgr.RequestAsymmetricKeys(Algorithm::Asymmetric::ECDH_X25519, []() noexcept {});
+			Assert::AreEqual(true, request != nullptr);
+
+			// Falling back to a pregenerated key after a request
+			// doesn't count as another need for a key
+			[[maybe_unused]] auto keys = mgr.GetAsymmetricKeys(Algorithm::Asymmetric::ECDH_X25519, true);
+
+			auto details = GetDetails(mgr);
+			Assert::AreEqual(true, details.has_value());
+			Assert::AreEqual(true, details->NumHits + details->NumMisses == 1);
+
+			// Without a request it does
+			keys = mgr.GetAsymmetricKeys(Algorithm::Asymmetric::ECDH_X25519);
+
+			details = GetDetails(mgr);
+			Assert::AreEqual(true, details.has_value());
+			Assert::AreEqual(true, details->NumHits + details->NumMisses == 2);
+
+			mgr.Shutdown();
+		}
+
+		TEST_METHOD(TargetSizes)
+		{
+			constexpr Size min_size{ 5 };
+			constexpr auto window = 10s;
+			constexpr Size budget{ 64'000'000 };
+
+			// No demand
+			{
+				Vector<Manager::QueueDemand> demands(1);
+				Manager::CalcTargetSizes(demands, min_size, window, budget);
+				Assert::AreEqual(true, demands[0].TargetSize == min_size);
+			}
+
+			// Nothing to do
+			{
+				Vector<Manager::QueueDemand> demands;
+				Manager::CalcTargetSizes(demands, min_size, window, budget);
+				Assert::AreEqual(true, demands.empty());
+			}
+
+			// Demand without a known generation time
+			{
+				Vector<Manager::QueueDemand> demands(1);
+				demands[0].NeededRate = 2.0;
+				Manager::CalcTargetSizes(demands, min_size, window, budget);
+				Assert::AreEqual(true, demands[0].TargetSize == 20);
+			}
+
+			// Slow and fast key generation with the same demand
+			{
+				Vector<Manager::QueueDemand> demands(2);
+				demands[0].NeededRate = 10.0;
+				demands[0].GenerationTime = 1s;
+				demands[0].KeySize = 1000;
+				demands[1].NeededRate = 10.0;
+				demands[1].GenerationTime = 1ms;
+				demands[1].KeySize = 1000;
+				Manager::CalcTargetSizes(demands, min_size, window, budget);
+
+				// 10 keys/s for 10s, minus the 10 keys one thread generates in that time
+				Assert::AreEqual(true, demands[0].TargetSize == 90);
+
+				// Generation keeps up with the demand
+				Assert::AreEqual(true, demands[1].TargetSize == min_size);
+			}
+
+			// Keys beyond the minimum get scaled down to fit the memory budget
+			{
+				Vector<Manager::QueueDemand> demands(2);
+				for (auto& demand : demands)
+				{
+					demand.NeededRate = 10.0;
+					demand.GenerationTime = 1s;
+					demand.KeySize = 1000;
+				}
+
+				// Minimum 2 * 5 keys, extra 2 * 85 keys; half of the extra fits
+				Manager::CalcTargetSizes(demands, min_size, window, (10 + 85) * 1000);
+				Assert::AreEqual(true, demands[0].TargetSize == 5 + 42);
+				Assert::AreEqual(true, demands[1].TargetSize == 5 + 42);
+
+				// The minimum number of keys is always kept
+				Manager::CalcTargetSizes(demands, min_size, window, 1000);
+				Assert::AreEqual(true, demands[0].TargetSize == min_size);
+				Assert::AreEqual(true, demands[1].TargetSize == min_size);
+			}
+		}
+	};
+}
@@ -0,0 +1,211 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#include "pch.h"
+#include "Core\KeyGeneration\KeyPoolFile.h"
+#include "Crypto\Crypto.h"
+
+#include <fstream>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace QuantumGate::Implementation::Core::KeyGeneration;
+
+namespace UnitTests
+{
+	TEST_CLASS(KeyPoolFileTests)
+	{
+	public:
+		String GetFilePath()
+		{
+			return (std::filesystem::temp_directory_path() / L"QuantumGateKeyPoolFileTests.qgkp").wstring();
+		}
+
+		ProtectedBuffer GetSecret(const char* str)
+		{
+			return ProtectedBuffer(reinterpret_cast<const Byte*>(str), std::strlen(str));
+		}
+
+		Vector<KeyPoolFile::KeyPool> GetPools()
+		{
+			Vector<KeyPoolFile::KeyPool> pools;
+
+			for (const auto alg : { Algorithm::Asymmetric::ECDH_X25519, Algorithm::Asymmetric::KEM_NTRUPRIME })
+			{
+				auto& pool = pools.emplace_back(alg);
+				pool.NeededRate = 2.5;
+				pool.GenerationTime = std::chrono::milliseconds(3);
+
+				for (auto x = 0; x < 3; ++x)
+				{
+					auto& keydata = pool.Keys.emplace_back(alg);
+					Assert::AreEqual(true, Crypto::GenerateAsymmetricKeys(keydata));
+				}
+			}
+
+			return pools;
+		}
+
+		bool IsSameKey(const Crypto::AsymmetricKeyData& keydata1, const Crypto::AsymmetricKeyData& keydata2)
+		{
+			return (keydata1.GetAlgorithm() == keydata2.GetAlgorithm() &&
+					keydata1.LocalPrivateKey == keydata2.LocalPrivateKey &&
+					keydata1.LocalPublicKey == keydata2.LocalPublicKey);
+		}
+
+		Size GetNumKeys(const Vector<KeyPoolFile::KeyPool>& pools)
+		{
+			Size num{ 0 };
+			for (const auto& pool : pools) num += pool.Keys.size();
+			return num;
+		}
+
+		TEST_METHOD(SaveAndLoad)
+		{
+			const auto path = GetFilePath();
+			const auto secret = GetSecret("secret");
+			const auto pools = GetPools();
+
+			// No file
+			std::filesystem::remove(path);
+			{
+				KeyPoolFile file(path, secret);
+				const auto loaded = file.Load();
+				Assert::AreEqual(true, loaded.has_value());
+				Assert::AreEqual(true, loaded->empty());
+			}
+
+			{
+				KeyPoolFile file(path, secret);
+				Assert::AreEqual(true, file.Save(pools));
+			}
+
+			{
+				KeyPoolFile file(path, secret);
+				const auto loaded = file.Load();
+				Assert::AreEqual(true, loaded.has_value());
+				Assert::AreEqual(true, loaded->size() == pools.size());
+
+				for (Size x = 0; x < pools.size(); ++x)
+				{
+					const auto& pool = pools[x];
+					const auto& lpool = (*loaded)[x];
+
+					Assert::AreEqual(true, lpool.Algorithm == pool.Algorithm);
+					Assert::AreEqual(true, lpool.NeededRate == pool.NeededRate);
+					Assert::AreEqual(true, lpool.GenerationTime == pool.GenerationTime);
+					Assert::AreEqual(true, lpool.Keys.size() == pool.Keys.size());
+
+					for (Size y = 0; y < pool.Keys.size(); ++y)
+					{
+						Assert::AreEqual(true, IsSameKey(lpool.Keys[y], pool.Keys[y]));
+					}
+				}
+			}
+
+			// The keys were erased from the file after loading
+			// them, so that they can't be used more than once
+			{
+				Assert::AreEqual(true, std::filesystem::file_size(path) == 0);
+
+				KeyPoolFile file(path, secret);
+				const auto loaded = file.Load();
+				Assert::AreEqual(true, loaded.has_value());
+				Assert::AreEqual(true, loaded->empty());
+			}
+
+			std::filesystem::remove(path);
+		}
+
+		TEST_METHOD(WrongSecret)
+		{
+			const auto path = GetFilePath();
+			const auto pools = GetPools();
+
+			{
+				KeyPoolFile file(path, GetSecret("secret"));
+				Assert::AreEqual(true, file.Save(pools));
+			}
+
+			{
+				KeyPoolFile file(path, GetSecret("another secret"));
+				const auto loaded = file.Load();
+				Assert::AreEqual(true, !loaded.has_value() || GetNumKeys(*loaded) == 0);
+			}
+
+			// The keys are gone, even with the right secret
+			{
+				KeyPoolFile file(path, GetSecret("secret"));
+				const auto loaded = file.Load();
+				Assert::AreEqual(true, loaded.has_value());
+				Assert::AreEqual(true, GetNumKeys(*loaded) == 0);
+			}
+
+			std::filesystem::remove(path);
+		}
+
+		TEST_METHOD(TamperedRecord)
+		{
+			const auto path = GetFilePath();
+			const auto secret = GetSecret("secret");
+			const auto pools = GetPools();
+
+			{
+				KeyPoolFile file(path, secret);
+				Assert::AreEqual(true, file.Save(pools));
+			}
+
+			// Flip a bit in the encrypted data of the second key record; the file
+			// header is 48 bytes and each record header has the type (2 bytes), the
+			// algorithm and the size (4 bytes) of the encrypted data that follows it
+			{
+				std::fstream fs(path, std::ios::in | std::ios::out | std::ios::binary);
+				Assert::AreEqual(true, fs.is_open());
+
+				constexpr Size rheader_size = 2 + sizeof(Algorithm::Asymmetric) + 4;
+				Size offset{ 48 };
+
+				// Records: details, key 1, key 2
+				for (auto x = 0; x < 3; ++x)
+				{
+					UInt32 size{ 0 };
+					fs.seekg(offset + rheader_size - sizeof(size));
+					fs.read(reinterpret_cast<char*>(&size), sizeof(size));
+					Assert::AreEqual(true, fs.good());
+
+					if (x == 2)
+					{
+						char byte{ 0 };
+						fs.seekg(offset + rheader_size + size / 2);
+						fs.read(&byte, 1);
+						byte ^= 0x01;
+						fs.seekp(offset + rheader_size + size / 2);
+						fs.write(&byte, 1);
+						Assert::AreEqual(true, fs.good());
+					}
+
+					offset += rheader_size + size;
+				}
+			}
+
+			{
+				KeyPoolFile file(path, secret);
+				const auto loaded = file.Load();
+				Assert::AreEqual(true, loaded.has_value());
+				Assert::AreEqual(true, loaded->size() == pools.size());
+
+				// Only the tampered key is missing
+				const auto& lpool = loaded->front();
+				Assert::AreEqual(true, lpool.Algorithm == pools.front().Algorithm);
+				Assert::AreEqual(true, lpool.NeededRate == pools.front().NeededRate);
+				Assert::AreEqual(true, lpool.Keys.size() == 2);
+				Assert::AreEqual(true, IsSameKey(lpool.Keys[0], pools.front().Keys[0]));
+				Assert::AreEqual(true, IsSameKey(lpool.Keys[1], pools.front().Keys[2]));
+
+				Assert::AreEqual(true, (*loaded)[1].Keys.size() == pools[1].Keys.size());
+				Assert::AreEqual(true, GetNumKeys(*loaded) == GetNumKeys(pools) - 1);
+			}
+
+			std::filesystem::remove(path);
+		}
+	};
+}
@@ -0,0 +1,219 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#include "pch.h"
+#include "Concurrency\MPSCQueue.h"
+#include "Concurrency\MPMCQueue.h"
+
+#include <thread>
+
+using namespace std::literals;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace QuantumGate::Implementation::Concurrency;
+using namespace QuantumGate::Implementation;
+
+namespace UnitTests
+{
+	TEST_CLASS(LockFreeQueueTests)
+	{
+	public:
+		TEST_METHOD(MPSCBasic)
+		{
+			MPSCQueue<int> queue;
+			Assert::AreEqual(true, queue.IsEmpty());
+
+			queue.Push(1);
+			queue.Push(2);
+			auto called = false;
+			queue.Push(3, [&]() noexcept { called = true; });
+			Assert::AreEqual(true, called);
+			Assert::AreEqual(true, queue.GetSize() == 3);
+
+			// Element stays when the function declines it
+			auto value = 0;
+			queue.PopFrontIf([&](auto& v) noexcept { value = v; return false; });
+			Assert::AreEqual(1, value);
+			Assert::AreEqual(true, queue.GetSize() == 3);
+
+			for (auto x = 1; x <= 3; ++x)
+			{
+				queue.PopFrontIf([&](auto& v) noexcept { value = v; return true; });
+				Assert::AreEqual(x, value);
+			}
+
+			Assert::AreEqual(true, queue.IsEmpty());
+
+			value = 0;
+			queue.PopFrontIf([&](auto& v) noexcept { value = v; return true; });
+			Assert::AreEqual(0, value);
+
+			queue.Push(4);
+			queue.Push(5);
+			queue.Clear();
+			Assert::AreEqual(true, queue.IsEmpty());
+
+			// Non-trivial elements get destroyed with the queue
+			auto sp = std::make_shared<int>(1);
+			{
+				MPSCQueue<std::shared_ptr<int>> spqueue;
+				spqueue.Push(sp);
+				spqueue.Push(sp);
+				Assert::AreEqual(true, sp.use_count() == 3);
+			}
+			Assert::AreEqual(true, sp.use_count() == 1);
+		}
+
+		TEST_METHOD(MPMCBasic)
+		{
+			MPMCQueue<int, 4> queue;
+			Assert::AreEqual(true, queue.IsEmpty());
+
+			// Pushing past the capacity spills over without losing order
+			for (auto x = 1; x <= 10; ++x)
+			{
+				queue.Push(x);
+			}
+
+			Assert::AreEqual(true, queue.GetSize() == 10);
+
+			auto value = 0;
+			for (auto x = 1; x <= 10; ++x)
+			{
+				Assert::AreEqual(true, queue.PopFront([&](auto& v) noexcept { value = v; }));
+				Assert::AreEqual(x, value);
+			}
+
+			Assert::AreEqual(true, queue.IsEmpty());
+			Assert::AreEqual(false, queue.PopFront([&](auto& v) noexcept { value = v; }));
+
+			// Wraps around the ring
+			for (auto x = 0; x < 100; ++x)
+			{
+				queue.Push(x);
+				queue.Push(x + 1);
+				Assert::AreEqual(true, queue.PopFront([&](auto& v) noexcept { value = v; }));
+				Assert::AreEqual(x, value);
+				Assert::AreEqual(true, queue.PopFront([&](auto& v) noexcept { value = v; }));
+				Assert::AreEqual(x + 1, value);
+			}
+
+			queue.Push(1);
+			queue.Push(2);
+			queue.Clear();
+			Assert::AreEqual(true, queue.IsEmpty());
+		}
+
+		TEST_METHOD(Wait)
+		{
+			Event shutdown_event;
+
+			MPSCQueue<int> mpsc;
+			MPMCQueue<int> mpmc;
+
+			// Times out when empty
+			Assert::AreEqual(false, mpsc.Wait(10ms, shutdown_event));
+			Assert::AreEqual(false, mpmc.Wait(10ms, shutdown_event));
+
+			mpsc.Push(1);
+			mpmc.Push(1);
+			Assert::AreEqual(true, mpsc.Wait(10ms, shutdown_event));
+			Assert::AreEqual(true, mpmc.Wait(10ms, shutdown_event));
+			mpsc.Clear();
+			mpmc.Clear();
+
+			// Wakes up for a push from another thread
+			auto thread = std::thread([&]()
+			{
+				std::this_thread::sleep_for(50ms);
+				mpsc.Push(2);
+			});
+
+			Assert::AreEqual(true, mpsc.Wait(10s, shutdown_event));
+			thread.join();
+
+			// Wakes up when interrupted
+			thread = std::thread([&]()
+			{
+				std::this_thread::sleep_for(50ms);
+				shutdown_event.Set();
+				mpmc.InterruptWait();
+			});
+
+			Assert::AreEqual(true, mpmc.Wait(shutdown_event));
+			Assert::AreEqual(true, mpmc.IsEmpty());
+			thread.join();
+		}
+
+		TEST_METHOD(MultipleProducers)
+		{
+			constexpr auto num_producers = 8;
+			constexpr auto num_items = 20000;
+
+			MPSCQueue<std::pair<int, int>> mpsc;
+			MPMCQueue<std::pair<int, int>, 64> mpmc;
+
+			std::vector<std::thread> producers;
+			for (auto x = 0; x < num_producers; ++x)
+			{
+				producers.emplace_back([&, x]()
+				{
+					for (auto y = 0; y < num_items; ++y)
+					{
+						mpsc.Push({ x, y });
+						mpmc.Push({ x, y });
+					}
+				});
+			}
+
+			// Single consumer; elements from each producer arrive in order
+			std::vector<int> next(num_producers, 0);
+			auto num = 0;
+			auto success = true;
+
+			while (num < num_producers * num_items)
+			{
+				mpsc.PopFrontIf([&](auto& item) noexcept
+				{
+					if (next[item.first] != item.second) success = false;
+					next[item.first] = item.second + 1;
+					++num;
+					return true;
+				});
+			}
+
+			Assert::AreEqual(true, success);
+			Assert::AreEqual(true, mpsc.IsEmpty());
+
+			// Multiple consumers; every element arrives exactly once
+			std::atomic<int> mpmc_num{ 0 };
+			std::vector<std::atomic<int>> counts(num_producers);
+
+			std::vector<std::thread> consumers;
+			for (auto x = 0; x < 4; ++x)
+			{
+				consumers.emplace_back([&]()
+				{
+					while (mpmc_num.load() < num_producers * num_items)
+					{
+						mpmc.PopFront([&](auto& item) noexcept
+						{
+							counts[item.first].fetch_add(1);
+							mpmc_num.fetch_add(1);
+						});
+					}
+				});
+			}
+
+			for (auto& thread : producers) thread.join();
+			for (auto& thread : consumers) thread.join();
+
+			Assert::AreEqual(num_producers * num_items, mpmc_num.load());
+			for (auto& count : counts)
+			{
+				Assert::AreEqual(num_items, count.load());
+			}
+
+			Assert::AreEqual(true, mpmc.IsEmpty());
+		}
+	};
+}
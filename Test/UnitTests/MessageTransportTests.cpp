@@ -0,0 +1,261 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#include "pch.h"
+#include "Settings.h"
+#include "Core\MessageTransport.h"
+#include "Core\Peer\PeerKeys.h"
+
+#include <chrono>
+
+using namespace std::literals;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+	TEST_CLASS(MessageTransportTests)
+	{
+	public:
+		// Gives both sides a new key-pair derived from the same secret
+		void AddKeyPair(Core::Peer::SymmetricKeys& sender, Core::Peer::SymmetricKeys& receiver)
+		{
+			const auto rnd = Util::GetPseudoRandomBytes(64);
+			const ProtectedBuffer secret(rnd.GetBytes(), rnd.GetSize());
+
+			Assert::AreEqual(true, sender.GenerateAndAddSymmetricKeyPair(secret, ProtectedBuffer(),
+																		  Core::Peer::DefaultAlgorithms,
+																		  PeerConnectionType::Outbound));
+			Assert::AreEqual(true, receiver.GenerateAndAddSymmetricKeyPair(secret, ProtectedBuffer(),
+																			Core::Peer::DefaultAlgorithms,
+																			PeerConnectionType::Inbound));
+		}
+
+		Buffer WriteMessage(const Core::Peer::SymmetricKeys& keys, const Settings& settings, const BufferView data)
+		{
+			auto msg = Core::MessageTransport(Core::MessageTransport::DataSizeSettings{}, settings);
+			msg.SetMessageData(Buffer(data));
+
+			const auto& [symkey, nonce] = keys.GetEncryptionKeyAndNonce(msg.GetMessageNonceSeed(),
+																		PeerConnectionType::Outbound, false);
+			Assert::AreEqual(true, symkey != nullptr);
+
+			Buffer buffer;
+			Assert::AreEqual(true, msg.IsValid() && msg.Write(buffer, *symkey, nonce));
+
+			return buffer;
+		}
+
+		// Reads the message the same way Peer::ProcessMessageTransport() does,
+		// trying the keys whose key hint matches the one in the message
+		std::optional<Buffer> ReadMessage(const Core::Peer::SymmetricKeys& keys, const Settings& settings,
+										  BufferSpan msgbuf, const bool autogenkey_allowed, Size& num_tries)
+		{
+			const auto nonce_seed = Core::MessageTransport::GetNonceSeedFromBuffer(msgbuf);
+			const auto key_hint = Core::MessageTransport::GetKeyHintFromBuffer(msgbuf);
+			Assert::AreEqual(true, nonce_seed.has_value() && key_hint.has_value());
+
+			std::optional<Buffer> data;
+
+			[[maybe_unused]] const auto stopped = keys.ForEachDecryptionKey(*nonce_seed, *key_hint,
+																			PeerConnectionType::Inbound, autogenkey_allowed,
+																			[&](Crypto::SymmetricKeyData& symkey, const Buffer& nonce)
+			{
+				++num_tries;
+
+				auto msg = Core::MessageTransport(Core::MessageTransport::DataSizeSettings{}, settings);
+				const auto [success, retry] = msg.Read(msgbuf, symkey, nonce);
+				if (success && msg.IsValid())
+				{
+					data.emplace(msg.GetMessageData());
+					return false;
+				}
+
+				return retry;
+			});
+
+			return data;
+		}
+
+		TEST_METHOD(WriteRead)
+		{
+			Settings settings;
+			Core::Peer::SymmetricKeys sender, receiver;
+			AddKeyPair(sender, receiver);
+
+			for (const Size size : { 1, 64, 1'024, 65'536 })
+			{
+				const auto data = Util::GetPseudoRandomBytes(size);
+				auto buffer = WriteMessage(sender, settings, data);
+
+				// Message data is encrypted
+				Assert::AreEqual(true, buffer.GetSize() > data.GetSize());
+				Assert::AreEqual(true, BufferView(buffer).GetLast(data.GetSize()) != data);
+
+				const auto nonce_seed = Core::MessageTransport::GetNonceSeedFromBuffer(buffer);
+				Assert::AreEqual(true, nonce_seed.has_value());
+
+				const auto& [symkey, nonce] = receiver.GetDecryptionKeyAndNonce(0, *nonce_seed,
+																				PeerConnectionType::Inbound, false);
+				Assert::AreEqual(true, symkey != nullptr);
+
+				// Tampered message doesn't pass the HMAC check and
+				// the buffer is left as is so that reading can be retried
+				buffer[buffer.GetSize() - 1] ^= Byte{ 0x01 };
+				const auto tampered = buffer;
+
+				auto msg = Core::MessageTransport(Core::MessageTransport::DataSizeSettings{}, settings);
+				const auto [success, retry] = msg.Read(buffer, *symkey, nonce);
+				Assert::AreEqual(false, success);
+				Assert::AreEqual(true, retry);
+				Assert::AreEqual(true, buffer == tampered);
+
+				buffer[buffer.GetSize() - 1] ^= Byte{ 0x01 };
+
+				// Message data refers to the decrypted data inside the buffer
+				auto msg2 = Core::MessageTransport(Core::MessageTransport::DataSizeSettings{}, settings);
+				const auto [success2, retry2] = msg2.Read(buffer, *symkey, nonce);
+				Assert::AreEqual(true, success2);
+				Assert::AreEqual(true, msg2.IsValid());
+				Assert::AreEqual(true, msg2.GetMessageData() == data);
+				Assert::AreEqual(true, msg2.GetMessageData().GetBytes() >= buffer.GetBytes() &&
+									   msg2.GetMessageData().GetBytes() < buffer.GetBytes() + buffer.GetSize());
+			}
+		}
+
+		TEST_METHOD(WriteReadBenchmark)
+		{
+			Settings settings;
+			Core::Peer::SymmetricKeys sender, receiver;
+			AddKeyPair(sender, receiver);
+
+			for (const Size size : { 64, 1'024, 16'384, 65'536 })
+			{
+				const auto data = Util::GetPseudoRandomBytes(size);
+				const auto num = std::max(Size{ 10 }, Size{ 64'000'000 } / size);
+
+				Vector<Buffer> buffers;
+				buffers.reserve(num);
+
+				const auto wbegin = std::chrono::high_resolution_clock::now();
+
+				for (Size x = 0; x < num; ++x)
+				{
+					buffers.emplace_back(WriteMessage(sender, settings, data));
+				}
+
+				const auto wend = std::chrono::high_resolution_clock::now();
+
+				// Every message is read from its own buffer since
+				// reading decrypts the message in place
+				for (auto& buffer : buffers)
+				{
+					const auto nonce_seed = Core::MessageTransport::GetNonceSeedFromBuffer(buffer);
+					const auto& [symkey, nonce] = receiver.GetDecryptionKeyAndNonce(0, *nonce_seed,
+																					PeerConnectionType::Inbound, false);
+					auto msg = Core::MessageTransport(Core::MessageTransport::DataSizeSettings{}, settings);
+					const auto [success, retry] = msg.Read(buffer, *symkey, nonce);
+					Assert::AreEqual(true, success && msg.GetMessageData().GetSize() == size);
+				}
+
+				const auto rend = std::chrono::high_resolution_clock::now();
+
+				const auto mbps = [&](const auto duration)
+				{
+					const auto secs = std::chrono::duration<double>(duration).count();
+					return (static_cast<double>(size * num) / (1024.0 * 1024.0)) / secs;
+				};
+
+				Logger::WriteMessage(Util::FormatString(L"MessageTransport %zu byte messages: write %.1f MB/s, read %.1f MB/s",
+														size, mbps(wend - wbegin), mbps(rend - wend)).c_str());
+			}
+		}
+
+		TEST_METHOD(KeyHint)
+		{
+			Settings settings;
+			Core::Peer::SymmetricKeys receiver;
+			std::array<Core::Peer::SymmetricKeys, 4> senders;
+
+			for (auto& sender : senders) AddKeyPair(sender, receiver);
+
+			const auto data = Util::GetPseudoRandomBytes(256);
+
+			// Only the key the message was encrypted with gets tried,
+			// including for the oldest key which is the last one we have
+			for (const auto& sender : senders)
+			{
+				auto buffer = WriteMessage(sender, settings, data);
+
+				Size num_tries{ 0 };
+				const auto result = ReadMessage(receiver, settings, buffer, true, num_tries);
+				Assert::AreEqual(true, result.has_value() && *result == data);
+				Assert::AreEqual(true, num_tries == 1);
+			}
+
+			// Message encrypted with a key we don't have
+			Core::Peer::SymmetricKeys sender2, receiver2;
+			AddKeyPair(sender2, receiver2);
+
+			auto buffer = WriteMessage(sender2, settings, data);
+			const auto original = buffer;
+
+			// No matching key to try
+			Size num_tries{ 0 };
+			Assert::AreEqual(false, ReadMessage(receiver, settings, buffer, false, num_tries).has_value());
+			Assert::AreEqual(true, num_tries == 0);
+
+			// Only the autogen key gets tried and its
+			// key hint doesn't match either
+			Assert::AreEqual(false, ReadMessage(receiver, settings, buffer, true, num_tries).has_value());
+			Assert::AreEqual(true, num_tries == 1);
+			Assert::AreEqual(true, buffer == original);
+		}
+
+		TEST_METHOD(KeyHintBenchmark)
+		{
+			Settings settings;
+			const auto data = Util::GetPseudoRandomBytes(256);
+			constexpr Size num{ 20'000 };
+
+			for (Size numkeys = 1; numkeys <= 4; ++numkeys)
+			{
+				Core::Peer::SymmetricKeys sender, receiver;
+				AddKeyPair(sender, receiver);
+
+				// Newer keys get tried first so the message is encrypted
+				// with the oldest key; this is the worst case during a key update
+				for (Size x = 1; x < numkeys; ++x)
+				{
+					Core::Peer::SymmetricKeys sender2;
+					AddKeyPair(sender2, receiver);
+				}
+
+				Vector<Buffer> buffers;
+				buffers.reserve(num);
+
+				for (Size x = 0; x < num; ++x)
+				{
+					buffers.emplace_back(WriteMessage(sender, settings, data));
+				}
+
+				Size num_tries{ 0 };
+
+				const auto begin = std::chrono::high_resolution_clock::now();
+
+				for (auto& buffer : buffers)
+				{
+					Assert::AreEqual(true, ReadMessage(receiver, settings, buffer, true, num_tries).has_value());
+				}
+
+				const auto end = std::chrono::high_resolution_clock::now();
+
+				Assert::AreEqual(true, num_tries == num);
+
+				const auto us = std::chrono::duration<double, std::micro>(end - begin).count() / static_cast<double>(num);
+
+				Logger::WriteMessage(Util::FormatString(L"MessageTransport key selection with %zu keys: %.2f us per message",
+														numkeys, us).c_str());
+			}
+		}
+	};
+}
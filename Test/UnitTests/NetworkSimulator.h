@@ -0,0 +1,258 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#pragma once
+
+#include "Common\Containers.h"
+
+#include <random>
+
+namespace UnitTests
+{
+	// In-process datagram network that runs on virtual time. Links between endpoints can have
+	// latency, jitter, loss, reordering, limited bandwidth with a bottleneck queue and an MTU
+	// (with or without black hole). All randomness comes from the seed, so that the same
+	// scenario with the same seed always has the same outcome.
+	template<typename T>
+	class NetworkSimulator final
+	{
+	public:
+		using EndpointID = Size;
+
+		struct LinkParameters final
+		{
+			std::chrono::microseconds Latency{ 10'000 };				// One way propagation delay
+			std::chrono::microseconds Jitter{ 0 };						// Random extra delay of up to this much for each datagram
+			double LossRate{ 0.0 };										// Fraction of datagrams that get lost at random
+			double ReorderRate{ 0.0 };									// Fraction of datagrams that get held back and arrive out of order
+			std::chrono::microseconds ReorderDelay{ 0 };				// How long datagrams that arrive out of order get held back
+			Size MTU{ std::numeric_limits<Size>::max() };				// Maximum datagram size
+			bool MTUBlackHole{ false };									// Whether larger datagrams get dropped silently instead of failing to send
+			UInt64 Bandwidth{ 0 };										// Bytes per second at the bottleneck (0 for unlimited)
+			Size QueueSize{ 65'536 };									// Bytes that can wait at the bottleneck before datagrams get dropped
+		};
+
+		struct Statistics final
+		{
+			Size NumSent{ 0 };
+			Size NumDelivered{ 0 };
+			Size NumBytesDelivered{ 0 };
+			Size NumLost{ 0 };
+			Size NumQueueDropped{ 0 };
+			Size NumMTUDropped{ 0 };
+			Size NumReordered{ 0 };
+		};
+
+		struct Datagram final
+		{
+			EndpointID From{ 0 };
+			EndpointID To{ 0 };
+			Size NumBytes{ 0 };
+			SteadyTime TimeSent;
+			SteadyTime TimeDelivered;
+			T Payload;
+		};
+
+		enum class SendResult { Sent, MessageTooLarge };
+
+	private:
+		struct Link final
+		{
+			LinkParameters Parameters;
+			Statistics Stats;
+			SteadyTime BottleneckFreeSteadyTime;
+		};
+
+		struct Event final
+		{
+			UInt64 Order{ 0 };
+			Datagram Item;
+
+			// Ordered by delivery time for the heap; datagrams delivered at the
+			// same time stay in the order in which they were sent
+			[[nodiscard]] bool operator>(const Event& other) const noexcept
+			{
+				if (Item.TimeDelivered != other.Item.TimeDelivered)
+				{
+					return (Item.TimeDelivered > other.Item.TimeDelivered);
+				}
+
+				return (Order > other.Order);
+			}
+		};
+
+	public:
+		NetworkSimulator(const UInt64 seed) noexcept : m_Random(seed) {}
+		NetworkSimulator(const NetworkSimulator&) = delete;
+		NetworkSimulator(NetworkSimulator&&) noexcept = default;
+		~NetworkSimulator() = default;
+		NetworkSimulator& operator=(const NetworkSimulator&) = delete;
+		NetworkSimulator& operator=(NetworkSimulator&&) noexcept = default;
+
+		[[nodiscard]] inline SteadyTime GetNow() const noexcept { return m_Now; }
+
+		[[nodiscard]] EndpointID AddEndpoint()
+		{
+			m_Inboxes.emplace_back();
+			return (m_Inboxes.size() - 1);
+		}
+
+		// Sets the parameters for the link from one endpoint to another; links
+		// are one way, so both directions need to be set for a symmetric path
+		void SetLink(const EndpointID from, const EndpointID to, const LinkParameters& params)
+		{
+			GetLink(from, to).Parameters = params;
+		}
+
+		void SetLinks(const EndpointID endpoint1, const EndpointID endpoint2, const LinkParameters& params)
+		{
+			SetLink(endpoint1, endpoint2, params);
+			SetLink(endpoint2, endpoint1, params);
+		}
+
+		[[nodiscard]] const Statistics& GetStatistics(const EndpointID from, const EndpointID to)
+		{
+			return GetLink(from, to).Stats;
+		}
+
+		SendResult Send(const EndpointID from, const EndpointID to, const Size num_bytes, T&& payload)
+		{
+			assert(from < m_Inboxes.size() && to < m_Inboxes.size());
+
+			auto& link = GetLink(from, to);
+			const auto& params = link.Parameters;
+
+			if (num_bytes > params.MTU)
+			{
+				if (!params.MTUBlackHole) return SendResult::MessageTooLarge;
+
+				++link.Stats.NumSent;
+				++link.Stats.NumMTUDropped;
+				return SendResult::Sent;
+			}
+
+			++link.Stats.NumSent;
+
+			// Time at which the datagram has made it through the bottleneck
+			auto time_out = m_Now;
+			if (params.Bandwidth > 0)
+			{
+				const auto start_time = std::max(m_Now, link.BottleneckFreeSteadyTime);
+
+				// Bytes still waiting at the bottleneck
+				const auto backlog = static_cast<Size>(std::chrono::duration<double>(start_time - m_Now).count() *
+													   static_cast<double>(params.Bandwidth));
+				if (backlog + num_bytes > params.QueueSize)
+				{
+					++link.Stats.NumQueueDropped;
+					return SendResult::Sent;
+				}
+
+				time_out = start_time + std::chrono::duration_cast<SteadyTime::duration>(
+					std::chrono::duration<double>(static_cast<double>(num_bytes) / static_cast<double>(params.Bandwidth)));
+
+				link.BottleneckFreeSteadyTime = time_out;
+			}
+
+			if (params.LossRate > 0.0 && GetRandom() < params.LossRate)
+			{
+				++link.Stats.NumLost;
+				return SendResult::Sent;
+			}
+
+			auto delay = SteadyTime::duration(params.Latency);
+
+			if (params.Jitter.count() > 0)
+			{
+				delay += std::chrono::duration_cast<SteadyTime::duration>(params.Jitter * GetRandom());
+			}
+
+			if (params.ReorderRate > 0.0 && GetRandom() < params.ReorderRate)
+			{
+				++link.Stats.NumReordered;
+				delay += params.ReorderDelay;
+			}
+
+			m_Events.emplace_back(
+				Event{
+					.Order = m_NextEventOrder++,
+					.Item = Datagram{
+						.From = from,
+						.To = to,
+						.NumBytes = num_bytes,
+						.TimeSent = m_Now,
+						.TimeDelivered = time_out + delay,
+						.Payload = std::move(payload)
+					}
+				});
+
+			std::push_heap(m_Events.begin(), m_Events.end(), std::greater<>{});
+
+			return SendResult::Sent;
+		}
+
+		// When the next datagram arrives, if there's any on the way
+		[[nodiscard]] std::optional<SteadyTime> GetNextDeliveryTime() const noexcept
+		{
+			if (m_Events.empty()) return std::nullopt;
+
+			return m_Events.front().Item.TimeDelivered;
+		}
+
+		// Moves virtual time forward, delivering all datagrams that
+		// arrive up to and including the given time to their endpoints
+		void AdvanceTo(const SteadyTime time)
+		{
+			assert(time >= m_Now);
+
+			while (!m_Events.empty() && m_Events.front().Item.TimeDelivered <= time)
+			{
+				std::pop_heap(m_Events.begin(), m_Events.end(), std::greater<>{});
+
+				auto& datagram = m_Events.back().Item;
+
+				auto& stats = GetLink(datagram.From, datagram.To).Stats;
+				++stats.NumDelivered;
+				stats.NumBytesDelivered += datagram.NumBytes;
+
+				m_Inboxes[datagram.To].emplace_back(std::move(datagram));
+				m_Events.pop_back();
+			}
+
+			m_Now = time;
+		}
+
+		// Removes and returns the next datagram that arrived at the endpoint
+		[[nodiscard]] std::optional<Datagram> Receive(const EndpointID endpoint)
+		{
+			auto& inbox = m_Inboxes[endpoint];
+			if (inbox.empty()) return std::nullopt;
+
+			auto datagram = std::move(inbox.front());
+			inbox.pop_front();
+
+			return datagram;
+		}
+
+	private:
+		[[nodiscard]] Link& GetLink(const EndpointID from, const EndpointID to)
+		{
+			return m_Links[std::make_pair(from, to)];
+		}
+
+		[[nodiscard]] double GetRandom() noexcept
+		{
+			// Not using std::uniform_real_distribution since its output
+			// differs between implementations of the standard library
+			return (static_cast<double>(m_Random() >> 11) * 0x1.0p-53);
+		}
+
+	private:
+		std::mt19937_64 m_Random;
+		SteadyTime m_Now;
+		UInt64 m_NextEventOrder{ 0 };
+		Vector<Event> m_Events;
+		Vector<Containers::Deque<Datagram>> m_Inboxes;
+		Containers::Map<std::pair<EndpointID, EndpointID>, Link> m_Links;
+	};
+}
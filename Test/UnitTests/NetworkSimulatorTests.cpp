@@ -0,0 +1,188 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#include "pch.h"
+
+// Undefine conflicting macro
+#ifdef max
+#undef max
+#endif
+
+#ifdef min
+#undef min
+#endif
+
+#include "NetworkSimulator.h"
+
+using namespace std::literals;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace QuantumGate::Implementation;
+
+namespace UnitTests
+{
+	TEST_CLASS(NetworkSimulatorTests)
+	{
+		using Network = NetworkSimulator<Size>;
+
+	public:
+		TEST_METHOD(LatencyAndJitter)
+		{
+			Network network(1);
+			const auto ep1 = network.AddEndpoint();
+			const auto ep2 = network.AddEndpoint();
+			network.SetLink(ep1, ep2, { .Latency = 20ms, .Jitter = 10ms });
+
+			for (Size x = 0; x < 1000; ++x)
+			{
+				Assert::AreEqual(true, network.Send(ep1, ep2, 100, Size{ x }) == Network::SendResult::Sent);
+			}
+
+			network.AdvanceTo(network.GetNow() + 19ms);
+			Assert::AreEqual(false, network.Receive(ep2).has_value());
+
+			network.AdvanceTo(network.GetNow() + 11ms);
+
+			Size num{ 0 };
+			auto reordered{ false };
+			auto prev_time = network.GetNow() - 30ms;
+			while (const auto datagram = network.Receive(ep2))
+			{
+				Assert::AreEqual(true, datagram->TimeDelivered - datagram->TimeSent >= 20ms);
+				Assert::AreEqual(true, datagram->TimeDelivered - datagram->TimeSent <= 30ms);
+				Assert::AreEqual(true, datagram->TimeDelivered >= prev_time);
+
+				if (datagram->Payload != num) reordered = true;
+
+				prev_time = datagram->TimeDelivered;
+				++num;
+			}
+
+			Assert::AreEqual(true, num == 1000);
+			Assert::AreEqual(true, network.GetStatistics(ep1, ep2).NumDelivered == 1000);
+
+			// Jitter makes datagrams arrive out of order
+			Assert::AreEqual(true, reordered);
+
+			// Links are one way; the other direction has the default latency
+			Assert::AreEqual(true, network.Send(ep2, ep1, 100, 0) == Network::SendResult::Sent);
+			Assert::AreEqual(true, *network.GetNextDeliveryTime() == network.GetNow() + 10ms);
+		}
+
+		TEST_METHOD(LossAndReordering)
+		{
+			Network network(2);
+			const auto ep1 = network.AddEndpoint();
+			const auto ep2 = network.AddEndpoint();
+			network.SetLinks(ep1, ep2, { .LossRate = 0.1, .ReorderRate = 0.05, .ReorderDelay = 5ms });
+
+			for (Size x = 0; x < 10'000; ++x)
+			{
+				Assert::AreEqual(true, network.Send(ep1, ep2, 100, Size{ x }) == Network::SendResult::Sent);
+			}
+
+			network.AdvanceTo(network.GetNow() + 1s);
+
+			const auto& stats = network.GetStatistics(ep1, ep2);
+			Assert::AreEqual(true, stats.NumSent == 10'000);
+			Assert::AreEqual(true, stats.NumDelivered + stats.NumLost == stats.NumSent);
+			Assert::AreEqual(true, stats.NumLost > 900 && stats.NumLost < 1100);
+			Assert::AreEqual(true, stats.NumReordered > 400 && stats.NumReordered < 500);
+
+			Size num{ 0 };
+			Size num_out_of_order{ 0 };
+			Size last{ 0 };
+			while (const auto datagram = network.Receive(ep2))
+			{
+				if (num > 0 && datagram->Payload < last) ++num_out_of_order;
+				else last = datagram->Payload;
+
+				++num;
+			}
+
+			Assert::AreEqual(true, num == stats.NumDelivered);
+			Assert::AreEqual(true, num_out_of_order == stats.NumReordered);
+		}
+
+		TEST_METHOD(Bandwidth)
+		{
+			Network network(3);
+			const auto ep1 = network.AddEndpoint();
+			const auto ep2 = network.AddEndpoint();
+
+			// 1MB per second with room for 50 datagrams of 1000 bytes in the queue
+			network.SetLink(ep1, ep2, { .Latency = 10ms, .Bandwidth = 1'000'000, .QueueSize = 50'000 });
+
+			for (Size x = 0; x < 100; ++x)
+			{
+				Assert::AreEqual(true, network.Send(ep1, ep2, 1000, Size{ x }) == Network::SendResult::Sent);
+			}
+
+			const auto& stats = network.GetStatistics(ep1, ep2);
+			Assert::AreEqual(true, stats.NumQueueDropped == 50);
+
+			// Datagrams leave the bottleneck 1ms apart
+			network.AdvanceTo(network.GetNow() + 1s);
+
+			Size num{ 0 };
+			while (const auto datagram = network.Receive(ep2))
+			{
+				Assert::AreEqual(true, datagram->Payload == num);
+				Assert::AreEqual(true, datagram->TimeDelivered - datagram->TimeSent == 10ms + 1ms * (num + 1));
+				++num;
+			}
+
+			Assert::AreEqual(true, num == 50);
+			Assert::AreEqual(true, stats.NumBytesDelivered == 50'000);
+
+			// Queue has drained
+			Assert::AreEqual(true, network.Send(ep1, ep2, 1000, 0) == Network::SendResult::Sent);
+			Assert::AreEqual(true, *network.GetNextDeliveryTime() == network.GetNow() + 11ms);
+		}
+
+		TEST_METHOD(MTU)
+		{
+			Network network(4);
+			const auto ep1 = network.AddEndpoint();
+			const auto ep2 = network.AddEndpoint();
+			network.SetLink(ep1, ep2, { .MTU = 1472 });
+			network.SetLink(ep2, ep1, { .MTU = 1472, .MTUBlackHole = true });
+
+			Assert::AreEqual(true, network.Send(ep1, ep2, 1472, 0) == Network::SendResult::Sent);
+			Assert::AreEqual(true, network.Send(ep1, ep2, 1473, 0) == Network::SendResult::MessageTooLarge);
+
+			// Black hole drops the datagram without an error
+			Assert::AreEqual(true, network.Send(ep2, ep1, 1473, 0) == Network::SendResult::Sent);
+			Assert::AreEqual(true, network.GetStatistics(ep2, ep1).NumMTUDropped == 1);
+
+			network.AdvanceTo(network.GetNow() + 1s);
+			Assert::AreEqual(true, network.Receive(ep2).has_value());
+			Assert::AreEqual(false, network.Receive(ep1).has_value());
+		}
+
+		TEST_METHOD(Deterministic)
+		{
+			const auto run = [](const UInt64 seed)
+			{
+				Network network(seed);
+				const auto ep1 = network.AddEndpoint();
+				const auto ep2 = network.AddEndpoint();
+				network.SetLink(ep1, ep2, { .Jitter = 5ms, .LossRate = 0.2, .ReorderRate = 0.1, .ReorderDelay = 2ms });
+
+				for (Size x = 0; x < 1000; ++x) network.Send(ep1, ep2, 100, Size{ x });
+
+				network.AdvanceTo(network.GetNow() + 1s);
+
+				Vector<std::pair<Size, SteadyTime>> received;
+				while (const auto datagram = network.Receive(ep2))
+				{
+					received.emplace_back(datagram->Payload, datagram->TimeDelivered);
+				}
+
+				return received;
+			};
+
+			Assert::AreEqual(true, run(5) == run(5));
+			Assert::AreEqual(false, run(5) == run(6));
+		}
+	};
+}
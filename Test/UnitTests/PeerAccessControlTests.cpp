@@ -19,10 +19,10 @@ namespace UnitTests
 		TEST_METHOD(General)
 		{
 			Settings_CThS settings;
-			settings.UpdateValue([](Settings& set)
+			Assert::AreEqual(true, settings.UpdateValue([](Settings& set)
 			{
 				set.Local.RequireAuthentication = true;
-			});
+			}));
 
 			PeerAccessControl pac(settings);
 
@@ -177,10 +177,10 @@ namespace UnitTests
 		TEST_METHOD(Access)
 		{
 			Settings_CThS settings;
-			settings.UpdateValue([](Settings& set)
+			Assert::AreEqual(true, settings.UpdateValue([](Settings& set)
 			{
 				set.Local.RequireAuthentication = false;
-			});
+			}));
 
 			PeerAccessControl pac(settings);
 			pac.SetAccessDefault(PeerAccessDefault::Allowed);
@@ -251,19 +251,19 @@ namespace UnitTests
 								 pac.GetPublicKey(QuantumGate::UUID(L"e938164b-52c1-69d4-0b84-75d3d11dbfad")) == nullptr);
 			}
 
-			settings.UpdateValue([](Settings& set)
+			Assert::AreEqual(true, settings.UpdateValue([](Settings& set)
 			{
 				set.Local.RequireAuthentication = true;
-			});
+			}));
 
 			// Peer not allowed due to authentication required setting while peer doesn't have a public key
 			Assert::AreEqual(false,
 							 pac.GetAllowed(QuantumGate::UUID(L"e938164b-52c1-69d4-0b84-75d3d11dbfad")).GetValue());
 
-			settings.UpdateValue([](Settings& set)
+			Assert::AreEqual(true, settings.UpdateValue([](Settings& set)
 			{
 				set.Local.RequireAuthentication = false;
-			});
+			}));
 
 			// Peer is now allowed
 			Assert::AreEqual(true,
@@ -283,10 +283,10 @@ namespace UnitTests
 			Assert::AreEqual(true,
 							 pac.GetAllowed(QuantumGate::UUID(L"e938164b-52c1-69d4-0b84-75d3d11dbfad")).GetValue());
 
-			settings.UpdateValue([](Settings& set)
+			Assert::AreEqual(true, settings.UpdateValue([](Settings& set)
 			{
 				set.Local.RequireAuthentication = true;
-			});
+			}));
 
 			// Peer is not allowed due to authentication requirements
 			Assert::AreEqual(false,
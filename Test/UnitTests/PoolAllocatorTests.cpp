@@ -0,0 +1,170 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#include "pch.h"
+#include "Memory\PoolAllocator.h"
+
+#include <thread>
+#include <mutex>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace QuantumGate::Implementation::Memory;
+
+namespace UnitTests
+{
+	TEST_CLASS(PoolAllocatorTests)
+	{
+	public:
+		TEST_METHOD(ThreadMagazines)
+		{
+			PoolAllocator::Allocator<Byte> alloc;
+
+			constexpr Size len{ 100'000 };
+
+			// A freed buffer comes straight back from the thread's magazine
+			auto p1 = alloc.allocate(len);
+			alloc.deallocate(p1, len);
+			auto p2 = alloc.allocate(len);
+			Assert::AreEqual(true, p1 == p2);
+			alloc.deallocate(p2, len);
+
+			// Buffers allocated here and freed on another
+			// thread end up back in the shared pool
+			std::vector<Byte*> buffers;
+			for (auto x = 0; x < 16; ++x)
+			{
+				buffers.emplace_back(alloc.allocate(len));
+				std::memset(buffers.back(), x, len);
+			}
+
+			auto thread = std::thread([&]()
+			{
+				for (auto buffer : buffers)
+				{
+					alloc.deallocate(buffer, len);
+				}
+			});
+
+			thread.join();
+
+			for (auto& buffer : buffers)
+			{
+				buffer = alloc.allocate(len);
+				std::memset(buffer, 0xff, len);
+			}
+
+			for (auto buffer : buffers)
+			{
+				alloc.deallocate(buffer, len);
+			}
+
+			PoolAllocator::Allocator<Byte>::FreeUnused();
+		}
+
+		TEST_METHOD(Slabs)
+		{
+			PoolAllocator::Allocator<Byte> alloc;
+
+			// Sizes get rounded up to the same slab size class
+			auto p1 = alloc.allocate(100);
+			std::memset(p1, 0xff, 100);
+			alloc.deallocate(p1, 100);
+			auto p2 = alloc.allocate(128);
+			Assert::AreEqual(true, p1 == p2);
+
+			// Freed objects get wiped (apart from the free list link)
+			auto wiped = true;
+			for (Size x = sizeof(void*); x < 100; ++x)
+			{
+				if (p2[x] != Byte{ 0 }) wiped = false;
+			}
+
+			Assert::AreEqual(true, wiped);
+
+			// Pointers that aren't at the start of an object can't be freed
+			Assert::ExpectException<std::invalid_argument>([&] { alloc.deallocate(p2 + 64, 128); });
+
+			alloc.deallocate(p2, 128);
+
+			// Memory that isn't part of a slab can't be freed, even when
+			// it's at an offset where an object would be in a slab
+			auto region = static_cast<Byte*>(::VirtualAlloc(nullptr, 65'536, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+			Assert::AreEqual(true, region != nullptr);
+			Assert::ExpectException<std::invalid_argument>([&] { alloc.deallocate(region + 64, 128); });
+			::VirtualFree(region, 0, MEM_RELEASE);
+
+			// Objects of all size classes allocated on several
+			// threads and freed on another thread
+			std::vector<std::tuple<Byte*, Size, Byte>> objects;
+			std::mutex mutex;
+			std::vector<std::thread> threads;
+
+			for (auto x = 0; x < 4; ++x)
+			{
+				threads.emplace_back([&, x]()
+				{
+					for (Size len = 1; len <= 32'768; len *= 2)
+					{
+						for (auto y = 0; y < 100; ++y)
+						{
+							auto p = alloc.allocate(len + x);
+							std::memset(p, x, len + x);
+
+							std::lock_guard<std::mutex> lock(mutex);
+							objects.emplace_back(p, len + x, static_cast<Byte>(x));
+						}
+					}
+				});
+			}
+
+			for (auto& thread : threads) thread.join();
+
+			auto success = true;
+			for (const auto& [p, len, value] : objects)
+			{
+				if (p[0] != value || p[len - 1] != value) success = false;
+			}
+
+			Assert::AreEqual(true, success);
+
+			auto thread = std::thread([&]()
+			{
+				for (const auto& [p, len, value] : objects)
+				{
+					alloc.deallocate(p, len);
+				}
+			});
+
+			thread.join();
+
+			PoolAllocator::Allocator<Byte>::FreeUnused();
+		}
+
+		TEST_METHOD(ProtectedThreadMagazines)
+		{
+			PoolAllocator::ProtectedAllocator<Byte> alloc;
+
+			constexpr Size len{ 64 };
+
+			auto p1 = alloc.allocate(len);
+			std::memset(p1, 0xff, len);
+			alloc.deallocate(p1, len);
+
+			// Reused buffers get wiped
+			auto p2 = alloc.allocate(len);
+			Assert::AreEqual(true, p1 == p2);
+
+			auto wiped = true;
+			for (Size x = 0; x < len; ++x)
+			{
+				if (p2[x] != Byte{ 0 }) wiped = false;
+			}
+
+			Assert::AreEqual(true, wiped);
+
+			alloc.deallocate(p2, len);
+
+			PoolAllocator::ProtectedAllocator<Byte>::FreeUnused();
+		}
+	};
+}
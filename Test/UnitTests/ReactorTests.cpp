@@ -0,0 +1,189 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#include "pch.h"
+#include "Common\Util.h"
+#include "Concurrency\Reactor.h"
+#include "Common\DiffTimer.h"
+
+#include <thread>
+#include <random>
+
+using namespace std::literals;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace QuantumGate::Implementation::Concurrency;
+using namespace QuantumGate::Implementation;
+
+void WaitFunc5s(Event* event) noexcept; // Implemented in EventTests.cpp
+
+namespace UnitTests
+{
+	TEST_CLASS(ReactorTests)
+	{
+	public:
+		TEST_METHOD(Basic)
+		{
+			Event event1;
+			Event event2;
+
+			Reactor reactor;
+			Reactor::ReadyKeys ready_keys;
+
+			// Not initialized
+			const auto result = reactor.Wait(1s, ready_keys);
+			Assert::AreEqual(false, result.Waited);
+			Assert::AreEqual(false, result.HadEvent);
+
+			Assert::AreEqual(true, reactor.Initialize());
+
+			Assert::AreEqual(true, reactor.Add(event1, 1));
+			Assert::AreEqual(true, reactor.Has(event1));
+			Assert::AreEqual(true, reactor.Add(event2, 2));
+			Assert::AreEqual(true, reactor.Has(event2));
+			Assert::AreEqual(false, reactor.Add(event2, 2));
+			Assert::AreEqual(true, reactor.GetSize() == 2);
+
+			const auto result2 = reactor.Wait(1s, ready_keys);
+			Assert::AreEqual(true, result2.Waited);
+			Assert::AreEqual(false, result2.HadEvent);
+			Assert::AreEqual(true, ready_keys.empty());
+
+			DiffTimer<1> timer;
+			auto measurement = timer.GetNewMeasurement(1);
+			measurement.Start();
+
+			// This thread will set the event within 5 seconds
+			auto thread = std::thread(&WaitFunc5s, &event1);
+
+			const auto result3 = reactor.Wait(10s, ready_keys);
+
+			measurement.End();
+
+			thread.join();
+
+			Assert::AreEqual(true, result3.Waited);
+			Assert::AreEqual(true, result3.HadEvent);
+			Assert::AreEqual(true, measurement.GetElapsedTime() >= 5s);
+			Assert::AreEqual(true, ready_keys.size() == 1);
+			Assert::AreEqual(true, ready_keys[0] == 1);
+
+			// Event is still set so should get reported again
+			const auto result4 = reactor.Wait(1s, ready_keys);
+			Assert::AreEqual(true, result4.HadEvent);
+			Assert::AreEqual(true, ready_keys.size() == 1);
+			Assert::AreEqual(true, ready_keys[0] == 1);
+
+			event1.Reset();
+
+			const auto result5 = reactor.Wait(1s, ready_keys);
+			Assert::AreEqual(true, result5.Waited);
+			Assert::AreEqual(false, result5.HadEvent);
+			Assert::AreEqual(true, ready_keys.empty());
+
+			reactor.Remove(event1);
+			Assert::AreEqual(false, reactor.Has(event1));
+
+			event1.Set();
+
+			const auto result6 = reactor.Wait(1s, ready_keys);
+			Assert::AreEqual(true, result6.Waited);
+			Assert::AreEqual(false, result6.HadEvent);
+
+			Event event3;
+			Assert::AreEqual(true, event3.Set());
+			Assert::AreEqual(true, reactor.Add(event3, 3));
+
+			const auto result7 = reactor.Wait(1s, ready_keys);
+			Assert::AreEqual(true, result7.Waited);
+			Assert::AreEqual(true, result7.HadEvent);
+			Assert::AreEqual(true, ready_keys.size() == 1);
+			Assert::AreEqual(true, ready_keys[0] == 3);
+
+			reactor.Deinitialize();
+		}
+
+		TEST_METHOD(NotifyAndInterrupt)
+		{
+			Reactor reactor;
+			Reactor::ReadyKeys ready_keys;
+
+			Assert::AreEqual(true, reactor.Initialize());
+
+			reactor.Notify(10);
+			reactor.Notify(20);
+
+			const auto result = reactor.Wait(0s, ready_keys);
+			Assert::AreEqual(true, result.Waited);
+			Assert::AreEqual(true, result.HadEvent);
+			Assert::AreEqual(true, ready_keys.size() == 2);
+			Assert::AreEqual(true, ready_keys[0] == 10);
+			Assert::AreEqual(true, ready_keys[1] == 20);
+
+			const auto result2 = reactor.Wait(0s, ready_keys);
+			Assert::AreEqual(false, result2.HadEvent);
+			Assert::AreEqual(true, ready_keys.empty());
+
+			DiffTimer<1> timer;
+			auto measurement = timer.GetNewMeasurement(1);
+			measurement.Start();
+
+			auto thread = std::thread([&]()
+			{
+				std::this_thread::sleep_for(2s);
+				reactor.Interrupt();
+			});
+
+			const auto result3 = reactor.Wait(10s, ready_keys);
+
+			measurement.End();
+
+			thread.join();
+
+			Assert::AreEqual(true, result3.Waited);
+			Assert::AreEqual(false, result3.HadEvent);
+			Assert::AreEqual(true, measurement.GetElapsedTime() >= 2s);
+			Assert::AreEqual(true, measurement.GetElapsedTime() < 10s);
+
+			reactor.Deinitialize();
+		}
+
+		TEST_METHOD(ManyEvents)
+		{
+			Reactor reactor;
+			Reactor::ReadyKeys ready_keys;
+
+			Assert::AreEqual(true, reactor.Initialize());
+
+			// Well beyond what a single WaitForMultipleObjects call supports
+			constexpr Reactor::Key num_events{ 10'000 };
+
+			std::vector<Event> events(num_events);
+			for (Reactor::Key x = 0; x < num_events; ++x)
+			{
+				Assert::AreEqual(true, reactor.Add(events[x], x));
+			}
+
+			std::random_device dev;
+			std::mt19937_64 rng(dev());
+
+			for (int x = 0; x < 100; ++x)
+			{
+				const std::uniform_int_distribution<std::size_t> dist(0, events.size() - 1);
+				const auto idx = dist(rng);
+				events[idx].Set();
+
+				const auto result = reactor.Wait(5s, ready_keys);
+				Assert::AreEqual(true, result.Waited);
+				Assert::AreEqual(true, result.HadEvent);
+				Assert::AreEqual(true, std::find(ready_keys.begin(), ready_keys.end(), idx) != ready_keys.end());
+
+				events[idx].Reset();
+			}
+
+			reactor.RemoveAll();
+			Assert::AreEqual(true, reactor.GetSize() == 0);
+
+			reactor.Deinitialize();
+		}
+	};
+}
@@ -253,6 +253,118 @@ namespace UnitTests
 			WSACleanup();
 		}
 
+		TEST_METHOD(UDPSendBatch)
+		{
+			// Initialize Winsock
+			WSADATA wsaData{ 0 };
+			const auto result = WSAStartup(MAKEWORD(2, 2), &wsaData);
+			Assert::AreEqual(true, result == 0);
+
+			const std::array<IPAddress, 2> ips{ IPAddress::LoopbackIPv4(), IPAddress::LoopbackIPv6() };
+
+			for (const auto& ip : ips)
+			{
+				const auto endp1 = IPEndpoint(IPEndpoint::Protocol::UDP, ip, 9000);
+				Socket socket1(endp1.GetIPAddress().GetFamily(), Socket::Type::Datagram, IP::Protocol::UDP);
+				Assert::AreEqual(true, socket1.Bind(endp1, false));
+
+				const auto endp2 = IPEndpoint(IPEndpoint::Protocol::UDP, ip, 9001);
+				Socket socket2(endp2.GetIPAddress().GetFamily(), Socket::Type::Datagram, IP::Protocol::UDP);
+				Assert::AreEqual(true, socket2.Bind(endp2, false));
+
+				// Datagrams of the same size with a smaller last one, followed by a larger one
+				const std::array<Size, 6> sizes{ 100, 100, 100, 100, 40, 200 };
+
+				Vector<Buffer> snd_bufs;
+				Vector<BufferView> batch;
+				for (const auto size : sizes)
+				{
+					snd_bufs.emplace_back(Util::GetPseudoRandomBytes(size));
+				}
+
+				for (const auto& buf : snd_bufs)
+				{
+					batch.emplace_back(buf);
+				}
+
+				while (!batch.empty())
+				{
+					const auto snd_result = socket1.SendToBatch(endp2, batch);
+					Assert::AreEqual(true, snd_result.Succeeded());
+					Assert::AreEqual(true, *snd_result > 0 && *snd_result <= batch.size());
+
+					batch.erase(batch.begin(), batch.begin() + *snd_result);
+				}
+
+				const auto& snd_stats = socket1.GetDatagramStatistics();
+				Assert::AreEqual(true, snd_stats.NumSent == sizes.size());
+				Assert::AreEqual(true, snd_stats.NumSendCalls >= 2 && snd_stats.NumSendCalls <= sizes.size());
+				Assert::AreEqual(true, snd_stats.GetSentPerCall() >= 1.0);
+
+				// Datagram boundaries should be preserved
+				for (const auto& snd_buf : snd_bufs)
+				{
+					Assert::AreEqual(true, socket2.UpdateIOStatus(5000ms));
+					Assert::AreEqual(true, socket2.GetIOStatus().CanRead());
+
+					Endpoint endp_rcv;
+					Buffer rcv_buf;
+					const auto rcv_result = socket2.ReceiveFrom(endp_rcv, rcv_buf);
+					Assert::AreEqual(true, rcv_result.Succeeded());
+					Assert::AreEqual(true, endp_rcv == endp1);
+					Assert::AreEqual(true, rcv_buf == snd_buf);
+				}
+
+				Assert::AreEqual(true, socket2.GetDatagramStatistics().NumReceived == sizes.size());
+
+				// A single datagram larger than the last segment size
+				// should still arrive as one datagram
+				const auto snd_buf2 = Util::GetPseudoRandomBytes(300);
+				const auto snd_result2 = socket1.SendTo(endp2, snd_buf2);
+				Assert::AreEqual(true, snd_result2.Succeeded() && *snd_result2 == snd_buf2.GetSize());
+
+				Assert::AreEqual(true, socket2.UpdateIOStatus(5000ms));
+				Endpoint endp_rcv2;
+				Buffer rcv_buf2;
+				const auto rcv_result2 = socket2.ReceiveFrom(endp_rcv2, rcv_buf2);
+				Assert::AreEqual(true, rcv_result2.Succeeded());
+				Assert::AreEqual(true, rcv_buf2 == snd_buf2);
+
+				socket1.Close();
+				socket2.Close();
+			}
+
+			WSACleanup();
+		}
+
+		TEST_METHOD(DatagramStatisticsTotals)
+		{
+			Socket::DatagramStatisticsTotals totals;
+			Socket::DatagramStatistics added_stats1, added_stats2;
+
+			Socket::DatagramStatistics stats1{ .NumSent = 10, .NumSendCalls = 2, .NumReceived = 4, .NumReceiveCalls = 4 };
+			const Socket::DatagramStatistics stats2{ .NumSent = 1, .NumSendCalls = 1 };
+
+			totals.Add(stats1, added_stats1);
+			totals.Add(stats2, added_stats2);
+
+			// Adding the same statistics again doesn't count them twice
+			totals.Add(stats1, added_stats1);
+
+			// Only what's new gets added
+			stats1.NumSent += 6;
+			stats1.NumSendCalls += 1;
+			totals.Add(stats1, added_stats1);
+
+			const auto stats = totals.Get();
+			Assert::AreEqual(true, stats.NumSent == 17);
+			Assert::AreEqual(true, stats.NumSendCalls == 4);
+			Assert::AreEqual(true, stats.NumReceived == 4);
+			Assert::AreEqual(true, stats.NumReceiveCalls == 4);
+			Assert::AreEqual(true, stats.GetSentPerCall() == 17.0 / 4.0);
+			Assert::AreEqual(true, stats.GetReceivedPerCall() == 1.0);
+		}
+
 		TEST_METHOD(TCPSendReceive)
 		{
 			// Initialize Winsock
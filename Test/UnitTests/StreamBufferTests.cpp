@@ -0,0 +1,147 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#include "pch.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+	TEST_CLASS(StreamBufferTests)
+	{
+	public:
+		TEST_METHOD(General)
+		{
+			const String txt{ L"Man is born free; and everywhere he is in chains. One thinks himself the master of others, "
+				"and still remains a greater slave than they. How did this change come about? I do not know. "
+				"- Jean Jacques Rousseau" };
+
+			const BufferView txt_buffer(reinterpret_cast<const Byte*>(txt.data()), txt.size() * sizeof(String::value_type));
+
+			StreamBuffer b1;
+			Assert::AreEqual(true, b1.IsEmpty());
+			Assert::AreEqual(true, b1.GetSize() == 0);
+
+			// Adding and removing from the front
+			b1 += txt_buffer;
+			Assert::AreEqual(true, b1 == txt_buffer);
+
+			const auto bytes = b1.GetBytes();
+			b1.RemoveFirst(10);
+			Assert::AreEqual(true, b1.GetSize() == txt_buffer.GetSize() - 10);
+			Assert::AreEqual(true, b1.GetBytes() == bytes + 10);
+			Assert::AreEqual(true, b1.GetHeadroomSize() == 10);
+			Assert::AreEqual(true, b1 == txt_buffer.GetLast(txt_buffer.GetSize() - 10));
+
+			b1.RemoveLast(10);
+			Assert::AreEqual(true, b1 == txt_buffer.GetSub(10, txt_buffer.GetSize() - 20));
+
+			// Adding in front uses the headroom
+			b1.AddFirst(txt_buffer.GetFirst(10));
+			Assert::AreEqual(true, b1.GetBytes() == bytes);
+			Assert::AreEqual(true, b1 == txt_buffer.GetFirst(txt_buffer.GetSize() - 10));
+
+			// Adding in front without enough headroom
+			b1.AddFirst(txt_buffer.GetFirst(10));
+			Assert::AreEqual(true, b1.GetSize() == txt_buffer.GetSize());
+			Assert::AreEqual(true, BufferView(b1).GetFirst(10) == txt_buffer.GetFirst(10));
+
+			b1.RemoveFirst(b1.GetSize());
+			Assert::AreEqual(true, b1.IsEmpty());
+			Assert::AreEqual(true, b1.GetHeadroomSize() == 0);
+
+			// Reserved headroom
+			StreamBuffer b2(16);
+			b2 += txt_buffer;
+			Assert::AreEqual(true, b2.GetHeadroomSize() == 16);
+			b2.AddFirst(txt_buffer.GetFirst(16));
+			Assert::AreEqual(true, b2.GetHeadroomSize() == 0);
+			Assert::AreEqual(true, b2.GetSize() == txt_buffer.GetSize() + 16);
+
+			// Copy and move
+			StreamBuffer b3(b2);
+			Assert::AreEqual(true, b3 == BufferView(b2));
+
+			StreamBuffer b4(std::move(b3));
+			Assert::AreEqual(true, b4 == BufferView(b2));
+			Assert::AreEqual(true, b3.IsEmpty());
+
+			b4.Swap(b3);
+			Assert::AreEqual(true, b4.IsEmpty());
+			Assert::AreEqual(true, b3 == BufferView(b2));
+
+			// Taking over a Buffer
+			Buffer b5(txt_buffer);
+			const auto bytes2 = b5.GetBytes();
+			b4 = std::move(b5);
+			Assert::AreEqual(true, b4.GetBytes() == bytes2);
+			Assert::AreEqual(true, b4 == txt_buffer);
+
+			b4.Clear();
+			Assert::AreEqual(true, b4.IsEmpty());
+		}
+
+		TEST_METHOD(Tailroom)
+		{
+			StreamBuffer b1;
+
+			// Writing directly in the tailroom
+			auto tail = b1.GetTailroom(100);
+			Assert::AreEqual(true, tail.GetSize() >= 100);
+
+			for (Size x = 0; x < 100; ++x)
+			{
+				tail[x] = static_cast<Byte>(x);
+			}
+
+			b1.CommitTailroom(100);
+			Assert::AreEqual(true, b1.GetSize() == 100);
+			Assert::AreEqual(true, b1[99] == Byte{ 99 });
+
+			// Data gets moved back to the front once as much
+			// has been consumed as there's data left
+			b1.RemoveFirst(60);
+			const auto size = b1.GetSize() + b1.GetHeadroomSize() + b1.GetTailroomSize();
+
+			tail = b1.GetTailroom(b1.GetTailroomSize() + 60);
+			Assert::AreEqual(true, b1.GetHeadroomSize() == 0);
+			Assert::AreEqual(true, b1.GetSize() + b1.GetTailroomSize() == size);
+			Assert::AreEqual(true, b1[0] == Byte{ 60 });
+			Assert::AreEqual(true, b1[39] == Byte{ 99 });
+
+			// Consuming from the front while adding at the back
+			// keeps the data in order and the memory bounded
+			Size next_in{ 0 };
+			Size next_out{ 0 };
+			b1.Clear();
+
+			auto success = true;
+
+			for (auto x = 0; x < 1000; ++x)
+			{
+				tail = b1.GetTailroom(1000);
+				for (Size y = 0; y < 1000; ++y)
+				{
+					tail[y] = static_cast<Byte>(next_in++ % 251);
+				}
+
+				b1.CommitTailroom(1000);
+
+				const auto num = std::min(b1.GetSize(), Size{ 997 } + static_cast<Size>(x % 7));
+				for (Size y = 0; y < num; ++y)
+				{
+					if (b1[y] != static_cast<Byte>(next_out++ % 251)) success = false;
+				}
+
+				b1.RemoveFirst(num);
+			}
+
+			Assert::AreEqual(true, success);
+			Assert::AreEqual(true, b1.GetSize() + b1.GetHeadroomSize() + b1.GetTailroomSize() < 100'000);
+
+			b1.FreeUnused();
+			Assert::AreEqual(true, b1.GetTailroomSize() == 0);
+			Assert::AreEqual(true, b1.GetHeadroomSize() == 0);
+		}
+	};
+}
@@ -35,10 +35,10 @@ namespace UnitTests
 			// Cache should have initial value
 			Assert::AreEqual(33, tlc1->Value);
 
-			tlc1.UpdateValue([](TLTest& tlt)
+			Assert::AreEqual(true, tlc1.UpdateValue([](TLTest& tlt)
 			{
 				tlt.Value = 369;
-			});
+			}));
 
 			// Cache should not yet be updated
 			Assert::AreEqual(33, tlc1.GetCache(false).Value);
@@ -46,10 +46,10 @@ namespace UnitTests
 			// Cache should be updated
 			Assert::AreEqual(369, tlc1.GetCache(true).Value);
 
-			tlc1.UpdateValue([](TLTest& tlt)
+			Assert::AreEqual(true, tlc1.UpdateValue([](TLTest& tlt)
 			{
 				tlt.Value = 369369;
-			});
+			}));
 
 			// Cache should not yet be updated
 			Assert::AreEqual(369, tlc1.GetCache(false).Value);
@@ -61,6 +61,149 @@ namespace UnitTests
 			Assert::AreEqual(0, tlc2->Value);
 		}
 
+		TEST_METHOD(Snapshots)
+		{
+			Concurrency::ThreadLocalCache<TLTest, Concurrency::SpinMutex, 3> tlc(1);
+
+			const auto& value1 = tlc.GetCache();
+			Assert::AreEqual(1, value1.Value);
+
+			Assert::AreEqual(true, tlc.UpdateValue([](TLTest& tlt)
+			{
+				tlt.Value = 2;
+			}));
+
+			// Values are immutable snapshots; earlier references
+			// still refer to the value from before the update
+			const auto& value2 = tlc.GetCache();
+			Assert::AreEqual(2, value2.Value);
+			Assert::AreEqual(1, value1.Value);
+			Assert::AreEqual(true, &value1 != &value2);
+
+			// Getting the value again without an update doesn't change anything
+			Assert::AreEqual(true, &tlc.GetCache() == &value2);
+
+			// Updates are based on the latest value
+			Assert::AreEqual(true, tlc.UpdateValue([](TLTest& tlt)
+			{
+				tlt.Value *= 10;
+			}));
+
+			Assert::AreEqual(20, tlc->Value);
+			Assert::AreEqual(2, value2.Value);
+
+			std::atomic<bool> done{ false };
+			std::atomic<bool> success{ true };
+
+			auto thread = std::thread([&]()
+			{
+				while (!done)
+				{
+					// Each snapshot is consistent
+					const auto value = tlc->Value;
+					if (value % 10 != 0) success = false;
+				}
+			});
+
+			for (auto x = 1; x <= 10'000; ++x)
+			{
+				Assert::AreEqual(true, tlc.UpdateValue([&](TLTest& tlt)
+				{
+					tlt.Value = x;
+					tlt.Value *= 10;
+				}));
+			}
+
+			done = true;
+			thread.join();
+
+			Assert::AreEqual(true, success.load());
+			Assert::AreEqual(100'000, tlc->Value);
+		}
+
+		TEST_METHOD(SnapshotGuard)
+		{
+			Concurrency::ThreadLocalCache<TLTest, Concurrency::SpinMutex, 4> tlc(1);
+
+			const auto snapshot = tlc.GetSnapshot();
+			const auto& value = *snapshot;
+			Assert::AreEqual(true, &value == &tlc.GetCache());
+
+			// The snapshot keeps the value alive even after the
+			// thread has picked up several newer snapshots
+			for (auto x = 2; x <= 10; ++x)
+			{
+				Assert::AreEqual(true, tlc.UpdateValue([&](TLTest& tlt) noexcept
+				{
+					tlt.Value = x;
+				}));
+
+				Assert::AreEqual(x, tlc->Value);
+			}
+
+			Assert::AreEqual(1, value.Value);
+			Assert::AreEqual(10, tlc.GetSnapshot()->Value);
+
+			// Exceptions from the update function leave the value the same
+			auto exception_thrown = false;
+
+			try
+			{
+				Assert::AreEqual(true, tlc.UpdateValue([](TLTest& tlt)
+				{
+					tlt.Value = 11;
+					throw std::runtime_error("update failed");
+				}));
+			}
+			catch (const std::runtime_error&)
+			{
+				exception_thrown = true;
+			}
+
+			Assert::AreEqual(true, exception_thrown);
+			Assert::AreEqual(10, tlc->Value);
+		}
+
+		TEST_METHOD(QuiescentState)
+		{
+			Concurrency::ThreadLocalCache<TLTest, Concurrency::SpinMutex, 5> tlc(1);
+
+			// Reference held further up the call stack
+			const auto& value = tlc.GetCache();
+			const std::weak_ptr<const TLTest> weak_value = tlc.GetSnapshot();
+
+			// Two quick updates that get picked up by
+			// functions that get called in the meantime
+			for (auto x = 2; x <= 3; ++x)
+			{
+				Assert::AreEqual(true, tlc.UpdateValue([&](TLTest& tlt) noexcept
+				{
+					tlt.Value = x;
+				}));
+
+				Assert::AreEqual(x, tlc->Value);
+			}
+
+			// The reference is still valid since the
+			// thread didn't pass a quiescent point yet
+			Assert::AreEqual(false, weak_value.expired());
+			Assert::AreEqual(1, value.Value);
+
+			Concurrency::ThreadLocalCacheQuiescence::OnQuiescentState();
+
+			// Snapshots the thread moved on from get released
+			// the next time it picks up a newer snapshot
+			Assert::AreEqual(false, weak_value.expired());
+
+			Assert::AreEqual(true, tlc.UpdateValue([](TLTest& tlt) noexcept
+			{
+				tlt.Value = 4;
+			}));
+
+			Assert::AreEqual(4, tlc->Value);
+			Assert::AreEqual(true, weak_value.expired());
+		}
+
 		TEST_METHOD(Threads)
 		{
 			Concurrency::ThreadLocalCache<TLTest, Concurrency::SpinMutex, 1> tlc1(33);
@@ -148,10 +291,10 @@ namespace UnitTests
 				}
 			}
 
-			tlc1.UpdateValue([](TLTest& tlt)
+			Assert::AreEqual(true, tlc1.UpdateValue([](TLTest& tlt)
 			{
 				tlt.Value = 369;
-			});
+			}));
 
 			// Cache should be updated for main thread
 			Assert::AreEqual(369, tlc1->Value);
@@ -177,15 +320,15 @@ namespace UnitTests
 			}
 
 			{
-				tlc1.UpdateValue([](TLTest& tlt)
+				Assert::AreEqual(true, tlc1.UpdateValue([](TLTest& tlt)
 				{
 					tlt.Value = 369369;
-				});
+				}));
 
-				tlc2.UpdateValue([](TLTest& tlt)
+				Assert::AreEqual(true, tlc2.UpdateValue([](TLTest& tlt)
 				{
 					tlt.Value = 22;
-				});
+				}));
 			}
 
 			cv1.notify_one();
@@ -0,0 +1,176 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#include "pch.h"
+#include "Common\Util.h"
+#include "Concurrency\TimerWheel.h"
+
+#include <random>
+
+using namespace std::literals;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace QuantumGate::Implementation::Concurrency;
+using namespace QuantumGate::Implementation;
+
+namespace UnitTests
+{
+	TEST_CLASS(TimerWheelTests)
+	{
+	public:
+		TEST_METHOD(Basic)
+		{
+			const auto base = Util::GetCurrentSteadyTime();
+
+			TimerWheel<UInt64> wheel(base);
+			TimerWheel<UInt64>::ExpiredKeys expired;
+
+			Assert::AreEqual(true, wheel.IsEmpty());
+			Assert::AreEqual(false, wheel.GetNextExpiry().has_value());
+
+			Assert::AreEqual(true, wheel.Schedule(1, base + 10ms));
+			Assert::AreEqual(true, wheel.Schedule(2, base + 20ms));
+			Assert::AreEqual(true, wheel.Schedule(3, base + 30ms));
+			Assert::AreEqual(true, wheel.GetSize() == 3);
+			Assert::AreEqual(true, wheel.Has(2));
+			Assert::AreEqual(true, *wheel.GetNextExpiry() == base + 10ms);
+			Assert::AreEqual(true, *wheel.GetDeadline(3) == base + 30ms);
+
+			// Nothing due yet
+			Assert::AreEqual(true, wheel.Expire(base + 9ms, expired));
+			Assert::AreEqual(true, expired.empty());
+
+			Assert::AreEqual(true, wheel.Expire(base + 10ms, expired));
+			Assert::AreEqual(true, expired.size() == 1);
+			Assert::AreEqual(true, expired[0] == 1);
+			Assert::AreEqual(false, wheel.Has(1));
+			Assert::AreEqual(true, *wheel.GetNextExpiry() == base + 20ms);
+
+			// Cancel
+			Assert::AreEqual(true, wheel.Cancel(2));
+			Assert::AreEqual(false, wheel.Cancel(2));
+			Assert::AreEqual(false, wheel.Has(2));
+
+			// Reschedule
+			Assert::AreEqual(true, wheel.Schedule(3, base + 15ms));
+			Assert::AreEqual(true, wheel.GetSize() == 1);
+
+			expired.clear();
+			Assert::AreEqual(true, wheel.Expire(base + 100ms, expired));
+			Assert::AreEqual(true, expired.size() == 1);
+			Assert::AreEqual(true, expired[0] == 3);
+			Assert::AreEqual(true, wheel.IsEmpty());
+
+			// Deadlines in the past expire on the next tick
+			Assert::AreEqual(true, wheel.Schedule(4, base));
+			expired.clear();
+			Assert::AreEqual(true, wheel.Expire(base + 100ms, expired));
+			Assert::AreEqual(true, expired.empty());
+			Assert::AreEqual(true, wheel.Expire(base + 101ms, expired));
+			Assert::AreEqual(true, expired.size() == 1);
+			Assert::AreEqual(true, expired[0] == 4);
+
+			wheel.Clear();
+			Assert::AreEqual(true, wheel.IsEmpty());
+		}
+
+		TEST_METHOD(LongDeadlines)
+		{
+			const auto base = Util::GetCurrentSteadyTime();
+
+			TimerWheel<UInt64> wheel(base);
+			TimerWheel<UInt64>::ExpiredKeys expired;
+
+			// These end up on higher levels and need cascading
+			Assert::AreEqual(true, wheel.Schedule(1, base + 300ms));
+			Assert::AreEqual(true, wheel.Schedule(2, base + 70s));
+			Assert::AreEqual(true, wheel.Schedule(3, base + 5h));
+			Assert::AreEqual(true, wheel.Schedule(4, base + 24h * 400));
+
+			// Next expiry is never later than the earliest deadline
+			Assert::AreEqual(true, *wheel.GetNextExpiry() <= base + 300ms);
+
+			Assert::AreEqual(true, wheel.Expire(base + 299ms, expired));
+			Assert::AreEqual(true, expired.empty());
+			Assert::AreEqual(true, wheel.Expire(base + 300ms, expired));
+			Assert::AreEqual(true, expired.size() == 1 && expired[0] == 1);
+
+			expired.clear();
+			Assert::AreEqual(true, *wheel.GetNextExpiry() <= base + 70s);
+			Assert::AreEqual(true, wheel.Expire(base + 70s - 1ms, expired));
+			Assert::AreEqual(true, expired.empty());
+			Assert::AreEqual(true, wheel.Expire(base + 70s, expired));
+			Assert::AreEqual(true, expired.size() == 1 && expired[0] == 2);
+
+			expired.clear();
+			Assert::AreEqual(true, wheel.Expire(base + 5h - 1ms, expired));
+			Assert::AreEqual(true, expired.empty());
+			Assert::AreEqual(true, wheel.Expire(base + 5h, expired));
+			Assert::AreEqual(true, expired.size() == 1 && expired[0] == 3);
+
+			expired.clear();
+			Assert::AreEqual(true, wheel.Expire(base + 24h * 400 - 1ms, expired));
+			Assert::AreEqual(true, expired.empty());
+			Assert::AreEqual(true, wheel.Expire(base + 24h * 400, expired));
+			Assert::AreEqual(true, expired.size() == 1 && expired[0] == 4);
+			Assert::AreEqual(true, wheel.IsEmpty());
+		}
+
+		TEST_METHOD(ManyTimers)
+		{
+			const auto base = Util::GetCurrentSteadyTime();
+
+			TimerWheel<UInt64> wheel(base);
+			TimerWheel<UInt64>::ExpiredKeys expired;
+
+			std::random_device dev;
+			std::mt19937_64 rng(dev());
+			std::uniform_int_distribution<UInt64> dist(1, 200'000);
+
+			constexpr UInt64 num_timers{ 10'000 };
+			Vector<UInt64> deadlines(num_timers);
+
+			for (UInt64 x = 0; x < num_timers; ++x)
+			{
+				deadlines[x] = dist(rng);
+				Assert::AreEqual(true, wheel.Schedule(x, base + std::chrono::milliseconds(deadlines[x])));
+			}
+
+			// Cancel every tenth timer
+			for (UInt64 x = 0; x < num_timers; x += 10)
+			{
+				Assert::AreEqual(true, wheel.Cancel(x));
+			}
+
+			// Advance in irregular steps and check that timers
+			// expire exactly on time and never more than once
+			Vector<bool> seen(num_timers, false);
+			UInt64 now{ 0 };
+
+			while (!wheel.IsEmpty())
+			{
+				now += std::uniform_int_distribution<UInt64>(0, 500)(rng);
+
+				expired.clear();
+				Assert::AreEqual(true, wheel.Expire(base + std::chrono::milliseconds(now), expired));
+
+				for (const auto key : expired)
+				{
+					Assert::AreEqual(true, key % 10 != 0);
+					Assert::AreEqual(false, static_cast<bool>(seen[key]));
+					Assert::AreEqual(true, deadlines[key] <= now);
+					seen[key] = true;
+				}
+
+				if (const auto next = wheel.GetNextExpiry(); next.has_value())
+				{
+					Assert::AreEqual(true, *next > base + std::chrono::milliseconds(now));
+				}
+			}
+
+			for (UInt64 x = 0; x < num_timers; ++x)
+			{
+				Assert::AreEqual(x % 10 != 0, static_cast<bool>(seen[x]));
+			}
+		}
+	};
+}
@@ -0,0 +1,137 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#include "pch.h"
+#include "Settings.h"
+
+// Undefine conflicting macro
+#ifdef max
+#undef max
+#endif
+
+#ifdef min
+#undef min
+#endif
+
+#include "Core\UDP\UDPConnectionStats.h"
+
+using namespace std::literals;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace QuantumGate::Implementation;
+using namespace QuantumGate::Implementation::Core::UDP::Connection;
+
+namespace UnitTests
+{
+	TEST_CLASS(UDPConnectionCongestionControlTests)
+	{
+	public:
+		TEST_METHOD(Create)
+		{
+			Assert::AreEqual(true, dynamic_cast<Statistics*>(CongestionController::Create(UDPCongestionControl::AIMD).get()) != nullptr);
+			Assert::AreEqual(true, dynamic_cast<CubicCongestionController*>(CongestionController::Create(UDPCongestionControl::CUBIC).get()) != nullptr);
+			Assert::AreEqual(true, dynamic_cast<BBRCongestionController*>(CongestionController::Create(UDPCongestionControl::BBR).get()) != nullptr);
+		}
+
+		TEST_METHOD(RTTEstimation)
+		{
+			RTTEstimator rtt;
+			Assert::AreEqual(false, rtt.HasSamples());
+			Assert::AreEqual(true, rtt.GetRetransmissionTimeout() == 600ms);
+
+			rtt.RecordRTT(100ms);
+			Assert::AreEqual(true, rtt.HasSamples());
+			Assert::AreEqual(true, rtt.GetRTT() == 100ms);
+			Assert::AreEqual(true, rtt.GetRetransmissionTimeout() == 300ms);
+
+			// Converges on a stable RTT and the variation goes down
+			for (int x = 0; x < 100; ++x) rtt.RecordRTT(50ms);
+			Assert::AreEqual(true, rtt.GetRTT() < 51ms);
+			Assert::AreEqual(true, rtt.GetMinRTT() == 50ms);
+			Assert::AreEqual(true, rtt.GetRetransmissionTimeout() < 55ms);
+			Assert::AreEqual(true, rtt.GetRetransmissionTimeout() >= rtt.GetRTT() + 1ms);
+		}
+
+		TEST_METHOD(CUBIC)
+		{
+			CubicCongestionController cc;
+
+			auto now = SteadyTime{} + 1s;
+			cc.RecordRTT(100ms, now);
+
+			// Slow start doubles the window every RTT
+			const auto start_wnd = cc.GetMTUWindowSize();
+			for (int x = 0; x < 5; ++x)
+			{
+				const auto wnd = cc.GetMTUWindowSize();
+				cc.RecordMTUAck(static_cast<double>(wnd), now);
+				now += 100ms;
+			}
+
+			const auto max_wnd = cc.GetMTUWindowSize();
+			Assert::AreEqual(start_wnd << 5, max_wnd);
+
+			// Loss reduces the window by beta
+			cc.RecordMTULoss(1.0, now);
+			const auto loss_wnd = cc.GetMTUWindowSize();
+			Assert::AreEqual(static_cast<Size>(std::ceil(static_cast<double>(max_wnd) * 0.7)), loss_wnd);
+
+			// More losses within the same RTT are part of the same congestion event
+			cc.RecordMTULoss(1.0, now + 10ms);
+			Assert::AreEqual(loss_wnd, cc.GetMTUWindowSize());
+
+			// Window grows back to where the loss occurred and beyond
+			auto prev_wnd = loss_wnd;
+			for (int x = 0; x < 100; ++x)
+			{
+				now += 100ms;
+				cc.RecordMTUAck(static_cast<double>(cc.GetMTUWindowSize()), now);
+
+				Assert::AreEqual(true, cc.GetMTUWindowSize() >= prev_wnd);
+				prev_wnd = cc.GetMTUWindowSize();
+			}
+
+			Assert::AreEqual(true, cc.GetMTUWindowSize() > max_wnd);
+
+			// Never goes below the minimum window size
+			for (int x = 0; x < 100; ++x)
+			{
+				now += 200ms;
+				cc.RecordMTULoss(1.0, now);
+			}
+
+			Assert::AreEqual(Size{ 2 }, cc.GetMTUWindowSize());
+		}
+
+		TEST_METHOD(BBR)
+		{
+			BBRCongestionController cc;
+
+			// Bottleneck of 1000 MTUs per second with 50ms propagation delay
+			constexpr auto bandwidth = 1000.0;
+			constexpr auto rtt = 50ms;
+
+			auto now = SteadyTime{} + 1s;
+			Assert::AreEqual(Size{ 4 }, cc.GetMTUWindowSize());
+
+			// Acks arrive at the bottleneck rate with a growing queue
+			// delay in between; the queue doesn't lower the estimate
+			for (int x = 0; x < 2000; ++x)
+			{
+				now += 1ms;
+				cc.RecordRTT(rtt + std::chrono::milliseconds(x % 20), now);
+				cc.RecordMTUAck(bandwidth / 1000.0, now);
+
+				// Losses are not taken as a congestion signal
+				if (x % 50 == 0) cc.RecordMTULoss(1.0, now);
+			}
+
+			Assert::AreEqual(true, std::abs(cc.GetBottleneckBandwidth() - bandwidth) < bandwidth * 0.05);
+
+			// Left startup; pacing at around the bottleneck bandwidth
+			// and keeping about two bandwidth-delay products in flight
+			Assert::AreEqual(true, cc.GetPacingRate() < bandwidth * 1.3);
+			Assert::AreEqual(true, cc.GetPacingRate() > bandwidth * 0.7);
+			Assert::AreEqual(true, cc.GetMTUWindowSize() >= 95 && cc.GetMTUWindowSize() <= 105);
+		}
+	};
+}
@@ -0,0 +1,201 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#include "pch.h"
+#include "Settings.h"
+
+// Undefine conflicting macro
+#ifdef max
+#undef max
+#endif
+
+#include "Core\UDP\UDPConnectionSequenceWindow.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace QuantumGate::Implementation;
+using namespace QuantumGate::Implementation::Core::UDP;
+using namespace QuantumGate::Implementation::Core::UDP::Connection;
+
+namespace UnitTests
+{
+	TEST_CLASS(UDPConnectionSequenceWindowTests)
+	{
+	public:
+		TEST_METHOD(General)
+		{
+			SequenceWindow<int> wnd;
+			wnd.Reset(100);
+
+			Assert::AreEqual(true, wnd.IsEmpty());
+			Assert::AreEqual(true, wnd.GetFront() == nullptr);
+			Assert::AreEqual(true, wnd.Get(100) == nullptr);
+
+			for (int x = 100; x < 110; ++x)
+			{
+				const auto [item, inserted] = wnd.Emplace(static_cast<Message::SequenceNumber>(x), x);
+				Assert::AreEqual(true, item != nullptr && inserted);
+				Assert::AreEqual(x, *item);
+			}
+
+			Assert::AreEqual(Size{ 10 }, wnd.GetSize());
+			Assert::AreEqual(Size{ 10 }, wnd.GetSpan());
+			Assert::AreEqual(true, wnd.IsInWindow(109));
+			Assert::AreEqual(false, wnd.IsInWindow(110));
+			Assert::AreEqual(false, wnd.IsInWindow(99));
+
+			// Existing item doesn't get replaced
+			{
+				const auto [item, inserted] = wnd.Emplace(105, 1000);
+				Assert::AreEqual(true, item != nullptr && !inserted);
+				Assert::AreEqual(105, *item);
+			}
+
+			// Gaps in the window
+			{
+				const auto [item, inserted] = wnd.Emplace(115, 115);
+				Assert::AreEqual(true, item != nullptr && inserted);
+				Assert::AreEqual(Size{ 11 }, wnd.GetSize());
+				Assert::AreEqual(Size{ 16 }, wnd.GetSpan());
+				Assert::AreEqual(true, wnd.Get(112) == nullptr);
+				Assert::AreEqual(115, *wnd.Get(115));
+			}
+
+			int sum{ 0 };
+			wnd.ForEach([&](int& item) noexcept { sum += item; return true; });
+			Assert::AreEqual(1045 + 115, sum);
+
+			// Stops when the function returns false
+			Size num{ 0 };
+			wnd.ForEach([&](int& item) noexcept { ++num; return (item != 103); });
+			Assert::AreEqual(Size{ 4 }, num);
+
+			wnd.PopFront();
+			wnd.PopFront();
+			Assert::AreEqual(Message::SequenceNumber{ 102 }, wnd.GetBaseSequenceNumber());
+			Assert::AreEqual(Size{ 9 }, wnd.GetSize());
+			Assert::AreEqual(102, *wnd.GetFront());
+			Assert::AreEqual(true, wnd.Get(101) == nullptr);
+
+			wnd.Reset(200);
+			Assert::AreEqual(true, wnd.IsEmpty());
+			Assert::AreEqual(Size{ 0 }, wnd.GetSpan());
+			Assert::AreEqual(true, wnd.Get(102) == nullptr);
+		}
+
+		TEST_METHOD(WrapAround)
+		{
+			constexpr auto max_seqnum = std::numeric_limits<Message::SequenceNumber>::max();
+
+			SequenceWindow<Message::SequenceNumber> wnd;
+			wnd.Reset(max_seqnum - 4);
+
+			auto seqnum = wnd.GetBaseSequenceNumber();
+			for (int x = 0; x < 10; ++x)
+			{
+				Assert::AreEqual(true, wnd.Emplace(seqnum, seqnum).second);
+				seqnum = Message::GetNextSequenceNumber(seqnum);
+			}
+
+			Assert::AreEqual(Size{ 10 }, wnd.GetSize());
+			Assert::AreEqual(true, wnd.IsInWindow(max_seqnum));
+			Assert::AreEqual(true, wnd.IsInWindow(0));
+			Assert::AreEqual(true, wnd.IsInWindow(4));
+			Assert::AreEqual(false, wnd.IsInWindow(5));
+			Assert::AreEqual(Message::SequenceNumber{ 3 }, *wnd.Get(3));
+
+			// Items are visited in order of sequence number relative to the base
+			Vector<Message::SequenceNumber> seqnums;
+			wnd.ForEach([&](const auto item) { seqnums.emplace_back(item); return true; });
+			Assert::AreEqual(Size{ 10 }, seqnums.size());
+			Assert::AreEqual(true, seqnums.front() == max_seqnum - 4);
+			Assert::AreEqual(true, seqnums.back() == 4);
+
+			for (int x = 0; x < 6; ++x) wnd.PopFront();
+
+			Assert::AreEqual(Message::SequenceNumber{ 1 }, wnd.GetBaseSequenceNumber());
+			Assert::AreEqual(Size{ 4 }, wnd.GetSize());
+			Assert::AreEqual(false, wnd.IsInWindow(max_seqnum));
+		}
+
+		TEST_METHOD(ForEachInRange)
+		{
+			constexpr auto max_seqnum = std::numeric_limits<Message::SequenceNumber>::max();
+
+			SequenceWindow<Message::SequenceNumber> wnd;
+			wnd.Reset(max_seqnum - 9);
+
+			auto seqnum = wnd.GetBaseSequenceNumber();
+			for (int x = 0; x < 20; ++x)
+			{
+				// Leave out every third one
+				if (x % 3 != 2) Assert::AreEqual(true, wnd.Emplace(seqnum, seqnum).second);
+				seqnum = Message::GetNextSequenceNumber(seqnum);
+			}
+
+			const auto count = [&](const Message::SequenceNumber begin, const Message::SequenceNumber end)
+			{
+				Size num{ 0 };
+				wnd.ForEachInRange(begin, end, [&](const auto item)
+				{
+					Assert::AreEqual(true, item >= begin && item <= end);
+					++num;
+					return true;
+				});
+				return num;
+			};
+
+			// Ranges before the wrap around
+			Assert::AreEqual(Size{ 7 }, count(max_seqnum - 9, max_seqnum));
+			Assert::AreEqual(Size{ 1 }, count(max_seqnum - 1, max_seqnum));
+
+			// Ranges after the wrap around
+			Assert::AreEqual(Size{ 7 }, count(0, 9));
+			Assert::AreEqual(Size{ 7 }, count(0, 1000));
+
+			// Ranges partly or completely outside the window
+			Assert::AreEqual(Size{ 2 }, count(max_seqnum - 100, max_seqnum - 7));
+			Assert::AreEqual(Size{ 0 }, count(10, 1000));
+			Assert::AreEqual(Size{ 0 }, count(1000, 2000));
+			Assert::AreEqual(Size{ 14 }, count(0, max_seqnum));
+
+			// Invalid range
+			Assert::AreEqual(Size{ 0 }, count(5, 4));
+		}
+
+		TEST_METHOD(Growth)
+		{
+			SequenceWindow<Buffer> wnd;
+			wnd.Reset(60000);
+
+			Message::SequenceNumber seqnum = 60000;
+			for (Size x = 0; x < 20000; ++x)
+			{
+				Assert::AreEqual(true, wnd.Emplace(seqnum, Buffer(x % 100 + 1)).second);
+				seqnum = Message::GetNextSequenceNumber(seqnum);
+
+				// Keep the front moving for part of the time so
+				// that the window grows while wrapped around
+				if (x % 4 == 0) wnd.PopFront();
+			}
+
+			Assert::AreEqual(Size{ 15000 }, wnd.GetSize());
+			Assert::AreEqual(true, wnd.GetCapacity() >= wnd.GetSize());
+
+			Size x{ 5000 };
+			auto success{ true };
+			wnd.ForEach([&](const Buffer& buffer)
+			{
+				if (buffer.GetSize() != x % 100 + 1) success = false;
+				++x;
+				return true;
+			});
+
+			Assert::AreEqual(true, success);
+			Assert::AreEqual(Size{ 20000 }, x);
+
+			// Can't span more than half of all sequence numbers
+			Assert::AreEqual(false, wnd.Emplace(static_cast<Message::SequenceNumber>(wnd.GetBaseSequenceNumber() +
+																					 SequenceWindow<Buffer>::MaxCapacity), Buffer()).first != nullptr);
+		}
+	};
+}
@@ -0,0 +1,981 @@
+// This file is part of the QuantumGate project. For copyright and
+// licensing information refer to the license file(s) in the project root.
+
+#include "pch.h"
+#include "Settings.h"
+
+// Undefine conflicting macro
+#ifdef max
+#undef max
+#endif
+
+#ifdef min
+#undef min
+#endif
+
+#include "Core\UDP\UDPConnection.h"
+#include "Core\UDP\UDPConnectionCookies.h"
+#include "Core\UDP\UDPListenerSocket.h"
+#include "Core\KeyGeneration\KeyGenerationManager.h"
+#include "Core\Access\AccessManager.h"
+#include "NetworkSimulator.h"
+
+using namespace std::literals;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace QuantumGate::Implementation;
+using namespace QuantumGate::Implementation::Core::UDP;
+
+namespace UnitTests
+{
+	// The simulated network with IP endpoints on top of the
+	// endpoint IDs that the network simulator works with
+	class SimulatedUDPNetwork final
+	{
+	public:
+		using Simulator = NetworkSimulator<Buffer>;
+
+		SimulatedUDPNetwork(const Simulator::LinkParameters& params, const UInt64 seed) :
+			m_Network(seed), m_LinkParameters(params)
+		{
+			// Steady time shouldn't start near its epoch since
+			// the connections compare it with time spans in the past
+			m_Network.AdvanceTo(m_Network.GetNow() + 24h);
+		}
+
+		[[nodiscard]] inline Simulator& Get() noexcept { return m_Network; }
+
+		[[nodiscard]] inline SteadyTime GetNow() const noexcept { return m_Network.GetNow(); }
+
+		[[nodiscard]] Simulator::EndpointID AddEndpoint(const IPEndpoint& endpoint)
+		{
+			const auto id = m_Network.AddEndpoint();
+
+			for (const auto& [ep, epid] : m_Endpoints)
+			{
+				m_Network.SetLinks(id, epid, m_LinkParameters);
+			}
+
+			m_Endpoints.emplace_back(endpoint, id);
+
+			return id;
+		}
+
+		[[nodiscard]] std::optional<Simulator::EndpointID> GetEndpointID(const IPEndpoint& endpoint) const noexcept
+		{
+			for (const auto& [ep, epid] : m_Endpoints)
+			{
+				if (ep == endpoint) return epid;
+			}
+
+			return std::nullopt;
+		}
+
+		[[nodiscard]] const IPEndpoint& GetEndpoint(const Simulator::EndpointID id) const noexcept
+		{
+			for (const auto& [ep, epid] : m_Endpoints)
+			{
+				if (epid == id) return ep;
+			}
+
+			// Shouldn't get here
+			assert(false);
+			return m_Endpoints.front().first;
+		}
+
+	private:
+		Simulator m_Network;
+		Simulator::LinkParameters m_LinkParameters;
+		Vector<std::pair<IPEndpoint, Simulator::EndpointID>> m_Endpoints;
+	};
+
+	// Runs the connections on the virtual time of the simulated network; the
+	// system time can be skewed to simulate peers whose clocks don't agree
+	class SimulatedClock final : public Connection::Clock
+	{
+	public:
+		SimulatedClock(const SimulatedUDPNetwork& network, const std::chrono::seconds skew) noexcept :
+			m_Network(network), m_StartSteadyTime(network.GetNow()),
+			m_StartSystemTime(Util::GetCurrentSystemTime() + skew)
+		{}
+
+		[[nodiscard]] SteadyTime GetSteadyTime() const noexcept override { return m_Network.GetNow(); }
+
+		[[nodiscard]] SystemTime GetSystemTime() const noexcept override
+		{
+			return m_StartSystemTime + std::chrono::duration_cast<SystemTime::duration>(m_Network.GetNow() - m_StartSteadyTime);
+		}
+
+	private:
+		const SimulatedUDPNetwork& m_Network;
+		const SteadyTime m_StartSteadyTime;
+		const SystemTime m_StartSystemTime;
+	};
+
+	// Sends and receives the datagrams of a connection (or
+	// the stand-in listener) over the simulated network
+	class SimulatedDatagramIO final : public Connection::DatagramIO
+	{
+	public:
+		SimulatedDatagramIO(SimulatedUDPNetwork& network, const IPEndpoint& endpoint) noexcept :
+			m_Network(network), m_LocalEndpoint(endpoint)
+		{}
+
+		[[nodiscard]] bool Open(const Network::AddressFamily af, const bool nat_traversal) override
+		{
+			m_ID = m_Network.AddEndpoint(m_LocalEndpoint.GetIPEndpoint());
+
+			m_IOStatus.SetOpen(true);
+			m_IOStatus.SetBound(true);
+			m_IOStatus.SetRead(true);
+			m_IOStatus.SetWrite(true);
+
+			return true;
+		}
+
+		void Close() noexcept override { m_IOStatus = {}; }
+
+		[[nodiscard]] Concurrency::Event& GetEvent() noexcept override { return m_Event; }
+
+		[[nodiscard]] const Network::Socket::IOStatus& GetIOStatus() const noexcept override { return m_IOStatus; }
+
+		[[nodiscard]] bool UpdateIOStatus(const std::chrono::milliseconds& mseconds) noexcept override
+		{
+			m_Event.Reset();
+			return true;
+		}
+
+		[[nodiscard]] const Endpoint& GetLocalEndpoint() const noexcept override { return m_LocalEndpoint; }
+
+		[[nodiscard]] Result<Size> SendTo(const Endpoint& endpoint, const BufferView& buffer) noexcept override
+		{
+			++m_Statistics.NumSendCalls;
+
+			if (!Send(endpoint, buffer)) return std::error_code(WSAEMSGSIZE, std::system_category());
+
+			++m_Statistics.NumSent;
+
+			return buffer.GetSize();
+		}
+
+		[[nodiscard]] Result<Size> SendToBatch(const Endpoint& endpoint, const Vector<BufferView>& buffers) noexcept override
+		{
+			++m_Statistics.NumSendCalls;
+
+			// Returns the number of datagrams that were sent like the real socket does
+			Size num{ 0 };
+			for (const auto& buffer : buffers)
+			{
+				if (!Send(endpoint, buffer))
+				{
+					if (num == 0) return std::error_code(WSAEMSGSIZE, std::system_category());
+					break;
+				}
+
+				++num;
+			}
+
+			m_Statistics.NumSent += num;
+
+			return num;
+		}
+
+		[[nodiscard]] Result<Size> ReceiveFrom(Endpoint& endpoint, BufferSpan& buffer) noexcept override
+		{
+			++m_Statistics.NumReceiveCalls;
+
+			try
+			{
+				auto datagram = m_Network.Get().Receive(m_ID);
+				if (!datagram.has_value()) return 0;
+
+				const auto size = datagram->Payload.GetSize();
+				if (size > buffer.GetSize()) return ResultCode::Failed;
+
+				std::memcpy(buffer.GetBytes(), datagram->Payload.GetBytes(), size);
+				endpoint = Endpoint(m_Network.GetEndpoint(datagram->From));
+
+				++m_Statistics.NumReceived;
+				m_MaxDatagramSizeReceived = std::max(m_MaxDatagramSizeReceived, size);
+
+				return size;
+			}
+			catch (...) {}
+
+			return ResultCode::Failed;
+		}
+
+		[[nodiscard]] bool SetMTUDiscovery(const bool enabled) noexcept override { return true; }
+
+		[[nodiscard]] const Network::Socket::DatagramStatistics& GetDatagramStatistics() const noexcept override
+		{
+			return m_Statistics;
+		}
+
+		[[nodiscard]] inline SimulatedUDPNetwork::Simulator::EndpointID GetID() const noexcept { return m_ID; }
+		[[nodiscard]] inline Size GetNumBytesSent() const noexcept { return m_NumBytesSent; }
+		[[nodiscard]] inline Size GetMaxDatagramSizeReceived() const noexcept { return m_MaxDatagramSizeReceived; }
+
+	private:
+		[[nodiscard]] bool Send(const Endpoint& endpoint, const BufferView& buffer) noexcept
+		{
+			try
+			{
+				// Datagrams to endpoints that don't exist get lost on the way
+				const auto to = m_Network.GetEndpointID(endpoint.GetIPEndpoint());
+				if (to.has_value())
+				{
+					if (m_Network.Get().Send(m_ID, *to, buffer.GetSize(), Buffer(buffer)) ==
+						SimulatedUDPNetwork::Simulator::SendResult::MessageTooLarge)
+					{
+						return false;
+					}
+				}
+
+				m_NumBytesSent += buffer.GetSize();
+			}
+			catch (...) {}
+
+			return true;
+		}
+
+	private:
+		SimulatedUDPNetwork& m_Network;
+		SimulatedUDPNetwork::Simulator::EndpointID m_ID{ 0 };
+		Endpoint m_LocalEndpoint;
+		Network::Socket::IOStatus m_IOStatus;
+		Concurrency::Event m_Event;
+		Network::Socket::DatagramStatistics m_Statistics;
+		Size m_NumBytesSent{ 0 };
+		Size m_MaxDatagramSizeReceived{ 0 };
+	};
+
+	struct SimulatedPeer final
+	{
+		Core::UDP::Socket Socket;
+		std::unique_ptr<Connection::Connection> UDPConnection;
+		SimulatedDatagramIO* IO{ nullptr };
+	};
+
+	// Stands in for the UDP listener manager; accepts incoming connections the
+	// same way Listener::Manager::AcceptConnection() does, including the checks
+	// on the Syn messages and the connection cookies, but without a peer manager
+	class SimulatedListener final
+	{
+	public:
+		struct Statistics final
+		{
+			Size NumCookiesSent{ 0 };
+			Size NumCookiesVerified{ 0 };
+			Size NumCookiesRefused{ 0 };
+			Size NumRefused{ 0 };
+			Size NumAccepted{ 0 };
+		};
+
+		SimulatedListener(const Settings_CThS& settings, Core::KeyGeneration::Manager& keymgr, Core::Access::Manager& accessmgr,
+						  SimulatedUDPNetwork& network, const SimulatedClock& clock, const IPEndpoint& endpoint) :
+			m_Settings(settings), m_KeyManager(keymgr), m_AccessManager(accessmgr), m_Network(network),
+			m_Clock(clock), m_Endpoint(endpoint), m_IO(network, endpoint),
+			m_SymmetricKeys(PeerConnectionType::Inbound, settings.GetCache().Local.GlobalSharedSecret),
+			m_SendQueue(std::make_shared<Listener::SendQueue_ThS>())
+		{
+			Assert::AreEqual(true, m_IO.Open(Network::AddressFamily::IPv4, false));
+			Assert::AreEqual(true, m_Cookies.Initialize(m_Clock.GetSteadyTime(),
+														settings.GetCache().UDP.CookieExpirationInterval));
+		}
+
+		inline void SetRequireCookie(const bool require) noexcept { m_RequireCookie = require; }
+
+		[[nodiscard]] inline const IPEndpoint& GetEndpoint() const noexcept { return m_Endpoint; }
+		[[nodiscard]] inline const Statistics& GetStatistics() const noexcept { return m_Statistics; }
+		[[nodiscard]] inline Vector<std::unique_ptr<SimulatedPeer>>& GetPeers() noexcept { return m_Peers; }
+
+		void Receive()
+		{
+			const auto& settings = m_Settings.GetCache();
+
+			Buffer buffer(Connection::UDPMessageSizes::Max);
+
+			while (true)
+			{
+				Endpoint pendpoint;
+				BufferSpan bufspan(buffer);
+
+				const auto result = m_IO.ReceiveFrom(pendpoint, bufspan);
+				if (!result.Succeeded() || *result == 0) break;
+
+				bufspan = bufspan.GetFirst(*result);
+
+				AcceptConnection(settings, pendpoint.GetIPEndpoint(), bufspan);
+			}
+		}
+
+		void Send()
+		{
+			m_SendQueue->WithUniqueLock([&](auto& queue)
+			{
+				while (!queue.empty())
+				{
+					const auto& itm = queue.front();
+					DiscardReturnValue(m_IO.SendTo(Endpoint(itm.Endpoint), BufferView(itm.Data)));
+					queue.pop_front();
+				}
+			});
+		}
+
+	private:
+		void AcceptConnection(const Settings& settings, const IPEndpoint& pendpoint, BufferSpan& buffer)
+		{
+			Message msg(Message::Type::Unknown, Message::Direction::Incoming);
+			if (!msg.Read(buffer, m_SymmetricKeys) || !msg.IsValid())
+			{
+				++m_Statistics.NumRefused;
+				return;
+			}
+
+			// Nulls (decoy messages) get ignored
+			if (msg.GetType() != Message::Type::Syn) return;
+
+			auto& syn_data = msg.GetSynData();
+
+			if (!(syn_data.ProtocolVersionMajor == Core::UDP::ProtocolVersion::Major &&
+				  syn_data.ProtocolVersionMinor == Core::UDP::ProtocolVersion::Minor))
+			{
+				++m_Statistics.NumRefused;
+				return;
+			}
+
+			const auto msgtime = Util::ToTime(syn_data.Time);
+			if (std::chrono::abs(m_Clock.GetSystemTime() - msgtime) > settings.Message.AgeTolerance)
+			{
+				++m_Statistics.NumRefused;
+				return;
+			}
+
+			auto cookie_verified{ false };
+
+			if (syn_data.Cookie.has_value())
+			{
+				if (m_Cookies.VerifyCookie(*syn_data.Cookie, syn_data.ConnectionID, pendpoint,
+										   m_Clock.GetSteadyTime(), settings.UDP.CookieExpirationInterval))
+				{
+					++m_Statistics.NumCookiesVerified;
+					cookie_verified = true;
+				}
+				else
+				{
+					++m_Statistics.NumCookiesRefused;
+					return;
+				}
+			}
+
+			for (const auto& peer : m_Peers)
+			{
+				// Connection already exists
+				if (peer->UDPConnection->GetID() == syn_data.ConnectionID) return;
+			}
+
+			if (m_RequireCookie && !cookie_verified)
+			{
+				SendCookie(settings, pendpoint, syn_data.ConnectionID);
+				return;
+			}
+
+			// Every connection gets its own port like a real connection gets its own socket
+			const IPEndpoint lendpoint(IPEndpoint::Protocol::UDP, m_Endpoint.GetIPAddress(),
+									   static_cast<UInt16>(50'000 + m_Peers.size()));
+
+			auto io = std::make_unique<SimulatedDatagramIO>(m_Network, lendpoint);
+
+			auto peer = std::make_unique<SimulatedPeer>();
+			peer->IO = io.get();
+			peer->UDPConnection = std::make_unique<Connection::Connection>(m_Settings, m_KeyManager, m_AccessManager,
+																		   PeerConnectionType::Inbound, syn_data.ConnectionID,
+																		   msg.GetMessageSequenceNumber(),
+																		   std::move(*syn_data.HandshakeDataIn), std::nullopt,
+																		   nullptr, std::move(io), m_Clock);
+
+			Assert::AreEqual(true, peer->UDPConnection->Open(Network::AddressFamily::IPv4, false, peer->Socket));
+			Assert::AreEqual(true, peer->Socket.Accept(m_SendQueue, m_Endpoint, pendpoint));
+
+			m_Peers.emplace_back(std::move(peer));
+
+			++m_Statistics.NumAccepted;
+		}
+
+		void SendCookie(const Settings& settings, const IPEndpoint& pendpoint, const ConnectionID connectionid)
+		{
+			auto cookie_data = m_Cookies.GetCookie(connectionid, pendpoint, m_Clock.GetSteadyTime(),
+												   settings.UDP.CookieExpirationInterval);
+			Assert::AreEqual(true, cookie_data.has_value());
+
+			Message msg(Message::Type::Cookie, Message::Direction::Outgoing, Connection::UDPMessageSizes::Min);
+			msg.SetCookieData(std::move(*cookie_data));
+
+			Buffer data;
+			Assert::AreEqual(true, msg.Write(data, m_SymmetricKeys));
+
+			m_SendQueue->WithUniqueLock()->emplace_back(
+				Listener::SendQueueItem{
+					.Endpoint = pendpoint,
+					.Data = std::move(data)
+				});
+
+			++m_Statistics.NumCookiesSent;
+		}
+
+	private:
+		const Settings_CThS& m_Settings;
+		Core::KeyGeneration::Manager& m_KeyManager;
+		Core::Access::Manager& m_AccessManager;
+		SimulatedUDPNetwork& m_Network;
+		const SimulatedClock& m_Clock;
+		const IPEndpoint m_Endpoint;
+		SimulatedDatagramIO m_IO;
+		SymmetricKeys m_SymmetricKeys;
+		Listener::ConnectionCookies m_Cookies;
+		std::shared_ptr<Listener::SendQueue_ThS> m_SendQueue;
+		bool m_RequireCookie{ false };
+		Vector<std::unique_ptr<SimulatedPeer>> m_Peers;
+		Statistics m_Statistics;
+	};
+
+	// Runs a real outbound connection and the inbound connection that the stand-in
+	// listener accepts over the simulated network; the listener and connections get
+	// processed like the listener and connection managers would process them, and
+	// virtual time moves forward to when there's something to do next
+	class UDPConnectionSimulation final
+	{
+		// Connection deadlines get checked with some margin like
+		// the connection manager schedules its timers
+		static constexpr std::chrono::milliseconds DeadlineMargin{ 1 };
+
+		// Smallest step virtual time moves forward by so that
+		// the simulation can't get stuck at the same time
+		static constexpr std::chrono::microseconds MinTimeStep{ 10 };
+
+	public:
+		struct TransferResult final
+		{
+			bool Completed{ false };
+			bool DataIntact{ false };
+			std::chrono::nanoseconds Duration{ 0 };
+			double Goodput{ 0.0 };		// Bytes per second
+			double Overhead{ 0.0 };		// Bytes sent over the network per byte transferred
+		};
+
+		UDPConnectionSimulation(const SimulatedUDPNetwork::Simulator::LinkParameters& params,
+								const std::chrono::seconds clock_skew = 0s, const UInt64 seed = 1) :
+			m_KeyManager(m_Settings), m_AccessManager(m_Settings), m_Network(params, seed),
+			m_ListenerClock(m_Network, 0s), m_OutboundClock(m_Network, clock_skew),
+			m_Listener(m_Settings, m_KeyManager, m_AccessManager, m_Network, m_ListenerClock,
+					   IPEndpoint(IPEndpoint::Protocol::UDP, IPAddress(L"10.0.0.1"), 999))
+		{
+			Assert::AreEqual(true, m_Settings.UpdateValue([](Settings& set)
+			{
+				set.UDP.MaxNumDecoyMessages = 0;
+			}));
+
+			Assert::AreEqual(true, m_AccessManager.AddIPFilter(L"10.0.0.0/8", Core::Access::IPFilterType::Allowed).Succeeded());
+		}
+
+		template<typename F>
+		void UpdateSettings(F&& function)
+		{
+			Assert::AreEqual(true, m_Settings.UpdateValue(std::forward<F>(function)));
+		}
+
+		[[nodiscard]] inline SimulatedListener& GetListener() noexcept { return m_Listener; }
+		[[nodiscard]] inline SimulatedPeer& GetOutbound() noexcept { return *m_Outbound; }
+		[[nodiscard]] inline SimulatedUDPNetwork& GetNetwork() noexcept { return m_Network; }
+
+		[[nodiscard]] SimulatedPeer* GetInbound() noexcept
+		{
+			auto& peers = m_Listener.GetPeers();
+			return peers.empty() ? nullptr : peers.front().get();
+		}
+
+		// Connects to the listener, or to another endpoint where there may be
+		// no listener at all, and returns whether the connection got established
+		[[nodiscard]] bool Connect(const std::chrono::seconds timeout, const std::optional<IPEndpoint>& endpoint = std::nullopt)
+		{
+			const auto id = Connection::Connection::MakeConnectionID();
+			Assert::AreEqual(true, id.has_value());
+
+			auto io = std::make_unique<SimulatedDatagramIO>(m_Network,
+															IPEndpoint(IPEndpoint::Protocol::UDP, IPAddress(L"10.0.0.2"), 40'000));
+
+			m_Outbound = std::make_unique<SimulatedPeer>();
+			m_Outbound->IO = io.get();
+			m_Outbound->UDPConnection = std::make_unique<Connection::Connection>(m_Settings, m_KeyManager, m_AccessManager,
+																				 PeerConnectionType::Outbound, *id, 0,
+																				 ProtectedBuffer(), std::nullopt, nullptr,
+																				 std::move(io), m_OutboundClock);
+
+			Assert::AreEqual(true, m_Outbound->UDPConnection->Open(Network::AddressFamily::IPv4, false, m_Outbound->Socket));
+			Assert::AreEqual(true, m_Outbound->Socket.BeginConnect(Endpoint(endpoint.value_or(m_Listener.GetEndpoint()))));
+
+			return RunUntil([&]()
+			{
+				auto& socket = m_Outbound->Socket;
+				if (!socket.UpdateIOStatus(0ms)) return false;
+
+				if (socket.GetIOStatus().IsConnecting() && socket.GetIOStatus().CanWrite())
+				{
+					Assert::AreEqual(true, socket.CompleteConnect());
+				}
+
+				return socket.GetIOStatus().IsConnected();
+			}, timeout);
+		}
+
+		// Sends pseudo-random data from the outbound to the inbound connection
+		[[nodiscard]] TransferResult Transfer(const Size num_bytes, const std::chrono::seconds timeout)
+		{
+			auto inbound = GetInbound();
+			Assert::AreEqual(true, inbound != nullptr);
+
+			const auto data = Util::GetPseudoRandomBytes(num_bytes);
+			Buffer received;
+			Size num_sent{ 0 };
+
+			const auto start_time = m_Network.GetNow();
+			const auto start_bytes = m_Outbound->IO->GetNumBytesSent();
+
+			TransferResult result;
+			result.Completed = RunUntil([&]()
+			{
+				auto& osocket = m_Outbound->Socket;
+				if (num_sent < num_bytes && osocket.UpdateIOStatus(0ms) && osocket.GetIOStatus().CanWrite())
+				{
+					auto view = BufferView(data);
+					view.RemoveFirst(num_sent);
+
+					const auto sent = osocket.Send(view);
+					Assert::AreEqual(true, sent.Succeeded());
+					num_sent += *sent;
+				}
+
+				auto& isocket = inbound->Socket;
+				if (isocket.UpdateIOStatus(0ms) && isocket.GetIOStatus().CanRead())
+				{
+					Assert::AreEqual(true, isocket.Receive(received).Succeeded());
+				}
+
+				return (received.GetSize() == num_bytes);
+			}, timeout);
+
+			result.DataIntact = (received == data);
+			result.Duration = m_Network.GetNow() - start_time;
+
+			if (result.Completed && result.Duration.count() > 0)
+			{
+				result.Goodput = static_cast<double>(num_bytes) /
+					std::chrono::duration_cast<std::chrono::duration<double>>(result.Duration).count();
+				result.Overhead = static_cast<double>(m_Outbound->IO->GetNumBytesSent() - start_bytes) /
+					static_cast<double>(num_bytes);
+			}
+
+			return result;
+		}
+
+		// Keeps the connections running for a while without doing anything else
+		void RunFor(const std::chrono::seconds duration)
+		{
+			DiscardReturnValue(RunUntil([]() { return false; }, duration));
+		}
+
+	private:
+		template<typename F>
+		[[nodiscard]] bool RunUntil(F&& function, const std::chrono::seconds timeout)
+		{
+			const auto end_time = m_Network.GetNow() + timeout;
+
+			while (true)
+			{
+				// Application side of the sockets
+				if (function()) return true;
+
+				if (m_Network.GetNow() >= end_time) return false;
+
+				auto next_time = end_time;
+				const auto update_next_time = [&](const SteadyTime time) noexcept
+				{
+					next_time = std::min(next_time, time);
+				};
+
+				m_Listener.Receive();
+
+				auto closed{ false };
+
+				const auto process = [&](SimulatedPeer& peer)
+				{
+					auto& connection = *peer.UDPConnection;
+
+					connection.ProcessEvents(m_Network.GetNow(), connection.GetType() == PeerConnectionType::Outbound ?
+											 m_OutboundClock.GetSystemTime() : m_ListenerClock.GetSystemTime());
+					if (connection.ShouldClose())
+					{
+						closed = true;
+						return;
+					}
+
+					if (connection.HasDeferredWork()) update_next_time(m_Network.GetNow());
+
+					if (const auto deadline = connection.GetNextDeadline(); deadline.has_value())
+					{
+						update_next_time(*deadline + DeadlineMargin);
+					}
+				};
+
+				process(*m_Outbound);
+
+				for (auto& peer : m_Listener.GetPeers())
+				{
+					process(*peer);
+				}
+
+				m_Listener.Send();
+
+				// The closed connection gets processed once more so that the
+				// socket gets its exception (when the connection timed out)
+				if (closed)
+				{
+					DiscardReturnValue(function());
+					return false;
+				}
+
+				if (const auto delivery = m_Network.Get().GetNextDeliveryTime(); delivery.has_value())
+				{
+					update_next_time(*delivery);
+				}
+
+				m_Network.Get().AdvanceTo(std::min(std::max(next_time, m_Network.GetNow() + MinTimeStep), end_time));
+			}
+		}
+
+	private:
+		Settings_CThS m_Settings;
+		Core::KeyGeneration::Manager m_KeyManager;
+		Core::Access::Manager m_AccessManager;
+		SimulatedUDPNetwork m_Network;
+		SimulatedClock m_ListenerClock;
+		SimulatedClock m_OutboundClock;
+		SimulatedListener m_Listener;
+		std::unique_ptr<SimulatedPeer> m_Outbound;
+	};
+
+	TEST_CLASS(UDPConnectionTests)
+	{
+	public:
+		SimulatedUDPNetwork::Simulator::LinkParameters GetPath(const Size mtu = 1472)
+		{
+			SimulatedUDPNetwork::Simulator::LinkParameters params;
+			params.Latency = 25ms;
+			params.Bandwidth = 10'000'000;
+			params.QueueSize = 500'000;
+			params.MTU = mtu;
+			return params;
+		}
+
+		TEST_METHOD(Handshake)
+		{
+			UDPConnectionSimulation sim(GetPath());
+
+			Assert::AreEqual(true, sim.Connect(10s));
+			Assert::AreEqual(true, sim.GetInbound() != nullptr);
+			Assert::AreEqual(true, sim.GetOutbound().UDPConnection->GetStatus() == Connection::Status::Connected);
+
+			// The outbound connection continues with the port of the inbound connection
+			Assert::AreEqual(true, sim.GetOutbound().UDPConnection->GetPeerEndpoint().GetPort() ==
+							 sim.GetInbound()->IO->GetLocalEndpoint().GetIPEndpoint().GetPort());
+
+			// Without a cookie required, no cookie gets sent
+			const auto& stats = sim.GetListener().GetStatistics();
+			Assert::AreEqual(Size{ 1 }, stats.NumAccepted);
+			Assert::AreEqual(Size{ 0 }, stats.NumCookiesSent);
+
+			// Data goes through with the keys derived during the handshake
+			const auto result = sim.Transfer(64'000, 10s);
+			Assert::AreEqual(true, result.Completed);
+			Assert::AreEqual(true, result.DataIntact);
+			Assert::AreEqual(true, sim.GetInbound()->UDPConnection->GetStatus() == Connection::Status::Connected);
+		}
+
+		TEST_METHOD(HandshakeWithCookie)
+		{
+			UDPConnectionSimulation sim(GetPath());
+			sim.GetListener().SetRequireCookie(true);
+
+			Assert::AreEqual(true, sim.Connect(10s));
+
+			// The first Syn gets a cookie back, after which
+			// the Syn with the cookie gets accepted
+			const auto& stats = sim.GetListener().GetStatistics();
+			Assert::AreEqual(Size{ 1 }, stats.NumCookiesSent);
+			Assert::AreEqual(true, stats.NumCookiesVerified >= 1);
+			Assert::AreEqual(Size{ 0 }, stats.NumCookiesRefused);
+			Assert::AreEqual(Size{ 1 }, stats.NumAccepted);
+
+			const auto result = sim.Transfer(64'000, 10s);
+			Assert::AreEqual(true, result.Completed);
+			Assert::AreEqual(true, result.DataIntact);
+		}
+
+		TEST_METHOD(HandshakeWithExpiredCookie)
+		{
+			// With a round trip time of 3 seconds the cookies come back after the
+			// key they were made with has been rotated out; with a longer expiration
+			// interval they're still valid
+			for (const auto interval : { 20s, 2s })
+			{
+				auto params = GetPath();
+				params.Latency = 1500ms;
+
+				UDPConnectionSimulation sim(params);
+				sim.GetListener().SetRequireCookie(true);
+				sim.UpdateSettings([&](Settings& set)
+				{
+					set.UDP.CookieExpirationInterval = interval;
+					set.UDP.ConnectTimeout = 20s;
+				});
+
+				const auto connected = sim.Connect(30s);
+
+				const auto& stats = sim.GetListener().GetStatistics();
+				Assert::AreEqual(true, stats.NumCookiesSent >= 1);
+
+				if (interval == 20s)
+				{
+					Assert::AreEqual(true, connected);
+					Assert::AreEqual(Size{ 1 }, stats.NumAccepted);
+				}
+				else
+				{
+					Assert::AreEqual(false, connected);
+					Assert::AreEqual(true, stats.NumCookiesRefused >= 1);
+					Assert::AreEqual(Size{ 0 }, stats.NumCookiesVerified);
+					Assert::AreEqual(Size{ 0 }, stats.NumAccepted);
+				}
+			}
+		}
+
+		TEST_METHOD(HandshakeWithLoss)
+		{
+			auto params = GetPath();
+			params.LossRate = 0.3;
+
+			UDPConnectionSimulation sim(params);
+			sim.GetListener().SetRequireCookie(true);
+
+			// Lost Syns and cookies get retransmitted
+			Assert::AreEqual(true, sim.Connect(30s));
+			Assert::AreEqual(Size{ 1 }, sim.GetListener().GetStatistics().NumAccepted);
+
+			const auto result = sim.Transfer(64'000, 30s);
+			Assert::AreEqual(true, result.Completed);
+			Assert::AreEqual(true, result.DataIntact);
+		}
+
+		TEST_METHOD(HandshakeTimeout)
+		{
+			UDPConnectionSimulation sim(GetPath());
+			sim.UpdateSettings([](Settings& set)
+			{
+				set.UDP.ConnectTimeout = 10s;
+				set.UDP.ConnectRetransmissionTimeout = 1s;
+			});
+
+			const auto start_time = sim.GetNetwork().GetNow();
+
+			// Nobody is listening on this endpoint
+			Assert::AreEqual(false, sim.Connect(60s, IPEndpoint(IPEndpoint::Protocol::UDP, IPAddress(L"10.0.0.3"), 999)));
+
+			const auto duration = sim.GetNetwork().GetNow() - start_time;
+			Assert::AreEqual(true, duration >= 10s && duration < 11s);
+
+			const auto& iostatus = sim.GetOutbound().Socket.GetIOStatus();
+			Assert::AreEqual(true, iostatus.HasException());
+			Assert::AreEqual(true, iostatus.GetErrorCode() == WSAETIMEDOUT);
+
+			// The Syn got retransmitted in the meantime
+			Assert::AreEqual(true, sim.GetOutbound().IO->GetDatagramStatistics().NumSent > 1);
+		}
+
+		TEST_METHOD(HandshakeWithClockSkew)
+		{
+			// Syns from peers whose clocks are too far off get refused
+			for (const auto skew : { 30s, -30s, 120s, -120s })
+			{
+				UDPConnectionSimulation sim(GetPath(), skew);
+				sim.UpdateSettings([](Settings& set)
+				{
+					set.Message.AgeTolerance = 60s;
+					set.UDP.ConnectTimeout = 5s;
+				});
+
+				const auto connected = sim.Connect(10s);
+				const auto& stats = sim.GetListener().GetStatistics();
+
+				if (std::chrono::abs(skew) < 60s)
+				{
+					Assert::AreEqual(true, connected);
+					Assert::AreEqual(Size{ 1 }, stats.NumAccepted);
+				}
+				else
+				{
+					Assert::AreEqual(false, connected);
+					Assert::AreEqual(true, stats.NumRefused >= 1);
+					Assert::AreEqual(Size{ 0 }, stats.NumAccepted);
+				}
+			}
+		}
+
+		TEST_METHOD(Transfer)
+		{
+			constexpr Size num_bytes{ 4'000'000 };
+
+			for (const auto cc : { UDPCongestionControl::AIMD, UDPCongestionControl::CUBIC, UDPCongestionControl::BBR })
+			{
+				UDPConnectionSimulation sim(GetPath());
+				sim.UpdateSettings([&](Settings& set)
+				{
+					set.Local.UDP.CongestionControl = cc;
+				});
+
+				Assert::AreEqual(true, sim.Connect(10s));
+
+				const auto result = sim.Transfer(num_bytes, 60s);
+
+				Logger::WriteMessage(Util::FormatString(L"Congestion control %d: %.2f MB/s, overhead %.3f, duration %.2fs\r\n",
+														static_cast<int>(cc), result.Goodput / 1'000'000.0, result.Overhead,
+														std::chrono::duration<double>(result.Duration).count()).c_str());
+
+				Assert::AreEqual(true, result.Completed);
+				Assert::AreEqual(true, result.DataIntact);
+
+				// Slow start included, at least a tenth of the 10 MB/s bottleneck
+				// gets used without sending much more than the data itself
+				Assert::AreEqual(true, result.Goodput > 1'000'000.0);
+				Assert::AreEqual(true, result.Overhead < 1.25);
+			}
+		}
+
+		TEST_METHOD(TransferWithLoss)
+		{
+			constexpr Size num_bytes{ 1'000'000 };
+
+			auto params = GetPath();
+			params.LossRate = 0.01;
+
+			double aimd_goodput{ 0.0 };
+
+			for (const auto cc : { UDPCongestionControl::AIMD, UDPCongestionControl::CUBIC, UDPCongestionControl::BBR })
+			{
+				UDPConnectionSimulation sim(params);
+				sim.UpdateSettings([&](Settings& set)
+				{
+					set.Local.UDP.CongestionControl = cc;
+				});
+
+				Assert::AreEqual(true, sim.Connect(30s));
+
+				const auto result = sim.Transfer(num_bytes, 120s);
+
+				Logger::WriteMessage(Util::FormatString(L"Congestion control %d with 1%% loss: %.2f MB/s, overhead %.3f\r\n",
+														static_cast<int>(cc), result.Goodput / 1'000'000.0,
+														result.Overhead).c_str());
+
+				// Lost data gets retransmitted
+				Assert::AreEqual(true, result.Completed);
+				Assert::AreEqual(true, result.DataIntact);
+
+				if (cc == UDPCongestionControl::AIMD) aimd_goodput = result.Goodput;
+				else if (cc == UDPCongestionControl::BBR)
+				{
+					// BBR doesn't back off on random loss
+					Assert::AreEqual(true, result.Goodput >= aimd_goodput);
+				}
+			}
+		}
+
+		TEST_METHOD(TransferWithPacing)
+		{
+			constexpr Size num_bytes{ 2'000'000 };
+
+			// With a shallow queue at the bottleneck, bursts
+			// get dropped unless they get paced out
+			auto params = GetPath();
+			params.QueueSize = 50'000;
+
+			std::array<Size, 2> num_dropped{ 0, 0 };
+			std::array<double, 2> goodput{ 0.0, 0.0 };
+
+			for (const auto pacing : { false, true })
+			{
+				UDPConnectionSimulation sim(params);
+				sim.UpdateSettings([&](Settings& set)
+				{
+					set.Local.UDP.CongestionControl = UDPCongestionControl::BBR;
+					set.Local.UDP.Pacing = pacing;
+				});
+
+				Assert::AreEqual(true, sim.Connect(10s));
+
+				const auto result = sim.Transfer(num_bytes, 60s);
+				Assert::AreEqual(true, result.Completed);
+				Assert::AreEqual(true, result.DataIntact);
+
+				const auto& stats = sim.GetNetwork().Get().GetStatistics(sim.GetOutbound().IO->GetID(),
+																		 sim.GetInbound()->IO->GetID());
+				num_dropped[pacing] = stats.NumQueueDropped;
+				goodput[pacing] = result.Goodput;
+
+				Logger::WriteMessage(Util::FormatString(L"Pacing %s: %.2f MB/s, %zu datagrams dropped at the bottleneck\r\n",
+														pacing ? L"on" : L"off", result.Goodput / 1'000'000.0,
+														stats.NumQueueDropped).c_str());
+			}
+
+			Assert::AreEqual(true, num_dropped[1] <= num_dropped[0]);
+			Assert::AreEqual(true, goodput[1] >= goodput[0] * 0.9);
+		}
+
+		TEST_METHOD(MTUDiscovery)
+		{
+			// Larger datagrams either fail to send or get dropped silently on the path (a black hole);
+			// with no limit on the path the largest message size should get discovered
+			for (const auto& [mtu, black_hole, wait] : { std::make_tuple(Size{ 1472 }, false, 2s),
+														 std::make_tuple(Size{ 1472 }, true, 10s),
+														 std::make_tuple(std::numeric_limits<Size>::max(), false, 2s) })
+			{
+				auto params = GetPath(mtu);
+				params.MTUBlackHole = black_hole;
+
+				UDPConnectionSimulation sim(params);
+				sim.UpdateSettings([](Settings& set)
+				{
+					set.UDP.MaxMTUDiscoveryDelay = 0ms;
+				});
+
+				Assert::AreEqual(true, sim.Connect(10s));
+
+				sim.RunFor(wait);
+
+				// Data messages get filled up to the maximum message size
+				const auto result = sim.Transfer(256'000, 30s);
+				Assert::AreEqual(true, result.Completed);
+				Assert::AreEqual(true, result.DataIntact);
+
+				const auto max_size = sim.GetInbound()->IO->GetMaxDatagramSizeReceived();
+
+				Logger::WriteMessage(Util::FormatString(L"Path MTU %zu%s: largest datagram received %zu bytes\r\n",
+														mtu, black_hole ? L" (black hole)" : L"", max_size).c_str());
+
+				if (mtu == 1472)
+				{
+					Assert::AreEqual(true, max_size > 1460 && max_size <= 1472);
+				}
+				else Assert::AreEqual(true, max_size > 32'768);
+			}
+		}
+	};
+}